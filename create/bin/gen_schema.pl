@@ -21,9 +21,10 @@ my $file = dirname($0) . "/../src/schema.tmpl";	# name the file
 
 my ($state, %output, $eol, $fk_bol, $fk_eol, $ltab, $pkey, $table_name, $pkey_name);
 my ($szcol1, $szcol2, $szcol3, $szcol4, $sequences, $sql_suffix, $triggers);
-my ($fkeys, $fkeys_prefix, $fkeys_suffix, $uniq, $delete_cascade);
+my ($fkeys, $fkeys_prefix, $fkeys_suffix, $uniq, @delete_cascade);
 
 my %table_types;	# for making sure that table types aren't duplicated
+my %table_cascades;	# for making sure that changelog tables are cascade deleted only by changelog tables
 
 my %c = (
 	"type"		=>	"code",
@@ -179,7 +180,7 @@ sub process_table($)
 
 	newstate("table");
 
-	$delete_cascade = 0;
+	@delete_cascade = ();
 
 	($table_name, $pkey_name, $flags) = split(/\|/, $line, 3);
 
@@ -290,12 +291,16 @@ sub process_field($)
 				$fk_field = $name;
 			}
 
+			if (not $fk_flags or $fk_flags eq "")
+			{
+				push(@delete_cascade, $fk_table);
+			}
+
 			$fk_table = "\"${fk_table}\"";
 			$fk_field = "\"${fk_field}\"";
 
 			if (not $fk_flags or $fk_flags eq "")
 			{
-				$delete_cascade = 1;
 				$fk_flags = "ZBX_FK_CASCADE_DELETE";
 			}
 			elsif ($fk_flags eq "RESTRICT")
@@ -359,7 +364,7 @@ sub process_field($)
 
 			if (not $fk_flags or $fk_flags eq "")
 			{
-				$delete_cascade = 1;
+				push(@delete_cascade, $fk_table);
 				$fk_flags = " ON DELETE CASCADE";
 			}
 			elsif ($fk_flags eq "RESTRICT")
@@ -805,14 +810,29 @@ sub close_function($)
 	return $out;
 }
 
-sub process_changelog($)
+sub check_changelog_cascades()
 {
-	my $table_type = shift;
+	my %changelog_tables = map { $_ => 1 } values(%table_types);
 
-	if ($delete_cascade)
+	while (my ($table, $parents) = each(%table_cascades))
 	{
-		die("table '$table_name' foreign keys without RESTRICT flag are not compatible with table CHANGELOG token");
+		foreach my $parent (@{$parents})
+		{
+			if (not exists($changelog_tables{$parent}))
+			{
+				die("table '$table' foreign keys without RESTRICT flag to table '$parent' without CHANGELOG" .
+						" token are not compatible with table CHANGELOG token");
+			}
+		}
 	}
+}
+
+sub process_changelog($)
+{
+	my $table_type = shift;
+
+	# MySQL does not fire triggers for cascade deletes, so such deletes must be tracked by parent table changelog
+	$table_cascades{$table_name} = [@delete_cascade];
 
 	if (exists($table_types{$table_type}) && $table_types{$table_type} ne $table_name)
 	{
@@ -949,6 +969,8 @@ sub process()
 
 	newstate("table");
 
+	check_changelog_cascades();
+
 	if ($output{"database"} eq "mysql")
 	{
 		print "DELIMITER \$\$${eol}\n";
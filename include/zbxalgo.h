@@ -299,6 +299,69 @@ void			zbx_binary_heap_remove_direct(zbx_binary_heap_t *heap, zbx_uint64_t key);
 
 void			zbx_binary_heap_clear(zbx_binary_heap_t *heap);
 
+/* hierarchical timing wheel */
+
+/* Stores zbx_uint64_t keys with arbitrary auxiliary information scheduled at time in seconds. Elements are  */
+/* kept in per second slots for the nearest ZBX_TIMING_WHEEL_LEVEL_SLOTS seconds and in coarser slots on    */
+/* upper levels, which are cascaded down when the wheel reaches them. Elements scheduled at the same second */
+/* are returned in compare function order, elements scheduled before wheel time are returned first.        */
+
+#define ZBX_TIMING_WHEEL_LEVELS		3
+#define ZBX_TIMING_WHEEL_LEVEL_BITS	6
+#define ZBX_TIMING_WHEEL_LEVEL_SLOTS	(1 << ZBX_TIMING_WHEEL_LEVEL_BITS)
+#define ZBX_TIMING_WHEEL_SLOTS		(ZBX_TIMING_WHEEL_LEVELS * ZBX_TIMING_WHEEL_LEVEL_SLOTS + 1)
+
+typedef struct
+{
+	zbx_uint64_t	key;
+	void		*data;
+	int		time;
+}
+zbx_timing_wheel_elem_t;
+
+typedef struct
+{
+	zbx_timing_wheel_elem_t	*elems;
+	int			elems_first;	/* elements before this index were removed from sorted slot */
+	int			elems_num;
+	int			elems_alloc;
+	int			sorted;
+}
+zbx_timing_wheel_slot_t;
+
+typedef struct
+{
+	zbx_timing_wheel_slot_t	slots[ZBX_TIMING_WHEEL_SLOTS];
+	zbx_uint64_t		slots_used[ZBX_TIMING_WHEEL_LEVELS];
+	int			time;
+	int			elems_num;
+	zbx_compare_func_t	compare_func;
+	zbx_hashmap_t		*key_index;
+
+	/* the same memory allocation function restrictions as for binary heap apply */
+	zbx_mem_malloc_func_t	mem_malloc_func;
+	zbx_mem_realloc_func_t	mem_realloc_func;
+	zbx_mem_free_func_t	mem_free_func;
+}
+zbx_timing_wheel_t;
+
+void			zbx_timing_wheel_create(zbx_timing_wheel_t *wheel, zbx_compare_func_t compare_func);
+void			zbx_timing_wheel_create_ext(zbx_timing_wheel_t *wheel, zbx_compare_func_t compare_func,
+							zbx_mem_malloc_func_t mem_malloc_func,
+							zbx_mem_realloc_func_t mem_realloc_func,
+							zbx_mem_free_func_t mem_free_func);
+void			zbx_timing_wheel_destroy(zbx_timing_wheel_t *wheel);
+
+int			zbx_timing_wheel_empty(const zbx_timing_wheel_t *wheel);
+int			zbx_timing_wheel_min_time(const zbx_timing_wheel_t *wheel);
+zbx_timing_wheel_elem_t	*zbx_timing_wheel_find_min(zbx_timing_wheel_t *wheel);
+void			zbx_timing_wheel_insert(zbx_timing_wheel_t *wheel, const zbx_timing_wheel_elem_t *elem);
+void			zbx_timing_wheel_update_direct(zbx_timing_wheel_t *wheel, const zbx_timing_wheel_elem_t *elem);
+void			zbx_timing_wheel_remove_min(zbx_timing_wheel_t *wheel);
+void			zbx_timing_wheel_remove_direct(zbx_timing_wheel_t *wheel, zbx_uint64_t key);
+
+void			zbx_timing_wheel_clear(zbx_timing_wheel_t *wheel);
+
 /* vector implementation start */
 
 #define ZBX_VECTOR_STRUCT_DECL(__id, __type)									\
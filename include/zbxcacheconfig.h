@@ -855,28 +855,48 @@ void	zbx_dc_config_get_functions_by_functionids(zbx_dc_function_t *functions,
 void	zbx_dc_config_clean_functions(zbx_dc_function_t *functions, int *errcodes, size_t num);
 void	zbx_dc_config_clean_triggers(zbx_dc_trigger_t *triggers, int *errcodes, size_t num);
 
-typedef struct zbx_hc_data
+/* history cache value, the metadata (lastlogsize, mtime) is stored separately in chunk */
+typedef struct
 {
 	zbx_history_value_t	value;
-	zbx_uint64_t		lastlogsize;
 	zbx_timespec_t		ts;
-	int			mtime;
 	unsigned char		value_type;
 	unsigned char		flags;
 	unsigned char		state;
-
-	struct zbx_hc_data	*next;
 }
 zbx_hc_data_t;
 
+typedef struct
+{
+	zbx_uint64_t	lastlogsize;
+	int		mtime;
+}
+zbx_hc_meta_t;
+
+/* chunk of consecutive item values in history cache */
+typedef struct zbx_hc_chunk
+{
+	struct zbx_hc_chunk	*next;
+
+	/* metadata of chunk values, allocated only when a value with metadata is added */
+	zbx_hc_meta_t		*meta;
+
+	unsigned short		size;	/* the number of allocated values */
+	unsigned short		first;	/* the index of the oldest value */
+	unsigned short		last;	/* the index after the newest value */
+
+	zbx_hc_data_t		values[];
+}
+zbx_hc_chunk_t;
+
 typedef struct
 {
 	zbx_uint64_t	itemid;
 	unsigned char	status;
 	int		values_num;
 
-	zbx_hc_data_t	*tail;
-	zbx_hc_data_t	*head;
+	zbx_hc_chunk_t	*tail;
+	zbx_hc_chunk_t	*head;
 }
 zbx_hc_item_t;
 
@@ -956,6 +976,7 @@ int	zbx_dc_get_host_inventory_value_by_hostid(zbx_uint64_t hostid, char **replac
 #define ZBX_CONFSTATS_BUFFER_FREE	3
 #define ZBX_CONFSTATS_BUFFER_PUSED	4
 #define ZBX_CONFSTATS_BUFFER_PFREE	5
+#define ZBX_CONFSTATS_BUFFER_PAGESIZE	6
 void	*zbx_dc_config_get_stats(int request);
 
 int	zbx_dc_config_get_last_sync_time(void);
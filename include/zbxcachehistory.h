@@ -58,9 +58,28 @@ typedef struct
 	zbx_uint64_t	index_total;
 	zbx_uint64_t	trend_free;
 	zbx_uint64_t	trend_total;
+	zbx_uint64_t	history_page_size;	/* size of memory pages backing the caches */
+	zbx_uint64_t	index_page_size;
+	zbx_uint64_t	trend_page_size;
+	zbx_uint64_t	spill_total;	/* history cache spill journal size, 0 if disabled */
+	zbx_uint64_t	spill_used;
+	zbx_uint64_t	spill_values;	/* the number of values in spill journal */
+	int		spill_lag;	/* the age of the oldest value in spill journal */
 }
 zbx_wcache_info_t;
 
+/* the history cache shard statistics */
+typedef struct
+{
+	zbx_uint64_t	items_num;
+	zbx_uint64_t	values_num;
+	zbx_uint64_t	locks_num;		/* the number of shard lock acquisitions */
+	zbx_uint64_t	locks_contended;	/* the number of times shard lock was held by another process */
+}
+zbx_hc_shard_stats_t;
+
+ZBX_VECTOR_DECL(hc_shard_stats, zbx_hc_shard_stats_t)
+
 #define ZBX_SYNC_NONE	0
 #define ZBX_SYNC_ALL	1
 
@@ -87,6 +106,14 @@ zbx_wcache_info_t;
 #define ZBX_STATS_HISTORY_INDEX_PUSED	20
 #define ZBX_STATS_HISTORY_INDEX_PFREE	21
 #define ZBX_STATS_HISTORY_BIN_COUNTER	22
+#define ZBX_STATS_SPILL_TOTAL		23
+#define ZBX_STATS_SPILL_USED		24
+#define ZBX_STATS_SPILL_PUSED		25
+#define ZBX_STATS_SPILL_VALUES		26
+#define ZBX_STATS_SPILL_LAG		27
+#define ZBX_STATS_HISTORY_PAGESIZE	28
+#define ZBX_STATS_HISTORY_INDEX_PAGESIZE	29
+#define ZBX_STATS_TREND_PAGESIZE	30
 
 /* 'zbx_pp_value_opt_t' element 'flags' values */
 #define ZBX_PP_VALUE_OPT_NONE		0x0000	/* 'zbx_pp_value_opt_t' has no data */
@@ -151,14 +178,15 @@ typedef void (*zbx_history_sync_f)(int *values_num, int *triggers_num, const zbx
 
 int	zbx_init_database_cache(zbx_get_program_type_f get_program_type, zbx_history_sync_f sync_history,
 		zbx_uint64_t history_cache_size, zbx_uint64_t history_index_cache_size, zbx_uint64_t *trends_cache_size,
-		char **error);
+		const char *history_cache_spill_dir, zbx_uint64_t history_cache_spill_size, char **error);
 
 void	zbx_free_database_cache(int sync, const zbx_events_funcs_t *events_cbs, int config_history_storage_pipelines);
 
 zbx_uint64_t	zbx_dc_get_nextid(const char *table_name, int num);
 
 void	zbx_dc_update_interfaces_availability(void);
-void	zbx_hc_get_diag_stats(zbx_uint64_t *items_num, zbx_uint64_t *values_num);
+void	zbx_hc_get_diag_stats(zbx_uint64_t *items_num, zbx_uint64_t *values_num,
+		zbx_vector_hc_shard_stats_t *shards);
 void	zbx_hc_get_mem_stats(zbx_shmem_stats_t *data, zbx_shmem_stats_t *index);
 int	zbx_hc_is_itemid_cached(zbx_uint64_t itemid);
 void	zbx_hc_get_items(zbx_vector_uint64_pair_t *items);
@@ -170,11 +198,6 @@ int	zbx_hc_proxyqueue_dequeue(zbx_uint64_t proxyid);
 void	zbx_hc_proxyqueue_clear(void);
 void	zbx_dbcache_lock(void);
 void	zbx_dbcache_unlock(void);
-void	zbx_dbcache_set_history_num(int num);
-int	zbx_dbcache_get_history_num(void);
-
-zbx_shmem_info_t	*zbx_dbcache_get_hc_mem(void);
-
 void	zbx_dbcache_setproxyqueue_state(int proxyqueue_state);
 int	zbx_dbcache_getproxyqueue_state(void);
 #endif
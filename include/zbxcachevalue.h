@@ -33,6 +33,9 @@
  *   function. To ensure proper removal of shared memory the value cache must be destroyed
  *   upon a program exit with zbx_vc_destroy() function.
  *
+ *   The cache contents can be saved to a snapshot file with zbx_vc_snapshot_save()
+ *   before destroying the cache and loaded back after restart with zbx_vc_snapshot_load().
+ *
  * Adding data
  *
  *   Whenever a new item value is added to system (history tables) the item value must be
@@ -45,6 +48,14 @@
  *   either zbx_history_record_vector_destroy() function (free the zbx_vc_get_values()
  *   call output) or zbx_history_record_clear() function (free the zbx_vc_get_value() call output).
  *
+ *   Before requesting values of many items the values of items missing from cache can be
+ *   read in batches with zbx_vc_prefetch_values() function.
+ *
+ *   Aggregates (avg, sum, min, max, count) of numeric items over time periods ending with
+ *   the last item value can be retrieved with zbx_vc_get_aggregate() function without
+ *   copying the values. The cache keeps running aggregates for recently requested periods,
+ *   if the aggregate is not available the values must be retrieved with zbx_vc_get_values().
+ *
  * Locking
  *
  *   The cache ensures synchronization between processes by using automatic locks whenever
@@ -89,6 +100,44 @@ zbx_vc_item_stats_t;
 
 ZBX_PTR_VECTOR_DECL(vc_item_stats_ptr, zbx_vc_item_stats_t *)
 
+/* value cache snapshot loading statistics */
+typedef struct
+{
+	zbx_uint64_t	items;		/* the number of restored items */
+	zbx_uint64_t	values;		/* the number of restored values */
+	zbx_uint64_t	gap_values;	/* the number of values read from database since snapshot */
+	zbx_uint64_t	discarded;	/* the number of discarded snapshot items */
+	double		time;		/* the snapshot loading time in seconds */
+}
+zbx_vc_snapshot_stats_t;
+
+/* the aggregate functions supported by zbx_vc_get_aggregate() */
+typedef enum
+{
+	ZBX_VC_AGGREGATE_AVG,
+	ZBX_VC_AGGREGATE_SUM,
+	ZBX_VC_AGGREGATE_MIN,
+	ZBX_VC_AGGREGATE_MAX,
+	ZBX_VC_AGGREGATE_COUNT
+}
+zbx_vc_aggregate_func_t;
+
+/* the item value request, see zbx_vc_get_values() parameters */
+typedef struct
+{
+	zbx_uint64_t	itemid;
+	unsigned char	value_type;
+	int		seconds;
+	int		count;
+	zbx_timespec_t	ts;
+}
+zbx_vc_request_t;
+
+ZBX_VECTOR_DECL(vc_request, zbx_vc_request_t)
+
+/* checks if snapshot item matches current configuration, returns SUCCEED or FAIL */
+typedef int	(*zbx_vc_check_item_func_t)(zbx_uint64_t itemid, unsigned char value_type);
+
 void	zbx_vc_item_stats_free(zbx_vc_item_stats_t *vc_item_stats);
 
 int	zbx_vc_init(zbx_uint64_t value_cache_size, char **error);
@@ -104,9 +153,14 @@ void	zbx_vc_disable(void);
 int	zbx_vc_get_values(zbx_uint64_t itemid, unsigned char value_type, zbx_vector_history_record_t *values,
 		int seconds, int count, const zbx_timespec_t *ts);
 
+void	zbx_vc_prefetch_values(const zbx_vector_vc_request_t *requests);
+
 int	zbx_vc_get_value(zbx_uint64_t itemid, unsigned char value_type, const zbx_timespec_t *ts,
 		zbx_history_record_t *value);
 
+int	zbx_vc_get_aggregate(zbx_uint64_t itemid, unsigned char value_type, zbx_vc_aggregate_func_t func,
+		int seconds, const zbx_timespec_t *ts, zbx_history_value_t *value, int *values_num);
+
 int	zbx_vc_add_values(zbx_vector_dc_history_ptr_t *history, int *ret_flush, int config_history_storage_pipelines);
 
 int	zbx_vc_get_statistics(zbx_vc_stats_t *stats);
@@ -120,4 +174,8 @@ void	zbx_vc_flush_stats(void);
 
 void	zbx_vc_add_new_items(const zbx_vector_uint64_pair_t *items);
 
+int	zbx_vc_snapshot_save(const char *path, char **error);
+int	zbx_vc_snapshot_load(const char *path, zbx_vc_check_item_func_t check_item_cb, char **error);
+void	zbx_vc_get_snapshot_stats(zbx_vc_snapshot_stats_t *stats);
+
 #endif
@@ -42,6 +42,14 @@ typedef union
 }
 zbx_db_value_t;
 
+/* prepared statement parameter */
+typedef struct
+{
+	unsigned char	type;	/* ZBX_TYPE_ID, ZBX_TYPE_UINT, ZBX_TYPE_INT, ZBX_TYPE_FLOAT or ZBX_TYPE_CHAR */
+	zbx_db_value_t	value;
+}
+zbx_db_bind_t;
+
 typedef struct
 {
 	char		*dbhost;
@@ -59,6 +67,8 @@ typedef struct
 	unsigned int	dbport;
 	int		log_slow_queries;
 	int		read_only_recoverable;
+	int		pipelining;
+	int		prepared_statements;
 }
 zbx_db_config_t;
 
@@ -277,6 +287,8 @@ typedef struct
 	int				batch_size;
 	/* the last id assigned by autoincrement */
 	zbx_uint64_t			lastid;
+	/* rows can be inserted with binary COPY instead of insert statements */
+	int				copy;
 }
 zbx_db_insert_t;
 
@@ -299,10 +311,17 @@ zbx_db_result_t	zbx_dbconn_vselect(zbx_dbconn_t *db, const char *fmt, va_list ar
 zbx_db_result_t	zbx_dbconn_select(zbx_dbconn_t *db, const char *fmt, ...);
 zbx_db_result_t	zbx_dbconn_select_n(zbx_dbconn_t *db, const char *query, int n);
 
+void	zbx_db_bind_uint64(zbx_db_bind_t *bind, zbx_uint64_t value);
+void	zbx_db_bind_int(zbx_db_bind_t *bind, int value);
+void	zbx_db_bind_str(zbx_db_bind_t *bind, const char *value);
+zbx_db_result_t	zbx_dbconn_select_prepared(zbx_dbconn_t *db, const char *sql, const zbx_db_bind_t *binds,
+		int binds_num);
+
 zbx_db_row_t	zbx_db_fetch(zbx_db_result_t result);
 void	zbx_db_free_result(zbx_db_result_t result);
 
 int	zbx_dbconn_begin(zbx_dbconn_t *db);
+int	zbx_dbconn_begin_pipeline(zbx_dbconn_t *db);
 int	zbx_dbconn_commit(zbx_dbconn_t *db);
 int	zbx_dbconn_rollback(zbx_dbconn_t *db);
 int	zbx_dbconn_end(zbx_dbconn_t *db, int ret);
@@ -443,6 +462,7 @@ void	zbx_db_init_autoincrement_options(void);
 int	zbx_db_connect(int flag);
 void	zbx_db_close(void);
 void	zbx_db_begin(void);
+void	zbx_db_begin_pipeline(void);
 int	zbx_db_commit(void);
 void	zbx_db_rollback(void);
 int	zbx_db_end(int ret);
@@ -451,6 +471,7 @@ int	zbx_db_execute_once(const char *fmt, ...);
 zbx_db_result_t	zbx_db_select(const char *fmt, ...);
 zbx_db_result_t	zbx_db_vselect(const char *fmt, va_list args);
 zbx_db_result_t	zbx_db_select_n(const char *query, int n);
+zbx_db_result_t	zbx_db_select_prepared(const char *sql, const zbx_db_bind_t *binds, int binds_num);
 void	zbx_db_insert_prepare_dyn(zbx_db_insert_t *db_insert, const zbx_db_table_t *table,
 		const zbx_db_field_t **fields, int fields_num);
 void	zbx_db_insert_prepare(zbx_db_insert_t *self, const char *table, ...);
@@ -153,6 +153,8 @@ double	zbx_evaluate_string_to_double(const char *in);
 int	zbx_evaluatable_for_notsupported(const char *fn);
 int	zbx_evaluate_function(zbx_variant_t *value, const zbx_dc_evaluate_item_t *item, const char *function,
 		const char *parameter, const zbx_timespec_t *ts, char **error);
+int	zbx_evaluate_function_history_range(const char *function, const char *parameter, const zbx_timespec_t *ts,
+		int *seconds, int *count, zbx_timespec_t *ts_end);
 
 typedef int	(*zbx_macro_resolver_f)(char **text, const void *cb_data);
 
@@ -26,6 +26,9 @@
 
 #define ZBX_IPC_WAIT_FOREVER	-1
 
+/* the maximum number of descriptors received with a message */
+#define ZBX_IPC_SOCKET_FDS_MAX	4
+
 typedef struct
 {
 	/* the message code */
@@ -50,9 +53,18 @@ typedef struct
 	unsigned char	rx_buffer[ZBX_IPC_SOCKET_BUFFER_SIZE];
 	zbx_uint32_t	rx_buffer_bytes;
 	zbx_uint32_t	rx_buffer_offset;
+
+	/* descriptors received over socket, not yet claimed */
+	int		rx_fds[ZBX_IPC_SOCKET_FDS_MAX];
+	int		rx_fds_num;
 }
 zbx_ipc_socket_t;
 
+/* Single producer, single consumer shared memory ring. The producer writes */
+/* data records directly into memory shared with IPC service, avoiding      */
+/* socket writes and reads for bulk data.                                   */
+typedef struct zbx_ipc_ring zbx_ipc_ring_t;
+
 typedef struct zbx_ipc_client zbx_ipc_client_t;
 
 ZBX_PTR_VECTOR_DECL(ipc_client_ptr, zbx_ipc_client_t *)
@@ -116,6 +128,21 @@ int	zbx_ipc_socket_write(zbx_ipc_socket_t *csocket, zbx_uint32_t code, const uns
 		zbx_uint32_t size);
 int	zbx_ipc_socket_read(zbx_ipc_socket_t *csocket, zbx_ipc_message_t *message);
 int	zbx_ipc_socket_connected(const zbx_ipc_socket_t *csocket);
+int	zbx_ipc_socket_send_ring(zbx_ipc_socket_t *csocket, zbx_uint32_t code, const zbx_ipc_ring_t *ring);
+
+int			zbx_ipc_client_attach_ring(zbx_ipc_client_t *client, char **error);
+zbx_ipc_ring_t		*zbx_ipc_client_get_ring(zbx_ipc_client_t *client);
+
+int			zbx_ipc_ring_create(zbx_ipc_ring_t **ring, zbx_uint32_t size, char **error);
+void			zbx_ipc_ring_free(zbx_ipc_ring_t *ring);
+zbx_uint32_t		zbx_ipc_ring_max_record_size(const zbx_ipc_ring_t *ring);
+unsigned char		*zbx_ipc_ring_reserve(zbx_ipc_ring_t *ring, zbx_uint32_t size,
+			const zbx_ipc_socket_t *csocket);
+void			zbx_ipc_ring_commit(zbx_ipc_ring_t *ring, zbx_uint32_t size);
+void			zbx_ipc_ring_notify(zbx_ipc_ring_t *ring);
+int			zbx_ipc_ring_flush(zbx_ipc_ring_t *ring, const zbx_ipc_socket_t *csocket);
+const unsigned char	*zbx_ipc_ring_read(zbx_ipc_ring_t *ring, zbx_uint32_t *size);
+void			zbx_ipc_ring_release(zbx_ipc_ring_t *ring);
 
 int	zbx_ipc_async_socket_open(zbx_ipc_async_socket_t *asocket, const char *service_name, int timeout, char **error);
 void	zbx_ipc_async_socket_close(zbx_ipc_async_socket_t *asocket);
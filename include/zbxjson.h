@@ -406,6 +406,7 @@ typedef struct zbx_jsonpath_index zbx_jsonpath_index_t;
 
 int	zbx_jsonpath_compile(const char *path, zbx_jsonpath_t *jsonpath);
 int	zbx_jsonpath_query(const struct zbx_json_parse *jp, const char *path, char **output);
+int	zbx_jsonpath_query_data(const char *data, const char *path, char **output);
 void	zbx_jsonpath_clear(zbx_jsonpath_t *jsonpath);
 
 zbx_jsonpath_index_t	*zbx_jsonpath_index_create(char **error);
@@ -415,6 +416,7 @@ int	zbx_jsonobj_open(const char *data, zbx_jsonobj_t *obj);
 void	zbx_jsonobj_clear(zbx_jsonobj_t *obj);
 int	zbx_jsonobj_query(const zbx_jsonobj_t *obj, const char *path, char **output);
 int	zbx_jsonobj_query_ext(const zbx_jsonobj_t *obj, zbx_jsonpath_index_t *index, const char *path, char **output);
+int	zbx_jsonobj_query_path(const zbx_jsonobj_t *obj, zbx_jsonpath_t *jsonpath, char **output);
 int	zbx_jsonobj_to_string(char **str, size_t *str_alloc, size_t *str_offset, const zbx_jsonobj_t *obj);
 const zbx_jsonobj_t *zbx_jsonobj_get_value(const zbx_jsonobj_t *obj, const char *name);
 
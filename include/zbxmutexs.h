@@ -30,6 +30,9 @@ typedef HANDLE zbx_mutex_t;
 #	define zbx_mutex_lock(mutex)		__zbx_mutex_lock(__FILE__, __LINE__, mutex)
 #	define zbx_mutex_unlock(mutex)		__zbx_mutex_unlock(__FILE__, __LINE__, mutex)
 #else	/* not _WINDOWS */
+/* number of additional history cache shard mutexes, ZBX_MUTEX_CACHE protects the first shard */
+#define ZBX_MUTEX_CACHE_SHARDS_NUM	15
+
 typedef enum
 {
 	ZBX_MUTEX_LOG = 0,
@@ -52,6 +55,9 @@ typedef enum
 	ZBX_MUTEX_REMOTE_COMMANDS,
 	ZBX_MUTEX_PROXY_BUFFER,
 	ZBX_MUTEX_VPS_MONITOR,
+	ZBX_MUTEX_CACHE_SPILL,
+	ZBX_MUTEX_CACHE_SHARD,	/* the first of ZBX_MUTEX_CACHE_SHARDS_NUM history cache shard mutexes */
+	ZBX_MUTEX_CACHE_SHARD_LAST = ZBX_MUTEX_CACHE_SHARD + ZBX_MUTEX_CACHE_SHARDS_NUM - 1,
 	/* NOTE: Do not forget to sync changes here with mutex names in diag_add_locks_info()! */
 	ZBX_MUTEX_COUNT
 }
@@ -175,8 +181,11 @@ zbx_rwlock_t	zbx_rwlock_addr_get(zbx_rwlock_name_t rwlock_name);
 int	zbx_mutex_create(zbx_mutex_t *mutex, zbx_mutex_name_t name, char **error);
 void	__zbx_mutex_lock(const char *filename, int line, zbx_mutex_t mutex);
 void	__zbx_mutex_unlock(const char *filename, int line, zbx_mutex_t mutex);
+int	__zbx_mutex_trylock(const char *filename, int line, zbx_mutex_t mutex);
 void	zbx_mutex_destroy(zbx_mutex_t *mutex);
 
+#define zbx_mutex_trylock(mutex)	__zbx_mutex_trylock(__FILE__, __LINE__, mutex)
+
 #ifdef _WINDOWS
 zbx_mutex_name_t	zbx_mutex_create_per_process_name(const zbx_mutex_name_t prefix);
 #endif
@@ -53,14 +53,16 @@ typedef enum
 }
 zbx_pp_task_type_t;
 
-typedef struct
+typedef struct zbx_pp_task	zbx_pp_task_t;
+
+struct zbx_pp_task
 {
 	zbx_pp_task_type_t	type;
 	zbx_uint64_t		itemid;
 	zbx_uint64_t		hostid;
+	zbx_pp_task_t		*next;	/* next task in the finished task stack */
 	void			*data;
-}
-zbx_pp_task_t;
+};
 
 ZBX_PTR_VECTOR_DECL(pp_task_ptr, zbx_pp_task_t *)
 
@@ -107,6 +109,8 @@ void	zbx_preprocessor_get_worker_info(zbx_process_info_t *info);
 void	zbx_preprocess_item_value(zbx_uint64_t itemid, zbx_uint64_t hostid, unsigned char item_value_type,
 		unsigned char item_flags, AGENT_RESULT *result, zbx_timespec_t *ts, unsigned char state, char *error);
 void	zbx_preprocessor_flush(void);
+void	zbx_preprocessor_set_ring_size(zbx_uint64_t size);
+void	zbx_preprocessor_set_capture(const char *file, int sample);
 int	zbx_preprocessor_get_diag_stats(zbx_uint64_t *preproc_num, zbx_uint64_t *pending_num,
 		zbx_uint64_t *finished_num, zbx_uint64_t *sequences_num, char **error);
 int	zbx_preprocessor_get_top_sequences(int limit, zbx_vector_pp_top_stats_ptr_t *stats, char **error);
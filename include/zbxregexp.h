@@ -32,6 +32,9 @@ zbx_regexp_group_check_t;
 
 typedef struct zbx_regexp zbx_regexp_t;
 
+/* regular expression or global regular expression compiled for matching many strings */
+typedef struct zbx_regexp_set zbx_regexp_set_t;
+
 typedef struct
 {
 	char		*name;
@@ -59,6 +62,7 @@ int	zbx_mregexp_sub_precompiled(const char *string, const zbx_regexp_t *regexp,
 		size_t limit, char **out);
 int	zbx_regexp_repl(const char *string, const char *pattern, const char *repl_template, char **out);
 void	zbx_regexp_clean_expressions(zbx_vector_expression_t *expressions);
+void	zbx_regexp_cache_clear(void);
 
 void	zbx_add_regexp_ex(zbx_vector_expression_t *regexps, const char *name, const char *expression,
 		int expression_type, char exp_delimiter, int case_sensitive);
@@ -71,6 +75,13 @@ int	zbx_regexp_sub_ex2(const zbx_vector_expression_t *regexps, const char *strin
 int	zbx_global_regexp_exists(const char *name, const zbx_vector_expression_t *regexps);
 void	zbx_regexp_escape(char **string);
 
+zbx_regexp_set_t	*zbx_regexp_set_create(const zbx_vector_expression_t *regexps, const char *pattern,
+		int case_sensitive);
+void	zbx_regexp_set_free(zbx_regexp_set_t *set);
+int	zbx_regexp_set_sub(zbx_regexp_set_t *set, const char *string, const char *output_template, char **output,
+		char **err_msg);
+int	zbx_regexp_set_match(zbx_regexp_set_t *set, const char *string);
+
 /* wildcards */
 void	zbx_wildcard_minimize(char *str);
 int	zbx_wildcard_match(const char *value, const char *wildcard);
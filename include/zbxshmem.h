@@ -23,16 +23,23 @@
 #define SHMEM_MAX_BUCKET_SIZE		256 /* starting from this size all free chunks are put into the same bucket */
 #define ZBX_SHMEM_BUCKET_COUNT		((SHMEM_MAX_BUCKET_SIZE - ZBX_SHMEM_MIN_BUCKET_SIZE) / 8 + 1)
 
+/* small allocations are served from slabs of fixed size objects, see memalloc.c for size classes */
+#define ZBX_SHMEM_SLAB_CLASS_COUNT	8
+
+typedef struct zbx_shmem_slab_class	zbx_shmem_slab_class_t;
+
 typedef struct
 {
 	void		*base;
 	void		**buckets;
+	zbx_shmem_slab_class_t	*slab_classes;
 	void		*lo_bound;
 	void		*hi_bound;
 	zbx_uint64_t	free_size;
 	zbx_uint64_t	used_size;
 	zbx_uint64_t	orig_size;
 	zbx_uint64_t	total_size;
+	zbx_uint64_t	page_size;	/* size of memory pages backing the segment */
 	int		shm_id;
 
 	/* Continue execution in out of memory situation.                         */
@@ -45,6 +52,15 @@ typedef struct
 }
 zbx_shmem_info_t;
 
+typedef struct
+{
+	zbx_uint64_t	object_size;
+	unsigned int	slabs_num;
+	unsigned int	objects_used;
+	unsigned int	objects_free;
+}
+zbx_shmem_slab_stats_t;
+
 typedef struct
 {
 	zbx_uint64_t	free_size;
@@ -55,6 +71,10 @@ typedef struct
 	unsigned int	chunks_num[ZBX_SHMEM_BUCKET_COUNT];
 	unsigned int	free_chunks;
 	unsigned int	used_chunks;
+	zbx_uint64_t	page_size;
+	/* memory of free objects in slabs, accounted as used by the chunk allocator */
+	zbx_uint64_t	slab_free_size;
+	zbx_shmem_slab_stats_t	slabs[ZBX_SHMEM_SLAB_CLASS_COUNT];
 }
 zbx_shmem_stats_t;
 
@@ -64,6 +84,8 @@ int	zbx_shmem_create_min(zbx_shmem_info_t **info, zbx_uint64_t size, const char
 		int allow_oom, char **error);
 void	zbx_shmem_destroy(zbx_shmem_info_t *info);
 
+void	zbx_shmem_set_huge_page_size(zbx_uint64_t size);
+
 #define	zbx_shmem_malloc(info, old, size) __zbx_shmem_malloc(__FILE__, __LINE__, info, old, size)
 #define	zbx_shmem_realloc(info, old, size) __zbx_shmem_realloc(__FILE__, __LINE__, info, old, size)
 #define	zbx_shmem_free(info, ptr)			\
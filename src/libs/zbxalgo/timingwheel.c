@@ -0,0 +1,540 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxalgo.h"
+
+/******************************************************************************
+ *                                                                            *
+ * Timing wheel layout:                                                       *
+ *                                                                            *
+ * Level N slot covers 2^(N * ZBX_TIMING_WHEEL_LEVEL_BITS) seconds. Element   *
+ * is stored on the lowest level where its time shares the upper bits with    *
+ * wheel time, so level 0 slots hold elements of a single second. Elements    *
+ * that do not fit any level are kept in the overflow slot (the last one).    *
+ * Elements scheduled before wheel time are stored in the level 0 slot of     *
+ * wheel time.                                                                *
+ *                                                                            *
+ * Wheel time is moved forward only when there are no elements left on lower  *
+ * levels, at which point the next used upper level slot is cascaded down. So *
+ * slots on each level before wheel time position are always empty.           *
+ *                                                                            *
+ * The due level 0 slot is sorted once with compare function and elements are *
+ * then removed from its beginning. Key index maps element key to its slot    *
+ * and position in the slot.                                                  *
+ *                                                                            *
+ ******************************************************************************/
+
+#define	ARRAY_GROWTH_FACTOR	3/2
+
+#define TIMING_WHEEL_LEVEL_MASK		(ZBX_TIMING_WHEEL_LEVEL_SLOTS - 1)
+#define TIMING_WHEEL_OVERFLOW_SLOT	(ZBX_TIMING_WHEEL_SLOTS - 1)
+
+/* key index value holds slot (up to 255) and position in it */
+#define TIMING_WHEEL_POS_BITS		23
+#define TIMING_WHEEL_POS_MASK		((1 << TIMING_WHEEL_POS_BITS) - 1)
+
+#define TIMING_WHEEL_INDEX(slot, pos)	(((slot) << TIMING_WHEEL_POS_BITS) | (pos))
+#define TIMING_WHEEL_INDEX_SLOT(index)	((index) >> TIMING_WHEEL_POS_BITS)
+#define TIMING_WHEEL_INDEX_POS(index)	((index) & TIMING_WHEEL_POS_MASK)
+
+/* helper functions */
+
+static int	timing_wheel_first_used(zbx_uint64_t mask)
+{
+#if defined(__GNUC__)
+	return __builtin_ctzll(mask);
+#else
+	int	pos = 0;
+
+	while (0 == (mask & 1))
+	{
+		mask >>= 1;
+		pos++;
+	}
+
+	return pos;
+#endif
+}
+
+/* returns used slot mask of the specified level starting with the specified position */
+static zbx_uint64_t	timing_wheel_used_from(const zbx_timing_wheel_t *wheel, int level, int pos)
+{
+	if (ZBX_TIMING_WHEEL_LEVEL_SLOTS <= pos)
+		return 0;
+
+	return wheel->slots_used[level] >> pos << pos;
+}
+
+static int	timing_wheel_slot_index(const zbx_timing_wheel_t *wheel, int time)
+{
+	if (time < wheel->time)
+		time = wheel->time;
+
+	for (int level = 0; level < ZBX_TIMING_WHEEL_LEVELS; level++)
+	{
+		int	shift = level * ZBX_TIMING_WHEEL_LEVEL_BITS;
+
+		if ((time >> (shift + ZBX_TIMING_WHEEL_LEVEL_BITS)) ==
+				(wheel->time >> (shift + ZBX_TIMING_WHEEL_LEVEL_BITS)))
+		{
+			return level * ZBX_TIMING_WHEEL_LEVEL_SLOTS + ((time >> shift) & TIMING_WHEEL_LEVEL_MASK);
+		}
+	}
+
+	return TIMING_WHEEL_OVERFLOW_SLOT;
+}
+
+static void	timing_wheel_set_used(zbx_timing_wheel_t *wheel, int slot_index, int used)
+{
+	zbx_uint64_t	bit;
+	int		level;
+
+	if (TIMING_WHEEL_OVERFLOW_SLOT == slot_index)
+		return;
+
+	level = slot_index / ZBX_TIMING_WHEEL_LEVEL_SLOTS;
+	bit = __UINT64_C(1) << (slot_index % ZBX_TIMING_WHEEL_LEVEL_SLOTS);
+
+	if (0 != used)
+		wheel->slots_used[level] |= bit;
+	else
+		wheel->slots_used[level] &= ~bit;
+}
+
+static int	timing_wheel_slot_min_time(const zbx_timing_wheel_slot_t *slot)
+{
+	int	time;
+
+	if (0 != slot->sorted)
+		return slot->elems[slot->elems_first].time;
+
+	time = slot->elems[slot->elems_first].time;
+
+	for (int i = slot->elems_first + 1; i < slot->elems_num; i++)
+	{
+		if (slot->elems[i].time < time)
+			time = slot->elems[i].time;
+	}
+
+	return time;
+}
+
+static void	timing_wheel_slot_reindex(zbx_timing_wheel_t *wheel, int slot_index)
+{
+	zbx_timing_wheel_slot_t	*slot = &wheel->slots[slot_index];
+
+	for (int i = slot->elems_first; i < slot->elems_num; i++)
+		zbx_hashmap_set(wheel->key_index, slot->elems[i].key, TIMING_WHEEL_INDEX(slot_index, i));
+}
+
+static void	timing_wheel_slot_ensure_free_space(zbx_timing_wheel_t *wheel, int slot_index)
+{
+	zbx_timing_wheel_slot_t	*slot = &wheel->slots[slot_index];
+	int			tmp_elems_alloc;
+
+	if (slot->elems_num < slot->elems_alloc)
+		return;
+
+	/* reuse space left by elements removed from the beginning of sorted slot */
+	if (slot->elems_first > slot->elems_alloc / 4)
+	{
+		slot->elems_num -= slot->elems_first;
+		memmove(slot->elems, slot->elems + slot->elems_first,
+				(size_t)slot->elems_num * sizeof(zbx_timing_wheel_elem_t));
+		slot->elems_first = 0;
+		timing_wheel_slot_reindex(wheel, slot_index);
+
+		return;
+	}
+
+	if (NULL == slot->elems)
+		tmp_elems_alloc = 8;
+	else
+		tmp_elems_alloc = MAX(slot->elems_alloc + 1, slot->elems_alloc * ARRAY_GROWTH_FACTOR);
+
+	if (TIMING_WHEEL_POS_MASK < tmp_elems_alloc)
+	{
+		if (TIMING_WHEEL_POS_MASK <= slot->elems_alloc)
+		{
+			zabbix_log(LOG_LEVEL_CRIT, "too many elements scheduled in a timing wheel slot");
+			exit(EXIT_FAILURE);
+		}
+
+		tmp_elems_alloc = TIMING_WHEEL_POS_MASK;
+	}
+
+	/* as with binary heap, elems_alloc is set only after successful allocation */
+	slot->elems = (zbx_timing_wheel_elem_t *)wheel->mem_realloc_func(slot->elems,
+			(size_t)tmp_elems_alloc * sizeof(zbx_timing_wheel_elem_t));
+
+	if (NULL == slot->elems)
+	{
+		THIS_SHOULD_NEVER_HAPPEN;
+		exit(EXIT_FAILURE);
+	}
+
+	slot->elems_alloc = tmp_elems_alloc;
+}
+
+static void	timing_wheel_slot_append(zbx_timing_wheel_t *wheel, const zbx_timing_wheel_elem_t *elem)
+{
+	zbx_timing_wheel_slot_t	*slot;
+	int			slot_index;
+
+	slot_index = timing_wheel_slot_index(wheel, elem->time);
+	slot = &wheel->slots[slot_index];
+
+	timing_wheel_slot_ensure_free_space(wheel, slot_index);
+
+	if (slot->elems_first == slot->elems_num)
+	{
+		slot->sorted = 1;
+		timing_wheel_set_used(wheel, slot_index, 1);
+	}
+	else if (0 != slot->sorted && (ZBX_TIMING_WHEEL_LEVEL_SLOTS <= slot_index ||
+			0 < wheel->compare_func(&slot->elems[slot->elems_num - 1], elem)))
+	{
+		/* upper level slots are never sorted, they are cascaded down before extraction */
+		slot->sorted = 0;
+	}
+
+	slot->elems[slot->elems_num] = *elem;
+	zbx_hashmap_set(wheel->key_index, elem->key, TIMING_WHEEL_INDEX(slot_index, slot->elems_num));
+	slot->elems_num++;
+}
+
+static void	timing_wheel_slot_remove(zbx_timing_wheel_t *wheel, int slot_index, int pos)
+{
+	zbx_timing_wheel_slot_t	*slot = &wheel->slots[slot_index];
+
+	if (pos == slot->elems_first)
+	{
+		slot->elems_first++;
+	}
+	else
+	{
+		if (pos != --slot->elems_num)
+		{
+			slot->elems[pos] = slot->elems[slot->elems_num];
+			zbx_hashmap_set(wheel->key_index, slot->elems[pos].key, TIMING_WHEEL_INDEX(slot_index, pos));
+			slot->sorted = 0;
+		}
+	}
+
+	if (slot->elems_first == slot->elems_num)
+	{
+		slot->elems_first = 0;
+		slot->elems_num = 0;
+		timing_wheel_set_used(wheel, slot_index, 0);
+	}
+}
+
+/* moves all slot elements to the slots matching current wheel time */
+static void	timing_wheel_slot_reschedule(zbx_timing_wheel_t *wheel, int slot_index)
+{
+	zbx_timing_wheel_slot_t	slot = wheel->slots[slot_index];
+
+	memset(&wheel->slots[slot_index], 0, sizeof(zbx_timing_wheel_slot_t));
+	timing_wheel_set_used(wheel, slot_index, 0);
+
+	for (int i = slot.elems_first; i < slot.elems_num; i++)
+		timing_wheel_slot_append(wheel, &slot.elems[i]);
+
+	wheel->mem_free_func(slot.elems);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: moves wheel time to the next used upper level slot and cascades   *
+ *          its elements down                                                 *
+ *                                                                            *
+ * Return value: SUCCEED - elements were cascaded                             *
+ *               FAIL    - wheel is empty                                     *
+ *                                                                            *
+ * Comments: must be called only when level 0 has no elements left.           *
+ *                                                                            *
+ ******************************************************************************/
+static int	timing_wheel_cascade(zbx_timing_wheel_t *wheel)
+{
+	zbx_timing_wheel_slot_t	*slot;
+
+	for (int level = 1; level < ZBX_TIMING_WHEEL_LEVELS; level++)
+	{
+		int		shift = level * ZBX_TIMING_WHEEL_LEVEL_BITS, pos;
+		zbx_uint64_t	mask;
+
+		pos = (wheel->time >> shift) & TIMING_WHEEL_LEVEL_MASK;
+
+		if (0 != (mask = timing_wheel_used_from(wheel, level, pos + 1)))
+		{
+			pos = timing_wheel_first_used(mask);
+
+			wheel->time = (wheel->time >> (shift + ZBX_TIMING_WHEEL_LEVEL_BITS) <<
+					(shift + ZBX_TIMING_WHEEL_LEVEL_BITS)) | (pos << shift);
+
+			timing_wheel_slot_reschedule(wheel, level * ZBX_TIMING_WHEEL_LEVEL_SLOTS + pos);
+
+			return SUCCEED;
+		}
+	}
+
+	slot = &wheel->slots[TIMING_WHEEL_OVERFLOW_SLOT];
+
+	if (slot->elems_first == slot->elems_num)
+		return FAIL;
+
+	wheel->time = timing_wheel_slot_min_time(slot) >> (ZBX_TIMING_WHEEL_LEVELS * ZBX_TIMING_WHEEL_LEVEL_BITS) <<
+			(ZBX_TIMING_WHEEL_LEVELS * ZBX_TIMING_WHEEL_LEVEL_BITS);
+
+	timing_wheel_slot_reschedule(wheel, TIMING_WHEEL_OVERFLOW_SLOT);
+
+	return SUCCEED;
+}
+
+static int	timing_wheel_get_index(zbx_timing_wheel_t *wheel, zbx_uint64_t key, const char *operation)
+{
+	int	index;
+
+	if (FAIL == (index = zbx_hashmap_get(wheel->key_index, key)))
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "element with key " ZBX_FS_UI64 " not found in timing wheel for %s", key,
+				operation);
+		exit(EXIT_FAILURE);
+	}
+
+	return index;
+}
+
+/* public timing wheel interface */
+
+void	zbx_timing_wheel_create(zbx_timing_wheel_t *wheel, zbx_compare_func_t compare_func)
+{
+	zbx_timing_wheel_create_ext(wheel, compare_func,
+					ZBX_DEFAULT_MEM_MALLOC_FUNC,
+					ZBX_DEFAULT_MEM_REALLOC_FUNC,
+					ZBX_DEFAULT_MEM_FREE_FUNC);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: creates timing wheel                                              *
+ *                                                                            *
+ * Parameters: wheel            - [OUT]                                       *
+ *             compare_func     - [IN] function ordering elements, must order *
+ *                                     by element time first                  *
+ *             mem_malloc_func  - [IN]                                        *
+ *             mem_realloc_func - [IN]                                        *
+ *             mem_free_func    - [IN]                                        *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_timing_wheel_create_ext(zbx_timing_wheel_t *wheel, zbx_compare_func_t compare_func,
+					zbx_mem_malloc_func_t mem_malloc_func,
+					zbx_mem_realloc_func_t mem_realloc_func,
+					zbx_mem_free_func_t mem_free_func)
+{
+	memset(wheel->slots, 0, sizeof(wheel->slots));
+	memset(wheel->slots_used, 0, sizeof(wheel->slots_used));
+	wheel->time = 0;
+	wheel->elems_num = 0;
+	wheel->compare_func = compare_func;
+
+	wheel->key_index = (zbx_hashmap_t *)mem_malloc_func(NULL, sizeof(zbx_hashmap_t));
+	zbx_hashmap_create_ext(wheel->key_index, 512,
+				ZBX_DEFAULT_UINT64_HASH_FUNC,
+				ZBX_DEFAULT_UINT64_COMPARE_FUNC,
+				mem_malloc_func,
+				mem_realloc_func,
+				mem_free_func);
+
+	wheel->mem_malloc_func = mem_malloc_func;
+	wheel->mem_realloc_func = mem_realloc_func;
+	wheel->mem_free_func = mem_free_func;
+}
+
+void	zbx_timing_wheel_destroy(zbx_timing_wheel_t *wheel)
+{
+	for (int i = 0; i < ZBX_TIMING_WHEEL_SLOTS; i++)
+	{
+		if (NULL != wheel->slots[i].elems)
+			wheel->mem_free_func(wheel->slots[i].elems);
+	}
+
+	memset(wheel->slots, 0, sizeof(wheel->slots));
+	memset(wheel->slots_used, 0, sizeof(wheel->slots_used));
+	wheel->elems_num = 0;
+	wheel->compare_func = NULL;
+
+	zbx_hashmap_destroy(wheel->key_index);
+	wheel->mem_free_func(wheel->key_index);
+	wheel->key_index = NULL;
+
+	wheel->mem_malloc_func = NULL;
+	wheel->mem_realloc_func = NULL;
+	wheel->mem_free_func = NULL;
+}
+
+int	zbx_timing_wheel_empty(const zbx_timing_wheel_t *wheel)
+{
+	return (0 == wheel->elems_num ? SUCCEED : FAIL);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets the earliest element time without modifying the wheel, so    *
+ *          it can be used under read lock                                    *
+ *                                                                            *
+ * Return value: the earliest element time or FAIL if wheel is empty          *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_timing_wheel_min_time(const zbx_timing_wheel_t *wheel)
+{
+	zbx_uint64_t	mask;
+	int		pos;
+
+	if (0 == wheel->elems_num)
+		return FAIL;
+
+	pos = wheel->time & TIMING_WHEEL_LEVEL_MASK;
+
+	if (0 != (mask = timing_wheel_used_from(wheel, 0, pos)))
+	{
+		int	first = timing_wheel_first_used(mask);
+
+		/* only the wheel time slot can contain elements scheduled at different times */
+		if (first != pos)
+			return (wheel->time & ~TIMING_WHEEL_LEVEL_MASK) | first;
+
+		return timing_wheel_slot_min_time(&wheel->slots[pos]);
+	}
+
+	for (int level = 1; level < ZBX_TIMING_WHEEL_LEVELS; level++)
+	{
+		pos = (wheel->time >> (level * ZBX_TIMING_WHEEL_LEVEL_BITS)) & TIMING_WHEEL_LEVEL_MASK;
+
+		if (0 != (mask = timing_wheel_used_from(wheel, level, pos + 1)))
+		{
+			return timing_wheel_slot_min_time(
+					&wheel->slots[level * ZBX_TIMING_WHEEL_LEVEL_SLOTS + timing_wheel_first_used(mask)]);
+		}
+	}
+
+	return timing_wheel_slot_min_time(&wheel->slots[TIMING_WHEEL_OVERFLOW_SLOT]);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets the earliest element, cascading upper level slots down and   *
+ *          sorting the due slot when necessary                               *
+ *                                                                            *
+ ******************************************************************************/
+zbx_timing_wheel_elem_t	*zbx_timing_wheel_find_min(zbx_timing_wheel_t *wheel)
+{
+	if (0 == wheel->elems_num)
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "asking for a minimum in an empty timing wheel");
+		exit(EXIT_FAILURE);
+	}
+
+	while (1)
+	{
+		zbx_timing_wheel_slot_t	*slot;
+		zbx_uint64_t		mask;
+		int			slot_index;
+
+		if (0 == (mask = timing_wheel_used_from(wheel, 0, wheel->time & TIMING_WHEEL_LEVEL_MASK)))
+		{
+			if (SUCCEED != timing_wheel_cascade(wheel))
+			{
+				THIS_SHOULD_NEVER_HAPPEN;
+				exit(EXIT_FAILURE);
+			}
+
+			continue;
+		}
+
+		slot_index = timing_wheel_first_used(mask);
+		slot = &wheel->slots[slot_index];
+
+		if (0 == slot->sorted)
+		{
+			qsort(slot->elems + slot->elems_first, (size_t)(slot->elems_num - slot->elems_first),
+					sizeof(zbx_timing_wheel_elem_t), wheel->compare_func);
+			timing_wheel_slot_reindex(wheel, slot_index);
+			slot->sorted = 1;
+		}
+
+		return &slot->elems[slot->elems_first];
+	}
+}
+
+void	zbx_timing_wheel_insert(zbx_timing_wheel_t *wheel, const zbx_timing_wheel_elem_t *elem)
+{
+	if (FAIL != zbx_hashmap_get(wheel->key_index, elem->key))
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "inserting a duplicate key into a timing wheel");
+		exit(EXIT_FAILURE);
+	}
+
+	/* empty wheel can be moved back without breaking slot order */
+	if (0 == wheel->elems_num && (0 == wheel->time || elem->time < wheel->time))
+		wheel->time = elem->time;
+
+	timing_wheel_slot_append(wheel, elem);
+	wheel->elems_num++;
+}
+
+void	zbx_timing_wheel_update_direct(zbx_timing_wheel_t *wheel, const zbx_timing_wheel_elem_t *elem)
+{
+	int	index;
+
+	index = timing_wheel_get_index(wheel, elem->key, "update");
+
+	timing_wheel_slot_remove(wheel, TIMING_WHEEL_INDEX_SLOT(index), TIMING_WHEEL_INDEX_POS(index));
+	timing_wheel_slot_append(wheel, elem);
+}
+
+void	zbx_timing_wheel_remove_min(zbx_timing_wheel_t *wheel)
+{
+	zbx_timing_wheel_elem_t	*min;
+
+	min = zbx_timing_wheel_find_min(wheel);
+
+	zbx_timing_wheel_remove_direct(wheel, min->key);
+}
+
+void	zbx_timing_wheel_remove_direct(zbx_timing_wheel_t *wheel, zbx_uint64_t key)
+{
+	int	index;
+
+	index = timing_wheel_get_index(wheel, key, "remove");
+
+	zbx_hashmap_remove(wheel->key_index, key);
+	timing_wheel_slot_remove(wheel, TIMING_WHEEL_INDEX_SLOT(index), TIMING_WHEEL_INDEX_POS(index));
+	wheel->elems_num--;
+}
+
+void	zbx_timing_wheel_clear(zbx_timing_wheel_t *wheel)
+{
+	for (int i = 0; i < ZBX_TIMING_WHEEL_SLOTS; i++)
+	{
+		wheel->slots[i].elems_first = 0;
+		wheel->slots[i].elems_num = 0;
+	}
+
+	memset(wheel->slots_used, 0, sizeof(wheel->slots_used));
+	wheel->time = 0;
+	wheel->elems_num = 0;
+
+	zbx_hashmap_clear(wheel->key_index);
+}
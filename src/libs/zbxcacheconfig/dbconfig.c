@@ -155,9 +155,18 @@ int	zbx_get_sync_in_progress(void)
 	return sync_in_progress;
 }
 
-#define START_SYNC	do { WRLOCK_CACHE_CONFIG_HISTORY; WRLOCK_CACHE; sync_in_progress = 1; } while(0)
+static double	sync_lock_time;
+static int	sync_yields_num;
+
+#define START_SYNC	do { WRLOCK_CACHE_CONFIG_HISTORY; WRLOCK_CACHE; sync_in_progress = 1;			\
+			sync_lock_time = zbx_time(); } while(0)
 #define FINISH_SYNC	do { sync_in_progress = 0; UNLOCK_CACHE; UNLOCK_CACHE_CONFIG_HISTORY; } while(0)
 
+/* number of changeset rows applied between lock hold time checks */
+#define ZBX_DC_SYNC_YIELD_ROWS		1000
+/* maximum time configuration cache is kept write locked while applying large changesets */
+#define ZBX_DC_SYNC_YIELD_PERIOD	0.05
+
 #define ZBX_SNMP_OID_TYPE_NORMAL	0
 #define ZBX_SNMP_OID_TYPE_DYNAMIC	1
 #define ZBX_SNMP_OID_TYPE_MACRO		2
@@ -965,7 +974,7 @@ int	dc_strpool_replace(int found, const char **curr, const char *new_str)
 
 static void	DCupdate_item_queue(ZBX_DC_ITEM *item, unsigned char old_poller_type, int old_nextcheck)
 {
-	zbx_binary_heap_elem_t	elem;
+	zbx_timing_wheel_elem_t	elem;
 
 	if (ZBX_LOC_POLLER == item->location)
 		return;
@@ -973,7 +982,7 @@ static void	DCupdate_item_queue(ZBX_DC_ITEM *item, unsigned char old_poller_type
 	if (ZBX_LOC_QUEUE == item->location && old_poller_type != item->poller_type)
 	{
 		item->location = ZBX_LOC_NOWHERE;
-		zbx_binary_heap_remove_direct(&config->queues[old_poller_type], item->itemid);
+		zbx_timing_wheel_remove_direct(&config->queues[old_poller_type], item->itemid);
 	}
 
 	if (item->poller_type == ZBX_NO_POLLER)
@@ -984,19 +993,20 @@ static void	DCupdate_item_queue(ZBX_DC_ITEM *item, unsigned char old_poller_type
 
 	elem.key = item->itemid;
 	elem.data = (void *)item;
+	elem.time = item->nextcheck;
 
 	if (ZBX_LOC_QUEUE != item->location)
 	{
 		item->location = ZBX_LOC_QUEUE;
-		zbx_binary_heap_insert(&config->queues[item->poller_type], &elem);
+		zbx_timing_wheel_insert(&config->queues[item->poller_type], &elem);
 	}
 	else
-		zbx_binary_heap_update_direct(&config->queues[item->poller_type], &elem);
+		zbx_timing_wheel_update_direct(&config->queues[item->poller_type], &elem);
 }
 
 static void	DCupdate_proxy_queue(ZBX_DC_PROXY *proxy)
 {
-	zbx_binary_heap_elem_t	elem;
+	zbx_timing_wheel_elem_t	elem;
 
 	if (ZBX_LOC_POLLER == proxy->location)
 		return;
@@ -1009,14 +1019,15 @@ static void	DCupdate_proxy_queue(ZBX_DC_PROXY *proxy)
 
 	elem.key = proxy->proxyid;
 	elem.data = (void *)proxy;
+	elem.time = proxy->nextcheck;
 
 	if (ZBX_LOC_QUEUE != proxy->location)
 	{
 		proxy->location = ZBX_LOC_QUEUE;
-		zbx_binary_heap_insert(&config->pqueue, &elem);
+		zbx_timing_wheel_insert(&config->pqueue, &elem);
 	}
 	else
-		zbx_binary_heap_update_direct(&config->pqueue, &elem);
+		zbx_timing_wheel_update_direct(&config->pqueue, &elem);
 }
 
 /******************************************************************************
@@ -1718,7 +1729,7 @@ static void	DCsync_proxy_remove(ZBX_DC_PROXY *proxy)
 
 	if (ZBX_LOC_QUEUE == proxy->location)
 	{
-		zbx_binary_heap_remove_direct(&config->pqueue, proxy->proxyid);
+		zbx_timing_wheel_remove_direct(&config->pqueue, proxy->proxyid);
 		proxy->location = ZBX_LOC_NOWHERE;
 	}
 
@@ -3629,6 +3640,55 @@ static void	process_zero_pollers_items(ZBX_DC_ITEM *item)
 	}
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: temporarily releases configuration cache locks if they were held  *
+ *          too long to let other processes access cache                      *
+ *                                                                            *
+ * Comments: Can be called only when the cache is consistent - all tables     *
+ *           which rows reference each other are fully synced.                *
+ *                                                                            *
+ ******************************************************************************/
+static void	dc_sync_release_lock(void)
+{
+	struct timespec	delay = {0, 1000000};
+
+	if (ZBX_DC_SYNC_YIELD_PERIOD > zbx_time() - sync_lock_time)
+		return;
+
+	FINISH_SYNC;
+
+	/* give processes waiting for the lock time to acquire it */
+	nanosleep(&delay, NULL);
+	sync_yields_num++;
+
+	START_SYNC;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: temporarily releases configuration cache locks when applying      *
+ *          large changeset to let other processes access cache               *
+ *                                                                            *
+ * Parameters: rows_num - [IN/OUT] the number of rows applied since the last  *
+ *                                 lock hold time check                       *
+ *                                                                            *
+ * Comments: Can be called only between added/updated changeset rows of       *
+ *           tables which rows are independent from each other, so the cache  *
+ *           is consistent when lock is released. Removed rows must be        *
+ *           applied without releasing lock.                                  *
+ *                                                                            *
+ ******************************************************************************/
+static void	dc_sync_yield(int *rows_num)
+{
+	if (ZBX_DC_SYNC_YIELD_ROWS > ++(*rows_num))
+		return;
+
+	*rows_num = 0;
+
+	dc_sync_release_lock();
+}
+
 static void	DCsync_items(zbx_dbsync_t *sync, zbx_uint64_t revision, int flags, zbx_synced_new_config_t synced,
 		zbx_vector_uint64_t *deleted_itemids, zbx_vector_dc_item_ptr_t *new_items)
 {
@@ -4046,7 +4106,7 @@ static void	DCsync_items(zbx_dbsync_t *sync, zbx_uint64_t revision, int flags, z
 		}
 
 		if (ZBX_LOC_QUEUE == item->location)
-			zbx_binary_heap_remove_direct(&config->queues[item->poller_type], item->itemid);
+			zbx_timing_wheel_remove_direct(&config->queues[item->poller_type], item->itemid);
 
 		dc_strpool_release(item->key);
 		dc_strpool_release(item->error);
@@ -4766,7 +4826,7 @@ static void	DCsync_functions(zbx_dbsync_t *sync, zbx_uint64_t revision)
 	ZBX_DC_FUNCTION		*function;
 
 	zbx_hashset_uniq_t	uniq = ZBX_HASHSET_UNIQ_FALSE;
-	int			found, ret;
+	int			found, ret, rows_num = 0;
 	zbx_uint64_t		itemid, functionid, triggerid;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
@@ -4787,6 +4847,8 @@ static void	DCsync_functions(zbx_dbsync_t *sync, zbx_uint64_t revision)
 		if (ZBX_DBSYNC_ROW_REMOVE == tag)
 			break;
 
+		dc_sync_yield(&rows_num);
+
 		ZBX_STR2UINT64(itemid, row[1]);
 		ZBX_STR2UINT64(functionid, row[0]);
 		ZBX_STR2UINT64(triggerid, row[4]);
@@ -7726,7 +7788,7 @@ static void	DCsync_proxies(zbx_dbsync_t *sync, zbx_uint64_t revision, const zbx_
 		}
 		else if (PROXY_OPERATING_MODE_ACTIVE == mode && ZBX_LOC_QUEUE == proxy->location)
 		{
-			zbx_binary_heap_remove_direct(&config->pqueue, proxy->proxyid);
+			zbx_timing_wheel_remove_direct(&config->pqueue, proxy->proxyid);
 			proxy->location = ZBX_LOC_NOWHERE;
 		}
 
@@ -7943,6 +8005,8 @@ zbx_uint64_t	zbx_dc_sync_configuration(unsigned char mode, zbx_synced_new_config
 	else
 		pg_host_reloc_ref = NULL;
 
+	sync_yields_num = 0;
+
 	sec = zbx_time();
 	changelog_num = zbx_dbsync_env_prepare(changelog_sync_mode);
 	changelog_sec = zbx_time() - sec;
@@ -8192,6 +8256,10 @@ zbx_uint64_t	zbx_dc_sync_configuration(unsigned char mode, zbx_synced_new_config
 	/* relies on items, must be after DCsync_items() */
 	DCsync_items_param(&itemscrp_sync, new_revision);
 
+	/* items are synced together with their preprocessing and parameters, */
+	/* so the lock can be released before syncing functions               */
+	dc_sync_release_lock();
+
 	DCsync_functions(&func_sync, new_revision);
 
 	FINISH_SYNC;
@@ -8255,6 +8323,10 @@ zbx_uint64_t	zbx_dc_sync_configuration(unsigned char mode, zbx_synced_new_config
 
 	DCsync_item_tags(&item_tag_sync);
 
+	/* triggers are synced together with their dependencies and tags, */
+	/* so the lock can be released before syncing correlations        */
+	dc_sync_release_lock();
+
 	DCsync_correlations(&correlation_sync);
 
 	/* relies on correlation rules, must be after DCsync_correlations() */
@@ -8328,6 +8400,8 @@ zbx_uint64_t	zbx_dc_sync_configuration(unsigned char mode, zbx_synced_new_config
 		zabbix_log(LOG_LEVEL_DEBUG, "%s() reindex    : " ZBX_FS_DBL " sec " ZBX_FS_I64 " bytes.", __func__,
 				update_sec, update_size);
 
+		zabbix_log(LOG_LEVEL_DEBUG, "%s() lock yields: %d", __func__, sync_yields_num);
+
 		zbx_dcsync_stats_dump(__func__);
 
 		zabbix_log(LOG_LEVEL_DEBUG, "%s() proxies    : %d (%d slots)", __func__,
@@ -8434,12 +8508,10 @@ zbx_uint64_t	zbx_dc_sync_configuration(unsigned char mode, zbx_synced_new_config
 
 		for (i = 0; ZBX_POLLER_TYPE_COUNT > i; i++)
 		{
-			zabbix_log(LOG_LEVEL_DEBUG, "%s() queue[%d]   : %d (%d allocated)", __func__,
-					i, config->queues[i].elems_num, config->queues[i].elems_alloc);
+			zabbix_log(LOG_LEVEL_DEBUG, "%s() queue[%d]   : %d", __func__, i, config->queues[i].elems_num);
 		}
 
-		zabbix_log(LOG_LEVEL_DEBUG, "%s() pqueue     : %d (%d allocated)", __func__,
-				config->pqueue.elems_num, config->pqueue.elems_alloc);
+		zabbix_log(LOG_LEVEL_DEBUG, "%s() pqueue     : %d", __func__, config->pqueue.elems_num);
 
 		zabbix_log(LOG_LEVEL_DEBUG, "%s() timer queue: %d (%d allocated)", __func__,
 				config->trigger_queue.elems_num, config->trigger_queue.elems_alloc);
@@ -8726,10 +8798,10 @@ static int	__config_snmp_item_compare(const ZBX_DC_ITEM *i1, const ZBX_DC_ITEM *
 	return 0;
 }
 
-static int	__config_heap_elem_compare(const void *d1, const void *d2)
+static int	__config_queue_elem_compare(const void *d1, const void *d2)
 {
-	const zbx_binary_heap_elem_t	*e1 = (const zbx_binary_heap_elem_t *)d1;
-	const zbx_binary_heap_elem_t	*e2 = (const zbx_binary_heap_elem_t *)d2;
+	const zbx_timing_wheel_elem_t	*e1 = (const zbx_timing_wheel_elem_t *)d1;
+	const zbx_timing_wheel_elem_t	*e2 = (const zbx_timing_wheel_elem_t *)d2;
 
 	const ZBX_DC_ITEM		*i1 = (const ZBX_DC_ITEM *)e1->data;
 	const ZBX_DC_ITEM		*i2 = (const ZBX_DC_ITEM *)e2->data;
@@ -8755,8 +8827,8 @@ static int	__config_heap_elem_compare(const void *d1, const void *d2)
 
 static int	__config_pinger_elem_compare(const void *d1, const void *d2)
 {
-	const zbx_binary_heap_elem_t	*e1 = (const zbx_binary_heap_elem_t *)d1;
-	const zbx_binary_heap_elem_t	*e2 = (const zbx_binary_heap_elem_t *)d2;
+	const zbx_timing_wheel_elem_t	*e1 = (const zbx_timing_wheel_elem_t *)d1;
+	const zbx_timing_wheel_elem_t	*e2 = (const zbx_timing_wheel_elem_t *)d2;
 
 	const ZBX_DC_ITEM		*i1 = (const ZBX_DC_ITEM *)e1->data;
 	const ZBX_DC_ITEM		*i2 = (const ZBX_DC_ITEM *)e2->data;
@@ -8787,8 +8859,8 @@ static int	__config_java_item_compare(const ZBX_DC_ITEM *i1, const ZBX_DC_ITEM *
 
 static int	__config_java_elem_compare(const void *d1, const void *d2)
 {
-	const zbx_binary_heap_elem_t	*e1 = (const zbx_binary_heap_elem_t *)d1;
-	const zbx_binary_heap_elem_t	*e2 = (const zbx_binary_heap_elem_t *)d2;
+	const zbx_timing_wheel_elem_t	*e1 = (const zbx_timing_wheel_elem_t *)d1;
+	const zbx_timing_wheel_elem_t	*e2 = (const zbx_timing_wheel_elem_t *)d2;
 
 	const ZBX_DC_ITEM		*i1 = (const ZBX_DC_ITEM *)e1->data;
 	const ZBX_DC_ITEM		*i2 = (const ZBX_DC_ITEM *)e2->data;
@@ -8801,8 +8873,8 @@ static int	__config_java_elem_compare(const void *d1, const void *d2)
 
 static int	__config_proxy_compare(const void *d1, const void *d2)
 {
-	const zbx_binary_heap_elem_t	*e1 = (const zbx_binary_heap_elem_t *)d1;
-	const zbx_binary_heap_elem_t	*e2 = (const zbx_binary_heap_elem_t *)d2;
+	const zbx_timing_wheel_elem_t	*e1 = (const zbx_timing_wheel_elem_t *)d1;
+	const zbx_timing_wheel_elem_t	*e2 = (const zbx_timing_wheel_elem_t *)d2;
 
 	const ZBX_DC_PROXY		*p1 = (const ZBX_DC_PROXY *)e1->data;
 	const ZBX_DC_PROXY		*p2 = (const ZBX_DC_PROXY *)e2->data;
@@ -9047,25 +9119,22 @@ int	zbx_init_configuration_cache(zbx_get_program_type_f get_program_type, zbx_ge
 		switch (i)
 		{
 			case ZBX_POLLER_TYPE_JAVA:
-				zbx_binary_heap_create_ext(&config->queues[i],
+				zbx_timing_wheel_create_ext(&config->queues[i],
 						__config_java_elem_compare,
-						ZBX_BINARY_HEAP_OPTION_DIRECT,
 						__config_shmem_malloc_func,
 						__config_shmem_realloc_func,
 						__config_shmem_free_func);
 				break;
 			case ZBX_POLLER_TYPE_PINGER:
-				zbx_binary_heap_create_ext(&config->queues[i],
+				zbx_timing_wheel_create_ext(&config->queues[i],
 						__config_pinger_elem_compare,
-						ZBX_BINARY_HEAP_OPTION_DIRECT,
 						__config_shmem_malloc_func,
 						__config_shmem_realloc_func,
 						__config_shmem_free_func);
 				break;
 			default:
-				zbx_binary_heap_create_ext(&config->queues[i],
-						__config_heap_elem_compare,
-						ZBX_BINARY_HEAP_OPTION_DIRECT,
+				zbx_timing_wheel_create_ext(&config->queues[i],
+						__config_queue_elem_compare,
 						__config_shmem_malloc_func,
 						__config_shmem_realloc_func,
 						__config_shmem_free_func);
@@ -9073,9 +9142,8 @@ int	zbx_init_configuration_cache(zbx_get_program_type_f get_program_type, zbx_ge
 		}
 	}
 
-	zbx_binary_heap_create_ext(&config->pqueue,
+	zbx_timing_wheel_create_ext(&config->pqueue,
 					__config_proxy_compare,
-					ZBX_BINARY_HEAP_OPTION_DIRECT,
 					__config_shmem_malloc_func,
 					__config_shmem_realloc_func,
 					__config_shmem_free_func);
@@ -10701,7 +10769,7 @@ int	zbx_dc_config_lock_triggers_by_history_items(zbx_vector_hc_item_ptr_t *histo
 	{
 		history_item = history_items->values[i];
 
-		if (0 != (ZBX_DC_FLAG_NOVALUE & history_item->tail->flags))
+		if (0 != (ZBX_DC_FLAG_NOVALUE & history_item->tail->values[history_item->tail->first].flags))
 			continue;
 
 		if (NULL == (dc_item = (ZBX_DC_ITEM *)zbx_hashset_search(&config->items, &history_item->itemid)))
@@ -11496,23 +11564,9 @@ int	zbx_dc_get_interface_value_itemid(zbx_uint64_t itemid, char **replace_to, in
  * Return value: nextcheck or FAIL if no items for the specified queue        *
  *                                                                            *
  ******************************************************************************/
-static int	dc_config_get_queue_nextcheck(zbx_binary_heap_t *queue)
+static int	dc_config_get_queue_nextcheck(const zbx_timing_wheel_t *queue)
 {
-	int				nextcheck;
-	const zbx_binary_heap_elem_t	*min;
-	const ZBX_DC_ITEM		*dc_item;
-
-	if (FAIL == zbx_binary_heap_empty(queue))
-	{
-		min = zbx_binary_heap_find_min(queue);
-		dc_item = (const ZBX_DC_ITEM *)min->data;
-
-		nextcheck = dc_item->nextcheck;
-	}
-	else
-		nextcheck = FAIL;
-
-	return nextcheck;
+	return zbx_timing_wheel_min_time(queue);
 }
 
 /******************************************************************************
@@ -11527,7 +11581,7 @@ static int	dc_config_get_queue_nextcheck(zbx_binary_heap_t *queue)
 int	zbx_dc_config_get_poller_nextcheck(unsigned char poller_type)
 {
 	int			nextcheck;
-	zbx_binary_heap_t	*queue;
+	zbx_timing_wheel_t	*queue;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() poller_type:%d", __func__, (int)poller_type);
 
@@ -11612,7 +11666,7 @@ int	zbx_dc_config_get_poller_items(unsigned char poller_type, int config_timeout
 		int config_max_concurrent_checks, zbx_dc_item_t **items)
 {
 	int			now, num = 0, max_items, items_alloc = 0;
-	zbx_binary_heap_t	*queue;
+	zbx_timing_wheel_t	*queue;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() poller_type:%d", __func__, (int)poller_type);
 
@@ -11643,16 +11697,16 @@ int	zbx_dc_config_get_poller_items(unsigned char poller_type, int config_timeout
 
 	WRLOCK_CACHE;
 
-	while (num < max_items && FAIL == zbx_binary_heap_empty(queue))
+	while (num < max_items && FAIL == zbx_timing_wheel_empty(queue))
 	{
 		int				disable_until;
-		const zbx_binary_heap_elem_t	*min;
+		const zbx_timing_wheel_elem_t	*min;
 		ZBX_DC_HOST			*dc_host;
 		ZBX_DC_INTERFACE		*dc_interface;
 		ZBX_DC_ITEM			*dc_item;
 		static const ZBX_DC_ITEM	*dc_item_prev = NULL;
 
-		min = zbx_binary_heap_find_min(queue);
+		min = zbx_timing_wheel_find_min(queue);
 		dc_item = (ZBX_DC_ITEM *)min->data;
 
 		if (dc_item->nextcheck > now)
@@ -11675,7 +11729,7 @@ int	zbx_dc_config_get_poller_items(unsigned char poller_type, int config_timeout
 			}
 		}
 
-		zbx_binary_heap_remove_min(queue);
+		zbx_timing_wheel_remove_min(queue);
 		dc_item->location = ZBX_LOC_NOWHERE;
 
 		if (NULL == (dc_host = (ZBX_DC_HOST *)zbx_hashset_search(&config->hosts, &dc_item->hostid)))
@@ -11778,7 +11832,7 @@ int	zbx_dc_config_get_ipmi_poller_items(int now, int items_num, int config_timeo
 		int *nextcheck)
 {
 	int			num = 0;
-	zbx_binary_heap_t	*queue;
+	zbx_timing_wheel_t	*queue;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
@@ -11786,21 +11840,21 @@ int	zbx_dc_config_get_ipmi_poller_items(int now, int items_num, int config_timeo
 
 	WRLOCK_CACHE;
 
-	while (num < items_num && FAIL == zbx_binary_heap_empty(queue))
+	while (num < items_num && FAIL == zbx_timing_wheel_empty(queue))
 	{
 		int				disable_until;
-		const zbx_binary_heap_elem_t	*min;
+		const zbx_timing_wheel_elem_t	*min;
 		ZBX_DC_HOST			*dc_host;
 		ZBX_DC_INTERFACE		*dc_interface;
 		ZBX_DC_ITEM			*dc_item;
 
-		min = zbx_binary_heap_find_min(queue);
+		min = zbx_timing_wheel_find_min(queue);
 		dc_item = (ZBX_DC_ITEM *)min->data;
 
 		if (dc_item->nextcheck > now)
 			break;
 
-		zbx_binary_heap_remove_min(queue);
+		zbx_timing_wheel_remove_min(queue);
 		dc_item->location = ZBX_LOC_NOWHERE;
 
 		if (NULL == (dc_host = (ZBX_DC_HOST *)zbx_hashset_search(&config->hosts, &dc_item->hostid)))
@@ -12715,6 +12769,9 @@ void	*zbx_dc_config_get_stats(int request)
 		case ZBX_CONFSTATS_BUFFER_PFREE:
 			value_double = 100 * (double)config_mem->free_size / config_mem->orig_size;
 			return &value_double;
+		case ZBX_CONFSTATS_BUFFER_PAGESIZE:
+			value_uint = config_mem->page_size;
+			return &value_uint;
 		default:
 			return NULL;
 	}
@@ -12796,7 +12853,7 @@ int	zbx_dc_config_get_proxypoller_hosts(zbx_dc_proxy_t *proxies, int max_hosts)
 {
 	time_t			now;
 	int			num = 0;
-	zbx_binary_heap_t	*queue;
+	zbx_timing_wheel_t	*queue;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
@@ -12806,18 +12863,18 @@ int	zbx_dc_config_get_proxypoller_hosts(zbx_dc_proxy_t *proxies, int max_hosts)
 
 	WRLOCK_CACHE;
 
-	while (num < max_hosts && FAIL == zbx_binary_heap_empty(queue))
+	while (num < max_hosts && FAIL == zbx_timing_wheel_empty(queue))
 	{
-		const zbx_binary_heap_elem_t	*min;
+		const zbx_timing_wheel_elem_t	*min;
 		ZBX_DC_PROXY			*dc_proxy;
 
-		min = zbx_binary_heap_find_min(queue);
+		min = zbx_timing_wheel_find_min(queue);
 		dc_proxy = (ZBX_DC_PROXY *)min->data;
 
 		if (dc_proxy->nextcheck > now)
 			break;
 
-		zbx_binary_heap_remove_min(queue);
+		zbx_timing_wheel_remove_min(queue);
 		dc_proxy->location = ZBX_LOC_POLLER;
 
 		DCget_proxy(&proxies[num], dc_proxy);
@@ -12841,7 +12898,7 @@ int	zbx_dc_config_get_proxypoller_hosts(zbx_dc_proxy_t *proxies, int max_hosts)
 int	zbx_dc_config_get_proxypoller_nextcheck(void)
 {
 	int			nextcheck;
-	zbx_binary_heap_t	*queue;
+	zbx_timing_wheel_t	*queue;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
@@ -12849,18 +12906,7 @@ int	zbx_dc_config_get_proxypoller_nextcheck(void)
 
 	RDLOCK_CACHE;
 
-	if (FAIL == zbx_binary_heap_empty(queue))
-	{
-		const zbx_binary_heap_elem_t	*min;
-		const ZBX_DC_PROXY		*dc_proxy;
-
-		min = zbx_binary_heap_find_min(queue);
-		dc_proxy = (const ZBX_DC_PROXY *)min->data;
-
-		nextcheck = dc_proxy->nextcheck;
-	}
-	else
-		nextcheck = FAIL;
+	nextcheck = zbx_timing_wheel_min_time(queue);
 
 	UNLOCK_CACHE;
 
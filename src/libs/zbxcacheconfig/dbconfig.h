@@ -1047,8 +1047,8 @@ typedef struct
 	zbx_hashset_t		host_proxy;
 	zbx_hashset_t		host_proxy_index;
 	zbx_hashset_t		sessions[ZBX_SESSION_TYPE_COUNT];
-	zbx_binary_heap_t	queues[ZBX_POLLER_TYPE_COUNT];
-	zbx_binary_heap_t	pqueue;
+	zbx_timing_wheel_t	queues[ZBX_POLLER_TYPE_COUNT];
+	zbx_timing_wheel_t	pqueue;
 	zbx_binary_heap_t	trigger_queue;
 	zbx_binary_heap_t	drule_queue;
 	zbx_binary_heap_t	httptest_queue;		/* web scenario queue */
@@ -53,10 +53,34 @@
 #define ZBX_DBSYNC_OBJ_PROXY		19
 #define ZBX_DBSYNC_OBJ_PROXY_GROUP	20
 #define ZBX_DBSYNC_OBJ_HOST_PROXY	21
+#define ZBX_DBSYNC_OBJ_GLOBALMACRO	22
+#define ZBX_DBSYNC_OBJ_HOSTMACRO	23
+#define ZBX_DBSYNC_OBJ_INTERFACE	24
+#define ZBX_DBSYNC_OBJ_INTERFACE_SNMP	25
+#define ZBX_DBSYNC_OBJ_HOST_INVENTORY	26
+#define ZBX_DBSYNC_OBJ_HOSTS_TEMPLATES	27
+#define ZBX_DBSYNC_OBJ_ACTIONS		28
+#define ZBX_DBSYNC_OBJ_OPERATIONS	29
+#define ZBX_DBSYNC_OBJ_CONDITIONS	30
+#define ZBX_DBSYNC_OBJ_CORRELATION	31
+#define ZBX_DBSYNC_OBJ_CORR_CONDITION	32
+#define ZBX_DBSYNC_OBJ_CORR_CONDITION_TAG	33
+#define ZBX_DBSYNC_OBJ_CORR_CONDITION_GROUP	34
+#define ZBX_DBSYNC_OBJ_CORR_CONDITION_TAGPAIR	35
+#define ZBX_DBSYNC_OBJ_CORR_CONDITION_TAGVALUE	36
+#define ZBX_DBSYNC_OBJ_CORR_OPERATION	37
+#define ZBX_DBSYNC_OBJ_MAINTENANCE	38
+#define ZBX_DBSYNC_OBJ_MAINTENANCE_WINDOW	39
+#define ZBX_DBSYNC_OBJ_TIMEPERIOD	40
+#define ZBX_DBSYNC_OBJ_MAINTENANCE_TAG	41
+#define ZBX_DBSYNC_OBJ_MAINTENANCE_GROUP	42
+#define ZBX_DBSYNC_OBJ_MAINTENANCE_HOST	43
+#define ZBX_DBSYNC_OBJ_HSTGRP		44
 /* number of dbsync objects - keep in sync with above defines */
-#define ZBX_DBSYNC_OBJ_COUNT		21
+#define ZBX_DBSYNC_OBJ_COUNT		44
 
 #define ZBX_DBSYNC_JOURNAL(X)		(X - 1)
+#define ZBX_DBSYNC_OBJ_MASK(X)		(__UINT64_C(1) << ZBX_DBSYNC_JOURNAL(X))
 
 #define ZBX_DBSYNC_CHANGELOG_PRUNE_INTERVAL	SEC_PER_MIN * 10
 #define ZBX_DBSYNC_CHANGELOG_MAX_AGE		SEC_PER_HOUR
@@ -94,6 +118,9 @@ typedef struct
 
 	zbx_vector_dbsync_t 			syncs;
 	zbx_vector_dbsync_obj_changelog_t	changelog;
+
+	/* the object table is compared in full, all changelog records are processed by the sync */
+	unsigned char				full_sync;
 }
 zbx_dbsync_journal_t;
 
@@ -104,6 +131,7 @@ typedef struct
 
 	zbx_hashset_t			changelog;
 
+	unsigned char			mode;
 	zbx_dbsync_journal_t		journals[ZBX_DBSYNC_OBJ_COUNT];
 
 	zbx_vector_dbsync_t		changelog_dbsyncs;
@@ -303,6 +331,62 @@ static char	**dbsync_preproc_row(zbx_dbsync_t *sync, char **row)
 	return sync->row;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if table comparison can be skipped because no changes     *
+ *          were registered in changelog for the compared objects            *
+ *                                                                            *
+ * Parameters: sync             - [IN] the changeset                          *
+ *             columns_num      - [IN] the number of columns in the changeset *
+ *             preproc_row_func - [IN] the row preprocessing callback         *
+ *             objects          - [IN] the compared objects                   *
+ *                                     (ZBX_DBSYNC_OBJ_MASK() bitmask)        *
+ *             parents          - [IN] the objects which removal is cascaded  *
+ *                                     to the compared objects                *
+ *                                                                            *
+ * Return value: SUCCEED - the changeset was prepared without changes         *
+ *               FAIL    - table must be compared with cached data            *
+ *                                                                            *
+ * Comments: The compared tables are read in full when changed, so all their  *
+ *           changelog records are marked as processed by this sync.          *
+ *           MySQL does not fire triggers on cascaded deletes, so removal of  *
+ *           parent objects must force the comparison.                        *
+ *                                                                            *
+ ******************************************************************************/
+static int	dbsync_check_unchanged(zbx_dbsync_t *sync, int columns_num,
+		zbx_dbsync_preproc_row_func_t preproc_row_func, zbx_uint64_t objects, zbx_uint64_t parents)
+{
+	int	i, ret = SUCCEED;
+
+	if (ZBX_DBSYNC_UPDATE != sync->mode || ZBX_DBSYNC_UPDATE != dbsync_env.mode)
+		return FAIL;
+
+	for (i = 0; i < ZBX_DBSYNC_OBJ_COUNT; i++)
+	{
+		zbx_dbsync_journal_t	*journal = &dbsync_env.journals[i];
+		zbx_uint64_t		mask = __UINT64_C(1) << i;
+
+		if (0 != (objects & mask))
+		{
+			journal->full_sync = 1;
+
+			if (0 != journal->changelog.values_num)
+				ret = FAIL;
+		}
+
+		if (0 != (parents & mask) && 0 != journal->deletes.values_num)
+			ret = FAIL;
+	}
+
+	if (SUCCEED == ret)
+	{
+		dbsync_prepare(sync, columns_num, preproc_row_func);
+		zbx_dcsync_sql_end(sync);
+	}
+
+	return ret;
+}
+
 static void	dbsync_journal_init(zbx_dbsync_journal_t *journal)
 {
 	zbx_vector_uint64_create(&journal->inserts);
@@ -312,6 +396,8 @@ static void	dbsync_journal_init(zbx_dbsync_journal_t *journal)
 	zbx_vector_dbsync_create(&journal->syncs);
 
 	zbx_vector_dbsync_obj_changelog_create(&journal->changelog);
+
+	journal->full_sync = 0;
 }
 
 static void	dbsync_journal_destroy(zbx_dbsync_journal_t *journal)
@@ -445,6 +531,8 @@ int	zbx_dbsync_env_prepare(unsigned char mode)
 
 	zbx_hashset_create(&dbsync_env.strpool, 100, dbsync_strpool_hash_func, dbsync_strpool_compare_func);
 
+	dbsync_env.mode = mode;
+
 	for (i = 0; i < ARRSIZE(dbsync_env.journals); i++)
 		dbsync_journal_init(&dbsync_env.journals[i]);
 
@@ -530,6 +618,17 @@ static void	dbsync_env_flush_journal(zbx_dbsync_journal_t *journal)
 	if (0 == journal->changelog.values_num)
 		return;
 
+	if (0 != journal->full_sync)
+	{
+		for (i = 0; i < journal->changelog.values_num; i++)
+		{
+			zbx_hashset_insert(&dbsync_env.changelog, &journal->changelog.values[i].changelog,
+					sizeof(zbx_dbsync_changelog_t));
+		}
+
+		return;
+	}
+
 	objects_num = journal->inserts.values_num + journal->updates.values_num;
 
 	for (i = 0; i < journal->syncs.values_num; i++)
@@ -1183,6 +1282,12 @@ int	zbx_dbsync_compare_host_inventory(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
+	if (SUCCEED == dbsync_check_unchanged(sync, 72, NULL, ZBX_DBSYNC_OBJ_MASK(ZBX_DBSYNC_OBJ_HOST_INVENTORY),
+			ZBX_DBSYNC_OBJ_MASK(ZBX_DBSYNC_OBJ_HOST)))
+	{
+		return SUCCEED;
+	}
+
 	sql = "select hostid,inventory_mode,type,type_full,name,alias,os,os_full,os_short,serialno_a,"
 			"serialno_b,tag,asset_tag,macaddress_a,macaddress_b,hardware,hardware_full,software,"
 			"software_full,software_app_a,software_app_b,software_app_c,software_app_d,"
@@ -1272,6 +1377,12 @@ int	zbx_dbsync_compare_host_templates(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
+	if (SUCCEED == dbsync_check_unchanged(sync, 2, NULL, ZBX_DBSYNC_OBJ_MASK(ZBX_DBSYNC_OBJ_HOSTS_TEMPLATES),
+			ZBX_DBSYNC_OBJ_MASK(ZBX_DBSYNC_OBJ_HOST)))
+	{
+		return SUCCEED;
+	}
+
 	if (NULL == (result = zbx_db_select(
 			"select hostid,templateid"
 			" from hosts_templates"
@@ -1414,6 +1525,9 @@ int	zbx_dbsync_compare_global_macros(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
+	if (SUCCEED == dbsync_check_unchanged(sync, 4, NULL, ZBX_DBSYNC_OBJ_MASK(ZBX_DBSYNC_OBJ_GLOBALMACRO), 0))
+		return SUCCEED;
+
 	if (NULL == (result = zbx_db_select(
 			"select globalmacroid,macro,value,type"
 			" from globalmacro")))
@@ -1549,6 +1663,12 @@ int	zbx_dbsync_compare_host_macros(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
+	if (SUCCEED == dbsync_check_unchanged(sync, 5, NULL, ZBX_DBSYNC_OBJ_MASK(ZBX_DBSYNC_OBJ_HOSTMACRO),
+			ZBX_DBSYNC_OBJ_MASK(ZBX_DBSYNC_OBJ_HOST)))
+	{
+		return SUCCEED;
+	}
+
 	if (NULL == (result = zbx_db_select("select hostmacroid,hostid,macro,value,type from hostmacro")))
 		return FAIL;
 
@@ -1776,6 +1896,16 @@ int	zbx_dbsync_compare_interfaces(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
+	if (SUCCEED == dbsync_check_unchanged(sync, 23, dbsync_interface_preproc_row,
+			ZBX_DBSYNC_OBJ_MASK(ZBX_DBSYNC_OBJ_INTERFACE) |
+			ZBX_DBSYNC_OBJ_MASK(ZBX_DBSYNC_OBJ_INTERFACE_SNMP) |
+			ZBX_DBSYNC_OBJ_MASK(ZBX_DBSYNC_OBJ_GLOBALMACRO) |
+			ZBX_DBSYNC_OBJ_MASK(ZBX_DBSYNC_OBJ_HOSTMACRO) |
+			ZBX_DBSYNC_OBJ_MASK(ZBX_DBSYNC_OBJ_HOSTS_TEMPLATES), ZBX_DBSYNC_OBJ_MASK(ZBX_DBSYNC_OBJ_HOST)))
+	{
+		return SUCCEED;
+	}
+
 	if (NULL == (result = zbx_db_select(
 			"select i.interfaceid,i.hostid,i.type,i.main,i.useip,i.ip,i.dns,i.port,"
 			"i.available,i.disable_until,i.error,i.errors_from,"
@@ -2424,6 +2554,9 @@ int	zbx_dbsync_compare_actions(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
+	if (SUCCEED == dbsync_check_unchanged(sync, 4, NULL, ZBX_DBSYNC_OBJ_MASK(ZBX_DBSYNC_OBJ_ACTIONS), 0))
+		return SUCCEED;
+
 	if (NULL == (result = zbx_db_select(
 			"select actionid,eventsource,evaltype,formula"
 			" from actions"
@@ -2526,6 +2659,12 @@ int	zbx_dbsync_compare_action_ops(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
+	if (SUCCEED == dbsync_check_unchanged(sync, 2, NULL, ZBX_DBSYNC_OBJ_MASK(ZBX_DBSYNC_OBJ_ACTIONS) |
+			ZBX_DBSYNC_OBJ_MASK(ZBX_DBSYNC_OBJ_OPERATIONS), 0))
+	{
+		return SUCCEED;
+	}
+
 	if (NULL == (result = zbx_db_select(
 			"select a.actionid,o.recovery"
 			" from actions a"
@@ -2626,6 +2765,12 @@ int	zbx_dbsync_compare_action_conditions(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
+	if (SUCCEED == dbsync_check_unchanged(sync, 6, NULL, ZBX_DBSYNC_OBJ_MASK(ZBX_DBSYNC_OBJ_ACTIONS) |
+			ZBX_DBSYNC_OBJ_MASK(ZBX_DBSYNC_OBJ_CONDITIONS), 0))
+	{
+		return SUCCEED;
+	}
+
 	if (NULL == (result = zbx_db_select(
 			"select c.conditionid,c.actionid,c.conditiontype,c.operator,c.value,c.value2"
 			" from conditions c,actions a"
@@ -2842,6 +2987,9 @@ int	zbx_dbsync_compare_correlations(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
+	if (SUCCEED == dbsync_check_unchanged(sync, 4, NULL, ZBX_DBSYNC_OBJ_MASK(ZBX_DBSYNC_OBJ_CORRELATION), 0))
+		return SUCCEED;
+
 	if (NULL == (result = zbx_db_select(
 			"select correlationid,name,evaltype,formula"
 			" from correlation"
@@ -2972,6 +3120,17 @@ int	zbx_dbsync_compare_corr_conditions(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
+	if (SUCCEED == dbsync_check_unchanged(sync, 11, NULL, ZBX_DBSYNC_OBJ_MASK(ZBX_DBSYNC_OBJ_CORRELATION) |
+			ZBX_DBSYNC_OBJ_MASK(ZBX_DBSYNC_OBJ_CORR_CONDITION) |
+			ZBX_DBSYNC_OBJ_MASK(ZBX_DBSYNC_OBJ_CORR_CONDITION_TAG) |
+			ZBX_DBSYNC_OBJ_MASK(ZBX_DBSYNC_OBJ_CORR_CONDITION_GROUP) |
+			ZBX_DBSYNC_OBJ_MASK(ZBX_DBSYNC_OBJ_CORR_CONDITION_TAGPAIR) |
+			ZBX_DBSYNC_OBJ_MASK(ZBX_DBSYNC_OBJ_CORR_CONDITION_TAGVALUE),
+			ZBX_DBSYNC_OBJ_MASK(ZBX_DBSYNC_OBJ_HSTGRP)))
+	{
+		return SUCCEED;
+	}
+
 	if (NULL == (result = zbx_db_select(
 			"select cc.corr_conditionid,cc.correlationid,cc.type,cct.tag,cctv.tag,cctv.value,cctv.operator,"
 				" ccg.groupid,ccg.operator,cctp.oldtag,cctp.newtag"
@@ -3081,6 +3240,12 @@ int	zbx_dbsync_compare_corr_operations(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
+	if (SUCCEED == dbsync_check_unchanged(sync, 3, NULL, ZBX_DBSYNC_OBJ_MASK(ZBX_DBSYNC_OBJ_CORRELATION) |
+			ZBX_DBSYNC_OBJ_MASK(ZBX_DBSYNC_OBJ_CORR_OPERATION), 0))
+	{
+		return SUCCEED;
+	}
+
 	if (NULL == (result = zbx_db_select(
 			"select co.corr_operationid,co.correlationid,co.type"
 			" from correlation c,corr_operation co"
@@ -3176,6 +3341,9 @@ int	zbx_dbsync_compare_host_groups(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
+	if (SUCCEED == dbsync_check_unchanged(sync, 2, NULL, ZBX_DBSYNC_OBJ_MASK(ZBX_DBSYNC_OBJ_HSTGRP), 0))
+		return SUCCEED;
+
 	if (NULL == (result = zbx_db_select("select groupid,name from hstgrp where type=%d", HOSTGROUP_TYPE_HOST)))
 		return FAIL;
 
@@ -3423,6 +3591,9 @@ int	zbx_dbsync_compare_maintenances(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
+	if (SUCCEED == dbsync_check_unchanged(sync, 5, NULL, ZBX_DBSYNC_OBJ_MASK(ZBX_DBSYNC_OBJ_MAINTENANCE), 0))
+		return SUCCEED;
+
 	if (NULL == (result = zbx_db_select("select maintenanceid,maintenance_type,active_since,active_till,tags_evaltype"
 						" from maintenances")))
 	{
@@ -3521,6 +3692,12 @@ int	zbx_dbsync_compare_maintenance_tags(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
+	if (SUCCEED == dbsync_check_unchanged(sync, 5, NULL, ZBX_DBSYNC_OBJ_MASK(ZBX_DBSYNC_OBJ_MAINTENANCE) |
+			ZBX_DBSYNC_OBJ_MASK(ZBX_DBSYNC_OBJ_MAINTENANCE_TAG), 0))
+	{
+		return SUCCEED;
+	}
+
 	if (NULL == (result = zbx_db_select("select maintenancetagid,maintenanceid,operator,tag,value"
 						" from maintenance_tag")))
 	{
@@ -3635,6 +3812,13 @@ int	zbx_dbsync_compare_maintenance_periods(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
+	if (SUCCEED == dbsync_check_unchanged(sync, 10, NULL, ZBX_DBSYNC_OBJ_MASK(ZBX_DBSYNC_OBJ_MAINTENANCE) |
+			ZBX_DBSYNC_OBJ_MASK(ZBX_DBSYNC_OBJ_MAINTENANCE_WINDOW) |
+			ZBX_DBSYNC_OBJ_MASK(ZBX_DBSYNC_OBJ_TIMEPERIOD), 0))
+	{
+		return SUCCEED;
+	}
+
 	if (NULL == (result = zbx_db_select("select t.timeperiodid,t.timeperiod_type,t.every,t.month,t.dayofweek,t.day,"
 						"t.start_time,t.period,t.start_date,m.maintenanceid"
 					" from maintenances_windows m,timeperiods t"
@@ -3713,6 +3897,13 @@ int	zbx_dbsync_compare_maintenance_groups(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
+	if (SUCCEED == dbsync_check_unchanged(sync, 2, NULL, ZBX_DBSYNC_OBJ_MASK(ZBX_DBSYNC_OBJ_MAINTENANCE) |
+			ZBX_DBSYNC_OBJ_MASK(ZBX_DBSYNC_OBJ_MAINTENANCE_GROUP),
+			ZBX_DBSYNC_OBJ_MASK(ZBX_DBSYNC_OBJ_HSTGRP)))
+	{
+		return SUCCEED;
+	}
+
 	if (NULL == (result = zbx_db_select("select maintenanceid,groupid from maintenances_groups order by maintenanceid")))
 		return FAIL;
 
@@ -3793,6 +3984,12 @@ int	zbx_dbsync_compare_maintenance_hosts(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
+	if (SUCCEED == dbsync_check_unchanged(sync, 2, NULL, ZBX_DBSYNC_OBJ_MASK(ZBX_DBSYNC_OBJ_MAINTENANCE) |
+			ZBX_DBSYNC_OBJ_MASK(ZBX_DBSYNC_OBJ_MAINTENANCE_HOST), ZBX_DBSYNC_OBJ_MASK(ZBX_DBSYNC_OBJ_HOST)))
+	{
+		return SUCCEED;
+	}
+
 	if (NULL == (result = zbx_db_select("select maintenanceid,hostid from maintenances_hosts order by maintenanceid")))
 	{
 		return FAIL;
@@ -13,6 +13,7 @@
 **/
 
 #include "zbxcachehistory.h"
+#include "cachehistory_spill.h"
 
 #include "zbxmutexs.h"
 #include "module.h"
@@ -40,17 +41,16 @@
 #include "zbxipcservice.h"
 
 static zbx_shmem_info_t	*hc_index_mem = NULL;
-static zbx_shmem_info_t	*hc_mem = NULL;
 static zbx_shmem_info_t	*trend_mem = NULL;
 
-#define	LOCK_CACHE	zbx_mutex_lock(cache_lock)
-#define	UNLOCK_CACHE	zbx_mutex_unlock(cache_lock)
+/* the cache lock protects the first history cache shard together with global cache data */
+#define	LOCK_CACHE	hc_shard_lock(&cache->shards[0])
+#define	UNLOCK_CACHE	hc_shard_unlock(&cache->shards[0])
 #define	LOCK_TRENDS	zbx_mutex_lock(trends_lock)
 #define	UNLOCK_TRENDS	zbx_mutex_unlock(trends_lock)
 #define	LOCK_CACHE_IDS		zbx_mutex_lock(cache_ids_lock)
 #define	UNLOCK_CACHE_IDS	zbx_mutex_unlock(cache_ids_lock)
 
-static zbx_mutex_t	cache_lock = ZBX_MUTEX_NULL;
 static zbx_mutex_t	trends_lock = ZBX_MUTEX_NULL;
 static zbx_mutex_t	cache_ids_lock = ZBX_MUTEX_NULL;
 
@@ -64,6 +64,27 @@ static zbx_history_sync_f	sync_history_cb = NULL;
 
 #define ZBX_HC_ITEMS_INIT_SIZE	1000
 
+/* databases merging existing trends with single insert statement */
+#if defined(HAVE_POSTGRESQL) || defined(HAVE_MYSQL)
+#	define ZBX_TRENDS_UPSERT
+#endif
+
+/* spill journal record format version, journals with different format are reset - increase it when */
+/* dc_item_value_t structure or the way its strings are stored in journal records are changed       */
+#define ZBX_HC_SPILL_FORMAT	1
+
+/* the maximum number of values moved from spill journal to history cache at once */
+#define ZBX_HC_SPILL_DRAIN_MAX	10000
+
+/* the maximum number of values in history cache chunk, chunk sizes of an item grow up to this limit */
+#define ZBX_HC_CHUNK_VALUES_MAX	64
+
+/* history cache is split into shards by itemid, each shard having its own lock, index and memory */
+#define ZBX_HC_SHARDS_MAX	(ZBX_MUTEX_CACHE_SHARDS_NUM + 1)
+
+/* the minimum history cache size per shard, smaller caches are not sharded */
+#define ZBX_HC_SHARD_MIN_SIZE	(64 * ZBX_MEBIBYTE)
+
 #define ZBX_TRENDS_CLEANUP_TIME	(SEC_PER_MIN * 55)
 
 /* the maximum number of characters for history cache values (except binary) */
@@ -94,13 +115,29 @@ zbx_hc_proxyqueue_t;
 
 typedef struct
 {
-	zbx_hashset_t		trends;
-	zbx_dc_stats_t		stats;
-
 	zbx_hashset_t		history_items;
 	zbx_binary_heap_t	history_queue;
+	zbx_dc_stats_t		stats;
+
+	zbx_shmem_info_t	*mem;
+	zbx_shmem_info_t	*index_mem;
 
 	int			history_num;
+	int			processing_num;
+
+	/* lock contention statistics */
+	zbx_uint64_t		locks_num;
+	zbx_uint64_t		locks_contended;
+}
+zbx_hc_shard_t;
+
+typedef struct
+{
+	zbx_hashset_t		trends;
+
+	zbx_hc_shard_t		shards[ZBX_HC_SHARDS_MAX];
+	int			shards_num;
+
 	int			trends_num;
 	int			trends_last_cleanup_hour;
 	int			history_num_total;
@@ -109,13 +146,17 @@ typedef struct
 	unsigned char		db_trigger_queue_lock;
 
 	zbx_hc_proxyqueue_t	proxyqueue;
-	int			processing_num;
 	double			last_error_ts;
 }
 ZBX_DC_CACHE;
 
 static ZBX_DC_CACHE	*cache = NULL;
 
+static zbx_mutex_t	shard_locks[ZBX_HC_SHARDS_MAX];
+
+/* the shard locked by the current process, history cache memory is allocated from its segments */
+static zbx_hc_shard_t	*hc_shard = NULL;
+
 /* local history cache */
 #define ZBX_MAX_VALUES_LOCAL	256
 #define ZBX_STRUCT_REALLOC_STEP	8
@@ -136,6 +177,7 @@ typedef struct
 }
 dc_value_t;
 
+/* item values are written to spill journal as is, update ZBX_HC_SPILL_FORMAT when changing this structure */
 typedef struct
 {
 	zbx_uint64_t	itemid;
@@ -159,10 +201,67 @@ static size_t		string_values_alloc = 0, string_values_offset = 0;
 static dc_item_value_t	*item_values = NULL;
 static size_t		item_values_alloc = 0, item_values_num = 0;
 
-static void	hc_add_item_values(dc_item_value_t *values, int values_num);
-static void	hc_queue_item(zbx_hc_item_t *item);
+static int	hc_add_item_values(dc_item_value_t *values, int values_num);
+static int	hc_spill_drain(void);
+static void	hc_queue_item(zbx_hc_shard_t *shard, zbx_hc_item_t *item);
 static int	hc_queue_elem_compare_func(const void *d1, const void *d2);
-static void	hc_get_items(zbx_vector_uint64_pair_t *items);
+static void	hc_get_items(zbx_hc_shard_t *shard, zbx_vector_uint64_pair_t *items);
+
+ZBX_VECTOR_IMPL(hc_shard_stats, zbx_hc_shard_stats_t)
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns history cache shard of the specified item                 *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_hc_shard_t	*hc_get_shard(zbx_uint64_t itemid)
+{
+	return &cache->shards[itemid % (zbx_uint64_t)cache->shards_num];
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: locks history cache shard and makes its memory current for        *
+ *          history cache allocations                                         *
+ *                                                                            *
+ ******************************************************************************/
+static void	hc_shard_lock(zbx_hc_shard_t *shard)
+{
+	zbx_mutex_t	lock = shard_locks[shard - cache->shards];
+
+	if (SUCCEED != zbx_mutex_trylock(lock))
+	{
+		zbx_mutex_lock(lock);
+		shard->locks_contended++;
+	}
+
+	shard->locks_num++;
+	hc_shard = shard;
+}
+
+static void	hc_shard_unlock(zbx_hc_shard_t *shard)
+{
+	hc_shard = NULL;
+	zbx_mutex_unlock(shard_locks[shard - cache->shards]);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns number of values in history cache                         *
+ *                                                                            *
+ * Comments: Shards are not locked, the result is used only for progress      *
+ *           reporting and logging.                                           *
+ *                                                                            *
+ ******************************************************************************/
+static int	hc_get_history_num(void)
+{
+	int	history_num = 0;
+
+	for (int i = 0; i < cache->shards_num; i++)
+		history_num += cache->shards[i].history_num;
+
+	return history_num;
+}
 
 void	zbx_pp_value_opt_clear(zbx_pp_value_opt_t *opt)
 {
@@ -179,21 +278,53 @@ void	zbx_pp_value_opt_clear(zbx_pp_value_opt_t *opt)
  ******************************************************************************/
 void	zbx_dc_get_stats_all(zbx_wcache_info_t *wcache_info)
 {
-	LOCK_CACHE;
+	zbx_hc_spill_stats_t	spill_stats;
 
-	wcache_info->stats = cache->stats;
-	wcache_info->history_free = hc_mem->free_size;
-	wcache_info->history_total = hc_mem->total_size;
-	wcache_info->index_free = hc_index_mem->free_size;
-	wcache_info->index_total = hc_index_mem->total_size;
+	memset(wcache_info, 0, sizeof(zbx_wcache_info_t));
 
-	if (0 != (get_program_type_cb() & ZBX_PROGRAM_TYPE_SERVER))
+	for (int i = 0; i < cache->shards_num; i++)
 	{
-		wcache_info->trend_free = trend_mem->free_size;
-		wcache_info->trend_total = trend_mem->orig_size;
+		zbx_hc_shard_t	*shard = &cache->shards[i];
+
+		hc_shard_lock(shard);
+
+		wcache_info->stats.history_counter += shard->stats.history_counter;
+		wcache_info->stats.history_float_counter += shard->stats.history_float_counter;
+		wcache_info->stats.history_uint_counter += shard->stats.history_uint_counter;
+		wcache_info->stats.history_str_counter += shard->stats.history_str_counter;
+		wcache_info->stats.history_log_counter += shard->stats.history_log_counter;
+		wcache_info->stats.history_text_counter += shard->stats.history_text_counter;
+		wcache_info->stats.history_bin_counter += shard->stats.history_bin_counter;
+		wcache_info->stats.notsupported_counter += shard->stats.notsupported_counter;
+
+		wcache_info->history_free += shard->mem->free_size;
+		wcache_info->history_total += shard->mem->total_size;
+
+		wcache_info->index_free += shard->index_mem->free_size;
+		wcache_info->index_total += shard->index_mem->total_size;
+
+		if (0 == i)
+		{
+			wcache_info->history_page_size = shard->mem->page_size;
+			wcache_info->index_page_size = shard->index_mem->page_size;
+
+			if (0 != (get_program_type_cb() & ZBX_PROGRAM_TYPE_SERVER))
+			{
+				wcache_info->trend_free = trend_mem->free_size;
+				wcache_info->trend_total = trend_mem->orig_size;
+				wcache_info->trend_page_size = trend_mem->page_size;
+			}
+		}
+
+		hc_shard_unlock(shard);
 	}
 
-	UNLOCK_CACHE;
+	hc_spill_get_stats(&spill_stats);
+
+	wcache_info->spill_total = spill_stats.total;
+	wcache_info->spill_used = spill_stats.used;
+	wcache_info->spill_values = spill_stats.records_num;
+	wcache_info->spill_lag = spill_stats.lag;
 }
 
 /******************************************************************************
@@ -206,111 +337,146 @@ void	*zbx_dc_get_stats(int request)
 	static zbx_uint64_t	value_uint;
 	static double		value_double;
 	void			*ret;
+	zbx_wcache_info_t	wcache_info;
 
-	LOCK_CACHE;
+	zbx_dc_get_stats_all(&wcache_info);
 
 	switch (request)
 	{
 		case ZBX_STATS_HISTORY_COUNTER:
-			value_uint = cache->stats.history_counter;
+			value_uint = wcache_info.stats.history_counter;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_FLOAT_COUNTER:
-			value_uint = cache->stats.history_float_counter;
+			value_uint = wcache_info.stats.history_float_counter;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_UINT_COUNTER:
-			value_uint = cache->stats.history_uint_counter;
+			value_uint = wcache_info.stats.history_uint_counter;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_STR_COUNTER:
-			value_uint = cache->stats.history_str_counter;
+			value_uint = wcache_info.stats.history_str_counter;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_LOG_COUNTER:
-			value_uint = cache->stats.history_log_counter;
+			value_uint = wcache_info.stats.history_log_counter;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_TEXT_COUNTER:
-			value_uint = cache->stats.history_text_counter;
+			value_uint = wcache_info.stats.history_text_counter;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_NOTSUPPORTED_COUNTER:
-			value_uint = cache->stats.notsupported_counter;
+			value_uint = wcache_info.stats.notsupported_counter;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_TOTAL:
-			value_uint = hc_mem->total_size;
+			value_uint = wcache_info.history_total;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_USED:
-			value_uint = hc_mem->total_size - hc_mem->free_size;
+			value_uint = wcache_info.history_total - wcache_info.history_free;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_FREE:
-			value_uint = hc_mem->free_size;
+			value_uint = wcache_info.history_free;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_PUSED:
-			value_double = 100 * (double)(hc_mem->total_size - hc_mem->free_size) / hc_mem->total_size;
+			value_double = 100 * (double)(wcache_info.history_total - wcache_info.history_free) /
+					wcache_info.history_total;
 			ret = (void *)&value_double;
 			break;
 		case ZBX_STATS_HISTORY_PFREE:
-			value_double = 100 * (double)hc_mem->free_size / hc_mem->total_size;
+			value_double = 100 * (double)wcache_info.history_free / wcache_info.history_total;
 			ret = (void *)&value_double;
 			break;
 		case ZBX_STATS_TREND_TOTAL:
-			value_uint = trend_mem->orig_size;
+			value_uint = wcache_info.trend_total;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_TREND_USED:
-			value_uint = trend_mem->orig_size - trend_mem->free_size;
+			value_uint = wcache_info.trend_total - wcache_info.trend_free;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_TREND_FREE:
-			value_uint = trend_mem->free_size;
+			value_uint = wcache_info.trend_free;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_TREND_PUSED:
-			value_double = 100 * (double)(trend_mem->orig_size - trend_mem->free_size) /
-					trend_mem->orig_size;
+			value_double = 100 * (double)(wcache_info.trend_total - wcache_info.trend_free) /
+					wcache_info.trend_total;
 			ret = (void *)&value_double;
 			break;
 		case ZBX_STATS_TREND_PFREE:
-			value_double = 100 * (double)trend_mem->free_size / trend_mem->orig_size;
+			value_double = 100 * (double)wcache_info.trend_free / wcache_info.trend_total;
 			ret = (void *)&value_double;
 			break;
 		case ZBX_STATS_HISTORY_INDEX_TOTAL:
-			value_uint = hc_index_mem->total_size;
+			value_uint = wcache_info.index_total;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_INDEX_USED:
-			value_uint = hc_index_mem->total_size - hc_index_mem->free_size;
+			value_uint = wcache_info.index_total - wcache_info.index_free;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_INDEX_FREE:
-			value_uint = hc_index_mem->free_size;
+			value_uint = wcache_info.index_free;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_INDEX_PUSED:
-			value_double = 100 * (double)(hc_index_mem->total_size - hc_index_mem->free_size) /
-					hc_index_mem->total_size;
+			value_double = 100 * (double)(wcache_info.index_total - wcache_info.index_free) /
+					wcache_info.index_total;
 			ret = (void *)&value_double;
 			break;
 		case ZBX_STATS_HISTORY_INDEX_PFREE:
-			value_double = 100 * (double)hc_index_mem->free_size / hc_index_mem->total_size;
+			value_double = 100 * (double)wcache_info.index_free / wcache_info.index_total;
 			ret = (void *)&value_double;
 			break;
 		case ZBX_STATS_HISTORY_BIN_COUNTER:
-			value_uint = cache->stats.history_bin_counter;
+			value_uint = wcache_info.stats.history_bin_counter;
+			ret = (void *)&value_uint;
+			break;
+		case ZBX_STATS_SPILL_TOTAL:
+			value_uint = wcache_info.spill_total;
+			ret = (void *)&value_uint;
+			break;
+		case ZBX_STATS_SPILL_USED:
+			value_uint = wcache_info.spill_used;
+			ret = (void *)&value_uint;
+			break;
+		case ZBX_STATS_SPILL_PUSED:
+			if (0 != wcache_info.spill_total)
+				value_double = 100 * (double)wcache_info.spill_used / wcache_info.spill_total;
+			else
+				value_double = 0;
+			ret = (void *)&value_double;
+			break;
+		case ZBX_STATS_SPILL_VALUES:
+			value_uint = wcache_info.spill_values;
+			ret = (void *)&value_uint;
+			break;
+		case ZBX_STATS_SPILL_LAG:
+			value_uint = (zbx_uint64_t)wcache_info.spill_lag;
+			ret = (void *)&value_uint;
+			break;
+		case ZBX_STATS_HISTORY_PAGESIZE:
+			value_uint = wcache_info.history_page_size;
+			ret = (void *)&value_uint;
+			break;
+		case ZBX_STATS_HISTORY_INDEX_PAGESIZE:
+			value_uint = wcache_info.index_page_size;
+			ret = (void *)&value_uint;
+			break;
+		case ZBX_STATS_TREND_PAGESIZE:
+			value_uint = wcache_info.trend_page_size;
 			ret = (void *)&value_uint;
 			break;
 		default:
 			ret = NULL;
 	}
 
-	UNLOCK_CACHE;
-
 	return ret;
 }
 
@@ -497,6 +663,7 @@ static void	dc_remove_updated_trends(ZBX_DC_TREND *trends, int trends_num, const
 	}
 }
 
+#ifndef ZBX_TRENDS_UPSERT
 /******************************************************************************
  *                                                                            *
  * Purpose: helper function for DCflush trends                                *
@@ -637,6 +804,226 @@ static void	dc_trends_fetch_and_update(ZBX_DC_TREND *trends, int trends_num, zbx
 
 	(void)zbx_db_flush_overflowed_sql(sql, sql_offset);
 }
+#else
+/* the maximum length of trend value in upsert statement - 128 bit decimal or double */
+#define DC_TREND_VALUE_LEN_MAX	64
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: formats 128 bit unsigned integer as decimal number                *
+ *                                                                            *
+ * Parameters: value  - [IN] the value to format                              *
+ *             buffer - [OUT] the output buffer                               *
+ *             size   - [IN] the output buffer size                           *
+ *                                                                            *
+ ******************************************************************************/
+static void	dc_uint128_to_str(const zbx_uint128_t *value, char *buffer, size_t size)
+{
+	char		digits[DC_TREND_VALUE_LEN_MAX];
+	size_t		digits_num = 0, i;
+	zbx_uint128_t	rest = *value, quotient;
+
+	if (0 == value->hi)
+	{
+		zbx_snprintf(buffer, size, ZBX_FS_UI64, value->lo);
+		return;
+	}
+
+	do
+	{
+		zbx_udiv128_64(&quotient, &rest, 10);
+		digits[digits_num++] = (char)('0' + rest.lo - quotient.lo * 10);
+		rest = quotient;
+	}
+	while (0 != rest.hi || 0 != rest.lo);
+
+	for (i = 0; i < digits_num && i < size - 1; i++)
+		buffer[i] = digits[digits_num - i - 1];
+
+	buffer[i] = '\0';
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: insert trends merging them with the existing trends of the same   *
+ *          hour                                                              *
+ *                                                                            *
+ * Parameters: trends      - [IN/OUT] the trends to flush                     *
+ *             trends_num  - [IN] the number of trends                        *
+ *             itemids     - [IN] the sorted identifiers of items, which      *
+ *                                trends might exist in database              *
+ *             itemids_num - [IN] the number of item identifiers              *
+ *             inserts_num - [IN/OUT] the number of trends left for insert    *
+ *             value_type  - [IN] the trends value type                       *
+ *             table_name  - [IN] the trends table                            *
+ *             clock       - [IN] the trends hour                             *
+ *                                                                            *
+ * Comments: Replaces reading existing trends and updating them row by row    *
+ *           with one statement per ZBX_DB_LARGE_QUERY_BATCH_SIZE trends.     *
+ *           The cached trends are passed as a derived table, so that         *
+ *           unsigned trends can carry the exact value sum instead of the     *
+ *           truncated average and are merged as exactly as                   *
+ *           dc_trends_update_uint() does:                                    *
+ *             avg = trunc((value_avg * num + value_sum) / (num + v.num))     *
+ *           PostgreSQL updates the existing trends and inserts the rest in   *
+ *           one statement, MySQL inserts with 'on duplicate key update'      *
+ *           referring to the derived table instead of deprecated values().   *
+ *                                                                            *
+ ******************************************************************************/
+static void	dc_trends_upsert(ZBX_DC_TREND *trends, int trends_num, const zbx_uint64_t *itemids,
+		int itemids_num, int *inserts_num, unsigned char value_type, const char *table_name, int clock)
+{
+	int		i, rows_num = 0;
+	size_t		sql_offset = 0, upsert_alloc = 0, upsert_offset = 0;
+	char		*upsert = NULL, value_min[DC_TREND_VALUE_LEN_MAX], value_avg[DC_TREND_VALUE_LEN_MAX],
+			value_max[DC_TREND_VALUE_LEN_MAX];
+	const char	*avg_field, *avg_insert;
+	ZBX_DC_TREND	*trend;
+
+	if (ITEM_VALUE_TYPE_FLOAT == value_type)
+	{
+		avg_field = "value_avg";
+		avg_insert = "value_avg";
+	}
+	else
+	{
+		avg_field = "value_sum";
+#if defined(HAVE_POSTGRESQL)
+		avg_insert = "trunc(cast(value_sum as numeric)/num)";
+#else
+		avg_insert = "truncate(value_sum/num,0)";
+#endif
+	}
+
+#if defined(HAVE_POSTGRESQL)
+	zbx_snprintf_alloc(&upsert, &upsert_alloc, &upsert_offset,
+			"),u as (update %s t set num=t.num+v.num,value_min=least(t.value_min,v.value_min),",
+			table_name);
+
+	if (ITEM_VALUE_TYPE_FLOAT == value_type)
+	{
+		zbx_strcpy_alloc(&upsert, &upsert_alloc, &upsert_offset,
+				"value_avg=t.value_avg/(t.num+v.num)*t.num+"
+				"cast(v.value_avg as double precision)/(t.num+v.num)*v.num,");
+	}
+	else
+	{
+		zbx_strcpy_alloc(&upsert, &upsert_alloc, &upsert_offset,
+				"value_avg=trunc((t.value_avg*t.num+v.value_sum)/(t.num+v.num)),");
+	}
+
+	zbx_snprintf_alloc(&upsert, &upsert_alloc, &upsert_offset,
+			"value_max=greatest(t.value_max,v.value_max)"
+			" from v where t.itemid=v.itemid and t.clock=v.clock returning t.itemid)"
+			" insert into %s (itemid,clock,num,value_min,value_avg,value_max)"
+			" select itemid,clock,num,value_min,%s,value_max from v"
+			" where not exists (select null from u where u.itemid=v.itemid);\n",
+			table_name, avg_insert);
+#else
+	/* the assignments are evaluated from left to right, so num must be updated last */
+	zbx_snprintf_alloc(&upsert, &upsert_alloc, &upsert_offset,
+			") v on duplicate key update"
+			" value_min=least(%s.value_min,v.value_min),"
+			"value_max=greatest(%s.value_max,v.value_max),",
+			table_name, table_name);
+
+	if (ITEM_VALUE_TYPE_FLOAT == value_type)
+	{
+		zbx_snprintf_alloc(&upsert, &upsert_alloc, &upsert_offset,
+				"value_avg=%s.value_avg/(%s.num+v.num)*%s.num+"
+				"cast(v.value_avg as double)/(%s.num+v.num)*v.num,",
+				table_name, table_name, table_name, table_name);
+	}
+	else
+	{
+		zbx_snprintf_alloc(&upsert, &upsert_alloc, &upsert_offset,
+				"value_avg=truncate((cast(%s.value_avg as decimal(40,0))*%s.num+v.value_sum)/"
+				"(%s.num+v.num),0),",
+				table_name, table_name, table_name);
+	}
+
+	zbx_snprintf_alloc(&upsert, &upsert_alloc, &upsert_offset, "num=%s.num+v.num;\n", table_name);
+#endif
+
+	for (i = 0; i < trends_num; i++)
+	{
+		trend = &trends[i];
+
+		if (0 == trend->itemid)
+			continue;
+
+		if (clock != trend->clock || value_type != trend->value_type)
+			continue;
+
+		if (NULL == bsearch(&trend->itemid, itemids, (size_t)itemids_num, sizeof(zbx_uint64_t),
+				ZBX_DEFAULT_UINT64_COMPARE_FUNC))
+		{
+			continue;
+		}
+
+		if (ITEM_VALUE_TYPE_FLOAT == value_type)
+		{
+			zbx_snprintf(value_min, sizeof(value_min), ZBX_FS_DBL64_SQL, trend->value_min.dbl);
+			zbx_snprintf(value_avg, sizeof(value_avg), ZBX_FS_DBL64_SQL, trend->value_avg.dbl);
+			zbx_snprintf(value_max, sizeof(value_max), ZBX_FS_DBL64_SQL, trend->value_max.dbl);
+		}
+		else
+		{
+			zbx_snprintf(value_min, sizeof(value_min), ZBX_FS_UI64, trend->value_min.ui64);
+			dc_uint128_to_str(&trend->value_avg.ui64, value_avg, sizeof(value_avg));
+			zbx_snprintf(value_max, sizeof(value_max), ZBX_FS_UI64, trend->value_max.ui64);
+		}
+
+#if defined(HAVE_POSTGRESQL)
+		if (0 == rows_num)
+		{
+			zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
+					"with v (itemid,clock,num,value_min,%s,value_max) as (values ", avg_field);
+		}
+		else
+			zbx_chrcpy_alloc(&sql, &sql_alloc, &sql_offset, ',');
+
+		zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, "(" ZBX_FS_UI64 ",%d,%d,%s,%s,%s)", trend->itemid,
+				trend->clock, trend->num, value_min, value_avg, value_max);
+#else
+		/* the derived table columns are named by the first select of the union */
+		if (0 == rows_num)
+		{
+			zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
+					"insert into %s (itemid,clock,num,value_min,value_avg,value_max)"
+					" select itemid,clock,num,value_min,%s,value_max from ("
+					"select " ZBX_FS_UI64 " itemid,%d clock,%d num,%s value_min,%s %s,%s value_max",
+					table_name, avg_insert, trend->itemid, trend->clock, trend->num, value_min,
+					value_avg, avg_field, value_max);
+		}
+		else
+		{
+			zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
+					" union all select " ZBX_FS_UI64 ",%d,%d,%s,%s,%s", trend->itemid, trend->clock,
+					trend->num, value_min, value_avg, value_max);
+		}
+#endif
+		trend->itemid = 0;
+
+		--*inserts_num;
+
+		if (ZBX_DB_LARGE_QUERY_BATCH_SIZE == ++rows_num)
+		{
+			zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, upsert);
+			zbx_db_execute_overflowed_sql(&sql, &sql_alloc, &sql_offset);
+			rows_num = 0;
+		}
+	}
+
+	if (0 != rows_num)
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, upsert);
+
+	(void)zbx_db_flush_overflowed_sql(sql, sql_offset);
+
+	zbx_free(upsert);
+}
+#undef DC_TREND_VALUE_LEN_MAX
+#endif
 
 /******************************************************************************
  *                                                                            *
@@ -714,8 +1101,13 @@ void	zbx_db_flush_trends(ZBX_DC_TREND *trends, int *trends_num, zbx_vector_uint6
 
 	if (0 != itemids_num)
 	{
+#ifdef ZBX_TRENDS_UPSERT
+		dc_trends_upsert(trends, trends_to, itemids, itemids_num, &inserts_num, value_type, table_name,
+				clock);
+#else
 		dc_trends_fetch_and_update(trends, trends_to, itemids, itemids_num,
 				&inserts_num, value_type, table_name, clock);
+#endif
 	}
 
 	zbx_free(itemids);
@@ -1796,12 +2188,12 @@ void	zbx_db_mass_update_items(const zbx_vector_item_diff_ptr_t *item_diff,
  ******************************************************************************/
 static void	sync_history_cache_full(const zbx_events_funcs_t *events_cbs, int config_history_storage_pipelines)
 {
-	int			values_num = 0, triggers_num = 0, more;
+	int			values_num = 0, triggers_num = 0, more, i;
 	zbx_hashset_iter_t	iter;
 	zbx_hc_item_t		*item;
-	zbx_binary_heap_t	tmp_history_queue;
+	zbx_binary_heap_t	tmp_history_queues[ZBX_HC_SHARDS_MAX];
 
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s() history_num:%d", __func__, cache->history_num);
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() history_num:%d", __func__, hc_get_history_num());
 
 	/* History index cache might be full without any space left for queueing items from history index to  */
 	/* history queue. The solution: replace the shared-memory history queue with heap-allocated one. Add  */
@@ -1820,18 +2212,24 @@ static void	sync_history_cache_full(const zbx_events_funcs_t *events_cbs, int co
 		zbx_dc_config_unlock_all_triggers();
 	}
 
-	tmp_history_queue = cache->history_queue;
+	for (i = 0; i < cache->shards_num; i++)
+	{
+		zbx_hc_shard_t	*shard = &cache->shards[i];
 
-	zbx_binary_heap_create(&cache->history_queue, hc_queue_elem_compare_func, ZBX_BINARY_HEAP_OPTION_EMPTY);
-	zbx_hashset_iter_reset(&cache->history_items, &iter);
+		tmp_history_queues[i] = shard->history_queue;
 
-	/* add all items from history index to the new history queue */
-	while (NULL != (item = (zbx_hc_item_t *)zbx_hashset_iter_next(&iter)))
-	{
-		if (NULL != item->tail)
+		zbx_binary_heap_create(&shard->history_queue, hc_queue_elem_compare_func,
+				ZBX_BINARY_HEAP_OPTION_EMPTY);
+		zbx_hashset_iter_reset(&shard->history_items, &iter);
+
+		/* add all items from history index to the new history queue */
+		while (NULL != (item = (zbx_hc_item_t *)zbx_hashset_iter_next(&iter)))
 		{
-			item->status = ZBX_HC_ITEM_STATUS_NORMAL;
-			hc_queue_item(item);
+			if (NULL != item->tail)
+			{
+				item->status = ZBX_HC_ITEM_STATUS_NORMAL;
+				hc_queue_item(shard, item);
+			}
 		}
 	}
 
@@ -1845,15 +2243,18 @@ static void	sync_history_cache_full(const zbx_events_funcs_t *events_cbs, int co
 					&more);
 
 			zabbix_log(LOG_LEVEL_WARNING, "syncing history data... " ZBX_FS_DBL "%%",
-					(double)values_num / (cache->history_num + values_num) * 100);
+					(double)values_num / (hc_get_history_num() + values_num) * 100);
 		}
 		while (0 != zbx_hc_queue_get_size());
 
 		zabbix_log(LOG_LEVEL_WARNING, "syncing history data done");
 	}
 
-	zbx_binary_heap_destroy(&cache->history_queue);
-	cache->history_queue = tmp_history_queue;
+	for (i = 0; i < cache->shards_num; i++)
+	{
+		zbx_binary_heap_destroy(&cache->shards[i].history_queue);
+		cache->shards[i].history_queue = tmp_history_queues[i];
+	}
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
@@ -1866,7 +2267,9 @@ static void	sync_history_cache_full(const zbx_events_funcs_t *events_cbs, int co
 void	zbx_log_sync_history_cache_progress(void)
 {
 	double		pcnt = -1.0;
-	int		ts_last, ts_next, sec;
+	int		ts_last, ts_next, sec, history_num;
+
+	history_num = hc_get_history_num();
 
 	LOCK_CACHE;
 
@@ -1881,16 +2284,16 @@ void	zbx_log_sync_history_cache_progress(void)
 
 	if (0 == cache->history_progress_ts)
 	{
-		cache->history_num_total = cache->history_num;
+		cache->history_num_total = history_num;
 		cache->history_progress_ts = sec;
 	}
 
-	if (ZBX_HC_SYNC_TIME_MAX <= sec - cache->history_progress_ts || 0 == cache->history_num)
+	if (ZBX_HC_SYNC_TIME_MAX <= sec - cache->history_progress_ts || 0 == history_num)
 	{
 		if (0 != cache->history_num_total)
-			pcnt = 100 * (double)(cache->history_num_total - cache->history_num) / cache->history_num_total;
+			pcnt = 100 * (double)(cache->history_num_total - history_num) / cache->history_num_total;
 
-		cache->history_progress_ts = (0 == cache->history_num ? INT_MAX : sec);
+		cache->history_progress_ts = (0 == history_num ? INT_MAX : sec);
 	}
 
 	ts_next = cache->history_progress_ts;
@@ -1925,12 +2328,19 @@ void	zbx_log_sync_history_cache_progress(void)
 void	zbx_sync_history_cache(const zbx_events_funcs_t *events_cbs, zbx_ipc_async_socket_t *rtc,
 		int config_history_storage_pipelines, int *values_num, int *triggers_num, int *more)
 {
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s() history_num:%d", __func__, cache->history_num);
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() history_num:%d", __func__, hc_get_history_num());
 
 	*values_num = 0;
 	*triggers_num = 0;
 
+	hc_spill_drain();
+
 	sync_history_cb(values_num, triggers_num, events_cbs, rtc, config_history_storage_pipelines, more);
+
+	/* keep syncing while there are values in spill journal to move back to history cache, values */
+	/* journaled after the check are moved on the next sync                                        */
+	if (0 != hc_spill_get_records_num())
+		*more = ZBX_SYNC_MORE;
 }
 
 /******************************************************************************
@@ -2439,14 +2849,7 @@ size_t	zbx_dc_flush_history(void)
 	if (0 == item_values_num)
 		return 0;
 
-	LOCK_CACHE;
-
-	hc_add_item_values(item_values, item_values_num);
-
-	cache->history_num += item_values_num;
-	processing_num = cache->processing_num;
-
-	UNLOCK_CACHE;
+	processing_num = hc_add_item_values(item_values, item_values_num);
 
 	zbx_vps_monitor_add_collected((zbx_uint64_t)item_values_num);
 
@@ -2466,8 +2869,8 @@ size_t	zbx_dc_flush_history(void)
  * history cache storage                                                      *
  *                                                                            *
  ******************************************************************************/
-ZBX_SHMEM_FUNC_IMPL(__hc_index, hc_index_mem)
-ZBX_SHMEM_FUNC_IMPL(__hc, hc_mem)
+ZBX_SHMEM_FUNC_IMPL(__hc_index, hc_shard->index_mem)
+ZBX_SHMEM_FUNC_IMPL(__hc, hc_shard->mem)
 
 /******************************************************************************
  *                                                                            *
@@ -2483,12 +2886,13 @@ static int	hc_queue_elem_compare_func(const void *d1, const void *d2)
 	const zbx_hc_item_t	*item2 = (const zbx_hc_item_t *)e2->data;
 
 	/* compare by timestamp of the oldest value */
-	return zbx_timespec_compare(&item1->tail->ts, &item2->tail->ts);
+	return zbx_timespec_compare(&item1->tail->values[item1->tail->first].ts,
+			&item2->tail->values[item2->tail->first].ts);
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: free history item data allocated in history cache                 *
+ * Purpose: free history item value data allocated in history cache           *
  *                                                                            *
  * Parameters: data - [IN] history item data                                  *
  *                                                                            *
@@ -2528,54 +2932,111 @@ static void	hc_free_data(zbx_hc_data_t *data)
 			}
 		}
 	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: free partially cloned history item value data                     *
+ *                                                                            *
+ * Parameters: data - [IN] history item data                                  *
+ *                                                                            *
+ ******************************************************************************/
+static void	hc_free_partial_data(zbx_hc_data_t *data)
+{
+	if (ITEM_STATE_NOTSUPPORTED != data->state)
+	{
+		if (0 != (data->flags & ZBX_DC_FLAG_NOVALUE))
+			return;
+
+		if (ITEM_VALUE_TYPE_FLOAT == data->value_type || ITEM_VALUE_TYPE_UINT64 == data->value_type)
+			return;
+
+		if (ITEM_VALUE_TYPE_LOG == data->value_type && 0 == (data->flags & ZBX_DC_FLAG_LLD))
+		{
+			if (NULL == data->value.log)
+				return;
+
+			if (NULL != data->value.log->value)
+				__hc_shmem_free_func(data->value.log->value);
+
+			if (NULL != data->value.log->source)
+				__hc_shmem_free_func(data->value.log->source);
+
+			__hc_shmem_free_func(data->value.log);
+
+			return;
+		}
+	}
+
+	if (NULL != data->value.str)
+		__hc_shmem_free_func(data->value.str);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: free history cache chunk together with its remaining values       *
+ *                                                                            *
+ * Parameters: chunk - [IN] the chunk to free                                 *
+ *                                                                            *
+ ******************************************************************************/
+static void	hc_free_chunk(zbx_hc_chunk_t *chunk)
+{
+	for (int i = chunk->first; i < chunk->last; i++)
+		hc_free_data(&chunk->values[i]);
 
-	__hc_shmem_free_func(data);
+	if (NULL != chunk->meta)
+		__hc_shmem_free_func(chunk->meta);
+
+	__hc_shmem_free_func(chunk);
 }
 
 /******************************************************************************
  *                                                                            *
  * Purpose: put back item into history queue                                  *
  *                                                                            *
- * Parameters: data - [IN] history item data                                  *
+ * Parameters: shard - [IN] the history cache shard                           *
+ *             item  - [IN] history item                                      *
  *                                                                            *
  ******************************************************************************/
-static void	hc_queue_item(zbx_hc_item_t *item)
+static void	hc_queue_item(zbx_hc_shard_t *shard, zbx_hc_item_t *item)
 {
 	zbx_binary_heap_elem_t	elem = {item->itemid, (void *)item};
 
-	zbx_binary_heap_insert(&cache->history_queue, &elem);
+	zbx_binary_heap_insert(&shard->history_queue, &elem);
 }
 
 /******************************************************************************
  *                                                                            *
  * Purpose: returns history item by itemid                                    *
  *                                                                            *
- * Parameters: itemid - [IN] the item id                                      *
+ * Parameters: shard  - [IN] the history cache shard                          *
+ *             itemid - [IN] the item id                                      *
  *                                                                            *
  * Return value: the history item or NULL if the requested item is not in     *
  *               history cache                                                *
  *                                                                            *
  ******************************************************************************/
-static zbx_hc_item_t	*hc_get_item(zbx_uint64_t itemid)
+static zbx_hc_item_t	*hc_get_item(zbx_hc_shard_t *shard, zbx_uint64_t itemid)
 {
-	return (zbx_hc_item_t *)zbx_hashset_search(&cache->history_items, &itemid);
+	return (zbx_hc_item_t *)zbx_hashset_search(&shard->history_items, &itemid);
 }
 
 /******************************************************************************
  *                                                                            *
  * Purpose: adds a new item to history cache                                  *
  *                                                                            *
- * Parameters: itemid - [IN] the item id                                      *
- *                      [IN] the item data                                    *
+ * Parameters: shard  - [IN] the history cache shard                          *
+ *             itemid - [IN] the item id                                      *
+ *             chunk  - [IN] the first chunk of item values                    *
  *                                                                            *
  * Return value: the added history item                                       *
  *                                                                            *
  ******************************************************************************/
-static zbx_hc_item_t	*hc_add_item(zbx_uint64_t itemid, zbx_hc_data_t *data)
+static zbx_hc_item_t	*hc_add_item(zbx_hc_shard_t *shard, zbx_uint64_t itemid, zbx_hc_chunk_t *chunk)
 {
-	zbx_hc_item_t	item_local = {itemid, ZBX_HC_ITEM_STATUS_NORMAL, 0, data, data};
+	zbx_hc_item_t	item_local = {itemid, ZBX_HC_ITEM_STATUS_NORMAL, 0, chunk, chunk};
 
-	return (zbx_hc_item_t *)zbx_hashset_insert(&cache->history_items, &item_local, sizeof(item_local));
+	return (zbx_hc_item_t *)zbx_hashset_insert(&shard->history_items, &item_local, sizeof(item_local));
 }
 
 /******************************************************************************
@@ -2590,34 +3051,64 @@ static zbx_hc_item_t	*hc_add_item(zbx_uint64_t itemid, zbx_hc_data_t *data)
  ******************************************************************************/
 int	zbx_hc_clear_item_middle(zbx_uint64_t itemid)
 {
-	int	i = 0;
+	int		i = 0;
+	zbx_hc_shard_t	*shard = hc_get_shard(itemid);
 
-	LOCK_CACHE;
+	hc_shard_lock(shard);
 
 	zbx_hc_item_t	*item;
 
-	if (NULL != (item = hc_get_item(itemid)))
+	if (NULL != (item = hc_get_item(shard, itemid)))
 	{
-		if (NULL != item->tail->next)
+		zbx_hc_chunk_t	*tail = item->tail, *head = item->head;
+
+		if (2 < item->values_num)
 		{
-			for (zbx_hc_data_t *tail = item->tail; NULL != tail->next->next;)
+			int	j, last = (tail == head ? tail->last - 1 : tail->last);
+
+			/* the oldest value might be being processed, so it must stay in place */
+			for (j = tail->first + 1; j < last; j++)
+				hc_free_data(&tail->values[j]);
+
+			if (tail == head)
 			{
-				zbx_hc_data_t	*next = tail->next;
+				/* move the newest value next to the oldest value */
+				tail->values[tail->first + 1] = tail->values[tail->last - 1];
 
-				tail->next = next->next;
+				if (NULL != tail->meta)
+					tail->meta[tail->first + 1] = tail->meta[tail->last - 1];
 
-				hc_free_data(next);
-				item->values_num--;
-				i++;
+				tail->last = tail->first + 2;
 			}
-		}
+			else
+			{
+				zbx_hc_chunk_t	*chunk, *next;
 
-		cache->history_num -= i;
-	}
-	else
+				tail->last = tail->first + 1;
+
+				for (chunk = tail->next; chunk != head; chunk = next)
+				{
+					next = chunk->next;
+					hc_free_chunk(chunk);
+				}
+
+				for (j = head->first; j < head->last - 1; j++)
+					hc_free_data(&head->values[j]);
+
+				head->first = head->last - 1;
+				tail->next = head;
+			}
+
+			i = item->values_num - 2;
+			item->values_num = 2;
+		}
+
+		shard->history_num -= i;
+	}
+	else
 		i = FAIL;
 
-	UNLOCK_CACHE;
+	hc_shard_unlock(shard);
 
 	return i;
 }
@@ -2626,19 +3117,20 @@ int	zbx_hc_clear_item_middle(zbx_uint64_t itemid)
  *                                                                            *
  * Purpose: copies string value to history cache                              *
  *                                                                            *
- * Parameters: str - [IN] the string value                                    *
+ * Parameters: str     - [IN] the string value                                *
+ *             strings - [IN] the buffer of string values                     *
  *                                                                            *
  * Return value: the copied string or NULL if there was not enough memory     *
  *                                                                            *
  ******************************************************************************/
-static char	*hc_mem_value_str_dup(const dc_value_str_t *str)
+static char	*hc_mem_value_str_dup(const dc_value_str_t *str, const char *strings)
 {
 	char	*ptr;
 
 	if (NULL == (ptr = (char *)__hc_shmem_malloc_func(NULL, str->len)))
 		return NULL;
 
-	memcpy(ptr, &string_values[str->pvalue], str->len - 1);
+	memcpy(ptr, &strings[str->pvalue], str->len - 1);
 	ptr[str->len - 1] = '\0';
 
 	return ptr;
@@ -2648,8 +3140,9 @@ static char	*hc_mem_value_str_dup(const dc_value_str_t *str)
  *                                                                            *
  * Purpose: clones string value into history data memory                      *
  *                                                                            *
- * Parameters: dst - [IN/OUT] a reference to the cloned value                 *
- *             str - [IN] the string value to clone                           *
+ * Parameters: dst     - [IN/OUT] a reference to the cloned value             *
+ *             str     - [IN] the string value to clone                       *
+ *             strings - [IN] the buffer of string values                     *
  *                                                                            *
  * Return value: SUCCESS - either there was no need to clone the string       *
  *                         (it was empty or already cloned) or the string was *
@@ -2660,7 +3153,7 @@ static char	*hc_mem_value_str_dup(const dc_value_str_t *str)
  *           until it finishes cloning string value.                          *
  *                                                                            *
  ******************************************************************************/
-static int	hc_clone_history_str_data(char **dst, const dc_value_str_t *str)
+static int	hc_clone_history_str_data(char **dst, const dc_value_str_t *str, const char *strings)
 {
 	if (0 == str->len)
 		return SUCCEED;
@@ -2668,7 +3161,7 @@ static int	hc_clone_history_str_data(char **dst, const dc_value_str_t *str)
 	if (NULL != *dst)
 		return SUCCEED;
 
-	if (NULL != (*dst = hc_mem_value_str_dup(str)))
+	if (NULL != (*dst = hc_mem_value_str_dup(str, strings)))
 		return SUCCEED;
 
 	return FAIL;
@@ -2680,6 +3173,7 @@ static int	hc_clone_history_str_data(char **dst, const dc_value_str_t *str)
  *                                                                            *
  * Parameters: dst        - [IN/OUT] a reference to the cloned value          *
  *             item_value - [IN] the log value to clone                       *
+ *             strings    - [IN] the buffer of string values                  *
  *                                                                            *
  * Return value: SUCCESS - the log value was cloned successfully              *
  *               FAIL    - not enough memory                                  *
@@ -2688,7 +3182,8 @@ static int	hc_clone_history_str_data(char **dst, const dc_value_str_t *str)
  *           until it finishes cloning log value.                             *
  *                                                                            *
  ******************************************************************************/
-static int	hc_clone_history_log_data(zbx_log_value_t **dst, const dc_item_value_t *item_value)
+static int	hc_clone_history_log_data(zbx_log_value_t **dst, const dc_item_value_t *item_value,
+		const char *strings)
 {
 	if (NULL == *dst)
 	{
@@ -2699,10 +3194,10 @@ static int	hc_clone_history_log_data(zbx_log_value_t **dst, const dc_item_value_
 		memset(*dst, 0, sizeof(zbx_log_value_t));
 	}
 
-	if (SUCCEED != hc_clone_history_str_data(&(*dst)->value, &item_value->value.value_str))
+	if (SUCCEED != hc_clone_history_str_data(&(*dst)->value, &item_value->value.value_str, strings))
 		return FAIL;
 
-	if (SUCCEED != hc_clone_history_str_data(&(*dst)->source, &item_value->source))
+	if (SUCCEED != hc_clone_history_str_data(&(*dst)->source, &item_value->source, strings))
 		return FAIL;
 
 	(*dst)->logeventid = item_value->logeventid;
@@ -2716,8 +3211,9 @@ static int	hc_clone_history_log_data(zbx_log_value_t **dst, const dc_item_value_
  *                                                                            *
  * Purpose: clones item value from local cache into history cache             *
  *                                                                            *
- * Parameters: data       - [IN/OUT] a reference to the cloned value          *
+ * Parameters: data       - [IN/OUT] the cloned value                         *
  *             item_value - [IN] the item value                               *
+ *             strings    - [IN] the buffer of string values                  *
  *                                                                            *
  * Return value: SUCCESS - the item value was cloned successfully             *
  *               FAIL    - not enough memory                                  *
@@ -2726,111 +3222,195 @@ static int	hc_clone_history_log_data(zbx_log_value_t **dst, const dc_item_value_
  *           until it finishes cloning item value.                            *
  *                                                                            *
  ******************************************************************************/
-static int	hc_clone_history_data(zbx_hc_data_t **data, const dc_item_value_t *item_value)
+static int	hc_clone_history_data(zbx_hc_data_t *data, const dc_item_value_t *item_value, const char *strings)
 {
-	if (NULL == *data)
-	{
-		if (NULL == (*data = (zbx_hc_data_t *)__hc_shmem_malloc_func(NULL, sizeof(zbx_hc_data_t))))
-			return FAIL;
+	data->state = item_value->state;
+	data->ts = item_value->ts;
+	data->flags = item_value->flags;
 
-		memset(*data, 0, sizeof(zbx_hc_data_t));
+	if (ITEM_STATE_NOTSUPPORTED == item_value->state)
+	{
+		data->value_type = item_value->value_type;
 
-		(*data)->state = item_value->state;
-		(*data)->ts = item_value->ts;
-		(*data)->flags = item_value->flags;
+		return hc_clone_history_str_data(&data->value.str, &item_value->value.value_str, strings);
 	}
 
-	if (0 != (ZBX_DC_FLAG_META & item_value->flags))
+	if (0 != (ZBX_DC_FLAG_LLD & item_value->flags))
 	{
-		(*data)->lastlogsize = item_value->lastlogsize;
-		(*data)->mtime = item_value->mtime;
+		data->value_type = ITEM_VALUE_TYPE_TEXT;
+
+		return hc_clone_history_str_data(&data->value.str, &item_value->value.value_str, strings);
 	}
 
-	if (ITEM_STATE_NOTSUPPORTED == item_value->state)
+	data->value_type = item_value->value_type;
+
+	if (0 != (ZBX_DC_FLAG_NOVALUE & item_value->flags))
+		return SUCCEED;
+
+	switch (item_value->value_type)
 	{
-		if (NULL == ((*data)->value.str = hc_mem_value_str_dup(&item_value->value.value_str)))
-			return FAIL;
+		case ITEM_VALUE_TYPE_FLOAT:
+			data->value.dbl = item_value->value.value_dbl;
+			break;
+		case ITEM_VALUE_TYPE_UINT64:
+			data->value.ui64 = item_value->value.value_uint;
+			break;
+		case ITEM_VALUE_TYPE_STR:
+		case ITEM_VALUE_TYPE_TEXT:
+		case ITEM_VALUE_TYPE_BIN:
+			if (SUCCEED != hc_clone_history_str_data(&data->value.str, &item_value->value.value_str,
+					strings))
+			{
+				return FAIL;
+			}
+			break;
+		case ITEM_VALUE_TYPE_LOG:
+			if (SUCCEED != hc_clone_history_log_data(&data->value.log, item_value, strings))
+				return FAIL;
+			break;
+		case ITEM_VALUE_TYPE_NONE:
+		default:
+			THIS_SHOULD_NEVER_HAPPEN;
+			exit(EXIT_FAILURE);
+	}
 
-		(*data)->value_type = item_value->value_type;
-		cache->stats.notsupported_counter++;
+	return SUCCEED;
+}
 
-		return SUCCEED;
+/******************************************************************************
+ *                                                                            *
+ * Purpose: updates history cache statistics with the added item value        *
+ *                                                                            *
+ * Parameters: item_value - [IN] the item value                               *
+ *                                                                            *
+ ******************************************************************************/
+static void	hc_update_stats(const dc_item_value_t *item_value)
+{
+	if (ITEM_STATE_NOTSUPPORTED == item_value->state)
+	{
+		hc_shard->stats.notsupported_counter++;
+		return;
 	}
 
 	if (0 != (ZBX_DC_FLAG_LLD & item_value->flags))
 	{
-		if (NULL == ((*data)->value.str = hc_mem_value_str_dup(&item_value->value.value_str)))
-			return FAIL;
+		hc_shard->stats.history_text_counter++;
+		hc_shard->stats.history_counter++;
+		return;
+	}
 
-		(*data)->value_type = ITEM_VALUE_TYPE_TEXT;
+	if (0 != (ZBX_DC_FLAG_NOVALUE & item_value->flags))
+		return;
 
-		cache->stats.history_text_counter++;
-		cache->stats.history_counter++;
+	switch (item_value->item_value_type)
+	{
+		case ITEM_VALUE_TYPE_FLOAT:
+			hc_shard->stats.history_float_counter++;
+			break;
+		case ITEM_VALUE_TYPE_UINT64:
+			hc_shard->stats.history_uint_counter++;
+			break;
+		case ITEM_VALUE_TYPE_STR:
+			hc_shard->stats.history_str_counter++;
+			break;
+		case ITEM_VALUE_TYPE_TEXT:
+			hc_shard->stats.history_text_counter++;
+			break;
+		case ITEM_VALUE_TYPE_LOG:
+			hc_shard->stats.history_log_counter++;
+			break;
+		case ITEM_VALUE_TYPE_BIN:
+			hc_shard->stats.history_bin_counter++;
+			break;
+		case ITEM_VALUE_TYPE_NONE:
+		default:
+			THIS_SHOULD_NEVER_HAPPEN;
+			exit(EXIT_FAILURE);
+	}
 
+	hc_shard->stats.history_counter++;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: allocates metadata of history cache chunk values                  *
+ *                                                                            *
+ * Parameters: chunk - [IN] the history cache chunk                           *
+ *                                                                            *
+ * Return value: SUCCEED - the chunk has metadata allocated                   *
+ *               FAIL    - not enough memory                                  *
+ *                                                                            *
+ ******************************************************************************/
+static int	hc_chunk_alloc_meta(zbx_hc_chunk_t *chunk)
+{
+	if (NULL != chunk->meta)
 		return SUCCEED;
+
+	if (NULL == (chunk->meta = (zbx_hc_meta_t *)__hc_shmem_malloc_func(NULL,
+			sizeof(zbx_hc_meta_t) * chunk->size)))
+	{
+		return FAIL;
 	}
 
-	if (0 == (ZBX_DC_FLAG_NOVALUE & item_value->flags))
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets history cache chunk with space for a new item value          *
+ *                                                                            *
+ * Parameters: item - [IN] the history item, NULL for items not in cache      *
+ *             meta - [IN] 1 - the value has metadata, 0 - otherwise          *
+ *                                                                            *
+ * Return value: the chunk with space for a new value or NULL if there was    *
+ *               not enough memory                                            *
+ *                                                                            *
+ * Comments: New chunk is linked to the item only when all memory for it has  *
+ *           been allocated, so items never have empty chunks. Chunk sizes    *
+ *           grow with the number of item values in cache, items having a     *
+ *           single value use single value chunks.                            *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_hc_chunk_t	*hc_get_item_chunk(zbx_hc_item_t *item, int meta)
+{
+	zbx_hc_chunk_t	*chunk;
+	int		size;
+
+	if (NULL != item && item->head->last != item->head->size)
 	{
-		switch (item_value->value_type)
-		{
-			case ITEM_VALUE_TYPE_FLOAT:
-				(*data)->value.dbl = item_value->value.value_dbl;
-				break;
-			case ITEM_VALUE_TYPE_UINT64:
-				(*data)->value.ui64 = item_value->value.value_uint;
-				break;
-			case ITEM_VALUE_TYPE_STR:
-			case ITEM_VALUE_TYPE_TEXT:
-			case ITEM_VALUE_TYPE_BIN:
-				if (SUCCEED != hc_clone_history_str_data(&(*data)->value.str,
-						&item_value->value.value_str))
-				{
-					return FAIL;
-				}
-				break;
-			case ITEM_VALUE_TYPE_LOG:
-				if (SUCCEED != hc_clone_history_log_data(&(*data)->value.log, item_value))
-					return FAIL;
-				break;
-			case ITEM_VALUE_TYPE_NONE:
-			default:
-				THIS_SHOULD_NEVER_HAPPEN;
-				exit(EXIT_FAILURE);
-		}
+		if (0 != meta && SUCCEED != hc_chunk_alloc_meta(item->head))
+			return NULL;
 
-		switch (item_value->item_value_type)
-		{
-			case ITEM_VALUE_TYPE_FLOAT:
-				cache->stats.history_float_counter++;
-				break;
-			case ITEM_VALUE_TYPE_UINT64:
-				cache->stats.history_uint_counter++;
-				break;
-			case ITEM_VALUE_TYPE_STR:
-				cache->stats.history_str_counter++;
-				break;
-			case ITEM_VALUE_TYPE_TEXT:
-				cache->stats.history_text_counter++;
-				break;
-			case ITEM_VALUE_TYPE_LOG:
-				cache->stats.history_log_counter++;
-				break;
-			case ITEM_VALUE_TYPE_BIN:
-				cache->stats.history_bin_counter++;
-				break;
-			case ITEM_VALUE_TYPE_NONE:
-			default:
-				THIS_SHOULD_NEVER_HAPPEN;
-				exit(EXIT_FAILURE);
-		}
+		return item->head;
+	}
 
-		cache->stats.history_counter++;
+	size = (NULL == item ? 1 : MIN(ZBX_HC_CHUNK_VALUES_MAX, item->values_num));
+
+	if (NULL == (chunk = (zbx_hc_chunk_t *)__hc_shmem_malloc_func(NULL,
+			sizeof(zbx_hc_chunk_t) + sizeof(zbx_hc_data_t) * (size_t)size)))
+	{
+		return NULL;
 	}
 
-	(*data)->value_type = item_value->value_type;
+	chunk->next = NULL;
+	chunk->meta = NULL;
+	chunk->size = (unsigned short)size;
+	chunk->first = 0;
+	chunk->last = 0;
 
-	return SUCCEED;
+	if (0 != meta && SUCCEED != hc_chunk_alloc_meta(chunk))
+	{
+		__hc_shmem_free_func(chunk);
+		return NULL;
+	}
+
+	if (NULL != item)
+	{
+		item->head->next = chunk;
+		item->head = chunk;
+	}
+
+	return chunk;
 }
 
 /******************************************************************************
@@ -2889,83 +3469,368 @@ static void	hc_print_history_cache_full(zbx_vector_uint64_pair_t *items)
 
 /******************************************************************************
  *                                                                            *
- * Purpose: adds item values to the history cache                             *
+ * Purpose: adds item value to the history cache shard                        *
  *                                                                            *
- * Parameters: values     - [IN] the item values to add                       *
- *             values_num - [IN] the number of item values to add             *
+ * Parameters: shard      - [IN] the locked history cache shard               *
+ *             item_value - [IN] the item value to add                        *
+ *             strings    - [IN] the buffer of item value strings             *
+ *             wait       - [IN] 1 - wait for free space if history cache     *
+ *                                   shard is full                            *
+ *                               0 - fail if history cache shard is full      *
  *                                                                            *
- * Comments: If the history cache is full this function will wait until       *
+ * Return value: SUCCEED - the value was added                                *
+ *               FAIL    - history cache shard is full (only without wait)    *
+ *                                                                            *
+ * Comments: When waiting for free space this function will wait until        *
  *           history syncers processes values freeing enough space to store   *
  *           the new value.                                                   *
  *                                                                            *
  ******************************************************************************/
-static void	hc_add_item_values(dc_item_value_t *values, int values_num)
+static int	hc_add_item_value(zbx_hc_shard_t *shard, const dc_item_value_t *item_value, const char *strings,
+		int wait)
 {
-	dc_item_value_t	*item_value;
-	int		i;
 	zbx_hc_item_t	*item;
-
-	for (i = 0; i < values_num; i++)
+	zbx_hc_chunk_t	*chunk;
+	zbx_hc_data_t	data = {0};
+	int		meta = (0 != (ZBX_DC_FLAG_META & item_value->flags) ? 1 : 0);
+
+	/* a record with metadata and no value can be dropped if  */
+	/* the metadata update is copied to the last queued value */
+	if (NULL != (item = hc_get_item(shard, item_value->itemid)) &&
+			0 != (item_value->flags & ZBX_DC_FLAG_NOVALUE))
 	{
-		zbx_hc_data_t	*data = NULL;
+		/* skip metadata updates when only one value is queued, */
+		/* because the item might be already being processed    */
+		if (1 < item->values_num)
+		{
+			chunk = item->head;
 
-		item_value = &values[i];
+			if (0 == meta)
+				return SUCCEED;
 
-		/* a record with metadata and no value can be dropped if  */
-		/* the metadata update is copied to the last queued value */
-		if (NULL != (item = hc_get_item(item_value->itemid)) && 0 != (item_value->flags & ZBX_DC_FLAG_NOVALUE))
-		{
-			/* skip metadata updates when only one value is queued, */
-			/* because the item might be already being processed    */
-			if (item->head != item->tail)
+			/* when there is no memory for metadata the record is queued as a separate value */
+			if (SUCCEED == hc_chunk_alloc_meta(chunk))
 			{
-				if (0 != (item_value->flags & ZBX_DC_FLAG_META))
-				{
-					item->head->lastlogsize = item_value->lastlogsize;
-					item->head->mtime = item_value->mtime;
-					item->head->flags |= ZBX_DC_FLAG_META;
-				}
+				chunk->meta[chunk->last - 1].lastlogsize = item_value->lastlogsize;
+				chunk->meta[chunk->last - 1].mtime = item_value->mtime;
+				chunk->values[chunk->last - 1].flags |= ZBX_DC_FLAG_META;
 
-				continue;
+				return SUCCEED;
 			}
 		}
+	}
+
+	/* the value data is cloned before reserving space for it, so the partially */
+	/* cloned value stays valid while shard is unlocked waiting for free space  */
+	while (SUCCEED != hc_clone_history_data(&data, item_value, strings) ||
+			NULL == (chunk = hc_get_item_chunk(item, meta)))
+	{
+		zbx_vector_uint64_pair_t	items;
 
-		if (SUCCEED != hc_clone_history_data(&data, item_value))
+		if (0 == wait)
 		{
-			do
-			{
-				zbx_vector_uint64_pair_t	items;
+			hc_free_partial_data(&data);
+			return FAIL;
+		}
 
-				zbx_vector_uint64_pair_create(&items);
+		zbx_vector_uint64_pair_create(&items);
 
-				hc_get_items(&items);
+		hc_get_items(shard, &items);
 
-				UNLOCK_CACHE;
+		hc_shard_unlock(shard);
 
-				hc_print_history_cache_full(&items);
+		hc_print_history_cache_full(&items);
 
-				zbx_vector_uint64_pair_destroy(&items);
-				sleep(1);
+		zbx_vector_uint64_pair_destroy(&items);
+		sleep(1);
 
-				LOCK_CACHE;
-			}
-			while (SUCCEED != hc_clone_history_data(&data, item_value));
+		hc_shard_lock(shard);
+
+		item = hc_get_item(shard, item_value->itemid);
+	}
+
+	chunk->values[chunk->last] = data;
 
-			item = hc_get_item(item_value->itemid);
+	if (0 != meta)
+	{
+		chunk->meta[chunk->last].lastlogsize = item_value->lastlogsize;
+		chunk->meta[chunk->last].mtime = item_value->mtime;
+	}
+
+	chunk->last++;
+
+	if (NULL == item)
+	{
+		item = hc_add_item(shard, item_value->itemid, chunk);
+		hc_queue_item(shard, item);
+	}
+
+	item->values_num++;
+
+	hc_update_stats(item_value);
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets lengths of item value strings stored in history cache        *
+ *                                                                            *
+ * Parameters: item_value - [IN] the item value                               *
+ *             value_len  - [OUT] the value string length                     *
+ *             source_len - [OUT] the log source string length                *
+ *                                                                            *
+ * Comments: String fields of item values not having strings are not         *
+ *           initialized, so the lengths must be checked by value type.       *
+ *                                                                            *
+ ******************************************************************************/
+static void	hc_get_value_str_len(const dc_item_value_t *item_value, size_t *value_len, size_t *source_len)
+{
+	*value_len = 0;
+	*source_len = 0;
+
+	if (ITEM_STATE_NOTSUPPORTED == item_value->state || 0 != (ZBX_DC_FLAG_LLD & item_value->flags))
+	{
+		*value_len = item_value->value.value_str.len;
+		return;
+	}
+
+	if (0 != (ZBX_DC_FLAG_NOVALUE & item_value->flags))
+		return;
+
+	switch (item_value->value_type)
+	{
+		case ITEM_VALUE_TYPE_LOG:
+			*source_len = item_value->source.len;
+			ZBX_FALLTHROUGH;
+		case ITEM_VALUE_TYPE_STR:
+		case ITEM_VALUE_TYPE_TEXT:
+		case ITEM_VALUE_TYPE_BIN:
+			*value_len = item_value->value.value_str.len;
+			break;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: writes item values to history cache spill journal                 *
+ *                                                                            *
+ * Parameters: values     - [IN] the item values to write                     *
+ *             values_num - [IN] the number of item values to write           *
+ *                                                                            *
+ * Comments: Journal records consist of item value structure followed by its  *
+ *           strings. If the journal is full this function will wait until    *
+ *           history syncers move values from journal to history cache.       *
+ *                                                                            *
+ ******************************************************************************/
+static void	hc_spill_item_values(dc_item_value_t * const *values, int values_num)
+{
+	static double	last_warning;
+	unsigned char	*data = NULL;
+	size_t		data_alloc = 0;
+	int		now = (int)time(NULL);
+	double		time_now = zbx_time();
+
+	if (SEC_PER_MIN <= time_now - last_warning)
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "History cache is full. Writing values to spill journal.");
+		last_warning = time_now;
+	}
+
+	hc_spill_lock();
+
+	for (int i = 0; i < values_num; i++)
+	{
+		dc_item_value_t	*record;
+		size_t		value_len, source_len, size;
+
+		hc_get_value_str_len(values[i], &value_len, &source_len);
+
+		size = sizeof(dc_item_value_t) + value_len + source_len;
+
+		if (data_alloc < size)
+		{
+			data_alloc = size;
+			data = (unsigned char *)zbx_realloc(data, data_alloc);
 		}
 
-		if (NULL == item)
+		record = (dc_item_value_t *)data;
+		*record = *values[i];
+
+		record->value.value_str.pvalue = 0;
+		record->value.value_str.len = value_len;
+		record->source.pvalue = value_len;
+		record->source.len = source_len;
+
+		if (0 != value_len)
+			memcpy(data + sizeof(dc_item_value_t), &string_values[values[i]->value.value_str.pvalue], value_len);
+
+		if (0 != source_len)
 		{
-			item = hc_add_item(item_value->itemid, data);
-			hc_queue_item(item);
+			memcpy(data + sizeof(dc_item_value_t) + value_len, &string_values[values[i]->source.pvalue],
+					source_len);
 		}
-		else
+
+		while (SUCCEED != hc_spill_append(data, (zbx_uint32_t)size, now))
 		{
-			item->head->next = data;
-			item->head = data;
+			hc_spill_unlock();
+
+			zabbix_log(LOG_LEVEL_DEBUG, "History cache spill journal is full. Sleeping for 1 second.");
+			sleep(1);
+
+			hc_spill_lock();
 		}
-		item->values_num++;
 	}
+
+	hc_spill_unlock();
+
+	zbx_free(data);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: moves item values from history cache spill journal back to       *
+ *          history cache                                                     *
+ *                                                                            *
+ * Return value: the number of moved values                                   *
+ *                                                                            *
+ * Comments: Values are moved in the order they were written to journal until *
+ *           the history cache shard of the next value is full.               *
+ *                                                                            *
+ ******************************************************************************/
+static int	hc_spill_drain(void)
+{
+	const void	*data;
+	zbx_uint32_t	size;
+	int		values_num = 0;
+
+	if (SUCCEED != hc_spill_enabled())
+		return 0;
+
+	hc_spill_lock();
+
+	while (ZBX_HC_SPILL_DRAIN_MAX > values_num && SUCCEED == hc_spill_peek(&data, &size))
+	{
+		dc_item_value_t	item_value;
+		zbx_hc_shard_t	*shard;
+		int		ret;
+
+		memcpy(&item_value, data, sizeof(dc_item_value_t));
+		shard = hc_get_shard(item_value.itemid);
+
+		hc_shard_lock(shard);
+
+		if (SUCCEED == (ret = hc_add_item_value(shard, &item_value, (const char *)data + sizeof(dc_item_value_t),
+				0)))
+		{
+			shard->history_num++;
+		}
+
+		hc_shard_unlock(shard);
+
+		if (SUCCEED != ret)
+			break;
+
+		hc_spill_pop();
+		values_num++;
+	}
+
+	hc_spill_unlock();
+
+	zabbix_log(LOG_LEVEL_DEBUG, "%s() moved %d values from history cache spill journal", __func__, values_num);
+
+	return values_num;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds item values to the history cache                             *
+ *                                                                            *
+ * Parameters: values     - [IN] the item values to add                       *
+ *             values_num - [IN] the number of item values to add             *
+ *                                                                            *
+ * Return value: the number of history syncers processing the shards the      *
+ *               values were added to                                         *
+ *                                                                            *
+ * Comments: Values are added shard by shard, locking each affected shard     *
+ *           once and keeping the order of values of the same item.           *
+ *           When spill journal is enabled values are written to journal if   *
+ *           history cache shard is full or journal is not empty, so values   *
+ *           of an item are never added to cache before the journaled ones.   *
+ *                                                                            *
+ ******************************************************************************/
+static int	hc_add_item_values(dc_item_value_t *values, int values_num)
+{
+	int			processing_num = 0, wait = 1;
+	zbx_vector_ptr_t	spill_values;
+
+	if (SUCCEED == hc_spill_enabled())
+	{
+		wait = 0;
+
+		/* The journal can be changed by other processes after the check. Values of an item are added */
+		/* by a single process at a time, which sees its own journaled values, so order of item values */
+		/* is kept. If the journal is drained meanwhile the values are journaled and moved later.      */
+		if (0 != hc_spill_get_records_num())
+		{
+			zbx_vector_ptr_create(&spill_values);
+			zbx_vector_ptr_reserve(&spill_values, (size_t)values_num);
+
+			for (int i = 0; i < values_num; i++)
+				zbx_vector_ptr_append(&spill_values, &values[i]);
+
+			hc_spill_item_values((dc_item_value_t * const *)spill_values.values, spill_values.values_num);
+			zbx_vector_ptr_destroy(&spill_values);
+
+			return 0;
+		}
+	}
+
+	zbx_vector_ptr_create(&spill_values);
+
+	for (int i = 0; i < cache->shards_num; i++)
+	{
+		zbx_hc_shard_t	*shard = &cache->shards[i];
+		int		added_num = 0, full = 0;
+
+		for (int j = 0; j < values_num; j++)
+		{
+			if (shard != hc_get_shard(values[j].itemid))
+				continue;
+
+			/* once shard is full the following values are journaled to keep values order */
+			if (0 == full)
+			{
+				if (0 == added_num)
+					hc_shard_lock(shard);
+
+				if (SUCCEED == hc_add_item_value(shard, &values[j], string_values, wait))
+				{
+					added_num++;
+					continue;
+				}
+
+				full = 1;
+			}
+
+			zbx_vector_ptr_append(&spill_values, &values[j]);
+		}
+
+		if (0 != added_num || 0 != full)
+		{
+			shard->history_num += added_num;
+			processing_num += shard->processing_num;
+
+			hc_shard_unlock(shard);
+		}
+	}
+
+	if (0 != spill_values.values_num)
+		hc_spill_item_values((dc_item_value_t * const *)spill_values.values, spill_values.values_num);
+
+	zbx_vector_ptr_destroy(&spill_values);
+
+	return processing_num;
 }
 
 /******************************************************************************
@@ -2975,19 +3840,32 @@ static void	hc_add_item_values(dc_item_value_t *values, int values_num)
  *                                                                            *
  * Parameters: history - [OUT] the history value                              *
  *             itemid  - [IN] the item identifier                             *
- *             data    - [IN] the history data to copy                        *
+ *             chunk   - [IN] the history cache chunk                         *
+ *             index   - [IN] the index of value in chunk to copy             *
  *                                                                            *
  * Comments: handling of uninitialized fields in dc_add_proxy_history_log()   *
  *                                                                            *
  ******************************************************************************/
-static void	hc_copy_history_data(zbx_dc_history_t *history, zbx_uint64_t itemid, zbx_hc_data_t *data)
+static void	hc_copy_history_data(zbx_dc_history_t *history, zbx_uint64_t itemid, const zbx_hc_chunk_t *chunk,
+		int index)
 {
+	const zbx_hc_data_t	*data = &chunk->values[index];
+
 	history->itemid = itemid;
 	history->ts = data->ts;
 	history->state = data->state;
 	history->flags = data->flags;
-	history->lastlogsize = data->lastlogsize;
-	history->mtime = data->mtime;
+
+	if (0 != (ZBX_DC_FLAG_META & data->flags))
+	{
+		history->lastlogsize = chunk->meta[index].lastlogsize;
+		history->mtime = chunk->meta[index].mtime;
+	}
+	else
+	{
+		history->lastlogsize = 0;
+		history->mtime = 0;
+	}
 
 	if (ITEM_STATE_NOTSUPPORTED == data->state)
 	{
@@ -3042,25 +3920,42 @@ static void	hc_copy_history_data(zbx_dc_history_t *history, zbx_uint64_t itemid,
  * Parameters: history_items - [OUT] the locked history items                 *
  *                                                                            *
  * Comments: The history_items must be returned back to history cache with    *
- *           zbx_hc_push_items() function after they have been processed.         *
+ *           zbx_hc_push_items() function after they have been processed.     *
+ *           Shards are visited starting with a different shard each time, so *
+ *           history syncers are spread over shards.                          *
  *                                                                            *
  ******************************************************************************/
 void	zbx_hc_pop_items(zbx_vector_hc_item_ptr_t *history_items)
 {
+	static int		shard_next;
 	zbx_binary_heap_elem_t	*elem;
 	zbx_hc_item_t		*item;
+	int			shard_start;
 
-	while (ZBX_HC_SYNC_MAX > history_items->values_num && FAIL == zbx_binary_heap_empty(&cache->history_queue))
+	shard_start = shard_next++ % cache->shards_num;
+
+	for (int i = 0; i < cache->shards_num && ZBX_HC_SYNC_MAX > history_items->values_num; i++)
 	{
-		elem = zbx_binary_heap_find_min(&cache->history_queue);
-		item = elem->data;
-		zbx_vector_hc_item_ptr_append(history_items, item);
+		zbx_hc_shard_t	*shard = &cache->shards[(shard_start + i) % cache->shards_num];
+		int		values_num = history_items->values_num;
 
-		zbx_binary_heap_remove_min(&cache->history_queue);
-	}
+		hc_shard_lock(shard);
+
+		while (ZBX_HC_SYNC_MAX > history_items->values_num &&
+				FAIL == zbx_binary_heap_empty(&shard->history_queue))
+		{
+			elem = zbx_binary_heap_find_min(&shard->history_queue);
+			item = elem->data;
+			zbx_vector_hc_item_ptr_append(history_items, item);
+
+			zbx_binary_heap_remove_min(&shard->history_queue);
+		}
+
+		if (values_num != history_items->values_num)
+			shard->processing_num++;
 
-	if (0 != history_items->values_num)
-		cache->processing_num++;
+		hc_shard_unlock(shard);
+	}
 }
 
 /******************************************************************************
@@ -3085,7 +3980,7 @@ void	zbx_hc_get_item_values(zbx_dc_history_t *history, zbx_vector_hc_item_ptr_t
 		if (ZBX_HC_ITEM_STATUS_BUSY == item->status)
 			continue;
 
-		hc_copy_history_data(&history[history_num++], item->itemid, item->tail);
+		hc_copy_history_data(&history[history_num++], item->itemid, item->tail, item->tail->first);
 	}
 }
 
@@ -3105,43 +4000,85 @@ void	zbx_hc_push_items(zbx_vector_hc_item_ptr_t *history_items)
 {
 	int		i;
 	zbx_hc_item_t	*item;
-	zbx_hc_data_t	*data_free;
+	zbx_hc_chunk_t	*chunk;
+	zbx_hc_shard_t	*shard = NULL;
+	zbx_uint32_t	shards_processed = 0;	/* bitmask of shards, ZBX_HC_SHARDS_MAX cannot exceed 32 */
 
 	for (i = 0; i < history_items->values_num; i++)
 	{
+		zbx_uint32_t	shard_bit;
+
 		item = history_items->values[i];
 
+		/* items are popped shard by shard, so the shard lock is normally taken once per shard */
+		if (shard != hc_get_shard(item->itemid))
+		{
+			if (NULL != shard)
+				hc_shard_unlock(shard);
+
+			shard = hc_get_shard(item->itemid);
+			hc_shard_lock(shard);
+
+			shard_bit = (zbx_uint32_t)1 << (shard - cache->shards);
+
+			if (0 == (shards_processed & shard_bit))
+			{
+				shards_processed |= shard_bit;
+				shard->processing_num--;
+			}
+		}
+
 		switch (item->status)
 		{
 			case ZBX_HC_ITEM_STATUS_BUSY:
 				/* reset item status before returning it to queue */
 				item->status = ZBX_HC_ITEM_STATUS_NORMAL;
-				hc_queue_item(item);
+				hc_queue_item(shard, item);
 				break;
 			case ZBX_HC_ITEM_STATUS_NORMAL:
 				item->values_num--;
-				data_free = item->tail;
-				item->tail = item->tail->next;
-				hc_free_data(data_free);
-				if (NULL == item->tail)
-					zbx_hashset_remove(&cache->history_items, item);
-				else
-					hc_queue_item(item);
+				shard->history_num--;
+				chunk = item->tail;
+				hc_free_data(&chunk->values[chunk->first++]);
+
+				if (0 == item->values_num)
+				{
+					hc_free_chunk(chunk);
+					zbx_hashset_remove(&shard->history_items, item);
+					break;
+				}
+
+				if (chunk->first == chunk->last)
+				{
+					item->tail = chunk->next;
+					hc_free_chunk(chunk);
+				}
+
+				hc_queue_item(shard, item);
 				break;
 		}
 	}
 
-	cache->processing_num--;
+	if (NULL != shard)
+		hc_shard_unlock(shard);
 }
 
 /******************************************************************************
  *                                                                            *
  * Purpose: retrieve the size of history queue                                *
  *                                                                            *
+ * Comments: Shards are not locked, the result is an estimate used to decide  *
+ *           if history syncers should continue.                              *
+ *                                                                            *
  ******************************************************************************/
 int	zbx_hc_queue_get_size(void)
 {
-	return cache->history_queue.elems_num;
+	int	size = 0;
+
+	for (int i = 0; i < cache->shards_num; i++)
+		size += cache->shards[i].history_queue.elems_num;
+
+	return size;
 }
 
 int	zbx_hc_get_history_compression_age(void)
@@ -3169,24 +4106,30 @@ int	zbx_hc_get_history_compression_age(void)
  *                                                                            *
  * Purpose: calculate usage percentage of hc memory buffer                    *
  *                                                                            *
+ * Comments: Shards are not locked, the result is an estimate of history      *
+ *           cache load. Can be called while holding cache lock.              *
+ *                                                                            *
  ******************************************************************************/
 double	zbx_hc_mem_pused(void)
 {
-	return 100 * (double)(zbx_dbcache_get_hc_mem()->total_size - zbx_dbcache_get_hc_mem()->free_size) /
-			zbx_dbcache_get_hc_mem()->total_size;
+	zbx_uint64_t	total_size = 0, free_size = 0;
+
+	for (int i = 0; i < cache->shards_num; i++)
+	{
+		total_size += cache->shards[i].mem->total_size;
+		free_size += cache->shards[i].mem->free_size;
+	}
+
+	return 100 * (double)(total_size - free_size) / total_size;
 }
 
 double	zbx_hc_mem_pused_lock(void)
 {
-	double	pused;
-
-	zbx_dbcache_lock();
+	zbx_wcache_info_t	wcache_info;
 
-	pused = zbx_hc_mem_pused();
+	zbx_dc_get_stats_all(&wcache_info);
 
-	zbx_dbcache_unlock();
-
-	return pused;
+	return 100 * (double)(wcache_info.history_total - wcache_info.history_free) / wcache_info.history_total;
 }
 
 /******************************************************************************
@@ -3243,9 +4186,9 @@ out:
  ******************************************************************************/
 int	zbx_init_database_cache(zbx_get_program_type_f get_program_type, zbx_history_sync_f sync_history,
 		zbx_uint64_t history_cache_size, zbx_uint64_t history_index_cache_size,zbx_uint64_t *trends_cache_size,
-		char **error)
+		const char *history_cache_spill_dir, zbx_uint64_t history_cache_spill_size, char **error)
 {
-	int	ret;
+	int	ret, shards_num;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
@@ -3258,39 +4201,73 @@ int	zbx_init_database_cache(zbx_get_program_type_f get_program_type, zbx_history
 		goto out;
 	}
 
-	if (SUCCEED != (ret = zbx_mutex_create(&cache_lock, ZBX_MUTEX_CACHE, error)))
-		goto out;
-
 	if (SUCCEED != (ret = zbx_mutex_create(&cache_ids_lock, ZBX_MUTEX_CACHE_IDS, error)))
 		goto out;
 
-	if (SUCCEED != (ret = zbx_shmem_create(&hc_mem, history_cache_size, "history cache",
-			"HistoryCacheSize", 1, error)))
-	{
-		goto out;
-	}
+	shards_num = (int)MIN(ZBX_HC_SHARDS_MAX, MAX(1, history_cache_size / ZBX_HC_SHARD_MIN_SIZE));
 
-	if (SUCCEED != (ret = zbx_shmem_create(&hc_index_mem, history_index_cache_size, "history index cache",
-			"HistoryIndexCacheSize", 0, error)))
+	/* the first shard index memory also holds global cache data */
+	if (SUCCEED != (ret = zbx_shmem_create(&hc_index_mem, history_index_cache_size / shards_num,
+			"history index cache", "HistoryIndexCacheSize", 0, error)))
 	{
 		goto out;
 	}
 
-	cache = (ZBX_DC_CACHE *)__hc_index_shmem_malloc_func(NULL, sizeof(ZBX_DC_CACHE));
+	cache = (ZBX_DC_CACHE *)zbx_shmem_malloc(hc_index_mem, NULL, sizeof(ZBX_DC_CACHE));
 	memset(cache, 0, sizeof(ZBX_DC_CACHE));
 
-	ids = (ZBX_DC_IDS *)__hc_index_shmem_malloc_func(NULL, sizeof(ZBX_DC_IDS));
+	ids = (ZBX_DC_IDS *)zbx_shmem_malloc(hc_index_mem, NULL, sizeof(ZBX_DC_IDS));
 	memset(ids, 0, sizeof(ZBX_DC_IDS));
 
-	zbx_hashset_create_ext(&cache->history_items, ZBX_HC_ITEMS_INIT_SIZE,
-			ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC, NULL,
-			__hc_index_shmem_malloc_func, __hc_index_shmem_realloc_func, __hc_index_shmem_free_func);
+	cache->shards_num = shards_num;
 
-	zbx_binary_heap_create_ext(&cache->history_queue, hc_queue_elem_compare_func, ZBX_BINARY_HEAP_OPTION_EMPTY,
-			__hc_index_shmem_malloc_func, __hc_index_shmem_realloc_func, __hc_index_shmem_free_func);
+	for (int i = 0; i < shards_num; i++)
+	{
+		zbx_hc_shard_t	*shard = &cache->shards[i];
+
+		if (SUCCEED != (ret = zbx_mutex_create(&shard_locks[i],
+				0 == i ? ZBX_MUTEX_CACHE : ZBX_MUTEX_CACHE_SHARD + i - 1, error)))
+		{
+			goto out;
+		}
+
+		if (SUCCEED != (ret = zbx_shmem_create(&shard->mem, history_cache_size / shards_num, "history cache",
+				"HistoryCacheSize", 1, error)))
+		{
+			goto out;
+		}
+
+		if (0 == i)
+		{
+			shard->index_mem = hc_index_mem;
+		}
+		else if (SUCCEED != (ret = zbx_shmem_create(&shard->index_mem, history_index_cache_size / shards_num,
+				"history index cache", "HistoryIndexCacheSize", 0, error)))
+		{
+			goto out;
+		}
+
+		hc_shard = shard;
+
+		zbx_hashset_create_ext(&shard->history_items, ZBX_HC_ITEMS_INIT_SIZE / shards_num,
+				ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC, NULL,
+				__hc_index_shmem_malloc_func, __hc_index_shmem_realloc_func,
+				__hc_index_shmem_free_func);
+
+		zbx_binary_heap_create_ext(&shard->history_queue, hc_queue_elem_compare_func,
+				ZBX_BINARY_HEAP_OPTION_EMPTY, __hc_index_shmem_malloc_func,
+				__hc_index_shmem_realloc_func, __hc_index_shmem_free_func);
+
+		hc_shard = NULL;
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "%s() history cache shards:%d", __func__, shards_num);
 
 	if (0 != (get_program_type_cb() & ZBX_PROGRAM_TYPE_SERVER))
 	{
+		/* proxy queue is protected by cache lock and allocated from the first shard index memory */
+		hc_shard = &cache->shards[0];
+
 		zbx_hashset_create_ext(&(cache->proxyqueue.index), ZBX_HC_SYNC_MAX,
 			ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC, NULL,
 			__hc_index_shmem_malloc_func, __hc_index_shmem_realloc_func, __hc_index_shmem_free_func);
@@ -3300,11 +4277,24 @@ int	zbx_init_database_cache(zbx_get_program_type_f get_program_type, zbx_history
 
 		cache->proxyqueue.state = ZBX_HC_PROXYQUEUE_STATE_NORMAL;
 
+		hc_shard = NULL;
+
 		if (SUCCEED != (ret = init_trend_cache(trends_cache_size, error)))
 			goto out;
 	}
 
-	cache->processing_num = 0;
+	if (NULL != history_cache_spill_dir && '\0' != *history_cache_spill_dir)
+	{
+		const char	*name = (0 != (get_program_type_cb() & ZBX_PROGRAM_TYPE_SERVER) ?
+					"zabbix_server_history.spill" : "zabbix_proxy_history.spill");
+
+		if (SUCCEED != (ret = hc_spill_init(history_cache_spill_dir, name, history_cache_spill_size,
+				ZBX_HC_SPILL_FORMAT, error)))
+		{
+			goto out;
+		}
+	}
+
 	cache->history_num_total = 0;
 	cache->history_progress_ts = 0;
 	cache->last_error_ts = 0;
@@ -3348,16 +4338,25 @@ void	zbx_free_database_cache(int sync, const zbx_events_funcs_t *events_cbs, int
 	if (ZBX_SYNC_ALL == sync)
 		DCsync_all(events_cbs, config_history_storage_pipelines);
 
+	for (int i = cache->shards_num - 1; 0 <= i; i--)
+	{
+		zbx_shmem_destroy(cache->shards[i].mem);
+
+		if (0 != i)
+			zbx_shmem_destroy(cache->shards[i].index_mem);
+
+		zbx_mutex_destroy(&shard_locks[i]);
+	}
+
 	cache = NULL;
 
-	zbx_shmem_destroy(hc_mem);
-	hc_mem = NULL;
 	zbx_shmem_destroy(hc_index_mem);
 	hc_index_mem = NULL;
 
-	zbx_mutex_destroy(&cache_lock);
 	zbx_mutex_destroy(&cache_ids_lock);
 
+	hc_spill_destroy();
+
 	if (0 != (get_program_type_cb() & ZBX_PROGRAM_TYPE_SERVER))
 	{
 		zbx_shmem_destroy(trend_mem);
@@ -3381,6 +4380,8 @@ zbx_uint64_t	zbx_dc_get_nextid(const char *table_name, int num)
 	const zbx_db_table_t	*table;
 	ZBX_DC_ID		*id;
 	zbx_uint64_t		min = 0, max = ZBX_DB_MAX_ID, nextid, lastid;
+	zbx_db_bind_t		binds[2];
+	char			*select_sql;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() table:'%s' num:%d", __func__, table_name, num);
 
@@ -3415,8 +4416,13 @@ zbx_uint64_t	zbx_dc_get_nextid(const char *table_name, int num)
 
 	table = zbx_db_get_table(table_name);
 
-	result = zbx_db_select("select max(%s) from %s where %s between " ZBX_FS_UI64 " and " ZBX_FS_UI64,
-			table->recid, table_name, table->recid, min, max);
+	zbx_db_bind_uint64(&binds[0], min);
+	zbx_db_bind_uint64(&binds[1], max);
+
+	select_sql = zbx_dsprintf(NULL, "select max(%s) from %s where %s between ? and ?", table->recid, table_name,
+			table->recid);
+	result = zbx_db_select_prepared(select_sql, binds, 2);
+	zbx_free(select_sql);
 
 	if (NULL != result)
 	{
@@ -3473,15 +4479,77 @@ out:
  *                                                                            *
  * Purpose: get history cache diagnostics statistics                          *
  *                                                                            *
+ * Parameters: items_num  - [OUT] the number of cached items                  *
+ *             values_num - [OUT] the number of cached values                 *
+ *             shards     - [OUT] the per shard statistics (optional)         *
+ *                                                                            *
  ******************************************************************************/
-void	zbx_hc_get_diag_stats(zbx_uint64_t *items_num, zbx_uint64_t *values_num)
+void	zbx_hc_get_diag_stats(zbx_uint64_t *items_num, zbx_uint64_t *values_num,
+		zbx_vector_hc_shard_stats_t *shards)
 {
-	LOCK_CACHE;
+	*items_num = 0;
+	*values_num = 0;
 
-	*values_num = cache->history_num;
-	*items_num = cache->history_items.num_data;
+	for (int i = 0; i < cache->shards_num; i++)
+	{
+		zbx_hc_shard_t		*shard = &cache->shards[i];
+		zbx_hc_shard_stats_t	stats;
 
-	UNLOCK_CACHE;
+		hc_shard_lock(shard);
+
+		stats.items_num = (zbx_uint64_t)shard->history_items.num_data;
+		stats.values_num = (zbx_uint64_t)shard->history_num;
+		stats.locks_num = shard->locks_num;
+		stats.locks_contended = shard->locks_contended;
+
+		hc_shard_unlock(shard);
+
+		*items_num += stats.items_num;
+		*values_num += stats.values_num;
+
+		if (NULL != shards)
+			zbx_vector_hc_shard_stats_append(shards, stats);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: sums shared memory allocator statistics of history cache shards   *
+ *                                                                            *
+ ******************************************************************************/
+static void	hc_shmem_stats_add(zbx_shmem_stats_t *dst, const zbx_shmem_stats_t *src, int first)
+{
+	if (0 != first)
+	{
+		*dst = *src;
+		return;
+	}
+
+	dst->free_size += src->free_size;
+	dst->used_size += src->used_size;
+	dst->overhead += src->overhead;
+	dst->free_chunks += src->free_chunks;
+	dst->used_chunks += src->used_chunks;
+
+	if (0 != src->free_chunks)
+	{
+		if (0 == dst->min_chunk_size || src->min_chunk_size < dst->min_chunk_size)
+			dst->min_chunk_size = src->min_chunk_size;
+	}
+
+	dst->max_chunk_size = MAX(dst->max_chunk_size, src->max_chunk_size);
+
+	for (int i = 0; i < ZBX_SHMEM_BUCKET_COUNT; i++)
+		dst->chunks_num[i] += src->chunks_num[i];
+
+	dst->slab_free_size += src->slab_free_size;
+
+	for (int i = 0; i < ZBX_SHMEM_SLAB_CLASS_COUNT; i++)
+	{
+		dst->slabs[i].slabs_num += src->slabs[i].slabs_num;
+		dst->slabs[i].objects_used += src->slabs[i].objects_used;
+		dst->slabs[i].objects_free += src->slabs[i].objects_free;
+	}
 }
 
 /******************************************************************************
@@ -3491,15 +4559,27 @@ void	zbx_hc_get_diag_stats(zbx_uint64_t *items_num, zbx_uint64_t *values_num)
  ******************************************************************************/
 void	zbx_hc_get_mem_stats(zbx_shmem_stats_t *data, zbx_shmem_stats_t *index)
 {
-	LOCK_CACHE;
+	for (int i = 0; i < cache->shards_num; i++)
+	{
+		zbx_hc_shard_t		*shard = &cache->shards[i];
+		zbx_shmem_stats_t	stats;
 
-	if (NULL != data)
-		zbx_shmem_get_stats(hc_mem, data);
+		hc_shard_lock(shard);
 
-	if (NULL != index)
-		zbx_shmem_get_stats(hc_index_mem, index);
+		if (NULL != data)
+		{
+			zbx_shmem_get_stats(shard->mem, &stats);
+			hc_shmem_stats_add(data, &stats, 0 == i);
+		}
 
-	UNLOCK_CACHE;
+		if (NULL != index)
+		{
+			zbx_shmem_get_stats(shard->index_mem, &stats);
+			hc_shmem_stats_add(index, &stats, 0 == i);
+		}
+
+		hc_shard_unlock(shard);
+	}
 }
 
 /******************************************************************************
@@ -3509,31 +4589,32 @@ void	zbx_hc_get_mem_stats(zbx_shmem_stats_t *data, zbx_shmem_stats_t *index)
  ******************************************************************************/
 int	zbx_hc_is_itemid_cached(zbx_uint64_t itemid)
 {
-	int	ret = FAIL;
+	int		ret = FAIL;
+	zbx_hc_shard_t	*shard = hc_get_shard(itemid);
 
-	LOCK_CACHE;
+	hc_shard_lock(shard);
 
-	if (NULL != zbx_hashset_search(&cache->history_items, &itemid))
+	if (NULL != zbx_hashset_search(&shard->history_items, &itemid))
 		ret = SUCCEED;
 
-	UNLOCK_CACHE;
+	hc_shard_unlock(shard);
 
 	return ret;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: get statistics of cached items                                    *
+ * Purpose: get statistics of cached items in history cache shard             *
  *                                                                            *
  ******************************************************************************/
-static void	hc_get_items(zbx_vector_uint64_pair_t *items)
+static void	hc_get_items(zbx_hc_shard_t *shard, zbx_vector_uint64_pair_t *items)
 {
 	zbx_hashset_iter_t	iter;
 	zbx_hc_item_t		*item;
 
-	zbx_vector_uint64_pair_reserve(items, cache->history_items.num_data);
+	zbx_vector_uint64_pair_reserve(items, (size_t)(items->values_num + shard->history_items.num_data));
 
-	zbx_hashset_iter_reset(&cache->history_items, &iter);
+	zbx_hashset_iter_reset(&shard->history_items, &iter);
 	while (NULL != (item = (zbx_hc_item_t *)zbx_hashset_iter_next(&iter)))
 	{
 		zbx_uint64_pair_t	pair = {item->itemid, item->values_num};
@@ -3548,11 +4629,12 @@ static void	hc_get_items(zbx_vector_uint64_pair_t *items)
  ******************************************************************************/
 void	zbx_hc_get_items(zbx_vector_uint64_pair_t *items)
 {
-	LOCK_CACHE;
-
-	hc_get_items(items);
-
-	UNLOCK_CACHE;
+	for (int i = 0; i < cache->shards_num; i++)
+	{
+		hc_shard_lock(&cache->shards[i]);
+		hc_get_items(&cache->shards[i], items);
+		hc_shard_unlock(&cache->shards[i]);
+	}
 }
 
 /******************************************************************************
@@ -3662,21 +4744,6 @@ void	zbx_dbcache_unlock(void)
 	UNLOCK_CACHE;
 }
 
-void	zbx_dbcache_set_history_num(int num)
-{
-	cache->history_num = num;
-}
-
-int	zbx_dbcache_get_history_num(void)
-{
-	return cache->history_num;
-}
-
-zbx_shmem_info_t	*zbx_dbcache_get_hc_mem(void)
-{
-	return hc_mem;
-}
-
 void	zbx_dbcache_setproxyqueue_state(int proxyqueue_state)
 {
 	cache->proxyqueue.state = proxyqueue_state;
@@ -0,0 +1,404 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "cachehistory_spill.h"
+
+#include "zbxmutexs.h"
+#include "zbxstr.h"
+
+#include <sys/mman.h>
+
+/******************************************************************************
+ *                                                                            *
+ * History cache spill journal is a memory mapped file used as a ring buffer  *
+ * of records. Records are appended at the write position and removed from    *
+ * the read position, so they are read back in the same order as written.     *
+ * The journal header is stored at the start of the file and is shared by all *
+ * processes, allowing journal to survive server restarts.                    *
+ *                                                                            *
+ ******************************************************************************/
+
+#define HC_SPILL_MAGIC		0x4c505348
+#define HC_SPILL_VERSION	1
+
+#define HC_SPILL_ALIGN(size)	(((size) + 7) & ~(zbx_uint64_t)7)
+
+typedef struct
+{
+	zbx_uint32_t	magic;
+	zbx_uint32_t	version;
+	zbx_uint32_t	format;		/* the record data format defined by journal user */
+	zbx_uint32_t	reserved;
+	zbx_uint64_t	size;		/* the journal data size */
+	zbx_uint64_t	read_pos;
+	zbx_uint64_t	write_pos;
+	zbx_uint64_t	used;		/* used data size including record headers and wrap gaps */
+	zbx_uint64_t	records_num;
+}
+hc_spill_header_t;
+
+typedef struct
+{
+	zbx_uint32_t	size;		/* record data size, 0 - the rest of journal data is not used */
+	int		clock;		/* the time when record was written */
+}
+hc_spill_record_t;
+
+static hc_spill_header_t	*spill = NULL;
+static unsigned char		*spill_data;
+static size_t			spill_map_size;
+static zbx_mutex_t		spill_lock = ZBX_MUTEX_NULL;
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: resets journal header                                             *
+ *                                                                            *
+ ******************************************************************************/
+static void	hc_spill_reset(zbx_uint64_t size, zbx_uint32_t format)
+{
+	memset(spill, 0, sizeof(hc_spill_header_t));
+
+	spill->magic = HC_SPILL_MAGIC;
+	spill->version = HC_SPILL_VERSION;
+	spill->format = format;
+	spill->size = size;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: opens and maps history cache spill journal                        *
+ *                                                                            *
+ * Parameters: dir    - [IN] the journal directory                            *
+ *             name   - [IN] the journal file name                            *
+ *             size   - [IN] the journal data size                            *
+ *             format - [IN] the record data format, journals with different  *
+ *                           format are reset                                 *
+ *             error  - [OUT] the error message                               *
+ *                                                                            *
+ * Return value: SUCCEED - the journal was opened successfully                *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: The journal must be opened before forking child processes, so   *
+ *           they inherit the shared mapping.                                 *
+ *                                                                            *
+ ******************************************************************************/
+int	hc_spill_init(const char *dir, const char *name, zbx_uint64_t size, zbx_uint32_t format, char **error)
+{
+	char		*path;
+	int		fd, ret = FAIL, err;
+	zbx_stat_t	buf;
+	void		*map;
+
+	path = zbx_dsprintf(NULL, "%s/%s", dir, name);
+	size = HC_SPILL_ALIGN(size);
+	spill_map_size = sizeof(hc_spill_header_t) + size;
+
+	if (-1 == (fd = open(path, O_RDWR | O_CREAT, S_IRUSR | S_IWUSR)))
+	{
+		*error = zbx_dsprintf(NULL, "cannot open history cache spill journal \"%s\": %s", path,
+				zbx_strerror(errno));
+		goto out;
+	}
+
+	if (0 != zbx_fstat(fd, &buf))
+	{
+		*error = zbx_dsprintf(NULL, "cannot stat history cache spill journal \"%s\": %s", path,
+				zbx_strerror(errno));
+		goto out;
+	}
+
+	if ((zbx_uint64_t)buf.st_size > spill_map_size && 0 != ftruncate(fd, (off_t)spill_map_size))
+	{
+		*error = zbx_dsprintf(NULL, "cannot truncate history cache spill journal \"%s\": %s", path,
+				zbx_strerror(errno));
+		goto out;
+	}
+
+	/* allocate disk space beforehand, writing to memory mapped sparse file fails with SIGBUS if disk is full */
+	if (0 != (err = posix_fallocate(fd, 0, (off_t)spill_map_size)))
+	{
+		*error = zbx_dsprintf(NULL, "cannot allocate " ZBX_FS_SIZE_T " bytes for history cache spill journal"
+				" \"%s\": %s", (zbx_fs_size_t)spill_map_size, path, zbx_strerror(err));
+		goto out;
+	}
+
+	if (MAP_FAILED == (map = mmap(NULL, spill_map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)))
+	{
+		*error = zbx_dsprintf(NULL, "cannot map history cache spill journal \"%s\": %s", path,
+				zbx_strerror(errno));
+		goto out;
+	}
+
+	if (SUCCEED != zbx_mutex_create(&spill_lock, ZBX_MUTEX_CACHE_SPILL, error))
+	{
+		munmap(map, spill_map_size);
+		goto out;
+	}
+
+	spill = (hc_spill_header_t *)map;
+	spill_data = (unsigned char *)map + sizeof(hc_spill_header_t);
+
+	if (HC_SPILL_MAGIC != spill->magic || HC_SPILL_VERSION != spill->version || format != spill->format ||
+			size != spill->size || spill->read_pos > size || spill->write_pos > size || spill->used > size)
+	{
+		if (HC_SPILL_MAGIC == spill->magic && 0 != spill->records_num)
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "discarding " ZBX_FS_UI64 " values from history cache spill"
+					" journal \"%s\": journal size or format has been changed", spill->records_num,
+					path);
+		}
+
+		hc_spill_reset(size, format);
+	}
+	else if (0 != spill->records_num)
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "history cache spill journal \"%s\" contains " ZBX_FS_UI64 " values",
+				path, spill->records_num);
+	}
+
+	ret = SUCCEED;
+out:
+	if (-1 != fd)
+		close(fd);
+
+	zbx_free(path);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: flushes and unmaps history cache spill journal                    *
+ *                                                                            *
+ ******************************************************************************/
+void	hc_spill_destroy(void)
+{
+	if (NULL == spill)
+		return;
+
+	if (0 != msync(spill, spill_map_size, MS_SYNC))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot flush history cache spill journal: %s",
+				zbx_strerror(errno));
+	}
+
+	munmap(spill, spill_map_size);
+	spill = NULL;
+
+	zbx_mutex_destroy(&spill_lock);
+}
+
+int	hc_spill_enabled(void)
+{
+	return NULL != spill ? SUCCEED : FAIL;
+}
+
+void	hc_spill_lock(void)
+{
+	zbx_mutex_lock(spill_lock);
+}
+
+void	hc_spill_unlock(void)
+{
+	zbx_mutex_unlock(spill_lock);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: appends record to journal                                         *
+ *                                                                            *
+ * Parameters: data  - [IN] the record data                                   *
+ *             size  - [IN] the record data size                              *
+ *             clock - [IN] the record timestamp                              *
+ *                                                                            *
+ * Return value: SUCCEED - the record was appended                            *
+ *               FAIL    - not enough space in journal                        *
+ *                                                                            *
+ * Comments: The journal must be locked.                                      *
+ *                                                                            *
+ ******************************************************************************/
+int	hc_spill_append(const void *data, zbx_uint32_t size, int clock)
+{
+	zbx_uint64_t		record_size, gap = 0;
+	hc_spill_record_t	*record;
+	int			wrap = 0;
+
+	record_size = HC_SPILL_ALIGN(sizeof(hc_spill_record_t) + size);
+
+	if (0 == spill->records_num)
+	{
+		spill->read_pos = 0;
+		spill->write_pos = 0;
+		spill->used = 0;
+	}
+
+	/* records are not split, wrap to the start of journal if record does not fit at the end */
+	if (spill->write_pos + record_size > spill->size)
+	{
+		gap = spill->size - spill->write_pos;
+		wrap = 1;
+	}
+
+	if (gap + record_size > spill->size - spill->used)
+		return FAIL;
+
+	if (0 != wrap)
+	{
+		if (sizeof(hc_spill_record_t) <= gap)
+		{
+			record = (hc_spill_record_t *)(spill_data + spill->write_pos);
+			record->size = 0;
+		}
+
+		spill->used += gap;
+		spill->write_pos = 0;
+	}
+
+	record = (hc_spill_record_t *)(spill_data + spill->write_pos);
+	record->size = size;
+	record->clock = clock;
+	memcpy(record + 1, data, size);
+
+	spill->write_pos += record_size;
+	spill->used += record_size;
+	spill->records_num++;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: skips unused space at the end of journal                          *
+ *                                                                            *
+ ******************************************************************************/
+static hc_spill_record_t	*hc_spill_first(void)
+{
+	hc_spill_record_t	*record;
+
+	if (spill->size - spill->read_pos < sizeof(hc_spill_record_t) ||
+			0 == ((hc_spill_record_t *)(spill_data + spill->read_pos))->size)
+	{
+		spill->used -= spill->size - spill->read_pos;
+		spill->read_pos = 0;
+	}
+
+	record = (hc_spill_record_t *)(spill_data + spill->read_pos);
+
+	return record;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets the oldest journal record without removing it                *
+ *                                                                            *
+ * Parameters: data - [OUT] the record data, valid until record is removed    *
+ *             size - [OUT] the record data size                              *
+ *                                                                            *
+ * Return value: SUCCEED - the record was returned                            *
+ *               FAIL    - journal is empty                                   *
+ *                                                                            *
+ * Comments: The journal must be locked.                                      *
+ *                                                                            *
+ ******************************************************************************/
+int	hc_spill_peek(const void **data, zbx_uint32_t *size)
+{
+	hc_spill_record_t	*record;
+
+	if (0 == spill->records_num)
+		return FAIL;
+
+	record = hc_spill_first();
+
+	*data = record + 1;
+	*size = record->size;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: removes the oldest journal record                                 *
+ *                                                                            *
+ * Comments: The journal must be locked.                                      *
+ *                                                                            *
+ ******************************************************************************/
+void	hc_spill_pop(void)
+{
+	hc_spill_record_t	*record;
+	zbx_uint64_t		record_size;
+
+	if (0 == spill->records_num)
+		return;
+
+	record = hc_spill_first();
+	record_size = HC_SPILL_ALIGN(sizeof(hc_spill_record_t) + record->size);
+
+	spill->read_pos += record_size;
+	spill->used -= record_size;
+	spill->records_num--;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns number of records in journal                              *
+ *                                                                            *
+ * Comments: The journal must not be locked by caller. The number of records  *
+ *           can be changed by other processes as soon as journal is          *
+ *           unlocked.                                                        *
+ *                                                                            *
+ ******************************************************************************/
+zbx_uint64_t	hc_spill_get_records_num(void)
+{
+	zbx_uint64_t	records_num;
+
+	if (NULL == spill)
+		return 0;
+
+	hc_spill_lock();
+	records_num = spill->records_num;
+	hc_spill_unlock();
+
+	return records_num;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets journal statistics                                           *
+ *                                                                            *
+ ******************************************************************************/
+void	hc_spill_get_stats(zbx_hc_spill_stats_t *stats)
+{
+	memset(stats, 0, sizeof(zbx_hc_spill_stats_t));
+
+	if (NULL == spill)
+		return;
+
+	hc_spill_lock();
+
+	stats->total = spill->size;
+	stats->used = spill->used;
+	stats->records_num = spill->records_num;
+
+	if (0 != spill->records_num)
+	{
+		int	now = (int)time(NULL);
+
+		stats->lag = now - hc_spill_first()->clock;
+
+		if (0 > stats->lag)
+			stats->lag = 0;
+	}
+
+	hc_spill_unlock();
+}
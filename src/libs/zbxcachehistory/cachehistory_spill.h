@@ -0,0 +1,42 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#ifndef ZABBIX_CACHEHISTORY_SPILL_H
+#define ZABBIX_CACHEHISTORY_SPILL_H
+
+#include "zbxcommon.h"
+
+typedef struct
+{
+	zbx_uint64_t	total;		/* journal data size */
+	zbx_uint64_t	used;		/* used journal data size */
+	zbx_uint64_t	records_num;	/* number of records in journal */
+	int		lag;		/* age of the oldest record in seconds */
+}
+zbx_hc_spill_stats_t;
+
+int	hc_spill_init(const char *dir, const char *name, zbx_uint64_t size, zbx_uint32_t format, char **error);
+void	hc_spill_destroy(void);
+
+int	hc_spill_enabled(void);
+void	hc_spill_lock(void);
+void	hc_spill_unlock(void);
+
+int	hc_spill_append(const void *data, zbx_uint32_t size, int clock);
+int	hc_spill_peek(const void **data, zbx_uint32_t *size);
+void	hc_spill_pop(void);
+zbx_uint64_t	hc_spill_get_records_num(void);
+void	hc_spill_get_stats(zbx_hc_spill_stats_t *stats);
+
+#endif
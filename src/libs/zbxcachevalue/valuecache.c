@@ -87,6 +87,18 @@ ZBX_SHMEM_FUNC_IMPL(__vc, vc_mem)
 
 #define ZBX_VC_ITEM_EXPIRE_PERIOD	SEC_PER_DAY
 
+/* the period searched for the values of count based requests of items without cached database values */
+#define ZBX_VC_PREFETCH_PERIOD		SEC_PER_HOUR
+
+/* the prefetch period start alignment, so that periods ending at close timestamps are read by one query */
+#define ZBX_VC_PREFETCH_ALIGN		SEC_PER_MIN
+
+/* the maximum number of periods with running aggregates per item */
+#define ZBX_VC_ITEM_WINDOWS_MAX		4
+
+/* the number of values in period when its aggregates are not calculated */
+#define ZBX_VC_WINDOW_INVALID		-1
+
 /* the data chunk used to store data fragment */
 typedef struct zbx_vc_chunk
 {
@@ -105,11 +117,56 @@ typedef struct zbx_vc_chunk
 	/* the number of item value slots in chunk */
 	int			slots_num;
 
+	/* The size of packed value data in bytes, 0 for chunks storing values in slots.   */
+	/* Packed chunks keep the first value in slots[0], the last value in slots[1] and  */
+	/* the rest of values are encoded in a bit stream following the slots.            */
+	int			packed_size;
+
 	/* the item value data */
 	zbx_history_record_t	slots[1];
 }
 zbx_vc_chunk_t;
 
+/* the running aggregates of item values in time period ending with the last item value */
+typedef struct
+{
+	/* the period length in seconds */
+	int			period;
+
+	/* the last time the aggregates were requested */
+	int			lastaccess;
+
+	/* the number of values in period, ZBX_VC_WINDOW_INVALID if aggregates are not calculated */
+	int			values_num;
+
+	/* The number of values removed from period since the aggregates were calculated.  */
+	/* The aggregates are recalculated after all values in period have been replaced   */
+	/* to discard the rounding errors left over by the compensated sum.                */
+	int			removed_num;
+
+	/* The chunk and index of the oldest value in period. The chunk is never packed. */
+	zbx_vc_chunk_t		*chunk;
+	int			index;
+
+	/* The sum of values, used for average and floating point value sum. The sum is    */
+	/* Neumaier compensated - the low order bits lost when adding or subtracting       */
+	/* values of different magnitude are accumulated in sum_comp, so removing a large  */
+	/* value from period does not cancel the smaller values added after it.            */
+	double			sum;
+	double			sum_comp;
+
+	/* the sum of unsigned values */
+	zbx_uint64_t		sum_ui64;
+
+	zbx_history_value_t	min;
+	zbx_history_value_t	max;
+
+	/* the number of values equal to minimum and maximum values */
+	int			min_num;
+	int			max_num;
+}
+zbx_vc_window_t;
+
 /* min/max number of item history values to store in chunk */
 
 #define ZBX_VC_MIN_CHUNK_RECORDS	2
@@ -133,6 +190,9 @@ typedef struct
 	/* the hour when the current/global range sync was done       */
 	unsigned char	range_sync_hour;
 
+	/* the number of periods with running aggregates              */
+	unsigned char	windows_num;
+
 	/* The total number of item values in cache.                  */
 	/* Used to evaluate if the item must be dropped from cache    */
 	/* in low memory situation.                                   */
@@ -180,6 +240,10 @@ typedef struct
 
 	/* the first (oldest) chunk of item history data              */
 	zbx_vc_chunk_t	*tail;
+
+	/* the periods with running aggregates, the array of          */
+	/* ZBX_VC_ITEM_WINDOWS_MAX elements is allocated on demand    */
+	zbx_vc_window_t	*windows;
 }
 zbx_vc_item_t;
 
@@ -209,6 +273,9 @@ typedef struct
 
 	/* the string pool for str, text and log item values */
 	zbx_hashset_t	strpool;
+
+	/* the value cache snapshot loading statistics */
+	zbx_vc_snapshot_stats_t	snapshot_stats;
 }
 zbx_vc_cache_t;
 
@@ -229,7 +296,8 @@ ZBX_VECTOR_IMPL(vc_itemweight, zbx_vc_item_weight_t)
 typedef enum
 {
 	ZBX_VC_UPDATE_STATS,
-	ZBX_VC_UPDATE_RANGE
+	ZBX_VC_UPDATE_RANGE,
+	ZBX_VC_UPDATE_WINDOW
 }
 zbx_vc_item_update_type_t;
 
@@ -245,6 +313,12 @@ enum
 	ZBX_VC_UPDATE_RANGE_NOW
 };
 
+enum
+{
+	ZBX_VC_UPDATE_WINDOW_PERIOD,
+	ZBX_VC_UPDATE_WINDOW_NOW
+};
+
 typedef struct
 {
 	zbx_uint64_t			itemid;
@@ -256,8 +330,26 @@ zbx_vc_item_update_t;
 ZBX_VECTOR_DECL(vc_itemupdate, zbx_vc_item_update_t)
 ZBX_VECTOR_IMPL(vc_itemupdate, zbx_vc_item_update_t)
 
+/* the item values to prefetch from database */
+typedef struct
+{
+	zbx_uint64_t	itemid;
+	unsigned char	value_type;
+	int		range_start;
+	int		count;		/* the number of last values to read, 0 - all values */
+}
+zbx_vc_prefetch_t;
+
+ZBX_VECTOR_DECL(vc_prefetch, zbx_vc_prefetch_t)
+ZBX_VECTOR_IMPL(vc_prefetch, zbx_vc_prefetch_t)
+
+ZBX_VECTOR_IMPL(vc_request, zbx_vc_request_t)
+
 static zbx_vector_vc_itemupdate_t	vc_itemupdates;
 
+/* the buffer for decoding packed chunk values */
+static zbx_vector_history_record_t	vc_unpack_buffer;
+
 static void	vc_cache_item_update(zbx_uint64_t itemid, zbx_vc_item_update_type_t type, int arg1, int arg2)
 {
 	zbx_vc_item_update_t	*update;
@@ -917,7 +1009,7 @@ static void	vc_history_record_copy(zbx_history_record_t *dst, const zbx_history_
  *                                                                            *
  ******************************************************************************/
 static void	vc_history_record_vector_append(zbx_vector_history_record_t *vector, int value_type,
-		zbx_history_record_t *value)
+		const zbx_history_record_t *value)
 {
 	zbx_history_record_t	record;
 
@@ -1265,6 +1357,11 @@ static void	vc_item_update_db_cached_from(zbx_vc_item_t *item, int timestamp)
  *
  * After adding a new chunk, the older chunks (outside the largest request
  * range) are automatically removed from cache.
+ *
+ * Full chunks of numeric items, except the head chunk, are packed - the
+ * timestamps are encoded as delta-of-delta and the values as XOR of the
+ * previous value bits. Packed chunks are decoded when reading values and
+ * unpacked back to slots if their values must be modified.
  */
 
 /******************************************************************************
@@ -1396,1533 +1493,3558 @@ static int	vch_item_add_chunk(zbx_vc_item_t *item, int nslots, zbx_vc_chunk_t *i
 	return SUCCEED;
 }
 
+/* the bit stream used to encode packed chunk values */
+typedef struct
+{
+	unsigned char	*data;
+	size_t		offset;		/* the current bit offset */
+}
+vc_bitstream_t;
+
 /******************************************************************************
  *                                                                            *
- * Purpose: find the index of the last value in chunk with timestamp less or  *
- *          equal to the specified timestamp.                                 *
- *                                                                            *
- * Parameters:  chunk - [IN] the chunk                                        *
- *              ts    - [IN] the target timestamp                             *
+ * Purpose: writes the lowest bits of value into bit stream                   *
  *                                                                            *
- * Return value: The index of the last value in chunk with timestamp less or  *
- *               equal to the specified timestamp.                            *
- *               -1 is returned in the case of failure (meaning that all      *
- *               values have timestamps greater than the target timestamp).   *
+ * Parameters: bs    - [IN/OUT] the bit stream, data must be zero initialized *
+ *             value - [IN] the value to write                                *
+ *             bits  - [IN] the number of bits to write (1-64)                *
  *                                                                            *
  ******************************************************************************/
-static int	vch_chunk_find_last_value_before(const zbx_vc_chunk_t *chunk, const zbx_timespec_t *ts)
+static void	vc_bitstream_write(vc_bitstream_t *bs, zbx_uint64_t value, int bits)
 {
-	int	start = chunk->first_value, end = chunk->last_value, middle;
-
-	/* check if the last value timestamp is already greater or equal to the specified timestamp */
-	if (0 >= zbx_timespec_compare(&chunk->slots[end].timestamp, ts))
-		return end;
-
-	/* chunk contains only one value, which did not pass the above check, return failure */
-	if (start == end)
-		return -1;
-
-	/* perform value lookup using binary search */
-	while (start != end)
+	while (0 < bits)
 	{
-		middle = start + (end - start) / 2;
-
-		if (0 < zbx_timespec_compare(&chunk->slots[middle].timestamp, ts))
-		{
-			end = middle;
-			continue;
-		}
-
-		if (0 >= zbx_timespec_compare(&chunk->slots[middle + 1].timestamp, ts))
-		{
-			start = middle;
-			continue;
-		}
+		int	free_bits = 8 - (int)(bs->offset & 7), n = MIN(free_bits, bits);
 
-		return middle;
+		bs->data[bs->offset >> 3] |= (unsigned char)(((value >> (bits - n)) & ((1u << n) - 1)) <<
+				(free_bits - n));
+		bs->offset += (size_t)n;
+		bits -= n;
 	}
-
-	return -1;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: gets the chunk and index of the last value with a timestamp less  *
- *          or equal to the specified timestamp                               *
- *                                                                            *
- * Parameters:  item          - [IN] the item                                 *
- *              ts            - [IN] the target timestamp                     *
- *                                   (NULL - current time)                    *
- *              pchunk        - [OUT] the chunk containing the target value   *
- *              pindex        - [OUT] the index of the target value           *
+ * Purpose: reads value from bit stream                                       *
  *                                                                            *
- * Return value: SUCCEED - the last value was found successfully              *
- *               FAIL - all values in cache have timestamps greater than the  *
- *                      target (timeshift) timestamp.                         *
+ * Parameters: bs    - [IN/OUT] the bit stream                                *
+ *             bits  - [IN] the number of bits to read (1-64)                 *
  *                                                                            *
- * Comments: If end_timestamp value is 0, then simply the last item value in  *
- *           cache is returned.                                               *
+ * Return value: the value read                                               *
  *                                                                            *
  ******************************************************************************/
-static int	vch_item_get_last_value(const zbx_vc_item_t *item, const zbx_timespec_t *ts, zbx_vc_chunk_t **pchunk,
-		int *pindex)
+static zbx_uint64_t	vc_bitstream_read(vc_bitstream_t *bs, int bits)
 {
-	zbx_vc_chunk_t	*chunk = item->head;
-	int		index;
-
-	if (NULL == chunk)
-		return FAIL;
-
-	index = chunk->last_value;
+	zbx_uint64_t	value = 0;
 
-	if (0 < zbx_timespec_compare(&chunk->slots[index].timestamp, ts))
+	while (0 < bits)
 	{
-		while (0 < zbx_timespec_compare(&chunk->slots[chunk->first_value].timestamp, ts))
-		{
-			chunk = chunk->prev;
-			/* there are no values for requested range, return failure */
-			if (NULL == chunk)
-				return FAIL;
-		}
-		index = vch_chunk_find_last_value_before(chunk, ts);
-	}
+		int	free_bits = 8 - (int)(bs->offset & 7), n = MIN(free_bits, bits);
 
-	*pchunk = chunk;
-	*pindex = index;
+		value = (value << n) | ((bs->data[bs->offset >> 3] >> (free_bits - n)) & ((1u << n) - 1));
+		bs->offset += (size_t)n;
+		bits -= n;
+	}
 
-	return SUCCEED;
+	return value;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: copies value in the specified item's chunk slot                   *
- *                                                                            *
- * Parameters: chunk        - [IN/OUT] the target chunk                       *
- *             index        - [IN] the target slot                            *
- *             source_value - [IN] the value to copy                          *
- *                                                                            *
- * Return value: SUCCEED - the value was copied successfully                  *
- *               FAIL    - the value copying failed (not enough space for     *
- *                         string, text or log type data)                     *
- *                                                                            *
- * Comments: This function is used to copy data to cache. The contents of     *
- *           str, text and log type values are stored in cache string pool.   *
+ * Purpose: counts leading and trailing zero bits of a non-zero value         *
  *                                                                            *
  ******************************************************************************/
-static int	vch_item_copy_value(zbx_vc_item_t *item, zbx_vc_chunk_t *chunk, int index,
-		const zbx_history_record_t *source_value)
+static void	vc_count_zero_bits(zbx_uint64_t value, int *leading, int *trailing)
 {
-	zbx_history_record_t	*value;
-	int			ret = FAIL;
-
-	value = &chunk->slots[index];
+	zbx_uint64_t	bits;
+	int		n;
 
-	switch (item->value_type)
-	{
-		case ITEM_VALUE_TYPE_STR:
-		case ITEM_VALUE_TYPE_TEXT:
-			if (NULL == (value->value.str = vc_item_strdup(item, source_value->value.str)))
-				goto out;
-			break;
-		case ITEM_VALUE_TYPE_LOG:
-			if (NULL == (value->value.log = vc_item_logdup(item, source_value->value.log)))
-				goto out;
-			break;
-		default:
-			value->value = source_value->value;
-	}
-	value->timestamp = source_value->timestamp;
+	for (n = 0, bits = value; 0 == (bits & (__UINT64_C(1) << 63)); bits <<= 1)
+		n++;
+	*leading = n;
 
-	ret = SUCCEED;
-out:
-	return ret;
+	for (n = 0, bits = value; 0 == (bits & 1); bits >>= 1)
+		n++;
+	*trailing = n;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: copies values at the beginning of item tail chunk                 *
- *                                                                            *
- * Parameters: item       - [IN/OUT] the target item                          *
- *             values     - [IN] the values to copy                           *
- *             values_num - [IN] the number of values to copy                 *
+ * Purpose: encodes numeric history values into bit stream                    *
  *                                                                            *
- * Return value: SUCCEED - the values were copied successfully                *
- *               FAIL    - the value copying failed (not enough space for     *
- *                         string, text or log type data)                     *
+ * Parameters: bs         - [IN/OUT] the output bit stream                    *
+ *             values     - [IN] the values to encode                         *
+ *             values_num - [IN] the number of values                         *
  *                                                                            *
- * Comments: This function is used to copy data to cache. The contents of     *
- *           str, text and log type values are stored in cache string pool.   *
+ * Comments: The first value is not encoded and is used as a base for         *
+ *           encoding the next values. The timestamp seconds are encoded as   *
+ *           delta-of-delta, the nanoseconds are stored only when they change *
+ *           and the value bits are encoded as XOR with the previous value.   *
+ *           Floating point and unsigned values share the same 64 bit         *
+ *           representation in history value union, so the same encoding is  *
+ *           used for both types.                                             *
  *                                                                            *
  ******************************************************************************/
-static int	vch_item_copy_values_at_tail(zbx_vc_item_t *item, const zbx_history_record_t *values, int values_num)
+static void	vc_values_encode(vc_bitstream_t *bs, const zbx_history_record_t *values, int values_num)
 {
-	int	i, ret = FAIL, first_value = item->tail->first_value;
+	zbx_int64_t	delta = 0, dod;
+	zbx_uint64_t	xor;
+	int		i, leading, trailing, prev_leading = -1, prev_trailing = 0;
 
-	switch (item->value_type)
+	for (i = 1; i < values_num; i++)
 	{
-		case ITEM_VALUE_TYPE_STR:
-		case ITEM_VALUE_TYPE_TEXT:
-			for (i = values_num - 1; i >= 0; i--)
-			{
-				zbx_history_record_t	*value = &item->tail->slots[item->tail->first_value - 1];
+		const zbx_history_record_t	*prev = &values[i - 1], *value = &values[i];
 
-				if (NULL == (value->value.str = vc_item_strdup(item, values[i].value.str)))
-					goto out;
+		dod = (zbx_int64_t)value->timestamp.sec - prev->timestamp.sec - delta;
+		delta += dod;
 
-				value->timestamp = values[i].timestamp;
-				item->tail->first_value--;
-			}
-			ret = SUCCEED;
+		if (0 == dod)
+		{
+			vc_bitstream_write(bs, 0, 1);
+		}
+		else if (-63 <= dod && 64 >= dod)
+		{
+			vc_bitstream_write(bs, 2, 2);
+			vc_bitstream_write(bs, (zbx_uint64_t)(dod + 63), 7);
+		}
+		else if (-255 <= dod && 256 >= dod)
+		{
+			vc_bitstream_write(bs, 6, 3);
+			vc_bitstream_write(bs, (zbx_uint64_t)(dod + 255), 9);
+		}
+		else if (-2047 <= dod && 2048 >= dod)
+		{
+			vc_bitstream_write(bs, 14, 4);
+			vc_bitstream_write(bs, (zbx_uint64_t)(dod + 2047), 12);
+		}
+		else
+		{
+			vc_bitstream_write(bs, 15, 4);
+			vc_bitstream_write(bs, (zbx_uint32_t)dod, 32);
+		}
 
-			break;
-		case ITEM_VALUE_TYPE_LOG:
-			for (i = values_num - 1; i >= 0; i--)
-			{
-				zbx_history_record_t	*value = &item->tail->slots[item->tail->first_value - 1];
+		if (value->timestamp.ns == prev->timestamp.ns)
+		{
+			vc_bitstream_write(bs, 0, 1);
+		}
+		else
+		{
+			vc_bitstream_write(bs, 1, 1);
+			vc_bitstream_write(bs, (zbx_uint64_t)value->timestamp.ns, 30);
+		}
 
-				if (NULL == (value->value.log = vc_item_logdup(item, values[i].value.log)))
-					goto out;
+		if (0 == (xor = value->value.ui64 ^ prev->value.ui64))
+		{
+			vc_bitstream_write(bs, 0, 1);
+			continue;
+		}
 
-				value->timestamp = values[i].timestamp;
-				item->tail->first_value--;
-			}
-			ret = SUCCEED;
+		vc_count_zero_bits(xor, &leading, &trailing);
 
-			break;
-		default:
-			memcpy(&item->tail->slots[item->tail->first_value - values_num], values,
-					(size_t)values_num * sizeof(zbx_history_record_t));
-			item->tail->first_value -= values_num;
-			ret = SUCCEED;
-	}
-out:
-	item->values_total += first_value - item->tail->first_value;
+		if (-1 != prev_leading && leading >= prev_leading && trailing >= prev_trailing)
+		{
+			/* the meaningful bits fit into the previous window */
+			vc_bitstream_write(bs, 2, 2);
+			vc_bitstream_write(bs, xor >> prev_trailing, 64 - prev_leading - prev_trailing);
+		}
+		else
+		{
+			vc_bitstream_write(bs, 3, 2);
+			vc_bitstream_write(bs, (zbx_uint64_t)leading, 6);
+			vc_bitstream_write(bs, (zbx_uint64_t)(63 - leading - trailing), 6);
+			vc_bitstream_write(bs, xor >> trailing, 64 - leading - trailing);
 
-	return ret;
+			prev_leading = leading;
+			prev_trailing = trailing;
+		}
+	}
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: frees chunk and all resources allocated to store its values       *
- *                                                                            *
- * Parameters: item    - [IN] the chunk owner item                            *
- *             chunk   - [IN] the chunk to free                               *
+ * Purpose: decodes numeric history values from bit stream                    *
  *                                                                            *
- * Return value: the number of bytes freed                                    *
+ * Parameters: bs         - [IN/OUT] the input bit stream                     *
+ *             values     - [IN/OUT] the decoded values, the first value must *
+ *                                   be already set                           *
+ *             values_num - [IN] the number of values                         *
  *                                                                            *
  ******************************************************************************/
-static size_t	vch_item_free_chunk(zbx_vc_item_t *item, zbx_vc_chunk_t *chunk)
+static void	vc_values_decode(vc_bitstream_t *bs, zbx_history_record_t *values, int values_num)
 {
-	size_t	freed;
+	zbx_int64_t	delta = 0, dod;
+	zbx_uint64_t	xor;
+	int		i, leading = 0, trailing = 0;
+
+	for (i = 1; i < values_num; i++)
+	{
+		const zbx_history_record_t	*prev = &values[i - 1];
+		zbx_history_record_t		*value = &values[i];
+
+		if (0 == vc_bitstream_read(bs, 1))
+			dod = 0;
+		else if (0 == vc_bitstream_read(bs, 1))
+			dod = (zbx_int64_t)vc_bitstream_read(bs, 7) - 63;
+		else if (0 == vc_bitstream_read(bs, 1))
+			dod = (zbx_int64_t)vc_bitstream_read(bs, 9) - 255;
+		else if (0 == vc_bitstream_read(bs, 1))
+			dod = (zbx_int64_t)vc_bitstream_read(bs, 12) - 2047;
+		else
+			dod = (int)vc_bitstream_read(bs, 32);
 
-	freed = sizeof(zbx_vc_chunk_t) + (size_t)(chunk->slots_num - 1) * sizeof(zbx_history_record_t);
-	freed += vc_item_free_values(item, chunk->slots, chunk->first_value, chunk->last_value);
+		delta += dod;
+		value->timestamp.sec = (int)(prev->timestamp.sec + delta);
 
-	__vc_shmem_free_func(chunk);
+		if (0 == vc_bitstream_read(bs, 1))
+			value->timestamp.ns = prev->timestamp.ns;
+		else
+			value->timestamp.ns = (int)vc_bitstream_read(bs, 30);
 
-	return freed;
+		if (0 == vc_bitstream_read(bs, 1))
+		{
+			xor = 0;
+		}
+		else
+		{
+			if (1 == vc_bitstream_read(bs, 1))
+			{
+				leading = (int)vc_bitstream_read(bs, 6);
+				trailing = 63 - leading - (int)vc_bitstream_read(bs, 6);
+			}
+
+			xor = vc_bitstream_read(bs, 64 - leading - trailing) << trailing;
+		}
+
+		value->value.ui64 = prev->value.ui64 ^ xor;
+	}
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: removes item history data chunk                                   *
+ * Purpose: gets the last (newest) value of chunk                             *
  *                                                                            *
- * Parameters: item    - [IN ] the chunk owner item                           *
- *             chunk   - [IN] the chunk to remove                             *
+ ******************************************************************************/
+static const zbx_history_record_t	*vch_chunk_last_value(const zbx_vc_chunk_t *chunk)
+{
+	if (0 != chunk->packed_size)
+		return &chunk->slots[1];
+
+	return &chunk->slots[chunk->last_value];
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets chunk values in a form accessible by value index             *
+ *                                                                            *
+ * Parameters: chunk  - [IN] the chunk                                        *
+ *             buffer - [IN/OUT] the buffer for decoding packed chunk values  *
+ *                                                                            *
+ * Return value: The chunk values, indexed from chunk first_value to          *
+ *               last_value. For packed chunks the values are valid until the *
+ *               buffer is reused.                                            *
  *                                                                            *
  ******************************************************************************/
-static void	vch_item_remove_chunk(zbx_vc_item_t *item, zbx_vc_chunk_t *chunk)
+static const zbx_history_record_t	*vch_chunk_get_slots(const zbx_vc_chunk_t *chunk,
+		zbx_vector_history_record_t *buffer)
 {
-	if (NULL != chunk->next)
-		chunk->next->prev = chunk->prev;
+	vc_bitstream_t	bs;
 
-	if (NULL != chunk->prev)
-		chunk->prev->next = chunk->next;
+	if (0 == chunk->packed_size)
+		return chunk->slots;
 
-	if (chunk == item->head)
-		item->head = chunk->prev;
+	zbx_vector_history_record_reserve(buffer, (size_t)chunk->slots_num);
+	buffer->values[0] = chunk->slots[0];
 
-	if (chunk == item->tail)
-		item->tail = chunk->next;
+	bs.data = (unsigned char *)&chunk->slots[2];
+	bs.offset = 0;
+	vc_values_decode(&bs, buffer->values, chunk->slots_num);
+	buffer->values_num = chunk->slots_num;
 
-	vch_item_free_chunk(item, chunk);
+	return buffer->values;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: removes item history data that are outside (older) the maximum    *
- *          request range                                                     *
+ * Purpose: checks if chunk contains values of periods with running           *
+ *          aggregates                                                        *
  *                                                                            *
- * Parameters:  item      - [IN] the target item                              *
- *              timestamp - [IN] last timestamp in active range               *
+ * Return value: SUCCEED - the chunk contains values of at least one period   *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: Chunks containing period values are not packed, so the values    *
+ *           can be removed from running aggregates without decoding chunk.   *
  *                                                                            *
  ******************************************************************************/
-static void	vch_item_clean_cache(zbx_vc_item_t *item, int timestamp)
+static int	vch_item_windows_hold_chunk(const zbx_vc_item_t *item, const zbx_vc_chunk_t *chunk)
 {
-	zbx_vc_chunk_t	*next;
+	int	i;
 
-	if (0 != item->active_range)
+	for (i = 0; i < item->windows_num; i++)
 	{
-		zbx_vc_chunk_t	*tail = item->tail;
-		zbx_vc_chunk_t	*chunk = tail;
+		const zbx_vc_window_t	*window = &item->windows[i];
 
-		timestamp -= item->active_range;
+		if (ZBX_VC_WINDOW_INVALID == window->values_num)
+			continue;
 
-		/* Try to remove chunks with all history values older than maximum request range, maximum */
-		/* request range should be calculated from last received value with which active range    */
-		/* was calculated to avoid dropping of chunks that might be still used in count request.  */
-		while (NULL != chunk && chunk->slots[chunk->last_value].timestamp.sec < timestamp &&
-				chunk->slots[chunk->last_value].timestamp.sec !=
-						item->head->slots[item->head->last_value].timestamp.sec)
+		if (window->chunk == chunk || 0 >= zbx_timespec_compare(&window->chunk->slots[window->index].timestamp,
+				&vch_chunk_last_value(chunk)->timestamp))
 		{
-			/* don't remove the head chunk */
-			if (NULL == (next = chunk->next))
-				break;
-
-			/* Values with the same timestamps (seconds resolution) always should be either   */
-			/* kept in cache or removed together. There should not be a case when one of them */
-			/* is in cache and the second is dropped.                                         */
-			/* Here we are handling rare case, when the last value of first chunk has the     */
-			/* same timestamp (seconds resolution) as the first value in the second chunk.    */
-			/* In this case increase the first value index of the next chunk until the first  */
-			/* value timestamp is greater.                                                    */
-
-			if (next->slots[next->first_value].timestamp.sec != next->slots[next->last_value].timestamp.sec)
-			{
-				while (next->slots[next->first_value].timestamp.sec ==
-						chunk->slots[chunk->last_value].timestamp.sec)
-				{
-					vc_item_free_values(item, next->slots, next->first_value, next->first_value);
-					next->first_value++;
-				}
-			}
-
-			/* set the database cached from timestamp to the last (oldest) removed value timestamp + 1 */
-			item->db_cached_from = chunk->slots[chunk->last_value].timestamp.sec + 1;
-
-			vch_item_remove_chunk(item, chunk);
-
-			chunk = next;
+			return SUCCEED;
 		}
-
-		/* reset the status flags if data was removed from cache */
-		if (tail != item->tail)
-			item->status = 0;
 	}
+
+	return FAIL;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: removes item history data that are older than the specified       *
- *          timestamp                                                         *
+ * Purpose: invalidates running aggregates of periods starting with the value *
+ *          being removed from cache                                          *
  *                                                                            *
- * Parameters:  item      - [IN] the target item                              *
- *              timestamp - [IN] the timestamp (number of seconds since the   *
- *                               Epoch)                                       *
+ * Parameters: item  - [IN/OUT] the item                                      *
+ *             chunk - [IN] the chunk with removed values, NULL to invalidate *
+ *                          all periods                                       *
+ *             index - [IN] the index of the first value left in chunk        *
  *                                                                            *
  ******************************************************************************/
-static void	vch_item_remove_values(zbx_vc_item_t *item, int timestamp)
+static void	vch_item_windows_invalidate(zbx_vc_item_t *item, const zbx_vc_chunk_t *chunk, int index)
 {
-	zbx_vc_chunk_t	*chunk = item->tail;
-
-	if (ZBX_ITEM_STATUS_CACHED_ALL == item->status)
-		item->status = 0;
+	int	i;
 
-	/* try to remove chunks with all history values older than the timestamp */
-	while (NULL != chunk && chunk->slots[chunk->first_value].timestamp.sec < timestamp)
+	for (i = 0; i < item->windows_num; i++)
 	{
-		zbx_vc_chunk_t	*next;
-
-		/* If chunk contains values with timestamp greater or equal - remove */
-		/* only the values with less timestamp. Otherwise remove the while   */
-		/* chunk and check next one.                                         */
-		if (chunk->slots[chunk->last_value].timestamp.sec >= timestamp)
-		{
-			while (chunk->slots[chunk->first_value].timestamp.sec < timestamp)
-			{
-				vc_item_free_values(item, chunk->slots, chunk->first_value, chunk->first_value);
-				chunk->first_value++;
-			}
-
-			break;
-		}
+		zbx_vc_window_t	*window = &item->windows[i];
 
-		next = chunk->next;
-		vch_item_remove_chunk(item, chunk);
-		chunk = next;
+		if (NULL == chunk || (window->chunk == chunk && window->index < index))
+			window->values_num = ZBX_VC_WINDOW_INVALID;
 	}
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: adds one item history value at the end of current item's history  *
- *          data                                                              *
- *                                                                            *
- * Parameters:  item   - [IN] the item to add history data to                 *
- *              value  - [IN] the item history data value                     *
- *                                                                            *
- * Return value: SUCCEED - the history data value was added successfully      *
- *               FAIL - failed to add history data value (not enough memory)  *
- *                                                                            *
- * Comments: In the case of failure the item will be removed from cache       *
- *           later.                                                           *
+ * Purpose: replaces chunk in item's history data list                        *
  *                                                                            *
  ******************************************************************************/
-static int	vch_item_add_value_at_head(zbx_vc_item_t *item, const zbx_history_record_t *value)
+static void	vch_item_replace_chunk(zbx_vc_item_t *item, zbx_vc_chunk_t *chunk, zbx_vc_chunk_t *new_chunk)
 {
-	int		ret = FAIL, index, sindex, nslots = 0;
-	zbx_vc_chunk_t	*chunk, *schunk;
+	int	i;
 
-	if (NULL != item->head &&
-			0 < zbx_history_record_compare_asc_func(&item->head->slots[item->head->last_value], value))
+	for (i = 0; i < item->windows_num; i++)
 	{
-		if (0 < zbx_history_record_compare_asc_func(&item->tail->slots[item->tail->first_value], value))
-		{
-			/* If the added value has the same or older timestamp as the first value in cache */
-			/* we can't add it to keep cache consistency. Additionally we must make sure no   */
-			/* values with matching timestamp seconds are kept in cache.                      */
-			vch_item_remove_values(item, value->timestamp.sec + 1);
-
-			/* empty items must be removed to avoid situation when a new value is added to cache */
-			/* while other values with matching timestamp seconds are not cached                 */
-			if (NULL == item->head)
-				goto out;
-
-			/* if the value is newer than the database cached from timestamp we must */
-			/* adjust the cached from timestamp to exclude this value                */
-			if (item->db_cached_from <= value->timestamp.sec)
-				item->db_cached_from = value->timestamp.sec + 1;
-
-			ret = SUCCEED;
-			goto out;
-		}
+		if (item->windows[i].chunk == chunk)
+			item->windows[i].chunk = new_chunk;
+	}
 
-		sindex = item->head->last_value;
-		schunk = item->head;
+	new_chunk->prev = chunk->prev;
+	new_chunk->next = chunk->next;
 
-		if (0 == item->head->slots_num - item->head->last_value - 1)
-		{
-			if (FAIL == vch_item_add_chunk(item, vch_item_chunk_slot_count(item, 1), NULL))
-				goto out;
-		}
-		else
-			item->head->last_value++;
+	if (NULL != chunk->prev)
+		chunk->prev->next = new_chunk;
+	else
+		item->tail = new_chunk;
 
-		item->values_total++;
+	if (NULL != chunk->next)
+		chunk->next->prev = new_chunk;
+	else
+		item->head = new_chunk;
 
-		chunk = item->head;
-		index = item->head->last_value;
+	__vc_shmem_free_func(chunk);
+}
 
-		do
-		{
-			chunk->slots[index] = schunk->slots[sindex];
+/******************************************************************************
+ *                                                                            *
+ * Purpose: packs chunk values to reduce the memory used by chunk             *
+ *                                                                            *
+ * Parameters: item  - [IN/OUT] the chunk owner item                          *
+ *             chunk - [IN] the chunk to pack                                 *
+ *                                                                            *
+ * Comments: Only chunks of numeric items are packed. The chunk is left as    *
+ *           it is if packing does not reduce its size, there is not enough   *
+ *           memory to allocate packed chunk or the chunk contains values of  *
+ *           periods with running aggregates.                                 *
+ *                                                                            *
+ ******************************************************************************/
+static void	vch_item_pack_chunk(zbx_vc_item_t *item, zbx_vc_chunk_t *chunk)
+{
+	zbx_vc_chunk_t	*packed;
+	vc_bitstream_t	bs;
+	int		values_num;
+	size_t		data_size, size;
 
-			chunk = schunk;
-			index = sindex;
+	if (ITEM_VALUE_TYPE_FLOAT != item->value_type && ITEM_VALUE_TYPE_UINT64 != item->value_type)
+		return;
 
-			if (--sindex < schunk->first_value)
-			{
-				if (NULL == (schunk = schunk->prev))
-				{
-					memset(&chunk->slots[index], 0, sizeof(zbx_vc_chunk_t));
-					THIS_SHOULD_NEVER_HAPPEN;
+	if (0 != chunk->packed_size || 2 > (values_num = chunk->last_value - chunk->first_value + 1))
+		return;
 
-					goto out;
-				}
+	if (SUCCEED == vch_item_windows_hold_chunk(item, chunk))
+		return;
 
-				sindex = schunk->last_value;
-			}
-		}
-		while (0 < zbx_timespec_compare(&schunk->slots[sindex].timestamp, &value->timestamp));
-	}
-	else
-	{
-		/* find the number of free slots on the right side in last (head) chunk */
-		if (NULL != item->head)
-			nslots = item->head->slots_num - item->head->last_value - 1;
+	/* each value is encoded with less than sizeof(zbx_history_record_t) bytes */
+	data_size = (size_t)values_num * sizeof(zbx_history_record_t);
+	bs.data = (unsigned char *)zbx_malloc(NULL, data_size);
+	memset(bs.data, 0, data_size);
+	bs.offset = 0;
 
-		if (0 == nslots)
-		{
-			if (FAIL == vch_item_add_chunk(item, vch_item_chunk_slot_count(item, 1), NULL))
-				goto out;
-		}
-		else
-			item->head->last_value++;
+	vc_values_encode(&bs, chunk->slots + chunk->first_value, values_num);
 
-		item->values_total++;
+	data_size = (bs.offset + 7) >> 3;
+	size = sizeof(zbx_vc_chunk_t) + sizeof(zbx_history_record_t) + data_size;
 
-		chunk = item->head;
-		index = item->head->last_value;
-	}
+	if (size >= sizeof(zbx_vc_chunk_t) + (size_t)(chunk->slots_num - 1) * sizeof(zbx_history_record_t))
+		goto out;
 
-	if (SUCCEED != vch_item_copy_value(item, chunk, index, value))
+	if (NULL == (packed = (zbx_vc_chunk_t *)__vc_shmem_malloc_func(NULL, size)))
 		goto out;
 
-	ret = SUCCEED;
+	packed->first_value = 0;
+	packed->last_value = values_num - 1;
+	packed->slots_num = values_num;
+	packed->packed_size = (int)data_size;
+	packed->slots[0] = chunk->slots[chunk->first_value];
+	packed->slots[1] = chunk->slots[chunk->last_value];
+	memcpy(&packed->slots[2], bs.data, data_size);
+
+	vch_item_replace_chunk(item, chunk, packed);
 out:
-	return ret;
+	zbx_free(bs.data);
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: adds item history values at the beginning of current item's       *
- *          history data                                                      *
- *                                                                            *
- * Parameters:  item   - [IN] the item to add history data to                 *
- *              values - [IN] the item history data values                    *
- *              num    - [IN] the number of history data values to add        *
+ * Purpose: unpacks chunk values back to slots so they can be modified        *
  *                                                                            *
- * Return value: SUCCEED - the history data values were added successfully    *
- *               FAIL - failed to add history data values (not enough memory) *
+ * Parameters: item  - [IN/OUT] the chunk owner item                          *
+ *             chunk - [IN] the packed chunk                                  *
  *                                                                            *
- * Comments: In the case of failure the item is removed from cache.           *
- *           Overlapping values (by timestamp seconds) are ignored.           *
+ * Return value: the unpacked chunk or NULL if there is not enough memory     *
  *                                                                            *
  ******************************************************************************/
-static int	vch_item_add_values_at_tail(zbx_vc_item_t *item, const zbx_history_record_t *values, int values_num)
+static zbx_vc_chunk_t	*vch_item_unpack_chunk(zbx_vc_item_t *item, zbx_vc_chunk_t *chunk)
 {
-	int 	count = values_num, ret = FAIL;
+	zbx_vc_chunk_t	*unpacked;
+	vc_bitstream_t	bs;
 
-	/* skip values already added to the item cache by another process */
-	if (NULL != item->tail)
+	if (NULL == (unpacked = (zbx_vc_chunk_t *)vc_item_malloc(item, sizeof(zbx_vc_chunk_t) +
+			(size_t)(chunk->slots_num - 1) * sizeof(zbx_history_record_t))))
 	{
-		int	sec = item->tail->slots[item->tail->first_value].timestamp.sec;
-
-		while (--count >= 0 && values[count].timestamp.sec >= sec)
-			;
-		++count;
+		return NULL;
 	}
 
-	while (0 != count)
-	{
-		int	copy_slots, nslots = 0;
-
-		/* find the number of free slots on the left side in first (tail) chunk */
-		if (NULL != item->tail)
-			nslots = item->tail->first_value;
+	unpacked->first_value = chunk->first_value;
+	unpacked->last_value = chunk->last_value;
+	unpacked->slots_num = chunk->slots_num;
+	unpacked->packed_size = 0;
+	unpacked->slots[0] = chunk->slots[0];
 
-		if (0 == nslots)
-		{
-			nslots = vch_item_chunk_slot_count(item, count);
+	bs.data = (unsigned char *)&chunk->slots[2];
+	bs.offset = 0;
+	vc_values_decode(&bs, unpacked->slots, chunk->slots_num);
 
-			if (FAIL == vch_item_add_chunk(item, nslots, item->tail))
-				goto out;
+	vch_item_replace_chunk(item, chunk, unpacked);
 
-			item->tail->last_value = nslots - 1;
-			item->tail->first_value = nslots;
-		}
+	return unpacked;
+}
 
-		/* copy values to chunk */
-		copy_slots = MIN(nslots, count);
-		count -= copy_slots;
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds value to period running compensated sum                      *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_window_sum_add(zbx_vc_window_t *window, double value)
+{
+	double	sum = window->sum + value;
 
-		if (FAIL == vch_item_copy_values_at_tail(item, values + count, copy_slots))
-			goto out;
-	}
+	if (fabs(window->sum) >= fabs(value))
+		window->sum_comp += (window->sum - sum) + value;
+	else
+		window->sum_comp += (value - sum) + window->sum;
 
-	ret = SUCCEED;
-out:
-	return ret;
+	window->sum = sum;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: cache item history data for the specified time period             *
- *                                                                            *
- * Parameters: item        - [IN] the item                                    *
- *             range_start - [IN] the interval start time                     *
+ * Purpose: returns period running sum                                        *
  *                                                                            *
- * Return value:  >=0    - the number of values read from database            *
- *                FAIL   - an error occurred while trying to cache values     *
+ ******************************************************************************/
+static double	vc_window_sum(const zbx_vc_window_t *window)
+{
+	return window->sum + window->sum_comp;
+}
+
+/******************************************************************************
  *                                                                            *
- * Comments: This function checks if the requested value range is cached and  *
- *           updates cache from database if necessary.                        *
+ * Purpose: adds value to period running aggregates                           *
  *                                                                            *
  ******************************************************************************/
-static int	vch_item_cache_values_by_time(zbx_vc_item_t **item, int range_start)
+static void	vc_window_add_value(zbx_vc_window_t *window, unsigned char value_type, const zbx_history_value_t *value)
 {
-	int				ret, range_end;
-	zbx_vector_history_record_t	records;
-	zbx_uint64_t			itemid;
-	unsigned char			value_type;
+	int	min_cmp, max_cmp;
 
-	if (ZBX_ITEM_STATUS_CACHED_ALL == (*item)->status)
-		return SUCCEED;
+	if (ITEM_VALUE_TYPE_FLOAT == value_type)
+	{
+		vc_window_sum_add(window, value->dbl);
+		min_cmp = (value->dbl > window->min.dbl) - (value->dbl < window->min.dbl);
+		max_cmp = (value->dbl > window->max.dbl) - (value->dbl < window->max.dbl);
+	}
+	else
+	{
+		vc_window_sum_add(window, (double)value->ui64);
+		window->sum_ui64 += value->ui64;
+		min_cmp = (value->ui64 > window->min.ui64) - (value->ui64 < window->min.ui64);
+		max_cmp = (value->ui64 > window->max.ui64) - (value->ui64 < window->max.ui64);
+	}
 
-	/* check if the requested period is in the cached range */
-	if (0 != (*item)->db_cached_from && range_start >= (*item)->db_cached_from)
-		return SUCCEED;
-
-	/* find if the cache should be updated to cover the required range */
-	if (NULL != (*item)->tail)
+	if (0 == window->values_num || 0 > min_cmp)
 	{
-		/* we need to get item values before the first cached value, but not including it */
-		range_end = (*item)->tail->slots[(*item)->tail->first_value].timestamp.sec - 1;
+		window->min = *value;
+		window->min_num = 1;
 	}
-	else
-		range_end = ZBX_JAN_2038;
-
-	/* update cache if necessary */
-	if (range_start >= range_end)
-		return SUCCEED;
-
-	zbx_vector_history_record_create(&records);
-	itemid = (*item)->itemid;
-	value_type = (*item)->value_type;
-
-	UNLOCK_CACHE;
+	else if (0 == min_cmp)
+		window->min_num++;
 
-	if (SUCCEED == (ret = vc_db_read_values_by_time(itemid, value_type, &records, range_start, range_end)))
+	if (0 == window->values_num || 0 < max_cmp)
 	{
-		zbx_vector_history_record_sort(&records,
-				(zbx_compare_func_t)zbx_history_record_compare_asc_func);
+		window->max = *value;
+		window->max_num = 1;
 	}
+	else if (0 == max_cmp)
+		window->max_num++;
 
-	WRLOCK_CACHE;
+	window->values_num++;
+}
 
-	if (SUCCEED != ret)
-		goto out;
+/******************************************************************************
+ *                                                                            *
+ * Purpose: removes value from period running aggregates                      *
+ *                                                                            *
+ * Return value: SUCCEED - the minimum and maximum values are still valid     *
+ *               FAIL    - the last minimum or maximum value was removed      *
+ *                                                                            *
+ ******************************************************************************/
+static int	vc_window_remove_value(zbx_vc_window_t *window, unsigned char value_type,
+		const zbx_history_value_t *value)
+{
+	int	ret = SUCCEED, is_min, is_max;
 
-	if (NULL == (*item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &itemid)))
+	if (ITEM_VALUE_TYPE_FLOAT == value_type)
 	{
-		zbx_vc_item_t	new_item = {.itemid = itemid, .value_type = value_type};
-
-		if (NULL == (*item = (zbx_vc_item_t *)zbx_hashset_insert(&vc_cache->items, &new_item,
-				sizeof(new_item))))
-		{
-			ret = FAIL;
-			goto out;
-		}
+		vc_window_sum_add(window, -value->dbl);
+		is_min = (value->dbl == window->min.dbl);
+		is_max = (value->dbl == window->max.dbl);
+	}
+	else
+	{
+		vc_window_sum_add(window, -(double)value->ui64);
+		window->sum_ui64 -= value->ui64;
+		is_min = (value->ui64 == window->min.ui64);
+		is_max = (value->ui64 == window->max.ui64);
 	}
 
-	/* when updating cache with time based request we can always reset status flags */
-	/* flag even if the requested period contains no data                           */
-	(*item)->status = 0;
-
-	if (0 < records.values_num)
+	if (0 == --window->values_num)
 	{
-		if (SUCCEED != (ret = vch_item_add_values_at_tail(*item, records.values, records.values_num)))
-			goto out;
+		window->sum = 0;
+		window->sum_comp = 0;
+		window->sum_ui64 = 0;
 	}
 
-	ret = records.values_num;
-	vc_item_update_db_cached_from(*item, range_start);
-out:
-	zbx_history_record_vector_destroy(&records, value_type);
+	if (0 != is_min && 0 == --window->min_num)
+		ret = FAIL;
+
+	if (0 != is_max && 0 == --window->max_num)
+		ret = FAIL;
 
 	return ret;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: cache the specified number of history data values for time period *
- *          since timestamp                                                   *
- *                                                                            *
- * Parameters: item        - [IN] the item                                    *
- *             range_start - [IN] the interval start time                     *
- *             count       - [IN] the number of history values to retrieve    *
- *             ts          - [IN] the target timestamp                        *
- *                                                                            *
- * Return value:  >=0    - the number of values read from database            *
- *                FAIL   - an error occurred while trying to cache values     *
- *                                                                            *
- * Comments: This function checks if the requested number of values is cached *
- *           and updates cache from database if necessary.                    *
+ * Purpose: calculates period running aggregates from the oldest period value *
+ *          to the last item value                                            *
  *                                                                            *
  ******************************************************************************/
-static int	vch_item_cache_values_by_time_and_count(zbx_vc_item_t **item, int range_start, int count,
-		const zbx_timespec_t *ts)
+static void	vch_item_window_calculate(const zbx_vc_item_t *item, zbx_vc_window_t *window)
 {
-	int				ret = SUCCEED, cached_records = 0, range_end, records_offset;
-	zbx_vector_history_record_t	records;
-	zbx_uint64_t			itemid;
-	unsigned char			value_type;
+	const zbx_vc_chunk_t	*chunk;
+	int			index = window->index;
 
-	if (ZBX_ITEM_STATUS_CACHED_ALL == (*item)->status)
-		return SUCCEED;
-
-	/* check if the requested period is in the cached range */
-	if (0 != (*item)->db_cached_from && range_start >= (*item)->db_cached_from)
-		return SUCCEED;
+	window->values_num = 0;
+	window->removed_num = 0;
+	window->sum = 0;
+	window->sum_comp = 0;
+	window->sum_ui64 = 0;
 
-	/* find if the cache should be updated to cover the required count */
-	if (0 != (*item)->db_cached_from && NULL != (*item)->head)
+	for (chunk = window->chunk; NULL != chunk; chunk = chunk->next)
 	{
-		zbx_vc_chunk_t	*chunk;
-		int		index;
+		const zbx_history_record_t	*slots;
 
-		if (SUCCEED == vch_item_get_last_value(*item, ts, &chunk, &index))
-		{
-			cached_records = index - chunk->first_value + 1;
+		slots = vch_chunk_get_slots(chunk, &vc_unpack_buffer);
 
-			while (NULL != (chunk = chunk->prev) && cached_records < count)
-				cached_records += chunk->last_value - chunk->first_value + 1;
-		}
+		if (chunk != window->chunk)
+			index = chunk->first_value;
+
+		for (; index <= chunk->last_value; index++)
+			vc_window_add_value(window, item->value_type, &slots[index].value);
 	}
+}
 
-	/* update cache if necessary */
-	if (cached_records >= count)
-		return SUCCEED;
+/******************************************************************************
+ *                                                                            *
+ * Purpose: initializes period running aggregates from cached values          *
+ *                                                                            *
+ * Parameters: item   - [IN/OUT] the item                                     *
+ *             window - [IN/OUT] the period                                   *
+ *                                                                            *
+ * Comments: The aggregates are left invalid if not all period values are     *
+ *           cached.                                                          *
+ *                                                                            *
+ ******************************************************************************/
+static void	vch_item_window_init(zbx_vc_item_t *item, zbx_vc_window_t *window)
+{
+	zbx_vc_chunk_t			*chunk;
+	const zbx_history_record_t	*slots;
+	zbx_timespec_t			start;
+	int				index;
 
-	/* get the end timestamp to which (including) the values should be cached */
-	if (0 != (*item)->db_cached_from && NULL != (*item)->head)
-		range_end = (*item)->tail->slots[(*item)->tail->first_value].timestamp.sec - 1;
-	else
-		range_end = ZBX_JAN_2038;
+	window->values_num = ZBX_VC_WINDOW_INVALID;
 
-	itemid = (*item)->itemid;
-	value_type = (*item)->value_type;
-	UNLOCK_CACHE;
+	if (NULL == item->head)
+		return;
 
-	zbx_vector_history_record_create(&records);
+	start = item->head->slots[item->head->last_value].timestamp;
+	start.sec -= window->period;
 
-	if (range_end > ts->sec)
+	if (ZBX_ITEM_STATUS_CACHED_ALL != item->status && (0 == item->db_cached_from ||
+			item->db_cached_from > start.sec))
 	{
-		ret = vc_db_read_values_by_time(itemid, value_type, &records, ts->sec + 1, range_end);
-		range_end = ts->sec;
+		return;
 	}
 
-	records_offset = records.values_num;
-
-	if (SUCCEED == ret && SUCCEED == (ret = vc_db_read_values_by_time_and_count(itemid, value_type, &records,
-			range_start, count - cached_records, range_end, ts)))
+	/* find the chunk containing the oldest period value */
+	for (chunk = item->head; NULL != chunk->prev; chunk = chunk->prev)
 	{
-		zbx_vector_history_record_sort(&records,
-				(zbx_compare_func_t)zbx_history_record_compare_asc_func);
+		if (0 >= zbx_timespec_compare(&chunk->slots[chunk->first_value].timestamp, &start))
+			break;
 	}
 
-	WRLOCK_CACHE;
-
-	if (SUCCEED != ret)
-		goto out;
+	slots = vch_chunk_get_slots(chunk, &vc_unpack_buffer);
 
-	if (NULL == (*item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &itemid)))
+	for (index = chunk->first_value; index <= chunk->last_value; index++)
 	{
-		zbx_vc_item_t	new_item = {.itemid = itemid, .value_type = value_type};
-
-		if (NULL == (*item = (zbx_vc_item_t *)zbx_hashset_insert(&vc_cache->items, &new_item, sizeof(new_item))))
-		{
-			ret = FAIL;
-			goto out;
-		}
+		if (0 < zbx_timespec_compare(&slots[index].timestamp, &start))
+			break;
 	}
 
-	if (0 < records.values_num)
-		ret = vch_item_add_values_at_tail(*item, records.values, records.values_num);
-
-	if (SUCCEED != ret)
-		goto out;
-
-	ret = records.values_num;
-
-	if (0 == range_start && count - cached_records > records.values_num - records_offset)
+	/* the last item value is always in period, so the next chunk exists */
+	if (index > chunk->last_value)
 	{
-		(*item)->active_range = 0;
-		(*item)->daily_range = 0;
-		(*item)->status = ZBX_ITEM_STATUS_CACHED_ALL;
+		chunk = chunk->next;
+		index = chunk->first_value;
 	}
 
-	if ((count <= records.values_num || 0 == range_start) && 0 != records.values_num)
-	{
-		vc_item_update_db_cached_from(*item,
-				(*item)->tail->slots[(*item)->tail->first_value].timestamp.sec);
-	}
-	else if (0 != range_start)
-		vc_item_update_db_cached_from(*item, range_start);
+	if (0 != chunk->packed_size && NULL == (chunk = vch_item_unpack_chunk(item, chunk)))
+		return;
 
-out:
-	zbx_history_record_vector_destroy(&records, value_type);
+	window->chunk = chunk;
+	window->index = index;
 
-	return ret;
+	vch_item_window_calculate(item, window);
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: retrieves item history data from cache                            *
+ * Purpose: updates running aggregates after a new value was added at the     *
+ *          end of item history data                                          *
  *                                                                            *
- * Parameters: item      - [IN] the item                                      *
- *             values    - [OUT] the item history data stored time/value      *
- *                         pairs in undefined order                           *
- *             seconds   - [IN] the time period to retrieve data for          *
- *             ts        - [IN] the requested period end timestamp            *
+ * Parameters: item - [IN/OUT] the item                                       *
  *                                                                            *
  ******************************************************************************/
-static void	vch_item_get_values_by_time(const zbx_vc_item_t *item, zbx_vector_history_record_t *values, int seconds,
-		const zbx_timespec_t *ts)
+static void	vch_item_windows_add_value(zbx_vc_item_t *item)
 {
-	int		index, now;
-	zbx_timespec_t	start = {ts->sec - seconds, ts->ns};
-	zbx_vc_chunk_t	*chunk;
+	const zbx_history_record_t	*value = &item->head->slots[item->head->last_value];
+	int				i, now;
+
+	if (0 == item->windows_num)
+		return;
 
 	now = (int)time(NULL);
-	/* add another second to include nanosecond shifts */
-	vc_cache_item_update(item->itemid, ZBX_VC_UPDATE_RANGE, seconds + now - ts->sec + 1, now);
 
-	if (FAIL == vch_item_get_last_value(item, ts, &chunk, &index))
+	for (i = 0; i < item->windows_num; i++)
 	{
-		/* Cache does not contain records for the specified timeshift & seconds range. */
-		/* Return empty vector with success.                                           */
-		return;
-	}
+		zbx_vc_window_t	*window = &item->windows[i];
+		zbx_timespec_t	start;
+		int		minmax = SUCCEED;
 
-	/* fill the values vector with item history values until the start timestamp is reached */
-	while (0 < zbx_timespec_compare(&chunk->slots[chunk->last_value].timestamp, &start))
-	{
-		while (index >= chunk->first_value && 0 < zbx_timespec_compare(&chunk->slots[index].timestamp, &start))
-			vc_history_record_vector_append(values, item->value_type, &chunk->slots[index--]);
+		/* drop periods that are not requested anymore */
+		if (window->lastaccess < now - ZBX_VC_ITEM_EXPIRE_PERIOD)
+		{
+			item->windows[i--] = item->windows[--item->windows_num];
+			continue;
+		}
 
-		if (NULL == (chunk = chunk->prev))
-			break;
+		if (ZBX_VC_WINDOW_INVALID == window->values_num)
+			continue;
 
-		index = chunk->last_value;
+		vc_window_add_value(window, item->value_type, &value->value);
+
+		start = value->timestamp;
+		start.sec -= window->period;
+
+		/* remove values that are out of period, the added value is always in period */
+		while (0 >= zbx_timespec_compare(&window->chunk->slots[window->index].timestamp, &start))
+		{
+			if (SUCCEED != vc_window_remove_value(window, item->value_type,
+					&window->chunk->slots[window->index].value))
+			{
+				minmax = FAIL;
+			}
+
+			window->removed_num++;
+
+			if (++window->index > window->chunk->last_value)
+			{
+				zbx_vc_chunk_t	*chunk = window->chunk;
+
+				window->chunk = chunk->next;
+				window->index = window->chunk->first_value;
+
+				if (0 != window->chunk->packed_size &&
+						NULL == vch_item_unpack_chunk(item, window->chunk))
+				{
+					window->values_num = ZBX_VC_WINDOW_INVALID;
+					break;
+				}
+
+				/* pack the chunk left behind unless it still contains values of other periods */
+				vch_item_pack_chunk(item, chunk);
+			}
+		}
+
+		if (ZBX_VC_WINDOW_INVALID == window->values_num)
+			continue;
+
+		if (SUCCEED != minmax || window->removed_num >= window->values_num)
+			vch_item_window_calculate(item, window);
 	}
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: retrieves item history data from cache                            *
+ * Purpose: adds period with running aggregates or updates its last access    *
+ *          time                                                              *
  *                                                                            *
- * Parameters: item      - [IN] the item                                      *
- *             values    - [OUT] the item history data stored time/value      *
- *                         pairs in undefined order, optional                 *
- *                         If null then cache is updated if necessary, but no *
- *                         values are returned. Used to ensure that cache     *
- *                         contains a value of the specified timestamp.       *
- *             seconds   - [IN] the time period                               *
- *             count     - [IN] the number of history values to retrieve      *
- *             timestamp - [IN] the target timestamp                          *
+ * Parameters: item   - [IN/OUT] the item                                     *
+ *             period - [IN] the period length in seconds                     *
+ *             now    - [IN] the period request time                          *
  *                                                                            *
  ******************************************************************************/
-static void	vch_item_get_values_by_time_and_count(zbx_vc_item_t *item, zbx_vector_history_record_t *values,
-		int seconds, int count, const zbx_timespec_t *ts)
+static void	vch_item_update_window(zbx_vc_item_t *item, int period, int now)
 {
-	int		index, now, range_timestamp;
-	zbx_vc_chunk_t	*chunk;
-	zbx_timespec_t	start;
+	zbx_vc_window_t	*window = NULL;
+	int		i;
 
-	/* set start timestamp of the requested time period */
-	if (0 != seconds)
-	{
-		start.sec = ts->sec - seconds;
-		start.ns = ts->ns;
-	}
-	else
-	{
-		start.sec = 0;
-		start.ns = 0;
-	}
+	if (ITEM_VALUE_TYPE_FLOAT != item->value_type && ITEM_VALUE_TYPE_UINT64 != item->value_type)
+		return;
 
-	if (FAIL == vch_item_get_last_value(item, ts, &chunk, &index))
+	for (i = 0; i < item->windows_num; i++)
 	{
-		/* return empty vector with success */
-		goto out;
+		if (item->windows[i].period == period)
+		{
+			window = &item->windows[i];
+			break;
+		}
 	}
 
-	/* fill the values vector with item history values until the <count> values are read    */
-	/* or no more values within specified time period                                       */
-	/* fill the values vector with item history values until the start timestamp is reached */
-	while (0 < zbx_timespec_compare(&chunk->slots[chunk->last_value].timestamp, &start))
+	if (NULL == window)
 	{
-		while (index >= chunk->first_value && 0 < zbx_timespec_compare(&chunk->slots[index].timestamp, &start))
-		{
-			vc_history_record_vector_append(values, item->value_type, &chunk->slots[index--]);
+		if (ZBX_VC_ITEM_WINDOWS_MAX == item->windows_num)
+			return;
 
-			if (values->values_num == count)
-				goto out;
+		if (NULL == item->windows && NULL == (item->windows = (zbx_vc_window_t *)__vc_shmem_malloc_func(NULL,
+				sizeof(zbx_vc_window_t) * ZBX_VC_ITEM_WINDOWS_MAX)))
+		{
+			return;
 		}
 
-		if (NULL == (chunk = chunk->prev))
-			break;
-
-		index = chunk->last_value;
+		window = &item->windows[item->windows_num++];
+		memset(window, 0, sizeof(zbx_vc_window_t));
+		window->period = period;
+		window->values_num = ZBX_VC_WINDOW_INVALID;
 	}
-out:
-	if (count > values->values_num)
-	{
-		if (0 == seconds)
-			return;
 
-		/* set the range equal to the period plus one second to include nanosecond shifts */
-		range_timestamp = ts->sec - seconds;
-	}
-	else
-	{
-		/* the requested number of values was retrieved, set the range to the oldest value timestamp */
+	if (window->lastaccess < now)
+		window->lastaccess = now;
+
+	if (ZBX_VC_WINDOW_INVALID == window->values_num)
+		vch_item_window_init(item, window);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: find the index of the last value in chunk with timestamp less or  *
+ *          equal to the specified timestamp.                                 *
+ *                                                                            *
+ * Parameters:  chunk - [IN] the chunk                                        *
+ *              slots - [IN] the chunk values                                 *
+ *              ts    - [IN] the target timestamp                             *
+ *                                                                            *
+ * Return value: The index of the last value in chunk with timestamp less or  *
+ *               equal to the specified timestamp.                            *
+ *               -1 is returned in the case of failure (meaning that all      *
+ *               values have timestamps greater than the target timestamp).   *
+ *                                                                            *
+ ******************************************************************************/
+static int	vch_chunk_find_last_value_before(const zbx_vc_chunk_t *chunk, const zbx_history_record_t *slots,
+		const zbx_timespec_t *ts)
+{
+	int	start = chunk->first_value, end = chunk->last_value, middle;
+
+	/* check if the last value timestamp is already greater or equal to the specified timestamp */
+	if (0 >= zbx_timespec_compare(&slots[end].timestamp, ts))
+		return end;
+
+	/* chunk contains only one value, which did not pass the above check, return failure */
+	if (start == end)
+		return -1;
+
+	/* perform value lookup using binary search */
+	while (start != end)
+	{
+		middle = start + (end - start) / 2;
+
+		if (0 < zbx_timespec_compare(&slots[middle].timestamp, ts))
+		{
+			end = middle;
+			continue;
+		}
+
+		if (0 >= zbx_timespec_compare(&slots[middle + 1].timestamp, ts))
+		{
+			start = middle;
+			continue;
+		}
+
+		return middle;
+	}
+
+	return -1;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets the chunk and index of the last value with a timestamp less  *
+ *          or equal to the specified timestamp                               *
+ *                                                                            *
+ * Parameters:  item          - [IN] the item                                 *
+ *              ts            - [IN] the target timestamp                     *
+ *                                   (NULL - current time)                    *
+ *              pchunk        - [OUT] the chunk containing the target value   *
+ *              pindex        - [OUT] the index of the target value           *
+ *              pslots        - [OUT] the values of the target chunk          *
+ *              buffer        - [IN/OUT] the buffer for decoding packed chunk *
+ *                                       values                               *
+ *                                                                            *
+ * Return value: SUCCEED - the last value was found successfully              *
+ *               FAIL - all values in cache have timestamps greater than the  *
+ *                      target (timeshift) timestamp.                         *
+ *                                                                            *
+ * Comments: If end_timestamp value is 0, then simply the last item value in  *
+ *           cache is returned.                                               *
+ *                                                                            *
+ ******************************************************************************/
+static int	vch_item_get_last_value(const zbx_vc_item_t *item, const zbx_timespec_t *ts, zbx_vc_chunk_t **pchunk,
+		int *pindex, const zbx_history_record_t **pslots, zbx_vector_history_record_t *buffer)
+{
+	zbx_vc_chunk_t			*chunk = item->head;
+	const zbx_history_record_t	*slots;
+	int				index;
+
+	if (NULL == chunk)
+		return FAIL;
+
+	index = chunk->last_value;
+	slots = chunk->slots;
+
+	if (0 < zbx_timespec_compare(&chunk->slots[index].timestamp, ts))
+	{
+		while (0 < zbx_timespec_compare(&chunk->slots[chunk->first_value].timestamp, ts))
+		{
+			chunk = chunk->prev;
+			/* there are no values for requested range, return failure */
+			if (NULL == chunk)
+				return FAIL;
+		}
+
+		slots = vch_chunk_get_slots(chunk, buffer);
+		index = vch_chunk_find_last_value_before(chunk, slots, ts);
+	}
+
+	*pchunk = chunk;
+	*pindex = index;
+	*pslots = slots;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: copies value in the specified item's chunk slot                   *
+ *                                                                            *
+ * Parameters: chunk        - [IN/OUT] the target chunk                       *
+ *             index        - [IN] the target slot                            *
+ *             source_value - [IN] the value to copy                          *
+ *                                                                            *
+ * Return value: SUCCEED - the value was copied successfully                  *
+ *               FAIL    - the value copying failed (not enough space for     *
+ *                         string, text or log type data)                     *
+ *                                                                            *
+ * Comments: This function is used to copy data to cache. The contents of     *
+ *           str, text and log type values are stored in cache string pool.   *
+ *                                                                            *
+ ******************************************************************************/
+static int	vch_item_copy_value(zbx_vc_item_t *item, zbx_vc_chunk_t *chunk, int index,
+		const zbx_history_record_t *source_value)
+{
+	zbx_history_record_t	*value;
+	int			ret = FAIL;
+
+	value = &chunk->slots[index];
+
+	switch (item->value_type)
+	{
+		case ITEM_VALUE_TYPE_STR:
+		case ITEM_VALUE_TYPE_TEXT:
+			if (NULL == (value->value.str = vc_item_strdup(item, source_value->value.str)))
+				goto out;
+			break;
+		case ITEM_VALUE_TYPE_LOG:
+			if (NULL == (value->value.log = vc_item_logdup(item, source_value->value.log)))
+				goto out;
+			break;
+		default:
+			value->value = source_value->value;
+	}
+	value->timestamp = source_value->timestamp;
+
+	ret = SUCCEED;
+out:
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: copies values at the beginning of item tail chunk                 *
+ *                                                                            *
+ * Parameters: item       - [IN/OUT] the target item                          *
+ *             values     - [IN] the values to copy                           *
+ *             values_num - [IN] the number of values to copy                 *
+ *                                                                            *
+ * Return value: SUCCEED - the values were copied successfully                *
+ *               FAIL    - the value copying failed (not enough space for     *
+ *                         string, text or log type data)                     *
+ *                                                                            *
+ * Comments: This function is used to copy data to cache. The contents of     *
+ *           str, text and log type values are stored in cache string pool.   *
+ *                                                                            *
+ ******************************************************************************/
+static int	vch_item_copy_values_at_tail(zbx_vc_item_t *item, const zbx_history_record_t *values, int values_num)
+{
+	int	i, ret = FAIL, first_value = item->tail->first_value;
+
+	switch (item->value_type)
+	{
+		case ITEM_VALUE_TYPE_STR:
+		case ITEM_VALUE_TYPE_TEXT:
+			for (i = values_num - 1; i >= 0; i--)
+			{
+				zbx_history_record_t	*value = &item->tail->slots[item->tail->first_value - 1];
+
+				if (NULL == (value->value.str = vc_item_strdup(item, values[i].value.str)))
+					goto out;
+
+				value->timestamp = values[i].timestamp;
+				item->tail->first_value--;
+			}
+			ret = SUCCEED;
+
+			break;
+		case ITEM_VALUE_TYPE_LOG:
+			for (i = values_num - 1; i >= 0; i--)
+			{
+				zbx_history_record_t	*value = &item->tail->slots[item->tail->first_value - 1];
+
+				if (NULL == (value->value.log = vc_item_logdup(item, values[i].value.log)))
+					goto out;
+
+				value->timestamp = values[i].timestamp;
+				item->tail->first_value--;
+			}
+			ret = SUCCEED;
+
+			break;
+		default:
+			memcpy(&item->tail->slots[item->tail->first_value - values_num], values,
+					(size_t)values_num * sizeof(zbx_history_record_t));
+			item->tail->first_value -= values_num;
+			ret = SUCCEED;
+	}
+out:
+	item->values_total += first_value - item->tail->first_value;
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: frees chunk and all resources allocated to store its values       *
+ *                                                                            *
+ * Parameters: item    - [IN] the chunk owner item                            *
+ *             chunk   - [IN] the chunk to free                               *
+ *                                                                            *
+ * Return value: the number of bytes freed                                    *
+ *                                                                            *
+ ******************************************************************************/
+static size_t	vch_item_free_chunk(zbx_vc_item_t *item, zbx_vc_chunk_t *chunk)
+{
+	size_t	freed;
+
+	if (0 != chunk->packed_size)
+	{
+		freed = sizeof(zbx_vc_chunk_t) + sizeof(zbx_history_record_t) + (size_t)chunk->packed_size;
+		item->values_total -= chunk->last_value - chunk->first_value + 1;
+	}
+	else
+	{
+		freed = sizeof(zbx_vc_chunk_t) + (size_t)(chunk->slots_num - 1) * sizeof(zbx_history_record_t);
+		freed += vc_item_free_values(item, chunk->slots, chunk->first_value, chunk->last_value);
+	}
+
+	__vc_shmem_free_func(chunk);
+
+	return freed;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: removes item history data chunk                                   *
+ *                                                                            *
+ * Parameters: item    - [IN ] the chunk owner item                           *
+ *             chunk   - [IN] the chunk to remove                             *
+ *                                                                            *
+ ******************************************************************************/
+static void	vch_item_remove_chunk(zbx_vc_item_t *item, zbx_vc_chunk_t *chunk)
+{
+	if (NULL != chunk->next)
+		chunk->next->prev = chunk->prev;
+
+	if (NULL != chunk->prev)
+		chunk->prev->next = chunk->next;
+
+	if (chunk == item->head)
+		item->head = chunk->prev;
+
+	if (chunk == item->tail)
+		item->tail = chunk->next;
+
+	vch_item_windows_invalidate(item, chunk, chunk->last_value + 1);
+	vch_item_free_chunk(item, chunk);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: removes item history data that are outside (older) the maximum    *
+ *          request range                                                     *
+ *                                                                            *
+ * Parameters:  item      - [IN] the target item                              *
+ *              timestamp - [IN] last timestamp in active range               *
+ *                                                                            *
+ ******************************************************************************/
+static void	vch_item_clean_cache(zbx_vc_item_t *item, int timestamp)
+{
+	zbx_vc_chunk_t	*next;
+
+	if (0 != item->active_range)
+	{
+		zbx_vc_chunk_t	*tail = item->tail;
+		zbx_vc_chunk_t	*chunk = tail;
+
+		timestamp -= item->active_range;
+
+		/* Try to remove chunks with all history values older than maximum request range, maximum */
+		/* request range should be calculated from last received value with which active range    */
+		/* was calculated to avoid dropping of chunks that might be still used in count request.  */
+		while (NULL != chunk && vch_chunk_last_value(chunk)->timestamp.sec < timestamp &&
+				vch_chunk_last_value(chunk)->timestamp.sec !=
+						item->head->slots[item->head->last_value].timestamp.sec)
+		{
+			int	last_sec = vch_chunk_last_value(chunk)->timestamp.sec;
+
+			/* don't remove the head chunk */
+			if (NULL == (next = chunk->next))
+				break;
+
+			/* Values with the same timestamps (seconds resolution) always should be either   */
+			/* kept in cache or removed together. There should not be a case when one of them */
+			/* is in cache and the second is dropped.                                         */
+			/* Here we are handling rare case, when the last value of first chunk has the     */
+			/* same timestamp (seconds resolution) as the first value in the second chunk.    */
+			/* In this case increase the first value index of the next chunk until the first  */
+			/* value timestamp is greater.                                                    */
+
+			if (next->slots[next->first_value].timestamp.sec != vch_chunk_last_value(next)->timestamp.sec &&
+					next->slots[next->first_value].timestamp.sec == last_sec)
+			{
+				/* stop cleaning if there is not enough memory to unpack chunk for modification */
+				if (0 != next->packed_size && NULL == (next = vch_item_unpack_chunk(item, next)))
+					break;
+
+				while (next->slots[next->first_value].timestamp.sec == last_sec)
+				{
+					vc_item_free_values(item, next->slots, next->first_value, next->first_value);
+					next->first_value++;
+				}
+
+				vch_item_windows_invalidate(item, next, next->first_value);
+			}
+
+			/* set the database cached from timestamp to the last (oldest) removed value timestamp + 1 */
+			item->db_cached_from = last_sec + 1;
+
+			vch_item_remove_chunk(item, chunk);
+
+			chunk = next;
+		}
+
+		/* reset the status flags if data was removed from cache */
+		if (tail != item->tail)
+			item->status = 0;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: removes item history data that are older than the specified       *
+ *          timestamp                                                         *
+ *                                                                            *
+ * Parameters:  item      - [IN] the target item                              *
+ *              timestamp - [IN] the timestamp (number of seconds since the   *
+ *                               Epoch)                                       *
+ *                                                                            *
+ * Return value: SUCCEED - the values were removed                            *
+ *               FAIL    - not enough memory to unpack chunk for modification *
+ *                                                                            *
+ ******************************************************************************/
+static int	vch_item_remove_values(zbx_vc_item_t *item, int timestamp)
+{
+	zbx_vc_chunk_t	*chunk = item->tail;
+
+	if (ZBX_ITEM_STATUS_CACHED_ALL == item->status)
+		item->status = 0;
+
+	/* try to remove chunks with all history values older than the timestamp */
+	while (NULL != chunk && chunk->slots[chunk->first_value].timestamp.sec < timestamp)
+	{
+		zbx_vc_chunk_t	*next;
+
+		/* If chunk contains values with timestamp greater or equal - remove */
+		/* only the values with less timestamp. Otherwise remove the while   */
+		/* chunk and check next one.                                         */
+		if (vch_chunk_last_value(chunk)->timestamp.sec >= timestamp)
+		{
+			if (0 != chunk->packed_size && NULL == (chunk = vch_item_unpack_chunk(item, chunk)))
+				return FAIL;
+
+			while (chunk->slots[chunk->first_value].timestamp.sec < timestamp)
+			{
+				vc_item_free_values(item, chunk->slots, chunk->first_value, chunk->first_value);
+				chunk->first_value++;
+			}
+
+			vch_item_windows_invalidate(item, chunk, chunk->first_value);
+
+			break;
+		}
+
+		next = chunk->next;
+		vch_item_remove_chunk(item, chunk);
+		chunk = next;
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds one item history value at the end of current item's history  *
+ *          data                                                              *
+ *                                                                            *
+ * Parameters:  item   - [IN] the item to add history data to                 *
+ *              value  - [IN] the item history data value                     *
+ *                                                                            *
+ * Return value: SUCCEED - the history data value was added successfully      *
+ *               FAIL - failed to add history data value (not enough memory)  *
+ *                                                                            *
+ * Comments: In the case of failure the item will be removed from cache       *
+ *           later.                                                           *
+ *                                                                            *
+ ******************************************************************************/
+static int	vch_item_add_value_at_head(zbx_vc_item_t *item, const zbx_history_record_t *value)
+{
+	int		ret = FAIL, index, sindex, nslots = 0;
+	zbx_vc_chunk_t	*chunk, *schunk, *head = item->head;
+
+	if (NULL != item->head &&
+			0 < zbx_history_record_compare_asc_func(&item->head->slots[item->head->last_value], value))
+	{
+		/* running aggregates are updated only when values are added in order */
+		vch_item_windows_invalidate(item, NULL, 0);
+
+		if (0 < zbx_history_record_compare_asc_func(&item->tail->slots[item->tail->first_value], value))
+		{
+			/* If the added value has the same or older timestamp as the first value in cache */
+			/* we can't add it to keep cache consistency. Additionally we must make sure no   */
+			/* values with matching timestamp seconds are kept in cache.                      */
+			if (SUCCEED != vch_item_remove_values(item, value->timestamp.sec + 1))
+				goto out;
+
+			/* empty items must be removed to avoid situation when a new value is added to cache */
+			/* while other values with matching timestamp seconds are not cached                 */
+			if (NULL == item->head)
+				goto out;
+
+			/* if the value is newer than the database cached from timestamp we must */
+			/* adjust the cached from timestamp to exclude this value                */
+			if (item->db_cached_from <= value->timestamp.sec)
+				item->db_cached_from = value->timestamp.sec + 1;
+
+			ret = SUCCEED;
+			goto out;
+		}
+
+		/* unpack the chunks that will be modified when shifting newer values */
+		for (chunk = item->head; 0 < zbx_timespec_compare(&chunk->slots[chunk->first_value].timestamp,
+				&value->timestamp);)
+		{
+			if (NULL == (chunk = chunk->prev))
+				break;
+
+			if (0 != chunk->packed_size && NULL == (chunk = vch_item_unpack_chunk(item, chunk)))
+				goto out;
+		}
+
+		sindex = item->head->last_value;
+		schunk = item->head;
+
+		if (0 == item->head->slots_num - item->head->last_value - 1)
+		{
+			if (FAIL == vch_item_add_chunk(item, vch_item_chunk_slot_count(item, 1), NULL))
+				goto out;
+		}
+		else
+			item->head->last_value++;
+
+		item->values_total++;
+
+		chunk = item->head;
+		index = item->head->last_value;
+
+		do
+		{
+			chunk->slots[index] = schunk->slots[sindex];
+
+			chunk = schunk;
+			index = sindex;
+
+			if (--sindex < schunk->first_value)
+			{
+				if (NULL == (schunk = schunk->prev))
+				{
+					memset(&chunk->slots[index], 0, sizeof(zbx_vc_chunk_t));
+					THIS_SHOULD_NEVER_HAPPEN;
+
+					goto out;
+				}
+
+				sindex = schunk->last_value;
+			}
+		}
+		while (0 < zbx_timespec_compare(&schunk->slots[sindex].timestamp, &value->timestamp));
+	}
+	else
+	{
+		/* find the number of free slots on the right side in last (head) chunk */
+		if (NULL != item->head)
+			nslots = item->head->slots_num - item->head->last_value - 1;
+
+		if (0 == nslots)
+		{
+			if (FAIL == vch_item_add_chunk(item, vch_item_chunk_slot_count(item, 1), NULL))
+				goto out;
+		}
+		else
+			item->head->last_value++;
+
+		item->values_total++;
+
+		chunk = item->head;
+		index = item->head->last_value;
+	}
+
+	if (SUCCEED != vch_item_copy_value(item, chunk, index, value))
+		goto out;
+
+	if (chunk == item->head && index == item->head->last_value)
+		vch_item_windows_add_value(item);
+
+	/* pack the previous head chunk after a new head chunk was added */
+	if (NULL != head && head != item->head)
+		vch_item_pack_chunk(item, head);
+
+	ret = SUCCEED;
+out:
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds item history values at the beginning of current item's       *
+ *          history data                                                      *
+ *                                                                            *
+ * Parameters:  item   - [IN] the item to add history data to                 *
+ *              values - [IN] the item history data values                    *
+ *              num    - [IN] the number of history data values to add        *
+ *                                                                            *
+ * Return value: SUCCEED - the history data values were added successfully    *
+ *               FAIL - failed to add history data values (not enough memory) *
+ *                                                                            *
+ * Comments: In the case of failure the item is removed from cache.           *
+ *           Overlapping values (by timestamp seconds) are ignored.           *
+ *                                                                            *
+ ******************************************************************************/
+static int	vch_item_add_values_at_tail(zbx_vc_item_t *item, const zbx_history_record_t *values, int values_num)
+{
+	int 	count = values_num, ret = FAIL;
+
+	/* skip values already added to the item cache by another process */
+	if (NULL != item->tail)
+	{
+		int	sec = item->tail->slots[item->tail->first_value].timestamp.sec;
+
+		while (--count >= 0 && values[count].timestamp.sec >= sec)
+			;
+		++count;
+	}
+
+	while (0 != count)
+	{
+		int	copy_slots, nslots = 0;
+
+		/* find the number of free slots on the left side in first (tail) chunk */
+		if (NULL != item->tail)
+			nslots = item->tail->first_value;
+
+		if (0 == nslots)
+		{
+			nslots = vch_item_chunk_slot_count(item, count);
+
+			if (FAIL == vch_item_add_chunk(item, nslots, item->tail))
+				goto out;
+
+			item->tail->last_value = nslots - 1;
+			item->tail->first_value = nslots;
+
+			/* the previous tail chunk is full, pack it unless it's the head chunk */
+			if (NULL != item->tail->next && item->head != item->tail->next)
+				vch_item_pack_chunk(item, item->tail->next);
+		}
+
+		/* copy values to chunk */
+		copy_slots = MIN(nslots, count);
+		count -= copy_slots;
+
+		if (FAIL == vch_item_copy_values_at_tail(item, values + count, copy_slots))
+			goto out;
+	}
+
+	ret = SUCCEED;
+out:
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: cache item history data for the specified time period             *
+ *                                                                            *
+ * Parameters: item        - [IN] the item                                    *
+ *             range_start - [IN] the interval start time                     *
+ *                                                                            *
+ * Return value:  >=0    - the number of values read from database            *
+ *                FAIL   - an error occurred while trying to cache values     *
+ *                                                                            *
+ * Comments: This function checks if the requested value range is cached and  *
+ *           updates cache from database if necessary.                        *
+ *                                                                            *
+ ******************************************************************************/
+static int	vch_item_cache_values_by_time(zbx_vc_item_t **item, int range_start)
+{
+	int				ret, range_end;
+	zbx_vector_history_record_t	records;
+	zbx_uint64_t			itemid;
+	unsigned char			value_type;
+
+	if (ZBX_ITEM_STATUS_CACHED_ALL == (*item)->status)
+		return SUCCEED;
+
+	/* check if the requested period is in the cached range */
+	if (0 != (*item)->db_cached_from && range_start >= (*item)->db_cached_from)
+		return SUCCEED;
+
+	/* find if the cache should be updated to cover the required range */
+	if (NULL != (*item)->tail)
+	{
+		/* we need to get item values before the first cached value, but not including it */
+		range_end = (*item)->tail->slots[(*item)->tail->first_value].timestamp.sec - 1;
+	}
+	else
+		range_end = ZBX_JAN_2038;
+
+	/* update cache if necessary */
+	if (range_start >= range_end)
+		return SUCCEED;
+
+	zbx_vector_history_record_create(&records);
+	itemid = (*item)->itemid;
+	value_type = (*item)->value_type;
+
+	UNLOCK_CACHE;
+
+	if (SUCCEED == (ret = vc_db_read_values_by_time(itemid, value_type, &records, range_start, range_end)))
+	{
+		zbx_vector_history_record_sort(&records,
+				(zbx_compare_func_t)zbx_history_record_compare_asc_func);
+	}
+
+	WRLOCK_CACHE;
+
+	if (SUCCEED != ret)
+		goto out;
+
+	if (NULL == (*item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &itemid)))
+	{
+		zbx_vc_item_t	new_item = {.itemid = itemid, .value_type = value_type};
+
+		if (NULL == (*item = (zbx_vc_item_t *)zbx_hashset_insert(&vc_cache->items, &new_item,
+				sizeof(new_item))))
+		{
+			ret = FAIL;
+			goto out;
+		}
+	}
+
+	/* when updating cache with time based request we can always reset status flags */
+	/* flag even if the requested period contains no data                           */
+	(*item)->status = 0;
+
+	if (0 < records.values_num)
+	{
+		if (SUCCEED != (ret = vch_item_add_values_at_tail(*item, records.values, records.values_num)))
+			goto out;
+	}
+
+	ret = records.values_num;
+	vc_item_update_db_cached_from(*item, range_start);
+out:
+	zbx_history_record_vector_destroy(&records, value_type);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: cache the specified number of history data values for time period *
+ *          since timestamp                                                   *
+ *                                                                            *
+ * Parameters: item        - [IN] the item                                    *
+ *             range_start - [IN] the interval start time                     *
+ *             count       - [IN] the number of history values to retrieve    *
+ *             ts          - [IN] the target timestamp                        *
+ *                                                                            *
+ * Return value:  >=0    - the number of values read from database            *
+ *                FAIL   - an error occurred while trying to cache values     *
+ *                                                                            *
+ * Comments: This function checks if the requested number of values is cached *
+ *           and updates cache from database if necessary.                    *
+ *                                                                            *
+ ******************************************************************************/
+static int	vch_item_cache_values_by_time_and_count(zbx_vc_item_t **item, int range_start, int count,
+		const zbx_timespec_t *ts)
+{
+	int				ret = SUCCEED, cached_records = 0, range_end, records_offset;
+	zbx_vector_history_record_t	records;
+	zbx_uint64_t			itemid;
+	unsigned char			value_type;
+
+	if (ZBX_ITEM_STATUS_CACHED_ALL == (*item)->status)
+		return SUCCEED;
+
+	/* check if the requested period is in the cached range */
+	if (0 != (*item)->db_cached_from && range_start >= (*item)->db_cached_from)
+		return SUCCEED;
+
+	/* find if the cache should be updated to cover the required count */
+	if (0 != (*item)->db_cached_from && NULL != (*item)->head)
+	{
+		zbx_vc_chunk_t			*chunk;
+		const zbx_history_record_t	*slots;
+		int				index;
+
+		if (SUCCEED == vch_item_get_last_value(*item, ts, &chunk, &index, &slots, &vc_unpack_buffer))
+		{
+			cached_records = index - chunk->first_value + 1;
+
+			while (NULL != (chunk = chunk->prev) && cached_records < count)
+				cached_records += chunk->last_value - chunk->first_value + 1;
+		}
+	}
+
+	/* update cache if necessary */
+	if (cached_records >= count)
+		return SUCCEED;
+
+	/* get the end timestamp to which (including) the values should be cached */
+	if (0 != (*item)->db_cached_from && NULL != (*item)->head)
+		range_end = (*item)->tail->slots[(*item)->tail->first_value].timestamp.sec - 1;
+	else
+		range_end = ZBX_JAN_2038;
+
+	itemid = (*item)->itemid;
+	value_type = (*item)->value_type;
+	UNLOCK_CACHE;
+
+	zbx_vector_history_record_create(&records);
+
+	if (range_end > ts->sec)
+	{
+		ret = vc_db_read_values_by_time(itemid, value_type, &records, ts->sec + 1, range_end);
+		range_end = ts->sec;
+	}
+
+	records_offset = records.values_num;
+
+	if (SUCCEED == ret && SUCCEED == (ret = vc_db_read_values_by_time_and_count(itemid, value_type, &records,
+			range_start, count - cached_records, range_end, ts)))
+	{
+		zbx_vector_history_record_sort(&records,
+				(zbx_compare_func_t)zbx_history_record_compare_asc_func);
+	}
+
+	WRLOCK_CACHE;
+
+	if (SUCCEED != ret)
+		goto out;
+
+	if (NULL == (*item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &itemid)))
+	{
+		zbx_vc_item_t	new_item = {.itemid = itemid, .value_type = value_type};
+
+		if (NULL == (*item = (zbx_vc_item_t *)zbx_hashset_insert(&vc_cache->items, &new_item, sizeof(new_item))))
+		{
+			ret = FAIL;
+			goto out;
+		}
+	}
+
+	if (0 < records.values_num)
+		ret = vch_item_add_values_at_tail(*item, records.values, records.values_num);
+
+	if (SUCCEED != ret)
+		goto out;
+
+	ret = records.values_num;
+
+	if (0 == range_start && count - cached_records > records.values_num - records_offset)
+	{
+		(*item)->active_range = 0;
+		(*item)->daily_range = 0;
+		(*item)->status = ZBX_ITEM_STATUS_CACHED_ALL;
+	}
+
+	if ((count <= records.values_num || 0 == range_start) && 0 != records.values_num)
+	{
+		vc_item_update_db_cached_from(*item,
+				(*item)->tail->slots[(*item)->tail->first_value].timestamp.sec);
+	}
+	else if (0 != range_start)
+		vc_item_update_db_cached_from(*item, range_start);
+
+out:
+	zbx_history_record_vector_destroy(&records, value_type);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: retrieves item history data from cache                            *
+ *                                                                            *
+ * Parameters: item      - [IN] the item                                      *
+ *             values    - [OUT] the item history data stored time/value      *
+ *                         pairs in undefined order                           *
+ *             seconds   - [IN] the time period to retrieve data for          *
+ *             ts        - [IN] the requested period end timestamp            *
+ *                                                                            *
+ ******************************************************************************/
+static void	vch_item_get_values_by_time(const zbx_vc_item_t *item, zbx_vector_history_record_t *values, int seconds,
+		const zbx_timespec_t *ts)
+{
+	int				index, now;
+	zbx_timespec_t			start = {ts->sec - seconds, ts->ns};
+	zbx_vc_chunk_t			*chunk;
+	const zbx_history_record_t	*slots;
+
+	now = (int)time(NULL);
+	/* add another second to include nanosecond shifts */
+	vc_cache_item_update(item->itemid, ZBX_VC_UPDATE_RANGE, seconds + now - ts->sec + 1, now);
+
+	if (FAIL == vch_item_get_last_value(item, ts, &chunk, &index, &slots, &vc_unpack_buffer))
+	{
+		/* Cache does not contain records for the specified timeshift & seconds range. */
+		/* Return empty vector with success.                                           */
+		return;
+	}
+
+	/* fill the values vector with item history values until the start timestamp is reached */
+	while (0 < zbx_timespec_compare(&vch_chunk_last_value(chunk)->timestamp, &start))
+	{
+		while (index >= chunk->first_value && 0 < zbx_timespec_compare(&slots[index].timestamp, &start))
+			vc_history_record_vector_append(values, item->value_type, &slots[index--]);
+
+		if (NULL == (chunk = chunk->prev))
+			break;
+
+		index = chunk->last_value;
+		slots = vch_chunk_get_slots(chunk, &vc_unpack_buffer);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: retrieves item history data from cache                            *
+ *                                                                            *
+ * Parameters: item      - [IN] the item                                      *
+ *             values    - [OUT] the item history data stored time/value      *
+ *                         pairs in undefined order, optional                 *
+ *                         If null then cache is updated if necessary, but no *
+ *                         values are returned. Used to ensure that cache     *
+ *                         contains a value of the specified timestamp.       *
+ *             seconds   - [IN] the time period                               *
+ *             count     - [IN] the number of history values to retrieve      *
+ *             timestamp - [IN] the target timestamp                          *
+ *                                                                            *
+ ******************************************************************************/
+static void	vch_item_get_values_by_time_and_count(zbx_vc_item_t *item, zbx_vector_history_record_t *values,
+		int seconds, int count, const zbx_timespec_t *ts)
+{
+	int				index, now, range_timestamp;
+	zbx_vc_chunk_t			*chunk;
+	const zbx_history_record_t	*slots;
+	zbx_timespec_t			start;
+
+	/* set start timestamp of the requested time period */
+	if (0 != seconds)
+	{
+		start.sec = ts->sec - seconds;
+		start.ns = ts->ns;
+	}
+	else
+	{
+		start.sec = 0;
+		start.ns = 0;
+	}
+
+	if (FAIL == vch_item_get_last_value(item, ts, &chunk, &index, &slots, &vc_unpack_buffer))
+	{
+		/* return empty vector with success */
+		goto out;
+	}
+
+	/* fill the values vector with item history values until the <count> values are read    */
+	/* or no more values within specified time period                                       */
+	/* fill the values vector with item history values until the start timestamp is reached */
+	while (0 < zbx_timespec_compare(&vch_chunk_last_value(chunk)->timestamp, &start))
+	{
+		while (index >= chunk->first_value && 0 < zbx_timespec_compare(&slots[index].timestamp, &start))
+		{
+			vc_history_record_vector_append(values, item->value_type, &slots[index--]);
+
+			if (values->values_num == count)
+				goto out;
+		}
+
+		if (NULL == (chunk = chunk->prev))
+			break;
+
+		index = chunk->last_value;
+		slots = vch_chunk_get_slots(chunk, &vc_unpack_buffer);
+	}
+out:
+	if (count > values->values_num)
+	{
+		if (0 == seconds)
+			return;
+
+		/* set the range equal to the period plus one second to include nanosecond shifts */
+		range_timestamp = ts->sec - seconds;
+	}
+	else
+	{
+		/* the requested number of values was retrieved, set the range to the oldest value timestamp */
 		range_timestamp = values->values[values->values_num - 1].timestamp.sec - 1;
 	}
 
-	now = (int)time(NULL);
-	vc_cache_item_update(item->itemid, ZBX_VC_UPDATE_RANGE, now - range_timestamp, now);
+	now = (int)time(NULL);
+	vc_cache_item_update(item->itemid, ZBX_VC_UPDATE_RANGE, now - range_timestamp, now);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get item values for the specified range                           *
+ *                                                                            *
+ * Parameters: item      - [IN] the item                                      *
+ *             values    - [OUT] the item history data stored time/value      *
+ *                         pairs in undefined order, optional                 *
+ *                         If null then cache is updated if necessary, but no *
+ *                         values are returned. Used to ensure that cache     *
+ *                         contains a value of the specified timestamp.       *
+ *             seconds   - [IN] the time period to retrieve data for          *
+ *             count     - [IN] the number of history values to retrieve      *
+ *             ts        - [IN] the target timestamp                          *
+ *                                                                            *
+ * Return value:  SUCCEED - the item history data was retrieved successfully  *
+ *                FAIL    - the item history data was not retrieved           *
+ *                                                                            *
+ * Comments: This function returns data from cache if necessary updating it   *
+ *           from DB. If cache update was required and failed (not enough     *
+ *           memory to cache DB values), then this function also fails.       *
+ *                                                                            *
+ *           If <count> is set then value range is defined as <count> values  *
+ *           before <timestamp>. Otherwise the range is defined as <seconds>  *
+ *           seconds before <timestamp>.                                      *
+ *                                                                            *
+ ******************************************************************************/
+static int	vch_item_get_values(zbx_vc_item_t *item, zbx_vector_history_record_t *values, int seconds,
+		int count, const zbx_timespec_t *ts)
+{
+	int	ret, records_read, hits, misses, range_start;
+
+	zbx_vector_history_record_clear(values);
+
+	if (0 == count)
+	{
+		if (0 > (range_start = ts->sec - seconds))
+			range_start = 0;
+
+		if (FAIL == (ret = vch_item_cache_values_by_time(&item, range_start)))
+			goto out;
+
+		records_read = ret;
+
+		vch_item_get_values_by_time(item, values, seconds, ts);
+
+		if (records_read > values->values_num)
+			records_read = values->values_num;
+	}
+	else
+	{
+		range_start = (0 == seconds ? 0 : ts->sec - seconds);
+
+		if (FAIL == (ret = vch_item_cache_values_by_time_and_count(&item, range_start, count, ts)))
+			goto out;
+
+		records_read = ret;
+
+		vch_item_get_values_by_time_and_count(item, values, seconds, count, ts);
+
+		if (records_read > values->values_num)
+			records_read = values->values_num;
+	}
+
+	hits = values->values_num - records_read;
+	misses = records_read;
+
+	vc_cache_item_update(item->itemid, ZBX_VC_UPDATE_STATS, hits, misses);
+
+	ret = SUCCEED;
+out:
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: frees resources allocated for item history data                   *
+ *                                                                            *
+ * Parameters: item    - [IN] the item                                        *
+ *                                                                            *
+ * Return value: the size of freed memory (bytes)                             *
+ *                                                                            *
+ ******************************************************************************/
+static size_t	vch_item_free_cache(zbx_vc_item_t *item)
+{
+	size_t	freed = 0;
+
+	zbx_vc_chunk_t	*chunk = item->tail;
+
+	while (NULL != chunk)
+	{
+		zbx_vc_chunk_t	*next = chunk->next;
+
+		freed += vch_item_free_chunk(item, chunk);
+		chunk = next;
+	}
+	item->values_total = 0;
+	item->head = NULL;
+	item->tail = NULL;
+
+	if (NULL != item->windows)
+	{
+		__vc_shmem_free_func(item->windows);
+		freed += sizeof(zbx_vc_window_t) * ZBX_VC_ITEM_WINDOWS_MAX;
+		item->windows = NULL;
+		item->windows_num = 0;
+	}
+
+	return freed;
+}
+
+/******************************************************************************************************************
+ *                                                                                                                *
+ * Public API                                                                                                     *
+ *                                                                                                                *
+ ******************************************************************************************************************/
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: initializes value cache                                           *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_vc_init(zbx_uint64_t value_cache_size, char **error)
+{
+	zbx_uint64_t	size_reserved;
+	int		ret = FAIL;
+
+	if (0 == value_cache_size)
+		return SUCCEED;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+
+	if (SUCCEED != (ret = zbx_rwlock_create(&vc_lock, ZBX_RWLOCK_VALUECACHE, error)))
+		goto out;
+
+	size_reserved = zbx_shmem_required_size(1, "value cache size", "ValueCacheSize");
+
+	if (SUCCEED != zbx_shmem_create(&vc_mem, value_cache_size, "value cache size", "ValueCacheSize", 1,
+			error))
+	{
+		goto out;
+	}
+
+	value_cache_size -= size_reserved;
+
+	vc_cache = (zbx_vc_cache_t *)__vc_shmem_malloc_func(vc_cache, sizeof(zbx_vc_cache_t));
+
+	if (NULL == vc_cache)
+	{
+		*error = zbx_strdup(*error, "cannot allocate value cache header");
+		goto out;
+	}
+	memset(vc_cache, 0, sizeof(zbx_vc_cache_t));
+
+	zbx_hashset_create_ext(&vc_cache->items, VC_ITEMS_INIT_SIZE,
+			ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC, NULL,
+			__vc_shmem_malloc_func, __vc_shmem_realloc_func, __vc_shmem_free_func);
+
+	if (NULL == vc_cache->items.slots)
+	{
+		*error = zbx_strdup(*error, "cannot allocate value cache data storage");
+		goto out;
+	}
+
+	zbx_hashset_create_ext(&vc_cache->strpool, VC_STRPOOL_INIT_SIZE,
+			vc_strpool_hash_func, vc_strpool_compare_func, NULL,
+			__vc_shmem_malloc_func, __vc_shmem_realloc_func, __vc_shmem_free_func);
+
+	if (NULL == vc_cache->strpool.slots)
+	{
+		*error = zbx_strdup(*error, "cannot allocate string pool for value cache data storage");
+		goto out;
+	}
+
+	/* the free space request should be 5% of cache size, but no more than 128KB */
+	vc_cache->min_free_request = (value_cache_size / 100) * 5;
+	if (vc_cache->min_free_request > 128 * ZBX_KIBIBYTE)
+		vc_cache->min_free_request = 128 * ZBX_KIBIBYTE;
+
+	zbx_vector_vc_itemupdate_create(&vc_itemupdates);
+	zbx_vector_vc_itemupdate_reserve(&vc_itemupdates, 256);
+
+	zbx_vector_history_record_create(&vc_unpack_buffer);
+
+	ret = SUCCEED;
+out:
+	zbx_vc_disable();
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: destroys value cache                                              *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_vc_destroy(void)
+{
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+
+	if (NULL != vc_cache)
+	{
+		zbx_vector_vc_itemupdate_destroy(&vc_itemupdates);
+		zbx_vector_history_record_destroy(&vc_unpack_buffer);
+
+		zbx_hashset_destroy(&vc_cache->items);
+		zbx_hashset_destroy(&vc_cache->strpool);
+
+		__vc_shmem_free_func(vc_cache);
+		vc_cache = NULL;
+
+		zbx_shmem_destroy(vc_mem);
+		vc_mem = NULL;
+		zbx_rwlock_destroy(&vc_lock);
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: resets value cache                                                *
+ *                                                                            *
+ * Comments: All items and their historical data are removed,                 *
+ *           cache working mode, statistics reset.                            *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_vc_reset(void)
+{
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+
+	if (NULL != vc_cache)
+	{
+		zbx_vc_item_t		*item;
+		zbx_hashset_iter_t	iter;
+
+		WRLOCK_CACHE;
+
+		zbx_hashset_iter_reset(&vc_cache->items, &iter);
+		while (NULL != (item = (zbx_vc_item_t *)zbx_hashset_iter_next(&iter)))
+		{
+			vch_item_free_cache(item);
+			zbx_hashset_iter_remove(&iter);
+		}
+
+		vc_cache->hits = 0;
+		vc_cache->misses = 0;
+		vc_cache->min_free_request = 0;
+		vc_cache->mode = ZBX_VC_MODE_NORMAL;
+		vc_cache->mode_time = 0;
+		vc_cache->last_warning_time = 0;
+
+		UNLOCK_CACHE;
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds item values to history and value cache                       *
+ *                                                                            *
+ * Parameters:                                                                *
+ *   history                          - [IN] item history values              *
+ *   ret_flush                        - [OUT]                                 *
+ *   config_history_storage_pipelines - [IN]                                  *
+ *                                                                            *
+ * Return value: SUCCEED - values were added successfully                     *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_vc_add_values(zbx_vector_dc_history_ptr_t *history, int *ret_flush, int config_history_storage_pipelines)
+{
+	zbx_vc_item_t		*item;
+	int			i;
+	zbx_dc_history_t	*h;
+
+	if (SUCCEED != zbx_history_add_values(history, ret_flush, config_history_storage_pipelines))
+		return FAIL;
+
+	if (ZBX_VC_DISABLED == vc_state)
+		return SUCCEED;
+
+	WRLOCK_CACHE;
+
+	for (i = 0; i < history->values_num; i++)
+	{
+		h = history->values[i];
+
+		item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &h->itemid);
+
+		if (NULL == item && 0 != (h->flags & ZBX_DC_FLAG_HASTRIGGER) && ZBX_VC_MODE_NORMAL == vc_cache->mode)
+		{
+			zbx_vc_item_t	item_local = {
+					.itemid = h->itemid,
+					.value_type = h->value_type,
+					.last_accessed = (int)time(NULL)
+
+			};
+
+			item = (zbx_vc_item_t *)zbx_hashset_insert(&vc_cache->items, &item_local, sizeof(item_local));
+		}
+
+		/* cache new values only after the item history database status is known */
+		if (NULL != item)
+		{
+			zbx_history_record_t	record = {h->ts, h->value};
+			zbx_vc_chunk_t		*head = item->head;
+			int			last_value_timestamp;
+
+			if (NULL != head)
+				last_value_timestamp = head->slots[head->last_value].timestamp.sec;
+			else
+				last_value_timestamp = (int)time(NULL);
+
+			/* If the new value type does not match the item's type in cache remove it, */
+			/* so it's cached with the correct type from correct tables when accessed   */
+			/* next time.                                                               */
+			/* Also remove item if the value adding failed. In this case we             */
+			/* won't have the latest data in cache - so the requests must go directly   */
+			/* to the database.                                                         */
+			if (item->value_type != h->value_type || FAIL == vch_item_add_value_at_head(item, &record))
+			{
+				vc_remove_item(item);
+				continue;
+			}
+
+			/* try to remove old (unused) chunks if a new chunk was added */
+			if (head != item->head)
+				vch_item_clean_cache(item, last_value_timestamp);
+		}
+	}
+
+	UNLOCK_CACHE;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get item history data for the specified time period               *
+ *                                                                            *
+ * Parameters: itemid     - [IN] the item id                                  *
+ *             value_type - [IN] the item value type                          *
+ *             values     - [OUT] the item history data stored time/value     *
+ *                          pairs in descending order                         *
+ *             seconds    - [IN] the time period to retrieve data for         *
+ *             count      - [IN] the number of history values to retrieve     *
+ *             ts         - [IN] the period end timestamp                     *
+ *                                                                            *
+ * Return value:  SUCCEED - the item history data was retrieved successfully  *
+ *                FAIL    - the item history data was not retrieved           *
+ *                                                                            *
+ * Comments: If the data is not in cache, it's read from DB, so this function *
+ *           will always return the requested data, unless some error occurs. *
+ *                                                                            *
+ *           If <count> is set then value range is defined as <count> values  *
+ *           before <timestamp>. Otherwise the range is defined as <seconds>  *
+ *           seconds before <timestamp>.                                      *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_vc_get_values(zbx_uint64_t itemid, unsigned char value_type, zbx_vector_history_record_t *values,
+		int seconds, int count, const zbx_timespec_t *ts)
+{
+	zbx_vc_item_t	*item, new_item;
+	int 		ret = FAIL, cache_used = 1;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() itemid:" ZBX_FS_UI64 " value_type:%d count:%d period:%d end_timestamp"
+			" '%s'", __func__, itemid, value_type, count, seconds, zbx_timespec_str(ts));
+
+	if (ITEM_VALUE_TYPE_BIN == value_type)
+		return FAIL;
+
+	RDLOCK_CACHE;
+
+	if (ZBX_VC_DISABLED == vc_state)
+		goto out;
+
+	if (ZBX_VC_MODE_LOWMEM == vc_cache->mode)
+		vc_warn_low_memory();
+
+	if (NULL == (item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &itemid)))
+	{
+		if (ZBX_VC_MODE_NORMAL != vc_cache->mode)
+			goto out;
+
+		memset(&new_item, 0, sizeof(new_item));
+		new_item.itemid = itemid;
+		new_item.value_type = value_type;
+		item = &new_item;
+	}
+	else if (item->value_type != value_type)
+		goto out;
+
+	ret = vch_item_get_values(item, values, seconds, count, ts);
+out:
+	if (FAIL == ret)
+	{
+		cache_used = 0;
+
+		UNLOCK_CACHE;
+		ret = vc_db_get_values(itemid, value_type, values, seconds, count, ts);
+		WRLOCK_CACHE;
+
+		if (ZBX_VC_DISABLED != vc_state)
+			vc_remove_item_by_id(itemid);
+
+		if (SUCCEED == ret)
+			vc_update_statistics(NULL, 0, values->values_num, (int)time(NULL));
+	}
+
+	UNLOCK_CACHE;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s count:%d cached:%d",
+			__func__, zbx_result_string(ret), values->values_num, cache_used);
+
+	return ret;
+}
+
+static int	vc_prefetch_compare_by_itemid(const void *d1, const void *d2)
+{
+	const zbx_vc_prefetch_t	*p1 = (const zbx_vc_prefetch_t *)d1;
+	const zbx_vc_prefetch_t	*p2 = (const zbx_vc_prefetch_t *)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(p1->itemid, p2->itemid);
+	/* time based prefetches go first, they cover count based requests of the same item */
+	ZBX_RETURN_IF_NOT_EQUAL(0 != p1->count, 0 != p2->count);
+	ZBX_RETURN_IF_NOT_EQUAL(p1->range_start, p2->range_start);
+
+	return 0;
+}
+
+static int	vc_prefetch_compare_by_range(const void *d1, const void *d2)
+{
+	const zbx_vc_prefetch_t	*p1 = (const zbx_vc_prefetch_t *)d1;
+	const zbx_vc_prefetch_t	*p2 = (const zbx_vc_prefetch_t *)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(p1->value_type, p2->value_type);
+	ZBX_RETURN_IF_NOT_EQUAL(p1->range_start, p2->range_start);
+	ZBX_RETURN_IF_NOT_EQUAL(p1->count, p2->count);
+	ZBX_RETURN_IF_NOT_EQUAL(p1->itemid, p2->itemid);
+
+	return 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: cache prefetched item values                                      *
+ *                                                                            *
+ * Parameters: prefetch - [IN] the prefetched item and period                 *
+ *             records  - [IN] the item values since period start in          *
+ *                             ascending order, limited to the seconds of the *
+ *                             last prefetch->count values if it is not zero  *
+ *                                                                            *
+ * Return value:  SUCCEED - the values were cached or are not needed anymore  *
+ *                FAIL    - not enough space in value cache                   *
+ *                                                                            *
+ * Comments: Values are cached in the same way as by time based request       *
+ *           reading the period from database. If the number of values was    *
+ *           limited, the database values are cached only since the second of *
+ *           the oldest value read. The cache must be locked for writing.     *
+ *                                                                            *
+ ******************************************************************************/
+static int	vc_prefetch_cache_values(const zbx_vc_prefetch_t *prefetch,
+		const zbx_vector_history_record_t *records)
+{
+	zbx_vc_item_t	*item;
+	int		range_start, range_end, values_num;
+
+	if (NULL == (item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &prefetch->itemid)))
+	{
+		zbx_vc_item_t	item_local = {
+				.itemid = prefetch->itemid,
+				.value_type = prefetch->value_type,
+				.last_accessed = (int)time(NULL)
+		};
+
+		if (NULL == (item = (zbx_vc_item_t *)zbx_hashset_insert(&vc_cache->items, &item_local,
+				sizeof(item_local))))
+		{
+			return FAIL;
+		}
+	}
+	else if (item->value_type != prefetch->value_type || ZBX_ITEM_STATUS_CACHED_ALL == item->status ||
+			(0 != item->db_cached_from && prefetch->range_start >= item->db_cached_from))
+	{
+		/* the period was cached by another process meanwhile */
+		return SUCCEED;
+	}
+
+	values_num = records->values_num;
+
+	/* older values in the period might have been left out by the limit */
+	if (0 != prefetch->count && prefetch->count <= values_num)
+		range_start = records->values[0].timestamp.sec;
+	else
+		range_start = prefetch->range_start;
+
+	/* values since the oldest cached value second are already cached */
+	if (NULL != item->tail)
+	{
+		range_end = item->tail->slots[item->tail->first_value].timestamp.sec - 1;
+
+		while (0 < values_num && records->values[values_num - 1].timestamp.sec > range_end)
+			values_num--;
+	}
+
+	if (0 < values_num && SUCCEED != vch_item_add_values_at_tail(item, records->values, values_num))
+	{
+		vc_remove_item(item);
+		return FAIL;
+	}
+
+	item->status = 0;
+	vc_item_update_db_cached_from(item, range_start);
+	vc_update_statistics(NULL, 0, values_num, (int)time(NULL));
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: read history values of items missing from cache with few database *
+ *          queries                                                           *
+ *                                                                            *
+ * Parameters: requests - [IN] the item value requests that are going to be   *
+ *                             made with zbx_vc_get_values()                  *
+ *                                                                            *
+ * Comments: The values of items, which would be read from database one by    *
+ *           one when requested, are read by value type and period start in   *
+ *           batches and cached. Count based requests without time period     *
+ *           prefetch at most the requested number of values from the last    *
+ *           ZBX_VC_PREFETCH_PERIOD seconds, if there are not enough values   *
+ *           the remaining values are read by the request itself.             *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_vc_prefetch_values(const zbx_vector_vc_request_t *requests)
+{
+	zbx_vector_vc_prefetch_t	prefetch;
+	zbx_vector_uint64_t		itemids;
+	zbx_vector_history_record_t	*records;
+	int				i, j, k, ret = SUCCEED;
+
+	if (ZBX_VC_DISABLED == vc_state || 0 == requests->values_num)
+		return;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() requests:%d", __func__, requests->values_num);
+
+	zbx_vector_vc_prefetch_create(&prefetch);
+	zbx_vector_vc_prefetch_reserve(&prefetch, (size_t)requests->values_num);
+
+	RDLOCK_CACHE;
+
+	if (ZBX_VC_MODE_NORMAL == vc_cache->mode)
+	{
+		for (i = 0; i < requests->values_num; i++)
+		{
+			const zbx_vc_request_t	*request = &requests->values[i];
+			const zbx_vc_item_t	*item;
+			zbx_vc_prefetch_t	prefetch_local;
+
+			if (ITEM_VALUE_TYPE_BIN == request->value_type ||
+					(0 == request->count && 0 == request->seconds))
+			{
+				continue;
+			}
+
+			item = (const zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &request->itemid);
+
+			if (0 == request->count || 0 != request->seconds)
+			{
+				prefetch_local.range_start = request->ts.sec - request->seconds;
+				prefetch_local.count = 0;
+			}
+			else
+			{
+				/* count based requests check the cached values count themselves */
+				if (NULL != item && 0 != item->db_cached_from)
+					continue;
+
+				prefetch_local.range_start = request->ts.sec - ZBX_VC_PREFETCH_PERIOD;
+				prefetch_local.count = request->count;
+			}
+
+			if (0 > prefetch_local.range_start)
+				prefetch_local.range_start = 0;
+
+			prefetch_local.range_start -= prefetch_local.range_start % ZBX_VC_PREFETCH_ALIGN;
+
+			if (NULL != item && (item->value_type != request->value_type ||
+					ZBX_ITEM_STATUS_CACHED_ALL == item->status || (0 != item->db_cached_from &&
+					prefetch_local.range_start >= item->db_cached_from)))
+			{
+				continue;
+			}
+
+			prefetch_local.itemid = request->itemid;
+			prefetch_local.value_type = request->value_type;
+			zbx_vector_vc_prefetch_append(&prefetch, prefetch_local);
+		}
+	}
+
+	UNLOCK_CACHE;
+
+	if (0 == prefetch.values_num)
+		goto out;
+
+	/* keep the longest period of each item, or the largest count if the item has only count based requests */
+	zbx_vector_vc_prefetch_sort(&prefetch, vc_prefetch_compare_by_itemid);
+
+	for (i = 1, j = 0; i < prefetch.values_num; i++)
+	{
+		if (prefetch.values[i].itemid != prefetch.values[j].itemid)
+			prefetch.values[++j] = prefetch.values[i];
+		else if (0 != prefetch.values[j].count && prefetch.values[i].count > prefetch.values[j].count)
+			prefetch.values[j].count = prefetch.values[i].count;
+	}
+
+	prefetch.values_num = j + 1;
+
+	zbx_vector_vc_prefetch_sort(&prefetch, vc_prefetch_compare_by_range);
+	zbx_vector_uint64_create(&itemids);
+
+	for (i = 0; i < prefetch.values_num && SUCCEED == ret; i = j)
+	{
+		const zbx_vc_prefetch_t	*first = &prefetch.values[i];
+		int			range_start;
+
+		zbx_vector_uint64_clear(&itemids);
+
+		for (j = i; j < prefetch.values_num && prefetch.values[j].value_type == first->value_type &&
+				prefetch.values[j].range_start == first->range_start &&
+				prefetch.values[j].count == first->count; j++)
+		{
+			zbx_vector_uint64_append(&itemids, prefetch.values[j].itemid);
+		}
+
+		records = (zbx_vector_history_record_t *)zbx_malloc(NULL, sizeof(zbx_vector_history_record_t) *
+				(size_t)itemids.values_num);
+
+		for (k = 0; k < itemids.values_num; k++)
+			zbx_history_record_vector_create(&records[k]);
+
+		/* decrement interval start point because interval starting point is excluded by history backend */
+		if (0 != (range_start = first->range_start))
+			range_start--;
+
+		if (SUCCEED == (ret = zbx_history_get_values_multi(itemids.values, itemids.values_num,
+				first->value_type, range_start, first->count, ZBX_JAN_2038, records)))
+		{
+			WRLOCK_CACHE;
+
+			if (ZBX_VC_DISABLED == vc_state || ZBX_VC_MODE_NORMAL != vc_cache->mode)
+				ret = FAIL;
+
+			for (k = 0; k < itemids.values_num && SUCCEED == ret; k++)
+			{
+				zbx_vector_history_record_sort(&records[k],
+						(zbx_compare_func_t)zbx_history_record_compare_asc_func);
+				ret = vc_prefetch_cache_values(&prefetch.values[i + k], &records[k]);
+			}
+
+			UNLOCK_CACHE;
+		}
+
+		for (k = 0; k < itemids.values_num; k++)
+			zbx_history_record_vector_destroy(&records[k], first->value_type);
+
+		zbx_free(records);
+	}
+
+	zbx_vector_uint64_destroy(&itemids);
+out:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() items:%d", __func__, prefetch.values_num);
+
+	zbx_vector_vc_prefetch_destroy(&prefetch);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get the last history value with a timestamp less or equal to the  *
+ *          target timestamp                                                  *
+ *                                                                            *
+ * Parameters: itemid     - [IN] the item id                                  *
+ *             value_type - [IN] the item value type                          *
+ *             ts         - [IN] the target timestamp                         *
+ *             value      - [OUT] the value found                             *
+ *                                                                            *
+ * Return Value: SUCCEED - the item was retrieved                             *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: Depending on the value type this function might allocate memory  *
+ *           to store value data. To free it use zbx_vc_history_value_clear() *
+ *           function.                                                        *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_vc_get_value(zbx_uint64_t itemid, unsigned char value_type, const zbx_timespec_t *ts,
+		zbx_history_record_t *value)
+{
+	zbx_vector_history_record_t	values;
+	int				ret = FAIL;
+
+	zbx_history_record_vector_create(&values);
+
+	if (SUCCEED != zbx_vc_get_values(itemid, value_type, &values, ts->sec, 1, ts) || 0 == values.values_num)
+		goto out;
+
+	*value = values.values[0];
+
+	/* reset values vector size so the returned value is not cleared when destroying the vector */
+	values.values_num = 0;
+
+	ret = SUCCEED;
+out:
+	zbx_history_record_vector_destroy(&values, value_type);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets aggregate of item values for the specified time period from  *
+ *          running aggregates                                                *
+ *                                                                            *
+ * Parameters: itemid     - [IN] the item id                                  *
+ *             value_type - [IN] the item value type                          *
+ *             func       - [IN] the aggregate function                       *
+ *             seconds    - [IN] the time period                              *
+ *             ts         - [IN] the period end timestamp                     *
+ *             value      - [OUT] the aggregate value - average as double,    *
+ *                                sum, minimum and maximum as item value type *
+ *             values_num - [OUT] the number of values in period              *
+ *                                                                            *
+ * Return value: SUCCEED - the aggregate was calculated                       *
+ *               FAIL    - the running aggregates are not available, the      *
+ *                         values must be retrieved with zbx_vc_get_values()  *
+ *                                                                            *
+ * Comments: The running aggregates are calculated for periods ending with    *
+ *           the last item value. When a period is requested the first time   *
+ *           its running aggregates are calculated during the next statistics *
+ *           flush and updated as new values are added to cache.              *
+ *           If the specified timestamp is after the last item value the      *
+ *           values older than the period start are subtracted from the       *
+ *           running aggregates without modifying them. If the last minimum   *
+ *           or maximum value is subtracted the remaining period values are   *
+ *           scanned instead.                                                 *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_vc_get_aggregate(zbx_uint64_t itemid, unsigned char value_type, zbx_vc_aggregate_func_t func,
+		int seconds, const zbx_timespec_t *ts, zbx_history_value_t *value, int *values_num)
+{
+	zbx_vc_item_t			*item;
+	const zbx_vc_window_t		*window = NULL;
+	zbx_vc_window_t			local;
+	zbx_vc_chunk_t			*chunk;
+	const zbx_history_record_t	*slots;
+	zbx_timespec_t			start;
+	int				i, index, now, extremes = SUCCEED, ret = FAIL;
+
+	if (ITEM_VALUE_TYPE_FLOAT != value_type && ITEM_VALUE_TYPE_UINT64 != value_type)
+		return FAIL;
+
+	if (0 >= seconds)
+		return FAIL;
+
+	RDLOCK_CACHE;
+
+	if (ZBX_VC_DISABLED == vc_state)
+		goto out;
+
+	if (NULL == (item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &itemid)) ||
+			item->value_type != value_type || NULL == item->head)
+	{
+		goto out;
+	}
+
+	/* running aggregates are not kept for periods ending before the last value */
+	if (0 < zbx_timespec_compare(&item->head->slots[item->head->last_value].timestamp, ts))
+		goto out;
+
+	now = (int)time(NULL);
+	vc_cache_item_update(itemid, ZBX_VC_UPDATE_WINDOW, seconds, now);
+
+	for (i = 0; i < item->windows_num; i++)
+	{
+		if (item->windows[i].period == seconds)
+		{
+			window = &item->windows[i];
+			break;
+		}
+	}
+
+	if (NULL == window || ZBX_VC_WINDOW_INVALID == window->values_num)
+		goto out;
+
+	local = *window;
+	start = *ts;
+	start.sec -= seconds;
+
+	/* remove values that are out of the requested period */
+	for (chunk = window->chunk, index = window->index, slots = chunk->slots;
+			0 != local.values_num && 0 >= zbx_timespec_compare(&slots[index].timestamp, &start);)
+	{
+		if (SUCCEED != vc_window_remove_value(&local, value_type, &slots[index].value))
+			extremes = FAIL;
+
+		if (++index > chunk->last_value)
+		{
+			if (NULL == (chunk = chunk->next))
+				break;
+
+			index = chunk->first_value;
+			slots = vch_chunk_get_slots(chunk, &vc_unpack_buffer);
+		}
+	}
+
+	/* the last minimum or maximum value left the period - recalculate the remaining values */
+	if (SUCCEED != extremes && 0 != local.values_num &&
+			(ZBX_VC_AGGREGATE_MIN == func || ZBX_VC_AGGREGATE_MAX == func))
+	{
+		local.chunk = chunk;
+		local.index = index;
+		vch_item_window_calculate(item, &local);
+	}
+
+	switch (func)
+	{
+		case ZBX_VC_AGGREGATE_AVG:
+			if (0 != local.values_num)
+				value->dbl = vc_window_sum(&local) / local.values_num;
+			break;
+		case ZBX_VC_AGGREGATE_SUM:
+			if (ITEM_VALUE_TYPE_FLOAT == value_type)
+				value->dbl = vc_window_sum(&local);
+			else
+				value->ui64 = local.sum_ui64;
+			break;
+		case ZBX_VC_AGGREGATE_MIN:
+			*value = local.min;
+			break;
+		case ZBX_VC_AGGREGATE_MAX:
+			*value = local.max;
+			break;
+		case ZBX_VC_AGGREGATE_COUNT:
+			break;
+	}
+
+	*values_num = local.values_num;
+
+	/* add another second to include nanosecond shifts */
+	vc_cache_item_update(itemid, ZBX_VC_UPDATE_RANGE, seconds + now - ts->sec + 1, now);
+	vc_cache_item_update(itemid, ZBX_VC_UPDATE_STATS, local.values_num, 0);
+
+	ret = SUCCEED;
+out:
+	UNLOCK_CACHE;
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: retrieves usage cache statistics                                  *
+ *                                                                            *
+ * Parameters: stats     - [OUT] the cache usage statistics                   *
+ *                                                                            *
+ * Return value:  SUCCEED - the cache statistics were retrieved successfully  *
+ *                FAIL    - failed to retrieve cache statistics               *
+ *                          (cache was not initialized)                       *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_vc_get_statistics(zbx_vc_stats_t *stats)
+{
+	if (ZBX_VC_DISABLED == vc_state)
+		return FAIL;
+
+	RDLOCK_CACHE;
+
+	stats->hits = vc_cache->hits;
+	stats->misses = vc_cache->misses;
+	stats->mode = vc_cache->mode;
+
+	stats->total_size = vc_mem->total_size;
+	stats->free_size = vc_mem->free_size;
+
+	UNLOCK_CACHE;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: enables value caching for current process                         *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_vc_enable(void)
+{
+	if (NULL != vc_cache)
+		vc_state = ZBX_VC_ENABLED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: disables value caching for current process                        *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_vc_disable(void)
+{
+	vc_state = ZBX_VC_DISABLED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get value cache diagnostic statistics                             *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_vc_get_diag_stats(zbx_uint64_t *items_num, zbx_uint64_t *values_num, int *mode)
+{
+	zbx_hashset_iter_t	iter;
+	zbx_vc_item_t		*item;
+
+	*values_num = 0;
+
+	if (ZBX_VC_DISABLED == vc_state)
+	{
+		*items_num = 0;
+		*mode = -1;
+		return;
+	}
+
+	RDLOCK_CACHE;
+
+	*items_num = (zbx_uint64_t)vc_cache->items.num_data;
+	*mode = vc_cache->mode;
+
+	zbx_hashset_iter_reset(&vc_cache->items, &iter);
+	while (NULL != (item = (zbx_vc_item_t *)zbx_hashset_iter_next(&iter)))
+		*values_num += (zbx_uint64_t)item->values_total;
+
+	UNLOCK_CACHE;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: get item values for the specified range                           *
- *                                                                            *
- * Parameters: item      - [IN] the item                                      *
- *             values    - [OUT] the item history data stored time/value      *
- *                         pairs in undefined order, optional                 *
- *                         If null then cache is updated if necessary, but no *
- *                         values are returned. Used to ensure that cache     *
- *                         contains a value of the specified timestamp.       *
- *             seconds   - [IN] the time period to retrieve data for          *
- *             count     - [IN] the number of history values to retrieve      *
- *             ts        - [IN] the target timestamp                          *
- *                                                                            *
- * Return value:  SUCCEED - the item history data was retrieved successfully  *
- *                FAIL    - the item history data was not retrieved           *
+ * Purpose: get value cache shared memory statistics                          *
  *                                                                            *
- * Comments: This function returns data from cache if necessary updating it   *
- *           from DB. If cache update was required and failed (not enough     *
- *           memory to cache DB values), then this function also fails.       *
+ ******************************************************************************/
+void	zbx_vc_get_mem_stats(zbx_shmem_stats_t *mem)
+{
+	if (ZBX_VC_DISABLED == vc_state)
+	{
+		memset(mem, 0, sizeof(zbx_shmem_stats_t));
+		return;
+	}
+
+	RDLOCK_CACHE;
+	zbx_shmem_get_stats(vc_mem, mem);
+	UNLOCK_CACHE;
+}
+
+/******************************************************************************
  *                                                                            *
- *           If <count> is set then value range is defined as <count> values  *
- *           before <timestamp>. Otherwise the range is defined as <seconds>  *
- *           seconds before <timestamp>.                                      *
+ * Purpose: get statistics of cached items                                    *
  *                                                                            *
  ******************************************************************************/
-static int	vch_item_get_values(zbx_vc_item_t *item, zbx_vector_history_record_t *values, int seconds,
-		int count, const zbx_timespec_t *ts)
+void	zbx_vc_get_item_stats(zbx_vector_vc_item_stats_ptr_t *stats)
 {
-	int	ret, records_read, hits, misses, range_start;
+	zbx_hashset_iter_t	iter;
+	zbx_vc_item_t		*item;
+	zbx_vc_item_stats_t	*item_stats;
 
-	zbx_vector_history_record_clear(values);
+	if (ZBX_VC_DISABLED == vc_state)
+		return;
 
-	if (0 == count)
+	RDLOCK_CACHE;
+
+	zbx_vector_vc_item_stats_ptr_reserve(stats, (size_t)vc_cache->items.num_data);
+
+	zbx_hashset_iter_reset(&vc_cache->items, &iter);
+	while (NULL != (item = (zbx_vc_item_t *)zbx_hashset_iter_next(&iter)))
 	{
-		if (0 > (range_start = ts->sec - seconds))
-			range_start = 0;
+		item_stats = (zbx_vc_item_stats_t *)zbx_malloc(NULL, sizeof(zbx_vc_item_stats_t));
+		item_stats->itemid = item->itemid;
+		item_stats->values_num = item->values_total;
+		item_stats->hourly_num = item->last_hourly_num;
+		zbx_vector_vc_item_stats_ptr_append(stats, item_stats);
+	}
 
-		if (FAIL == (ret = vch_item_cache_values_by_time(&item, range_start)))
-			goto out;
+	UNLOCK_CACHE;
+}
 
-		records_read = ret;
+/******************************************************************************
+ *                                                                            *
+ * Purpose: flush locally cached statistics                                   *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_vc_flush_stats(void)
+{
+	int		i, now;
+	zbx_vc_item_t	*item = NULL;
+	zbx_uint64_t	itemid = 0;
 
-		vch_item_get_values_by_time(item, values, seconds, ts);
+	if (ZBX_VC_DISABLED == vc_state || 0 == vc_itemupdates.values_num)
+		return;
 
-		if (records_read > values->values_num)
-			records_read = values->values_num;
-	}
-	else
-	{
-		range_start = (0 == seconds ? 0 : ts->sec - seconds);
+	zbx_vector_vc_itemupdate_sort(&vc_itemupdates, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 
-		if (FAIL == (ret = vch_item_cache_values_by_time_and_count(&item, range_start, count, ts)))
-			goto out;
+	now = (int)time(NULL);
 
-		records_read = ret;
+	WRLOCK_CACHE;
 
-		vch_item_get_values_by_time_and_count(item, values, seconds, count, ts);
+	for (i = 0; i < vc_itemupdates.values_num; i++)
+	{
+		zbx_vc_item_update_t	*update = &vc_itemupdates.values[i];
 
-		if (records_read > values->values_num)
-			records_read = values->values_num;
-	}
+		if (itemid != update->itemid)
+		{
+			itemid = update->itemid;
+			item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &itemid);
+		}
 
-	hits = values->values_num - records_read;
-	misses = records_read;
+		if (NULL == item)
+			continue;
 
-	vc_cache_item_update(item->itemid, ZBX_VC_UPDATE_STATS, hits, misses);
+		switch (update->type)
+		{
+			case ZBX_VC_UPDATE_RANGE:
+				vch_item_update_range(item, update->data[ZBX_VC_UPDATE_RANGE_SECONDS],
+						update->data[ZBX_VC_UPDATE_RANGE_NOW]);
+				break;
+			case ZBX_VC_UPDATE_STATS:
+				vc_update_statistics(item, update->data[ZBX_VC_UPDATE_STATS_HITS],
+						update->data[ZBX_VC_UPDATE_STATS_MISSES], now);
+				break;
+			case ZBX_VC_UPDATE_WINDOW:
+				vch_item_update_window(item, update->data[ZBX_VC_UPDATE_WINDOW_PERIOD],
+						update->data[ZBX_VC_UPDATE_WINDOW_NOW]);
+				break;
+		}
+	}
 
-	ret = SUCCEED;
-out:
-	return ret;
+	UNLOCK_CACHE;
+
+	zbx_vector_vc_itemupdate_clear(&vc_itemupdates);
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: frees resources allocated for item history data                   *
- *                                                                            *
- * Parameters: item    - [IN] the item                                        *
- *                                                                            *
- * Return value: the size of freed memory (bytes)                             *
+ * Purpose: add newly created items with triggers to value cachel              *
  *                                                                            *
  ******************************************************************************/
-static size_t	vch_item_free_cache(zbx_vc_item_t *item)
+void	zbx_vc_add_new_items(const zbx_vector_uint64_pair_t *items)
 {
-	size_t	freed = 0;
+	if (ZBX_VC_DISABLED == vc_state)
+		return;
 
-	zbx_vc_chunk_t	*chunk = item->tail;
+	WRLOCK_CACHE;
 
-	while (NULL != chunk)
+	if (ZBX_VC_MODE_NORMAL == vc_cache->mode)
 	{
-		zbx_vc_chunk_t	*next = chunk->next;
+		int	i;
 
-		freed += vch_item_free_chunk(item, chunk);
-		chunk = next;
+		for (i = 0; i < items->values_num; i++)
+		{
+			if (NULL != zbx_hashset_search(&vc_cache->items, &items->values[i]))
+				continue;
+
+			zbx_vc_item_t	item_local = {
+					.itemid = items->values[i].first,
+					.value_type = (unsigned char)items->values[i].second,
+					.status = ZBX_ITEM_STATUS_CACHED_ALL,
+					.last_accessed = (int)time(NULL)
+
+			};
+
+			if (NULL == zbx_hashset_insert(&vc_cache->items, &item_local, sizeof(item_local)))
+			{
+				/* out of memory - cache will switch to low memory mode on next caching request */
+				break;
+			}
+		}
 	}
-	item->values_total = 0;
-	item->head = NULL;
-	item->tail = NULL;
 
-	return freed;
+	UNLOCK_CACHE;
 }
 
 /******************************************************************************************************************
  *                                                                                                                *
- * Public API                                                                                                     *
+ * Value cache snapshot                                                                                           *
  *                                                                                                                *
  ******************************************************************************************************************/
+/*
+ * The snapshot file contains a header followed by item records. Each item record
+ * is followed by item values in ascending order. Values are stored as timestamps
+ * followed by value data depending on value type - numeric values as 8 bytes,
+ * strings as length and contents, log values as log attributes and two strings.
+ *
+ * The snapshot is written in native byte order and structure layout, so it can be
+ * loaded only by the same server build on the same host.
+ */
 
-/******************************************************************************
- *                                                                            *
- * Purpose: initializes value cache                                           *
- *                                                                            *
- ******************************************************************************/
-int	zbx_vc_init(zbx_uint64_t value_cache_size, char **error)
-{
-	zbx_uint64_t	size_reserved;
-	int		ret = FAIL;
+#define VC_SNAPSHOT_MAGIC	0x53435658
+#define VC_SNAPSHOT_VERSION	1
 
-	if (0 == value_cache_size)
-		return SUCCEED;
+/* the string length marking NULL string */
+#define VC_SNAPSHOT_STR_NULL	((zbx_uint32_t)~0)
+#define VC_SNAPSHOT_STR_MAX	(64 * ZBX_MEBIBYTE)
 
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+/* the minimum size of value in snapshot file - timestamp followed by at least string length */
+#define VC_SNAPSHOT_VALUE_SIZE_MIN	(sizeof(zbx_timespec_t) + sizeof(zbx_uint32_t))
 
-	if (SUCCEED != (ret = zbx_rwlock_create(&vc_lock, ZBX_RWLOCK_VALUECACHE, error)))
-		goto out;
+typedef struct
+{
+	zbx_uint32_t	magic;
+	zbx_uint32_t	version;
+	zbx_uint32_t	record_size;	/* sizeof(zbx_history_record_t), used to detect incompatible builds */
+	int		clock;		/* the snapshot creation time */
+	zbx_uint64_t	items_num;
+}
+vc_snapshot_header_t;
 
-	size_reserved = zbx_shmem_required_size(1, "value cache size", "ValueCacheSize");
+typedef struct
+{
+	zbx_uint64_t	itemid;
+	unsigned char	value_type;
+	unsigned char	status;
+	int		active_range;
+	int		daily_range;
+	int		db_cached_from;
+	int		values_num;
+}
+vc_snapshot_item_t;
 
-	if (SUCCEED != zbx_shmem_create(&vc_mem, value_cache_size, "value cache size", "ValueCacheSize", 1,
-			error))
-	{
-		goto out;
-	}
+/* the number of snapshot items which missing values are read from database with a single query */
+#define VC_SNAPSHOT_BATCH_SIZE	1000
 
-	value_cache_size -= size_reserved;
+/* snapshot item waiting for values written after the snapshot was created to be read from database */
+typedef struct
+{
+	vc_snapshot_item_t		record;
 
-	vc_cache = (zbx_vc_cache_t *)__vc_shmem_malloc_func(vc_cache, sizeof(zbx_vc_cache_t));
+	/* the item values read from snapshot in ascending order */
+	zbx_vector_history_record_t	values;
 
-	if (NULL == vc_cache)
-	{
-		*error = zbx_strdup(*error, "cannot allocate value cache header");
-		goto out;
-	}
-	memset(vc_cache, 0, sizeof(zbx_vc_cache_t));
+	/* the start of period to read from database, aligned to ZBX_VC_PREFETCH_ALIGN to read items */
+	/* with close last snapshot values with the same query                                      */
+	int				range_start;
+}
+vc_snapshot_pending_t;
 
-	zbx_hashset_create_ext(&vc_cache->items, VC_ITEMS_INIT_SIZE,
-			ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC, NULL,
-			__vc_shmem_malloc_func, __vc_shmem_realloc_func, __vc_shmem_free_func);
+ZBX_VECTOR_DECL(vc_snapshot_pending, vc_snapshot_pending_t)
+ZBX_VECTOR_IMPL(vc_snapshot_pending, vc_snapshot_pending_t)
 
-	if (NULL == vc_cache->items.slots)
-	{
-		*error = zbx_strdup(*error, "cannot allocate value cache data storage");
-		goto out;
-	}
+static int	vc_snapshot_write(FILE *file, const void *data, size_t size)
+{
+	return 1 == fwrite(data, size, 1, file) ? SUCCEED : FAIL;
+}
 
-	zbx_hashset_create_ext(&vc_cache->strpool, VC_STRPOOL_INIT_SIZE,
-			vc_strpool_hash_func, vc_strpool_compare_func, NULL,
-			__vc_shmem_malloc_func, __vc_shmem_realloc_func, __vc_shmem_free_func);
+static int	vc_snapshot_read(FILE *file, void *data, size_t size)
+{
+	return 1 == fread(data, size, 1, file) ? SUCCEED : FAIL;
+}
 
-	if (NULL == vc_cache->strpool.slots)
+static int	vc_snapshot_write_str(FILE *file, const char *str)
+{
+	zbx_uint32_t	len;
+
+	if (NULL == str)
 	{
-		*error = zbx_strdup(*error, "cannot allocate string pool for value cache data storage");
-		goto out;
+		len = VC_SNAPSHOT_STR_NULL;
+		return vc_snapshot_write(file, &len, sizeof(len));
 	}
 
-	/* the free space request should be 5% of cache size, but no more than 128KB */
-	vc_cache->min_free_request = (value_cache_size / 100) * 5;
-	if (vc_cache->min_free_request > 128 * ZBX_KIBIBYTE)
-		vc_cache->min_free_request = 128 * ZBX_KIBIBYTE;
-
-	zbx_vector_vc_itemupdate_create(&vc_itemupdates);
-	zbx_vector_vc_itemupdate_reserve(&vc_itemupdates, 256);
-
-	ret = SUCCEED;
-out:
-	zbx_vc_disable();
+	len = (zbx_uint32_t)strlen(str);
 
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+	if (SUCCEED != vc_snapshot_write(file, &len, sizeof(len)))
+		return FAIL;
 
-	return ret;
+	return 0 == len ? SUCCEED : vc_snapshot_write(file, str, len);
 }
 
-/******************************************************************************
- *                                                                            *
- * Purpose: destroys value cache                                              *
- *                                                                            *
- ******************************************************************************/
-void	zbx_vc_destroy(void)
+static int	vc_snapshot_read_str(FILE *file, char **str)
 {
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+	zbx_uint32_t	len;
 
-	if (NULL != vc_cache)
+	if (SUCCEED != vc_snapshot_read(file, &len, sizeof(len)))
+		return FAIL;
+
+	if (VC_SNAPSHOT_STR_NULL == len)
 	{
-		zbx_vector_vc_itemupdate_destroy(&vc_itemupdates);
+		*str = NULL;
+		return SUCCEED;
+	}
 
-		zbx_hashset_destroy(&vc_cache->items);
-		zbx_hashset_destroy(&vc_cache->strpool);
+	if (VC_SNAPSHOT_STR_MAX < len)
+		return FAIL;
 
-		__vc_shmem_free_func(vc_cache);
-		vc_cache = NULL;
+	*str = (char *)zbx_malloc(NULL, len + 1);
+	(*str)[len] = '\0';
 
-		zbx_shmem_destroy(vc_mem);
-		vc_mem = NULL;
-		zbx_rwlock_destroy(&vc_lock);
+	if (0 != len && SUCCEED != vc_snapshot_read(file, *str, len))
+	{
+		zbx_free(*str);
+		return FAIL;
 	}
 
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+	return SUCCEED;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: resets value cache                                                *
+ * Purpose: checks if the rest of snapshot file can hold the specified number *
+ *          of values                                                         *
  *                                                                            *
- * Comments: All items and their historical data are removed,                 *
- *           cache working mode, statistics reset.                            *
+ * Parameters: file       - [IN] the snapshot file positioned after item      *
+ *                               record                                       *
+ *             file_size  - [IN] the snapshot file size                       *
+ *             values_num - [IN] the number of item values                    *
+ *                                                                            *
+ * Return value: SUCCEED - the number of values is valid                      *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: Used to reject corrupted records before reserving space for the  *
+ *           values.                                                          *
  *                                                                            *
  ******************************************************************************/
-void	zbx_vc_reset(void)
+static int	vc_snapshot_check_values_num(FILE *file, zbx_uint64_t file_size, int values_num)
 {
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+	long	offset;
 
-	if (NULL != vc_cache)
-	{
-		zbx_vc_item_t		*item;
-		zbx_hashset_iter_t	iter;
+	if (0 >= values_num || -1 == (offset = ftell(file)) || file_size < (zbx_uint64_t)offset)
+		return FAIL;
 
-		WRLOCK_CACHE;
+	if ((zbx_uint64_t)values_num > (file_size - (zbx_uint64_t)offset) / VC_SNAPSHOT_VALUE_SIZE_MIN)
+		return FAIL;
 
-		zbx_hashset_iter_reset(&vc_cache->items, &iter);
-		while (NULL != (item = (zbx_vc_item_t *)zbx_hashset_iter_next(&iter)))
-		{
-			vch_item_free_cache(item);
-			zbx_hashset_iter_remove(&iter);
-		}
+	return SUCCEED;
+}
 
-		vc_cache->hits = 0;
-		vc_cache->misses = 0;
-		vc_cache->min_free_request = 0;
-		vc_cache->mode = ZBX_VC_MODE_NORMAL;
-		vc_cache->mode_time = 0;
-		vc_cache->last_warning_time = 0;
+/******************************************************************************
+ *                                                                            *
+ * Purpose: writes history value to snapshot file                             *
+ *                                                                            *
+ ******************************************************************************/
+static int	vc_snapshot_write_value(FILE *file, unsigned char value_type, const zbx_history_record_t *value)
+{
+	if (SUCCEED != vc_snapshot_write(file, &value->timestamp, sizeof(value->timestamp)))
+		return FAIL;
 
-		UNLOCK_CACHE;
-	}
+	switch (value_type)
+	{
+		case ITEM_VALUE_TYPE_STR:
+		case ITEM_VALUE_TYPE_TEXT:
+			return vc_snapshot_write_str(file, value->value.str);
+		case ITEM_VALUE_TYPE_LOG:
+			if (SUCCEED != vc_snapshot_write(file, &value->value.log->timestamp, sizeof(int)) ||
+					SUCCEED != vc_snapshot_write(file, &value->value.log->logeventid, sizeof(int)) ||
+					SUCCEED != vc_snapshot_write(file, &value->value.log->severity, sizeof(int)) ||
+					SUCCEED != vc_snapshot_write_str(file, value->value.log->source))
+			{
+				return FAIL;
+			}
 
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+			return vc_snapshot_write_str(file, value->value.log->value);
+		default:
+			return vc_snapshot_write(file, &value->value.ui64, sizeof(value->value.ui64));
+	}
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: adds item values to history and value cache                       *
- *                                                                            *
- * Parameters:                                                                *
- *   history                          - [IN] item history values              *
- *   ret_flush                        - [OUT]                                 *
- *   config_history_storage_pipelines - [IN]                                  *
+ * Purpose: reads history value from snapshot file                            *
  *                                                                            *
- * Return value: SUCCEED - values were added successfully                     *
- *               FAIL    - otherwise                                          *
+ * Comments: The value contents are allocated in process memory and must be   *
+ *           freed by the caller.                                             *
  *                                                                            *
  ******************************************************************************/
-int	zbx_vc_add_values(zbx_vector_dc_history_ptr_t *history, int *ret_flush, int config_history_storage_pipelines)
+static int	vc_snapshot_read_value(FILE *file, unsigned char value_type, zbx_history_record_t *value)
 {
-	zbx_vc_item_t		*item;
-	int			i;
-	zbx_dc_history_t	*h;
+	zbx_log_value_t	*log;
 
-	if (SUCCEED != zbx_history_add_values(history, ret_flush, config_history_storage_pipelines))
+	if (SUCCEED != vc_snapshot_read(file, &value->timestamp, sizeof(value->timestamp)))
 		return FAIL;
 
-	if (ZBX_VC_DISABLED == vc_state)
-		return SUCCEED;
-
-	WRLOCK_CACHE;
-
-	for (i = 0; i < history->values_num; i++)
+	switch (value_type)
 	{
-		h = history->values[i];
-
-		item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &h->itemid);
+		case ITEM_VALUE_TYPE_STR:
+		case ITEM_VALUE_TYPE_TEXT:
+			if (SUCCEED != vc_snapshot_read_str(file, &value->value.str))
+				return FAIL;
 
-		if (NULL == item && 0 != (h->flags & ZBX_DC_FLAG_HASTRIGGER) && ZBX_VC_MODE_NORMAL == vc_cache->mode)
-		{
-			zbx_vc_item_t	item_local = {
-					.itemid = h->itemid,
-					.value_type = h->value_type,
-					.last_accessed = (int)time(NULL)
+			/* NULL strings are never cached */
+			if (NULL == value->value.str)
+				return FAIL;
 
-			};
+			return SUCCEED;
+		case ITEM_VALUE_TYPE_LOG:
+			log = (zbx_log_value_t *)zbx_malloc(NULL, sizeof(zbx_log_value_t));
+			log->source = NULL;
+			log->value = NULL;
+			value->value.log = log;
+
+			if (SUCCEED != vc_snapshot_read(file, &log->timestamp, sizeof(int)) ||
+					SUCCEED != vc_snapshot_read(file, &log->logeventid, sizeof(int)) ||
+					SUCCEED != vc_snapshot_read(file, &log->severity, sizeof(int)) ||
+					SUCCEED != vc_snapshot_read_str(file, &log->source) ||
+					SUCCEED != vc_snapshot_read_str(file, &log->value) || NULL == log->value)
+			{
+				vc_history_logfree(log);
+				return FAIL;
+			}
 
-			item = (zbx_vc_item_t *)zbx_hashset_insert(&vc_cache->items, &item_local, sizeof(item_local));
-		}
+			return SUCCEED;
+		default:
+			return vc_snapshot_read(file, &value->value.ui64, sizeof(value->value.ui64));
+	}
+}
 
-		/* cache new values only after the item history database status is known */
-		if (NULL != item)
-		{
-			zbx_history_record_t	record = {h->ts, h->value};
-			zbx_vc_chunk_t		*head = item->head;
-			int			last_value_timestamp;
+/******************************************************************************
+ *                                                                            *
+ * Purpose: writes item and its cached values to snapshot file                *
+ *                                                                            *
+ ******************************************************************************/
+static int	vc_snapshot_write_item(FILE *file, const zbx_vc_item_t *item)
+{
+	vc_snapshot_item_t	record;
+	const zbx_vc_chunk_t	*chunk;
+
+	record.itemid = item->itemid;
+	record.value_type = item->value_type;
+	record.status = item->status;
+	record.active_range = item->active_range;
+	record.daily_range = item->daily_range;
+	record.db_cached_from = item->db_cached_from;
+	record.values_num = item->values_total;
+
+	if (SUCCEED != vc_snapshot_write(file, &record, sizeof(record)))
+		return FAIL;
 
-			if (NULL != head)
-				last_value_timestamp = head->slots[head->last_value].timestamp.sec;
-			else
-				last_value_timestamp = (int)time(NULL);
+	for (chunk = item->tail; NULL != chunk; chunk = chunk->next)
+	{
+		const zbx_history_record_t	*slots;
+		int				i;
 
-			/* If the new value type does not match the item's type in cache remove it, */
-			/* so it's cached with the correct type from correct tables when accessed   */
-			/* next time.                                                               */
-			/* Also remove item if the value adding failed. In this case we             */
-			/* won't have the latest data in cache - so the requests must go directly   */
-			/* to the database.                                                         */
-			if (item->value_type != h->value_type || FAIL == vch_item_add_value_at_head(item, &record))
-			{
-				vc_remove_item(item);
-				continue;
-			}
+		slots = vch_chunk_get_slots(chunk, &vc_unpack_buffer);
 
-			/* try to remove old (unused) chunks if a new chunk was added */
-			if (head != item->head)
-				vch_item_clean_cache(item, last_value_timestamp);
+		for (i = chunk->first_value; i <= chunk->last_value; i++)
+		{
+			if (SUCCEED != vc_snapshot_write_value(file, item->value_type, &slots[i]))
+				return FAIL;
 		}
 	}
 
-	UNLOCK_CACHE;
-
 	return SUCCEED;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: get item history data for the specified time period               *
- *                                                                            *
- * Parameters: itemid     - [IN] the item id                                  *
- *             value_type - [IN] the item value type                          *
- *             values     - [OUT] the item history data stored time/value     *
- *                          pairs in descending order                         *
- *             seconds    - [IN] the time period to retrieve data for         *
- *             count      - [IN] the number of history values to retrieve     *
- *             ts         - [IN] the period end timestamp                     *
+ * Purpose: saves value cache contents to snapshot file                       *
  *                                                                            *
- * Return value:  SUCCEED - the item history data was retrieved successfully  *
- *                FAIL    - the item history data was not retrieved           *
+ * Parameters: path  - [IN] the snapshot file path                            *
+ *             error - [OUT] the error message                                *
  *                                                                            *
- * Comments: If the data is not in cache, it's read from DB, so this function *
- *           will always return the requested data, unless some error occurs. *
+ * Return value: SUCCEED - the snapshot was saved                             *
+ *               FAIL    - otherwise                                          *
  *                                                                            *
- *           If <count> is set then value range is defined as <count> values  *
- *           before <timestamp>. Otherwise the range is defined as <seconds>  *
- *           seconds before <timestamp>.                                      *
+ * Comments: The snapshot is written to a temporary file which is renamed to  *
+ *           the target path when completed, so an incomplete snapshot is     *
+ *           never loaded.                                                    *
  *                                                                            *
  ******************************************************************************/
-int	zbx_vc_get_values(zbx_uint64_t itemid, unsigned char value_type, zbx_vector_history_record_t *values,
-		int seconds, int count, const zbx_timespec_t *ts)
+int	zbx_vc_snapshot_save(const char *path, char **error)
 {
-	zbx_vc_item_t	*item, new_item;
-	int 		ret = FAIL, cache_used = 1;
+	FILE			*file;
+	char			*tmp_path;
+	int			ret = FAIL;
+	vc_snapshot_header_t	header = {.magic = VC_SNAPSHOT_MAGIC, .version = VC_SNAPSHOT_VERSION,
+					.record_size = sizeof(zbx_history_record_t)};
+	zbx_hashset_iter_t	iter;
+	zbx_vc_item_t		*item;
+	zbx_uint64_t		values_num = 0;
+	double			time_start;
 
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s() itemid:" ZBX_FS_UI64 " value_type:%d count:%d period:%d end_timestamp"
-			" '%s'", __func__, itemid, value_type, count, seconds, zbx_timespec_str(ts));
+	if (NULL == vc_cache || ZBX_VC_DISABLED == vc_state)
+		return SUCCEED;
 
-	if (ITEM_VALUE_TYPE_BIN == value_type)
-		return FAIL;
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() path:%s", __func__, path);
 
-	RDLOCK_CACHE;
+	time_start = zbx_time();
+	tmp_path = zbx_dsprintf(NULL, "%s.tmp", path);
 
-	if (ZBX_VC_DISABLED == vc_state)
+	if (NULL == (file = fopen(tmp_path, "wb")))
+	{
+		*error = zbx_dsprintf(*error, "cannot create file \"%s\": %s", tmp_path, zbx_strerror(errno));
 		goto out;
+	}
 
-	if (ZBX_VC_MODE_LOWMEM == vc_cache->mode)
-		vc_warn_low_memory();
+	RDLOCK_CACHE;
 
-	if (NULL == (item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &itemid)))
-	{
-		if (ZBX_VC_MODE_NORMAL != vc_cache->mode)
-			goto out;
+	header.clock = (int)time(NULL);
 
-		memset(&new_item, 0, sizeof(new_item));
-		new_item.itemid = itemid;
-		new_item.value_type = value_type;
-		item = &new_item;
+	zbx_hashset_iter_reset(&vc_cache->items, &iter);
+	while (NULL != (item = (zbx_vc_item_t *)zbx_hashset_iter_next(&iter)))
+	{
+		if (NULL != item->head)
+			header.items_num++;
 	}
-	else if (item->value_type != value_type)
-		goto out;
 
-	ret = vch_item_get_values(item, values, seconds, count, ts);
-out:
-	if (FAIL == ret)
+	if (SUCCEED == (ret = vc_snapshot_write(file, &header, sizeof(header))))
 	{
-		cache_used = 0;
-
-		UNLOCK_CACHE;
-		ret = vc_db_get_values(itemid, value_type, values, seconds, count, ts);
-		WRLOCK_CACHE;
+		zbx_hashset_iter_reset(&vc_cache->items, &iter);
+		while (NULL != (item = (zbx_vc_item_t *)zbx_hashset_iter_next(&iter)))
+		{
+			if (NULL == item->head)
+				continue;
 
-		if (ZBX_VC_DISABLED != vc_state)
-			vc_remove_item_by_id(itemid);
+			if (SUCCEED != (ret = vc_snapshot_write_item(file, item)))
+				break;
 
-		if (SUCCEED == ret)
-			vc_update_statistics(NULL, 0, values->values_num, (int)time(NULL));
+			values_num += (zbx_uint64_t)item->values_total;
+		}
 	}
 
 	UNLOCK_CACHE;
 
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s count:%d cached:%d",
-			__func__, zbx_result_string(ret), values->values_num, cache_used);
-
-	return ret;
-}
-
-/******************************************************************************
- *                                                                            *
- * Purpose: get the last history value with a timestamp less or equal to the  *
- *          target timestamp                                                  *
- *                                                                            *
- * Parameters: itemid     - [IN] the item id                                  *
- *             value_type - [IN] the item value type                          *
- *             ts         - [IN] the target timestamp                         *
- *             value      - [OUT] the value found                             *
- *                                                                            *
- * Return Value: SUCCEED - the item was retrieved                             *
- *               FAIL    - otherwise                                          *
- *                                                                            *
- * Comments: Depending on the value type this function might allocate memory  *
- *           to store value data. To free it use zbx_vc_history_value_clear() *
- *           function.                                                        *
- *                                                                            *
- ******************************************************************************/
-int	zbx_vc_get_value(zbx_uint64_t itemid, unsigned char value_type, const zbx_timespec_t *ts,
-		zbx_history_record_t *value)
-{
-	zbx_vector_history_record_t	values;
-	int				ret = FAIL;
-
-	zbx_history_record_vector_create(&values);
+	if (0 != fclose(file))
+		ret = FAIL;
 
-	if (SUCCEED != zbx_vc_get_values(itemid, value_type, &values, ts->sec, 1, ts) || 0 == values.values_num)
+	if (SUCCEED != ret)
+	{
+		*error = zbx_dsprintf(*error, "cannot write file \"%s\": %s", tmp_path, zbx_strerror(errno));
+		unlink(tmp_path);
 		goto out;
+	}
 
-	*value = values.values[0];
-
-	/* reset values vector size so the returned value is not cleared when destroying the vector */
-	values.values_num = 0;
+	if (0 != rename(tmp_path, path))
+	{
+		*error = zbx_dsprintf(*error, "cannot rename file \"%s\" to \"%s\": %s", tmp_path, path,
+				zbx_strerror(errno));
+		unlink(tmp_path);
+		ret = FAIL;
+		goto out;
+	}
 
-	ret = SUCCEED;
+	zabbix_log(LOG_LEVEL_INFORMATION, "saved " ZBX_FS_UI64 " items with " ZBX_FS_UI64 " values to value cache"
+			" snapshot \"%s\" in " ZBX_FS_DBL " sec", header.items_num, values_num, path,
+			zbx_time() - time_start);
 out:
-	zbx_history_record_vector_destroy(&values, value_type);
+	zbx_free(tmp_path);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
 
 	return ret;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: retrieves usage cache statistics                                  *
+ * Purpose: restores snapshot item in value cache                             *
  *                                                                            *
- * Parameters: stats     - [OUT] the cache usage statistics                   *
+ * Parameters: record - [IN] the snapshot item                                *
+ *             values - [IN/OUT] the item values in ascending order, values   *
+ *                               read from database are appended              *
+ *             gap    - [IN/OUT] the item values read from database since the *
+ *                               aligned last snapshot value second, the      *
+ *                               values are moved to values vector or freed   *
+ *             now    - [IN] the current time                                 *
+ *             stats  - [IN/OUT] the snapshot loading statistics              *
  *                                                                            *
- * Return value:  SUCCEED - the cache statistics were retrieved successfully  *
- *                FAIL    - failed to retrieve cache statistics               *
- *                          (cache was not initialized)                       *
+ * Return value: SUCCEED - the item was restored or discarded                 *
+ *               FAIL    - not enough space in value cache                    *
+ *                                                                            *
+ * Comments: Values newer than the last snapshot value second are read from   *
+ *           database, so the values written after the snapshot was created   *
+ *           (for example by another HA node) are also cached.                *
  *                                                                            *
  ******************************************************************************/
-int	zbx_vc_get_statistics(zbx_vc_stats_t *stats)
+static int	vc_snapshot_restore_item(const vc_snapshot_item_t *record, zbx_vector_history_record_t *values,
+		zbx_vector_history_record_t *gap, int now, zbx_vc_snapshot_stats_t *stats)
 {
-	if (ZBX_VC_DISABLED == vc_state)
-		return FAIL;
+	zbx_vc_item_t	*item, item_local;
+	int		last_sec, i, ret = SUCCEED;
 
-	RDLOCK_CACHE;
+	last_sec = values->values[values->values_num - 1].timestamp.sec;
 
-	stats->hits = vc_cache->hits;
-	stats->misses = vc_cache->misses;
-	stats->mode = vc_cache->mode;
+	/* replace values of the last snapshot second with values read from database */
+	while (0 < values->values_num && values->values[values->values_num - 1].timestamp.sec == last_sec)
+	{
+		zbx_history_record_clear(&values->values[values->values_num - 1], record->value_type);
+		values->values_num--;
+	}
 
-	stats->total_size = vc_mem->total_size;
-	stats->free_size = vc_mem->free_size;
+	zbx_vector_history_record_sort(gap, (zbx_compare_func_t)zbx_history_record_compare_asc_func);
+
+	for (i = 0; i < gap->values_num; i++)
+	{
+		/* the values before the last snapshot value second are already in snapshot */
+		if (gap->values[i].timestamp.sec < last_sec)
+		{
+			zbx_history_record_clear(&gap->values[i], record->value_type);
+			continue;
+		}
+
+		zbx_vector_history_record_append_ptr(values, &gap->values[i]);
+		stats->gap_values++;
+	}
+
+	/* the gap values are owned by values vector or freed now */
+	gap->values_num = 0;
+
+	if (0 == values->values_num)
+	{
+		stats->discarded++;
+		return SUCCEED;
+	}
+
+	WRLOCK_CACHE;
+
+	/* skip items added by configuration syncer while loading snapshot */
+	if (NULL != zbx_hashset_search(&vc_cache->items, &record->itemid))
+	{
+		stats->discarded++;
+		goto out;
+	}
 
+	memset(&item_local, 0, sizeof(item_local));
+	item_local.itemid = record->itemid;
+	item_local.value_type = record->value_type;
+	item_local.status = record->status;
+	item_local.active_range = record->active_range;
+	item_local.daily_range = record->daily_range;
+	item_local.db_cached_from = record->db_cached_from;
+	item_local.last_accessed = now;
+	item_local.range_sync_hour = (unsigned char)((now / SEC_PER_HOUR) & 0xff);
+
+	if (NULL == (item = (zbx_vc_item_t *)zbx_hashset_insert(&vc_cache->items, &item_local, sizeof(item_local))))
+	{
+		ret = FAIL;
+		goto out;
+	}
+
+	if (SUCCEED != vch_item_add_values_at_tail(item, values->values, values->values_num))
+	{
+		vc_remove_item(item);
+		ret = FAIL;
+		goto out;
+	}
+
+	stats->items++;
+	stats->values += (zbx_uint64_t)values->values_num;
+out:
 	UNLOCK_CACHE;
 
-	return SUCCEED;
+	return ret;
 }
 
-/******************************************************************************
- *                                                                            *
- * Purpose: enables value caching for current process                         *
- *                                                                            *
- ******************************************************************************/
-void	zbx_vc_enable(void)
+static int	vc_snapshot_pending_compare(const void *d1, const void *d2)
 {
-	if (NULL != vc_cache)
-		vc_state = ZBX_VC_ENABLED;
+	const vc_snapshot_pending_t	*p1 = (const vc_snapshot_pending_t *)d1;
+	const vc_snapshot_pending_t	*p2 = (const vc_snapshot_pending_t *)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(p1->record.value_type, p2->record.value_type);
+	ZBX_RETURN_IF_NOT_EQUAL(p1->range_start, p2->range_start);
+	ZBX_RETURN_IF_NOT_EQUAL(p1->record.itemid, p2->record.itemid);
+
+	return 0;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: disables value caching for current process                        *
+ * Purpose: reads values written after the snapshot was created for pending   *
+ *          snapshot items and restores the items in value cache              *
  *                                                                            *
- ******************************************************************************/
-void	zbx_vc_disable(void)
-{
-	vc_state = ZBX_VC_DISABLED;
-}
-
-/******************************************************************************
+ * Parameters: pending - [IN/OUT] the pending snapshot items, cleared on exit *
+ *             now     - [IN] the current time                                *
+ *             stats   - [IN/OUT] the snapshot loading statistics             *
  *                                                                            *
- * Purpose: get value cache diagnostic statistics                             *
+ * Return value: SUCCEED - the items were restored or discarded               *
+ *               FAIL    - not enough space in value cache                    *
+ *                                                                            *
+ * Comments: The items with the same value type and aligned last snapshot     *
+ *           value second are read from database with a single query.         *
  *                                                                            *
  ******************************************************************************/
-void	zbx_vc_get_diag_stats(zbx_uint64_t *items_num, zbx_uint64_t *values_num, int *mode)
+static int	vc_snapshot_restore_items(zbx_vector_vc_snapshot_pending_t *pending, int now,
+		zbx_vc_snapshot_stats_t *stats)
 {
-	zbx_hashset_iter_t	iter;
-	zbx_vc_item_t		*item;
+	zbx_vector_uint64_t		itemids;
+	zbx_vector_history_record_t	*records;
+	int				i, j, k, ret = SUCCEED;
 
-	*values_num = 0;
+	zbx_vector_vc_snapshot_pending_sort(pending, vc_snapshot_pending_compare);
+	zbx_vector_uint64_create(&itemids);
 
-	if (ZBX_VC_DISABLED == vc_state)
+	for (i = 0; i < pending->values_num; i = j)
 	{
-		*items_num = 0;
-		*mode = -1;
-		return;
-	}
+		const vc_snapshot_pending_t	*first = &pending->values[i];
+		int				range_start;
 
-	RDLOCK_CACHE;
+		zbx_vector_uint64_clear(&itemids);
 
-	*items_num = (zbx_uint64_t)vc_cache->items.num_data;
-	*mode = vc_cache->mode;
+		for (j = i; j < pending->values_num && pending->values[j].record.value_type ==
+				first->record.value_type && pending->values[j].range_start == first->range_start; j++)
+		{
+			zbx_vector_uint64_append(&itemids, pending->values[j].record.itemid);
+		}
 
-	zbx_hashset_iter_reset(&vc_cache->items, &iter);
-	while (NULL != (item = (zbx_vc_item_t *)zbx_hashset_iter_next(&iter)))
-		*values_num += (zbx_uint64_t)item->values_total;
+		if (SUCCEED != ret)
+		{
+			stats->discarded += (zbx_uint64_t)itemids.values_num;
+			continue;
+		}
 
-	UNLOCK_CACHE;
-}
+		records = (zbx_vector_history_record_t *)zbx_malloc(NULL, sizeof(zbx_vector_history_record_t) *
+				(size_t)itemids.values_num);
 
-/******************************************************************************
- *                                                                            *
- * Purpose: get value cache shared memory statistics                          *
- *                                                                            *
- ******************************************************************************/
-void	zbx_vc_get_mem_stats(zbx_shmem_stats_t *mem)
-{
-	if (ZBX_VC_DISABLED == vc_state)
-	{
-		memset(mem, 0, sizeof(zbx_shmem_stats_t));
-		return;
+		for (k = 0; k < itemids.values_num; k++)
+			zbx_history_record_vector_create(&records[k]);
+
+		/* decrement interval start point because interval starting point is excluded by history backend */
+		if (0 != (range_start = first->range_start))
+			range_start--;
+
+		/* read also values with future timestamps, they would be cached if received while server was running */
+		if (SUCCEED == zbx_history_get_values_multi(itemids.values, itemids.values_num,
+				first->record.value_type, range_start, 0, ZBX_JAN_2038, records))
+		{
+			for (k = 0; k < itemids.values_num; k++)
+			{
+				vc_snapshot_pending_t	*item = &pending->values[i + k];
+
+				if (SUCCEED != ret || SUCCEED != (ret = vc_snapshot_restore_item(&item->record,
+						&item->values, &records[k], now, stats)))
+				{
+					stats->discarded++;
+				}
+			}
+		}
+		else
+			stats->discarded += (zbx_uint64_t)itemids.values_num;
+
+		for (k = 0; k < itemids.values_num; k++)
+			zbx_history_record_vector_destroy(&records[k], first->record.value_type);
+
+		zbx_free(records);
 	}
 
-	RDLOCK_CACHE;
-	zbx_shmem_get_stats(vc_mem, mem);
-	UNLOCK_CACHE;
+	zbx_vector_uint64_destroy(&itemids);
+
+	for (i = 0; i < pending->values_num; i++)
+		zbx_history_record_vector_destroy(&pending->values[i].values, pending->values[i].record.value_type);
+
+	zbx_vector_vc_snapshot_pending_clear(pending);
+
+	return ret;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: get statistics of cached items                                    *
+ * Purpose: loads value cache contents from snapshot file                     *
+ *                                                                            *
+ * Parameters: path          - [IN] the snapshot file path                    *
+ *             check_item_cb - [IN] the callback to check if snapshot item    *
+ *                                  matches current configuration             *
+ *             error         - [OUT] the error message                        *
+ *                                                                            *
+ * Return value: SUCCEED - the snapshot was loaded or does not exist          *
+ *               FAIL    - the snapshot file is invalid                       *
+ *                                                                            *
+ * Comments: The snapshot file is removed after loading, so a stale snapshot  *
+ *           is not loaded after the server crashes.                          *
+ *           This function must be called after configuration cache is        *
+ *           synchronized and before history syncers are started.             *
  *                                                                            *
  ******************************************************************************/
-void	zbx_vc_get_item_stats(zbx_vector_vc_item_stats_ptr_t *stats)
+int	zbx_vc_snapshot_load(const char *path, zbx_vc_check_item_func_t check_item_cb, char **error)
 {
-	zbx_hashset_iter_t	iter;
-	zbx_vc_item_t		*item;
-	zbx_vc_item_stats_t	*item_stats;
+	FILE					*file;
+	vc_snapshot_header_t			header;
+	vc_snapshot_item_t			record;
+	zbx_vector_vc_snapshot_pending_t	pending;
+	zbx_vc_snapshot_stats_t			stats = {0};
+	zbx_stat_t				st;
+	zbx_uint64_t				i;
+	int					ret = FAIL, now, j, last_sec;
+	double					time_start;
 
 	if (ZBX_VC_DISABLED == vc_state)
-		return;
+		return SUCCEED;
 
-	RDLOCK_CACHE;
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() path:%s", __func__, path);
 
-	zbx_vector_vc_item_stats_ptr_reserve(stats, (size_t)vc_cache->items.num_data);
+	time_start = zbx_time();
 
-	zbx_hashset_iter_reset(&vc_cache->items, &iter);
-	while (NULL != (item = (zbx_vc_item_t *)zbx_hashset_iter_next(&iter)))
+	if (NULL == (file = fopen(path, "rb")))
 	{
-		item_stats = (zbx_vc_item_stats_t *)zbx_malloc(NULL, sizeof(zbx_vc_item_stats_t));
-		item_stats->itemid = item->itemid;
-		item_stats->values_num = item->values_total;
-		item_stats->hourly_num = item->last_hourly_num;
-		zbx_vector_vc_item_stats_ptr_append(stats, item_stats);
-	}
+		if (ENOENT == errno)
+		{
+			ret = SUCCEED;
+		}
+		else
+		{
+			*error = zbx_dsprintf(*error, "cannot open file \"%s\": %s", path,
+					zbx_strerror(errno));
+		}
 
-	UNLOCK_CACHE;
-}
+		goto out;
+	}
 
-/******************************************************************************
- *                                                                            *
- * Purpose: flush locally cached statistics                                   *
- *                                                                            *
- ******************************************************************************/
-void	zbx_vc_flush_stats(void)
-{
-	int		i, now;
-	zbx_vc_item_t	*item = NULL;
-	zbx_uint64_t	itemid = 0;
+	zbx_vector_vc_snapshot_pending_create(&pending);
+	zbx_vector_vc_snapshot_pending_reserve(&pending, VC_SNAPSHOT_BATCH_SIZE);
 
-	if (ZBX_VC_DISABLED == vc_state || 0 == vc_itemupdates.values_num)
-		return;
+	if (0 != zbx_fstat(fileno(file), &st))
+	{
+		*error = zbx_dsprintf(*error, "cannot obtain file \"%s\" information: %s", path,
+				zbx_strerror(errno));
+		goto close;
+	}
 
-	zbx_vector_vc_itemupdate_sort(&vc_itemupdates, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	if (SUCCEED != vc_snapshot_read(file, &header, sizeof(header)) || VC_SNAPSHOT_MAGIC != header.magic ||
+			VC_SNAPSHOT_VERSION != header.version || sizeof(zbx_history_record_t) != header.record_size)
+	{
+		*error = zbx_dsprintf(*error, "invalid file \"%s\" header", path);
+		goto close;
+	}
 
 	now = (int)time(NULL);
 
-	WRLOCK_CACHE;
-
-	for (i = 0; i < vc_itemupdates.values_num; i++)
+	for (i = 0; i < header.items_num; i++)
 	{
-		zbx_vc_item_update_t	*update = &vc_itemupdates.values[i];
+		vc_snapshot_pending_t	*item, item_local;
 
-		if (itemid != update->itemid)
+		if (SUCCEED != vc_snapshot_read(file, &record, sizeof(record)) ||
+				ITEM_VALUE_TYPE_BIN <= record.value_type || SUCCEED !=
+				vc_snapshot_check_values_num(file, (zbx_uint64_t)st.st_size, record.values_num))
 		{
-			itemid = update->itemid;
-			item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &itemid);
+			*error = zbx_dsprintf(*error, "invalid item record in file \"%s\"", path);
+			goto close;
 		}
 
-		if (NULL == item)
+		item_local.record = record;
+		zbx_history_record_vector_create(&item_local.values);
+		zbx_vector_history_record_reserve(&item_local.values, (size_t)record.values_num);
+		zbx_vector_vc_snapshot_pending_append(&pending, item_local);
+		item = &pending.values[pending.values_num - 1];
+
+		for (j = 0; j < record.values_num; j++)
+		{
+			zbx_history_record_t	value;
+
+			if (SUCCEED != vc_snapshot_read_value(file, record.value_type, &value))
+			{
+				*error = zbx_dsprintf(*error, "invalid value of item " ZBX_FS_UI64 " in file \"%s\"",
+						record.itemid, path);
+				goto close;
+			}
+
+			zbx_vector_history_record_append_ptr(&item->values, &value);
+		}
+
+		last_sec = item->values.values[item->values.values_num - 1].timestamp.sec;
+
+		/* discard items not matching configuration and items which cached values are outside the item */
+		/* request range and would be dropped anyway                                                   */
+		if (SUCCEED != check_item_cb(record.itemid, record.value_type) ||
+				(0 != record.active_range && last_sec < now - record.active_range))
+		{
+			zbx_history_record_vector_destroy(&item->values, record.value_type);
+			pending.values_num--;
+			stats.discarded++;
 			continue;
+		}
 
-		switch (update->type)
+		item->range_start = last_sec - last_sec % ZBX_VC_PREFETCH_ALIGN;
+
+		if (VC_SNAPSHOT_BATCH_SIZE > pending.values_num)
+			continue;
+
+		if (SUCCEED != vc_snapshot_restore_items(&pending, now, &stats))
 		{
-			case ZBX_VC_UPDATE_RANGE:
-				vch_item_update_range(item, update->data[ZBX_VC_UPDATE_RANGE_SECONDS],
-						update->data[ZBX_VC_UPDATE_RANGE_NOW]);
-				break;
-			case ZBX_VC_UPDATE_STATS:
-				vc_update_statistics(item, update->data[ZBX_VC_UPDATE_STATS_HITS],
-						update->data[ZBX_VC_UPDATE_STATS_MISSES], now);
-				break;
+			zabbix_log(LOG_LEVEL_WARNING, "not enough space in value cache to load snapshot, skipping"
+					" remaining " ZBX_FS_UI64 " items", header.items_num - i - 1);
+			stats.discarded += header.items_num - i - 1;
+			break;
 		}
 	}
 
+	if (0 != pending.values_num && SUCCEED != vc_snapshot_restore_items(&pending, now, &stats))
+		zabbix_log(LOG_LEVEL_WARNING, "not enough space in value cache to load snapshot");
+
+	ret = SUCCEED;
+close:
+	for (j = 0; j < pending.values_num; j++)
+		zbx_history_record_vector_destroy(&pending.values[j].values, pending.values[j].record.value_type);
+
+	zbx_vector_vc_snapshot_pending_destroy(&pending);
+	fclose(file);
+
+	if (0 != unlink(path))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot remove value cache snapshot file \"%s\": %s", path,
+				zbx_strerror(errno));
+	}
+
+	stats.time = zbx_time() - time_start;
+
+	WRLOCK_CACHE;
+	vc_cache->snapshot_stats = stats;
 	UNLOCK_CACHE;
 
-	zbx_vector_vc_itemupdate_clear(&vc_itemupdates);
+	if (SUCCEED == ret)
+	{
+		zabbix_log(LOG_LEVEL_INFORMATION, "loaded value cache snapshot \"%s\" created at %s %s: restored "
+				ZBX_FS_UI64 " items with " ZBX_FS_UI64 " values, read " ZBX_FS_UI64 " newer values from"
+				" database, discarded " ZBX_FS_UI64 " items in " ZBX_FS_DBL " sec", path,
+				zbx_date2str((time_t)header.clock, NULL), zbx_time2str((time_t)header.clock, NULL),
+				stats.items, stats.values, stats.gap_values, stats.discarded, stats.time);
+	}
+out:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
+
+	return ret;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: add newly created items with triggers to value cachel              *
+ * Purpose: gets value cache snapshot loading statistics                      *
  *                                                                            *
  ******************************************************************************/
-void	zbx_vc_add_new_items(const zbx_vector_uint64_pair_t *items)
+void	zbx_vc_get_snapshot_stats(zbx_vc_snapshot_stats_t *stats)
 {
 	if (ZBX_VC_DISABLED == vc_state)
-		return;
-
-	WRLOCK_CACHE;
-
-	if (ZBX_VC_MODE_NORMAL == vc_cache->mode)
 	{
-		int	i;
-
-		for (i = 0; i < items->values_num; i++)
-		{
-			if (NULL != zbx_hashset_search(&vc_cache->items, &items->values[i]))
-				continue;
-
-			zbx_vc_item_t	item_local = {
-					.itemid = items->values[i].first,
-					.value_type = (unsigned char)items->values[i].second,
-					.status = ZBX_ITEM_STATUS_CACHED_ALL,
-					.last_accessed = (int)time(NULL)
-
-			};
-
-			if (NULL == zbx_hashset_insert(&vc_cache->items, &item_local, sizeof(item_local)))
-			{
-				/* out of memory - cache will switch to low memory mode on next caching request */
-				break;
-			}
-		}
+		memset(stats, 0, sizeof(zbx_vc_snapshot_stats_t));
+		return;
 	}
 
+	RDLOCK_CACHE;
+	*stats = vc_cache->snapshot_stats;
 	UNLOCK_CACHE;
 }
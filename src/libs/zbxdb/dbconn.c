@@ -25,12 +25,35 @@
 #	define ZBX_PG_READ_ONLY	"25006"
 #	define ZBX_PG_UNIQUE_VIOLATION	"23505"
 #	define ZBX_PG_DEADLOCK		"40P01"
+#	define ZBX_PG_INVALID_STMT	"26000"
+#endif
+
+#if defined(ZBX_DB_STMT)
+/* maximum number of prepared statements per connection */
+#define DBCONN_STMT_MAX	256
+
+typedef struct
+{
+	char		*sql;
+	int		binds_num;
+#if defined(HAVE_MYSQL)
+	MYSQL_STMT	*stmt;
+#elif defined(HAVE_POSTGRESQL)
+	char		name[32];
+#endif
+}
+zbx_db_stmt_t;
 #endif
 
 struct zbx_db_result
 {
 #if defined(HAVE_MYSQL)
 	MYSQL_RES	*result;
+	/* rows of prepared statement result, copied out of the statement when it is executed */
+	zbx_db_row_t	values;
+	int		row_num;
+	int		cursor;
+	int		fld_num;
 #elif defined(HAVE_POSTGRESQL)
 	PGresult	*pg_result;
 	int		row_num;
@@ -277,6 +300,332 @@ static void	db_get_postgresql_error(char **error, const PGresult *pg_result)
 		zbx_snprintf_alloc(error, &error_alloc, &error_offset, ":%s", result_error_msg);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: logs error of failed statement                                    *
+ *                                                                            *
+ * Parameters: db     - [IN]                                                  *
+ *             result - [IN] statement result, can be NULL                    *
+ *             sql    - [IN] failed statement                                 *
+ *                                                                            *
+ * Return value: ZBX_DB_DOWN (on recoverable error) or ZBX_DB_FAIL            *
+ *                                                                            *
+ ******************************************************************************/
+static int	dbconn_pg_result_error(zbx_dbconn_t *db, const PGresult *result, const char *sql)
+{
+	zbx_err_codes_t	errcode;
+	char		*error = NULL;
+
+	if (NULL == result)
+	{
+		dbconn_errlog(db, ERR_Z3005, 0, "result is NULL", sql);
+		return CONNECTION_OK == PQstatus(db->conn) ? ZBX_DB_FAIL : ZBX_DB_DOWN;
+	}
+
+	db_get_postgresql_error(&error, result);
+
+	if (0 == zbx_strcmp_null(PQresultErrorField(result, PG_DIAG_SQLSTATE), ZBX_PG_UNIQUE_VIOLATION))
+		errcode = ERR_Z3008;
+	else if (0 == zbx_strcmp_null(PQresultErrorField(result, PG_DIAG_SQLSTATE), ZBX_PG_READ_ONLY))
+		errcode = ERR_Z3009;
+	else
+		errcode = ERR_Z3005;
+
+	dbconn_errlog(db, errcode, 0, error, sql);
+	zbx_free(error);
+
+	return SUCCEED == dbconn_is_recoverable_error(db, result) ? ZBX_DB_DOWN : ZBX_DB_FAIL;
+}
+
+#if defined(ZBX_PG_PIPELINE)
+
+/* Number of queued statements after which their results are collected. Connection is blocking, so */
+/* results must be read before server output fills socket buffers while client is still sending.  */
+#define DBCONN_PIPELINE_MAX	1000
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: logs connection level error                                       *
+ *                                                                            *
+ * Parameters: db  - [IN]                                                     *
+ *             sql - [IN] failed statement, can be NULL                       *
+ *                                                                            *
+ * Return value: ZBX_DB_DOWN (on recoverable error) or ZBX_DB_FAIL            *
+ *                                                                            *
+ ******************************************************************************/
+static int	dbconn_pg_conn_error(zbx_dbconn_t *db, const char *sql)
+{
+	dbconn_errlog(db, NULL == sql ? ERR_Z3007 : ERR_Z3005, 0, PQerrorMessage(db->conn), sql);
+
+	return CONNECTION_OK == PQstatus(db->conn) ? ZBX_DB_FAIL : ZBX_DB_DOWN;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if character can be part of unquoted identifier            *
+ *                                                                            *
+ ******************************************************************************/
+static int	dbconn_is_ident_char(char c)
+{
+	return 0 != isalnum((unsigned char)c) || '_' == c || '$' == c;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets length of dollar quote tag ($$ or $tag$) at the SQL position *
+ *                                                                            *
+ * Return value: the tag length or 0 if there is no dollar quote tag          *
+ *                                                                            *
+ ******************************************************************************/
+static size_t	dbconn_dollar_tag_len(const char *sql)
+{
+	const char	*ptr = sql + 1;
+
+	/* tag follows identifier rules, but cannot contain '$' and start with digit */
+	if ('$' != *ptr && 0 == isalpha((unsigned char)*ptr) && '_' != *ptr)
+		return 0;
+
+	while (0 != isalnum((unsigned char)*ptr) || '_' == *ptr)
+		ptr++;
+
+	if ('$' != *ptr)
+		return 0;
+
+	return (size_t)(ptr - sql) + 1;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: finds end of the first statement in SQL text                      *
+ *                                                                            *
+ * Parameters: sql              - [IN]                                        *
+ *             escape_backslash - [IN] 1 - backslash escapes next character   *
+ *                                     in all string literals                 *
+ *                                     (standard_conforming_strings=off)      *
+ *                                                                            *
+ * Return value: pointer to the ';' terminating statement or to the           *
+ *               terminating zero                                             *
+ *                                                                            *
+ * Comments: Quoted literals and identifiers, escape string literals (E'')    *
+ *           and dollar quoted strings are skipped. Generated statements do   *
+ *           not contain comments, so they are not supported.                 *
+ *                                                                            *
+ ******************************************************************************/
+static const char	*dbconn_statement_end(const char *sql, int escape_backslash)
+{
+	const char	*start = sql, *tag = NULL;
+	char		quote = '\0';
+	int		escape = 0;
+	size_t		tag_len = 0;
+
+	for (; '\0' != *sql; sql++)
+	{
+		if (NULL != tag)
+		{
+			if ('$' == *sql && 0 == strncmp(sql, tag, tag_len))
+			{
+				sql += tag_len - 1;
+				tag = NULL;
+			}
+
+			continue;
+		}
+
+		if ('\0' != quote)
+		{
+			if (0 != escape && '\\' == *sql && '\0' != sql[1])
+				sql++;
+			else if (quote == *sql)	/* doubled quote character closes and reopens the literal */
+				quote = '\0';
+
+			continue;
+		}
+
+		switch (*sql)
+		{
+			case '\'':
+				escape = escape_backslash;
+
+				if (sql > start && ('E' == sql[-1] || 'e' == sql[-1]) &&
+						(sql - 1 == start || 0 == dbconn_is_ident_char(sql[-2])))
+				{
+					escape = 1;
+				}
+
+				quote = *sql;
+				break;
+			case '"':
+				escape = 0;
+				quote = *sql;
+				break;
+			case '$':
+				if ((sql == start || 0 == dbconn_is_ident_char(sql[-1])) &&
+						0 != (tag_len = dbconn_dollar_tag_len(sql)))
+				{
+					tag = sql;
+					sql += tag_len - 1;
+				}
+				break;
+			case ';':
+				return sql;
+		}
+	}
+
+	return sql;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: finds the next statement in SQL text with statements separated    *
+ *          by ';'                                                            *
+ *                                                                            *
+ * Parameters: sql              - [IN/OUT] the SQL text, on return points at  *
+ *                                         the start of the next statement    *
+ *             escape_backslash - [IN] see dbconn_statement_end()             *
+ *                                                                            *
+ * Return value: pointer to the end of the statement or NULL if there are no  *
+ *               more statements                                              *
+ *                                                                            *
+ ******************************************************************************/
+const char	*dbconn_statement_next(const char **sql, int escape_backslash)
+{
+	if ('\0' == *(*sql += strspn(*sql, " \t\r\n;")))
+		return NULL;
+
+	return dbconn_statement_end(*sql, escape_backslash);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: collects results of the statements queued in pipeline and leaves  *
+ *          pipeline mode                                                     *
+ *                                                                            *
+ * Return value: ZBX_DB_OK, ZBX_DB_FAIL (on error) or ZBX_DB_DOWN (on         *
+ *               recoverable error)                                           *
+ *                                                                            *
+ * Comments: Only the first failed statement is logged, server skips the      *
+ *           statements following it. Failure sets transaction as failed.     *
+ *                                                                            *
+ ******************************************************************************/
+static int	dbconn_pipeline_sync(zbx_dbconn_t *db)
+{
+	PGresult	*result;
+	int		ret = ZBX_DB_OK;
+
+	if (PQ_PIPELINE_OFF == PQpipelineStatus(db->conn))
+		return ZBX_DB_OK;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() statements:%d", __func__, db->pipeline_sql.values_num);
+
+	if (1 != PQpipelineSync(db->conn))
+	{
+		ret = dbconn_pg_conn_error(db, NULL);
+		goto out;
+	}
+
+	for (int i = 0; i < db->pipeline_sql.values_num; i++)
+	{
+		const char	*sql = db->pipeline_sql.values[i];
+
+		if (NULL == (result = PQgetResult(db->conn)))
+		{
+			ret = dbconn_pg_result_error(db, NULL, sql);
+			goto out;
+		}
+
+		if (ZBX_DB_OK == ret && PGRES_COMMAND_OK != PQresultStatus(result) &&
+				PGRES_PIPELINE_ABORTED != PQresultStatus(result))
+		{
+			ret = dbconn_pg_result_error(db, result, sql);
+		}
+
+		PQclear(result);
+
+		/* results of every statement are terminated by NULL */
+		while (NULL != (result = PQgetResult(db->conn)))
+			PQclear(result);
+	}
+
+	/* synchronization point */
+	if (NULL == (result = PQgetResult(db->conn)) || PGRES_PIPELINE_SYNC != PQresultStatus(result))
+	{
+		PQclear(result);
+		ret = dbconn_pg_conn_error(db, NULL);
+		goto out;
+	}
+
+	PQclear(result);
+
+	if (1 != PQexitPipelineMode(db->conn))
+	{
+		/* connection cannot be used for synchronous queries anymore, force its reset */
+		(void)dbconn_pg_conn_error(db, NULL);
+		ret = ZBX_DB_DOWN;
+	}
+out:
+	zbx_vector_str_clear_ext(&db->pipeline_sql, zbx_str_free);
+
+	if (ZBX_DB_OK != ret && 0 < db->txn_level)
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "pipeline failed, setting transaction as failed");
+		db->txn_error = ret;
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%d", __func__, ret);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: queues statements in pipeline without waiting for their results   *
+ *                                                                            *
+ * Parameters: db  - [IN]                                                     *
+ *             sql - [IN] one or more statements separated by ';'             *
+ *                                                                            *
+ * Return value: ZBX_DB_OK, ZBX_DB_FAIL (on error) or ZBX_DB_DOWN (on         *
+ *               recoverable error)                                           *
+ *                                                                            *
+ * Comments: Pipeline uses extended query protocol, which does not allow      *
+ *           multiple statements in one query, so they are queued one by one. *
+ *           Results are collected after every DBCONN_PIPELINE_MAX queued     *
+ *           statements, also in the middle of the SQL text.                  *
+ *                                                                            *
+ ******************************************************************************/
+static int	dbconn_pipeline_send(zbx_dbconn_t *db, const char *sql)
+{
+	const char	*end;
+	char		*statement;
+	int		ret;
+
+	while (NULL != (end = dbconn_statement_next(&sql, ZBX_PG_ESCAPE_BACKSLASH)))
+	{
+		if (PQ_PIPELINE_OFF == PQpipelineStatus(db->conn) && 1 != PQenterPipelineMode(db->conn))
+			return dbconn_pg_conn_error(db, sql);
+
+		statement = (char *)zbx_malloc(NULL, (size_t)(end - sql) + 1);
+		memcpy(statement, sql, (size_t)(end - sql));
+		statement[end - sql] = '\0';
+
+		if (1 != PQsendQueryParams(db->conn, statement, 0, NULL, NULL, NULL, NULL, 0))
+		{
+			ret = dbconn_pg_conn_error(db, statement);
+			zbx_free(statement);
+
+			return ret;
+		}
+
+		zbx_vector_str_append(&db->pipeline_sql, statement);
+		sql = end;
+
+		if (DBCONN_PIPELINE_MAX <= db->pipeline_sql.values_num && ZBX_DB_OK != (ret = dbconn_pipeline_sync(db)))
+			return ret;
+	}
+
+	return ZBX_DB_OK;
+}
+
+#endif
 #endif
 
 /******************************************************************************
@@ -286,6 +635,22 @@ static void	db_get_postgresql_error(char **error, const PGresult *pg_result)
  ******************************************************************************/
 static void	dbconn_close(zbx_dbconn_t *db)
 {
+#if defined(ZBX_DB_STMT)
+	if (0 != db->stmts.num_data)
+	{
+		zbx_db_stmt_stats_t	*stats = &db->stmt_stats;
+
+		/* each execution of already prepared statement saves the average preparation time */
+		zabbix_log(LOG_LEVEL_DEBUG, "prepared statements: " ZBX_FS_UI64 " prepared, " ZBX_FS_UI64 " executed,"
+				" preparation " ZBX_FS_DBL " sec, saved " ZBX_FS_DBL " sec", stats->prepared,
+				stats->executed, stats->prepare_time, stats->executed > stats->prepared ?
+				(double)(stats->executed - stats->prepared) * stats->prepare_time /
+				(double)stats->prepared : 0.0);
+
+		/* prepared statements are released together with connection */
+		zbx_hashset_clear(&db->stmts);
+	}
+#endif
 #if defined(HAVE_MYSQL)
 	if (NULL != db->conn)
 	{
@@ -298,6 +663,9 @@ static void	dbconn_close(zbx_dbconn_t *db)
 		PQfinish(db->conn);
 		db->conn = NULL;
 	}
+#	if defined(ZBX_PG_PIPELINE)
+	zbx_vector_str_clear_ext(&db->pipeline_sql, zbx_str_free);
+#	endif
 #elif defined(HAVE_SQLITE3)
 	if (NULL != db->conn)
 	{
@@ -331,6 +699,9 @@ static int	dbconn_open(zbx_dbconn_t *db)
 	const char	*keywords[ZBX_DB_MAX_PARAMS + 1];
 	const char	*values[ZBX_DB_MAX_PARAMS + 1];
 	unsigned int	i = 0;
+#	if defined(ZBX_PG_PIPELINE)
+	int		last_pipeline;
+#	endif
 #elif defined(HAVE_SQLITE3)
 	char		*p, *path = NULL;
 #endif
@@ -345,6 +716,12 @@ static int	dbconn_open(zbx_dbconn_t *db)
 	db->txn_error = ZBX_DB_OK;
 	db->txn_level = 0;
 
+#if defined(ZBX_PG_PIPELINE)
+	/* connection is initialized by synchronous queries */
+	last_pipeline = db->pipeline;
+	db->pipeline = 0;
+#endif
+
 #if defined(HAVE_MYSQL)
 	if (NULL == (db->conn = mysql_init(NULL)))
 	{
@@ -694,6 +1071,9 @@ out:
 
 	db->txn_error = last_txn_error;
 	db->txn_level = last_txn_level;
+#if defined(ZBX_PG_PIPELINE)
+	db->pipeline = last_pipeline;
+#endif
 
 	return ret;
 }
@@ -737,7 +1117,6 @@ static int	dbconn_vexecute(zbx_dbconn_t *db, const char *fmt, va_list args)
 	double		sec = 0;
 #if defined(HAVE_POSTGRESQL)
 	PGresult	*result;
-	char		*error = NULL;
 #elif defined(HAVE_SQLITE3)
 	int		err;
 	char		*error = NULL;
@@ -815,36 +1194,24 @@ static int	dbconn_vexecute(zbx_dbconn_t *db, const char *fmt, va_list args)
 		}
 	}
 #elif defined(HAVE_POSTGRESQL)
-	result = PQexec(db->conn, sql);
-
-	if (NULL == result)
+#	if defined(ZBX_PG_PIPELINE)
+	if (0 != db->pipeline)
 	{
-		dbconn_errlog(db, ERR_Z3005, 0, "result is NULL", sql);
-		ret = (CONNECTION_OK == PQstatus(db->conn) ? ZBX_DB_FAIL : ZBX_DB_DOWN);
+		ret = dbconn_pipeline_send(db, sql);
 	}
-	else if (PGRES_COMMAND_OK != PQresultStatus(result))
+	else
+#	endif
 	{
-		zbx_err_codes_t	errcode;
+		result = PQexec(db->conn, sql);
 
-		db_get_postgresql_error(&error, result);
-
-		if (0 == zbx_strcmp_null(PQresultErrorField(result, PG_DIAG_SQLSTATE), ZBX_PG_UNIQUE_VIOLATION))
-			errcode = ERR_Z3008;
-		else if (0 == zbx_strcmp_null(PQresultErrorField(result, PG_DIAG_SQLSTATE), ZBX_PG_READ_ONLY))
-			errcode = ERR_Z3009;
-		else
-			errcode = ERR_Z3005;
+		if (NULL == result || PGRES_COMMAND_OK != PQresultStatus(result))
+			ret = dbconn_pg_result_error(db, result, sql);
 
-		dbconn_errlog(db, errcode, 0, error, sql);
-		zbx_free(error);
+		if (ZBX_DB_OK == ret)
+			ret = atoi(PQcmdTuples(result));
 
-		ret = (SUCCEED == dbconn_is_recoverable_error(db, result) ? ZBX_DB_DOWN : ZBX_DB_FAIL);
+		PQclear(result);
 	}
-
-	if (ZBX_DB_OK == ret)
-		ret = atoi(PQcmdTuples(result));
-
-	PQclear(result);
 #elif defined(HAVE_SQLITE3)
 	if (0 == db->txn_level)
 		zbx_mutex_lock(*db->sqlite_access);
@@ -988,6 +1355,11 @@ static int	dbconn_commit(zbx_dbconn_t *db)
 
 	rc = dbconn_execute(db, "commit;");
 
+#if defined(ZBX_PG_PIPELINE)
+	/* commit is queued after the transaction statements, collect all results at once */
+	if (ZBX_DB_OK <= rc)
+		rc = dbconn_pipeline_sync(db);
+#endif
 #ifdef HAVE_SQLITE3
 	zbx_mutex_unlock(*db->sqlite_access);
 #endif
@@ -999,6 +1371,9 @@ static int	dbconn_commit(zbx_dbconn_t *db)
 
 	db->txn_level--;
 	db->txn_end_error = ZBX_DB_OK;
+#if defined(ZBX_PG_PIPELINE)
+	db->pipeline = 0;
+#endif
 
 	return rc;
 }
@@ -1022,6 +1397,11 @@ static int	dbconn_rollback(zbx_dbconn_t *db)
 		assert(0);
 	}
 
+#if defined(ZBX_PG_PIPELINE)
+	/* discard queued statements, their errors still fail the transaction */
+	(void)dbconn_pipeline_sync(db);
+	db->pipeline = 0;
+#endif
 	last_txn_error = db->txn_error;
 
 	/* allow rollback of failed transaction */
@@ -1069,6 +1449,10 @@ static zbx_db_result_t	dbconn_vselect(zbx_dbconn_t *db, const char *fmt, va_list
 
 	sql = zbx_dvsprintf(sql, fmt, args);
 
+#if defined(ZBX_PG_PIPELINE)
+	/* synchronous queries cannot be executed in pipeline mode */
+	(void)dbconn_pipeline_sync(db);
+#endif
 	if (ZBX_DB_OK != db->txn_error)
 	{
 		zabbix_log(LOG_LEVEL_DEBUG, "ignoring query [txnlev:%d] [%s] within failed transaction", db->txn_level,
@@ -1081,6 +1465,7 @@ static zbx_db_result_t	dbconn_vselect(zbx_dbconn_t *db, const char *fmt, va_list
 #if defined(HAVE_MYSQL)
 	result = (zbx_db_result_t)zbx_malloc(NULL, sizeof(struct zbx_db_result));
 	result->result = NULL;
+	result->values = NULL;
 
 	if (NULL == db->conn)
 	{
@@ -1212,71 +1597,569 @@ static zbx_db_result_t	dbconn_select_n(zbx_dbconn_t *db, const char *query, int
 	return dbconn_select(db, "%s limit %d", query, n);
 }
 
-/*
- * Public API
- */
-
 /******************************************************************************
  *                                                                            *
- * Purpose: set connection options                                            *
- *                                                                            *
- * Parameters: db      - [IN]                                                 *
- *             options - [IN] connection options:                             *
- *                               ZBX_DB_CONNECT_NORMAL (retry on failure)     *
- *                               ZBX_DB_CONNECT_EXIT (exit on failure)        *
- *                               ZBX_DB_CONNECT_ONCE (return on failure)      *
- *                                                                            *
+ * Purpose: find next parameter placeholder outside of quoted literals        *
  *                                                                            *
- * Return value: old connection options                                       *
+ * Return value: pointer to the '?' character or NULL if there are no more    *
+ *               placeholders                                                 *
  *                                                                            *
  ******************************************************************************/
-int	zbx_dbconn_set_connect_options(zbx_dbconn_t *db, int options)
+static const char	*dbconn_stmt_param(const char *sql)
 {
-	if (0 != db->managed)
+	char	quote = '\0';
+
+	for (; '\0' != *sql; sql++)
 	{
-		THIS_SHOULD_NEVER_HAPPEN_MSG("Cannot change connection options for managed connections");
-		return ZBX_DB_CONNECT_NORMAL;
-	}
+		if ('\0' != quote)
+		{
+			if (quote == *sql)
+				quote = '\0';
 
-	int	old_options = db->connect_options;
+			continue;
+		}
 
-	db->connect_options = options;
+		if ('\'' == *sql || '"' == *sql)
+			quote = *sql;
+		else if ('?' == *sql)
+			return sql;
+	}
 
-	return old_options;
+	return NULL;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: set autoincrement                                                 *
+ * Purpose: format bound parameter value as text                              *
  *                                                                            *
  ******************************************************************************/
-void	zbx_dbconn_set_autoincrement(zbx_dbconn_t *db, int options)
+static char	*dbconn_bind_value(const zbx_db_bind_t *bind)
 {
-	db->autoincrement = options;
+	switch (bind->type)
+	{
+		case ZBX_TYPE_ID:
+		case ZBX_TYPE_UINT:
+			return zbx_dsprintf(NULL, ZBX_FS_UI64, bind->value.ui64);
+		case ZBX_TYPE_INT:
+			return zbx_dsprintf(NULL, "%d", bind->value.i32);
+		case ZBX_TYPE_FLOAT:
+			return zbx_dsprintf(NULL, ZBX_FS_DBL64_SQL, bind->value.dbl);
+		default:
+			return zbx_strdup(NULL, bind->value.str);
+	}
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: create database connection object                                 *
+ * Purpose: substitute parameter values into statement text                   *
+ *                                                                            *
+ * Parameters: sql       - [IN] statement with '?' parameter placeholders     *
+ *             binds     - [IN] parameter values                              *
+ *             binds_num - [IN] number of parameter values                    *
+ *                                                                            *
+ * Return value: statement text, must be freed by caller                      *
+ *                                                                            *
+ * Comments: String values are escaped and quoted. Placeholders without       *
+ *           parameter values are left as is.                                 *
  *                                                                            *
  ******************************************************************************/
-zbx_dbconn_t	*zbx_dbconn_create(void)
+char	*dbconn_bind_sql(const char *sql, const zbx_db_bind_t *binds, int binds_num)
 {
-	zbx_dbconn_t	*db;
+	char		*query = NULL, *value;
+	size_t		query_alloc = 0, query_offset = 0;
+	const char	*ptr;
+	int		i;
 
-	db = (zbx_dbconn_t *)zbx_malloc(NULL, sizeof(zbx_dbconn_t));
-	memset(db, 0, sizeof(zbx_dbconn_t));
+	for (i = 0; i < binds_num && NULL != (ptr = dbconn_stmt_param(sql)); i++)
+	{
+		zbx_strncpy_alloc(&query, &query_alloc, &query_offset, sql, (size_t)(ptr - sql));
 
-	db->managed = DBCONN_TYPE_UNMANAGED;
-	db->config = db_config;
-	db->txn_error = ZBX_DB_OK;
-	db->txn_end_error = ZBX_DB_OK;
-	db->connect_options = ZBX_DB_CONNECT_NORMAL;
+		value = dbconn_bind_value(&binds[i]);
 
-#if defined(HAVE_SQLITE3)
-	db->sqlite_access = &db_sqlite_access;
-#endif
-	return db;
+		if (ZBX_TYPE_CHAR == binds[i].type)
+		{
+			char	*value_esc;
+
+			value_esc = zbx_db_dyn_escape_string(value);
+			zbx_snprintf_alloc(&query, &query_alloc, &query_offset, "'%s'", value_esc);
+			zbx_free(value_esc);
+		}
+		else
+			zbx_strcpy_alloc(&query, &query_alloc, &query_offset, value);
+
+		zbx_free(value);
+		sql = ptr + 1;
+	}
+
+	zbx_strcpy_alloc(&query, &query_alloc, &query_offset, sql);
+
+	return query;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: execute a select statement with parameter values substituted      *
+ *          into its text                                                     *
+ *                                                                            *
+ * Return value: data, NULL (on error) or (zbx_db_result_t)ZBX_DB_DOWN        *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_db_result_t	dbconn_select_bound(zbx_dbconn_t *db, const char *sql, const zbx_db_bind_t *binds,
+		int binds_num)
+{
+	char		*query;
+	zbx_db_result_t	result;
+
+	query = dbconn_bind_sql(sql, binds, binds_num);
+	result = dbconn_select(db, "%s", query);
+	zbx_free(query);
+
+	return result;
+}
+
+#if defined(ZBX_DB_STMT)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: release prepared statement                                        *
+ *                                                                            *
+ ******************************************************************************/
+static void	dbconn_stmt_clean(void *data)
+{
+	zbx_db_stmt_t	*stmt = (zbx_db_stmt_t *)data;
+
+#if defined(HAVE_MYSQL)
+	mysql_stmt_close(stmt->stmt);
+#endif
+	zbx_free(stmt->sql);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: prepare statement on server and register it in connection         *
+ *                                                                            *
+ * Parameters: db  - [IN]                                                     *
+ *             sql - [IN] statement with '?' parameter placeholders           *
+ *             rc  - [OUT] ZBX_DB_FAIL or ZBX_DB_DOWN on failure              *
+ *                                                                            *
+ * Return value: prepared statement or NULL on failure                        *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_db_stmt_t	*dbconn_stmt_prepare(zbx_dbconn_t *db, const char *sql, int *rc)
+{
+	zbx_db_stmt_t	stmt_local;
+	const char	*ptr;
+	double		sec;
+#if defined(HAVE_MYSQL)
+	int		err_no;
+#elif defined(HAVE_POSTGRESQL)
+	const char	*src;
+	char		*text = NULL;
+	size_t		text_alloc = 0, text_offset = 0;
+	PGresult	*pg_result;
+#endif
+
+	sec = zbx_time();
+	stmt_local.binds_num = 0;
+
+#if defined(HAVE_MYSQL)
+	for (ptr = sql; NULL != (ptr = dbconn_stmt_param(ptr)); ptr++)
+		stmt_local.binds_num++;
+
+	if (NULL == (stmt_local.stmt = mysql_stmt_init(db->conn)))
+	{
+		err_no = (int)mysql_errno(db->conn);
+		dbconn_errlog(db, ERR_Z3005, err_no, mysql_error(db->conn), sql);
+		*rc = SUCCEED == dbconn_is_recoverable_error(db, err_no) ? ZBX_DB_DOWN : ZBX_DB_FAIL;
+
+		return NULL;
+	}
+
+	if (0 != mysql_stmt_prepare(stmt_local.stmt, sql, (unsigned long)strlen(sql)))
+	{
+		err_no = (int)mysql_stmt_errno(stmt_local.stmt);
+		dbconn_errlog(db, ERR_Z3005, err_no, mysql_stmt_error(stmt_local.stmt), sql);
+		*rc = SUCCEED == dbconn_is_recoverable_error(db, err_no) ? ZBX_DB_DOWN : ZBX_DB_FAIL;
+		mysql_stmt_close(stmt_local.stmt);
+
+		return NULL;
+	}
+#elif defined(HAVE_POSTGRESQL)
+	/* PostgreSQL uses numbered $1, $2, ... parameter placeholders */
+	for (src = sql; NULL != (ptr = dbconn_stmt_param(src)); src = ptr + 1)
+	{
+		zbx_strncpy_alloc(&text, &text_alloc, &text_offset, src, (size_t)(ptr - src));
+		zbx_snprintf_alloc(&text, &text_alloc, &text_offset, "$%d", ++stmt_local.binds_num);
+	}
+
+	zbx_strcpy_alloc(&text, &text_alloc, &text_offset, src);
+	zbx_snprintf(stmt_local.name, sizeof(stmt_local.name), "zbx_stmt_%d", db->stmt_next++);
+
+	pg_result = PQprepare(db->conn, stmt_local.name, text, stmt_local.binds_num, NULL);
+
+	if (PGRES_COMMAND_OK != PQresultStatus(pg_result))
+	{
+		*rc = dbconn_pg_result_error(db, pg_result, text);
+		PQclear(pg_result);
+		zbx_free(text);
+
+		return NULL;
+	}
+
+	PQclear(pg_result);
+	zbx_free(text);
+#endif
+	stmt_local.sql = zbx_strdup(NULL, sql);
+
+	db->stmt_stats.prepared++;
+	db->stmt_stats.prepare_time += zbx_time() - sec;
+
+	return (zbx_db_stmt_t *)zbx_hashset_insert(&db->stmts, &stmt_local, sizeof(stmt_local));
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: execute prepared statement                                        *
+ *                                                                            *
+ * Return value: data, NULL (on error) or (zbx_db_result_t)ZBX_DB_DOWN        *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_db_result_t	dbconn_stmt_execute(zbx_dbconn_t *db, zbx_db_stmt_t *stmt, const zbx_db_bind_t *binds)
+{
+	zbx_db_result_t	result;
+	int		i;
+#if defined(HAVE_MYSQL)
+	MYSQL_BIND	*params = NULL, *columns = NULL;
+	int		ret, row, err_no, fld_num = 0;
+	unsigned long	len;
+	char		**value;
+#elif defined(HAVE_POSTGRESQL)
+	char		**values = NULL;
+	int		rc;
+#endif
+
+	db->stmt_stats.executed++;
+
+#if defined(HAVE_MYSQL)
+	if (0 != stmt->binds_num)
+	{
+		params = (MYSQL_BIND *)zbx_calloc(NULL, (size_t)stmt->binds_num, sizeof(MYSQL_BIND));
+
+		for (i = 0; i < stmt->binds_num; i++)
+		{
+			/* numeric members of the value union share its address */
+			params[i].buffer = (void *)&binds[i].value;
+
+			switch (binds[i].type)
+			{
+				case ZBX_TYPE_ID:
+				case ZBX_TYPE_UINT:
+					params[i].buffer_type = MYSQL_TYPE_LONGLONG;
+					params[i].is_unsigned = 1;
+					break;
+				case ZBX_TYPE_INT:
+					params[i].buffer_type = MYSQL_TYPE_LONG;
+					break;
+				case ZBX_TYPE_FLOAT:
+					params[i].buffer_type = MYSQL_TYPE_DOUBLE;
+					break;
+				default:
+					params[i].buffer_type = MYSQL_TYPE_STRING;
+					params[i].buffer = binds[i].value.str;
+					params[i].buffer_length = (unsigned long)strlen(binds[i].value.str);
+			}
+		}
+	}
+
+	result = (zbx_db_result_t)zbx_malloc(NULL, sizeof(struct zbx_db_result));
+	result->result = NULL;
+	result->values = NULL;
+	result->cursor = 0;
+	result->row_num = 0;
+	result->fld_num = 0;
+
+	if ((NULL != params && 0 != mysql_stmt_bind_param(stmt->stmt, params)) ||
+			0 != mysql_stmt_execute(stmt->stmt) || 0 != mysql_stmt_store_result(stmt->stmt))
+	{
+		goto error;
+	}
+
+	result->fld_num = fld_num = (int)mysql_stmt_field_count(stmt->stmt);
+	result->row_num = (int)mysql_stmt_num_rows(stmt->stmt);
+
+	if (0 == result->fld_num || 0 == result->row_num)
+		goto out;
+
+	/* copy rows out of the statement, so it can be executed again while the result is being processed */
+	result->values = (zbx_db_row_t)zbx_calloc(NULL, (size_t)result->row_num * (size_t)result->fld_num,
+			sizeof(char *));
+	columns = (MYSQL_BIND *)zbx_calloc(NULL, (size_t)fld_num, sizeof(MYSQL_BIND));
+
+	for (i = 0; i < fld_num; i++)
+	{
+		columns[i].buffer_type = MYSQL_TYPE_STRING;
+		columns[i].buffer_length = ZBX_KIBIBYTE;
+		columns[i].buffer = zbx_malloc(NULL, columns[i].buffer_length);
+		columns[i].length = &columns[i].length_value;
+		columns[i].is_null = &columns[i].is_null_value;
+	}
+
+	if (0 != mysql_stmt_bind_result(stmt->stmt, columns))
+		goto error;
+
+	for (row = 0; row < result->row_num && MYSQL_NO_DATA != (ret = mysql_stmt_fetch(stmt->stmt)); row++)
+	{
+		if (1 == ret)
+			goto error;
+
+		for (i = 0; i < result->fld_num; i++)
+		{
+			if (0 != columns[i].is_null_value)
+				continue;
+
+			value = &result->values[row * result->fld_num + i];
+			len = columns[i].length_value;
+			*value = (char *)zbx_malloc(NULL, len + 1);
+
+			if (len <= columns[i].buffer_length)
+			{
+				memcpy(*value, columns[i].buffer, len);
+			}
+			else
+			{
+				MYSQL_BIND	column = columns[i];
+
+				/* value was truncated by fetch, read it whole */
+				column.buffer = *value;
+				column.buffer_length = len;
+
+				if (0 != mysql_stmt_fetch_column(stmt->stmt, &column, (unsigned int)i, 0))
+					goto error;
+			}
+
+			(*value)[len] = '\0';
+		}
+	}
+
+	goto out;
+error:
+	err_no = (int)mysql_stmt_errno(stmt->stmt);
+	db->error_count++;
+
+	if (FAIL == dbconn_is_inhibited_error(db, err_no))
+		dbconn_errlog(db, ERR_Z3005, err_no, mysql_stmt_error(stmt->stmt), stmt->sql);
+
+	zbx_db_free_result(result);
+	result = (SUCCEED == dbconn_is_recoverable_error(db, err_no) ? (zbx_db_result_t)ZBX_DB_DOWN : NULL);
+out:
+	if (NULL != columns)
+	{
+		for (i = 0; i < fld_num; i++)
+			zbx_free(columns[i].buffer);
+
+		zbx_free(columns);
+	}
+
+	mysql_stmt_free_result(stmt->stmt);
+	zbx_free(params);
+#elif defined(HAVE_POSTGRESQL)
+	if (0 != stmt->binds_num)
+	{
+		values = (char **)zbx_malloc(NULL, sizeof(char *) * (size_t)stmt->binds_num);
+
+		for (i = 0; i < stmt->binds_num; i++)
+			values[i] = dbconn_bind_value(&binds[i]);
+	}
+
+	result = (zbx_db_result_t)zbx_malloc(NULL, sizeof(struct zbx_db_result));
+	result->pg_result = PQexecPrepared(db->conn, stmt->name, stmt->binds_num, (const char * const *)values, NULL,
+			NULL, 0);
+	result->values = NULL;
+	result->cursor = 0;
+	result->row_num = 0;
+
+	for (i = 0; i < stmt->binds_num; i++)
+		zbx_free(values[i]);
+
+	zbx_free(values);
+
+	if (PGRES_TUPLES_OK != PQresultStatus(result->pg_result))
+	{
+		int	invalid_stmt;
+
+		/* statement can be deallocated behind our back, for example by connection pooler */
+		invalid_stmt = (0 == zbx_strcmp_null(PQresultErrorField(result->pg_result, PG_DIAG_SQLSTATE),
+				ZBX_PG_INVALID_STMT));
+
+		rc = dbconn_pg_result_error(db, result->pg_result, stmt->sql);
+		zbx_db_free_result(result);
+		result = (ZBX_DB_DOWN == rc ? (zbx_db_result_t)ZBX_DB_DOWN : NULL);
+
+		/* forget the statement, so it is prepared again on next use */
+		if (0 != invalid_stmt)
+			zbx_hashset_remove_direct(&db->stmts, stmt);
+	}
+	else
+		result->row_num = PQntuples(result->pg_result);
+#endif
+	return result;
+}
+#endif
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: execute a select statement prepared by server                     *
+ *                                                                            *
+ * Parameters: db        - [IN]                                               *
+ *             sql       - [IN] statement with '?' parameter placeholders     *
+ *             binds     - [IN] parameter values                              *
+ *             binds_num - [IN] number of parameter values                    *
+ *                                                                            *
+ * Return value: data, NULL (on error) or (zbx_db_result_t)ZBX_DB_DOWN        *
+ *                                                                            *
+ * Comments: Statement is prepared on its first execution and kept in         *
+ *           connection until it is closed. Statements exceeding registry     *
+ *           limit, statements on databases without prepared statement        *
+ *           support and all statements when DBPreparedStatements option is   *
+ *           disabled are executed with parameter values substituted.         *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_db_result_t	dbconn_select_prepared(zbx_dbconn_t *db, const char *sql, const zbx_db_bind_t *binds,
+		int binds_num)
+{
+#if defined(ZBX_DB_STMT)
+	zbx_db_stmt_t	*stmt;
+	zbx_db_result_t	result;
+	double		sec = 0;
+	int		rc = ZBX_DB_FAIL;
+
+	if (0 == db->config->prepared_statements)
+		return dbconn_select_bound(db, sql, binds, binds_num);
+
+	if (NULL == (stmt = (zbx_db_stmt_t *)zbx_hashset_search(&db->stmts, &sql)) &&
+			(NULL == db->conn || DBCONN_STMT_MAX <= db->stmts.num_data))
+	{
+		return dbconn_select_bound(db, sql, binds, binds_num);
+	}
+
+	if (0 != db->config->log_slow_queries)
+		sec = zbx_time();
+
+#if defined(ZBX_PG_PIPELINE)
+	/* synchronous queries cannot be executed in pipeline mode */
+	(void)dbconn_pipeline_sync(db);
+#endif
+	if (ZBX_DB_OK != db->txn_error)
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "ignoring query [txnlev:%d] [%s] within failed transaction", db->txn_level,
+				sql);
+		return NULL;
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "prepared query [txnlev:%d] [%s]", db->txn_level, sql);
+
+	if (NULL == stmt && NULL == (stmt = dbconn_stmt_prepare(db, sql, &rc)))
+	{
+		result = (ZBX_DB_DOWN == rc ? (zbx_db_result_t)ZBX_DB_DOWN : NULL);
+	}
+	else if (stmt->binds_num != binds_num)
+	{
+		THIS_SHOULD_NEVER_HAPPEN;
+		result = NULL;
+	}
+	else
+		result = dbconn_stmt_execute(db, stmt, binds);
+
+	if (0 != db->config->log_slow_queries)
+	{
+		sec = zbx_time() - sec;
+		if (sec > (double)db->config->log_slow_queries / 1000.0)
+			zabbix_log(LOG_LEVEL_WARNING, "slow query: " ZBX_FS_DBL " sec, \"%s\"", sec, sql);
+	}
+
+	if (NULL == result && 0 < db->txn_level)
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "query [%s] failed, setting transaction as failed", sql);
+		db->txn_error = ZBX_DB_FAIL;
+	}
+
+	return result;
+#else
+	return dbconn_select_bound(db, sql, binds, binds_num);
+#endif
+}
+
+/*
+ * Public API
+ */
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: set connection options                                            *
+ *                                                                            *
+ * Parameters: db      - [IN]                                                 *
+ *             options - [IN] connection options:                             *
+ *                               ZBX_DB_CONNECT_NORMAL (retry on failure)     *
+ *                               ZBX_DB_CONNECT_EXIT (exit on failure)        *
+ *                               ZBX_DB_CONNECT_ONCE (return on failure)      *
+ *                                                                            *
+ *                                                                            *
+ * Return value: old connection options                                       *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_dbconn_set_connect_options(zbx_dbconn_t *db, int options)
+{
+	if (0 != db->managed)
+	{
+		THIS_SHOULD_NEVER_HAPPEN_MSG("Cannot change connection options for managed connections");
+		return ZBX_DB_CONNECT_NORMAL;
+	}
+
+	int	old_options = db->connect_options;
+
+	db->connect_options = options;
+
+	return old_options;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: set autoincrement                                                 *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_dbconn_set_autoincrement(zbx_dbconn_t *db, int options)
+{
+	db->autoincrement = options;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: create database connection object                                 *
+ *                                                                            *
+ ******************************************************************************/
+zbx_dbconn_t	*zbx_dbconn_create(void)
+{
+	zbx_dbconn_t	*db;
+
+	db = (zbx_dbconn_t *)zbx_malloc(NULL, sizeof(zbx_dbconn_t));
+	memset(db, 0, sizeof(zbx_dbconn_t));
+
+	db->managed = DBCONN_TYPE_UNMANAGED;
+	db->config = db_config;
+	db->txn_error = ZBX_DB_OK;
+	db->txn_end_error = ZBX_DB_OK;
+	db->connect_options = ZBX_DB_CONNECT_NORMAL;
+
+#if defined(HAVE_SQLITE3)
+	db->sqlite_access = &db_sqlite_access;
+#elif defined(ZBX_PG_PIPELINE)
+	zbx_vector_str_create(&db->pipeline_sql);
+#endif
+#if defined(ZBX_DB_STMT)
+	zbx_hashset_create_ext(&db->stmts, 0, ZBX_DEFAULT_STRING_PTR_HASH_FUNC, ZBX_DEFAULT_STR_COMPARE_FUNC,
+			dbconn_stmt_clean, ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC,
+			ZBX_DEFAULT_MEM_FREE_FUNC);
+#endif
+	return db;
 }
 
 /******************************************************************************
@@ -1288,7 +2171,12 @@ void	zbx_dbconn_free(zbx_dbconn_t *db)
 {
 	dbconn_close(db);
 	zbx_free(db->last_db_strerror);
-
+#if defined(ZBX_PG_PIPELINE)
+	zbx_vector_str_destroy(&db->pipeline_sql);
+#endif
+#if defined(ZBX_DB_STMT)
+	zbx_hashset_destroy(&db->stmts);
+#endif
 	zbx_free(db);
 }
 
@@ -1391,6 +2279,34 @@ int	zbx_dbconn_begin(zbx_dbconn_t *db)
 	return rc;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: start transaction with statements executed in pipeline            *
+ *                                                                            *
+ * Comments: With PostgreSQL pipeline mode enabled (DBPipelining) the         *
+ *           non-select statements are queued without waiting for their       *
+ *           results, which are collected at commit, before select or copy.   *
+ *           The queued statements return ZBX_DB_OK instead of number of      *
+ *           affected rows and their errors fail the transaction.             *
+ *           Without pipeline mode it's the same as zbx_dbconn_begin().       *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_dbconn_begin_pipeline(zbx_dbconn_t *db)
+{
+#if defined(ZBX_PG_PIPELINE)
+	int	rc;
+
+	db->pipeline = db->config->pipelining;
+
+	if (ZBX_DB_DOWN == (rc = zbx_dbconn_begin(db)))
+		db->pipeline = 0;
+
+	return rc;
+#else
+	return zbx_dbconn_begin(db);
+#endif
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: commit transaction                                                *
@@ -1444,6 +2360,135 @@ int	zbx_dbconn_rollback(zbx_dbconn_t *db)
 	return rc;
 }
 
+#if defined(HAVE_POSTGRESQL)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: executes COPY FROM STDIN statement with the specified data        *
+ *                                                                            *
+ * Return value: ZBX_DB_FAIL (on error) or ZBX_DB_DOWN (on recoverable error) *
+ *               or number of rows copied (on success)                        *
+ *                                                                            *
+ ******************************************************************************/
+static int	dbconn_copy_from(zbx_dbconn_t *db, const char *sql, const char *data, size_t size)
+{
+#define DBCONN_COPY_CHUNK_SIZE	(ZBX_KIBIBYTE * 256)
+	PGresult	*result;
+	int		ret = ZBX_DB_OK;
+	double		sec = 0;
+	size_t		offset, chunk;
+
+	if (0 != db->config->log_slow_queries)
+		sec = zbx_time();
+
+	if (0 == db->txn_level)
+		zabbix_log(LOG_LEVEL_DEBUG, "query without transaction detected");
+
+#if defined(ZBX_PG_PIPELINE)
+	/* copy cannot be executed in pipeline mode */
+	(void)dbconn_pipeline_sync(db);
+#endif
+	if (ZBX_DB_OK != db->txn_error)
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "ignoring query [txnlev:%d] [%s] within failed transaction", db->txn_level,
+				sql);
+		return ZBX_DB_FAIL;
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "query [txnlev:%d] [%s] [" ZBX_FS_SIZE_T " bytes]", db->txn_level, sql,
+			(zbx_fs_size_t)size);
+
+	result = PQexec(db->conn, sql);
+
+	if (NULL == result || PGRES_COPY_IN != PQresultStatus(result))
+	{
+		ret = dbconn_pg_result_error(db, result, sql);
+		PQclear(result);
+		goto out;
+	}
+
+	PQclear(result);
+
+	/* on failure the data is discarded, error is reported by the copy result */
+	for (offset = 0; offset < size; offset += chunk)
+	{
+		chunk = MIN(size - offset, DBCONN_COPY_CHUNK_SIZE);
+
+		if (1 != PQputCopyData(db->conn, data + offset, (int)chunk))
+			break;
+	}
+
+	PQputCopyEnd(db->conn, offset < size ? "cannot send data" : NULL);
+
+	result = PQgetResult(db->conn);
+
+	if (NULL == result || PGRES_COMMAND_OK != PQresultStatus(result))
+		ret = dbconn_pg_result_error(db, result, sql);
+	else
+		ret = atoi(PQcmdTuples(result));
+
+	PQclear(result);
+
+	while (NULL != (result = PQgetResult(db->conn)))
+		PQclear(result);
+
+	if (0 != db->config->log_slow_queries)
+	{
+		sec = zbx_time() - sec;
+		if (sec > (double)db->config->log_slow_queries / 1000.0)
+			zabbix_log(LOG_LEVEL_WARNING, "slow query: " ZBX_FS_DBL " sec, \"%s\"", sec, sql);
+	}
+out:
+	if (ZBX_DB_FAIL == ret && 0 < db->txn_level)
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "query [%s] failed, setting transaction as failed", sql);
+		db->txn_error = ZBX_DB_FAIL;
+	}
+
+	return ret;
+#undef DBCONN_COPY_CHUNK_SIZE
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: copies data in COPY format into table                             *
+ *                                                                            *
+ * Parameters: db   - [IN]                                                    *
+ *             sql  - [IN] COPY FROM STDIN statement                          *
+ *             data - [IN] the data to copy                                   *
+ *             size - [IN] the data size                                      *
+ *                                                                            *
+ * Return value: ZBX_DB_FAIL (on error) or ZBX_DB_DOWN (on recoverable error) *
+ *               or number of rows copied (on success)                        *
+ *                                                                            *
+ * Comments: retry until DB is up                                             *
+ *                                                                            *
+ ******************************************************************************/
+int	dbconn_copy(zbx_dbconn_t *db, const char *sql, const char *data, size_t size)
+{
+	int	rc;
+
+	rc = dbconn_copy_from(db, sql, data, size);
+
+	if (ZBX_DB_CONNECT_NORMAL != db->connect_options)
+		return rc;
+
+	while (ZBX_DB_DOWN == rc)
+	{
+		zbx_dbconn_close(db);
+		zbx_dbconn_open(db);
+
+		if (ZBX_DB_DOWN == (rc = dbconn_copy_from(db, sql, data, size)))
+		{
+			zabbix_log(LOG_LEVEL_ERR, "database is down: retrying in %d seconds", ZBX_DB_WAIT_DOWN);
+			db->connection_failure = 1;
+			sleep(ZBX_DB_WAIT_DOWN);
+		}
+	}
+
+	return rc;
+}
+#endif
+
 /******************************************************************************
  *                                                                            *
  * Purpose: commit or rollback a transaction depending on a parameter value   *
@@ -1597,6 +2642,81 @@ zbx_db_result_t	zbx_dbconn_select_n(zbx_dbconn_t *db, const char *query, int n)
 	return rc;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: bind identifier or unsigned integer parameter value               *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_db_bind_uint64(zbx_db_bind_t *bind, zbx_uint64_t value)
+{
+	bind->type = ZBX_TYPE_ID;
+	bind->value.ui64 = value;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: bind integer parameter value                                      *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_db_bind_int(zbx_db_bind_t *bind, int value)
+{
+	bind->type = ZBX_TYPE_INT;
+	bind->value.i32 = value;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: bind string parameter value                                       *
+ *                                                                            *
+ * Comments: the value is not copied and must stay valid until the statement  *
+ *           is executed                                                      *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_db_bind_str(zbx_db_bind_t *bind, const char *value)
+{
+	bind->type = ZBX_TYPE_CHAR;
+	bind->value.str = (char *)value;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: execute a select statement prepared by server                     *
+ *                                                                            *
+ * Parameters: db        - [IN]                                               *
+ *             sql       - [IN] statement with '?' parameter placeholders,    *
+ *                              must not contain values of varying text       *
+ *             binds     - [IN] parameter values                              *
+ *             binds_num - [IN] number of parameter values                    *
+ *                                                                            *
+ * Comments: retry until DB is up                                             *
+ *                                                                            *
+ ******************************************************************************/
+zbx_db_result_t	zbx_dbconn_select_prepared(zbx_dbconn_t *db, const char *sql, const zbx_db_bind_t *binds,
+		int binds_num)
+{
+	zbx_db_result_t	rc;
+
+	rc = dbconn_select_prepared(db, sql, binds, binds_num);
+
+	if (ZBX_DB_CONNECT_NORMAL != db->connect_options)
+		return rc;
+
+	while ((zbx_db_result_t)ZBX_DB_DOWN == rc)
+	{
+		zbx_dbconn_close(db);
+		zbx_dbconn_open(db);
+
+		if ((zbx_db_result_t)ZBX_DB_DOWN == (rc = dbconn_select_prepared(db, sql, binds, binds_num)))
+		{
+			zabbix_log(LOG_LEVEL_ERR, "database is down: retrying in %d seconds", ZBX_DB_WAIT_DOWN);
+			db->connection_failure = 1;
+			sleep(ZBX_DB_WAIT_DOWN);
+		}
+	}
+
+	return rc;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: fetch database row from result returned from select               *
@@ -1609,7 +2729,13 @@ zbx_db_row_t	__zbx_attr_weak zbx_db_fetch(zbx_db_result_t result)
 
 #if defined(HAVE_MYSQL)
 	if (NULL == result->result)
-		return NULL;
+	{
+		/* prepared statement result */
+		if (result->cursor == result->row_num)
+			return NULL;
+
+		return &result->values[result->fld_num * result->cursor++];
+	}
 
 	return (zbx_db_row_t)mysql_fetch_row(result->result);
 #elif defined(HAVE_POSTGRESQL)
@@ -1665,6 +2791,16 @@ void	__zbx_attr_weak zbx_db_free_result(zbx_db_result_t result)
 	if (NULL == result)
 		return;
 
+	if (NULL != result->values)
+	{
+		int	i;
+
+		for (i = 0; i < result->row_num * result->fld_num; i++)
+			zbx_free(result->values[i]);
+
+		zbx_free(result->values);
+	}
+
 	mysql_free_result(result->result);
 	zbx_free(result);
 #elif defined(HAVE_POSTGRESQL)
@@ -1737,6 +2873,9 @@ int	zbx_db_get_row_num(zbx_db_result_t result)
 #if defined(HAVE_POSTGRESQL)
 	return result->row_num;
 #elif defined(HAVE_MYSQL)
+	if (NULL == result->result)
+		return result->row_num;
+
 	return (int)mysql_num_rows(result->result);
 #else
 	ZBX_UNUSED(result);
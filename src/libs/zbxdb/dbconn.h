@@ -16,6 +16,7 @@
 #define ZABBIX_DBCONN_H
 
 #include "zbxcommon.h"
+#include "zbxalgo.h"
 #include "zbxdb.h"
 #include "zbxdbschema.h"
 #include "zbxtypes.h"
@@ -30,11 +31,27 @@
 #	include "oci.h"
 #elif defined(HAVE_POSTGRESQL)
 #	include <libpq-fe.h>
+#	if defined(LIBPQ_HAS_PIPELINING)
+#		define ZBX_PG_PIPELINE
+#	endif
 #elif defined(HAVE_SQLITE3)
 #	include <sqlite3.h>
 #	include <zbxmutexs.h>
 #endif
 
+#if defined(HAVE_MYSQL) || defined(HAVE_POSTGRESQL)
+#	define ZBX_DB_STMT	/* server side prepared statements */
+
+/* prepared statement statistics, logged when connection is closed */
+typedef struct
+{
+	zbx_uint64_t	prepared;	/* statements prepared by server */
+	zbx_uint64_t	executed;	/* executions of prepared statements */
+	double		prepare_time;	/* time spent preparing statements */
+}
+zbx_db_stmt_stats_t;
+#endif
+
 typedef enum
 {
 	DBCONN_TYPE_UNMANAGED,
@@ -60,12 +77,22 @@ struct zbx_dbconn
 
 	const zbx_db_config_t	*config;
 
+#if defined(ZBX_DB_STMT)
+	zbx_hashset_t		stmts;		/* prepared statements by their SQL text */
+	int			stmt_next;	/* sequence number of the next prepared statement */
+	zbx_db_stmt_stats_t	stmt_stats;
+#endif
+
 #if defined(HAVE_MYSQL)
 	MYSQL			*conn;
 	int			error_count;
 	int			txn_begin;		/* transaction begin statement is executed */
 #elif defined(HAVE_POSTGRESQL)
 	PGconn			*conn;
+#	if defined(ZBX_PG_PIPELINE)
+	int			pipeline;	/* queue statements of the current transaction in pipeline */
+	zbx_vector_str_t	pipeline_sql;	/* queued statements waiting for results */
+#	endif
 #elif defined(HAVE_SQLITE3)
 	sqlite3			*conn;
 	zbx_mutex_t		*sqlite_access;
@@ -77,11 +104,21 @@ void	dbconn_deinit(void);
 
 void	dbconn_set_managed(zbx_dbconn_t *db);
 
+char	*dbconn_bind_sql(const char *sql, const zbx_db_bind_t *binds, int binds_num);
+
+#if defined(ZBX_PG_PIPELINE)
+const char	*dbconn_statement_next(const char **sql, int escape_backslash);
+#endif
+
 char	*db_dyn_escape_string(const char *src, size_t max_bytes, size_t max_chars, zbx_escape_sequence_t flag);
 char	*db_dyn_escape_field_len(const zbx_db_field_t *field, const char *src, zbx_escape_sequence_t flag);
 int	db_is_escape_sequence(char c);
 
 zbx_uint32_t	db_get_server_version(void);
 
+#if defined(HAVE_POSTGRESQL)
+int	dbconn_copy(zbx_dbconn_t *db, const char *sql, const char *data, size_t size);
+#endif
+
 #endif
 
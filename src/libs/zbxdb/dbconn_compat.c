@@ -95,6 +95,22 @@ void	zbx_db_begin(void)
 	return;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: start a transaction with statements executed in pipeline          *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_db_begin_pipeline(void)
+{
+	if (NULL == dbconn)
+	{
+		THIS_SHOULD_NEVER_HAPPEN;
+		return;
+	}
+
+	(void)zbx_dbconn_begin_pipeline(dbconn);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: commit a transaction                                              *
@@ -262,6 +278,24 @@ zbx_db_result_t	zbx_db_select_n(const char *query, int n)
 	return zbx_dbconn_select_n(dbconn, query, n);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: execute a select statement prepared by server                     *
+ *                                                                            *
+ * Comments: retry until DB is up                                             *
+ *                                                                            *
+ ******************************************************************************/
+zbx_db_result_t	zbx_db_select_prepared(const char *sql, const zbx_db_bind_t *binds, int binds_num)
+{
+	if (NULL == dbconn)
+	{
+		THIS_SHOULD_NEVER_HAPPEN;
+		return NULL;
+	}
+
+	return zbx_dbconn_select_prepared(dbconn, sql, binds, binds_num);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: get next id for requested table                                   *
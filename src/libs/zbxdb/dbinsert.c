@@ -21,6 +21,17 @@
 #include "zbxstr.h"
 #include "zbxtypes.h"
 
+#if defined(HAVE_POSTGRESQL)
+/* string values are kept unescaped to be copied as is and escaped only when inserted with SQL statements */
+#	define DB_INSERT_ESCAPE_SEQUENCE	ESCAPE_SEQUENCE_OFF
+/* fewer rows are inserted with SQL statement to avoid additional round trips of COPY protocol */
+#	define DB_INSERT_COPY_ROWS_MIN		8
+/* maximum size of data sent with single COPY statement */
+#	define DB_INSERT_COPY_SIZE_MAX		(4 * ZBX_MEBIBYTE)
+#else
+#	define DB_INSERT_ESCAPE_SEQUENCE	ESCAPE_SEQUENCE_ON
+#endif
+
 /******************************************************************************
  *                                                                            *
  * Purpose: releases resources allocated by bulk insert operations            *
@@ -71,6 +82,43 @@ void	zbx_db_insert_clean(zbx_db_insert_t *db_insert)
 	zbx_vector_const_db_field_ptr_destroy(&db_insert->fields);
 }
 
+#if defined(HAVE_POSTGRESQL)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if rows can be inserted with binary COPY                   *
+ *                                                                            *
+ * Comments: Tables with serial fields or changelog insert triggers and       *
+ *           fields converted to upper case are inserted with SQL statements. *
+ *                                                                            *
+ ******************************************************************************/
+static int	db_insert_copy_supported(const zbx_db_table_t *table, const zbx_db_field_t * const *fields,
+		int fields_num)
+{
+	const zbx_db_table_changelog_t	*changelog;
+	const zbx_db_field_t		*field;
+
+	for (changelog = zbx_dbschema_get_changelog_tables(); NULL != changelog->table; changelog++)
+	{
+		if (0 == strcmp(changelog->table, table->table))
+			return FAIL;
+	}
+
+	for (field = table->fields; NULL != field->name; field++)
+	{
+		if (ZBX_TYPE_SERIAL == field->type)
+			return FAIL;
+	}
+
+	for (int i = 0; i < fields_num; i++)
+	{
+		if (0 != (fields[i]->flags & ZBX_UPPER))
+			return FAIL;
+	}
+
+	return SUCCEED;
+}
+#endif
+
 /******************************************************************************
  *                                                                            *
  * Purpose: prepare for database bulk insert operation                        *
@@ -115,6 +163,12 @@ void	zbx_dbconn_prepare_insert_dyn(zbx_dbconn_t *db, zbx_db_insert_t *db_insert,
 
 	for (int i = 0; i < fields_num; i++)
 		zbx_vector_const_db_field_ptr_append(&db_insert->fields, fields[i]);
+
+#if defined(HAVE_POSTGRESQL)
+	db_insert->copy = (SUCCEED == db_insert_copy_supported(table, fields, fields_num) ? 1 : 0);
+#else
+	db_insert->copy = 0;
+#endif
 }
 
 /******************************************************************************
@@ -217,7 +271,7 @@ void	zbx_db_insert_add_values_dyn(zbx_db_insert_t *db_insert, zbx_db_value_t **v
 			case ZBX_TYPE_TEXT:
 			case ZBX_TYPE_CUID:
 			case ZBX_TYPE_BLOB:
-				row[i].str = db_dyn_escape_field_len(field, value->str, ESCAPE_SEQUENCE_ON);
+				row[i].str = db_dyn_escape_field_len(field, value->str, DB_INSERT_ESCAPE_SEQUENCE);
 				break;
 			case ZBX_TYPE_INT:
 			case ZBX_TYPE_FLOAT:
@@ -353,6 +407,238 @@ static void	decode_and_escape_binary_value_for_sql(zbx_dbconn_t *db, char **sql_
 }
 #endif
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: appends string value to SQL statement                             *
+ *                                                                            *
+ ******************************************************************************/
+static void	db_insert_strcpy_alloc(char **sql, size_t *sql_alloc, size_t *sql_offset, const char *str)
+{
+#if defined(HAVE_POSTGRESQL)
+	const char	*start = str;
+
+	for (; '\0' != *str; str++)
+	{
+		if (SUCCEED != db_is_escape_sequence(*str))
+			continue;
+
+		/* escape sequence characters are escaped by repeating them */
+		zbx_strncpy_alloc(sql, sql_alloc, sql_offset, start, (size_t)(str - start + 1));
+		start = str;
+	}
+
+	zbx_strcpy_alloc(sql, sql_alloc, sql_offset, start);
+#else
+	zbx_strcpy_alloc(sql, sql_alloc, sql_offset, str);
+#endif
+}
+
+#if defined(HAVE_POSTGRESQL)
+
+static void	db_copy_add_bytes(char **data, size_t *data_alloc, size_t *data_offset, const void *src, size_t size)
+{
+	if (*data_alloc < *data_offset + size)
+	{
+		while (*data_alloc < *data_offset + size)
+			*data_alloc *= 2;
+
+		*data = (char *)zbx_realloc(*data, *data_alloc);
+	}
+
+	memcpy(*data + *data_offset, src, size);
+	*data_offset += size;
+}
+
+static void	db_copy_add_int16(char **data, size_t *data_alloc, size_t *data_offset, int value)
+{
+	unsigned char	buf[2];
+
+	buf[0] = (unsigned char)(value >> 8);
+	buf[1] = (unsigned char)value;
+
+	db_copy_add_bytes(data, data_alloc, data_offset, buf, sizeof(buf));
+}
+
+static void	db_copy_add_int32(char **data, size_t *data_alloc, size_t *data_offset, zbx_uint32_t value)
+{
+	unsigned char	buf[4];
+
+	for (int i = 3; 0 <= i; i--, value >>= 8)
+		buf[i] = (unsigned char)value;
+
+	db_copy_add_bytes(data, data_alloc, data_offset, buf, sizeof(buf));
+}
+
+static void	db_copy_add_int64(char **data, size_t *data_alloc, size_t *data_offset, zbx_uint64_t value)
+{
+	unsigned char	buf[8];
+
+	for (int i = 7; 0 <= i; i--, value >>= 8)
+		buf[i] = (unsigned char)value;
+
+	db_copy_add_bytes(data, data_alloc, data_offset, buf, sizeof(buf));
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds unsigned 64 bit integer value of numeric(20) field           *
+ *                                                                            *
+ * Comments: Numeric is sent as number of base 10000 digits, weight of the    *
+ *           first digit, sign, display scale and the digits, starting with   *
+ *           the most significant one. Trailing zero digits are omitted.      *
+ *                                                                            *
+ ******************************************************************************/
+static void	db_copy_add_numeric(char **data, size_t *data_alloc, size_t *data_offset, zbx_uint64_t value)
+{
+	int	digits[5], digits_num = 0, digits_min = 0;
+
+	for (; 0 != value; value /= 10000)
+		digits[digits_num++] = (int)(value % 10000);
+
+	while (digits_min < digits_num && 0 == digits[digits_min])
+		digits_min++;
+
+	db_copy_add_int32(data, data_alloc, data_offset, (zbx_uint32_t)(8 + (digits_num - digits_min) * 2));
+	db_copy_add_int16(data, data_alloc, data_offset, digits_num - digits_min);
+	db_copy_add_int16(data, data_alloc, data_offset, 0 == digits_num ? 0 : digits_num - 1);
+	db_copy_add_int16(data, data_alloc, data_offset, 0);
+	db_copy_add_int16(data, data_alloc, data_offset, 0);
+
+	for (int i = digits_num - 1; i >= digits_min; i--)
+		db_copy_add_int16(data, data_alloc, data_offset, digits[i]);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: inserts rows with COPY FROM STDIN in binary format                *
+ *                                                                            *
+ * Parameters: db_insert - [IN] the bulk insert data                          *
+ *                                                                            *
+ * Return value: SUCCEED if the operation completed successfully or           *
+ *               FAIL otherwise.                                              *
+ *                                                                            *
+ * Comments: Values are sent in binary representation of the field types      *
+ *           defined by database schema, avoiding their conversion to and     *
+ *           parsing from SQL text.                                           *
+ *                                                                            *
+ ******************************************************************************/
+static int	db_insert_copy(zbx_db_insert_t *db_insert)
+{
+	static const char	signature[] = "PGCOPY\n\377\r\n";
+	char			*sql = NULL, *data, *bin = NULL;
+	size_t			sql_alloc = 0, sql_offset = 0, data_alloc = 64 * ZBX_KIBIBYTE, data_offset = 0,
+				bin_alloc = 0, len;
+	int			ret = SUCCEED;
+
+	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, "copy %s (", db_insert->table->table);
+
+	for (int i = 0; i < db_insert->fields.values_num; i++)
+	{
+		if (0 != i)
+			zbx_chrcpy_alloc(&sql, &sql_alloc, &sql_offset, ',');
+
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, db_insert->fields.values[i]->name);
+	}
+
+	zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, ") from stdin with (format binary)");
+
+	data = (char *)zbx_malloc(NULL, data_alloc);
+
+	for (int i = 0; i < db_insert->rows.values_num; i++)
+	{
+		const zbx_db_value_t	*values = db_insert->rows.values[i];
+
+		if (0 == data_offset)
+		{
+			/* file header - signature including terminating zero, flags and header extension length */
+			db_copy_add_bytes(&data, &data_alloc, &data_offset, signature, sizeof(signature));
+			db_copy_add_int32(&data, &data_alloc, &data_offset, 0);
+			db_copy_add_int32(&data, &data_alloc, &data_offset, 0);
+		}
+
+		db_copy_add_int16(&data, &data_alloc, &data_offset, db_insert->fields.values_num);
+
+		for (int j = 0; j < db_insert->fields.values_num; j++)
+		{
+			const zbx_db_value_t	*value = &values[j];
+
+			switch (db_insert->fields.values[j]->type)
+			{
+				case ZBX_TYPE_CHAR:
+				case ZBX_TYPE_TEXT:
+				case ZBX_TYPE_LONGTEXT:
+				case ZBX_TYPE_CUID:
+					len = strlen(value->str);
+					db_copy_add_int32(&data, &data_alloc, &data_offset, (zbx_uint32_t)len);
+					db_copy_add_bytes(&data, &data_alloc, &data_offset, value->str, len);
+					break;
+				case ZBX_TYPE_BLOB:
+					len = strlen(value->str) * 3 / 4 + 1;
+
+					if (bin_alloc < len)
+						bin = (char *)zbx_realloc(bin, (bin_alloc = len));
+
+					zbx_base64_decode(value->str, bin, bin_alloc, &len);
+					db_copy_add_int32(&data, &data_alloc, &data_offset, (zbx_uint32_t)len);
+					db_copy_add_bytes(&data, &data_alloc, &data_offset, bin, len);
+					break;
+				case ZBX_TYPE_INT:
+					db_copy_add_int32(&data, &data_alloc, &data_offset, sizeof(zbx_uint32_t));
+					db_copy_add_int32(&data, &data_alloc, &data_offset, (zbx_uint32_t)value->i32);
+					break;
+				case ZBX_TYPE_FLOAT:
+				{
+					zbx_uint64_t	dbl;
+
+					memcpy(&dbl, &value->dbl, sizeof(dbl));
+					db_copy_add_int32(&data, &data_alloc, &data_offset, sizeof(zbx_uint64_t));
+					db_copy_add_int64(&data, &data_alloc, &data_offset, dbl);
+					break;
+				}
+				case ZBX_TYPE_UINT:
+					db_copy_add_numeric(&data, &data_alloc, &data_offset, value->ui64);
+					break;
+				case ZBX_TYPE_ID:
+					/* zero identifiers are inserted as NULL, see zbx_db_sql_id_ins() */
+					if (0 == value->ui64)
+					{
+						db_copy_add_int32(&data, &data_alloc, &data_offset, (zbx_uint32_t)-1);
+						break;
+					}
+
+					db_copy_add_int32(&data, &data_alloc, &data_offset, sizeof(zbx_uint64_t));
+					db_copy_add_int64(&data, &data_alloc, &data_offset, value->ui64);
+					break;
+				default:
+					THIS_SHOULD_NEVER_HAPPEN;
+					exit(EXIT_FAILURE);
+			}
+		}
+
+		if (DB_INSERT_COPY_SIZE_MAX > data_offset && i != db_insert->rows.values_num - 1)
+			continue;
+
+		/* file trailer */
+		db_copy_add_int16(&data, &data_alloc, &data_offset, -1);
+
+		if (ZBX_DB_OK > dbconn_copy(db_insert->db, sql, data, data_offset))
+		{
+			ret = FAIL;
+			break;
+		}
+
+		data_offset = 0;
+	}
+
+	zbx_free(bin);
+	zbx_free(data);
+	zbx_free(sql);
+
+	return ret;
+}
+
+#endif
+
 /******************************************************************************
  *                                                                            *
  * Purpose: executes the prepared database bulk insert operation              *
@@ -408,6 +694,11 @@ int	zbx_db_insert_execute(zbx_db_insert_t *db_insert)
 		db_insert->autoincrement = -1;
 	}
 
+#if defined(HAVE_POSTGRESQL)
+	if (0 != db_insert->copy && DB_INSERT_COPY_ROWS_MIN <= db_insert->rows.values_num)
+		return db_insert_copy(db_insert);
+#endif
+
 	sql = (char *)zbx_malloc(NULL, sql_alloc);
 	sql_command = (char *)zbx_malloc(NULL, sql_command_alloc);
 
@@ -480,7 +771,7 @@ int	zbx_db_insert_execute(zbx_db_insert_t *db_insert)
 					else
 						zbx_chrcpy_alloc(&sql, &sql_alloc, &sql_offset, '\'');
 
-					zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, value->str);
+					db_insert_strcpy_alloc(&sql, &sql_alloc, &sql_offset, value->str);
 
 					if (0 != (field->flags & ZBX_UPPER))
 					{
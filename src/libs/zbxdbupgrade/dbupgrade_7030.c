@@ -28,6 +28,351 @@ static int	DBpatch_7030000(void)
 	return DBadd_field("config", &field);
 }
 
+static int	DBpatch_7030001(void)
+{
+	return DBcreate_changelog_insert_trigger("globalmacro", "globalmacroid");
+}
+
+static int	DBpatch_7030002(void)
+{
+	return DBcreate_changelog_update_trigger("globalmacro", "globalmacroid");
+}
+
+static int	DBpatch_7030003(void)
+{
+	return DBcreate_changelog_delete_trigger("globalmacro", "globalmacroid");
+}
+
+static int	DBpatch_7030004(void)
+{
+	return DBcreate_changelog_insert_trigger("hostmacro", "hostmacroid");
+}
+
+static int	DBpatch_7030005(void)
+{
+	return DBcreate_changelog_update_trigger("hostmacro", "hostmacroid");
+}
+
+static int	DBpatch_7030006(void)
+{
+	return DBcreate_changelog_delete_trigger("hostmacro", "hostmacroid");
+}
+
+static int	DBpatch_7030007(void)
+{
+	return DBcreate_changelog_insert_trigger("interface", "interfaceid");
+}
+
+static int	DBpatch_7030008(void)
+{
+	return DBcreate_changelog_update_trigger("interface", "interfaceid");
+}
+
+static int	DBpatch_7030009(void)
+{
+	return DBcreate_changelog_delete_trigger("interface", "interfaceid");
+}
+
+static int	DBpatch_7030010(void)
+{
+	return DBcreate_changelog_insert_trigger("interface_snmp", "interfaceid");
+}
+
+static int	DBpatch_7030011(void)
+{
+	return DBcreate_changelog_update_trigger("interface_snmp", "interfaceid");
+}
+
+static int	DBpatch_7030012(void)
+{
+	return DBcreate_changelog_delete_trigger("interface_snmp", "interfaceid");
+}
+
+static int	DBpatch_7030013(void)
+{
+	return DBcreate_changelog_insert_trigger("host_inventory", "hostid");
+}
+
+static int	DBpatch_7030014(void)
+{
+	return DBcreate_changelog_update_trigger("host_inventory", "hostid");
+}
+
+static int	DBpatch_7030015(void)
+{
+	return DBcreate_changelog_delete_trigger("host_inventory", "hostid");
+}
+
+static int	DBpatch_7030016(void)
+{
+	return DBcreate_changelog_insert_trigger("hosts_templates", "hosttemplateid");
+}
+
+static int	DBpatch_7030017(void)
+{
+	return DBcreate_changelog_update_trigger("hosts_templates", "hosttemplateid");
+}
+
+static int	DBpatch_7030018(void)
+{
+	return DBcreate_changelog_delete_trigger("hosts_templates", "hosttemplateid");
+}
+
+static int	DBpatch_7030019(void)
+{
+	return DBcreate_changelog_insert_trigger("actions", "actionid");
+}
+
+static int	DBpatch_7030020(void)
+{
+	return DBcreate_changelog_update_trigger("actions", "actionid");
+}
+
+static int	DBpatch_7030021(void)
+{
+	return DBcreate_changelog_delete_trigger("actions", "actionid");
+}
+
+static int	DBpatch_7030022(void)
+{
+	return DBcreate_changelog_insert_trigger("operations", "operationid");
+}
+
+static int	DBpatch_7030023(void)
+{
+	return DBcreate_changelog_update_trigger("operations", "operationid");
+}
+
+static int	DBpatch_7030024(void)
+{
+	return DBcreate_changelog_delete_trigger("operations", "operationid");
+}
+
+static int	DBpatch_7030025(void)
+{
+	return DBcreate_changelog_insert_trigger("conditions", "conditionid");
+}
+
+static int	DBpatch_7030026(void)
+{
+	return DBcreate_changelog_update_trigger("conditions", "conditionid");
+}
+
+static int	DBpatch_7030027(void)
+{
+	return DBcreate_changelog_delete_trigger("conditions", "conditionid");
+}
+
+static int	DBpatch_7030028(void)
+{
+	return DBcreate_changelog_insert_trigger("correlation", "correlationid");
+}
+
+static int	DBpatch_7030029(void)
+{
+	return DBcreate_changelog_update_trigger("correlation", "correlationid");
+}
+
+static int	DBpatch_7030030(void)
+{
+	return DBcreate_changelog_delete_trigger("correlation", "correlationid");
+}
+
+static int	DBpatch_7030031(void)
+{
+	return DBcreate_changelog_insert_trigger("corr_condition", "corr_conditionid");
+}
+
+static int	DBpatch_7030032(void)
+{
+	return DBcreate_changelog_update_trigger("corr_condition", "corr_conditionid");
+}
+
+static int	DBpatch_7030033(void)
+{
+	return DBcreate_changelog_delete_trigger("corr_condition", "corr_conditionid");
+}
+
+static int	DBpatch_7030034(void)
+{
+	return DBcreate_changelog_insert_trigger("corr_condition_tag", "corr_conditionid");
+}
+
+static int	DBpatch_7030035(void)
+{
+	return DBcreate_changelog_update_trigger("corr_condition_tag", "corr_conditionid");
+}
+
+static int	DBpatch_7030036(void)
+{
+	return DBcreate_changelog_delete_trigger("corr_condition_tag", "corr_conditionid");
+}
+
+static int	DBpatch_7030037(void)
+{
+	return DBcreate_changelog_insert_trigger("corr_condition_group", "corr_conditionid");
+}
+
+static int	DBpatch_7030038(void)
+{
+	return DBcreate_changelog_update_trigger("corr_condition_group", "corr_conditionid");
+}
+
+static int	DBpatch_7030039(void)
+{
+	return DBcreate_changelog_delete_trigger("corr_condition_group", "corr_conditionid");
+}
+
+static int	DBpatch_7030040(void)
+{
+	return DBcreate_changelog_insert_trigger("corr_condition_tagpair", "corr_conditionid");
+}
+
+static int	DBpatch_7030041(void)
+{
+	return DBcreate_changelog_update_trigger("corr_condition_tagpair", "corr_conditionid");
+}
+
+static int	DBpatch_7030042(void)
+{
+	return DBcreate_changelog_delete_trigger("corr_condition_tagpair", "corr_conditionid");
+}
+
+static int	DBpatch_7030043(void)
+{
+	return DBcreate_changelog_insert_trigger("corr_condition_tagvalue", "corr_conditionid");
+}
+
+static int	DBpatch_7030044(void)
+{
+	return DBcreate_changelog_update_trigger("corr_condition_tagvalue", "corr_conditionid");
+}
+
+static int	DBpatch_7030045(void)
+{
+	return DBcreate_changelog_delete_trigger("corr_condition_tagvalue", "corr_conditionid");
+}
+
+static int	DBpatch_7030046(void)
+{
+	return DBcreate_changelog_insert_trigger("corr_operation", "corr_operationid");
+}
+
+static int	DBpatch_7030047(void)
+{
+	return DBcreate_changelog_update_trigger("corr_operation", "corr_operationid");
+}
+
+static int	DBpatch_7030048(void)
+{
+	return DBcreate_changelog_delete_trigger("corr_operation", "corr_operationid");
+}
+
+static int	DBpatch_7030049(void)
+{
+	return DBcreate_changelog_insert_trigger("maintenances", "maintenanceid");
+}
+
+static int	DBpatch_7030050(void)
+{
+	return DBcreate_changelog_update_trigger("maintenances", "maintenanceid");
+}
+
+static int	DBpatch_7030051(void)
+{
+	return DBcreate_changelog_delete_trigger("maintenances", "maintenanceid");
+}
+
+static int	DBpatch_7030052(void)
+{
+	return DBcreate_changelog_insert_trigger("maintenances_windows", "maintenance_timeperiodid");
+}
+
+static int	DBpatch_7030053(void)
+{
+	return DBcreate_changelog_update_trigger("maintenances_windows", "maintenance_timeperiodid");
+}
+
+static int	DBpatch_7030054(void)
+{
+	return DBcreate_changelog_delete_trigger("maintenances_windows", "maintenance_timeperiodid");
+}
+
+static int	DBpatch_7030055(void)
+{
+	return DBcreate_changelog_insert_trigger("timeperiods", "timeperiodid");
+}
+
+static int	DBpatch_7030056(void)
+{
+	return DBcreate_changelog_update_trigger("timeperiods", "timeperiodid");
+}
+
+static int	DBpatch_7030057(void)
+{
+	return DBcreate_changelog_delete_trigger("timeperiods", "timeperiodid");
+}
+
+static int	DBpatch_7030058(void)
+{
+	return DBcreate_changelog_insert_trigger("maintenance_tag", "maintenancetagid");
+}
+
+static int	DBpatch_7030059(void)
+{
+	return DBcreate_changelog_update_trigger("maintenance_tag", "maintenancetagid");
+}
+
+static int	DBpatch_7030060(void)
+{
+	return DBcreate_changelog_delete_trigger("maintenance_tag", "maintenancetagid");
+}
+
+static int	DBpatch_7030061(void)
+{
+	return DBcreate_changelog_insert_trigger("maintenances_groups", "maintenance_groupid");
+}
+
+static int	DBpatch_7030062(void)
+{
+	return DBcreate_changelog_update_trigger("maintenances_groups", "maintenance_groupid");
+}
+
+static int	DBpatch_7030063(void)
+{
+	return DBcreate_changelog_delete_trigger("maintenances_groups", "maintenance_groupid");
+}
+
+static int	DBpatch_7030064(void)
+{
+	return DBcreate_changelog_insert_trigger("maintenances_hosts", "maintenance_hostid");
+}
+
+static int	DBpatch_7030065(void)
+{
+	return DBcreate_changelog_update_trigger("maintenances_hosts", "maintenance_hostid");
+}
+
+static int	DBpatch_7030066(void)
+{
+	return DBcreate_changelog_delete_trigger("maintenances_hosts", "maintenance_hostid");
+}
+
+static int	DBpatch_7030067(void)
+{
+	return DBcreate_changelog_insert_trigger("hstgrp", "groupid");
+}
+
+static int	DBpatch_7030068(void)
+{
+	return DBcreate_changelog_update_trigger("hstgrp", "groupid");
+}
+
+static int	DBpatch_7030069(void)
+{
+	return DBcreate_changelog_delete_trigger("hstgrp", "groupid");
+}
+
 #endif
 
 DBPATCH_START(7030)
@@ -35,5 +380,74 @@ DBPATCH_START(7030)
 /* version, duplicates flag, mandatory flag */
 
 DBPATCH_ADD(7030000, 0, 1)
+DBPATCH_ADD(7030001, 0, 1)
+DBPATCH_ADD(7030002, 0, 1)
+DBPATCH_ADD(7030003, 0, 1)
+DBPATCH_ADD(7030004, 0, 1)
+DBPATCH_ADD(7030005, 0, 1)
+DBPATCH_ADD(7030006, 0, 1)
+DBPATCH_ADD(7030007, 0, 1)
+DBPATCH_ADD(7030008, 0, 1)
+DBPATCH_ADD(7030009, 0, 1)
+DBPATCH_ADD(7030010, 0, 1)
+DBPATCH_ADD(7030011, 0, 1)
+DBPATCH_ADD(7030012, 0, 1)
+DBPATCH_ADD(7030013, 0, 1)
+DBPATCH_ADD(7030014, 0, 1)
+DBPATCH_ADD(7030015, 0, 1)
+DBPATCH_ADD(7030016, 0, 1)
+DBPATCH_ADD(7030017, 0, 1)
+DBPATCH_ADD(7030018, 0, 1)
+DBPATCH_ADD(7030019, 0, 1)
+DBPATCH_ADD(7030020, 0, 1)
+DBPATCH_ADD(7030021, 0, 1)
+DBPATCH_ADD(7030022, 0, 1)
+DBPATCH_ADD(7030023, 0, 1)
+DBPATCH_ADD(7030024, 0, 1)
+DBPATCH_ADD(7030025, 0, 1)
+DBPATCH_ADD(7030026, 0, 1)
+DBPATCH_ADD(7030027, 0, 1)
+DBPATCH_ADD(7030028, 0, 1)
+DBPATCH_ADD(7030029, 0, 1)
+DBPATCH_ADD(7030030, 0, 1)
+DBPATCH_ADD(7030031, 0, 1)
+DBPATCH_ADD(7030032, 0, 1)
+DBPATCH_ADD(7030033, 0, 1)
+DBPATCH_ADD(7030034, 0, 1)
+DBPATCH_ADD(7030035, 0, 1)
+DBPATCH_ADD(7030036, 0, 1)
+DBPATCH_ADD(7030037, 0, 1)
+DBPATCH_ADD(7030038, 0, 1)
+DBPATCH_ADD(7030039, 0, 1)
+DBPATCH_ADD(7030040, 0, 1)
+DBPATCH_ADD(7030041, 0, 1)
+DBPATCH_ADD(7030042, 0, 1)
+DBPATCH_ADD(7030043, 0, 1)
+DBPATCH_ADD(7030044, 0, 1)
+DBPATCH_ADD(7030045, 0, 1)
+DBPATCH_ADD(7030046, 0, 1)
+DBPATCH_ADD(7030047, 0, 1)
+DBPATCH_ADD(7030048, 0, 1)
+DBPATCH_ADD(7030049, 0, 1)
+DBPATCH_ADD(7030050, 0, 1)
+DBPATCH_ADD(7030051, 0, 1)
+DBPATCH_ADD(7030052, 0, 1)
+DBPATCH_ADD(7030053, 0, 1)
+DBPATCH_ADD(7030054, 0, 1)
+DBPATCH_ADD(7030055, 0, 1)
+DBPATCH_ADD(7030056, 0, 1)
+DBPATCH_ADD(7030057, 0, 1)
+DBPATCH_ADD(7030058, 0, 1)
+DBPATCH_ADD(7030059, 0, 1)
+DBPATCH_ADD(7030060, 0, 1)
+DBPATCH_ADD(7030061, 0, 1)
+DBPATCH_ADD(7030062, 0, 1)
+DBPATCH_ADD(7030063, 0, 1)
+DBPATCH_ADD(7030064, 0, 1)
+DBPATCH_ADD(7030065, 0, 1)
+DBPATCH_ADD(7030066, 0, 1)
+DBPATCH_ADD(7030067, 0, 1)
+DBPATCH_ADD(7030068, 0, 1)
+DBPATCH_ADD(7030069, 0, 1)
 
 DBPATCH_END()
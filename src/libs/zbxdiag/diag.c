@@ -32,9 +32,11 @@
 #define ZBX_DIAG_HISTORYCACHE_VALUES		0x00000002
 #define ZBX_DIAG_HISTORYCACHE_MEMORY_DATA	0x00000004
 #define ZBX_DIAG_HISTORYCACHE_MEMORY_INDEX	0x00000008
+#define ZBX_DIAG_HISTORYCACHE_SHARDS		0x00000010
 
 #define ZBX_DIAG_HISTORYCACHE_SIMPLE	(ZBX_DIAG_HISTORYCACHE_ITEMS | \
-					ZBX_DIAG_HISTORYCACHE_VALUES)
+					ZBX_DIAG_HISTORYCACHE_VALUES | \
+					ZBX_DIAG_HISTORYCACHE_SHARDS)
 
 #define ZBX_DIAG_HISTORYCACHE_MEMORY	(ZBX_DIAG_HISTORYCACHE_MEMORY_DATA | \
 					ZBX_DIAG_HISTORYCACHE_MEMORY_INDEX)
@@ -171,6 +173,7 @@ void	zbx_diag_add_mem_stats(struct zbx_json *json, const char *name, const zbx_s
 	zbx_json_addobject(json, "size");
 	zbx_json_adduint64(json, "free", stats->free_size);
 	zbx_json_adduint64(json, "used", stats->used_size);
+	zbx_json_adduint64(json, "pagesize", stats->page_size);
 	zbx_json_close(json);
 
 	zbx_json_addobject(json, "chunks");
@@ -197,6 +200,29 @@ void	zbx_diag_add_mem_stats(struct zbx_json *json, const char *name, const zbx_s
 
 	zbx_json_close(json);
 	zbx_json_close(json);
+
+	zbx_json_addobject(json, "slabs");
+	zbx_json_adduint64(json, "free", stats->slab_free_size);
+	zbx_json_addarray(json, "classes");
+
+	for (i = 0; i < ZBX_SHMEM_SLAB_CLASS_COUNT; i++)
+	{
+		const zbx_shmem_slab_stats_t	*slab_stats = &stats->slabs[i];
+
+		if (0 == slab_stats->slabs_num)
+			continue;
+
+		zbx_json_addobject(json, NULL);
+		zbx_json_adduint64(json, "size", slab_stats->object_size);
+		zbx_json_adduint64(json, "slabs", slab_stats->slabs_num);
+		zbx_json_adduint64(json, "used", slab_stats->objects_used);
+		zbx_json_adduint64(json, "free", slab_stats->objects_free);
+		zbx_json_close(json);
+	}
+
+	zbx_json_close(json);
+	zbx_json_close(json);
+
 	zbx_json_close(json);
 }
 
@@ -261,6 +287,7 @@ int	zbx_diag_add_historycache_info(const struct zbx_json_parse *jp, struct zbx_j
 								ZBX_DIAG_HISTORYCACHE_MEMORY},
 							{"items", ZBX_DIAG_HISTORYCACHE_ITEMS},
 							{"values", ZBX_DIAG_HISTORYCACHE_VALUES},
+							{"shards", ZBX_DIAG_HISTORYCACHE_SHARDS},
 							{"memory", ZBX_DIAG_HISTORYCACHE_MEMORY},
 							{"memory.data", ZBX_DIAG_HISTORYCACHE_MEMORY_DATA},
 							{"memory.index", ZBX_DIAG_HISTORYCACHE_MEMORY_INDEX},
@@ -277,10 +304,13 @@ int	zbx_diag_add_historycache_info(const struct zbx_json_parse *jp, struct zbx_j
 
 		if (0 != (fields & ZBX_DIAG_HISTORYCACHE_SIMPLE))
 		{
-			zbx_uint64_t	values_num, items_num;
+			zbx_uint64_t			values_num, items_num;
+			zbx_vector_hc_shard_stats_t	shards;
+
+			zbx_vector_hc_shard_stats_create(&shards);
 
 			time1 = zbx_time();
-			zbx_hc_get_diag_stats(&items_num, &values_num);
+			zbx_hc_get_diag_stats(&items_num, &values_num, &shards);
 			time2 = zbx_time();
 			time_total += time2 - time1;
 
@@ -288,6 +318,25 @@ int	zbx_diag_add_historycache_info(const struct zbx_json_parse *jp, struct zbx_j
 				zbx_json_adduint64(json, "items", items_num);
 			if (0 != (fields & ZBX_DIAG_HISTORYCACHE_VALUES))
 				zbx_json_adduint64(json, "values", values_num);
+
+			if (0 != (fields & ZBX_DIAG_HISTORYCACHE_SHARDS))
+			{
+				zbx_json_addarray(json, "shards");
+
+				for (i = 0; i < shards.values_num; i++)
+				{
+					zbx_json_addobject(json, NULL);
+					zbx_json_adduint64(json, "items", shards.values[i].items_num);
+					zbx_json_adduint64(json, "values", shards.values[i].values_num);
+					zbx_json_adduint64(json, "locks", shards.values[i].locks_num);
+					zbx_json_adduint64(json, "contended", shards.values[i].locks_contended);
+					zbx_json_close(json);
+				}
+
+				zbx_json_close(json);
+			}
+
+			zbx_vector_hc_shard_stats_destroy(&shards);
 		}
 
 		if (0 != (fields & ZBX_DIAG_HISTORYCACHE_MEMORY))
@@ -414,21 +463,31 @@ void	zbx_diag_add_locks_info(struct zbx_json *json)
 				"ZBX_MUTEX_VALUECACHE", "ZBX_MUTEX_VMWARE", "ZBX_MUTEX_SQLITE3",
 				"ZBX_MUTEX_PROCSTAT", "ZBX_MUTEX_PROXY_HISTORY", "ZBX_MUTEX_KSTAT", "ZBX_MUTEX_MODBUS",
 				"ZBX_MUTEX_TREND_FUNC", "ZBX_MUTEX_REMOTE_COMMANDS", "ZBX_MUTEX_PROXY_BUFFER",
-				"ZBX_MUTEX_VPS_MONITOR"};
+				"ZBX_MUTEX_VPS_MONITOR", "ZBX_MUTEX_CACHE_SPILL"};
 #else
 	const char	*names[ZBX_MUTEX_COUNT] = {"ZBX_MUTEX_LOG", "ZBX_MUTEX_CACHE", "ZBX_MUTEX_TRENDS",
 				"ZBX_MUTEX_CACHE_IDS", "ZBX_MUTEX_SELFMON", "ZBX_MUTEX_CPUSTATS", "ZBX_MUTEX_DISKSTATS",
 				"ZBX_MUTEX_VALUECACHE", "ZBX_MUTEX_VMWARE", "ZBX_MUTEX_SQLITE3",
 				"ZBX_MUTEX_PROCSTAT", "ZBX_MUTEX_PROXY_HISTORY", "ZBX_MUTEX_MODBUS",
 				"ZBX_MUTEX_TREND_FUNC", "ZBX_MUTEX_REMOTE_COMMANDS", "ZBX_MUTEX_PROXY_BUFFER",
-				"ZBX_MUTEX_VPS_MONITOR"};
+				"ZBX_MUTEX_VPS_MONITOR", "ZBX_MUTEX_CACHE_SPILL"};
 #endif
 	zbx_json_addarray(json, ZBX_DIAG_LOCKS);
 
 	for (i = 0; i < ZBX_MUTEX_COUNT; i++)
 	{
 		zbx_json_addobject(json, NULL);
-		zbx_json_addhex(json, names[i], (zbx_uint64_t)zbx_mutex_addr_get(i));
+
+		if (ZBX_MUTEX_CACHE_SHARD <= i && ZBX_MUTEX_CACHE_SHARD_LAST >= i)
+		{
+			char	name[32];
+
+			zbx_snprintf(name, sizeof(name), "ZBX_MUTEX_CACHE_SHARD_%d", i - ZBX_MUTEX_CACHE_SHARD + 1);
+			zbx_json_addhex(json, name, (zbx_uint64_t)zbx_mutex_addr_get(i));
+		}
+		else
+			zbx_json_addhex(json, names[i], (zbx_uint64_t)zbx_mutex_addr_get(i));
+
 		zbx_json_close(json);
 	}
 
@@ -696,6 +755,8 @@ static void	diag_log_history_cache(struct zbx_json_parse *jp, char **out, size_t
 	zbx_strlog_alloc(LOG_LEVEL_INFORMATION, out, out_alloc, out_offset, "%s", msg);
 	zbx_free(msg);
 
+	diag_log_top_view(jp, "shards", "$.shards", out, out_alloc, out_offset);
+
 	diag_log_memory_info(jp, "memory.data", "$.memory.data", out, out_alloc, out_offset);
 	diag_log_memory_info(jp, "memory.index", "$.memory.index", out, out_alloc, out_offset);
 
@@ -711,7 +772,8 @@ static void	diag_log_history_cache(struct zbx_json_parse *jp, char **out, size_t
  ******************************************************************************/
 static void	diag_log_value_cache(struct zbx_json_parse *jp, char **out, size_t *out_alloc, size_t *out_offset)
 {
-	char	*msg = NULL;
+	char			*msg = NULL;
+	struct zbx_json_parse	jp_snapshot;
 
 	zbx_strlog_alloc(LOG_LEVEL_INFORMATION, out, out_alloc, out_offset, "== value cache diagnostic information ==");
 
@@ -721,6 +783,13 @@ static void	diag_log_value_cache(struct zbx_json_parse *jp, char **out, size_t *
 
 	diag_log_memory_info(jp, "memory", "$.memory", out, out_alloc, out_offset);
 
+	if (SUCCEED == zbx_json_open_path(jp, "$.snapshot", &jp_snapshot))
+	{
+		diag_get_simple_values(&jp_snapshot, &msg);
+		zbx_strlog_alloc(LOG_LEVEL_INFORMATION, out, out_alloc, out_offset, "snapshot: %s", msg);
+		zbx_free(msg);
+	}
+
 	diag_log_top_view(jp, "top.values", "$.top.values", out, out_alloc, out_offset);
 	diag_log_top_view(jp, "top.request.values", "$.top['request.values']", out, out_alloc, out_offset);
 
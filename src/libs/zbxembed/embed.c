@@ -33,8 +33,18 @@
 /* maximum number of consequent runtime errors after which it's treated as fatal error */
 #define ZBX_ES_MAX_CONSEQUENT_RT_ERROR	3
 
-#define ZBX_ES_SCRIPT_HEADER	"function(value){"
-#define ZBX_ES_SCRIPT_FOOTER	"\n}"
+/* script function is returned by the compiled function, so every execution gets new function object */
+#define ZBX_ES_SCRIPT_HEADER	"function(){return function(value){"
+#define ZBX_ES_SCRIPT_FOOTER	"\n}}"
+
+/* maximum size of cached bytecode, for compiled scripts and for loaded functions separately */
+#define ZBX_ES_CACHE_LIMIT	(ZBX_MEBIBYTE * 16)
+
+/* full garbage collection is forced after this number of executions or heap growth */
+#define ZBX_ES_GC_PERIOD	100
+#define ZBX_ES_GC_ALLOC_LIMIT	(ZBX_MEBIBYTE * 8)
+
+#define ZBX_ES_FUNCTIONS_KEY	"\xff""\xff""zbx_functions"
 
 typedef struct
 {
@@ -44,6 +54,25 @@ typedef struct
 }
 zbx_es_obj_data_t;
 
+typedef struct
+{
+	char		*script;
+	char		*code;
+	int		size;
+	zbx_uint64_t	lastaccess;
+}
+zbx_es_script_t;
+
+typedef struct
+{
+	char		*code;
+	int		size;
+	duk_uarridx_t	index;		/* index in stashed functions object keeping function alive */
+	void		*heapptr;
+	zbx_uint64_t	lastaccess;
+}
+zbx_es_function_t;
+
 /******************************************************************************
  *                                                                            *
  * Purpose: fatal error handler                                               *
@@ -280,6 +309,201 @@ int	zbx_es_check_timeout(void *udata)
 	return 0;
 }
 
+static zbx_hash_t	es_script_hash(const void *data)
+{
+	const zbx_es_script_t	*script = (const zbx_es_script_t *)data;
+
+	return ZBX_DEFAULT_STRING_HASH_FUNC(script->script);
+}
+
+static int	es_script_compare(const void *d1, const void *d2)
+{
+	const zbx_es_script_t	*s1 = (const zbx_es_script_t *)d1;
+	const zbx_es_script_t	*s2 = (const zbx_es_script_t *)d2;
+
+	return strcmp(s1->script, s2->script);
+}
+
+static void	es_script_clear(void *data)
+{
+	zbx_es_script_t	*script = (zbx_es_script_t *)data;
+
+	zbx_free(script->script);
+	zbx_free(script->code);
+}
+
+static zbx_hash_t	es_function_hash(const void *data)
+{
+	const zbx_es_function_t	*func = (const zbx_es_function_t *)data;
+
+	return ZBX_DEFAULT_STRING_HASH_ALGO(func->code, (size_t)func->size, ZBX_DEFAULT_HASH_SEED);
+}
+
+static int	es_function_compare(const void *d1, const void *d2)
+{
+	const zbx_es_function_t	*f1 = (const zbx_es_function_t *)d1;
+	const zbx_es_function_t	*f2 = (const zbx_es_function_t *)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(f1->size, f2->size);
+
+	return memcmp(f1->code, f2->code, (size_t)f1->size);
+}
+
+static void	es_function_clear(void *data)
+{
+	zbx_es_function_t	*func = (zbx_es_function_t *)data;
+
+	zbx_free(func->code);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets bytecode of previously compiled script                       *
+ *                                                                            *
+ * Parameters: env    - [IN] scripting environment                            *
+ *             script - [IN] script text                                      *
+ *             code   - [OUT] copy of the bytecode                            *
+ *             size   - [OUT] bytecode size                                   *
+ *                                                                            *
+ * Return value: SUCCEED - bytecode was found in cache                        *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	es_script_cache_get(zbx_es_env_t *env, const char *script, char **code, int *size)
+{
+	zbx_es_script_t	script_local, *cached;
+
+	script_local.script = (char *)script;
+
+	if (NULL == (cached = (zbx_es_script_t *)zbx_hashset_search(&env->scripts, &script_local)))
+		return FAIL;
+
+	cached->lastaccess = ++env->cache_access;
+
+	*code = zbx_malloc(NULL, (size_t)cached->size);
+	memcpy(*code, cached->code, (size_t)cached->size);
+	*size = cached->size;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: caches bytecode of compiled script                                *
+ *                                                                            *
+ * Comments: The least recently used scripts are dropped when the cached      *
+ *           bytecode exceeds ZBX_ES_CACHE_LIMIT.                             *
+ *                                                                            *
+ ******************************************************************************/
+static void	es_script_cache_add(zbx_es_env_t *env, const char *script, const char *code, int size)
+{
+	zbx_es_script_t	script_local;
+	size_t		len = strlen(script);
+
+	if (len + (size_t)size > ZBX_ES_CACHE_LIMIT)
+		return;
+
+	while (env->scripts_size + len + (size_t)size > ZBX_ES_CACHE_LIMIT)
+	{
+		zbx_hashset_iter_t	iter;
+		zbx_es_script_t		*cached, *oldest = NULL;
+
+		zbx_hashset_iter_reset(&env->scripts, &iter);
+		while (NULL != (cached = (zbx_es_script_t *)zbx_hashset_iter_next(&iter)))
+		{
+			if (NULL == oldest || cached->lastaccess < oldest->lastaccess)
+				oldest = cached;
+		}
+
+		env->scripts_size -= strlen(oldest->script) + (size_t)oldest->size;
+		zbx_hashset_remove_direct(&env->scripts, oldest);
+	}
+
+	script_local.script = zbx_strdup(NULL, script);
+	script_local.code = zbx_malloc(NULL, (size_t)size);
+	memcpy(script_local.code, code, (size_t)size);
+	script_local.size = size;
+	script_local.lastaccess = ++env->cache_access;
+
+	zbx_hashset_insert(&env->scripts, &script_local, sizeof(script_local));
+	env->scripts_size += len + (size_t)size;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: pushes new instance of script function on the stack               *
+ *                                                                            *
+ * Parameters: env  - [IN] scripting environment                              *
+ *             code - [IN] bytecode                                           *
+ *             size - [IN] bytecode size                                      *
+ *                                                                            *
+ * Comments: Functions loaded from bytecode are kept referenced from global   *
+ *           stash, so the same bytecode is deserialized only once per heap.  *
+ *           The least recently used functions are released when the cached   *
+ *           bytecode exceeds ZBX_ES_CACHE_LIMIT.                             *
+ *           The loaded function is called to create the script function, so  *
+ *           properties set on the script function by one execution are not   *
+ *           visible to other executions of the same bytecode.                *
+ *                                                                            *
+ ******************************************************************************/
+static void	es_push_function(zbx_es_env_t *env, const char *code, int size)
+{
+	zbx_es_function_t	func_local, *func;
+	void			*buffer;
+
+	func_local.code = (char *)code;
+	func_local.size = size;
+
+	if (NULL != (func = (zbx_es_function_t *)zbx_hashset_search(&env->functions, &func_local)))
+	{
+		func->lastaccess = ++env->cache_access;
+		duk_push_heapptr(env->ctx, func->heapptr);
+		goto out;
+	}
+
+	buffer = duk_push_fixed_buffer(env->ctx, (duk_size_t)size);
+	memcpy(buffer, code, (size_t)size);
+	duk_load_function(env->ctx);
+
+	if ((size_t)size > ZBX_ES_CACHE_LIMIT)
+		goto out;
+
+	duk_push_global_stash(env->ctx);
+	duk_get_prop_string(env->ctx, -1, ZBX_ES_FUNCTIONS_KEY);		/* [func,stash,functions] */
+
+	while (env->functions_size + (size_t)size > ZBX_ES_CACHE_LIMIT)
+	{
+		zbx_hashset_iter_t	iter;
+		zbx_es_function_t	*oldest = NULL;
+
+		zbx_hashset_iter_reset(&env->functions, &iter);
+		while (NULL != (func = (zbx_es_function_t *)zbx_hashset_iter_next(&iter)))
+		{
+			if (NULL == oldest || func->lastaccess < oldest->lastaccess)
+				oldest = func;
+		}
+
+		duk_del_prop_index(env->ctx, -1, oldest->index);
+		env->functions_size -= (size_t)oldest->size;
+		zbx_hashset_remove_direct(&env->functions, oldest);
+	}
+
+	func_local.index = env->functions_index++;
+	duk_dup(env->ctx, -3);
+	duk_put_prop_index(env->ctx, -2, func_local.index);
+	duk_pop_2(env->ctx);							/* [func] */
+
+	func_local.code = zbx_malloc(NULL, (size_t)size);
+	memcpy(func_local.code, code, (size_t)size);
+	func_local.heapptr = duk_get_heapptr(env->ctx, -1);
+	func_local.lastaccess = ++env->cache_access;
+
+	zbx_hashset_insert(&env->functions, &func_local, sizeof(func_local));
+	env->functions_size += (size_t)size;
+out:
+	duk_call(env->ctx, 0);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: initializes embedded scripting engine                             *
@@ -376,6 +600,12 @@ int	zbx_es_init_env(zbx_es_t *es, const char *config_source_ip, char **error)
 	duk_get_prop_string(es->env->ctx, -2, "stringify");	/* [stash,JSON,"_stringify",JSON.stringify] */
 	es->env->json_stringify = duk_get_heapptr(es->env->ctx, -1);
 
+	duk_def_prop(es->env->ctx, -4, DUK_DEFPROP_HAVE_VALUE | DUK_DEFPROP_CLEAR_WRITABLE | DUK_DEFPROP_HAVE_ENUMERABLE |
+			DUK_DEFPROP_HAVE_CONFIGURABLE);	/* [stash,JSON] */
+
+	/* functions loaded from bytecode are kept in stash to be reused by next executions */
+	duk_push_string(es->env->ctx, ZBX_ES_FUNCTIONS_KEY);	/* [stash,JSON,ZBX_ES_FUNCTIONS_KEY] */
+	duk_push_object(es->env->ctx);				/* [stash,JSON,ZBX_ES_FUNCTIONS_KEY,{}] */
 	duk_def_prop(es->env->ctx, -4, DUK_DEFPROP_HAVE_VALUE | DUK_DEFPROP_CLEAR_WRITABLE | DUK_DEFPROP_HAVE_ENUMERABLE |
 			DUK_DEFPROP_HAVE_CONFIGURABLE);	/* [stash,JSON] */
 
@@ -391,6 +621,10 @@ int	zbx_es_init_env(zbx_es_t *es, const char *config_source_ip, char **error)
 	es->env->timeout = ZBX_ES_TIMEOUT;
 
 	zbx_hashset_create(&es->env->objmap, 0, ZBX_DEFAULT_PTR_HASH_FUNC, ZBX_DEFAULT_PTR_COMPARE_FUNC);
+	zbx_hashset_create_ext(&es->env->scripts, 0, es_script_hash, es_script_compare, es_script_clear,
+			ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC, ZBX_DEFAULT_MEM_FREE_FUNC);
+	zbx_hashset_create_ext(&es->env->functions, 0, es_function_hash, es_function_compare, es_function_clear,
+			ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC, ZBX_DEFAULT_MEM_FREE_FUNC);
 
 	ret = SUCCEED;
 out:
@@ -463,6 +697,8 @@ int	zbx_es_destroy_env(zbx_es_t *es, char **error)
 
 	duk_destroy_heap(es->env->ctx);
 	es_objmap_destroy(&es->env->objmap);
+	zbx_hashset_destroy(&es->env->scripts);
+	zbx_hashset_destroy(&es->env->functions);
 
 	zbx_es_debug_disable(es);
 
@@ -549,13 +785,19 @@ int	zbx_es_compile(zbx_es_t *es, const char *script, char **code, int *size, cha
 		goto out;
 	}
 
+	if (SUCCEED == es_script_cache_get(es->env, script, code, size))
+	{
+		ret = SUCCEED;
+		goto out;
+	}
+
 	if (0 != setjmp(es->env->loc))
 	{
 		*error = zbx_strdup(*error, es->env->error);
 		goto out;
 	}
 
-	/* wrap the code block into a function: function(value){<code>\n} */
+	/* wrap the code block into a function: function(){return function(value){<code>\n}} */
 	len = strlen(script);
 	ptr = func = zbx_malloc(NULL, len + ZBX_CONST_STRLEN(ZBX_ES_SCRIPT_HEADER) +
 			ZBX_CONST_STRLEN(ZBX_ES_SCRIPT_FOOTER) + 1);
@@ -584,6 +826,7 @@ int	zbx_es_compile(zbx_es_t *es, const char *script, char **code, int *size, cha
 		*size = sz;
 		*code = zbx_malloc(NULL, sz);
 		memcpy(*code, buffer, sz);
+		es_script_cache_add(es->env, script, *code, *size);
 		ret = SUCCEED;
 	}
 	else
@@ -622,7 +865,6 @@ out:
 int	zbx_es_execute(zbx_es_t *es, const char *script, const char *code, int size, const char *param,
 	char **script_ret, char **error)
 {
-	void		*buffer;
 	volatile int	ret = FAIL;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() param:%s", __func__, param);
@@ -651,9 +893,7 @@ int	zbx_es_execute(zbx_es_t *es, const char *script, const char *code, int size,
 		goto out;
 	}
 
-	buffer = duk_push_fixed_buffer(es->env->ctx, size);
-	memcpy(buffer, code, size);
-	duk_load_function(es->env->ctx);
+	es_push_function(es->env, code, size);
 	duk_push_string(es->env->ctx, param);
 
 	if (DUK_EXEC_SUCCESS != duk_pcall(es->env->ctx, 1))
@@ -745,9 +985,19 @@ out:
 		zbx_json_adduint64(es->env->json, "ms", zbx_get_duration_ms(&es->env->start_time));
 	}
 
-	/* Duktape documentation recommends calling duk_gc() twice, see https://duktape.org/api#duk_gc */
-	duk_gc(es->env->ctx, 0);
-	duk_gc(es->env->ctx, 0);
+	/* Most of garbage is freed by reference counting as soon as it becomes unreachable, full garbage */
+	/* collection is needed only to free reference loops and to finalize objects holding native data, */
+	/* so it's done only when such objects exist or when memory usage grows.                          */
+	if (0 != es->env->objmap.num_data || ZBX_ES_GC_PERIOD <= ++es->env->gc_skipped ||
+			es->env->total_alloc > es->env->gc_total_alloc + ZBX_ES_GC_ALLOC_LIMIT)
+	{
+		/* Duktape documentation recommends calling duk_gc() twice, see https://duktape.org/api#duk_gc */
+		duk_gc(es->env->ctx, 0);
+		duk_gc(es->env->ctx, 0);
+
+		es->env->gc_skipped = 0;
+		es->env->gc_total_alloc = es->env->total_alloc;
+	}
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s %s allocated memory: " ZBX_FS_SIZE_T
 			" max allocated or requested memory: " ZBX_FS_SIZE_T " max allowed memory: %d",
@@ -66,6 +66,16 @@ struct zbx_es_env
 	void		*json_stringify;
 
 	zbx_hashset_t	objmap;
+
+	zbx_hashset_t	scripts;	/* compiled bytecode by script text */
+	size_t		scripts_size;
+	zbx_hashset_t	functions;	/* functions loaded into heap by bytecode */
+	size_t		functions_size;
+	duk_uarridx_t	functions_index;
+	zbx_uint64_t	cache_access;
+
+	int		gc_skipped;
+	size_t		gc_total_alloc;
 };
 
 zbx_es_env_t	*zbx_es_get_env(duk_context *ctx);
@@ -2791,7 +2791,6 @@ static int	eval_execute_function_jsonpath(const zbx_eval_context_t *ctx, const z
 	int		ret = FAIL;
 	char		*ret_value = NULL;
 	zbx_variant_t	*json_value, *path, value, *default_value = NULL;
-	zbx_jsonobj_t	obj;
 
 	if (2 > token->opt || 3 < token->opt)
 	{
@@ -2831,13 +2830,7 @@ static int	eval_execute_function_jsonpath(const zbx_eval_context_t *ctx, const z
 		}
 	}
 
-	if (FAIL == zbx_jsonobj_open(json_value->data.str, &obj))
-	{
-		*error = zbx_strdup(*error, zbx_json_strerror());
-		return ret;
-	}
-
-	if (FAIL == zbx_jsonobj_query(&obj, path->data.str, &ret_value))
+	if (FAIL == zbx_jsonpath_query_data(json_value->data.str, path->data.str, &ret_value))
 	{
 		*error = zbx_strdup(*error, zbx_json_strerror());
 		goto clean;
@@ -2860,7 +2853,6 @@ static int	eval_execute_function_jsonpath(const zbx_eval_context_t *ctx, const z
 	ret = SUCCEED;
 clean:
 	zbx_free(ret_value);
-	zbx_jsonobj_clear(&obj);
 
 	return ret;
 }
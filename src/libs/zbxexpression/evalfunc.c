@@ -1184,6 +1184,23 @@ static int	evaluate_COUNT(zbx_variant_t *value, const zbx_dc_evaluate_item_t *it
 		goto out;
 	}
 
+	if (ZBX_VALUE_SECONDS == arg1_type && OP_ANY == pdata.op && COUNT_UNIQUE != unique)
+	{
+		zbx_history_value_t	result;
+
+		if (SUCCEED == zbx_vc_get_aggregate(item->itemid, item->value_type, ZBX_VC_AGGREGATE_COUNT, arg1,
+				&ts_end, &result, &count))
+		{
+			if (count > limit)
+				count = limit;
+
+			zbx_variant_set_dbl(value, count);
+
+			ret = SUCCEED;
+			goto clean;
+		}
+	}
+
 	switch (arg1_type)
 	{
 		case ZBX_VALUE_SECONDS:
@@ -1284,7 +1301,7 @@ out:
 static int	evaluate_SUM(zbx_variant_t *value, const zbx_dc_evaluate_item_t *item, const char *parameters,
 		const zbx_timespec_t *ts, char **error)
 {
-	int				arg1, i, ret = FAIL, seconds = 0, nvalues = 0, time_shift;
+	int				arg1, i, ret = FAIL, seconds = 0, nvalues = 0, time_shift, values_num;
 	zbx_value_type_t		arg1_type;
 	zbx_vector_history_record_t	values;
 	zbx_history_value_t		result;
@@ -1327,6 +1344,15 @@ static int	evaluate_SUM(zbx_variant_t *value, const zbx_dc_evaluate_item_t *item
 			THIS_SHOULD_NEVER_HAPPEN;
 	}
 
+	if (0 != seconds && SUCCEED == zbx_vc_get_aggregate(item->itemid, item->value_type, ZBX_VC_AGGREGATE_SUM,
+			seconds, &ts_end, &result, &values_num))
+	{
+		zbx_history_value2variant(&result, item->value_type, value);
+
+		ret = SUCCEED;
+		goto out;
+	}
+
 	if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end))
 	{
 		*error = zbx_strdup(*error, "cannot get values from value cache");
@@ -1376,9 +1402,10 @@ out:
 static int	evaluate_AVG(zbx_variant_t *value, const zbx_dc_evaluate_item_t *item, const char *parameters,
 		const zbx_timespec_t *ts, char **error)
 {
-	int				arg1, ret = FAIL, i, seconds = 0, nvalues = 0, time_shift;
+	int				arg1, ret = FAIL, i, seconds = 0, nvalues = 0, time_shift, values_num;
 	zbx_value_type_t		arg1_type;
 	zbx_vector_history_record_t	values;
+	zbx_history_value_t		result;
 	zbx_timespec_t			ts_end = *ts;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
@@ -1418,6 +1445,23 @@ static int	evaluate_AVG(zbx_variant_t *value, const zbx_dc_evaluate_item_t *item
 			THIS_SHOULD_NEVER_HAPPEN;
 	}
 
+	if (0 != seconds && SUCCEED == zbx_vc_get_aggregate(item->itemid, item->value_type, ZBX_VC_AGGREGATE_AVG,
+			seconds, &ts_end, &result, &values_num))
+	{
+		if (0 != values_num)
+		{
+			zbx_variant_set_dbl(value, result.dbl);
+			ret = SUCCEED;
+		}
+		else
+		{
+			zabbix_log(LOG_LEVEL_DEBUG, "result for AVG is empty");
+			*error = zbx_strdup(*error, "not enough data");
+		}
+
+		goto out;
+	}
+
 	if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end))
 	{
 		*error = zbx_strdup(*error, "cannot get values from value cache");
@@ -1604,9 +1648,10 @@ static int	evaluate_LOGTIMESTAMP(zbx_variant_t *value, const zbx_dc_evaluate_ite
 static int	evaluate_MIN_or_MAX(zbx_variant_t *value, const zbx_dc_evaluate_item_t *item, const char *parameters,
 		const zbx_timespec_t *ts, char **error, int min_or_max)
 {
-	int				arg1, i, ret = FAIL, seconds = 0, nvalues = 0, time_shift;
+	int				arg1, i, ret = FAIL, seconds = 0, nvalues = 0, time_shift, values_num;
 	zbx_value_type_t		arg1_type;
 	zbx_vector_history_record_t	values;
+	zbx_history_value_t		result;
 	zbx_timespec_t			ts_end = *ts;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
@@ -1646,6 +1691,24 @@ static int	evaluate_MIN_or_MAX(zbx_variant_t *value, const zbx_dc_evaluate_item_
 			THIS_SHOULD_NEVER_HAPPEN;
 	}
 
+	if (0 != seconds && SUCCEED == zbx_vc_get_aggregate(item->itemid, item->value_type,
+			EVALUATE_MIN == min_or_max ? ZBX_VC_AGGREGATE_MIN : ZBX_VC_AGGREGATE_MAX, seconds, &ts_end,
+			&result, &values_num))
+	{
+		if (0 != values_num)
+		{
+			zbx_history_value2variant(&result, item->value_type, value);
+			ret = SUCCEED;
+		}
+		else
+		{
+			zabbix_log(LOG_LEVEL_DEBUG, "result for MIN or MAX is empty");
+			*error = zbx_strdup(*error, "not enough data");
+		}
+
+		goto out;
+	}
+
 	if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end))
 	{
 		*error = zbx_strdup(*error, "cannot get values from value cache");
@@ -3749,6 +3812,80 @@ int	zbx_evaluate_function(zbx_variant_t *value, const zbx_dc_evaluate_item_t *it
 
 	return ret;
 }
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get history range of item values that function is going to read   *
+ *          from value cache                                                  *
+ *                                                                            *
+ * Parameters: function  - [IN] function (for example, 'max')                 *
+ *             parameter - [IN] parameter of function                         *
+ *             ts        - [IN] starting timestamp                            *
+ *             seconds   - [OUT] time period to read                          *
+ *             count     - [OUT] number of values to read                     *
+ *             ts_end    - [OUT] period end timestamp                         *
+ *                                                                            *
+ * Return value: SUCCEED - history range was returned                         *
+ *               FAIL - function history range cannot be determined           *
+ *                                                                            *
+ * Comments: The range matches zbx_vc_get_values() parameters of function     *
+ *           evaluation and is used to prefetch item values in batches.       *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_evaluate_function_history_range(const char *function, const char *parameter, const zbx_timespec_t *ts,
+		int *seconds, int *count, zbx_timespec_t *ts_end)
+{
+	static const char	*functions[] = {"min", "max", "avg", "sum", "percentile", "count", "countunique",
+					"find", "first", "forecast", "timeleft", "kurtosis", "mad", "skewness",
+					"stddevpop", "stddevsamp", "sumofsquares", "varpop", "varsamp", "monoinc",
+					"monodec", "rate", "changecount", NULL};
+	const char		**func;
+	int			arg1 = 1, time_shift = 0, last;
+	zbx_value_type_t	arg1_type = ZBX_VALUE_NVALUES;
+
+	if (0 == (last = (0 == strcmp(function, "last"))))
+	{
+		for (func = functions; NULL != *func && 0 != strcmp(function, *func); func++)
+			;
+
+		if (NULL == *func)
+			return FAIL;
+	}
+
+	if (SUCCEED != get_function_parameter_hist_range(ts->sec, parameter, 1, &arg1, &arg1_type, &time_shift))
+		return FAIL;
+
+	switch (arg1_type)
+	{
+		case ZBX_VALUE_SECONDS:
+			if (0 != last)
+			{
+				*seconds = 0;
+				*count = 1;
+			}
+			else
+			{
+				*seconds = arg1;
+				*count = 0;
+			}
+			break;
+		case ZBX_VALUE_NVALUES:
+			*seconds = 0;
+			*count = arg1;
+			break;
+		default:
+			if (0 == last)
+				return FAIL;
+
+			*seconds = 0;
+			*count = 1;
+	}
+
+	*ts_end = *ts;
+	ts_end->sec -= time_shift;
+
+	return SUCCEED;
+}
 #undef MONOINC
 #undef MONODEC
 #undef EVALUATE_MIN
@@ -194,6 +194,53 @@ int	zbx_history_get_values(zbx_uint64_t itemid, int value_type, int start, int c
 	return ret;
 }
 
+/************************************************************************************
+ *                                                                                  *
+ * Purpose: gets values of multiple items from history storage                      *
+ *                                                                                  *
+ * Parameters:  itemids     - [IN] the itemids, sorted                              *
+ *              itemids_num - [IN] the number of itemids                            *
+ *              value_type  - [IN] the items value type                             *
+ *              start       - [IN] the period start timestamp                       *
+ *              count       - [IN] the number of values to read per item            *
+ *              end         - [IN] the period end timestamp                         *
+ *              values      - [OUT] the item history data values, a vector for      *
+ *                                  each itemid                                     *
+ *                                                                                  *
+ * Return value: SUCCEED - the history data were read successfully                  *
+ *               FAIL - otherwise                                                   *
+ *                                                                                  *
+ * Comments: This function reads values from ]<start>,<end>] interval. If count is  *
+ *           not zero, only the values of seconds holding the last <count> values   *
+ *           of each item are read by storages with batch support. Storages         *
+ *           without batch support are read item by item and return all values      *
+ *           from the interval.                                                     *
+ *                                                                                  *
+ ************************************************************************************/
+int	zbx_history_get_values_multi(const zbx_uint64_t *itemids, int itemids_num, int value_type, int start,
+		int count, int end, zbx_vector_history_record_t *values)
+{
+	int			ret = SUCCEED, i;
+	zbx_history_iface_t	*writer = &history_ifaces[value_type];
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() itemids_num:%d value_type:%d start:%d count:%d end:%d", __func__,
+			itemids_num, value_type, start, count, end);
+
+	if (NULL != writer->get_values_multi)
+	{
+		ret = writer->get_values_multi(writer, itemids, itemids_num, start, count, end, values);
+	}
+	else
+	{
+		for (i = 0; i < itemids_num && SUCCEED == ret; i++)
+			ret = writer->get_values(writer, itemids[i], start, 0, end, &values[i]);
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
+
+	return ret;
+}
+
 /************************************************************************************
  *                                                                                  *
  * Purpose: checks if the value type requires trends data calculations              *
@@ -28,6 +28,8 @@ typedef int (*zbx_history_add_values_func_t)(struct zbx_history_iface *hist, con
 		int config_history_storage_pipelines);
 typedef int (*zbx_history_get_values_func_t)(struct zbx_history_iface *hist, zbx_uint64_t itemid, int start,
 		int count, int end, zbx_vector_history_record_t *values);
+typedef int (*zbx_history_get_values_multi_func_t)(struct zbx_history_iface *hist, const zbx_uint64_t *itemids,
+		int itemids_num, int start, int count, int end, zbx_vector_history_record_t *values);
 typedef int (*zbx_history_flush_func_t)(struct zbx_history_iface *hist);
 
 typedef void (*zbx_history_func_t)(const zbx_vector_dc_history_ptr_t *);
@@ -44,6 +46,7 @@ struct zbx_history_iface
 	zbx_history_destroy_func_t	destroy;
 	zbx_history_add_values_func_t	add_values;
 	zbx_history_get_values_func_t	get_values;
+	zbx_history_get_values_multi_func_t	get_values_multi;	/* optional, NULL if not supported */
 	zbx_history_flush_func_t	flush;
 	int				config_log_slow_queries;
 };
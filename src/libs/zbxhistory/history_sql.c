@@ -160,7 +160,7 @@ static int	sql_writer_flush(void)
 
 	do
 	{
-		zbx_db_begin();
+		zbx_db_begin_pipeline();
 
 		for (i = 0; i < writer.dbinserts.values_num; i++)
 		{
@@ -342,12 +342,15 @@ static int	db_read_values_by_time(zbx_uint64_t itemid, int value_type, zbx_vecto
 	zbx_db_row_t		row;
 	zbx_vc_history_table_t	*table = &vc_history_tables[value_type];
 	time_t			time_from;
+	zbx_db_bind_t		binds[3];
+	int			binds_num = 0;
 
 	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
 			"select clock,ns,%s"
 			" from %s"
-			" where itemid=" ZBX_FS_UI64,
-			table->fields, table->name, itemid);
+			" where itemid=?",
+			table->fields, table->name);
+	zbx_db_bind_uint64(&binds[binds_num++], itemid);
 
 	time_from = end_timestamp - seconds;
 
@@ -355,7 +358,8 @@ static int	db_read_values_by_time(zbx_uint64_t itemid, int value_type, zbx_vecto
 
 	if (ZBX_JAN_2038 == end_timestamp)
 	{
-		zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, " and clock>" ZBX_FS_I64, time_from);
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, " and clock>?");
+		zbx_db_bind_int(&binds[binds_num++], (int)time_from);
 	}
 	else if (1 == seconds)
 	{
@@ -365,15 +369,17 @@ static int	db_read_values_by_time(zbx_uint64_t itemid, int value_type, zbx_vecto
 			goto out;
 		}
 
-		zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, " and clock=%d", end_timestamp);
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, " and clock=?");
+		zbx_db_bind_int(&binds[binds_num++], end_timestamp);
 	}
 	else
 	{
-		zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, " and clock>" ZBX_FS_I64 " and clock<=%d",
-				time_from, end_timestamp);
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, " and clock>? and clock<=?");
+		zbx_db_bind_int(&binds[binds_num++], (int)time_from);
+		zbx_db_bind_int(&binds[binds_num++], end_timestamp);
 	}
 
-	result = zbx_db_select("%s", sql);
+	result = zbx_db_select_prepared(sql, binds, binds_num);
 
 	zbx_free(sql);
 
@@ -428,6 +434,8 @@ static int	db_read_values_by_count(zbx_uint64_t itemid, int value_type, zbx_vect
 	zbx_db_result_t		result;
 	zbx_db_row_t		row;
 	zbx_vc_history_table_t	*table = &vc_history_tables[value_type];
+	zbx_db_bind_t		binds[4];
+	int			binds_num;
 	const int		periods[] = {SEC_PER_HOUR, 12 * SEC_PER_HOUR, SEC_PER_DAY, SEC_PER_DAY, SEC_PER_WEEK,
 					SEC_PER_MONTH, 0, -1};
 
@@ -443,22 +451,27 @@ static int	db_read_values_by_count(zbx_uint64_t itemid, int value_type, zbx_vect
 		}
 
 		sql_offset = 0;
+		binds_num = 0;
 		zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
 				"select clock,ns,%s"
 				" from %s"
-				" where itemid=" ZBX_FS_UI64
-					" and clock<=%d",
-				table->fields, table->name, itemid, clock_to);
+				" where itemid=?"
+					" and clock<=?",
+				table->fields, table->name);
+		zbx_db_bind_uint64(&binds[binds_num++], itemid);
+		zbx_db_bind_int(&binds[binds_num++], clock_to);
 
 		if (clock_from != clock_to)
 		{
 			zbx_recalc_time_period(&clock_from, ZBX_RECALC_TIME_PERIOD_HISTORY);
-			zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, " and clock>" ZBX_FS_I64, clock_from);
+			zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, " and clock>?");
+			zbx_db_bind_int(&binds[binds_num++], (int)clock_from);
 		}
 
-		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, " order by clock desc");
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, " order by clock desc limit ?");
+		zbx_db_bind_int(&binds[binds_num++], count);
 
-		result = zbx_db_select_n(sql, count);
+		result = zbx_db_select_prepared(sql, binds, binds_num);
 
 		if (NULL == result)
 			goto out;
@@ -527,30 +540,37 @@ out:
 static int	db_read_values_by_time_and_count(zbx_uint64_t itemid, int value_type,
 		zbx_vector_history_record_t *values, int seconds, int count, int end_timestamp)
 {
-	int			ret = FAIL;
+	int			ret = FAIL, binds_num = 0;
 	char			*sql = NULL;
-	size_t			sql_alloc = 0, sql_offset;
+	size_t			sql_alloc = 0, sql_offset = 0;
 	zbx_db_result_t		result;
 	zbx_db_row_t		row;
 	zbx_vc_history_table_t	*table = &vc_history_tables[value_type];
+	zbx_db_bind_t		binds[4];
 
 	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
 			"select clock,ns,%s"
 			" from %s"
-			" where itemid=" ZBX_FS_UI64,
-			table->fields, table->name, itemid);
+			" where itemid=?",
+			table->fields, table->name);
+	zbx_db_bind_uint64(&binds[binds_num++], itemid);
 
 	if (1 == seconds)
 	{
-		zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, " and clock=%d", end_timestamp);
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, " and clock=?");
+		zbx_db_bind_int(&binds[binds_num++], end_timestamp);
 	}
 	else
 	{
-		zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, " and clock>%d and clock<=%d order by clock desc",
-				end_timestamp - seconds, end_timestamp);
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, " and clock>? and clock<=? order by clock desc");
+		zbx_db_bind_int(&binds[binds_num++], end_timestamp - seconds);
+		zbx_db_bind_int(&binds[binds_num++], end_timestamp);
 	}
 
-	result = zbx_db_select_n(sql, count);
+	zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, " limit ?");
+	zbx_db_bind_int(&binds[binds_num++], count);
+
+	result = zbx_db_select_prepared(sql, binds, binds_num);
 
 	zbx_free(sql);
 
@@ -578,7 +598,7 @@ static int	db_read_values_by_time_and_count(zbx_uint64_t itemid, int value_type,
 
 	/* Drop data from the last second and read the whole second again  */
 	/* to ensure that data is cached by seconds.                       */
-	/* Because the initial select has limit option (zbx_db_select_n()) */
+	/* Because the initial select has limit option                     */
 	/* we have to perform another select to read the last second data. */
 	end_timestamp = values->values[values->values_num - 1].timestamp.sec;
 
@@ -595,6 +615,164 @@ out:
 	return ret;
 }
 
+/************************************************************************************
+ *                                                                                  *
+ * Purpose: adds time period condition of multiple items history read to SQL        *
+ *                                                                                  *
+ ************************************************************************************/
+static void	db_add_period_condition(char **sql, size_t *sql_alloc, size_t *sql_offset, zbx_db_bind_t *binds,
+		int *binds_num, int time_from, int end_timestamp)
+{
+	zbx_strcpy_alloc(sql, sql_alloc, sql_offset, " clock>?");
+	zbx_db_bind_int(&binds[(*binds_num)++], time_from);
+
+	if (ZBX_JAN_2038 != end_timestamp)
+	{
+		zbx_strcpy_alloc(sql, sql_alloc, sql_offset, " and clock<=?");
+		zbx_db_bind_int(&binds[(*binds_num)++], end_timestamp);
+	}
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Purpose: reads history data of multiple items from database                      *
+ *                                                                                  *
+ * Parameters:  itemids       - [IN] the itemids, sorted                            *
+ *              itemids_num   - [IN] the number of itemids                          *
+ *              value_type    - [IN] the value type (see ITEM_VALUE_TYPE_* defs)    *
+ *              values        - [OUT] the item history data values, a vector for    *
+ *                                    each itemid                                   *
+ *              seconds       - [IN] the time period to read                        *
+ *              count         - [IN] the number of values to read per item, 0 -     *
+ *                                   all values                                     *
+ *              end_timestamp - [IN] the value timestamp to start reading with      *
+ *                                                                                  *
+ * Return value: SUCCEED - the history data were read successfully                  *
+ *               FAIL - otherwise                                                   *
+ *                                                                                  *
+ * Comments: This function reads values with timestamps in range:                   *
+ *             end_timestamp - seconds < <value timestamp> <= end_timestamp         *
+ *           If count is not zero, the values are limited per item to the seconds   *
+ *           holding its last <count> values, so the oldest second is read whole.   *
+ *           The limit is applied by a query per item, joined with union, where     *
+ *           the oldest second is found by reading <count> values from the index.   *
+ *                                                                                  *
+ ************************************************************************************/
+static int	db_read_values_multi(const zbx_uint64_t *itemids, int itemids_num, int value_type,
+		zbx_vector_history_record_t *values, int seconds, int count, int end_timestamp)
+{
+#define ZBX_HISTORY_COUNT_BATCH_SIZE	128
+	char			*sql = NULL;
+	size_t			sql_alloc = 0, sql_offset;
+	zbx_db_result_t		result;
+	zbx_db_row_t		row;
+	zbx_vc_history_table_t	*table = &vc_history_tables[value_type];
+	time_t			time_from;
+	zbx_db_bind_t		*binds = NULL;
+	int			binds_num, batch_num, batch_max, bucket_num, i, offset, ret = SUCCEED;
+
+	time_from = end_timestamp - seconds;
+	zbx_recalc_time_period(&time_from, ZBX_RECALC_TIME_PERIOD_HISTORY);
+
+	batch_max = (0 != count ? ZBX_HISTORY_COUNT_BATCH_SIZE : ZBX_DB_LARGE_QUERY_BATCH_SIZE);
+
+	for (offset = 0; offset < itemids_num; offset += batch_num)
+	{
+		batch_num = MIN(itemids_num - offset, batch_max);
+
+		/* round the number of item identifiers up to a power of two to keep the number of */
+		/* prepared statement variants low                                                 */
+		for (bucket_num = 1; bucket_num < batch_num; bucket_num <<= 1)
+			;
+
+		binds = (zbx_db_bind_t *)zbx_realloc(binds, sizeof(zbx_db_bind_t) * (size_t)(bucket_num * 7 + 2));
+		binds_num = 0;
+		sql_offset = 0;
+
+		if (0 != count)
+		{
+			for (i = 0; i < bucket_num; i++)
+			{
+				/* the padding reads item with zero identifier, which does not exist */
+				zbx_uint64_t	itemid = (i < batch_num ? itemids[offset + i] : 0);
+
+				if (0 != i)
+					zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, " union all ");
+
+				zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
+						"select itemid,clock,ns,%s from %s where itemid=? and",
+						table->fields, table->name);
+				zbx_db_bind_uint64(&binds[binds_num++], itemid);
+				db_add_period_condition(&sql, &sql_alloc, &sql_offset, binds, &binds_num,
+						(int)time_from, end_timestamp);
+
+				/* values of the same second are read together, so the oldest second is read whole */
+				zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
+						" and clock>=coalesce((select clock from %s where itemid=? and",
+						table->name);
+				zbx_db_bind_uint64(&binds[binds_num++], itemid);
+				db_add_period_condition(&sql, &sql_alloc, &sql_offset, binds, &binds_num,
+						(int)time_from, end_timestamp);
+				zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset,
+						" order by clock desc limit 1 offset ?),0)");
+				zbx_db_bind_int(&binds[binds_num++], count - 1);
+			}
+		}
+		else
+		{
+			zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, "select itemid,clock,ns,%s from %s where",
+					table->fields, table->name);
+			db_add_period_condition(&sql, &sql_alloc, &sql_offset, binds, &binds_num, (int)time_from,
+					end_timestamp);
+			zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, " and itemid in (");
+
+			/* the padding repeats the last identifier */
+			for (i = 0; i < bucket_num; i++)
+			{
+				zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, 0 == i ? "?" : ",?");
+				zbx_db_bind_uint64(&binds[binds_num++], itemids[offset + MIN(i, batch_num - 1)]);
+			}
+
+			zbx_chrcpy_alloc(&sql, &sql_alloc, &sql_offset, ')');
+		}
+
+		if (NULL == (result = zbx_db_select_prepared(sql, binds, binds_num)))
+		{
+			ret = FAIL;
+			break;
+		}
+
+		while (NULL != (row = zbx_db_fetch(result)))
+		{
+			zbx_history_record_t	value;
+			zbx_uint64_t		itemid;
+			const zbx_uint64_t	*pitemid;
+
+			ZBX_STR2UINT64(itemid, row[0]);
+
+			if (NULL == (pitemid = (const zbx_uint64_t *)bsearch(&itemid, itemids + offset,
+					(size_t)batch_num, sizeof(zbx_uint64_t), ZBX_DEFAULT_UINT64_COMPARE_FUNC)))
+			{
+				THIS_SHOULD_NEVER_HAPPEN;
+				continue;
+			}
+
+			value.timestamp.sec = atoi(row[1]);
+			value.timestamp.ns = atoi(row[2]);
+			table->rtov(&value.value, row + 3);
+
+			zbx_vector_history_record_append_ptr(&values[pitemid - itemids], &value);
+		}
+		zbx_db_free_result(result);
+	}
+
+	zbx_free(binds);
+	zbx_free(sql);
+
+	return ret;
+#undef ZBX_HISTORY_COUNT_BATCH_SIZE
+}
+
 /******************************************************************************************************************
  *                                                                                                                *
  * history interface support                                                                                      *
@@ -643,6 +821,33 @@ static int	sql_get_values(zbx_history_iface_t *hist, zbx_uint64_t itemid, int st
 	return db_read_values_by_time_and_count(itemid, hist->value_type, values, end - start, count, end);
 }
 
+/************************************************************************************
+ *                                                                                  *
+ * Purpose: gets history data of multiple items from history storage                *
+ *                                                                                  *
+ * Parameters:  hist        - [IN] the history storage interface                    *
+ *              itemids     - [IN] the itemids, sorted                              *
+ *              itemids_num - [IN] the number of itemids                            *
+ *              start       - [IN] the period start timestamp                       *
+ *              count       - [IN] the number of values to read per item, 0 - all   *
+ *              end         - [IN] the period end timestamp                         *
+ *              values      - [OUT] the item history data values, a vector for      *
+ *                                  each itemid                                     *
+ *                                                                                  *
+ * Return value: SUCCEED - the history data were read successfully                  *
+ *               FAIL - otherwise                                                   *
+ *                                                                                  *
+ * Comments: This function reads values from ]<start>,<end>] interval, limited to   *
+ *           the seconds holding the last <count> values of each item if count is   *
+ *           not zero.                                                              *
+ *                                                                                  *
+ ************************************************************************************/
+static int	sql_get_values_multi(zbx_history_iface_t *hist, const zbx_uint64_t *itemids, int itemids_num,
+		int start, int count, int end, zbx_vector_history_record_t *values)
+{
+	return db_read_values_multi(itemids, itemids_num, hist->value_type, values, end - start, count, end);
+}
+
 /**********************************************************************************************
  *                                                                                            *
  * Purpose: sends history data to storage                                                     *
@@ -707,6 +912,7 @@ void	zbx_history_sql_init(zbx_history_iface_t *hist, unsigned char value_type)
 	hist->add_values = sql_add_values;
 	hist->flush = sql_flush;
 	hist->get_values = sql_get_values;
+	hist->get_values_multi = sql_get_values_multi;
 
 	switch (value_type)
 	{
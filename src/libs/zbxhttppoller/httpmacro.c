@@ -148,10 +148,7 @@ static int	httpmacro_append_pair(zbx_httptest_t *httptest, const char *pkey, siz
 	}
 	else if (0 == strncmp(JSONPATH_PREFIX, value_str, JSONPATH_PREFIX_SIZE))
 	{
-		zbx_jsonobj_t	obj;
-
-		if (SUCCEED == (rc = zbx_jsonobj_open(data, &obj)))
-			rc = zbx_jsonobj_query(&obj, value_str + JSONPATH_PREFIX_SIZE, (char **)&pair.second);
+		rc = zbx_jsonpath_query_data(data, value_str + JSONPATH_PREFIX_SIZE, (char **)&pair.second);
 
 		if (SUCCEED != rc)
 		{
@@ -160,7 +157,6 @@ static int	httpmacro_append_pair(zbx_httptest_t *httptest, const char *pkey, siz
 			zbx_free(pair.second);
 		}
 
-		zbx_jsonobj_clear(&obj);
 		zbx_free(value_str);
 	}
 	else if (0 == strncmp(XMLXPATH_PREFIX, value_str, XMLXPATH_PREFIX_SIZE))
@@ -0,0 +1,501 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxcommon.h"
+
+#ifdef HAVE_IPCSERVICE
+
+#include "ipcring.h"
+
+#include <sys/mman.h>
+
+#if defined(__linux__)
+#	include <sys/syscall.h>
+#	include <sys/eventfd.h>
+#	if defined(SYS_memfd_create)
+#		define ZBX_IPC_RING_SUPPORTED
+#	endif
+#endif
+
+#ifndef MFD_CLOEXEC
+#	define MFD_CLOEXEC	0x0001U
+#endif
+
+#define ZBX_IPC_RING_MIN_SIZE		(64 * ZBX_KIBIBYTE)
+#define ZBX_IPC_RING_MAX_SIZE		ZBX_GIBIBYTE
+
+#define ZBX_IPC_RING_HEADER_SIZE	(ZBX_IPC_RING_CACHELINE_SIZE * 4)
+
+/* record header - data size followed by padding to keep the data 8 byte aligned */
+#define ZBX_IPC_RING_RECORD_HEADER_SIZE	8
+#define ZBX_IPC_RING_RECORD_WRAP	0xffffffff
+
+#define ZBX_IPC_RING_ALIGN(size)	(((zbx_uint64_t)(size) + 7) & ~(zbx_uint64_t)7)
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: increments eventfd counter to wake up the other side              *
+ *                                                                            *
+ ******************************************************************************/
+static void	ipc_ring_signal(int fd)
+{
+	zbx_uint64_t	value = 1;
+
+	while (-1 == write(fd, &value, sizeof(value)))
+	{
+		if (EINTR != errno)
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "cannot signal IPC ring event: %s", zbx_strerror(errno));
+			break;
+		}
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: resets eventfd counter                                            *
+ *                                                                            *
+ ******************************************************************************/
+static void	ipc_ring_clear_signal(int fd)
+{
+	zbx_uint64_t	value;
+
+	while (-1 == read(fd, &value, sizeof(value)) && EINTR == errno)
+		;
+}
+
+static void	ipc_ring_close_fds(int *fds)
+{
+	for (int i = 0; i < ZBX_IPC_RING_FDS_NUM; i++)
+	{
+		if (-1 != fds[i])
+			close(fds[i]);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: maps ring shared memory and creates ring object                   *
+ *                                                                            *
+ * Parameters: ring     - [OUT] the created ring                              *
+ *             fds      - [IN] the ring memory and event descriptors          *
+ *             map_size - [IN] the shared memory size                         *
+ *             error    - [OUT] the error message                             *
+ *                                                                            *
+ * Return value: SUCCEED - the ring was mapped successfully                   *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	ipc_ring_map(zbx_ipc_ring_t **ring, const int *fds, size_t map_size, char **error)
+{
+	void	*addr;
+
+	if (MAP_FAILED == (addr = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+			fds[ZBX_IPC_RING_FD_MEM], 0)))
+	{
+		*error = zbx_dsprintf(*error, "cannot map IPC ring memory: %s", zbx_strerror(errno));
+		return FAIL;
+	}
+
+	*ring = (zbx_ipc_ring_t *)zbx_malloc(NULL, sizeof(zbx_ipc_ring_t));
+	memset(*ring, 0, sizeof(zbx_ipc_ring_t));
+
+	(*ring)->header = (zbx_ipc_ring_header_t *)addr;
+	(*ring)->data = (unsigned char *)addr + ZBX_IPC_RING_HEADER_SIZE;
+	(*ring)->map_size = map_size;
+	(*ring)->size = (zbx_uint32_t)(map_size - ZBX_IPC_RING_HEADER_SIZE);
+	memcpy((*ring)->fds, fds, sizeof((*ring)->fds));
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: opens ring created by another process                             *
+ *                                                                            *
+ * Parameters: ring  - [OUT] the opened ring                                  *
+ *             fds   - [IN] the ring memory and event descriptors received    *
+ *                          from the ring producer                            *
+ *             error - [OUT] the error message                                *
+ *                                                                            *
+ * Return value: SUCCEED - the ring was opened successfully                   *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: The descriptors are owned by the ring after this call and are    *
+ *           closed on failure.                                               *
+ *                                                                            *
+ ******************************************************************************/
+int	ipc_ring_open(zbx_ipc_ring_t **ring, int *fds, char **error)
+{
+	struct stat	st;
+	zbx_uint64_t	size;
+
+	if (0 != fstat(fds[ZBX_IPC_RING_FD_MEM], &st))
+	{
+		*error = zbx_dsprintf(*error, "cannot obtain IPC ring memory size: %s", zbx_strerror(errno));
+		goto fail;
+	}
+
+	size = (zbx_uint64_t)st.st_size - ZBX_IPC_RING_HEADER_SIZE;
+
+	if (ZBX_IPC_RING_HEADER_SIZE >= st.st_size || ZBX_IPC_RING_MIN_SIZE > size || ZBX_IPC_RING_MAX_SIZE < size ||
+			0 != (size & (size - 1)))
+	{
+		*error = zbx_dsprintf(*error, "invalid IPC ring memory size " ZBX_FS_UI64, (zbx_uint64_t)st.st_size);
+		goto fail;
+	}
+
+	if (SUCCEED != ipc_ring_map(ring, fds, (size_t)st.st_size, error))
+		goto fail;
+
+	if ((*ring)->header->size != (*ring)->size)
+	{
+		*error = zbx_dsprintf(*error, "IPC ring size %u does not match its memory size %u",
+				(*ring)->header->size, (*ring)->size);
+		zbx_ipc_ring_free(*ring);
+		return FAIL;
+	}
+
+	(*ring)->offset = __atomic_load_n(&(*ring)->header->head, __ATOMIC_ACQUIRE);
+	(*ring)->limit = (*ring)->offset;
+
+	return SUCCEED;
+fail:
+	ipc_ring_close_fds(fds);
+
+	return FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: resets ring doorbell before reading the records                   *
+ *                                                                            *
+ * Parameters: ring - [IN] the ring                                           *
+ *                                                                            *
+ * Comments: The records published before the doorbell reset are made         *
+ *           available for reading. Records published later will ring the     *
+ *           doorbell again.                                                  *
+ *                                                                            *
+ ******************************************************************************/
+void	ipc_ring_reset_doorbell(zbx_ipc_ring_t *ring)
+{
+	ipc_ring_clear_signal(ring->fds[ZBX_IPC_RING_FD_DOORBELL]);
+	__atomic_store_n(&ring->header->signaled, 0, __ATOMIC_SEQ_CST);
+	ring->limit = __atomic_load_n(&ring->header->tail, __ATOMIC_SEQ_CST);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: creates shared memory ring for sending data to IPC service        *
+ *                                                                            *
+ * Parameters: ring  - [OUT] the created ring                                 *
+ *             size  - [IN] the requested ring size, rounded up to power of   *
+ *                          two                                               *
+ *             error - [OUT] the error message                                *
+ *                                                                            *
+ * Return value: SUCCEED - the ring was created successfully                  *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: The ring memory is backed by anonymous memory file and the       *
+ *           service is notified about new data with eventfd doorbell, so     *
+ *           the ring can be passed to the service over IPC socket with       *
+ *           zbx_ipc_socket_send_ring().                                      *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_ipc_ring_create(zbx_ipc_ring_t **ring, zbx_uint32_t size, char **error)
+{
+#ifdef ZBX_IPC_RING_SUPPORTED
+	zbx_uint32_t	ring_size = ZBX_IPC_RING_MIN_SIZE;
+	size_t		map_size;
+	int		fds[ZBX_IPC_RING_FDS_NUM] = {-1, -1, -1};
+
+	while (ring_size < size && ZBX_IPC_RING_MAX_SIZE > ring_size)
+		ring_size <<= 1;
+
+	map_size = ZBX_IPC_RING_HEADER_SIZE + (size_t)ring_size;
+
+	if (-1 == (fds[ZBX_IPC_RING_FD_MEM] = (int)syscall(SYS_memfd_create, "zabbix_ipc_ring", MFD_CLOEXEC)))
+	{
+		*error = zbx_dsprintf(*error, "cannot create IPC ring memory: %s", zbx_strerror(errno));
+		goto fail;
+	}
+
+	if (0 != ftruncate(fds[ZBX_IPC_RING_FD_MEM], (off_t)map_size))
+	{
+		*error = zbx_dsprintf(*error, "cannot allocate IPC ring memory: %s", zbx_strerror(errno));
+		goto fail;
+	}
+
+	if (-1 == (fds[ZBX_IPC_RING_FD_DOORBELL] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) ||
+			-1 == (fds[ZBX_IPC_RING_FD_SPACE] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)))
+	{
+		*error = zbx_dsprintf(*error, "cannot create IPC ring event: %s", zbx_strerror(errno));
+		goto fail;
+	}
+
+	if (SUCCEED != ipc_ring_map(ring, fds, map_size, error))
+		goto fail;
+
+	(*ring)->header->size = ring_size;
+
+	return SUCCEED;
+fail:
+	ipc_ring_close_fds(fds);
+
+	return FAIL;
+#else
+	ZBX_UNUSED(ring);
+	ZBX_UNUSED(size);
+
+	*error = zbx_strdup(*error, "shared memory rings are not supported on this platform");
+
+	return FAIL;
+#endif
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: unmaps ring memory and releases ring resources                    *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_ipc_ring_free(zbx_ipc_ring_t *ring)
+{
+	if (0 != munmap(ring->header, ring->map_size))
+		zabbix_log(LOG_LEVEL_WARNING, "cannot unmap IPC ring memory: %s", zbx_strerror(errno));
+
+	ipc_ring_close_fds(ring->fds);
+	zbx_free(ring);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns the maximum size of a record that can be written to ring  *
+ *                                                                            *
+ ******************************************************************************/
+zbx_uint32_t	zbx_ipc_ring_max_record_size(const zbx_ipc_ring_t *ring)
+{
+	return ring->size / 2 - ZBX_IPC_RING_RECORD_HEADER_SIZE;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: notifies consumer about published records                         *
+ *                                                                            *
+ * Parameters: ring - [IN] the ring                                           *
+ *                                                                            *
+ * Comments: The doorbell is rung only if the consumer has not been notified  *
+ *           since it started reading the records.                            *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_ipc_ring_notify(zbx_ipc_ring_t *ring)
+{
+	if (0 == __atomic_exchange_n(&ring->header->signaled, 1, __ATOMIC_SEQ_CST))
+		ipc_ring_signal(ring->fds[ZBX_IPC_RING_FD_DOORBELL]);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: waits until the ring has the requested amount of free space       *
+ *                                                                            *
+ * Parameters: ring    - [IN] the ring                                        *
+ *             size    - [IN] the required free space                         *
+ *             sock_fd - [IN] the IPC socket connected to the consumer, used  *
+ *                            to detect consumer termination                  *
+ *                                                                            *
+ * Return value: SUCCEED - the space is available                             *
+ *               FAIL    - the consumer connection was closed                 *
+ *                                                                            *
+ ******************************************************************************/
+static int	ipc_ring_wait(zbx_ipc_ring_t *ring, zbx_uint64_t size, int sock_fd)
+{
+	zbx_ipc_ring_header_t	*header = ring->header;
+
+	if (ring->size - (ring->offset - __atomic_load_n(&header->head, __ATOMIC_ACQUIRE)) >= size)
+		return SUCCEED;
+
+	while (1)
+	{
+		struct pollfd	pfd[2];
+
+		__atomic_store_n(&header->writer_waiting, 1, __ATOMIC_SEQ_CST);
+
+		if (ring->size - (ring->offset - __atomic_load_n(&header->head, __ATOMIC_SEQ_CST)) >= size)
+			return SUCCEED;
+
+		/* make sure consumer is processing the published records */
+		zbx_ipc_ring_notify(ring);
+
+		pfd[0].fd = ring->fds[ZBX_IPC_RING_FD_SPACE];
+		pfd[0].events = POLLIN;
+		pfd[1].fd = sock_fd;
+		pfd[1].events = 0;
+
+		if (-1 == poll(pfd, 2, -1))
+		{
+			if (EINTR == errno)
+				continue;
+
+			zabbix_log(LOG_LEVEL_WARNING, "cannot wait for IPC ring space: %s", zbx_strerror(errno));
+			return FAIL;
+		}
+
+		if (0 != (pfd[1].revents & (POLLHUP | POLLERR | POLLNVAL)))
+			return FAIL;
+
+		if (0 != (pfd[0].revents & POLLIN))
+			ipc_ring_clear_signal(ring->fds[ZBX_IPC_RING_FD_SPACE]);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: reserves space for a record in ring                               *
+ *                                                                            *
+ * Parameters: ring    - [IN] the ring                                        *
+ *             size    - [IN] the record size, must not exceed                *
+ *                            zbx_ipc_ring_max_record_size()                  *
+ *             csocket - [IN] the IPC socket the ring was sent over           *
+ *                                                                            *
+ * Return value: The record data to write or NULL if the consumer connection  *
+ *               was closed while waiting for free space.                     *
+ *                                                                            *
+ * Comments: The record is made visible to consumer by zbx_ipc_ring_commit()  *
+ *           call. Only one record can be reserved at a time.                 *
+ *                                                                            *
+ ******************************************************************************/
+unsigned char	*zbx_ipc_ring_reserve(zbx_ipc_ring_t *ring, zbx_uint32_t size, const zbx_ipc_socket_t *csocket)
+{
+	zbx_uint64_t	pos, record_size, required;
+	zbx_uint32_t	marker;
+
+	record_size = ZBX_IPC_RING_ALIGN(ZBX_IPC_RING_RECORD_HEADER_SIZE + (zbx_uint64_t)size);
+	pos = ring->offset & (ring->size - 1);
+	required = record_size;
+
+	/* records are not split, skip the space left at the end of data area */
+	if (ring->size - pos < record_size)
+		required += ring->size - pos;
+
+	if (SUCCEED != ipc_ring_wait(ring, required, csocket->fd))
+		return NULL;
+
+	if (ring->size - pos < record_size)
+	{
+		marker = ZBX_IPC_RING_RECORD_WRAP;
+		memcpy(ring->data + pos, &marker, sizeof(marker));
+		ring->offset += ring->size - pos;
+		pos = 0;
+	}
+
+	memcpy(ring->data + pos, &size, sizeof(size));
+
+	return ring->data + pos + ZBX_IPC_RING_RECORD_HEADER_SIZE;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: publishes the reserved record                                     *
+ *                                                                            *
+ * Parameters: ring - [IN] the ring                                           *
+ *             size - [IN] the reserved record size                           *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_ipc_ring_commit(zbx_ipc_ring_t *ring, zbx_uint32_t size)
+{
+	ring->offset += ZBX_IPC_RING_ALIGN(ZBX_IPC_RING_RECORD_HEADER_SIZE + (zbx_uint64_t)size);
+	__atomic_store_n(&ring->header->tail, ring->offset, __ATOMIC_RELEASE);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: waits until consumer has processed all published records          *
+ *                                                                            *
+ * Parameters: ring    - [IN] the ring                                        *
+ *             csocket - [IN] the IPC socket the ring was sent over           *
+ *                                                                            *
+ * Return value: SUCCEED - the ring is empty                                  *
+ *               FAIL    - the consumer connection was closed                 *
+ *                                                                            *
+ * Comments: Used to preserve the data order when data that does not fit in   *
+ *           ring is sent over socket.                                        *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_ipc_ring_flush(zbx_ipc_ring_t *ring, const zbx_ipc_socket_t *csocket)
+{
+	return ipc_ring_wait(ring, ring->size, csocket->fd);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: reads the next record from ring                                   *
+ *                                                                            *
+ * Parameters: ring - [IN] the ring                                           *
+ *             size - [OUT] the record size                                   *
+ *                                                                            *
+ * Return value: The record data or NULL if there are no more records to read *
+ *                                                                            *
+ * Comments: The record data is read directly from the shared memory and      *
+ *           stays valid until zbx_ipc_ring_release() is called.              *
+ *                                                                            *
+ ******************************************************************************/
+const unsigned char	*zbx_ipc_ring_read(zbx_ipc_ring_t *ring, zbx_uint32_t *size)
+{
+	zbx_uint64_t	pos, record_size;
+	zbx_uint32_t	data_size;
+
+	while (ring->offset != ring->limit)
+	{
+		pos = ring->offset & (ring->size - 1);
+		memcpy(&data_size, ring->data + pos, sizeof(data_size));
+
+		if (ZBX_IPC_RING_RECORD_WRAP == data_size)
+		{
+			ring->offset += ring->size - pos;
+			continue;
+		}
+
+		record_size = ZBX_IPC_RING_ALIGN(ZBX_IPC_RING_RECORD_HEADER_SIZE + (zbx_uint64_t)data_size);
+
+		if (ring->size - pos < record_size || ring->limit - ring->offset < record_size)
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "invalid IPC ring record of size %u at offset " ZBX_FS_UI64
+					", discarding ring contents", data_size, ring->offset);
+			ring->offset = ring->limit;
+			break;
+		}
+
+		ring->offset += record_size;
+		*size = data_size;
+
+		return ring->data + pos + ZBX_IPC_RING_RECORD_HEADER_SIZE;
+	}
+
+	return NULL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: releases the read records, making their space available to        *
+ *          producer                                                          *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_ipc_ring_release(zbx_ipc_ring_t *ring)
+{
+	__atomic_store_n(&ring->header->head, ring->offset, __ATOMIC_SEQ_CST);
+
+	if (0 != __atomic_exchange_n(&ring->header->writer_waiting, 0, __ATOMIC_SEQ_CST))
+		ipc_ring_signal(ring->fds[ZBX_IPC_RING_FD_SPACE]);
+}
+
+#endif /* HAVE_IPCSERVICE */
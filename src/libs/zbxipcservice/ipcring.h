@@ -0,0 +1,68 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#ifndef ZABBIX_IPCRING_H
+#define ZABBIX_IPCRING_H
+
+#include "zbxipcservice.h"
+
+#define ZBX_IPC_RING_FD_MEM		0
+#define ZBX_IPC_RING_FD_DOORBELL	1
+#define ZBX_IPC_RING_FD_SPACE		2
+#define ZBX_IPC_RING_FDS_NUM		3
+
+#define ZBX_IPC_RING_CACHELINE_SIZE	64
+
+/* ring control block, placed at the beginning of the shared memory */
+typedef struct
+{
+	/* producer offset, incremented after records are written */
+	zbx_uint64_t	tail;
+	char		pad_tail[ZBX_IPC_RING_CACHELINE_SIZE - sizeof(zbx_uint64_t)];
+
+	/* consumer offset, incremented after records are processed */
+	zbx_uint64_t	head;
+	char		pad_head[ZBX_IPC_RING_CACHELINE_SIZE - sizeof(zbx_uint64_t)];
+
+	/* set by producer when ringing the doorbell, reset by consumer before reading records */
+	int		signaled;
+
+	/* set by producer when waiting for free space, reset by consumer before signaling it */
+	int		writer_waiting;
+
+	/* the data area size */
+	zbx_uint32_t	size;
+}
+zbx_ipc_ring_header_t;
+
+struct zbx_ipc_ring
+{
+	zbx_ipc_ring_header_t	*header;
+	unsigned char		*data;
+	size_t			map_size;
+	zbx_uint32_t		size;
+
+	/* producer - the local tail including unpublished records, consumer - the read position */
+	zbx_uint64_t		offset;
+
+	/* consumer - the tail snapshot the records are read up to */
+	zbx_uint64_t		limit;
+
+	int			fds[ZBX_IPC_RING_FDS_NUM];
+};
+
+int	ipc_ring_open(zbx_ipc_ring_t **ring, int *fds, char **error);
+void	ipc_ring_reset_doorbell(zbx_ipc_ring_t *ring);
+
+#endif
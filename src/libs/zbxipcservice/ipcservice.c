@@ -23,6 +23,7 @@
 #endif
 
 #include "zbxipcservice.h"
+#include "ipcring.h"
 #include "zbxalgo.h"
 #include "zbxstr.h"
 #include "zbxtime.h"
@@ -62,6 +63,11 @@ struct zbx_ipc_client
 	zbx_uint64_t		id;
 	unsigned char		state;
 
+	/* shared memory ring attached by client, see zbx_ipc_client_attach_ring() */
+	zbx_ipc_ring_t		*ring;
+	struct event		*ring_event;
+	unsigned char		ring_pending;
+
 	void			*userdata;
 
 	zbx_uint32_t		refcount;
@@ -103,6 +109,7 @@ static void	event_free(struct event *event)
 
 static void	ipc_client_read_event_cb(evutil_socket_t fd, short what, void *arg);
 static void	ipc_client_write_event_cb(evutil_socket_t fd, short what, void *arg);
+static void	ipc_client_ring_event_cb(evutil_socket_t fd, short what, void *arg);
 
 static const char	*ipc_get_path(void)
 {
@@ -208,11 +215,52 @@ static int	ipc_write_data(int fd, const unsigned char *data, zbx_uint32_t size,
 	return ret;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: stores descriptors received over socket                           *
+ *                                                                            *
+ * Parameters: csocket - [IN] the socket                                      *
+ *             msg     - [IN] the received message header                     *
+ *                                                                            *
+ * Comments: Descriptors exceeding socket descriptor buffer are closed.       *
+ *                                                                            *
+ ******************************************************************************/
+static void	ipc_socket_store_fds(zbx_ipc_socket_t *csocket, struct msghdr *msg)
+{
+	struct cmsghdr	*cmsg;
+
+	if (0 != (msg->msg_flags & MSG_CTRUNC))
+		zabbix_log(LOG_LEVEL_WARNING, "descriptors received over IPC socket were truncated");
+
+	for (cmsg = CMSG_FIRSTHDR(msg); NULL != cmsg; cmsg = CMSG_NXTHDR(msg, cmsg))
+	{
+		int	fds_num, *fds;
+
+		if (SOL_SOCKET != cmsg->cmsg_level || SCM_RIGHTS != cmsg->cmsg_type)
+			continue;
+
+		fds_num = (int)((cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int));
+		fds = (int *)CMSG_DATA(cmsg);
+
+		for (int i = 0; i < fds_num; i++)
+		{
+			if (ZBX_IPC_SOCKET_FDS_MAX == csocket->rx_fds_num)
+			{
+				zabbix_log(LOG_LEVEL_WARNING, "too many descriptors received over IPC socket");
+				close(fds[i]);
+				continue;
+			}
+
+			csocket->rx_fds[csocket->rx_fds_num++] = fds[i];
+		}
+	}
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: reads data from a socket                                          *
  *                                                                            *
- * Parameters: fd        - [IN] the socket file descriptor                    *
+ * Parameters: csocket   - [IN] the socket                                    *
  *             data      - [IN] the data                                      *
  *             size      - [IN] the data size                                 *
  *             size_sent - [IN] the actual size read from socket              *
@@ -222,15 +270,36 @@ static int	ipc_write_data(int fd, const unsigned char *data, zbx_uint32_t size,
  *                                                                            *
  * Comments: When reading data from non-blocking sockets SUCCEED will be      *
  *           returned also if there were no more data to read.                *
+ *           Descriptors passed with the data are stored in socket            *
+ *           descriptor buffer.                                               *
  *                                                                            *
  ******************************************************************************/
-static int	ipc_read_data(int fd, unsigned char *buffer, zbx_uint32_t size, zbx_uint32_t *read_size)
+static int	ipc_read_data(zbx_ipc_socket_t *csocket, unsigned char *buffer, zbx_uint32_t size,
+		zbx_uint32_t *read_size)
 {
-	int	n;
+	ssize_t		n;
+	struct iovec	iov = {buffer, size};
+	struct msghdr	msg;
+	union
+	{
+		struct cmsghdr	align;
+		char		buf[CMSG_SPACE(sizeof(int) * ZBX_IPC_SOCKET_FDS_MAX)];
+	}
+	control;
+	int		flags = 0;
 
+#ifdef MSG_CMSG_CLOEXEC
+	flags |= MSG_CMSG_CLOEXEC;
+#endif
 	*read_size = 0;
 
-	while (-1 == (n = read(fd, buffer + *read_size, size - *read_size)))
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = control.buf;
+	msg.msg_controllen = sizeof(control.buf);
+
+	while (-1 == (n = recvmsg(csocket->fd, &msg, flags)))
 	{
 		if (EINTR == errno)
 			continue;
@@ -241,10 +310,13 @@ static int	ipc_read_data(int fd, unsigned char *buffer, zbx_uint32_t size, zbx_u
 		return FAIL;
 	}
 
+	if (0 != msg.msg_controllen)
+		ipc_socket_store_fds(csocket, &msg);
+
 	if (0 == n)
 		return FAIL;
 
-	*read_size += n;
+	*read_size += (zbx_uint32_t)n;
 
 	return SUCCEED;
 }
@@ -253,7 +325,7 @@ static int	ipc_read_data(int fd, unsigned char *buffer, zbx_uint32_t size, zbx_u
  *                                                                            *
  * Purpose: reads data from a socket until the requested data has been read   *
  *                                                                            *
- * Parameters: fd        - [IN] the socket file descriptor                    *
+ * Parameters: csocket   - [IN] the socket                                    *
  *             buffer    - [IN] the data                                      *
  *             size      - [IN] the data size                                 *
  *             read_size - [IN] the actual size read from socket              *
@@ -266,7 +338,8 @@ static int	ipc_read_data(int fd, unsigned char *buffer, zbx_uint32_t size, zbx_u
  *           the requested data has been read.                                *
  *                                                                            *
  ******************************************************************************/
-static int	ipc_read_data_full(int fd, unsigned char *buffer, zbx_uint32_t size, zbx_uint32_t *read_size)
+static int	ipc_read_data_full(zbx_ipc_socket_t *csocket, unsigned char *buffer, zbx_uint32_t size,
+		zbx_uint32_t *read_size)
 {
 	int		ret = FAIL;
 	zbx_uint32_t	offset = 0, chunk_size;
@@ -275,7 +348,7 @@ static int	ipc_read_data_full(int fd, unsigned char *buffer, zbx_uint32_t size,
 
 	while (offset < size)
 	{
-		if (FAIL == ipc_read_data(fd, buffer + offset, size - offset, &chunk_size))
+		if (FAIL == ipc_read_data(csocket, buffer + offset, size - offset, &chunk_size))
 			goto out;
 
 		if (0 == chunk_size)
@@ -469,13 +542,13 @@ static int	ipc_socket_read_message(zbx_ipc_socket_t *csocket, zbx_uint32_t *head
 			/* long messages will be read directly into message buffer */
 			if (ZBX_IPC_SOCKET_BUFFER_SIZE * 0.75 < data_size)
 			{
-				ret = ipc_read_data_full(csocket->fd, *data + offset, data_size, &read_size);
+				ret = ipc_read_data_full(csocket, *data + offset, data_size, &read_size);
 				*rx_bytes += read_size;
 				goto out;
 			}
 		}
 
-		if (FAIL == ipc_read_data(csocket->fd, csocket->rx_buffer, ZBX_IPC_SOCKET_BUFFER_SIZE, &read_size))
+		if (FAIL == ipc_read_data(csocket, csocket->rx_buffer, ZBX_IPC_SOCKET_BUFFER_SIZE, &read_size))
 			goto out;
 
 		/* it's possible that nothing will be read on non-blocking sockets, return success */
@@ -517,6 +590,12 @@ static void	ipc_client_free_events(zbx_ipc_client_t *client)
 		event_free(client->tx_event);
 		client->tx_event = NULL;
 	}
+
+	if (NULL != client->ring_event)
+	{
+		event_free(client->ring_event);
+		client->ring_event = NULL;
+	}
 }
 
 /******************************************************************************
@@ -547,6 +626,9 @@ static void	ipc_client_free(zbx_ipc_client_t *client)
 
 	ipc_client_free_events(client);
 
+	if (NULL != client->ring)
+		zbx_ipc_ring_free(client->ring);
+
 	zbx_free(client);
 }
 
@@ -712,8 +794,8 @@ static zbx_ipc_client_t	*ipc_service_pop_client(zbx_ipc_service_t *service)
  *             client  - [IN] the IPC client                                  *
  *                                                                            *
  * Comments: The client is pushed to the recv queue if it isn't already there *
- *           and there is messages to return or the client connection was     *
- *           closed.                                                          *
+ *           and there is messages to return, its shared memory ring has      *
+ *           new data or the client connection was closed.                    *
  *                                                                            *
  ******************************************************************************/
 static void	ipc_service_push_client(zbx_ipc_service_t *service, zbx_ipc_client_t *client)
@@ -721,7 +803,7 @@ static void	ipc_service_push_client(zbx_ipc_service_t *service, zbx_ipc_client_t
 	if (ZBX_IPC_CLIENT_STATE_QUEUED == client->state)
 		return;
 
-	if (0 == zbx_queue_ptr_values_num(&client->rx_queue) && NULL != client->rx_event)
+	if (0 == zbx_queue_ptr_values_num(&client->rx_queue) && NULL != client->rx_event && 0 == client->ring_pending)
 		return;
 
 	client->state = ZBX_IPC_CLIENT_STATE_QUEUED;
@@ -837,11 +919,33 @@ static void	ipc_client_read_event_cb(evutil_socket_t fd, short what, void *arg)
 	{
 		ipc_client_free_events(client);
 		ipc_service_remove_client(client->service, client);
+
+		/* make the data left in ring available for reading before the client is released */
+		if (NULL != client->ring)
+			ipc_ring_reset_doorbell(client->ring);
 	}
 
 	ipc_service_push_client(client->service, client);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: service client shared memory ring doorbell libevent callback      *
+ *                                                                            *
+ ******************************************************************************/
+static void	ipc_client_ring_event_cb(evutil_socket_t fd, short what, void *arg)
+{
+	zbx_ipc_client_t	*client = (zbx_ipc_client_t *)arg;
+
+	ZBX_UNUSED(fd);
+	ZBX_UNUSED(what);
+
+	ipc_ring_reset_doorbell(client->ring);
+	client->ring_pending = 1;
+
+	ipc_service_push_client(client->service, client);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: service client write event libevent callback                      *
@@ -1139,6 +1243,7 @@ int	zbx_ipc_socket_open(zbx_ipc_socket_t *csocket, const char *service_name, int
 
 	csocket->rx_buffer_bytes = 0;
 	csocket->rx_buffer_offset = 0;
+	csocket->rx_fds_num = 0;
 
 	ret = SUCCEED;
 out:
@@ -1163,6 +1268,11 @@ void	zbx_ipc_socket_close(zbx_ipc_socket_t *csocket)
 		csocket->fd = -1;
 	}
 
+	for (int i = 0; i < csocket->rx_fds_num; i++)
+		close(csocket->rx_fds[i]);
+
+	csocket->rx_fds_num = 0;
+
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
@@ -1267,6 +1377,77 @@ int	zbx_ipc_socket_connected(const zbx_ipc_socket_t *csocket)
 	return 0 < csocket->fd ? SUCCEED : FAIL;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: sends shared memory ring to IPC service                           *
+ *                                                                            *
+ * Parameters: csocket - [IN] an opened IPC socket to the service             *
+ *             code    - [IN] the message code                                *
+ *             ring    - [IN] the ring to send                                *
+ *                                                                            *
+ * Return value: SUCCEED - the ring was sent successfully                     *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: The ring memory and event descriptors are passed as ancillary    *
+ *           data of an empty message with the specified code. The service    *
+ *           attaches the ring to its client with                             *
+ *           zbx_ipc_client_attach_ring() when processing the message.        *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_ipc_socket_send_ring(zbx_ipc_socket_t *csocket, zbx_uint32_t code, const zbx_ipc_ring_t *ring)
+{
+	zbx_uint32_t	header[2] = {code, 0}, size_sent;
+	struct iovec	iov = {header, ZBX_IPC_HEADER_SIZE};
+	struct msghdr	msg;
+	struct cmsghdr	*cmsg;
+	union
+	{
+		struct cmsghdr	align;
+		char		buf[CMSG_SPACE(sizeof(int) * ZBX_IPC_RING_FDS_NUM)];
+	}
+	control;
+	ssize_t		n;
+	int		ret = FAIL;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+
+	memset(&msg, 0, sizeof(msg));
+	memset(&control, 0, sizeof(control));
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = control.buf;
+	msg.msg_controllen = sizeof(control.buf);
+
+	cmsg = CMSG_FIRSTHDR(&msg);
+	cmsg->cmsg_level = SOL_SOCKET;
+	cmsg->cmsg_type = SCM_RIGHTS;
+	cmsg->cmsg_len = CMSG_LEN(sizeof(int) * ZBX_IPC_RING_FDS_NUM);
+	memcpy(CMSG_DATA(cmsg), ring->fds, sizeof(int) * ZBX_IPC_RING_FDS_NUM);
+
+	while (-1 == (n = sendmsg(csocket->fd, &msg, 0)))
+	{
+		if (EINTR != errno)
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "cannot send IPC ring: %s", zbx_strerror(errno));
+			goto out;
+		}
+	}
+
+	/* descriptors are passed with the first byte, the rest of header can be written normally */
+	if (ZBX_IPC_HEADER_SIZE != n && (SUCCEED != ipc_write_data(csocket->fd, (unsigned char *)header + n,
+			(zbx_uint32_t)(ZBX_IPC_HEADER_SIZE - n), &size_sent) ||
+			(zbx_uint32_t)(ZBX_IPC_HEADER_SIZE - n) != size_sent))
+	{
+		goto out;
+	}
+
+	ret = SUCCEED;
+out:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
+
+	return ret;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: frees the resources allocated to store IPC message data           *
@@ -1585,7 +1766,8 @@ void	zbx_ipc_service_close(zbx_ipc_service_t *service)
  *                             The client must be released by caller with     *
  *                             zbx_ipc_client_release() function.             *
  *             message - [OUT] the received message or NULL if the client     *
- *                             connection was closed.                         *
+ *                             connection was closed or new data was          *
+ *                             written to the client shared memory ring.      *
  *                             The message must be freed by caller with       *
  *                             ipc_message_free() function.                   *
  *                                                                            *
@@ -1635,6 +1817,11 @@ int	zbx_ipc_service_recv(zbx_ipc_service_t *service, const zbx_timespec_t *timeo
 			ipc_service_push_client(service, *client);
 			zbx_ipc_client_addref(*client);
 		}
+		else if (0 != (*client)->ring_pending && NULL != (*client)->rx_event)
+		{
+			(*client)->ring_pending = 0;
+			zbx_ipc_client_addref(*client);
+		}
 
 		ret = (EVLOOP_NONBLOCK == flags ? ZBX_IPC_RECV_IMMEDIATE : ZBX_IPC_RECV_WAIT);
 	}
@@ -1768,6 +1955,64 @@ void	*zbx_ipc_client_get_userdata(zbx_ipc_client_t *client)
 	return client->userdata;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: attaches shared memory ring received from client                  *
+ *                                                                            *
+ * Parameters: client - [IN] the IPC client                                   *
+ *             error  - [OUT] the error message                               *
+ *                                                                            *
+ * Return value: SUCCEED - the ring was attached successfully                 *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: Must be called when processing the message sent by               *
+ *           zbx_ipc_socket_send_ring(). Afterwards the client is returned by *
+ *           zbx_ipc_service_recv() without message when the ring doorbell is *
+ *           rung and the ring records can be read with zbx_ipc_ring_read().  *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_ipc_client_attach_ring(zbx_ipc_client_t *client, char **error)
+{
+	zbx_ipc_socket_t	*csocket = &client->csocket;
+	int			ret;
+
+	if (NULL != client->ring)
+	{
+		*error = zbx_strdup(*error, "shared memory ring is already attached");
+		return FAIL;
+	}
+
+	if (ZBX_IPC_RING_FDS_NUM != csocket->rx_fds_num)
+	{
+		*error = zbx_dsprintf(*error, "expected %d ring descriptors but received %d", ZBX_IPC_RING_FDS_NUM,
+				csocket->rx_fds_num);
+
+		for (int i = 0; i < csocket->rx_fds_num; i++)
+			close(csocket->rx_fds[i]);
+
+		csocket->rx_fds_num = 0;
+
+		return FAIL;
+	}
+
+	ret = ipc_ring_open(&client->ring, csocket->rx_fds, error);
+	csocket->rx_fds_num = 0;
+
+	if (SUCCEED != ret)
+		return FAIL;
+
+	client->ring_event = event_new(client->service->ev, client->ring->fds[ZBX_IPC_RING_FD_DOORBELL],
+			EV_READ | EV_PERSIST, ipc_client_ring_event_cb, (void *)client);
+	event_add(client->ring_event, NULL);
+
+	return SUCCEED;
+}
+
+zbx_ipc_ring_t	*zbx_ipc_client_get_ring(zbx_ipc_client_t *client)
+{
+	return client->ring;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: opens asynchronous socket to IPC service client                   *
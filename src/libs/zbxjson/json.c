@@ -17,6 +17,7 @@
 #include "zbxjson.h"
 #include "json_parser.h"
 #include "jsonpath.h"
+#include "json_scan.h"
 
 #include "zbxnum.h"
 
@@ -604,7 +605,7 @@ static const char	*__zbx_json_rbracket(const char *p)
 
 	rbracket = ('{' == lbracket ? '}' : ']');
 
-	while ('\0' != *p)
+	while ('\0' != *(p = (0 == state ? json_scan_structural(p) : json_scan_string(p))))
 	{
 		switch (*p)
 		{
@@ -704,7 +705,7 @@ const char	*zbx_json_next(const struct zbx_json_parse *jp, const char *p)
 		return p;
 	}
 
-	while (p <= jp->end)
+	while ((p = (0 == state ? json_scan_structural(p) : json_scan_string(p))) <= jp->end)
 	{
 		switch (*p)
 		{
@@ -935,6 +936,7 @@ const char	*json_copy_string(const char *p, char *out, size_t size)
 	{
 		unsigned int	nbytes, i;
 		unsigned char	uc[4];	/* decoded Unicode character takes 1-4 bytes in UTF-8 */
+		size_t		len;
 
 		switch (*p)
 		{
@@ -954,7 +956,11 @@ const char	*json_copy_string(const char *p, char *out, size_t size)
 				*out = '\0';
 				return ++p;
 			default:
-				*out++ = *p++;
+				/* copy characters up to the next quote or escape sequence at once */
+				len = MIN((size_t)(json_scan_string(p + 1) - p), size - (size_t)(out - start));
+				memcpy(out, p, len);
+				out += len;
+				p += len;
 		}
 
 		if ((size_t)(out - start) == size)
@@ -17,8 +17,9 @@
 
 #include "zbxstr.h"
 
+/* matches ZBX_WHITESPACE without calling strchr() for every character */
 #define SKIP_WHITESPACE(src)	\
-	while ('\0' != *(src) && NULL != strchr(ZBX_WHITESPACE, *(src))) (src)++
+	while (' ' == *(src) || '\t' == *(src) || '\r' == *(src) || '\n' == *(src)) (src)++
 
 /* can only be used on non empty string */
 #define SKIP_WHITESPACE_NEXT(src)\
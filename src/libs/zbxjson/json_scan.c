@@ -0,0 +1,215 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "json_scan.h"
+
+#include "zbxcommon.h"
+
+/* Vector scanning reads whole aligned blocks, possibly past the terminating zero. Aligned blocks */
+/* never cross page boundary so it is safe, but it is reported by address sanitizer.              */
+#if defined(__has_feature)
+#	if __has_feature(address_sanitizer)
+#		define JSON_SCAN_SCALAR
+#	endif
+#endif
+
+#if defined(__GNUC__) && !defined(__SANITIZE_ADDRESS__) && !defined(JSON_SCAN_SCALAR)
+#	if defined(__AVX2__)
+#		include <immintrin.h>
+#		define JSON_SCAN_AVX2
+#		define JSON_SCAN_BLOCK_SIZE	32
+#		define JSON_SCAN_BYTE_BITS	1
+#	elif defined(__SSE2__)
+#		include <emmintrin.h>
+#		define JSON_SCAN_SSE2
+#		define JSON_SCAN_BLOCK_SIZE	16
+#		define JSON_SCAN_BYTE_BITS	1
+#	elif defined(__aarch64__) && defined(__ARM_NEON) && defined(__BYTE_ORDER__) && \
+		__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#		include <arm_neon.h>
+#		define JSON_SCAN_NEON
+#		define JSON_SCAN_BLOCK_SIZE	16
+#		define JSON_SCAN_BYTE_BITS	4
+#	endif
+#endif
+
+#define JSON_SCAN_STRING	0
+#define JSON_SCAN_STRUCTURAL	1
+
+#if defined(JSON_SCAN_BLOCK_SIZE)
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: finds characters of interest in aligned block                     *
+ *                                                                            *
+ * Parameters: block - [IN] block aligned to JSON_SCAN_BLOCK_SIZE             *
+ *             type  - [IN] JSON_SCAN_STRING - '"', '\\' and control          *
+ *                          characters, including terminating zero            *
+ *                          JSON_SCAN_STRUCTURAL - '"', '\\', brackets, ','   *
+ *                          and terminating zero                              *
+ *                                                                            *
+ * Return value: mask with JSON_SCAN_BYTE_BITS bits set for every matching    *
+ *               byte, the first byte in the lowest bits                      *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_uint64_t	json_scan_block(const char *block, int type)
+{
+#if defined(JSON_SCAN_AVX2)
+	__m256i	v, m;
+
+	v = _mm256_load_si256((const __m256i *)block);
+	m = _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\')));
+
+	if (JSON_SCAN_STRING == type)
+	{
+		m = _mm256_or_si256(m, _mm256_cmpeq_epi8(_mm256_min_epu8(v, _mm256_set1_epi8(0x1f)), v));
+	}
+	else
+	{
+		__m256i	lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+
+		/* '[' and ']' differ from '{' and '}' only by 0x20 bit */
+		m = _mm256_or_si256(m, _mm256_cmpeq_epi8(lower, _mm256_set1_epi8('{')));
+		m = _mm256_or_si256(m, _mm256_cmpeq_epi8(lower, _mm256_set1_epi8('}')));
+		m = _mm256_or_si256(m, _mm256_cmpeq_epi8(v, _mm256_set1_epi8(',')));
+		m = _mm256_or_si256(m, _mm256_cmpeq_epi8(v, _mm256_setzero_si256()));
+	}
+
+	return (unsigned int)_mm256_movemask_epi8(m);
+#elif defined(JSON_SCAN_SSE2)
+	__m128i	v, m;
+
+	v = _mm_load_si128((const __m128i *)block);
+	m = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\\')));
+
+	if (JSON_SCAN_STRING == type)
+	{
+		m = _mm_or_si128(m, _mm_cmpeq_epi8(_mm_min_epu8(v, _mm_set1_epi8(0x1f)), v));
+	}
+	else
+	{
+		__m128i	lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+
+		/* '[' and ']' differ from '{' and '}' only by 0x20 bit */
+		m = _mm_or_si128(m, _mm_cmpeq_epi8(lower, _mm_set1_epi8('{')));
+		m = _mm_or_si128(m, _mm_cmpeq_epi8(lower, _mm_set1_epi8('}')));
+		m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8(',')));
+		m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_setzero_si128()));
+	}
+
+	return (unsigned int)_mm_movemask_epi8(m);
+#elif defined(JSON_SCAN_NEON)
+	uint8x16_t	v, m;
+
+	v = vld1q_u8((const uint8_t *)block);
+	m = vorrq_u8(vceqq_u8(v, vdupq_n_u8('"')), vceqq_u8(v, vdupq_n_u8('\\')));
+
+	if (JSON_SCAN_STRING == type)
+	{
+		m = vorrq_u8(m, vcleq_u8(v, vdupq_n_u8(0x1f)));
+	}
+	else
+	{
+		uint8x16_t	lower = vorrq_u8(v, vdupq_n_u8(0x20));
+
+		/* '[' and ']' differ from '{' and '}' only by 0x20 bit */
+		m = vorrq_u8(m, vceqq_u8(lower, vdupq_n_u8('{')));
+		m = vorrq_u8(m, vceqq_u8(lower, vdupq_n_u8('}')));
+		m = vorrq_u8(m, vceqq_u8(v, vdupq_n_u8(',')));
+		m = vorrq_u8(m, vceqq_u8(v, vdupq_n_u8(0)));
+	}
+
+	/* narrow each byte of comparison result to 4 bits */
+	return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(m), 4)), 0);
+#endif
+}
+
+#endif
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: skips characters not matching the scan type                       *
+ *                                                                            *
+ * Parameters: p    - [IN] zero terminated string                             *
+ *             type - [IN] JSON_SCAN_STRING or JSON_SCAN_STRUCTURAL           *
+ *                                                                            *
+ * Return value: pointer to the first matching character                      *
+ *                                                                            *
+ * Comments: With vector instructions available the input is processed in     *
+ *           aligned blocks, skipping ordinary data without branching on      *
+ *           every byte.                                                      *
+ *                                                                            *
+ ******************************************************************************/
+static const char	*json_scan(const char *p, int type)
+{
+#if defined(JSON_SCAN_BLOCK_SIZE)
+	const char	*block;
+	zbx_uint64_t	mask;
+
+	block = (const char *)((uintptr_t)p & ~(uintptr_t)(JSON_SCAN_BLOCK_SIZE - 1));
+	mask = json_scan_block(block, type) & (~__UINT64_C(0) << ((p - block) * JSON_SCAN_BYTE_BITS));
+
+	while (0 == mask)
+	{
+		block += JSON_SCAN_BLOCK_SIZE;
+		mask = json_scan_block(block, type);
+	}
+
+	return block + __builtin_ctzll(mask) / JSON_SCAN_BYTE_BITS;
+#else
+	if (JSON_SCAN_STRING == type)
+	{
+		while ('"' != *p && '\\' != *p && 0x1f < (unsigned char)*p)
+			p++;
+	}
+	else
+	{
+		/* strchr() matches the terminating zero too */
+		while (NULL == strchr("\"\\[]{},", *p))
+			p++;
+	}
+
+	return p;
+#endif
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: skips JSON string characters not requiring special processing     *
+ *                                                                            *
+ * Parameters: p - [IN] position inside JSON string                           *
+ *                                                                            *
+ * Return value: pointer to the first '"', '\\' or control character,         *
+ *               including terminating zero                                   *
+ *                                                                            *
+ ******************************************************************************/
+const char	*json_scan_string(const char *p)
+{
+	return json_scan(p, JSON_SCAN_STRING);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: skips JSON data outside strings not affecting its structure       *
+ *                                                                            *
+ * Parameters: p - [IN] position outside JSON string                          *
+ *                                                                            *
+ * Return value: pointer to the first '"', '\\', '[', ']', '{', '}', ',' or   *
+ *               terminating zero                                             *
+ *                                                                            *
+ ******************************************************************************/
+const char	*json_scan_structural(const char *p)
+{
+	return json_scan(p, JSON_SCAN_STRUCTURAL);
+}
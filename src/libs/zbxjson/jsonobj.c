@@ -259,8 +259,11 @@ int	zbx_jsonobj_to_string(char **str, size_t *str_alloc, size_t *str_offset, con
  *                                                                            *
  * Purpose: parses json formatted data into json object structure             *
  *                                                                            *
+ * Parameters: data - [IN] json data                                          *
+ *             obj  - [OUT] json object (can be NULL to only validate data)   *
+ *                                                                            *
  ******************************************************************************/
-int	zbx_jsonobj_open(const char *data, zbx_jsonobj_t *obj)
+static int	jsonobj_parse(const char *data, zbx_jsonobj_t *obj)
 {
 	zbx_int64_t	offset;
 	int		ret = FAIL;
@@ -280,7 +283,9 @@ int	zbx_jsonobj_open(const char *data, zbx_jsonobj_t *obj)
 			break;
 		default:
 			/* not json data, failing */
-			jsonobj_init(obj, ZBX_JSON_TYPE_UNKNOWN);
+			if (NULL != obj)
+				jsonobj_init(obj, ZBX_JSON_TYPE_UNKNOWN);
+
 			(void)json_error("invalid object format, expected opening character '{' or '['", data, &error);
 			goto out;
 	}
@@ -295,7 +300,9 @@ int	zbx_jsonobj_open(const char *data, zbx_jsonobj_t *obj)
 out:
 	if (FAIL == ret)
 	{
-		zbx_jsonobj_clear(obj);
+		if (NULL != obj)
+			zbx_jsonobj_clear(obj);
+
 		zbx_set_json_strerror("%s", error);
 		zbx_free(error);
 	}
@@ -303,6 +310,27 @@ out:
 	return ret;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: parses json formatted data into json object structure             *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_jsonobj_open(const char *data, zbx_jsonobj_t *obj)
+{
+	return jsonobj_parse(data, obj);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: validates json formatted data the same way as zbx_jsonobj_open()  *
+ *          without building json object structure                            *
+ *                                                                            *
+ ******************************************************************************/
+int	jsonobj_validate(const char *data)
+{
+	return jsonobj_parse(data, NULL);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: free resources allocated by json object reference                 *
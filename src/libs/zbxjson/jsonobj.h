@@ -42,4 +42,6 @@ void	jsonobj_set_null(zbx_jsonobj_t *obj);
 
 void	jsonobj_clear_ref_vector(zbx_vector_jsonobj_ref_t *refs);
 
+int	jsonobj_validate(const char *data);
+
 #endif
@@ -15,6 +15,7 @@
 #include "jsonpath.h"
 
 #include "json.h"
+#include "json_parser.h"
 
 #include "zbxregexp.h"
 #include "zbxvariant.h"
@@ -2827,11 +2828,217 @@ int	zbx_jsonpath_compile(const char *path, zbx_jsonpath_t *jsonpath)
 	return ret;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: check if jsonpath is a chain of single name or index segments     *
+ *                                                                            *
+ * Parameters: jsonpath - [IN] the compiled jsonpath                          *
+ *                                                                            *
+ * Return value: SUCCEED - the jsonpath can match only one location, which    *
+ *                         can be found without backtracking                  *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	jsonpath_is_chain(const zbx_jsonpath_t *jsonpath)
+{
+	int	i;
+
+	for (i = 0; i < jsonpath->segments_num; i++)
+	{
+		const zbx_jsonpath_segment_t	*segment = &jsonpath->segments[i];
+
+		if (ZBX_JSONPATH_SEGMENT_MATCH_LIST != segment->type || 0 != segment->detached ||
+				NULL != segment->data.list.values->next)
+		{
+			return FAIL;
+		}
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: find json object matching jsonpath chain                          *
+ *                                                                            *
+ * Parameters: obj      - [IN] the json object                                *
+ *             jsonpath - [IN] the jsonpath chain                             *
+ *                                                                            *
+ * Return value: the matching object or NULL if jsonpath does not match       *
+ *                                                                            *
+ ******************************************************************************/
+static const zbx_jsonobj_t	*jsonpath_chain_find_obj(const zbx_jsonobj_t *obj, const zbx_jsonpath_t *jsonpath)
+{
+	int	i, index;
+
+	for (i = 0; i < jsonpath->segments_num && NULL != obj; i++)
+	{
+		const zbx_jsonpath_list_t	*list = &jsonpath->segments[i].data.list;
+
+		if (ZBX_JSONPATH_LIST_NAME == list->type)
+		{
+			obj = zbx_jsonobj_get_value(obj, list->values->data);
+			continue;
+		}
+
+		if (ZBX_JSON_TYPE_ARRAY != obj->type)
+			return NULL;
+
+		memcpy(&index, list->values->data, sizeof(index));
+
+		if (0 > index)
+			index += obj->data.array.values_num;
+
+		if (0 > index || index >= obj->data.array.values_num)
+			return NULL;
+
+		obj = obj->data.array.values[index];
+	}
+
+	return obj;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: find json value matching jsonpath chain in json data              *
+ *                                                                            *
+ * Parameters: data     - [IN] the valid json data                            *
+ *             jsonpath - [IN] the jsonpath chain                             *
+ *                                                                            *
+ * Return value: the matching value or NULL if jsonpath does not match        *
+ *                                                                            *
+ * Comments: Only the containers on the path are scanned, the rest of data    *
+ *           is skipped without parsing.                                      *
+ *                                                                            *
+ ******************************************************************************/
+static const char	*jsonpath_chain_find_data(const char *data, const zbx_jsonpath_t *jsonpath)
+{
+	const char	*ptr = data;
+	char		*name = NULL;
+	size_t		name_alloc = 0;
+	int		i;
+
+	for (i = 0; i < jsonpath->segments_num && NULL != ptr; i++)
+	{
+		const zbx_jsonpath_list_t	*list = &jsonpath->segments[i].data.list;
+		struct zbx_json_parse		jp;
+		const char			*p = NULL, *value = NULL;
+		int				index;
+
+		SKIP_WHITESPACE(ptr);
+
+		if (SUCCEED != zbx_json_brackets_open(ptr, &jp))
+		{
+			ptr = NULL;
+			break;
+		}
+
+		if (ZBX_JSONPATH_LIST_NAME == list->type)
+		{
+			if ('{' != *ptr)
+			{
+				ptr = NULL;
+				break;
+			}
+
+			/* the last of duplicate names is used, the same as when parsing into json object */
+			while (NULL != (p = zbx_json_next(&jp, p)) && '"' == *p)
+			{
+				const char	*next;
+
+				if (NULL == (next = zbx_json_decodevalue_dyn(p, &name, &name_alloc, NULL)))
+					break;
+
+				if (0 == strcmp(name, list->values->data))
+				{
+					SKIP_WHITESPACE(next);
+					value = next + 1;
+				}
+			}
+		}
+		else
+		{
+			if ('[' != *ptr)
+			{
+				ptr = NULL;
+				break;
+			}
+
+			memcpy(&index, list->values->data, sizeof(index));
+
+			if (0 > index)
+			{
+				while (NULL != (p = zbx_json_next(&jp, p)) && ']' != *p)
+					index++;
+
+				p = NULL;
+			}
+
+			while (0 <= index && NULL != (p = zbx_json_next(&jp, p)) && ']' != *p)
+			{
+				if (0 == index--)
+					value = p;
+			}
+		}
+
+		ptr = value;
+	}
+
+	zbx_free(name);
+
+	return ptr;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: perform jsonpath chain query on json data without parsing it into *
+ *          json object                                                       *
+ *                                                                            *
+ * Parameters: data     - [IN] the json data                                  *
+ *             jsonpath - [IN] the jsonpath chain                             *
+ *             output   - [OUT] the output value                              *
+ *                                                                            *
+ * Return value: SUCCEED - the query was performed successfully (empty result *
+ *                         being counted as successful query)                 *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	jsonpath_query_chain_data(const char *data, const zbx_jsonpath_t *jsonpath, char **output)
+{
+	const char	*ptr;
+	zbx_jsonobj_t	obj;
+	size_t		output_alloc = 0, output_offset = 0;
+	int		ret;
+
+	/* data is validated to fail with the same errors as zbx_jsonobj_open(), so the whole */
+	/* document is scanned even if the matched value is found at its beginning           */
+	if (SUCCEED != jsonobj_validate(data))
+		return FAIL;
+
+	if (NULL == (ptr = jsonpath_chain_find_data(data, jsonpath)))
+		return SUCCEED;
+
+	/* only the matched value is parsed to format it the same way as json object query */
+	jsonobj_init(&obj, ZBX_JSON_TYPE_UNKNOWN);
+
+	if (0 == json_parse_value(ptr, &obj, 0, NULL))
+	{
+		THIS_SHOULD_NEVER_HAPPEN;
+		ret = FAIL;
+	}
+	else
+		ret = jsonpath_str_copy_value(output, &output_alloc, &output_offset, &obj);
+
+	zbx_jsonobj_clear(&obj);
+
+	return ret;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: perform jsonpath query on the specified json data                 *
  *                                                                            *
- * Parameters: jp     - [IN] the json data                                    *
+ * Parameters: data   - [IN] the json data                                    *
  *             path   - [IN] the jsonpath                                     *
  *             output - [OUT] the output value                                *
  *                                                                            *
@@ -2839,25 +3046,67 @@ int	zbx_jsonpath_compile(const char *path, zbx_jsonpath_t *jsonpath)
  *                         being counted as successful query)                 *
  *               FAIL    - otherwise                                          *
  *                                                                            *
- * Comments: This function is for compatibility purposes. Where possible the  *
- *           zbx_jsonobj_query() function must be used.                       *
+ * Comments: Definite paths of names and indexes are matched by scanning the  *
+ *           json data, other paths are queried from the json data parsed     *
+ *           into json object.                                                *
  *                                                                            *
  ******************************************************************************/
-int	zbx_jsonpath_query(const struct zbx_json_parse *jp, const char *path, char **output)
+int	zbx_jsonpath_query_data(const char *data, const char *path, char **output)
 {
 	int		ret;
 	zbx_jsonobj_t	obj;
+	zbx_jsonpath_t	jsonpath;
 
-	if (SUCCEED != zbx_jsonobj_open(jp->start, &obj))
-		return FAIL;
+	if (SUCCEED != zbx_jsonpath_compile(path, &jsonpath))
+	{
+		/* json data errors are reported before jsonpath errors */
+		if (SUCCEED == zbx_jsonobj_open(data, &obj))
+		{
+			ret = zbx_jsonobj_query(&obj, path, output);
+			zbx_jsonobj_clear(&obj);
+		}
+		else
+			ret = FAIL;
 
-	ret = zbx_jsonobj_query(&obj, path, output);
+		return ret;
+	}
 
-	zbx_jsonobj_clear(&obj);
+	if (SUCCEED == jsonpath_is_chain(&jsonpath))
+	{
+		ret = jsonpath_query_chain_data(data, &jsonpath, output);
+	}
+	else if (SUCCEED == (ret = zbx_jsonobj_open(data, &obj)))
+	{
+		ret = zbx_jsonobj_query_path(&obj, &jsonpath, output);
+		zbx_jsonobj_clear(&obj);
+	}
+
+	zbx_jsonpath_clear(&jsonpath);
 
 	return ret;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: perform jsonpath query on the specified json data                 *
+ *                                                                            *
+ * Parameters: jp     - [IN] the json data                                    *
+ *             path   - [IN] the jsonpath                                     *
+ *             output - [OUT] the output value                                *
+ *                                                                            *
+ * Return value: SUCCEED - the query was performed successfully (empty result *
+ *                         being counted as successful query)                 *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: This function is for compatibility purposes. Where possible the  *
+ *           zbx_jsonpath_query_data() function must be used.                 *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_jsonpath_query(const struct zbx_json_parse *jp, const char *path, char **output)
+{
+	return zbx_jsonpath_query_data(jp->start, path, output);
+}
+
 static void	jsonpath_ctx_clear(zbx_jsonpath_context_t *ctx)
 {
 	jsonobj_clear_ref_vector(&ctx->objects);
@@ -2866,30 +3115,37 @@ static void	jsonpath_ctx_clear(zbx_jsonpath_context_t *ctx)
 
 /******************************************************************************
  *                                                                            *
- * Purpose: perform jsonpath query on the specified json object               *
+ * Purpose: perform compiled jsonpath query on the specified json object      *
  *                                                                            *
- * Parameters: obj    - [IN] json object                                      *
- *             index  - [IN] jsonpath index (optional)                        *
- *             path   - [IN] jsonpath                                         *
- *             output - [OUT] output value                                    *
+ * Parameters: obj      - [IN] json object                                    *
+ *             index    - [IN] jsonpath index (optional)                      *
+ *             jsonpath - [IN] compiled jsonpath                              *
+ *             output   - [OUT] output value                                  *
  *                                                                            *
  * Return value: SUCCEED - the query was performed successfully (empty result *
  *                         being counted as successful query)                 *
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-int	zbx_jsonobj_query_ext(const zbx_jsonobj_t *obj, zbx_jsonpath_index_t *index, const char *path, char **output)
+static int	jsonpath_query_obj(const zbx_jsonobj_t *obj, zbx_jsonpath_index_t *index, zbx_jsonpath_t *jsonpath,
+		char **output)
 {
 	zbx_jsonpath_context_t	ctx;
-	zbx_jsonpath_t		jsonpath;
 	int			ret = SUCCEED;
 
-	if (FAIL == zbx_jsonpath_compile(path, &jsonpath))
-		return FAIL;
+	if (SUCCEED == jsonpath_is_chain(jsonpath))
+	{
+		size_t	output_alloc = 0, output_offset = 0;
+
+		if (NULL == (obj = jsonpath_chain_find_obj(obj, jsonpath)))
+			return SUCCEED;
+
+		return jsonpath_str_copy_value(output, &output_alloc, &output_offset, obj);
+	}
 
 	ctx.found = 0;
 	ctx.root = obj;
-	ctx.path = &jsonpath;
+	ctx.path = jsonpath;
 	zbx_vector_jsonobj_ref_create(&ctx.objects);
 	ctx.index = index;
 
@@ -2908,15 +3164,15 @@ int	zbx_jsonobj_query_ext(const zbx_jsonobj_t *obj, zbx_jsonpath_index_t *index,
 	if (SUCCEED == ret)
 	{
 		zbx_vector_jsonobj_ref_t	out;
-		int				definite_path = jsonpath.definite, path_depth;
+		int				definite_path = jsonpath->definite, path_depth;
 
 		zbx_vector_jsonobj_ref_create(&out);
 
-		path_depth = jsonpath.segments_num;
-		while (0 < path_depth && ZBX_JSONPATH_SEGMENT_FUNCTION == jsonpath.segments[path_depth - 1].type)
+		path_depth = jsonpath->segments_num;
+		while (0 < path_depth && ZBX_JSONPATH_SEGMENT_FUNCTION == jsonpath->segments[path_depth - 1].type)
 			path_depth--;
 
-		if (path_depth < jsonpath.segments_num)
+		if (path_depth < jsonpath->segments_num)
 		{
 			if (SUCCEED == (ret = jsonpath_apply_functions(&ctx, path_depth, &definite_path, &out)))
 				ret = jsonpath_format_query_result(&out, definite_path, output);
@@ -2929,11 +3185,51 @@ int	zbx_jsonobj_query_ext(const zbx_jsonobj_t *obj, zbx_jsonpath_index_t *index,
 	}
 
 	jsonpath_ctx_clear(&ctx);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: perform jsonpath query on the specified json object               *
+ *                                                                            *
+ * Parameters: obj    - [IN] json object                                      *
+ *             index  - [IN] jsonpath index (optional)                        *
+ *             path   - [IN] jsonpath                                         *
+ *             output - [OUT] output value                                    *
+ *                                                                            *
+ * Return value: SUCCEED - the query was performed successfully (empty result *
+ *                         being counted as successful query)                 *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_jsonobj_query_ext(const zbx_jsonobj_t *obj, zbx_jsonpath_index_t *index, const char *path, char **output)
+{
+	zbx_jsonpath_t	jsonpath;
+	int		ret;
+
+	if (FAIL == zbx_jsonpath_compile(path, &jsonpath))
+		return FAIL;
+
+	ret = jsonpath_query_obj(obj, index, &jsonpath, output);
+
 	zbx_jsonpath_clear(&jsonpath);
 
 	return ret;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: perform compiled jsonpath query on the specified json object      *
+ *                                                                            *
+ * Comments: Allows to compile jsonpath once when querying many objects.      *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_jsonobj_query_path(const zbx_jsonobj_t *obj, zbx_jsonpath_t *jsonpath, char **output)
+{
+	return jsonpath_query_obj(obj, NULL, jsonpath, output);
+}
+
 int	zbx_jsonobj_query(const zbx_jsonobj_t *obj, const char *path, char **output)
 {
 	return zbx_jsonobj_query_ext(obj, NULL, path, output);
@@ -658,6 +658,8 @@ int	get_value_internal(const zbx_dc_item_t *item, AGENT_RESULT *result, const zb
 				SET_UI64_RESULT(result, *(zbx_uint64_t *)zbx_dc_get_stats(ZBX_STATS_HISTORY_FREE));
 			else if (0 == strcmp(tmp1, "pused"))
 				SET_DBL_RESULT(result, *(double *)zbx_dc_get_stats(ZBX_STATS_HISTORY_PUSED));
+			else if (0 == strcmp(tmp1, "pagesize"))
+				SET_UI64_RESULT(result, *(zbx_uint64_t *)zbx_dc_get_stats(ZBX_STATS_HISTORY_PAGESIZE));
 			else
 			{
 				SET_MSG_RESULT(result, zbx_strdup(NULL, "Invalid third parameter."));
@@ -682,6 +684,8 @@ int	get_value_internal(const zbx_dc_item_t *item, AGENT_RESULT *result, const zb
 				SET_UI64_RESULT(result, *(zbx_uint64_t *)zbx_dc_get_stats(ZBX_STATS_TREND_FREE));
 			else if (0 == strcmp(tmp1, "pused"))
 				SET_DBL_RESULT(result, *(double *)zbx_dc_get_stats(ZBX_STATS_TREND_PUSED));
+			else if (0 == strcmp(tmp1, "pagesize"))
+				SET_UI64_RESULT(result, *(zbx_uint64_t *)zbx_dc_get_stats(ZBX_STATS_TREND_PAGESIZE));
 			else
 			{
 				SET_MSG_RESULT(result, zbx_strdup(NULL, "Invalid third parameter."));
@@ -713,6 +717,29 @@ int	get_value_internal(const zbx_dc_item_t *item, AGENT_RESULT *result, const zb
 			{
 				SET_DBL_RESULT(result, *(double *)zbx_dc_get_stats(ZBX_STATS_HISTORY_INDEX_PUSED));
 			}
+			else if (0 == strcmp(tmp1, "pagesize"))
+			{
+				SET_UI64_RESULT(result, *(zbx_uint64_t *)
+						zbx_dc_get_stats(ZBX_STATS_HISTORY_INDEX_PAGESIZE));
+			}
+			else
+			{
+				SET_MSG_RESULT(result, zbx_strdup(NULL, "Invalid third parameter."));
+				goto out;
+			}
+		}
+		else if (0 == strcmp(tmp, "spill"))
+		{
+			if (NULL == tmp1 || '\0' == *tmp1 || 0 == strcmp(tmp1, "values"))
+				SET_UI64_RESULT(result, *(zbx_uint64_t *)zbx_dc_get_stats(ZBX_STATS_SPILL_VALUES));
+			else if (0 == strcmp(tmp1, "total"))
+				SET_UI64_RESULT(result, *(zbx_uint64_t *)zbx_dc_get_stats(ZBX_STATS_SPILL_TOTAL));
+			else if (0 == strcmp(tmp1, "used"))
+				SET_UI64_RESULT(result, *(zbx_uint64_t *)zbx_dc_get_stats(ZBX_STATS_SPILL_USED));
+			else if (0 == strcmp(tmp1, "pused"))
+				SET_DBL_RESULT(result, *(double *)zbx_dc_get_stats(ZBX_STATS_SPILL_PUSED));
+			else if (0 == strcmp(tmp1, "lag"))
+				SET_UI64_RESULT(result, *(zbx_uint64_t *)zbx_dc_get_stats(ZBX_STATS_SPILL_LAG));
 			else
 			{
 				SET_MSG_RESULT(result, zbx_strdup(NULL, "Invalid third parameter."));
@@ -761,6 +788,11 @@ int	get_value_internal(const zbx_dc_item_t *item, AGENT_RESULT *result, const zb
 			{
 				SET_DBL_RESULT(result, *(double *)zbx_dc_config_get_stats(ZBX_CONFSTATS_BUFFER_PUSED));
 			}
+			else if (0 == strcmp(tmp1, "pagesize"))
+			{
+				SET_UI64_RESULT(result, *(zbx_uint64_t *)
+						zbx_dc_config_get_stats(ZBX_CONFSTATS_BUFFER_PAGESIZE));
+			}
 			else
 			{
 				SET_MSG_RESULT(result, zbx_strdup(NULL, "Invalid third parameter."));
@@ -0,0 +1,531 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "pp_capture.h"
+
+#include "zbxpreproc.h"
+#include "zbxjson.h"
+#include "zbxstr.h"
+#include "zbxlog.h"
+
+/* Captured values are written as JSON lines. Item preprocessing is written before the first */
+/* captured value of the item and again when item preprocessing changes:                     */
+/*   {"itemid":1,"hostid":2,"revision":3,"type":0,"value_type":4,"flags":0,                    */
+/*     "steps":[{"type":12,"params":"$.a","error_handler":0,"error_handler_params":""}]}      */
+/* followed by the item values, with variant type and value converted to string or error:    */
+/*   {"itemid":1,"clock":1700000000,"ns":0,"type":3,"value":"{\"a\":1}"}                     */
+
+#define PP_CAPTURE_SIZE_LIMIT	ZBX_GIBIBYTE
+
+typedef struct
+{
+	zbx_uint64_t	itemid;
+	zbx_uint64_t	revision;
+	zbx_uint64_t	values_num;
+	unsigned char	value_type;
+	unsigned char	preproc_written;
+}
+zbx_pp_capture_item_t;
+
+ZBX_PTR_VECTOR_IMPL(pp_capture_value_ptr, zbx_pp_capture_value_t *)
+
+static const char	*capture_file = NULL;
+static int		capture_sample = 1;
+
+static FILE		*capture_fp = NULL;
+static zbx_uint64_t	capture_size;
+static zbx_hashset_t	capture_items;
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: sets preprocessing value capture parameters                       *
+ *                                                                            *
+ * Parameters: file   - [IN] file to append captured values to, NULL to       *
+ *                           disable capturing                                *
+ *             sample - [IN] capture every sample-th value of each item       *
+ *                                                                            *
+ * Comments: This function must be called before starting preprocessing      *
+ *           manager.                                                         *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_preprocessor_set_capture(const char *file, int sample)
+{
+	capture_file = file;
+	capture_sample = sample;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: opens capture file if value capturing is enabled                  *
+ *                                                                            *
+ ******************************************************************************/
+void	pp_capture_init(void)
+{
+	int	fd;
+
+	if (NULL == capture_file || '\0' == *capture_file)
+		return;
+
+	/* captured values are not anonymized, create the file readable by owner only */
+	if (-1 == (fd = open(capture_file, O_WRONLY | O_APPEND | O_CREAT, S_IRUSR | S_IWUSR)))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot open preprocessing capture file \"%s\": %s", capture_file,
+				zbx_strerror(errno));
+		return;
+	}
+
+	if (NULL == (capture_fp = fdopen(fd, "a")))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot open preprocessing capture file \"%s\": %s", capture_file,
+				zbx_strerror(errno));
+		close(fd);
+		return;
+	}
+
+	capture_size = 0;
+	zbx_hashset_create(&capture_items, 0, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	zabbix_log(LOG_LEVEL_INFORMATION, "capturing preprocessing values to \"%s\", sampling 1 of %d values"
+			" per item", capture_file, capture_sample);
+}
+
+void	pp_capture_destroy(void)
+{
+	if (NULL == capture_fp)
+		return;
+
+	fclose(capture_fp);
+	capture_fp = NULL;
+	zbx_hashset_destroy(&capture_items);
+}
+
+void	pp_capture_flush(void)
+{
+	if (NULL != capture_fp)
+		fflush(capture_fp);
+}
+
+static void	pp_capture_write(struct zbx_json *json)
+{
+	if (EOF == fputs(json->buffer, capture_fp) || EOF == fputc('\n', capture_fp))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot write preprocessing capture file \"%s\": %s, capturing stopped",
+				capture_file, zbx_strerror(errno));
+		pp_capture_destroy();
+		return;
+	}
+
+	if (PP_CAPTURE_SIZE_LIMIT < (capture_size += json->buffer_size + 1))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "preprocessing capture file \"%s\" reached size limit, capturing stopped",
+				capture_file);
+		pp_capture_destroy();
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: writes sampled item value to capture file                         *
+ *                                                                            *
+ * Parameters: itemid  - [IN]                                                 *
+ *             preproc - [IN] item preprocessing                              *
+ *             value   - [IN] value before preprocessing                      *
+ *             ts      - [IN] value timestamp                                 *
+ *                                                                            *
+ * Comments: Steps are written with unexpanded user macros, as they are       *
+ *           resolved by workers.                                             *
+ *                                                                            *
+ ******************************************************************************/
+void	pp_capture_value(zbx_uint64_t itemid, const zbx_pp_item_preproc_t *preproc, const zbx_variant_t *value,
+		zbx_timespec_t ts)
+{
+	zbx_pp_capture_item_t	*item;
+	struct zbx_json		json;
+
+	if (NULL == capture_fp || 0 == preproc->steps_num)
+		return;
+
+	switch (value->type)
+	{
+		case ZBX_VARIANT_STR:
+		case ZBX_VARIANT_UI64:
+		case ZBX_VARIANT_DBL:
+		case ZBX_VARIANT_ERR:
+			break;
+		default:
+			return;
+	}
+
+	if (NULL == (item = (zbx_pp_capture_item_t *)zbx_hashset_search(&capture_items, &itemid)))
+	{
+		zbx_pp_capture_item_t	item_local = {.itemid = itemid};
+
+		item = (zbx_pp_capture_item_t *)zbx_hashset_insert(&capture_items, &item_local, sizeof(item_local));
+	}
+
+	if (0 != item->values_num++ % (zbx_uint64_t)capture_sample)
+		return;
+
+	zbx_json_init(&json, ZBX_JSON_STAT_BUF_LEN);
+
+	if (0 == item->preproc_written || item->revision != preproc->pp_revision ||
+			item->value_type != preproc->value_type)
+	{
+		zbx_json_adduint64(&json, ZBX_PROTO_TAG_ITEMID, itemid);
+		zbx_json_adduint64(&json, ZBX_PROTO_TAG_HOSTID, preproc->hostid);
+		zbx_json_adduint64(&json, ZBX_PROTO_TAG_REVISION, preproc->pp_revision);
+		zbx_json_addint64(&json, ZBX_PROTO_TAG_TYPE, preproc->type);
+		zbx_json_addint64(&json, ZBX_PROTO_TAG_VALUE_TYPE, preproc->value_type);
+		zbx_json_addint64(&json, ZBX_PROTO_TAG_FLAGS, preproc->flags);
+		zbx_json_addarray(&json, ZBX_PROTO_TAG_STEPS);
+
+		for (int i = 0; i < preproc->steps_num; i++)
+		{
+			const zbx_pp_step_t	*step = &preproc->steps[i];
+
+			zbx_json_addobject(&json, NULL);
+			zbx_json_addint64(&json, ZBX_PROTO_TAG_TYPE, step->type);
+			zbx_json_addstring(&json, ZBX_PROTO_TAG_PARAMS, step->params, ZBX_JSON_TYPE_STRING);
+			zbx_json_addint64(&json, ZBX_PROTO_TAG_ERROR_HANDLER, step->error_handler);
+			zbx_json_addstring(&json, ZBX_PROTO_TAG_ERROR_HANDLER_PARAMS, step->error_handler_params,
+					ZBX_JSON_TYPE_STRING);
+			zbx_json_close(&json);
+		}
+
+		pp_capture_write(&json);
+
+		if (NULL == capture_fp)
+			goto out;
+
+		item->preproc_written = 1;
+		item->revision = preproc->pp_revision;
+		item->value_type = preproc->value_type;
+		zbx_json_clean(&json);
+	}
+
+	zbx_json_adduint64(&json, ZBX_PROTO_TAG_ITEMID, itemid);
+	zbx_json_addint64(&json, ZBX_PROTO_TAG_CLOCK, ts.sec);
+	zbx_json_addint64(&json, ZBX_PROTO_TAG_NS, ts.ns);
+
+	if (ZBX_VARIANT_ERR == value->type)
+	{
+		zbx_json_addstring(&json, ZBX_PROTO_TAG_ERROR, value->data.err, ZBX_JSON_TYPE_STRING);
+	}
+	else
+	{
+		zbx_json_addint64(&json, ZBX_PROTO_TAG_TYPE, value->type);
+		zbx_json_addstring(&json, ZBX_PROTO_TAG_VALUE, zbx_variant_value_desc(value), ZBX_JSON_TYPE_STRING);
+	}
+
+	pp_capture_write(&json);
+out:
+	zbx_json_free(&json);
+}
+
+static int	pp_capture_get_uint64(const struct zbx_json_parse *jp, const char *name, zbx_uint64_t *value)
+{
+	char	buf[MAX_ID_LEN + 1];
+
+	if (SUCCEED != zbx_json_value_by_name(jp, name, buf, sizeof(buf), NULL))
+		return FAIL;
+
+	return zbx_is_uint64(buf, value);
+}
+
+static int	pp_capture_get_int(const struct zbx_json_parse *jp, const char *name, int *value)
+{
+	char	buf[MAX_ID_LEN + 1];
+
+	if (SUCCEED != zbx_json_value_by_name(jp, name, buf, sizeof(buf), NULL))
+		return FAIL;
+
+	return zbx_is_int(buf, value);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: parses captured item preprocessing                                *
+ *                                                                            *
+ * Return value: item preprocessing or NULL on invalid data                   *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_pp_item_preproc_t	*pp_capture_parse_preproc(const struct zbx_json_parse *jp,
+		const struct zbx_json_parse *jp_steps)
+{
+	zbx_uint64_t		hostid, revision;
+	int			type, value_type, flags, steps_num = 0;
+	const char		*p = NULL;
+	zbx_pp_item_preproc_t	*preproc;
+
+	if (SUCCEED != pp_capture_get_uint64(jp, ZBX_PROTO_TAG_HOSTID, &hostid) ||
+			SUCCEED != pp_capture_get_uint64(jp, ZBX_PROTO_TAG_REVISION, &revision) ||
+			SUCCEED != pp_capture_get_int(jp, ZBX_PROTO_TAG_TYPE, &type) ||
+			SUCCEED != pp_capture_get_int(jp, ZBX_PROTO_TAG_VALUE_TYPE, &value_type) ||
+			SUCCEED != pp_capture_get_int(jp, ZBX_PROTO_TAG_FLAGS, &flags))
+	{
+		return NULL;
+	}
+
+	while (NULL != (p = zbx_json_next(jp_steps, p)))
+		steps_num++;
+
+	preproc = zbx_pp_item_preproc_create(hostid, (unsigned char)type, (unsigned char)value_type,
+			(unsigned char)flags);
+	preproc->pp_revision = revision;
+	preproc->steps = (zbx_pp_step_t *)zbx_malloc(NULL, sizeof(zbx_pp_step_t) * (size_t)steps_num);
+
+	while (NULL != (p = zbx_json_next(jp_steps, p)))
+	{
+		struct zbx_json_parse	jp_step;
+		zbx_pp_step_t		*step = &preproc->steps[preproc->steps_num];
+		size_t			params_alloc = 0, error_handler_params_alloc = 0;
+
+		step->params = NULL;
+		step->error_handler_params = NULL;
+
+		if (SUCCEED != zbx_json_brackets_open(p, &jp_step) ||
+				SUCCEED != pp_capture_get_int(&jp_step, ZBX_PROTO_TAG_TYPE, &step->type) ||
+				SUCCEED != pp_capture_get_int(&jp_step, ZBX_PROTO_TAG_ERROR_HANDLER,
+						&step->error_handler) ||
+				SUCCEED != zbx_json_value_by_name_dyn(&jp_step, ZBX_PROTO_TAG_PARAMS, &step->params,
+						&params_alloc, NULL) ||
+				SUCCEED != zbx_json_value_by_name_dyn(&jp_step, ZBX_PROTO_TAG_ERROR_HANDLER_PARAMS,
+						&step->error_handler_params, &error_handler_params_alloc, NULL))
+		{
+			zbx_free(step->params);
+			zbx_free(step->error_handler_params);
+			zbx_pp_item_preproc_release(preproc);
+
+			return NULL;
+		}
+
+		preproc->steps_num++;
+
+		if (SUCCEED == zbx_pp_preproc_has_history(step->type))
+		{
+			preproc->history_num++;
+
+			if (SUCCEED == zbx_pp_preproc_has_serial_history(step->type))
+				preproc->mode = ZBX_PP_PROCESS_SERIAL;
+		}
+	}
+
+	if (0 != preproc->history_num)
+		preproc->history_cache = zbx_pp_history_cache_create();
+
+	return preproc;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: parses captured item value                                        *
+ *                                                                            *
+ * Return value: SUCCEED - the value was parsed                               *
+ *               FAIL    - invalid data                                       *
+ *                                                                            *
+ ******************************************************************************/
+static int	pp_capture_parse_value(const struct zbx_json_parse *jp, zbx_pp_capture_value_t *value)
+{
+	char	*data = NULL;
+	size_t	data_alloc = 0;
+	int	type;
+
+	if (SUCCEED != pp_capture_get_int(jp, ZBX_PROTO_TAG_CLOCK, &value->ts.sec) ||
+			SUCCEED != pp_capture_get_int(jp, ZBX_PROTO_TAG_NS, &value->ts.ns))
+	{
+		return FAIL;
+	}
+
+	if (SUCCEED == zbx_json_value_by_name_dyn(jp, ZBX_PROTO_TAG_ERROR, &data, &data_alloc, NULL))
+	{
+		zbx_variant_set_error(&value->value, data);
+		return SUCCEED;
+	}
+
+	if (SUCCEED != pp_capture_get_int(jp, ZBX_PROTO_TAG_TYPE, &type) ||
+			SUCCEED != zbx_json_value_by_name_dyn(jp, ZBX_PROTO_TAG_VALUE, &data, &data_alloc, NULL))
+	{
+		zbx_free(data);
+		return FAIL;
+	}
+
+	zbx_variant_set_str(&value->value, data);
+
+	if (ZBX_VARIANT_STR != type && SUCCEED != zbx_variant_convert(&value->value, type))
+	{
+		zbx_variant_clear(&value->value);
+		return FAIL;
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: parses captured values for replay                                 *
+ *                                                                            *
+ * Parameters: data   - [IN] captured data, modified during parsing           *
+ *             values - [OUT] captured values in capture order                *
+ *             error  - [OUT] error message                                   *
+ *                                                                            *
+ * Return value: SUCCEED - the values were parsed                             *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: Values reference item preprocessing that was in effect when they *
+ *           were captured. Values of items without captured preprocessing    *
+ *           are skipped.                                                     *
+ *                                                                            *
+ ******************************************************************************/
+int	pp_capture_parse(char *data, zbx_vector_pp_capture_value_ptr_t *values, char **error)
+{
+	char		*line, *next;
+	int		ret = FAIL, line_num = 0;
+	zbx_hashset_t	items;
+	zbx_pp_item_t	*item;
+
+	zbx_hashset_create_ext(&items, 0, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC,
+			(zbx_clean_func_t)zbx_pp_item_clear, ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC,
+			ZBX_DEFAULT_MEM_FREE_FUNC);
+
+	for (line = data; '\0' != *line; line = next)
+	{
+		struct zbx_json_parse	jp, jp_steps;
+		zbx_uint64_t		itemid;
+
+		line_num++;
+
+		if (NULL != (next = strchr(line, '\n')))
+			*next++ = '\0';
+		else
+			next = line + strlen(line);
+
+		if ('\0' == *line)
+			continue;
+
+		if (SUCCEED != zbx_json_open(line, &jp) ||
+				SUCCEED != pp_capture_get_uint64(&jp, ZBX_PROTO_TAG_ITEMID, &itemid))
+		{
+			goto fail;
+		}
+
+		item = (zbx_pp_item_t *)zbx_hashset_search(&items, &itemid);
+
+		if (SUCCEED == zbx_json_brackets_by_name(&jp, ZBX_PROTO_TAG_STEPS, &jp_steps))
+		{
+			zbx_pp_item_preproc_t	*preproc;
+
+			if (NULL == (preproc = pp_capture_parse_preproc(&jp, &jp_steps)))
+				goto fail;
+
+			if (NULL == item)
+			{
+				zbx_pp_item_t	item_local = {.itemid = itemid};
+
+				item = (zbx_pp_item_t *)zbx_hashset_insert(&items, &item_local, sizeof(item_local));
+			}
+			else
+				zbx_pp_item_preproc_release(item->preproc);
+
+			item->preproc = preproc;
+			item->revision = preproc->pp_revision;
+		}
+		else if (NULL != item)
+		{
+			zbx_pp_capture_value_t	*value;
+
+			value = (zbx_pp_capture_value_t *)zbx_malloc(NULL, sizeof(zbx_pp_capture_value_t));
+
+			if (SUCCEED != pp_capture_parse_value(&jp, value))
+			{
+				zbx_free(value);
+				goto fail;
+			}
+
+			value->itemid = itemid;
+			value->preproc = zbx_pp_item_preproc_copy(item->preproc);
+			zbx_vector_pp_capture_value_ptr_append(values, value);
+		}
+	}
+
+	ret = SUCCEED;
+fail:
+	if (SUCCEED != ret)
+		*error = zbx_dsprintf(NULL, "invalid data at line %d", line_num);
+
+	zbx_hashset_destroy(&items);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: loads captured values for replay                                  *
+ *                                                                            *
+ * Parameters: path   - [IN] capture file                                     *
+ *             values - [OUT] captured values in capture order                *
+ *             error  - [OUT] error message                                   *
+ *                                                                            *
+ * Return value: SUCCEED - the values were loaded                             *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+int	pp_capture_load(const char *path, zbx_vector_pp_capture_value_ptr_t *values, char **error)
+{
+	FILE	*fp;
+	char	*data = NULL;
+	size_t	data_alloc = 0, data_offset = 0, n;
+	int	ret;
+
+	if (NULL == (fp = fopen(path, "r")))
+	{
+		*error = zbx_dsprintf(NULL, "cannot open file: %s", zbx_strerror(errno));
+		return FAIL;
+	}
+
+	do
+	{
+		if (data_alloc - data_offset < ZBX_KIBIBYTE * 64 + 1)
+		{
+			data_alloc += ZBX_KIBIBYTE * 64 + 1 + data_alloc / 2;
+			data = (char *)zbx_realloc(data, data_alloc);
+		}
+
+		n = fread(data + data_offset, 1, data_alloc - data_offset - 1, fp);
+		data_offset += n;
+	}
+	while (0 != n);
+
+	if (0 != ferror(fp))
+	{
+		*error = zbx_dsprintf(NULL, "cannot read file: %s", zbx_strerror(errno));
+		fclose(fp);
+		zbx_free(data);
+		return FAIL;
+	}
+
+	fclose(fp);
+	data[data_offset] = '\0';
+
+	ret = pp_capture_parse(data, values, error);
+	zbx_free(data);
+
+	return ret;
+}
+
+void	pp_capture_value_free(zbx_pp_capture_value_t *value)
+{
+	zbx_variant_clear(&value->value);
+	zbx_pp_item_preproc_release(value->preproc);
+	zbx_free(value);
+}
@@ -0,0 +1,45 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#ifndef ZABBIX_PP_CAPTURE_H
+#define ZABBIX_PP_CAPTURE_H
+
+#include "zbxpreprocbase.h"
+#include "zbxvariant.h"
+#include "zbxtime.h"
+#include "zbxalgo.h"
+
+/* captured item value for replay */
+typedef struct
+{
+	zbx_uint64_t		itemid;
+	zbx_pp_item_preproc_t	*preproc;	/* item preprocessing at the time of capture */
+	zbx_variant_t		value;
+	zbx_timespec_t		ts;
+}
+zbx_pp_capture_value_t;
+
+ZBX_PTR_VECTOR_DECL(pp_capture_value_ptr, zbx_pp_capture_value_t *)
+
+void	pp_capture_init(void);
+void	pp_capture_destroy(void);
+void	pp_capture_flush(void);
+void	pp_capture_value(zbx_uint64_t itemid, const zbx_pp_item_preproc_t *preproc, const zbx_variant_t *value,
+		zbx_timespec_t ts);
+
+int	pp_capture_parse(char *data, zbx_vector_pp_capture_value_ptr_t *values, char **error);
+int	pp_capture_load(const char *path, zbx_vector_pp_capture_value_ptr_t *values, char **error);
+void	pp_capture_value_free(zbx_pp_capture_value_t *value);
+
+#endif
@@ -254,25 +254,14 @@ static int	pp_excute_jsonpath_query(zbx_pp_cache_t *cache, zbx_variant_t *value,
 
 	if (NULL == cache || ZBX_PREPROC_JSONPATH != cache->type)
 	{
-		zbx_jsonobj_t	obj;
-
 		if (FAIL == item_preproc_convert_value(value, ZBX_VARIANT_STR, errmsg))
 			return FAIL;
 
-		if (FAIL == zbx_jsonobj_open(value->data.str, &obj))
-		{
-			*errmsg = zbx_strdup(*errmsg, zbx_json_strerror());
-			return FAIL;
-		}
-
-		if (FAIL == zbx_jsonobj_query(&obj, params, &data))
+		if (FAIL == zbx_jsonpath_query_data(value->data.str, params, &data))
 		{
-			zbx_jsonobj_clear(&obj);
 			*errmsg = zbx_strdup(*errmsg, zbx_json_strerror());
 			return FAIL;
 		}
-
-		zbx_jsonobj_clear(&obj);
 	}
 	else
 	{
@@ -1259,6 +1248,8 @@ void	pp_execute(zbx_pp_context_t *ctx, zbx_pp_item_preproc_t *preproc, zbx_pp_ca
 		zbx_variant_t		history_value_out, history_none;
 		const zbx_variant_t	*history_value_in;
 		zbx_timespec_t		history_ts;
+		struct timespec		step_start, step_end;
+		int			ret;
 
 		if (ZBX_VARIANT_ERR == value_out->type && ZBX_PREPROC_VALIDATE_NOT_SUPPORTED != preproc->steps[i].type)
 			break;
@@ -1275,8 +1266,21 @@ void	pp_execute(zbx_pp_context_t *ctx, zbx_pp_item_preproc_t *preproc, zbx_pp_ca
 			history_value_in = &history_none;
 		}
 
-		if (SUCCEED != pp_execute_step(ctx, cache, um_handle, preproc->hostid, preproc->value_type, value_out,
-				ts, preproc->steps + i, history_value_in, &history_value_out, &history_ts, config_source_ip))
+		if (NULL != ctx->step_stats_cb)
+			clock_gettime(CLOCK_MONOTONIC, &step_start);
+
+		ret = pp_execute_step(ctx, cache, um_handle, preproc->hostid, preproc->value_type, value_out, ts,
+				preproc->steps + i, history_value_in, &history_value_out, &history_ts,
+				config_source_ip);
+
+		if (NULL != ctx->step_stats_cb)
+		{
+			clock_gettime(CLOCK_MONOTONIC, &step_end);
+			ctx->step_stats_cb(preproc->steps + i, (zbx_uint64_t)((step_end.tv_sec - step_start.tv_sec) *
+					1000000000 + step_end.tv_nsec - step_start.tv_nsec), ctx->step_stats_data);
+		}
+
+		if (SUCCEED != ret)
 		{
 			zbx_variant_copy(&value_raw, value_out);
 
@@ -22,10 +22,16 @@
 #include "zbxcacheconfig.h"
 #include "zbxpreprocbase.h"
 
+/* callback to collect step execution time, used by preprocessing benchmark */
+typedef void (*zbx_pp_step_stats_cb_t)(const zbx_pp_step_t *step, zbx_uint64_t time_ns, void *data);
+
 typedef struct
 {
-	int		es_initialized;
-	zbx_es_t	es_engine;
+	int			es_initialized;
+	zbx_es_t		es_engine;
+
+	zbx_pp_step_stats_cb_t	step_stats_cb;
+	void			*step_stats_data;
 }
 zbx_pp_context_t;
 
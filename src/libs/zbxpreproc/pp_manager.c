@@ -29,6 +29,7 @@
 #include "zbxvariant.h"
 #include "zbxlog.h"
 #include "pp_cache.h"
+#include "pp_capture.h"
 #include "zbxcacheconfig.h"
 #include "zbxipcservice.h"
 #include "zbxthreads.h"
@@ -144,7 +145,7 @@ static zbx_pp_manager_t	*zbx_pp_manager_create(int workers_num, zbx_pp_notify_cb
 	manager = (zbx_pp_manager_t *)zbx_malloc(NULL, sizeof(zbx_pp_manager_t));
 	memset(manager, 0, sizeof(zbx_pp_manager_t));
 
-	if (SUCCEED != pp_task_queue_init(&manager->queue, error))
+	if (SUCCEED != pp_task_queue_init(&manager->queue, workers_num, error))
 		goto out;
 
 	manager->timekeeper = zbx_timekeeper_create(workers_num, NULL);
@@ -267,8 +268,9 @@ static void	zbx_pp_manager_queue_test(zbx_pp_manager_t *manager, zbx_pp_item_pre
 {
 	zbx_pp_task_t	*task = pp_task_test_create(preproc, value, ts, client);
 
-	pp_task_queue_lock(&manager->queue);
 	pp_task_queue_push_test(&manager->queue, task);
+
+	pp_task_queue_lock(&manager->queue);
 	pp_task_queue_notify(&manager->queue);
 	pp_task_queue_unlock(&manager->queue);
 }
@@ -280,13 +282,13 @@ static void	zbx_pp_manager_queue_test(zbx_pp_manager_t *manager, zbx_pp_item_pre
  ******************************************************************************/
 static void	zbx_pp_manager_queue_value_preproc(zbx_pp_manager_t *manager, zbx_vector_pp_task_ptr_t *tasks)
 {
+	for (int i = 0; i < tasks->values_num; i++)
+		pp_task_queue_push(&manager->queue, tasks->values[i]);
+
 	zbx_prof_start(__func__, ZBX_PROF_MUTEX);
 	pp_task_queue_lock(&manager->queue);
 	zbx_prof_end_wait();
 
-	for (int i = 0; i < tasks->values_num; i++)
-		pp_task_queue_push(&manager->queue, tasks->values[i]);
-
 	pp_task_queue_notify(&manager->queue);
 
 	pp_task_queue_unlock(&manager->queue);
@@ -321,6 +323,8 @@ static zbx_pp_task_t	*zbx_pp_manager_create_task(zbx_pp_manager_t *manager, zbx_
 	if (0 == item->preproc->dep_itemids_num && 0 == item->preproc->steps_num)
 		return NULL;
 
+	pp_capture_value(itemid, item->preproc, value, ts);
+
 	if (ZBX_PP_PROCESS_PARALLEL == item->preproc->mode)
 	{
 		return pp_task_value_create(item->itemid, item->preproc, manager->um_handle, value, ts, value_opt,
@@ -375,15 +379,11 @@ static zbx_pp_item_t	*pp_manager_get_cacheable_dependent_item(zbx_pp_manager_t *
  *             cache          - [IN] preprocessing cache                      *
  *                                   (optional, can be NULL)                  *
  *                                                                            *
- * Comments: This function called within task queue lock.                     *
- *                                                                            *
  ******************************************************************************/
 static void	pp_manager_queue_dependents(zbx_pp_manager_t *manager, zbx_pp_item_preproc_t *preproc,
 		zbx_dc_um_shared_handle_t *um_handle, zbx_uint64_t exclude_itemid, const zbx_variant_t *value,
 		zbx_timespec_t ts, zbx_pp_cache_t *cache)
 {
-	int	queued_num = 0;
-
 	if (0 == preproc->dep_itemids_num)
 		return;
 
@@ -417,12 +417,8 @@ static void	pp_manager_queue_dependents(zbx_pp_manager_t *manager, zbx_pp_item_p
 		}
 
 		pp_task_queue_push_immediate(&manager->queue, new_task);
-		queued_num++;
 	}
 
-	if (0 < queued_num)
-		pp_task_queue_notify(&manager->queue);
-
 	pp_cache_release(cache);
 }
 
@@ -434,8 +430,6 @@ static void	pp_manager_queue_dependents(zbx_pp_manager_t *manager, zbx_pp_item_p
  * Parameters: manager - [IN] manager                                         *
  *             task    - [IN] finished value task                             *
  *                                                                            *
- * Comments: This function called within task queue lock.                     *
- *                                                                            *
  ******************************************************************************/
 static void	pp_manager_queue_value_task_result(zbx_pp_manager_t *manager, zbx_pp_task_t *task)
 {
@@ -461,7 +455,6 @@ static void	pp_manager_queue_value_task_result(zbx_pp_manager_t *manager, zbx_pp
 				NULL, d_dep->cache);
 
 		pp_task_queue_push_immediate(&manager->queue, dep_task);
-		pp_task_queue_notify(&manager->queue);
 	}
 	else
 		pp_manager_queue_dependents(manager, d->preproc, d->um_handle, 0, &d->result, d->ts, NULL);
@@ -474,8 +467,6 @@ static void	pp_manager_queue_value_task_result(zbx_pp_manager_t *manager, zbx_pp
  * Parameters: manager - [IN] manager                                         *
  *             task    - [IN] finished dependent task                         *
  *                                                                            *
- * Comments: This function called within task queue lock.                     *
- *                                                                            *
  ******************************************************************************/
 static zbx_pp_task_t	*pp_manager_queue_dependent_task_result(zbx_pp_manager_t *manager, zbx_pp_task_t *task)
 {
@@ -499,8 +490,6 @@ static zbx_pp_task_t	*pp_manager_queue_dependent_task_result(zbx_pp_manager_t *m
  * Parameters: manager  - [IN] manager                                        *
  *             task_seq - [IN] finished sequence task                         *
  *                                                                            *
- * Comments: This function called within task queue lock.                     *
- *                                                                            *
  ******************************************************************************/
 static zbx_pp_task_t	*pp_manager_requeue_next_sequence_task(zbx_pp_manager_t *manager, zbx_pp_task_t *task_seq)
 {
@@ -525,10 +514,7 @@ static zbx_pp_task_t	*pp_manager_requeue_next_sequence_task(zbx_pp_manager_t *ma
 	}
 
 	if (SUCCEED == zbx_list_peek(&d_seq->tasks, (void **)&tmp_task))
-	{
 		pp_task_queue_push_immediate(&manager->queue, task_seq);
-		pp_task_queue_notify(&manager->queue);
-	}
 	else
 	{
 		pp_task_queue_remove_sequence(&manager->queue, task_seq->itemid);
@@ -561,9 +547,7 @@ static void	zbx_pp_manager_process_finished(zbx_pp_manager_t *manager, zbx_vecto
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
 	zbx_vector_pp_task_ptr_reserve(tasks, PP_FINISHED_TASK_BATCH_SIZE);
-	zbx_prof_start(__func__, ZBX_PROF_MUTEX);
-	pp_task_queue_lock(&manager->queue);
-	zbx_prof_end_wait();
+
 	while (PP_FINISHED_TASK_BATCH_SIZE > tasks->values_num)
 	{
 		if (NULL != (task = pp_task_queue_pop_finished(&manager->queue)))
@@ -590,12 +574,21 @@ static void	zbx_pp_manager_process_finished(zbx_pp_manager_t *manager, zbx_vecto
 		zbx_vector_pp_task_ptr_append(tasks, task);
 	}
 
-	*pending_num = manager->queue.pending_num;
-	*finished_num = manager->queue.finished_num;
-	*processing_num = manager->queue.processing_num;
+	/* finished tasks might have queued new tasks */
+	if (0 != tasks->values_num)
+	{
+		zbx_prof_start(__func__, ZBX_PROF_MUTEX);
+		pp_task_queue_lock(&manager->queue);
+		zbx_prof_end_wait();
+
+		pp_task_queue_notify(&manager->queue);
+
+		pp_task_queue_unlock(&manager->queue);
+		zbx_prof_end();
+	}
+
+	pp_task_queue_get_stats(&manager->queue, pending_num, processing_num, finished_num);
 
-	pp_task_queue_unlock(&manager->queue);
-	zbx_prof_end();
 	now = time(NULL);
 	if (now != timekeeper_clock)
 	{
@@ -664,9 +657,10 @@ zbx_hashset_t  *zbx_pp_manager_items(zbx_pp_manager_t *manager)
 static void	zbx_pp_manager_get_diag_stats(zbx_pp_manager_t *manager, zbx_uint64_t *preproc_num,
 		zbx_uint64_t *pending_num, zbx_uint64_t *finished_num, zbx_uint64_t *sequences_num)
 {
+	zbx_uint64_t	processing_num;
+
 	*preproc_num = (zbx_uint64_t)manager->items.num_data;
-	*pending_num = manager->queue.pending_num;
-	*finished_num = manager->queue.finished_num;
+	pp_task_queue_get_stats(&manager->queue, pending_num, &processing_num, finished_num);
 	*sequences_num = (zbx_uint64_t)manager->queue.sequences.num_data;
 }
 
@@ -848,6 +842,49 @@ static void	preprocessing_flush_value(zbx_pp_manager_t *manager, zbx_uint64_t it
 	flush_value_func_cb(manager, itemid, value_type, flags, value, ts, value_opt);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: unpacks item value and creates preprocessing task for it          *
+ *                                                                            *
+ * Parameters: manager    - [IN] preprocessing manager                        *
+ *             data       - [IN] packed item value                            *
+ *             tasks      - [OUT] created preprocessing tasks                 *
+ *             direct_num - [OUT] number of directly flushed values           *
+ *                                                                            *
+ * Return value: The size of unpacked data                                    *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_uint32_t	preprocessor_add_value(zbx_pp_manager_t *manager, const unsigned char *data,
+		zbx_vector_pp_task_ptr_t *tasks, zbx_uint64_t *direct_num)
+{
+	zbx_preproc_item_value_t	value;
+	zbx_variant_t			var;
+	zbx_pp_value_opt_t		var_opt;
+	zbx_timespec_t			ts;
+	zbx_pp_task_t			*task;
+	zbx_uint32_t			size;
+
+	size = zbx_preprocessor_unpack_value(&value, data);
+	preproc_item_value_extract_data(&value, &var, &ts, &var_opt);
+
+	if (NULL == (task = zbx_pp_manager_create_task(manager, value.itemid, &var, ts, &var_opt)))
+	{
+		(*direct_num)++;
+		/* allow empty values */
+		preprocessing_flush_value(manager, value.itemid, value.item_value_type, value.item_flags,
+				&var, ts, &var_opt);
+
+		zbx_variant_clear(&var);
+		zbx_pp_value_opt_clear(&var_opt);
+	}
+	else
+		zbx_vector_pp_task_ptr_append(tasks, task);
+
+	preproc_item_value_clear(&value);
+
+	return size;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: handle new preprocessing request                                  *
@@ -863,7 +900,6 @@ static zbx_uint64_t	preprocessor_add_request(zbx_pp_manager_t *manager, zbx_ipc_
 		zbx_uint64_t *direct_num)
 {
 	zbx_uint32_t			offset = 0;
-	zbx_preproc_item_value_t	value;
 	zbx_uint64_t			queued_num = 0;
 	zbx_vector_pp_task_ptr_t	tasks;
 
@@ -875,42 +911,101 @@ static zbx_uint64_t	preprocessor_add_request(zbx_pp_manager_t *manager, zbx_ipc_
 	preprocessor_sync_configuration(manager);
 
 	while (offset < message->size)
-	{
-		zbx_variant_t		var;
-		zbx_pp_value_opt_t	var_opt;
-		zbx_timespec_t		ts;
-		zbx_pp_task_t		*task;
+		offset += preprocessor_add_value(manager, message->data + offset, &tasks, direct_num);
 
-		offset += zbx_preprocessor_unpack_value(&value, message->data + offset);
-		preproc_item_value_extract_data(&value, &var, &ts, &var_opt);
+	if (0 != tasks.values_num)
+		zbx_pp_manager_queue_value_preproc(manager, &tasks);
 
-		if (NULL == (task = zbx_pp_manager_create_task(manager, value.itemid, &var, ts, &var_opt)))
-		{
-			(*direct_num)++;
-			/* allow empty values */
-			preprocessing_flush_value(manager, value.itemid, value.item_value_type, value.item_flags,
-					&var, ts, &var_opt);
+	queued_num = tasks.values_num;
+	zbx_vector_pp_task_ptr_destroy(&tasks);
 
-			zbx_variant_clear(&var);
-			zbx_pp_value_opt_clear(&var_opt);
-		}
-		else
-			zbx_vector_pp_task_ptr_append(&tasks, task);
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+
+	return queued_num;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: handle item values written to client shared memory ring           *
+ *                                                                            *
+ * Parameters: manager    - [IN] preprocessing manager                        *
+ *             ring       - [IN] client shared memory ring                    *
+ *             direct_num - [OUT] number of directly flushed values           *
+ *                                                                            *
+ *  Return value: The number of requests queued for preprocessing             *
+ *                                                                            *
+ * Comments: The values are unpacked directly from the ring memory. The ring  *
+ *           space is released after each batch so the client can continue    *
+ *           writing while the rest of values are being processed.            *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_uint64_t	preprocessor_add_ring_values(zbx_pp_manager_t *manager, zbx_ipc_ring_t *ring,
+		zbx_uint64_t *direct_num)
+{
+	const unsigned char		*data;
+	zbx_uint32_t			size;
+	zbx_uint64_t			queued_num = 0;
+	zbx_vector_pp_task_ptr_t	tasks;
+
+	if (NULL == (data = zbx_ipc_ring_read(ring, &size)))
+		return 0;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+
+	zbx_vector_pp_task_ptr_create(&tasks);
+	zbx_vector_pp_task_ptr_reserve(&tasks, ZBX_PREPROCESSING_BATCH_SIZE);
+
+	preprocessor_sync_configuration(manager);
+
+	do
+	{
+		preprocessor_add_value(manager, data, &tasks, direct_num);
 
-		preproc_item_value_clear(&value);
+		if (ZBX_PREPROCESSING_BATCH_SIZE <= tasks.values_num)
+		{
+			zbx_ipc_ring_release(ring);
+			zbx_pp_manager_queue_value_preproc(manager, &tasks);
+			queued_num += (zbx_uint64_t)tasks.values_num;
+			zbx_vector_pp_task_ptr_clear(&tasks);
+		}
 	}
+	while (NULL != (data = zbx_ipc_ring_read(ring, &size)));
+
+	zbx_ipc_ring_release(ring);
 
 	if (0 != tasks.values_num)
+	{
 		zbx_pp_manager_queue_value_preproc(manager, &tasks);
+		queued_num += (zbx_uint64_t)tasks.values_num;
+	}
 
-	queued_num = tasks.values_num;
 	zbx_vector_pp_task_ptr_destroy(&tasks);
 
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() queued:" ZBX_FS_UI64, __func__, queued_num);
 
 	return queued_num;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: attaches shared memory ring sent by preprocessing client          *
+ *                                                                            *
+ * Parameters: client - [IN] the client                                       *
+ *                                                                            *
+ ******************************************************************************/
+static void	preprocessor_attach_ring(zbx_ipc_client_t *client)
+{
+	char	*error = NULL;
+
+	if (SUCCEED != zbx_ipc_client_attach_ring(client, &error))
+	{
+		/* the client would be blocked on full ring, close connection so it fails early */
+		zabbix_log(LOG_LEVEL_WARNING, "cannot attach preprocessing client shared memory ring: %s", error);
+		zbx_free(error);
+		zbx_ipc_client_close(client);
+	}
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: handle new preprocessing test request                             *
@@ -939,7 +1034,9 @@ static void	preprocessor_add_test_request(zbx_pp_manager_t *manager, zbx_ipc_cli
 
 static void	preprocessor_reply_queue_size(zbx_pp_manager_t *manager, zbx_ipc_client_t *client)
 {
-	zbx_uint64_t	pending_num = manager->queue.pending_num;
+	zbx_uint64_t	pending_num, processing_num, finished_num;
+
+	pp_task_queue_get_stats(&manager->queue, &pending_num, &processing_num, &finished_num);
 
 	zbx_ipc_client_send(client, ZBX_IPC_PREPROCESSOR_QUEUE, (unsigned char *)&pending_num, sizeof(pending_num));
 }
@@ -1263,6 +1360,8 @@ ZBX_THREAD_ENTRY(zbx_pp_manager_thread, args)
 		exit(EXIT_FAILURE);
 	}
 
+	pp_capture_init();
+
 	/* subscribe for worker log level rtc messages */
 	zbx_rtc_subscribe_service(ZBX_PROCESS_TYPE_PREPROCESSOR, 0, rtc_msgs, ARRSIZE(rtc_msgs),
 			pp_args->config_timeout, ZBX_IPC_SERVICE_PREPROCESSING);
@@ -1315,6 +1414,9 @@ ZBX_THREAD_ENTRY(zbx_pp_manager_thread, args)
 				case ZBX_IPC_PREPROCESSOR_REQUEST:
 					queued_num += preprocessor_add_request(manager, message, &direct_num);
 					break;
+				case ZBX_IPC_PREPROCESSOR_RING:
+					preprocessor_attach_ring(client);
+					break;
 				case ZBX_IPC_PREPROCESSOR_QUEUE:
 					preprocessor_reply_queue_size(manager, client);
 					break;
@@ -1346,7 +1448,14 @@ ZBX_THREAD_ENTRY(zbx_pp_manager_thread, args)
 		}
 
 		if (NULL != client)
+		{
+			zbx_ipc_ring_t	*ring;
+
+			if (NULL != (ring = zbx_ipc_client_get_ring(client)))
+				queued_num += preprocessor_add_ring_values(manager, ring, &direct_num);
+
 			zbx_ipc_client_release(client);
+		}
 
 		zbx_pp_manager_process_finished(manager, &tasks, &pending_num, &processing_num, &finished_num);
 
@@ -1376,6 +1485,7 @@ ZBX_THREAD_ENTRY(zbx_pp_manager_thread, args)
 						ZBX_RTC_HISTORY_SYNC_NOTIFY, NULL, 0);
 			}
 
+			pp_capture_flush();
 			time_flush = sec;
 		}
 
@@ -1399,6 +1509,7 @@ ZBX_THREAD_ENTRY(zbx_pp_manager_thread, args)
 out:
 	zbx_setproctitle("%s #%d [terminating]", get_process_type_string(process_type), process_num);
 
+	pp_capture_destroy();
 	zbx_vector_pp_task_ptr_destroy(&tasks);
 	zbx_pp_manager_free(manager);
 
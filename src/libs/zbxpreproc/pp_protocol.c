@@ -32,6 +32,13 @@
 static zbx_ipc_message_t	cached_message;
 static int			cached_values;
 
+/* each process has a permanent connection to preprocessing manager */
+static zbx_ipc_socket_t		preproc_socket = {0};
+
+/* optional shared memory ring for sending values to preprocessing manager */
+static zbx_ipc_ring_t		*preproc_ring = NULL;
+static zbx_uint32_t		preproc_ring_size = 0;
+
 ZBX_PTR_VECTOR_IMPL(ipcmsg, zbx_ipc_message_t *)
 
 static zbx_uint32_t	fields_calc_size(zbx_packed_field_t *fields, int fields_num)
@@ -124,11 +131,44 @@ static zbx_uint32_t	message_pack_data(zbx_ipc_message_t *message, zbx_packed_fie
 	return data_size;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: helper for data packing directly into preprocessing ring          *
+ *                                                                            *
+ * Parameters: fields  - [IN] definition of data to be packed                 *
+ *             count   - [IN] field count                                     *
+ *                                                                            *
+ * Return value: size of packed data or 0 if the data does not fit in ring    *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_uint32_t	ring_pack_data(zbx_packed_field_t *fields, int count)
+{
+	zbx_uint32_t	data_size;
+	unsigned char	*data;
+
+	if (0 == (data_size = fields_calc_size(fields, count)) ||
+			zbx_ipc_ring_max_record_size(preproc_ring) < data_size)
+	{
+		return 0;
+	}
+
+	if (NULL == (data = zbx_ipc_ring_reserve(preproc_ring, data_size, &preproc_socket)))
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "cannot send data to preprocessing service");
+		exit(EXIT_FAILURE);
+	}
+
+	fields_pack(fields, count, data);
+	zbx_ipc_ring_commit(preproc_ring, data_size);
+
+	return data_size;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: pack item value data into a single buffer that can be used in IPC *
  *                                                                            *
- * Parameters: message - [OUT] IPC message                                    *
+ * Parameters: message - [OUT] IPC message, NULL to pack into ring            *
  *             value   - [IN] value to be packed                              *
  *                                                                            *
  * Return value: size of packed data                                          *
@@ -182,6 +222,9 @@ static zbx_uint32_t	preprocessor_pack_value(zbx_ipc_message_t *message, zbx_prep
 		}
 	}
 
+	if (NULL == message)
+		return ring_pack_data(fields, (int)(offset - fields));
+
 	return message_pack_data(message, fields, (int)(offset - fields));
 }
 
@@ -598,13 +641,14 @@ zbx_uint32_t	zbx_preprocessor_pack_top_stats_result(unsigned char **data, zbx_ve
  * Return value: size of packed data                                          *
  *                                                                            *
  ******************************************************************************/
-zbx_uint32_t	zbx_preprocessor_unpack_value(zbx_preproc_item_value_t *value, unsigned char *data)
+zbx_uint32_t	zbx_preprocessor_unpack_value(zbx_preproc_item_value_t *value, const unsigned char *data)
 {
-	zbx_uint32_t	value_len;
-	zbx_timespec_t	*timespec = NULL;
-	AGENT_RESULT	*agent_result = NULL;
-	zbx_log_t	*log = NULL;
-	unsigned char	*offset = data, ts_marker, result_marker, log_marker;
+	zbx_uint32_t		value_len;
+	zbx_timespec_t		*timespec = NULL;
+	AGENT_RESULT		*agent_result = NULL;
+	zbx_log_t		*log = NULL;
+	const unsigned char	*offset = data;
+	unsigned char		ts_marker, result_marker, log_marker;
 
 	offset += zbx_deserialize_uint64(offset, &value->itemid);
 	offset += zbx_deserialize_uint64(offset, &value->hostid);
@@ -786,6 +830,61 @@ void	zbx_preprocessor_unpack_top_stats_result(zbx_vector_pp_top_stats_ptr_t *sta
 	}
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: sets size of shared memory ring used to send values to            *
+ *          preprocessing manager                                             *
+ *                                                                            *
+ * Parameters: size - [IN] the ring size, 0 - values are sent over socket     *
+ *                                                                            *
+ * Comments: Must be called before the processes are forked.                  *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_preprocessor_set_ring_size(zbx_uint64_t size)
+{
+	preproc_ring_size = (zbx_uint32_t)size;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: connects to preprocessing manager if not connected                *
+ *                                                                            *
+ * Comments: If shared memory ring is configured, it is created and sent to   *
+ *           preprocessing manager. On failure to create the ring values are  *
+ *           sent over socket.                                                *
+ *                                                                            *
+ ******************************************************************************/
+static void	preprocessor_connect(void)
+{
+	char	*error = NULL;
+
+	if (0 != preproc_socket.fd)
+		return;
+
+	if (FAIL == zbx_ipc_socket_open(&preproc_socket, ZBX_IPC_SERVICE_PREPROCESSING, SEC_PER_MIN, &error))
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "cannot connect to preprocessing service: %s", error);
+		exit(EXIT_FAILURE);
+	}
+
+	if (0 == preproc_ring_size)
+		return;
+
+	if (SUCCEED != zbx_ipc_ring_create(&preproc_ring, preproc_ring_size, &error))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot create shared memory ring for preprocessing, values will be"
+				" sent over socket: %s", error);
+		zbx_free(error);
+		return;
+	}
+
+	if (SUCCEED != zbx_ipc_socket_send_ring(&preproc_socket, ZBX_IPC_PREPROCESSOR_RING, preproc_ring))
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "cannot send data to preprocessing service");
+		exit(EXIT_FAILURE);
+	}
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: sends command to preprocessor manager                             *
@@ -800,24 +899,15 @@ void	zbx_preprocessor_unpack_top_stats_result(zbx_vector_pp_top_stats_ptr_t *sta
 static void	preprocessor_send(zbx_uint32_t code, unsigned char *data, zbx_uint32_t size,
 		zbx_ipc_message_t *response)
 {
-	char			*error = NULL;
-	static zbx_ipc_socket_t	socket = {0};
+	preprocessor_connect();
 
-	/* each process has a permanent connection to preprocessing manager */
-	if (0 == socket.fd && FAIL == zbx_ipc_socket_open(&socket, ZBX_IPC_SERVICE_PREPROCESSING, SEC_PER_MIN,
-			&error))
-	{
-		zabbix_log(LOG_LEVEL_CRIT, "cannot connect to preprocessing service: %s", error);
-		exit(EXIT_FAILURE);
-	}
-
-	if (FAIL == zbx_ipc_socket_write(&socket, code, data, size))
+	if (FAIL == zbx_ipc_socket_write(&preproc_socket, code, data, size))
 	{
 		zabbix_log(LOG_LEVEL_CRIT, "cannot send data to preprocessing service");
 		exit(EXIT_FAILURE);
 	}
 
-	if (NULL != response && FAIL == zbx_ipc_socket_read(&socket, response))
+	if (NULL != response && FAIL == zbx_ipc_socket_read(&preproc_socket, response))
 	{
 		zabbix_log(LOG_LEVEL_CRIT, "cannot receive data from preprocessing service");
 		exit(EXIT_FAILURE);
@@ -881,10 +971,28 @@ void	zbx_preprocess_item_value(zbx_uint64_t itemid, zbx_uint64_t hostid, unsigne
 		}
 	}
 
-	if (0 == preprocessor_pack_value(&cached_message, &value))
+	preprocessor_connect();
+
+	if (NULL == preproc_ring)
 	{
-		zbx_preprocessor_flush();
+		if (0 == preprocessor_pack_value(&cached_message, &value))
+		{
+			zbx_preprocessor_flush();
+			preprocessor_pack_value(&cached_message, &value);
+		}
+	}
+	else if (0 == preprocessor_pack_value(NULL, &value))
+	{
+		/* the value does not fit in ring - send it over socket after the values */
+		/* already written to ring are processed to keep the value order        */
+		if (SUCCEED != zbx_ipc_ring_flush(preproc_ring, &preproc_socket))
+		{
+			zabbix_log(LOG_LEVEL_CRIT, "cannot send data to preprocessing service");
+			exit(EXIT_FAILURE);
+		}
+
 		preprocessor_pack_value(&cached_message, &value);
+		zbx_preprocessor_flush();
 	}
 
 	if (ZBX_PREPROCESSING_BATCH_SIZE < ++cached_values)
@@ -900,6 +1008,12 @@ void	zbx_preprocess_item_value(zbx_uint64_t itemid, zbx_uint64_t hostid, unsigne
  ******************************************************************************/
 void	zbx_preprocessor_flush(void)
 {
+	if (NULL != preproc_ring && 0 != cached_values)
+	{
+		zbx_ipc_ring_notify(preproc_ring);
+		cached_values = 0;
+	}
+
 	if (0 < cached_message.size)
 	{
 		preprocessor_send(ZBX_IPC_PREPROCESSOR_REQUEST, cached_message.data, cached_message.size, NULL);
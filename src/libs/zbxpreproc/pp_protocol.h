@@ -34,6 +34,7 @@
 #define ZBX_IPC_PREPROCESSOR_TOP_STATS_RESULT		10008
 #define ZBX_IPC_PREPROCESSOR_USAGE_STATS		10009
 #define ZBX_IPC_PREPROCESSOR_TOP_PEAK			10010
+#define ZBX_IPC_PREPROCESSOR_RING			10011
 
 /* item value data used in preprocessing manager */
 typedef struct
@@ -60,7 +61,7 @@ typedef struct
 }
 zbx_packed_field_t;
 
-zbx_uint32_t	zbx_preprocessor_unpack_value(zbx_preproc_item_value_t *value, unsigned char *data);
+zbx_uint32_t	zbx_preprocessor_unpack_value(zbx_preproc_item_value_t *value, const unsigned char *data);
 
 void	zbx_preprocessor_unpack_test_request(zbx_pp_item_preproc_t *preproc, zbx_variant_t *value, zbx_timespec_t *ts,
 		const unsigned char *data);
@@ -21,6 +21,10 @@
 #define PP_TASK_QUEUE_INIT_LOCK		0x01
 #define PP_TASK_QUEUE_INIT_EVENT	0x02
 
+#define PP_ATOMIC_LOAD(var)		__atomic_load_n(&(var), __ATOMIC_RELAXED)
+#define PP_ATOMIC_INC(var)		__atomic_add_fetch(&(var), 1, __ATOMIC_RELAXED)
+#define PP_ATOMIC_DEC(var)		__atomic_sub_fetch(&(var), 1, __ATOMIC_RELAXED)
+
 ZBX_PTR_VECTOR_IMPL(pp_top_stats_ptr, zbx_pp_top_stats_t *)
 
 /* task sequence registry by itemid */
@@ -35,14 +39,15 @@ zbx_pp_item_task_sequence_t;
  *                                                                            *
  * Purpose: initialize task queue                                             *
  *                                                                            *
- * Parameters: queue - [IN] task queue                                        *
- *             error - [OUT]                                                  *
+ * Parameters: queue       - [IN] task queue                                  *
+ *             workers_num - [IN] number of workers                           *
+ *             error       - [OUT]                                            *
  *                                                                            *
  * Return value: SUCCEED - the task queue was initialized successfully        *
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-int	pp_task_queue_init(zbx_pp_queue_t *queue, char **error)
+int	pp_task_queue_init(zbx_pp_queue_t *queue, int workers_num, char **error)
 {
 	int	err, ret = FAIL;
 
@@ -50,12 +55,33 @@ int	pp_task_queue_init(zbx_pp_queue_t *queue, char **error)
 	queue->pending_num = 0;
 	queue->finished_num = 0;
 	queue->processing_num = 0;
-	zbx_list_create(&queue->pending);
-	zbx_list_create(&queue->immediate);
+	queue->queued_num = 0;
+	queue->finished_stack = NULL;
 	zbx_list_create(&queue->finished);
 
 	zbx_hashset_create(&queue->sequences, 100, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 
+	queue->worker_queues = (zbx_pp_worker_queue_t *)zbx_malloc(NULL,
+			sizeof(zbx_pp_worker_queue_t) * (size_t)workers_num);
+	queue->worker_queues_num = 0;
+	queue->worker_queues_next = 0;
+
+	for (int i = 0; i < workers_num; i++)
+	{
+		zbx_pp_worker_queue_t	*worker_queue = &queue->worker_queues[i];
+
+		if (0 != (err = pthread_mutex_init(&worker_queue->lock, NULL)))
+		{
+			*error = zbx_dsprintf(NULL, "cannot initialize worker task queue mutex: %s",
+					zbx_strerror(err));
+			goto out;
+		}
+
+		zbx_list_create(&worker_queue->pending);
+		zbx_list_create(&worker_queue->immediate);
+		queue->worker_queues_num++;
+	}
+
 	if (0 != (err = pthread_mutex_init(&queue->lock, NULL)))
 	{
 		*error = zbx_dsprintf(NULL, "cannot initialize task queue mutex: %s", zbx_strerror(err));
@@ -98,17 +124,35 @@ static void	pp_task_queue_clear_tasks(zbx_list_t *tasks)
  ******************************************************************************/
 void	pp_task_queue_destroy(zbx_pp_queue_t *queue)
 {
+	zbx_pp_task_t	*task;
+
 	if (0 != (queue->init_flags & PP_TASK_QUEUE_INIT_LOCK))
 		pthread_mutex_destroy(&queue->lock);
 
 	if (0 != (queue->init_flags & PP_TASK_QUEUE_INIT_EVENT))
 		pthread_cond_destroy(&queue->event);
 
-	pp_task_queue_clear_tasks(&queue->pending);
-	zbx_list_destroy(&queue->pending);
+	for (int i = 0; i < queue->worker_queues_num; i++)
+	{
+		zbx_pp_worker_queue_t	*worker_queue = &queue->worker_queues[i];
+
+		pthread_mutex_destroy(&worker_queue->lock);
+
+		pp_task_queue_clear_tasks(&worker_queue->pending);
+		zbx_list_destroy(&worker_queue->pending);
+
+		pp_task_queue_clear_tasks(&worker_queue->immediate);
+		zbx_list_destroy(&worker_queue->immediate);
+	}
+
+	zbx_free(queue->worker_queues);
+	queue->worker_queues_num = 0;
 
-	pp_task_queue_clear_tasks(&queue->immediate);
-	zbx_list_destroy(&queue->immediate);
+	while (NULL != (task = queue->finished_stack))
+	{
+		queue->finished_stack = task->next;
+		pp_task_free(task);
+	}
 
 	pp_task_queue_clear_tasks(&queue->finished);
 	zbx_list_destroy(&queue->finished);
@@ -194,6 +238,38 @@ static zbx_pp_task_t	*pp_task_queue_add_sequence(zbx_pp_queue_t *queue, zbx_pp_t
 	return new_task;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: queue task to the next worker queue                               *
+ *                                                                            *
+ * Parameters: queue     - [IN] task queue                                    *
+ *             task      - [IN] task to push                                  *
+ *             immediate - [IN] 1 - task must be processed before normal      *
+ *                                  tasks of the same worker queue            *
+ *                              0 - otherwise                                 *
+ *                                                                            *
+ * Comments: Tasks are distributed between worker queues in round robin       *
+ *           order, idle workers steal tasks from other worker queues.        *
+ *           Immediate tasks take priority only within their worker queue, a  *
+ *           worker pops pending tasks from its own queue before stealing     *
+ *           immediate tasks from other queues.                               *
+ *                                                                            *
+ ******************************************************************************/
+static void	pp_task_queue_push_worker(zbx_pp_queue_t *queue, zbx_pp_task_t *task, int immediate)
+{
+	zbx_pp_worker_queue_t	*worker_queue = &queue->worker_queues[queue->worker_queues_next];
+
+	if (++queue->worker_queues_next == queue->worker_queues_num)
+		queue->worker_queues_next = 0;
+
+	pthread_mutex_lock(&worker_queue->lock);
+	(void)zbx_list_append(0 != immediate ? &worker_queue->immediate : &worker_queue->pending, task, NULL);
+
+	/* count the task before it can be popped by worker, so the counter cannot underflow */
+	PP_ATOMIC_INC(queue->queued_num);
+	pthread_mutex_unlock(&worker_queue->lock);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: queue task to be processed before normal tasks                    *
@@ -208,7 +284,7 @@ void	pp_task_queue_push_immediate(zbx_pp_queue_t *queue, zbx_pp_task_t *task)
 	{
 		case ZBX_PP_TASK_VALUE_SEQ:
 		case ZBX_PP_TASK_DEPENDENT:
-			queue->pending_num++;
+			PP_ATOMIC_INC(queue->pending_num);
 			if (NULL == (task = pp_task_queue_add_sequence(queue, task)))
 				return;
 			break;
@@ -217,11 +293,11 @@ void	pp_task_queue_push_immediate(zbx_pp_queue_t *queue, zbx_pp_task_t *task)
 			/* so there is no need to increment queue->pending_num                                */
 			break;
 		default:
-			queue->pending_num++;
+			PP_ATOMIC_INC(queue->pending_num);
 			break;
 	}
 
-	(void)zbx_list_append(&queue->immediate, task, NULL);
+	pp_task_queue_push_worker(queue, task, 1);
 }
 
 /******************************************************************************
@@ -247,8 +323,8 @@ void	pp_task_queue_remove_sequence(zbx_pp_queue_t *queue, zbx_uint64_t itemid)
  ******************************************************************************/
 void	pp_task_queue_push_test(zbx_pp_queue_t *queue, zbx_pp_task_t *task)
 {
-	queue->pending_num++;
-	(void)zbx_list_append(&queue->immediate, task, NULL);
+	PP_ATOMIC_INC(queue->pending_num);
+	pp_task_queue_push_worker(queue, task, 1);
 }
 
 /******************************************************************************
@@ -259,79 +335,98 @@ void	pp_task_queue_push_test(zbx_pp_queue_t *queue, zbx_pp_task_t *task)
  *             task  - [IN] task                                              *
  *                                                                            *
  * Comments: This function is used to push tasks created by new preprocessing *
- *           or testing requests.                                             *
+ *           or testing requests. Sequential value tasks are added to item    *
+ *           task sequences here, so workers never access the sequences.      *
  *                                                                            *
  ******************************************************************************/
 void	pp_task_queue_push(zbx_pp_queue_t *queue, zbx_pp_task_t *task)
 {
 	zbx_pp_task_value_t	*d = (zbx_pp_task_value_t *)PP_TASK_DATA(task);
-	queue->pending_num++;
+	int			immediate;
 
-	if (ITEM_TYPE_INTERNAL != d->preproc->type)
-	{
-		(void)zbx_list_append(&queue->pending, task, NULL);
+	PP_ATOMIC_INC(queue->pending_num);
+
+	immediate = (ITEM_TYPE_INTERNAL == d->preproc->type ? 1 : 0);
+
+	if (ZBX_PP_TASK_VALUE_SEQ == task->type && NULL == (task = pp_task_queue_add_sequence(queue, task)))
 		return;
-	}
 
-	if (ZBX_PP_TASK_VALUE == task->type)
+	pp_task_queue_push_worker(queue, task, immediate);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: pop task from worker queue                                        *
+ *                                                                            *
+ * Parameters: worker_queue - [IN]                                            *
+ *             steal        - [IN] 1 - do not wait if worker queue is locked  *
+ *                                 0 - otherwise                              *
+ *                                                                            *
+ * Return value: The popped task or NULL if there are no tasks in worker      *
+ *               queue or it was locked.                                      *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_pp_task_t	*pp_worker_queue_pop(zbx_pp_worker_queue_t *worker_queue, int steal)
+{
+	zbx_pp_task_t	*task = NULL;
+
+	if (0 != steal)
 	{
-		(void)zbx_list_append(&queue->immediate, task, NULL);
-		return;
+		if (0 != pthread_mutex_trylock(&worker_queue->lock))
+			return NULL;
 	}
+	else
+		pthread_mutex_lock(&worker_queue->lock);
 
-	zbx_pp_task_t	*seq_task;
+	if (SUCCEED != zbx_list_pop(&worker_queue->immediate, (void **)&task))
+		(void)zbx_list_pop(&worker_queue->pending, (void **)&task);
 
-	if (NULL != (seq_task = pp_task_queue_add_sequence(queue, task)))
-		(void)zbx_list_append(&queue->immediate, seq_task, NULL);
+	pthread_mutex_unlock(&worker_queue->lock);
+
+	return task;
 }
 
 /******************************************************************************
  *                                                                            *
  * Purpose: pop task from task queue                                          *
  *                                                                            *
- * Parameters: queue - [IN] task queue                                        *
+ * Parameters: queue        - [IN] task queue                                 *
+ *             worker_index - [IN] index of the worker queue                  *
  *                                                                            *
  * Return value: The popped task or NULL if there are no tasks to be          *
  *               processed.                                                   *
  *                                                                            *
  * Comments: This function is used by workers to pop tasks for processing.    *
- *           Sequence tasks will be moved to existing tasks sequences or      *
- *           returned if there are no registered sequences for this item.     *
+ *           Tasks are taken from the worker's own queue first and stolen     *
+ *           from other worker queues when it is empty.                       *
  *                                                                            *
  ******************************************************************************/
-zbx_pp_task_t	*pp_task_queue_pop_new(zbx_pp_queue_t *queue)
+zbx_pp_task_t	*pp_task_queue_pop_new(zbx_pp_queue_t *queue, int worker_index)
 {
-	zbx_pp_task_t	*task = NULL;
-
-	if (SUCCEED == zbx_list_pop(&queue->immediate, (void **)&task))
-	{
-		/* while sequence tasks do not affect statistics, the first task in sequence */
-		/* does, so the statistics can be updated for all tasks                      */
-		queue->pending_num--;
-		queue->processing_num++;
-
-		return (zbx_pp_task_t *)task;
-	}
+	zbx_pp_task_t	*task;
 
-	while (SUCCEED == zbx_list_pop(&queue->pending, (void **)&task))
+	if (NULL == (task = pp_worker_queue_pop(&queue->worker_queues[worker_index], 0)))
 	{
-		if (ZBX_PP_TASK_VALUE_SEQ == task->type)
+		for (int i = 1; i < queue->worker_queues_num && 0 != PP_ATOMIC_LOAD(queue->queued_num); i++)
 		{
-			/* task is being moved from pending to immediate queue */
-			/* while still pending, so statistics are not affected */
-			task = pp_task_queue_add_sequence(queue, task);
-		}
+			int	index = (worker_index + i) % queue->worker_queues_num;
 
-		if (NULL != task)
-		{
-			queue->pending_num--;
-			queue->processing_num++;
-
-			return task;
+			if (NULL != (task = pp_worker_queue_pop(&queue->worker_queues[index], 1)))
+				break;
 		}
+
+		if (NULL == task)
+			return NULL;
 	}
 
-	return NULL;
+	PP_ATOMIC_DEC(queue->queued_num);
+
+	/* while sequence tasks do not affect statistics, the first task in sequence */
+	/* does, so the statistics can be updated for all tasks                      */
+	PP_ATOMIC_DEC(queue->pending_num);
+	PP_ATOMIC_INC(queue->processing_num);
+
+	return task;
 }
 
 /******************************************************************************
@@ -341,12 +436,32 @@ zbx_pp_task_t	*pp_task_queue_pop_new(zbx_pp_queue_t *queue)
  * Parameters: queue - [IN] task queue                                        *
  *             task  - [IN] task                                              *
  *                                                                            *
+ * Return value: SUCCEED - there were no other unprocessed finished tasks, so *
+ *                         manager must be notified                           *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: Finished tasks are pushed to a lock-free stack without taking    *
+ *           any locks. Manager takes the whole stack at once, so the stack   *
+ *           is not affected by ABA problem.                                  *
+ *                                                                            *
  ******************************************************************************/
-void	pp_task_queue_push_finished(zbx_pp_queue_t *queue, zbx_pp_task_t *task)
+int	pp_task_queue_push_finished(zbx_pp_queue_t *queue, zbx_pp_task_t *task)
 {
-	queue->finished_num++;
-	queue->processing_num--;
-	(void)zbx_list_append(&queue->finished, task, NULL);
+	zbx_pp_task_t	*head;
+
+	PP_ATOMIC_INC(queue->finished_num);
+	PP_ATOMIC_DEC(queue->processing_num);
+
+	head = __atomic_load_n(&queue->finished_stack, __ATOMIC_RELAXED);
+
+	do
+	{
+		task->next = head;
+	}
+	while (0 == __atomic_compare_exchange_n(&queue->finished_stack, &head, task, 1, __ATOMIC_RELEASE,
+			__ATOMIC_RELAXED));
+
+	return NULL == head ? SUCCEED : FAIL;
 }
 
 /******************************************************************************
@@ -357,18 +472,51 @@ void	pp_task_queue_push_finished(zbx_pp_queue_t *queue, zbx_pp_task_t *task)
  *                                                                            *
  * Return value: The popped task or NULL if there are no finished tasks.      *
  *                                                                            *
+ * Comments: This function is used only by manager.                           *
+ *                                                                            *
  ******************************************************************************/
 zbx_pp_task_t	*pp_task_queue_pop_finished(zbx_pp_queue_t *queue)
 {
 	zbx_pp_task_t	*task;
 
-	if (SUCCEED == zbx_list_pop(&queue->finished, (void **)&task))
+	if (SUCCEED != zbx_list_pop(&queue->finished, (void **)&task))
 	{
-		queue->finished_num--;
-		return task;
+		zbx_pp_task_t	*next;
+
+		if (NULL == (task = __atomic_exchange_n(&queue->finished_stack, NULL, __ATOMIC_ACQUIRE)))
+			return NULL;
+
+		/* stack contains tasks in reverse order, prepending restores the finishing order */
+		for (; NULL != task; task = next)
+		{
+			next = task->next;
+			(void)zbx_list_prepend(&queue->finished, task, NULL);
+		}
+
+		(void)zbx_list_pop(&queue->finished, (void **)&task);
 	}
 
-	return NULL;
+	PP_ATOMIC_DEC(queue->finished_num);
+
+	return task;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get task queue statistics                                         *
+ *                                                                            *
+ * Parameters: queue          - [IN] task queue                               *
+ *             pending_num    - [OUT] pending tasks                           *
+ *             processing_num - [OUT] tasks being processed                   *
+ *             finished_num   - [OUT] finished tasks                          *
+ *                                                                            *
+ ******************************************************************************/
+void	pp_task_queue_get_stats(zbx_pp_queue_t *queue, zbx_uint64_t *pending_num, zbx_uint64_t *processing_num,
+		zbx_uint64_t *finished_num)
+{
+	*pending_num = PP_ATOMIC_LOAD(queue->pending_num);
+	*processing_num = PP_ATOMIC_LOAD(queue->processing_num);
+	*finished_num = PP_ATOMIC_LOAD(queue->finished_num);
 }
 
 /******************************************************************************
@@ -381,19 +529,29 @@ zbx_pp_task_t	*pp_task_queue_pop_finished(zbx_pp_queue_t *queue)
  * Return value: SUCCEED - the wait succeeded                                 *
  *               FAIL    - an error has occurred                              *
  *                                                                            *
- * Comments: This function is used by workers to wait for new tasks.          *
+ * Comments: This function is used by workers to wait for new tasks. It must  *
+ *           be called with task queue locked. Tasks are pushed to worker     *
+ *           queues before locking task queue for notification, so checking  *
+ *           queued tasks under lock does not lose notifications.             *
  *                                                                            *
  ******************************************************************************/
 int	pp_task_queue_wait(zbx_pp_queue_t *queue, char **error)
 {
 	int	err;
 
+	if (0 != PP_ATOMIC_LOAD(queue->queued_num))
+		return SUCCEED;
+
 	if (0 != (err = pthread_cond_wait(&queue->event, &queue->lock)))
 	{
 		*error = zbx_dsprintf(NULL, "cannot wait for conditional variable: %s", zbx_strerror(err));
 		return FAIL;
 	}
 
+	/* wake up another worker if there are more tasks queued */
+	if (1 < PP_ATOMIC_LOAD(queue->queued_num))
+		pp_task_queue_notify(queue);
+
 	return SUCCEED;
 }
 
@@ -453,8 +611,6 @@ void	pp_task_queue_get_sequence_stats(zbx_pp_queue_t *queue, zbx_vector_pp_top_s
 	zbx_pp_top_stats_t		*stat;
 	zbx_list_iterator_t		li;
 
-	pp_task_queue_lock(queue);
-
 	zbx_hashset_iter_reset(&queue->sequences, &iter);
 	while (NULL != (sequence = (zbx_pp_item_task_sequence_t *)zbx_hashset_iter_next(&iter)))
 	{
@@ -477,7 +633,4 @@ void	pp_task_queue_get_sequence_stats(zbx_pp_queue_t *queue, zbx_vector_pp_top_s
 
 		zbx_vector_pp_top_stats_ptr_append(stats, stat);
 	}
-
-	pp_task_queue_unlock(queue);
-
 }
@@ -18,26 +18,45 @@
 #include "zbxpreproc.h"
 #include "zbxalgo.h"
 
+/* per worker task queue, other workers steal tasks from it when idle */
+typedef struct
+{
+	zbx_list_t	pending;
+	zbx_list_t	immediate;
+
+	pthread_mutex_t	lock;
+}
+zbx_pp_worker_queue_t;
+
 typedef struct
 {
 	zbx_uint32_t	init_flags;
 	int		workers_num;
+
+	/* task counters are updated by both manager and workers, so they must be accessed atomically */
 	zbx_uint64_t	pending_num;
 	zbx_uint64_t	finished_num;
 	zbx_uint64_t	processing_num;
+	zbx_uint64_t	queued_num;	/* number of tasks in worker queues */
 
+	/* task sequences are accessed only by manager */
 	zbx_hashset_t	sequences;
 
-	zbx_list_t	pending;
-	zbx_list_t	immediate;
+	zbx_pp_worker_queue_t	*worker_queues;
+	int			worker_queues_num;
+	int			worker_queues_next;
+
+	/* finished tasks are pushed by workers to a lock-free stack and moved to the list by manager */
+	zbx_pp_task_t	*finished_stack;
 	zbx_list_t	finished;
 
+	/* lock and event are used only for worker registration, sleeping and waking up */
 	pthread_mutex_t	lock;
 	pthread_cond_t	event;
 }
 zbx_pp_queue_t;
 
-int	pp_task_queue_init(zbx_pp_queue_t *queue, char **error);
+int	pp_task_queue_init(zbx_pp_queue_t *queue, int workers_num, char **error);
 void	pp_task_queue_destroy(zbx_pp_queue_t *queue);
 
 void	pp_task_queue_lock(zbx_pp_queue_t *queue);
@@ -53,11 +72,13 @@ void	pp_task_queue_notify_all(zbx_pp_queue_t *queue);
 void	pp_task_queue_push_test(zbx_pp_queue_t *queue, zbx_pp_task_t *task);
 void	pp_task_queue_push(zbx_pp_queue_t *queue, zbx_pp_task_t *task);
 
-zbx_pp_task_t	*pp_task_queue_pop_new(zbx_pp_queue_t *queue);
+zbx_pp_task_t	*pp_task_queue_pop_new(zbx_pp_queue_t *queue, int worker_index);
 void	pp_task_queue_push_immediate(zbx_pp_queue_t *queue, zbx_pp_task_t *task);
-void	pp_task_queue_push_finished(zbx_pp_queue_t *queue, zbx_pp_task_t *task);
+int	pp_task_queue_push_finished(zbx_pp_queue_t *queue, zbx_pp_task_t *task);
 zbx_pp_task_t	*pp_task_queue_pop_finished(zbx_pp_queue_t *queue);
 
+void	pp_task_queue_get_stats(zbx_pp_queue_t *queue, zbx_uint64_t *pending_num, zbx_uint64_t *processing_num,
+		zbx_uint64_t *finished_num);
 void	pp_task_queue_get_sequence_stats(zbx_pp_queue_t *queue, zbx_vector_pp_top_stats_ptr_t *stats);
 
 #endif
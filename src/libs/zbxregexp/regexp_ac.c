@@ -0,0 +1,267 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "regexp_ac.h"
+
+#include "zbxregexp.h"
+
+/* Below this number of case sensitive literals searching them one by one with strstr() is faster than */
+/* the automaton scan, as libc string search is vectorized.                                            */
+#define REGEXP_AC_DIRECT_MAX	30
+
+void	regexp_ac_init(zbx_regexp_ac_t *ac)
+{
+	memset(ac, 0, sizeof(zbx_regexp_ac_t));
+}
+
+void	regexp_ac_destroy(zbx_regexp_ac_t *ac)
+{
+	int	i;
+
+	for (i = 0; i < ac->literals_num; i++)
+		zbx_free(ac->literals[i].str);
+
+	zbx_free(ac->literals);
+	zbx_free(ac->delta);
+	zbx_free(ac->state_literal);
+	zbx_free(ac->state_output);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds literal to automaton                                         *
+ *                                                                            *
+ * Parameters: ac             - [IN] automaton, not compiled yet              *
+ *             str            - [IN] literal                                  *
+ *             len            - [IN] literal length, must be positive         *
+ *             case_sensitive - [IN] ZBX_CASE_SENSITIVE or ZBX_IGNORE_CASE    *
+ *                                                                            *
+ * Return value: literal identifier - index in 'found' array filled by        *
+ *               regexp_ac_scan()                                             *
+ *                                                                            *
+ * Comments: Case insensitive comparison is done with tolower() like with     *
+ *           zbx_strcasestr().                                                *
+ *                                                                            *
+ ******************************************************************************/
+int	regexp_ac_add(zbx_regexp_ac_t *ac, const char *str, size_t len, int case_sensitive)
+{
+	int			i;
+	zbx_regexp_ac_literal_t	*literal;
+
+	for (i = 0; i < ac->literals_num; i++)
+	{
+		literal = &ac->literals[i];
+
+		if (literal->len == len && literal->case_sensitive == case_sensitive &&
+				0 == memcmp(literal->str, str, len))
+		{
+			return i;
+		}
+	}
+
+	if (ac->literals_num == ac->literals_alloc)
+	{
+		ac->literals_alloc = (0 == ac->literals_alloc ? 8 : ac->literals_alloc * 2);
+		ac->literals = (zbx_regexp_ac_literal_t *)zbx_realloc(ac->literals,
+				sizeof(zbx_regexp_ac_literal_t) * (size_t)ac->literals_alloc);
+	}
+
+	literal = &ac->literals[ac->literals_num];
+	literal->str = (char *)zbx_malloc(NULL, len + 1);
+	memcpy(literal->str, str, len);
+	literal->str[len] = '\0';
+	literal->len = len;
+	literal->case_sensitive = case_sensitive;
+	literal->next = -1;
+
+	return ac->literals_num++;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: builds transition table from added literals                       *
+ *                                                                            *
+ * Comments: The trie is built over case folded input classes, then failure   *
+ *           transitions are resolved in breadth first order, so each input   *
+ *           byte is processed with one table lookup. Case sensitive literals *
+ *           are verified when found.                                         *
+ *           Small sets of case sensitive literals are not compiled, they are *
+ *           searched one by one.                                             *
+ *                                                                            *
+ ******************************************************************************/
+void	regexp_ac_compile(zbx_regexp_ac_t *ac)
+{
+	int	i, c, states_max = 1, *fail, *queue, queue_head = 0, queue_tail = 0;
+	size_t	j;
+
+	if (REGEXP_AC_DIRECT_MAX > ac->literals_num)
+	{
+		for (i = 0; i < ac->literals_num && ZBX_CASE_SENSITIVE == ac->literals[i].case_sensitive; i++)
+			;
+
+		if (i == ac->literals_num)
+		{
+			ac->direct = 1;
+			return;
+		}
+	}
+
+	memset(ac->classes, 0, sizeof(ac->classes));
+	ac->classes_num = 1;
+
+	for (i = 0; i < ac->literals_num; i++)
+	{
+		const zbx_regexp_ac_literal_t	*literal = &ac->literals[i];
+
+		for (j = 0; j < literal->len; j++)
+		{
+			c = tolower((unsigned char)literal->str[j]);
+
+			if (0 == ac->classes[c])
+				ac->classes[c] = (unsigned char)ac->classes_num++;
+		}
+
+		states_max += (int)literal->len;
+	}
+
+	for (c = 0; c < 256; c++)
+		ac->classes[c] = ac->classes[tolower(c)];
+
+	ac->delta = (int *)zbx_calloc(NULL, (size_t)states_max * (size_t)ac->classes_num, sizeof(int));
+	ac->state_literal = (int *)zbx_malloc(NULL, (size_t)states_max * sizeof(int));
+	ac->state_output = (int *)zbx_calloc(NULL, (size_t)states_max, sizeof(int));
+	ac->states_num = 1;
+	ac->state_literal[0] = -1;
+
+	/* build trie, 0 marks missing transition as root cannot be a child */
+	for (i = 0; i < ac->literals_num; i++)
+	{
+		zbx_regexp_ac_literal_t	*literal = &ac->literals[i];
+		int			state = 0, *next;
+
+		for (j = 0; j < literal->len; j++)
+		{
+			next = &ac->delta[state * ac->classes_num + ac->classes[(unsigned char)literal->str[j]]];
+
+			if (0 == *next)
+			{
+				*next = ac->states_num;
+				ac->state_literal[ac->states_num++] = -1;
+			}
+
+			state = *next;
+		}
+
+		literal->next = ac->state_literal[state];
+		ac->state_literal[state] = i;
+	}
+
+	fail = (int *)zbx_calloc(NULL, (size_t)ac->states_num, sizeof(int));
+	queue = (int *)zbx_malloc(NULL, (size_t)ac->states_num * sizeof(int));
+	queue[queue_tail++] = 0;
+
+	while (queue_head < queue_tail)
+	{
+		int	state = queue[queue_head++];
+
+		for (c = 0; c < ac->classes_num; c++)
+		{
+			int	*next = &ac->delta[state * ac->classes_num + c], child;
+
+			if (0 == *next)
+			{
+				if (0 != state)
+					*next = ac->delta[fail[state] * ac->classes_num + c];
+
+				continue;
+			}
+
+			child = *next;
+			fail[child] = (0 == state ? 0 : ac->delta[fail[state] * ac->classes_num + c]);
+
+			if (-1 != ac->state_literal[fail[child]])
+				ac->state_output[child] = fail[child];
+			else
+				ac->state_output[child] = ac->state_output[fail[child]];
+
+			queue[queue_tail++] = child;
+		}
+	}
+
+	zbx_free(queue);
+	zbx_free(fail);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: finds literals contained in text                                  *
+ *                                                                            *
+ * Parameters: ac    - [IN] compiled automaton                                *
+ *             text  - [IN] text to scan                                      *
+ *             found - [OUT] found flags, indexed by literal identifiers.     *
+ *                           Must be zeroed by caller.                        *
+ *                                                                            *
+ ******************************************************************************/
+void	regexp_ac_scan(const zbx_regexp_ac_t *ac, const char *text, unsigned char *found)
+{
+	int		state = 0, found_num = 0;
+	const char	*ptr;
+
+	if (0 == ac->literals_num)
+		return;
+
+	if (0 != ac->direct)
+	{
+		int	i;
+
+		for (i = 0; i < ac->literals_num; i++)
+			found[i] = (NULL != strstr(text, ac->literals[i].str));
+
+		return;
+	}
+
+	for (ptr = text; '\0' != *ptr; ptr++)
+	{
+		int	out;
+
+		state = ac->delta[state * ac->classes_num + ac->classes[(unsigned char)*ptr]];
+
+		for (out = (-1 != ac->state_literal[state] ? state : ac->state_output[state]); 0 != out;
+				out = ac->state_output[out])
+		{
+			int	i;
+
+			for (i = ac->state_literal[out]; -1 != i; i = ac->literals[i].next)
+			{
+				const zbx_regexp_ac_literal_t	*literal = &ac->literals[i];
+
+				if (0 != found[i])
+					continue;
+
+				if (ZBX_CASE_SENSITIVE == literal->case_sensitive &&
+						0 != memcmp(ptr - literal->len + 1, literal->str, literal->len))
+				{
+					continue;
+				}
+
+				found[i] = 1;
+
+				if (++found_num == ac->literals_num)
+					return;
+			}
+		}
+	}
+}
+
+#undef REGEXP_AC_DIRECT_MAX
@@ -0,0 +1,63 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#ifndef ZABBIX_REGEXP_AC_H
+#define ZABBIX_REGEXP_AC_H
+
+#include "zbxtypes.h"
+
+typedef struct
+{
+	char	*str;
+	size_t	len;
+	int	case_sensitive;
+
+	/* the next literal ending at the same automaton state, -1 if none */
+	int	next;
+}
+zbx_regexp_ac_literal_t;
+
+/* Aho-Corasick automaton, finding all literals in a string with a single pass */
+typedef struct
+{
+	zbx_regexp_ac_literal_t	*literals;
+	int			literals_num;
+	int			literals_alloc;
+
+	/* byte to input class map, bytes not present in literals are mapped to class 0 */
+	unsigned char		classes[256];
+	int			classes_num;
+
+	/* states_num x classes_num transition table */
+	int			*delta;
+	int			states_num;
+
+	/* the first literal ending at state, -1 if none */
+	int			*state_literal;
+
+	/* the nearest proper suffix state with literals, 0 if none */
+	int			*state_output;
+
+	/* set if literals are searched one by one instead of using transition table */
+	int			direct;
+}
+zbx_regexp_ac_t;
+
+void	regexp_ac_init(zbx_regexp_ac_t *ac);
+void	regexp_ac_destroy(zbx_regexp_ac_t *ac);
+int	regexp_ac_add(zbx_regexp_ac_t *ac, const char *str, size_t len, int case_sensitive);
+void	regexp_ac_compile(zbx_regexp_ac_t *ac);
+void	regexp_ac_scan(const zbx_regexp_ac_t *ac, const char *text, unsigned char *found);
+
+#endif
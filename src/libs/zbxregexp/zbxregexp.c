@@ -13,10 +13,16 @@
 **/
 
 #include "zbxregexp.h"
+#include "regexp_ac.h"
 
 #include "zbxstr.h"
 #include "zbxtime.h"
 
+#if !defined(_WINDOWS) && !defined(__MINGW32__)
+#	include <pthread.h>
+#	define ZBX_REGEXP_CLEANUP_HOOK
+#endif
+
 #ifdef HAVE_PCRE_H
 #ifdef HAVE_PCRE2_H
 #error "cannot use both pcre and pcre2 at the same time!"
@@ -55,8 +61,158 @@ struct zbx_regexp
 	pcre2_code		*pcre2_regexp;
 	pcre2_match_context	*match_ctx;
 #endif
+	/* references held by callers and the compiled regexp cache */
+	int			refcount;
 };
 
+/* the maximum number of compiled regular expressions kept in per-thread cache */
+#define ZBX_REGEXP_CACHE_SIZE	256
+
+typedef struct regexp_cache_entry
+{
+	char				*pattern;
+	int				flags;
+	zbx_regexp_t			*regexp;
+
+	/* least recently used list links, the list head is the most recently used entry */
+	struct regexp_cache_entry	*prev;
+	struct regexp_cache_entry	*next;
+}
+zbx_regexp_cache_entry_t;
+
+typedef struct
+{
+	zbx_hashset_t			entries;
+	zbx_regexp_cache_entry_t	*head;
+	zbx_regexp_cache_entry_t	*tail;
+	int				initialized;
+}
+zbx_regexp_cache_t;
+
+static ZBX_THREAD_LOCAL zbx_regexp_cache_t	regexp_cache;
+
+static void	regexp_cleanup_register(void);
+
+#if defined(HAVE_PCRE2_H) && defined(PCRE2_CONFIG_JIT)
+#	define ZBX_REGEXP_JIT
+#elif defined(HAVE_PCRE_H) && defined(PCRE_STUDY_JIT_COMPILE)
+#	define ZBX_REGEXP_JIT
+#endif
+
+#ifdef ZBX_REGEXP_JIT
+#define REGEXP_JIT_STACK_START	(32 * ZBX_KIBIBYTE)
+#define REGEXP_JIT_STACK_MAX	(ZBX_MEBIBYTE)
+
+#ifdef HAVE_PCRE2_H
+static ZBX_THREAD_LOCAL pcre2_jit_stack	*rxp_jit_stack = NULL;
+#else
+static ZBX_THREAD_LOCAL pcre_jit_stack	*rxp_jit_stack = NULL;
+#endif
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns JIT stack of the calling thread, creating it on the first *
+ *          use                                                               *
+ *                                                                            *
+ * Comments: Compiled regular expressions can be used by several threads, so  *
+ *           the stack is picked up at match time instead of being assigned   *
+ *           with the regexp. If the stack cannot be created then NULL is     *
+ *           returned and the small machine stack based JIT stack is used.    *
+ *                                                                            *
+ ******************************************************************************/
+#ifdef HAVE_PCRE2_H
+static pcre2_jit_stack	*regexp_jit_stack_get(void *data)
+#else
+static pcre_jit_stack	*regexp_jit_stack_get(void *data)
+#endif
+{
+	ZBX_UNUSED(data);
+
+	if (NULL == rxp_jit_stack)
+	{
+#ifdef HAVE_PCRE2_H
+		rxp_jit_stack = pcre2_jit_stack_create(REGEXP_JIT_STACK_START, REGEXP_JIT_STACK_MAX, NULL);
+#else
+		rxp_jit_stack = pcre_jit_stack_alloc(REGEXP_JIT_STACK_START, REGEXP_JIT_STACK_MAX);
+#endif
+		regexp_cleanup_register();
+	}
+
+	return rxp_jit_stack;
+}
+
+#undef REGEXP_JIT_STACK_MAX
+#undef REGEXP_JIT_STACK_START
+#endif
+
+#ifdef ZBX_REGEXP_CLEANUP_HOOK
+/******************************************************************************
+ *                                                                            *
+ * Purpose: frees compiled regexp cache and JIT stack of the calling thread   *
+ *                                                                            *
+ ******************************************************************************/
+static void	regexp_thread_clean(void)
+{
+	zbx_regexp_cache_clear();
+
+#ifdef ZBX_REGEXP_JIT
+	if (NULL != rxp_jit_stack)
+	{
+#ifdef HAVE_PCRE2_H
+		pcre2_jit_stack_free(rxp_jit_stack);
+#else
+		pcre_jit_stack_free(rxp_jit_stack);
+#endif
+		rxp_jit_stack = NULL;
+	}
+#endif
+}
+
+static pthread_once_t	regexp_cleanup_once = PTHREAD_ONCE_INIT;
+static pthread_key_t	regexp_cleanup_key;
+static int		regexp_cleanup_key_created = 0;
+
+static void	regexp_cleanup_thread_exit(void *data)
+{
+	ZBX_UNUSED(data);
+
+	regexp_thread_clean();
+}
+
+static void	regexp_cleanup_process_exit(void)
+{
+	regexp_thread_clean();
+}
+
+static void	regexp_cleanup_init(void)
+{
+	if (0 == pthread_key_create(&regexp_cleanup_key, regexp_cleanup_thread_exit))
+		regexp_cleanup_key_created = 1;
+
+	atexit(regexp_cleanup_process_exit);
+}
+#endif
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: registers cleanup of per-thread regexp data                       *
+ *                                                                            *
+ * Comments: Thread specific key destructor frees the data when the thread    *
+ *           exits. Destructors are not called for the thread calling exit(), *
+ *           so the process exit handler frees the data of that thread.       *
+ *                                                                            *
+ ******************************************************************************/
+static void	regexp_cleanup_register(void)
+{
+#ifdef ZBX_REGEXP_CLEANUP_HOOK
+	(void)pthread_once(&regexp_cleanup_once, regexp_cleanup_init);
+
+	/* destructor is called only for non-NULL thread specific value */
+	if (0 != regexp_cleanup_key_created)
+		(void)pthread_setspecific(regexp_cleanup_key, &regexp_cache);
+#endif
+}
+
 /* maps to ovector of pcre_exec() */
 typedef struct
 {
@@ -177,8 +333,12 @@ static int	regexp_compile(const char *pattern, int flags, zbx_regexp_t **regexp,
 	if (NULL != regexp)
 	{
 		struct pcre_extra	*extra;
+		int			study_options = 0;
 
-		if (NULL == (extra = pcre_study(pcre_regexp, 0, &err_msg_static)) && NULL != err_msg_static)
+#ifdef ZBX_REGEXP_JIT
+		study_options |= PCRE_STUDY_JIT_COMPILE;
+#endif
+		if (NULL == (extra = pcre_study(pcre_regexp, study_options, &err_msg_static)) && NULL != err_msg_static)
 		{
 			if (NULL != err_msg)
 			{
@@ -190,9 +350,15 @@ static int	regexp_compile(const char *pattern, int flags, zbx_regexp_t **regexp,
 			return FAIL;
 		}
 
+#ifdef ZBX_REGEXP_JIT
+		/* JIT stack is ignored if the pattern was not JIT compiled */
+		if (NULL != extra)
+			pcre_assign_jit_stack(extra, regexp_jit_stack_get, NULL);
+#endif
 		*regexp = (zbx_regexp_t *)zbx_malloc(NULL, sizeof(zbx_regexp_t));
 		(*regexp)->pcre_regexp = pcre_regexp;
 		(*regexp)->extra = extra;
+		(*regexp)->refcount = 1;
 	}
 	else
 		pcre_free(pcre_regexp);
@@ -218,9 +384,15 @@ static int	regexp_compile(const char *pattern, int flags, zbx_regexp_t **regexp,
 			return FAIL;
 		}
 
+#ifdef ZBX_REGEXP_JIT
+		/* when JIT compilation is not supported or fails the interpreter is used by pcre2_match() */
+		if (0 == pcre2_jit_compile(pcre2_regexp, PCRE2_JIT_COMPLETE))
+			pcre2_jit_stack_assign(match_ctx, regexp_jit_stack_get, NULL);
+#endif
 		*regexp = (zbx_regexp_t *)zbx_malloc(NULL, sizeof(zbx_regexp_t));
 		(*regexp)->pcre2_regexp = pcre2_regexp;
 		(*regexp)->match_ctx = match_ctx;
+		(*regexp)->refcount = 1;
 	}
 	else
 		pcre2_code_free(pcre2_regexp);
@@ -228,12 +400,155 @@ static int	regexp_compile(const char *pattern, int flags, zbx_regexp_t **regexp,
 	return SUCCEED;
 }
 
+static zbx_hash_t	regexp_cache_hash(const void *d)
+{
+	const zbx_regexp_cache_entry_t	*entry = (const zbx_regexp_cache_entry_t *)d;
+	zbx_hash_t			hash;
+
+	hash = ZBX_DEFAULT_STRING_HASH_FUNC(entry->pattern);
+
+	return ZBX_DEFAULT_HASH_ALGO(&entry->flags, sizeof(entry->flags), hash);
+}
+
+static int	regexp_cache_compare(const void *d1, const void *d2)
+{
+	const zbx_regexp_cache_entry_t	*entry1 = (const zbx_regexp_cache_entry_t *)d1;
+	const zbx_regexp_cache_entry_t	*entry2 = (const zbx_regexp_cache_entry_t *)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(entry1->flags, entry2->flags);
+
+	return strcmp(entry1->pattern, entry2->pattern);
+}
+
+static void	regexp_cache_unlink(zbx_regexp_cache_entry_t *entry)
+{
+	if (NULL != entry->prev)
+		entry->prev->next = entry->next;
+	else
+		regexp_cache.head = entry->next;
+
+	if (NULL != entry->next)
+		entry->next->prev = entry->prev;
+	else
+		regexp_cache.tail = entry->prev;
+}
+
+static void	regexp_cache_link_head(zbx_regexp_cache_entry_t *entry)
+{
+	entry->prev = NULL;
+
+	if (NULL != (entry->next = regexp_cache.head))
+		regexp_cache.head->prev = entry;
+	else
+		regexp_cache.tail = entry;
+
+	regexp_cache.head = entry;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns compiled regular expression from cache, compiling and     *
+ *          caching it if necessary                                           *
+ *                                                                            *
+ * Parameters:                                                                *
+ *     pattern   - [IN] regular expression as a text string                   *
+ *     flags     - [IN] regexp compilation parameters                         *
+ *     regexp    - [OUT] compiled regexp, owned by cache                      *
+ *     err_msg   - [OUT] dynamically allocated error message                  *
+ *                                                                            *
+ * Return value: SUCCEED or FAIL                                              *
+ *                                                                            *
+ * Comments: The cache is kept per thread and holds up to                     *
+ *           ZBX_REGEXP_CACHE_SIZE regexps, evicting the least recently used  *
+ *           ones. The returned regexp stays valid while it is in cache, so   *
+ *           callers keeping it longer must take a reference.                 *
+ *                                                                            *
+ ******************************************************************************/
+static int	regexp_cache_get(const char *pattern, int flags, zbx_regexp_t **regexp, char **err_msg)
+{
+	zbx_regexp_cache_entry_t	entry_local, *entry;
+
+	if (0 == regexp_cache.initialized)
+	{
+		zbx_hashset_create(&regexp_cache.entries, ZBX_REGEXP_CACHE_SIZE, regexp_cache_hash,
+				regexp_cache_compare);
+		regexp_cache.initialized = 1;
+		regexp_cleanup_register();
+	}
+
+	entry_local.pattern = (char *)pattern;
+	entry_local.flags = flags;
+
+	if (NULL != (entry = (zbx_regexp_cache_entry_t *)zbx_hashset_search(&regexp_cache.entries, &entry_local)))
+	{
+		if (regexp_cache.head != entry)
+		{
+			regexp_cache_unlink(entry);
+			regexp_cache_link_head(entry);
+		}
+
+		*regexp = entry->regexp;
+
+		return SUCCEED;
+	}
+
+	if (SUCCEED != regexp_compile(pattern, flags, &entry_local.regexp, err_msg))
+		return FAIL;
+
+	if (ZBX_REGEXP_CACHE_SIZE <= regexp_cache.entries.num_data)
+	{
+		entry = regexp_cache.tail;
+		regexp_cache_unlink(entry);
+		zbx_regexp_free(entry->regexp);
+		zbx_free(entry->pattern);
+		zbx_hashset_remove_direct(&regexp_cache.entries, entry);
+	}
+
+	entry_local.pattern = zbx_strdup(NULL, pattern);
+	entry = (zbx_regexp_cache_entry_t *)zbx_hashset_insert(&regexp_cache.entries, &entry_local,
+			sizeof(entry_local));
+	regexp_cache_link_head(entry);
+
+	*regexp = entry->regexp;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: frees compiled regexps cached by the calling thread               *
+ *                                                                            *
+ * Comments: Regexps still referenced by callers are freed when released.     *
+ *           The cache is freed automatically when the thread or process      *
+ *           exits.                                                           *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_regexp_cache_clear(void)
+{
+	zbx_regexp_cache_entry_t	*entry;
+
+	if (0 == regexp_cache.initialized)
+		return;
+
+	while (NULL != (entry = regexp_cache.head))
+	{
+		regexp_cache_unlink(entry);
+		zbx_regexp_free(entry->regexp);
+		zbx_free(entry->pattern);
+	}
+
+	zbx_hashset_destroy(&regexp_cache.entries);
+	regexp_cache.initialized = 0;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: Compile a regular expression with default options. Capture groups *
  *          are disabled by default (if PCRE_NO_AUTO_CAPTURE is supported).   *
  *          If you need to compile a regular expression that contains capture *
  *          groups use function zbx_regexp_compile_ext() instead.             *
+ *          The regexp is shared with per-thread compiled regexp cache, it    *
+ *          must be freed with zbx_regexp_free() by the same thread.          *
  *                                                                            *
  * Parameters:                                                                *
  *     pattern   - [IN] regular expression as a text string. Empty            *
@@ -248,9 +563,9 @@ static int	regexp_compile(const char *pattern, int flags, zbx_regexp_t **regexp,
 int	zbx_regexp_compile(const char *pattern, zbx_regexp_t **regexp, char **err_msg)
 {
 #ifdef ZBX_REGEXP_NO_AUTO_CAPTURE
-	return regexp_compile(pattern, ZBX_REGEXP_MULTILINE | ZBX_REGEXP_NO_AUTO_CAPTURE, regexp, err_msg);
+	return zbx_regexp_compile_ext(pattern, regexp, ZBX_REGEXP_MULTILINE | ZBX_REGEXP_NO_AUTO_CAPTURE, err_msg);
 #else
-	return regexp_compile(pattern, ZBX_REGEXP_MULTILINE, regexp, err_msg);
+	return zbx_regexp_compile_ext(pattern, regexp, ZBX_REGEXP_MULTILINE, err_msg);
 #endif
 }
 
@@ -269,47 +584,31 @@ int	zbx_regexp_compile(const char *pattern, zbx_regexp_t **regexp, char **err_ms
  *                      ZBX_REGEXP_MULTILINE.                                 *
  *     err_msg   - [OUT] error message if any.                                *
  *                                                                            *
+ * Comments: The regexp is shared with per-thread compiled regexp cache, it   *
+ *           must be freed with zbx_regexp_free() by the same thread.         *
+ *                                                                            *
  ******************************************************************************/
 int	zbx_regexp_compile_ext(const char *pattern, zbx_regexp_t **regexp, int flags, char **err_msg)
 {
-	return regexp_compile(pattern, flags, regexp, err_msg);
+	if (NULL == regexp)
+		return regexp_compile(pattern, flags, regexp, err_msg);
+
+	if (SUCCEED != regexp_cache_get(pattern, flags, regexp, err_msg))
+		return FAIL;
+
+	(*regexp)->refcount++;
+
+	return SUCCEED;
 }
 
 /****************************************************************************************************
  *                                                                                                  *
- * Purpose: wrapper for zbx_regexp_compile. Caches and reuses the last used regexp.                 *
+ * Purpose: wrapper for zbx_regexp_compile. Reuses regexps from per-thread compiled regexp cache.   *
  *                                                                                                  *
  ****************************************************************************************************/
 static int	regexp_prepare(const char *pattern, int flags, zbx_regexp_t **regexp, char **err_msg)
 {
-	static ZBX_THREAD_LOCAL zbx_regexp_t	*curr_regexp = NULL;
-	static ZBX_THREAD_LOCAL char		*curr_pattern = NULL;
-	static ZBX_THREAD_LOCAL int		curr_flags = 0;
-	int					ret = SUCCEED;
-
-	if (NULL == curr_regexp || 0 != strcmp(curr_pattern, pattern) || curr_flags != flags)
-	{
-		if (NULL != curr_regexp)
-		{
-			zbx_regexp_free(curr_regexp);
-			zbx_free(curr_pattern);
-		}
-
-		curr_regexp = NULL;
-		curr_pattern = NULL;
-		curr_flags = 0;
-
-		if (SUCCEED == regexp_compile(pattern, flags, &curr_regexp, err_msg))
-		{
-			curr_pattern = zbx_strdup(curr_pattern, pattern);
-			curr_flags = flags;
-		}
-		else
-			ret = FAIL;
-	}
-
-	*regexp = curr_regexp;
-	return ret;
+	return regexp_cache_get(pattern, flags, regexp, err_msg);
 }
 
 /* calculate recursion limit, PCRE man page suggests to reckon on about 500 bytes per recursion */
@@ -525,9 +824,14 @@ static int	regexp_exec(const char *string, const zbx_regexp_t *regexp, int flags
  *                                                                            *
  * Parameters: regexp - [IN] compiled regular expression                      *
  *                                                                            *
+ * Comments: The regexp is freed when the last reference is released.        *
+ *                                                                            *
  ******************************************************************************/
 void	zbx_regexp_free(zbx_regexp_t *regexp)
 {
+	if (0 != --regexp->refcount)
+		return;
+
 #ifdef HAVE_PCRE_H
 	/* pcre_free_study() was added to the API for release 8.20 while extra was available before */
 #ifdef PCRE_CONFIG_JIT
@@ -1761,6 +2065,793 @@ out:
 
 	return ret;
 }
+#define REGEXP_PREFILTER_NONE		0	/* expression must be evaluated */
+#define REGEXP_PREFILTER_REQUIRED	1	/* regexp cannot match if its literal is not found */
+#define REGEXP_PREFILTER_EXACT		2	/* expression matches if any of its literals is found */
+
+/* literal identifier of empty substring, which is always found */
+#define REGEXP_LITERAL_EMPTY	-1
+
+typedef struct
+{
+	const char	*pattern;
+	int		expression_type;
+	int		case_sensitive;
+	int		prefilter;
+
+	/* literal identifiers in automaton */
+	int		*literals;
+	int		literals_num;
+}
+zbx_regexp_set_expression_t;
+
+struct zbx_regexp_set
+{
+	const zbx_vector_expression_t	*regexps;
+	const char			*pattern;
+	int				case_sensitive;
+
+	/* set if expressions are evaluated with zbx_regexp_sub_ex2() because of errors */
+	int				fallback;
+
+	zbx_regexp_set_expression_t	*expressions;
+	int				expressions_num;
+
+	zbx_regexp_ac_t			ac;
+
+	/* literals found by the automaton in the current string */
+	unsigned char			*found;
+};
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if character of case insensitive regexp is matched the     *
+ *          same way by tolower() based prefilter                             *
+ *                                                                            *
+ * Comments: In UTF mode caseless matching folds also some non-ASCII          *
+ *           characters to ASCII letters - Kelvin sign to 'k' and long s to   *
+ *           's'.                                                             *
+ *                                                                            *
+ ******************************************************************************/
+static int	regexp_caseless_literal_char(unsigned char c)
+{
+	unsigned char	lower, upper;
+
+	if (0x80 <= c)
+		return FAIL;
+
+	if (0 == isalpha(c))
+		return tolower(c) == c ? SUCCEED : FAIL;
+
+	lower = c | 0x20;
+	upper = c & (unsigned char)~0x20;
+
+	if ('k' == lower || 's' == lower || tolower(upper) != lower || tolower(lower) != lower)
+		return FAIL;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: ends literal sequence, keeping it if it is the longest one        *
+ *                                                                            *
+ ******************************************************************************/
+static void	regexp_literal_run_end(const char *run, size_t *run_len, char **longest, size_t *longest_len)
+{
+	if (*run_len > *longest_len)
+	{
+		*longest = (char *)zbx_realloc(*longest, *run_len + 1);
+		memcpy(*longest, run, *run_len);
+		(*longest)[*run_len] = '\0';
+		*longest_len = *run_len;
+	}
+
+	*run_len = 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns pointer to closing bracket of character class             *
+ *                                                                            *
+ ******************************************************************************/
+static const char	*regexp_skip_class(const char *ptr)
+{
+	if ('^' == *(++ptr))
+		ptr++;
+
+	/* the first ']' is a literal */
+	if (']' == *ptr)
+		ptr++;
+
+	for (; ']' != *ptr; ptr++)
+	{
+		const char	*end;
+
+		if ('\0' == *ptr)
+			return NULL;
+
+		if ('\\' == *ptr)
+		{
+			if ('\0' == *(++ptr))
+				return NULL;
+
+			continue;
+		}
+
+		if ('[' == *ptr && ':' == ptr[1] && NULL != (end = strstr(ptr + 2, ":]")))
+			ptr = end + 1;
+	}
+
+	return ptr;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns pointer to the last character of escape sequence          *
+ *                                                                            *
+ * Parameters: ptr - [IN] the character following backslash                   *
+ *                                                                            *
+ * Return value: pointer to the last character of escape sequence or NULL if  *
+ *               the sequence is not terminated                               *
+ *                                                                            *
+ * Comments: Escape sequences with arguments (\x41, \x{41}, \o{101}, \p{Lu},  *
+ *           \pL, \cA, \k<name>, \g{-1}, \N{U+41}, \12) are skipped as whole, *
+ *           so their arguments are not taken as literals.                    *
+ *                                                                            *
+ ******************************************************************************/
+static const char	*regexp_skip_escape(const char *ptr)
+{
+	const char	*end;
+	char		close;
+
+	switch (*ptr)
+	{
+		case 'x':
+			if ('{' == ptr[1])
+				break;
+
+			for (end = ptr; end - ptr < 2 && 0 != isxdigit((unsigned char)end[1]); end++)
+				;
+			return end;
+		case 'o':
+		case 'N':
+			if ('{' == ptr[1])
+				break;
+			return ptr;
+		case 'p':
+		case 'P':
+			if ('{' == ptr[1])
+				break;
+			return '\0' == ptr[1] ? NULL : ptr + 1;
+		case 'c':
+			return '\0' == ptr[1] ? NULL : ptr + 1;
+		case 'k':
+		case 'g':
+			if ('\0' != ptr[1] && NULL != strchr("<'{", ptr[1]))
+				break;
+
+			if ('g' == *ptr && ('+' == ptr[1] || '-' == ptr[1]))
+				ptr++;
+
+			for (end = ptr; 0 != isdigit((unsigned char)end[1]); end++)
+				;
+			return end;
+		default:
+			/* back reference or octal character code */
+			if (0 == isdigit((unsigned char)*ptr))
+				return ptr;
+
+			for (end = ptr; 0 != isdigit((unsigned char)end[1]); end++)
+				;
+			return end;
+	}
+
+	switch (*(++ptr))
+	{
+		case '<':
+			close = '>';
+			break;
+		case '{':
+			close = '}';
+			break;
+		default:
+			close = '\'';
+	}
+
+	return strchr(ptr + 1, close);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns pointer to the closing brace of {m}, {m,}, {m,n} or {,n}  *
+ *          quantifier or NULL if brace is a literal                          *
+ *                                                                            *
+ ******************************************************************************/
+static const char	*regexp_skip_quantifier(const char *ptr)
+{
+	int	digits = 0;
+
+	for (ptr++; 0 != isdigit((unsigned char)*ptr); ptr++)
+		digits++;
+
+	if (',' == *ptr)
+	{
+		for (ptr++; 0 != isdigit((unsigned char)*ptr); ptr++)
+			digits++;
+	}
+
+	return ('}' == *ptr && 0 != digits ? ptr : NULL);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if regexp changes options inline or uses quoting, which    *
+ *          makes top level characters unusable as literals                   *
+ *                                                                            *
+ ******************************************************************************/
+static int	regexp_has_inline_options(const char *pattern)
+{
+	const char	*ptr;
+
+	if (NULL != strstr(pattern, "\\Q") || NULL != strstr(pattern, "(*"))
+		return SUCCEED;
+
+	for (ptr = pattern; NULL != (ptr = strstr(ptr, "(?")); ptr += 2)
+	{
+		if (0 != islower((unsigned char)ptr[2]) || NULL != strchr("-^JU", ptr[2]))
+			return SUCCEED;
+	}
+
+	return FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: extracts literals from regular expression for prefiltering        *
+ *                                                                            *
+ * Parameters: pattern        - [IN] valid regular expression                 *
+ *             case_sensitive - [IN] ZBX_CASE_SENSITIVE or ZBX_IGNORE_CASE    *
+ *             literals       - [OUT] extracted literals                      *
+ *                                                                            *
+ * Return value: REGEXP_PREFILTER_EXACT    - regexp is alternation of plain   *
+ *                                           ASCII literals                   *
+ *               REGEXP_PREFILTER_REQUIRED - the longest literal any match    *
+ *                                           must contain                     *
+ *               REGEXP_PREFILTER_NONE     - no literals were extracted       *
+ *                                                                            *
+ * Comments: Only top level literal sequences are used. Quantifiers, groups,  *
+ *           classes, anchors and escape sequences other than escaped         *
+ *           punctuation end literal sequence. Quantifier braces and escape   *
+ *           sequence arguments are skipped as a whole.                       *
+ *                                                                            *
+ ******************************************************************************/
+static int	regexp_extract_literals(const char *pattern, int case_sensitive, zbx_vector_str_t *literals)
+{
+	const char	*ptr, *end;
+	char		*run, *longest = NULL;
+	size_t		run_len = 0, longest_len = 0;
+	int		depth = 0, exact = SUCCEED, alternation = FAIL, ascii = SUCCEED, ret = REGEXP_PREFILTER_NONE;
+
+	if (SUCCEED == regexp_has_inline_options(pattern))
+		return REGEXP_PREFILTER_NONE;
+
+	run = (char *)zbx_malloc(NULL, strlen(pattern) + 1);
+
+	for (ptr = pattern; '\0' != *ptr; ptr++)
+	{
+		unsigned char	c = (unsigned char)*ptr;
+		int		literal = FAIL, top_level = (0 == depth);
+
+		switch (c)
+		{
+			case '\\':
+				if ('\0' == (c = (unsigned char)*(++ptr)))
+					goto out;
+
+				if (0x80 > c && 0 == isalnum(c))
+					literal = SUCCEED;
+				else if (NULL == (ptr = regexp_skip_escape(ptr)))
+					goto out;
+				break;
+			case '[':
+				if (NULL == (ptr = regexp_skip_class(ptr)))
+					goto out;
+				break;
+			case '(':
+				depth++;
+				break;
+			case ')':
+				if (0 > --depth)
+					goto out;
+				break;
+			case '|':
+				if (0 == top_level)
+					break;
+
+				alternation = SUCCEED;
+
+				if (SUCCEED == exact && 0 != run_len)
+					zbx_vector_str_append(literals, zbx_dsprintf(NULL, "%.*s", (int)run_len, run));
+				else
+					exact = FAIL;
+
+				run_len = 0;
+				continue;
+			case '{':
+				/* a brace not starting quantifier is a literal, but it is safe to end sequence */
+				if (NULL != (end = regexp_skip_quantifier(ptr)))
+					ptr = end;
+				ZBX_FALLTHROUGH;
+			case '?':
+			case '*':
+				if (0 == top_level)
+					break;
+
+				/* the quantified character is optional, in UTF-8 it can be a multibyte sequence */
+				while (0 != run_len && 0x80 == ((unsigned char)run[run_len - 1] & 0xc0))
+					run_len--;
+
+				if (0 != run_len)
+					run_len--;
+				break;
+			case '^':
+			case '$':
+			case '.':
+			case '+':
+			case ']':
+			case '}':
+				break;
+			default:
+				literal = SUCCEED;
+		}
+
+		if (0 == top_level)
+			continue;
+
+		if (SUCCEED == literal && (ZBX_CASE_SENSITIVE == case_sensitive ||
+				SUCCEED == regexp_caseless_literal_char(c)))
+		{
+			if (0x80 <= c)
+				ascii = FAIL;
+
+			run[run_len++] = (char)c;
+			continue;
+		}
+
+		exact = FAIL;
+		regexp_literal_run_end(run, &run_len, &longest, &longest_len);
+	}
+
+	if (0 != depth)
+		goto out;
+
+	if (SUCCEED == exact && 0 != run_len && SUCCEED == ascii)
+	{
+		zbx_vector_str_append(literals, zbx_dsprintf(NULL, "%.*s", (int)run_len, run));
+		ret = REGEXP_PREFILTER_EXACT;
+		goto out;
+	}
+
+	if (SUCCEED == alternation)
+		goto out;
+
+	regexp_literal_run_end(run, &run_len, &longest, &longest_len);
+
+	if (0 != longest_len)
+	{
+		zbx_vector_str_append(literals, longest);
+		longest = NULL;
+		ret = REGEXP_PREFILTER_REQUIRED;
+	}
+out:
+	if (REGEXP_PREFILTER_NONE == ret)
+		zbx_vector_str_clear_ext(literals, zbx_str_free);
+
+	zbx_free(longest);
+	zbx_free(run);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: prepares expression of regexp set, registering its literals in    *
+ *          automaton                                                         *
+ *                                                                            *
+ * Return value: SUCCEED - expression was prepared                            *
+ *               FAIL    - regexp is invalid or expression type is unknown    *
+ *                                                                            *
+ ******************************************************************************/
+static int	regexp_set_expression_init(zbx_regexp_set_t *set, zbx_regexp_set_expression_t *expression,
+		const char *pattern, int expression_type, int case_sensitive, char delimiter)
+{
+	zbx_vector_str_t	literals;
+	int			i, flags = ZBX_REGEXP_MULTILINE;
+	char			*error = NULL;
+	const char		*s, *c;
+
+	expression->pattern = pattern;
+	expression->expression_type = expression_type;
+	expression->case_sensitive = case_sensitive;
+	expression->literals = NULL;
+	expression->literals_num = 0;
+
+	zbx_vector_str_create(&literals);
+
+	switch (expression_type)
+	{
+		case EXPRESSION_TYPE_TRUE:
+		case EXPRESSION_TYPE_FALSE:
+			if (ZBX_IGNORE_CASE == case_sensitive)
+				flags |= ZBX_REGEXP_CASELESS;
+
+			if (SUCCEED != regexp_compile(pattern, flags, NULL, &error))
+			{
+				zbx_free(error);
+				zbx_vector_str_destroy(&literals);
+				return FAIL;
+			}
+
+			expression->prefilter = regexp_extract_literals(pattern, case_sensitive, &literals);
+			break;
+		case EXPRESSION_TYPE_INCLUDED:
+		case EXPRESSION_TYPE_NOT_INCLUDED:
+			zbx_vector_str_append(&literals, zbx_strdup(NULL, pattern));
+			expression->prefilter = REGEXP_PREFILTER_EXACT;
+			break;
+		case EXPRESSION_TYPE_ANY_INCLUDED:
+			/* split the same way as regexp_match_ex_substring_list() does */
+			for (s = pattern; '\0' != *s; s = c + 1)
+			{
+				if (NULL == (c = strchr(s, delimiter)))
+				{
+					zbx_vector_str_append(&literals, zbx_strdup(NULL, s));
+					break;
+				}
+
+				zbx_vector_str_append(&literals, zbx_dsprintf(NULL, "%.*s", (int)(c - s), s));
+			}
+
+			expression->prefilter = REGEXP_PREFILTER_EXACT;
+			break;
+		default:
+			zbx_vector_str_destroy(&literals);
+			return FAIL;
+	}
+
+	if (0 != literals.values_num)
+	{
+		expression->literals = (int *)zbx_malloc(NULL, sizeof(int) * (size_t)literals.values_num);
+
+		for (i = 0; i < literals.values_num; i++)
+		{
+			size_t	len = strlen(literals.values[i]);
+
+			expression->literals[i] = (0 == len ? REGEXP_LITERAL_EMPTY :
+					regexp_ac_add(&set->ac, literals.values[i], len, case_sensitive));
+		}
+
+		expression->literals_num = literals.values_num;
+	}
+
+	zbx_vector_str_clear_ext(&literals, zbx_str_free);
+	zbx_vector_str_destroy(&literals);
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compiles regular expression or global regular expression into     *
+ *          a set, matched with a single pass over the string                 *
+ *                                                                            *
+ * Parameters: regexps        - [IN] global regular expressions               *
+ *             pattern        - [IN] regular expression or global regular     *
+ *                                   expression name (@<global regexp name>)  *
+ *             case_sensitive - [IN] ZBX_IGNORE_CASE or ZBX_CASE_SENSITIVE,   *
+ *                                   used for regular expression only         *
+ *                                                                            *
+ * Return value: compiled regexp set                                          *
+ *                                                                            *
+ * Comments: Substrings of all expressions and literals required by regexps   *
+ *           are searched with one Aho-Corasick automaton pass. Regexps are   *
+ *           run only when the literals do not decide the result already.     *
+ *           Expressions with errors are evaluated by zbx_regexp_sub_ex2(),   *
+ *           to keep error reporting the same.                                *
+ *           The set references 'regexps' and 'pattern', they must not be     *
+ *           freed while the set is used.                                     *
+ *                                                                            *
+ ******************************************************************************/
+zbx_regexp_set_t	*zbx_regexp_set_create(const zbx_vector_expression_t *regexps, const char *pattern,
+		int case_sensitive)
+{
+	zbx_regexp_set_t	*set;
+	int			i;
+
+	set = (zbx_regexp_set_t *)zbx_malloc(NULL, sizeof(zbx_regexp_set_t));
+	memset(set, 0, sizeof(zbx_regexp_set_t));
+
+	set->regexps = regexps;
+	set->pattern = pattern;
+	set->case_sensitive = case_sensitive;
+	regexp_ac_init(&set->ac);
+
+	if (NULL == pattern || '\0' == *pattern)
+		return set;
+
+	if ('@' != *pattern)
+	{
+		set->expressions = (zbx_regexp_set_expression_t *)zbx_malloc(NULL, sizeof(zbx_regexp_set_expression_t));
+
+		if (SUCCEED != regexp_set_expression_init(set, &set->expressions[0], pattern, EXPRESSION_TYPE_TRUE,
+				case_sensitive, '\0'))
+		{
+			set->fallback = 1;
+		}
+		else
+			set->expressions_num = 1;
+	}
+	else
+	{
+		set->expressions = (zbx_regexp_set_expression_t *)zbx_malloc(NULL,
+				sizeof(zbx_regexp_set_expression_t) * (size_t)MAX(1, regexps->values_num));
+
+		for (i = 0; i < regexps->values_num; i++)
+		{
+			const zbx_expression_t	*regexp = regexps->values[i];
+
+			if (0 != strcmp(regexp->name, pattern + 1))
+				continue;
+
+			if (SUCCEED != regexp_set_expression_init(set, &set->expressions[set->expressions_num],
+					regexp->expression, regexp->expression_type, regexp->case_sensitive,
+					regexp->exp_delimiter))
+			{
+				set->fallback = 1;
+				break;
+			}
+
+			set->expressions_num++;
+		}
+	}
+
+	if (0 == set->fallback && 0 != set->ac.literals_num)
+	{
+		regexp_ac_compile(&set->ac);
+		set->found = (unsigned char *)zbx_malloc(NULL, (size_t)set->ac.literals_num);
+	}
+
+	return set;
+}
+
+void	zbx_regexp_set_free(zbx_regexp_set_t *set)
+{
+	int	i;
+
+	for (i = 0; i < set->expressions_num; i++)
+		zbx_free(set->expressions[i].literals);
+
+	zbx_free(set->expressions);
+	zbx_free(set->found);
+	regexp_ac_destroy(&set->ac);
+	zbx_free(set);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks expression literals found in the current string            *
+ *                                                                            *
+ * Return value: SUCCEED - expression can match or literals are not used      *
+ *               FAIL    - expression cannot match                            *
+ *                                                                            *
+ ******************************************************************************/
+static int	regexp_set_literals_found(const zbx_regexp_set_t *set, const zbx_regexp_set_expression_t *expression)
+{
+	int	i;
+
+	if (REGEXP_PREFILTER_NONE == expression->prefilter)
+		return SUCCEED;
+
+	for (i = 0; i < expression->literals_num; i++)
+	{
+		if (REGEXP_LITERAL_EMPTY == expression->literals[i] || 0 != set->found[expression->literals[i]])
+			return SUCCEED;
+	}
+
+	return FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: matches string against regexp set, see zbx_regexp_sub_ex2()      *
+ *                                                                            *
+ * Parameters: set             - [IN] compiled regexp set                     *
+ *             string          - [IN] string to check                         *
+ *             output_template - [IN] output string template                  *
+ *             output          - [OUT] substitution result, can be NULL       *
+ *             err_msg         - [OUT] dynamically allocated error message    *
+ *                                                                            *
+ * Return value: ZBX_REGEXP_MATCH, ZBX_REGEXP_NO_MATCH or                     *
+ *               ZBX_REGEXP_COMPILE_FAIL, ZBX_REGEXP_RUNTIME_FAIL with error  *
+ *               message in 'err_msg'                                         *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_regexp_set_sub(zbx_regexp_set_t *set, const char *string, const char *output_template, char **output,
+		char **err_msg)
+{
+	int	i, ret = ZBX_REGEXP_NO_MATCH;
+	char	*output_accu = NULL;
+
+	if (0 != set->fallback)
+	{
+		return zbx_regexp_sub_ex2(set->regexps, string, set->pattern, set->case_sensitive, output_template,
+				output, err_msg);
+	}
+
+	if (NULL == set->pattern || '\0' == *set->pattern)
+	{
+		/* always match when no pattern is specified */
+		ret = ZBX_REGEXP_MATCH;
+		goto out;
+	}
+
+	if (0 != set->ac.literals_num)
+	{
+		memset(set->found, 0, (size_t)set->ac.literals_num);
+		regexp_ac_scan(&set->ac, string, set->found);
+	}
+
+	if ('@' != *set->pattern)
+	{
+		const zbx_regexp_set_expression_t	*expression = &set->expressions[0];
+
+		if (SUCCEED != regexp_set_literals_found(set, expression))
+		{
+			if (NULL != output)
+				zbx_free(*output);
+
+			ret = ZBX_REGEXP_NO_MATCH;
+		}
+		else if (REGEXP_PREFILTER_EXACT == expression->prefilter && NULL == output)
+		{
+			ret = ZBX_REGEXP_MATCH;
+		}
+		else
+		{
+			ret = regexp_match_ex_regsub2(string, set->pattern, set->case_sensitive, output_template, output,
+					err_msg);
+		}
+
+		goto out;
+	}
+
+	for (i = 0; i < set->expressions_num; i++)
+	{
+		const zbx_regexp_set_expression_t	*expression = &set->expressions[i];
+		int					found = regexp_set_literals_found(set, expression);
+
+		switch (expression->expression_type)
+		{
+			case EXPRESSION_TYPE_TRUE:
+				if (SUCCEED != found)
+				{
+					ret = ZBX_REGEXP_NO_MATCH;
+				}
+				else if (NULL != output)
+				{
+					char	*output_tmp = NULL;
+
+					if (ZBX_REGEXP_MATCH == (ret = regexp_match_ex_regsub2(string,
+							expression->pattern, expression->case_sensitive, output_template,
+							&output_tmp, err_msg)))
+					{
+						zbx_free(output_accu);
+						output_accu = output_tmp;
+					}
+				}
+				else if (REGEXP_PREFILTER_EXACT == expression->prefilter)
+				{
+					ret = ZBX_REGEXP_MATCH;
+				}
+				else
+				{
+					ret = regexp_match_ex_regsub2(string, expression->pattern,
+							expression->case_sensitive, NULL, NULL, err_msg);
+				}
+
+				if (ZBX_REGEXP_COMPILE_FAIL == ret || ZBX_REGEXP_RUNTIME_FAIL == ret)
+				{
+					zbx_free(output_accu);
+					return ret;
+				}
+
+				break;
+			case EXPRESSION_TYPE_FALSE:
+				if (SUCCEED != found)
+				{
+					ret = ZBX_REGEXP_NO_MATCH;
+				}
+				else if (REGEXP_PREFILTER_EXACT == expression->prefilter)
+				{
+					ret = ZBX_REGEXP_MATCH;
+				}
+				else
+				{
+					ret = regexp_match_ex_regsub2(string, expression->pattern,
+							expression->case_sensitive, NULL, NULL, err_msg);
+
+					if (ZBX_REGEXP_COMPILE_FAIL == ret || ZBX_REGEXP_RUNTIME_FAIL == ret)
+					{
+						zbx_free(output_accu);
+						return ret;
+					}
+				}
+
+				/* invert output value */
+				ret = (ZBX_REGEXP_MATCH == ret ? ZBX_REGEXP_NO_MATCH : ZBX_REGEXP_MATCH);
+				break;
+			case EXPRESSION_TYPE_INCLUDED:
+			case EXPRESSION_TYPE_ANY_INCLUDED:
+				ret = (SUCCEED == found ? ZBX_REGEXP_MATCH : ZBX_REGEXP_NO_MATCH);
+				break;
+			case EXPRESSION_TYPE_NOT_INCLUDED:
+				ret = (SUCCEED == found ? ZBX_REGEXP_NO_MATCH : ZBX_REGEXP_MATCH);
+				break;
+		}
+
+		if (ZBX_REGEXP_NO_MATCH == ret)
+		{
+			zbx_free(output_accu);
+			break;
+		}
+	}
+
+	if (ZBX_REGEXP_MATCH == ret && NULL != output_accu)
+	{
+		*output = output_accu;
+		return ZBX_REGEXP_MATCH;
+	}
+out:
+	if (ZBX_REGEXP_MATCH == ret && NULL != output && NULL == *output)
+	{
+		size_t	offset = 0, size = 0;
+
+		zbx_strcpy_alloc(output, &size, &offset, string);
+	}
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: matches string against regexp set, see zbx_regexp_match_ex()      *
+ *                                                                            *
+ * Return value: ZBX_REGEXP_MATCH, ZBX_REGEXP_NO_MATCH or FAIL                *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_regexp_set_match(zbx_regexp_set_t *set, const char *string)
+{
+	int	ret;
+
+	/* unlike zbx_regexp_sub_ex2() zbx_regexp_match_ex() fails for unknown global regular expression */
+	if (0 == set->fallback && NULL != set->pattern && '@' == *set->pattern && 0 == set->expressions_num)
+		return FAIL;
+
+	if (ZBX_REGEXP_MATCH != (ret = zbx_regexp_set_sub(set, string, NULL, NULL, NULL)) &&
+			ZBX_REGEXP_NO_MATCH != ret)
+	{
+		ret = FAIL;
+	}
+
+	return ret;
+}
+
+#undef REGEXP_LITERAL_EMPTY
+#undef REGEXP_PREFILTER_EXACT
+#undef REGEXP_PREFILTER_REQUIRED
+#undef REGEXP_PREFILTER_NONE
+
 #undef EXPRESSION_TYPE_INCLUDED
 #undef EXPRESSION_TYPE_ANY_INCLUDED
 #undef EXPRESSION_TYPE_NOT_INCLUDED
@@ -77,6 +77,22 @@
  *  lo_bound             `size' fields in chunk B                   hi_bound  *
  *  (aligned)            have SHMEM_FLG_USED bit set               (aligned)  *
  *                                                                            *
+ * (*) slab: a used chunk split into objects of the same size class           *
+ *                                                                            *
+ *     allocations of up to SHMEM_SLAB_MAX_OBJECT bytes are served from       *
+ *     slabs, each object is preceded by a single 8 byte header with          *
+ *     SHMEM_FLG_SLAB bit set and object offset from the slab start, so       *
+ *     the object is never coalesced and frees in constant time               *
+ *                                                                            *
+ *                 +------------------ slab chunk -------------------+        *
+ *                 |                                                 |        *
+ *                 v                                                 v        *
+ *  |--------|-- slab header --|--------|-object-|--------|-object-|...|----| *
+ *    size                       offset            offset                     *
+ *                                                                            *
+ *     slabs having free objects are kept in per size class lists, free      *
+ *     objects of a slab are linked through their first pointer              *
+ *                                                                            *
  ******************************************************************************/
 
 static void	*ALIGN4(void *ptr);
@@ -103,16 +119,56 @@ static void	*__mem_malloc(zbx_shmem_info_t *info, zbx_uint64_t size);
 static void	*__mem_realloc(zbx_shmem_info_t *info, void *old, zbx_uint64_t size);
 static void	__mem_free(zbx_shmem_info_t *info, void *ptr);
 
+static void	*mem_slab_malloc(zbx_shmem_info_t *info, zbx_uint64_t size);
+static void	mem_slab_free(zbx_shmem_info_t *info, void *ptr);
+
 #define SHMEM_SIZE_FIELD	sizeof(zbx_uint64_t)
 
 #define SHMEM_FLG_USED		((__UINT64_C(1))<<63)
+#define SHMEM_FLG_SLAB		((__UINT64_C(1))<<62)
 
 #define FREE_CHUNK(ptr)		(((*(zbx_uint64_t *)(ptr)) & SHMEM_FLG_USED) == 0)
 #define CHUNK_SIZE(ptr)		((*(zbx_uint64_t *)(ptr)) & ~SHMEM_FLG_USED)
 
+#if defined(SHM_HUGETLB) && !defined(SHM_HUGE_SHIFT)
+#	define SHM_HUGE_SHIFT	26
+#endif
+
 #define SHMEM_MIN_SIZE		__UINT64_C(128)
 #define SHMEM_MAX_SIZE		__UINT64_C(0x1000000000)	/* 64 GB */
 
+#define SLAB_OBJECT(ptr)	(0 != ((*(zbx_uint64_t *)((char *)(ptr) - SHMEM_SIZE_FIELD)) & SHMEM_FLG_SLAB))
+
+#define SHMEM_SLAB_SIZE		__UINT64_C(8192)
+#define SHMEM_SLAB_MAX_OBJECT	128
+/* segments smaller than this do not use slabs to avoid wasting memory on partially used slabs */
+#define SHMEM_SLAB_MIN_TOTAL	(64 * SHMEM_SLAB_SIZE)
+
+static const zbx_uint64_t	slab_object_sizes[ZBX_SHMEM_SLAB_CLASS_COUNT] = {24, 32, 40, 48, 64, 80, 96,
+		SHMEM_SLAB_MAX_OBJECT};
+
+typedef struct zbx_shmem_slab
+{
+	struct zbx_shmem_slab	*prev;
+	struct zbx_shmem_slab	*next;
+	void			*free_objects;
+	unsigned int		objects_used;
+	unsigned int		objects_num;
+	int			class_index;
+}
+zbx_shmem_slab_t;
+
+struct zbx_shmem_slab_class
+{
+	/* slabs having free objects */
+	zbx_shmem_slab_t	*slabs;
+	unsigned int		slabs_num;
+	unsigned int		objects_used;
+};
+
+/* huge page size to back segments with, 0 - huge pages are not used */
+static zbx_uint64_t	shmem_huge_page_size = 0;
+
 /* helper functions */
 
 static void	*ALIGN4(void *ptr)
@@ -521,13 +577,293 @@ static void	__mem_free(zbx_shmem_info_t *info, void *ptr)
 	}
 }
 
+/* private slab functions */
+
+static int	mem_slab_class_by_size(zbx_uint64_t size)
+{
+	if (SHMEM_SLAB_MAX_OBJECT < size)
+		return -1;
+
+	for (int i = 0; i < ZBX_SHMEM_SLAB_CLASS_COUNT; i++)
+	{
+		if (size <= slab_object_sizes[i])
+			return i;
+	}
+
+	return -1;
+}
+
+static zbx_uint64_t	mem_slab_header_size(void)
+{
+	return (sizeof(zbx_shmem_slab_t) + 7) & ~(zbx_uint64_t)7;
+}
+
+static unsigned int	mem_slab_objects_num(int class_index)
+{
+	return (unsigned int)((SHMEM_SLAB_SIZE - mem_slab_header_size()) /
+			(SHMEM_SIZE_FIELD + slab_object_sizes[class_index]));
+}
+
+static zbx_shmem_slab_t	*mem_slab_by_object(void *ptr)
+{
+	zbx_uint64_t	offset = *(zbx_uint64_t *)((char *)ptr - SHMEM_SIZE_FIELD) & ~(SHMEM_FLG_USED | SHMEM_FLG_SLAB);
+
+	return (zbx_shmem_slab_t *)((char *)ptr - SHMEM_SIZE_FIELD - offset);
+}
+
+static void	mem_slab_link(zbx_shmem_slab_class_t *slab_class, zbx_shmem_slab_t *slab)
+{
+	slab->prev = NULL;
+	slab->next = slab_class->slabs;
+
+	if (NULL != slab_class->slabs)
+		slab_class->slabs->prev = slab;
+
+	slab_class->slabs = slab;
+}
+
+static void	mem_slab_unlink(zbx_shmem_slab_class_t *slab_class, zbx_shmem_slab_t *slab)
+{
+	if (NULL != slab->prev)
+		slab->prev->next = slab->next;
+	else
+		slab_class->slabs = slab->next;
+
+	if (NULL != slab->next)
+		slab->next->prev = slab->prev;
+
+	slab->prev = slab->next = NULL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: allocates new slab for the size class from chunk memory           *
+ *                                                                            *
+ * Return value: allocated slab or NULL if there is not enough memory         *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_shmem_slab_t	*mem_slab_create(zbx_shmem_info_t *info, int class_index)
+{
+	zbx_shmem_slab_t	*slab;
+	void			*chunk;
+	char			*object;
+	zbx_uint64_t		object_size = SHMEM_SIZE_FIELD + slab_object_sizes[class_index];
+
+	if (NULL == (chunk = __mem_malloc(info, SHMEM_SLAB_SIZE)))
+		return NULL;
+
+	slab = (zbx_shmem_slab_t *)((char *)chunk + SHMEM_SIZE_FIELD);
+	slab->class_index = class_index;
+	slab->objects_num = mem_slab_objects_num(class_index);
+	slab->objects_used = 0;
+	slab->free_objects = NULL;
+
+	/* link free objects in reverse order so they are allocated in the order of addresses */
+	object = (char *)slab + mem_slab_header_size() + (slab->objects_num - 1) * object_size;
+
+	for (unsigned int i = 0; i < slab->objects_num; i++, object -= object_size)
+	{
+		*(zbx_uint64_t *)object = SHMEM_FLG_SLAB | (zbx_uint64_t)(object - (char *)slab);
+		*(void **)(object + SHMEM_SIZE_FIELD) = slab->free_objects;
+		slab->free_objects = object + SHMEM_SIZE_FIELD;
+	}
+
+	info->slab_classes[class_index].slabs_num++;
+	mem_slab_link(&info->slab_classes[class_index], slab);
+
+	return slab;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: allocates object from slab of the matching size class            *
+ *                                                                            *
+ * Return value: pointer to the object header (as for chunks) or NULL if the  *
+ *               size is not served by slabs or there is not enough memory   *
+ *                                                                            *
+ ******************************************************************************/
+static void	*mem_slab_malloc(zbx_shmem_info_t *info, zbx_uint64_t size)
+{
+	int			class_index;
+	zbx_shmem_slab_class_t	*slab_class;
+	zbx_shmem_slab_t	*slab;
+	void			*ptr;
+
+	if (SHMEM_SLAB_MIN_TOTAL > info->total_size || -1 == (class_index = mem_slab_class_by_size(size)))
+		return NULL;
+
+	slab_class = &info->slab_classes[class_index];
+
+	if (NULL == (slab = slab_class->slabs) && NULL == (slab = mem_slab_create(info, class_index)))
+		return NULL;
+
+	ptr = slab->free_objects;
+	slab->free_objects = *(void **)ptr;
+	*(zbx_uint64_t *)((char *)ptr - SHMEM_SIZE_FIELD) |= SHMEM_FLG_USED;
+
+	slab_class->objects_used++;
+
+	if (++slab->objects_used == slab->objects_num)
+		mem_slab_unlink(slab_class, slab);
+
+	return (char *)ptr - SHMEM_SIZE_FIELD;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns object to its slab                                        *
+ *                                                                            *
+ * Comments: Empty slabs are returned to chunk memory unless it is the last   *
+ *           slab with free objects in its size class.                        *
+ *                                                                            *
+ ******************************************************************************/
+static void	mem_slab_free(zbx_shmem_info_t *info, void *ptr)
+{
+	zbx_shmem_slab_t	*slab = mem_slab_by_object(ptr);
+	zbx_shmem_slab_class_t	*slab_class = &info->slab_classes[slab->class_index];
+
+	*(zbx_uint64_t *)((char *)ptr - SHMEM_SIZE_FIELD) &= ~SHMEM_FLG_USED;
+	*(void **)ptr = slab->free_objects;
+	slab->free_objects = ptr;
+
+	slab_class->objects_used--;
+
+	if (slab->objects_used-- == slab->objects_num)
+		mem_slab_link(slab_class, slab);
+
+	if (0 == slab->objects_used && (slab != slab_class->slabs || NULL != slab->next))
+	{
+		mem_slab_unlink(slab_class, slab);
+		slab_class->slabs_num--;
+		__mem_free(info, slab);
+	}
+}
+
+static void	mem_slab_clear(zbx_shmem_info_t *info)
+{
+	memset(info->slab_classes, 0, ZBX_SHMEM_SLAB_CLASS_COUNT * sizeof(zbx_shmem_slab_class_t));
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: allocates memory from slabs if possible, from chunks otherwise    *
+ *                                                                            *
+ ******************************************************************************/
+static void	*mem_malloc(zbx_shmem_info_t *info, zbx_uint64_t size)
+{
+	void	*chunk;
+
+	if (NULL != (chunk = mem_slab_malloc(info, mem_proper_alloc_size(size))))
+		return chunk;
+
+	return __mem_malloc(info, size);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: reallocates slab object                                           *
+ *                                                                            *
+ * Return value: pointer to the new memory header or NULL if there is not     *
+ *               enough memory (the old object is kept in that case)          *
+ *                                                                            *
+ ******************************************************************************/
+static void	*mem_slab_realloc(zbx_shmem_info_t *info, void *old, zbx_uint64_t size)
+{
+	zbx_uint64_t	object_size = slab_object_sizes[mem_slab_by_object(old)->class_index];
+	void		*chunk;
+
+	/* do not move if the object still fits and not much would be saved */
+	if (size <= object_size && size > object_size / 2)
+		return (char *)old - SHMEM_SIZE_FIELD;
+
+	if (NULL == (chunk = mem_malloc(info, size)))
+		return NULL;
+
+	memcpy((char *)chunk + SHMEM_SIZE_FIELD, old, MIN(size, object_size));
+	mem_slab_free(info, old);
+
+	return chunk;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets private shared memory segment backed by huge pages           *
+ *                                                                            *
+ * Parameters: size      - [IN/OUT] segment size, rounded up to huge page     *
+ *                                  size on success                          *
+ *             page_size - [IN] huge page size                               *
+ *             descr     - [IN] segment description                          *
+ *                                                                            *
+ * Return value: shared memory identifier or -1 if huge pages cannot be used *
+ *                                                                            *
+ ******************************************************************************/
+static int	mem_get_huge_pages(zbx_uint64_t *size, zbx_uint64_t page_size, const char *descr)
+{
+#if defined(SHM_HUGETLB)
+	int		shm_id, page_shift = 0;
+	zbx_uint64_t	huge_size;
+
+	while ((__UINT64_C(1) << page_shift) < page_size)
+		page_shift++;
+
+	huge_size = (*size + page_size - 1) / page_size * page_size;
+
+	if (huge_size > SHMEM_MAX_SIZE)
+		return -1;
+
+	if (-1 == (shm_id = shmget(IPC_PRIVATE, huge_size, SHM_HUGETLB | (page_shift << SHM_HUGE_SHIFT) | 0600)))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot get shared memory of size " ZBX_FS_SIZE_T " for %s backed by "
+				ZBX_FS_UI64 " byte huge pages, using normal pages: %s", (zbx_fs_size_t)huge_size,
+				descr, page_size, zbx_strerror(errno));
+		return -1;
+	}
+
+	if (huge_size != *size)
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "size of %s is rounded up from " ZBX_FS_UI64 " to " ZBX_FS_UI64
+				" bytes to fit " ZBX_FS_UI64 " byte huge pages", descr, *size, huge_size, page_size);
+	}
+
+	*size = huge_size;
+
+	return shm_id;
+#else
+	ZBX_UNUSED(size);
+
+	zabbix_log(LOG_LEVEL_WARNING, "cannot use " ZBX_FS_UI64 " byte huge pages for %s: huge pages are not"
+			" supported on this platform, using normal pages", page_size, descr);
+
+	return -1;
+#endif
+}
+
 /* public memory interface */
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: sets huge page size to back shared memory segments created later  *
+ *                                                                            *
+ * Parameters: size - [IN] huge page size or 0 to use normal pages            *
+ *                                                                            *
+ * Comments: Segments smaller than the huge page size use normal pages.       *
+ *           Larger segments are rounded up to the huge page size, which is   *
+ *           logged. If huge pages cannot be allocated (for example not       *
+ *           enough pages are reserved) normal pages of the requested size    *
+ *           are used as fallback.                                            *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_shmem_set_huge_page_size(zbx_uint64_t size)
+{
+	shmem_huge_page_size = size;
+}
+
 int	zbx_shmem_create(zbx_shmem_info_t **info, zbx_uint64_t size, const char *descr, const char *param,
 		int allow_oom, char **error)
 {
-	int	shm_id, index, ret = FAIL;
-	void	*base;
+	int		shm_id, index, ret = FAIL;
+	void		*base;
+	zbx_uint64_t	page_size;
 
 	descr = ZBX_NULL2STR(descr);
 	param = ZBX_NULL2STR(param);
@@ -550,12 +886,19 @@ int	zbx_shmem_create(zbx_shmem_info_t **info, zbx_uint64_t size, const char *des
 		goto out;
 	}
 
-	if (-1 == (shm_id = shmget(IPC_PRIVATE, size, 0600)))
+	if (0 != shmem_huge_page_size && size >= shmem_huge_page_size &&
+			-1 != (shm_id = mem_get_huge_pages(&size, shmem_huge_page_size, descr)))
+	{
+		page_size = shmem_huge_page_size;
+	}
+	else if (-1 == (shm_id = shmget(IPC_PRIVATE, size, 0600)))
 	{
 		*error = zbx_dsprintf(*error, "cannot get private shared memory of size " ZBX_FS_SIZE_T " for %s: %s",
 				(zbx_fs_size_t)size, descr, zbx_strerror(errno));
 		goto out;
 	}
+	else
+		page_size = (zbx_uint64_t)sysconf(_SC_PAGESIZE);
 
 	if ((void *)(-1) == (base = shmat(shm_id, NULL, 0)))
 	{
@@ -573,6 +916,7 @@ int	zbx_shmem_create(zbx_shmem_info_t **info, zbx_uint64_t size, const char *des
 	*info = (zbx_shmem_info_t *)ALIGN8(base);
 	(*info)->base = base;
 	(*info)->shm_id = shm_id;
+	(*info)->page_size = page_size;
 	(*info)->orig_size = size;
 	size -= (char *)(*info + 1) - (char *)base;
 
@@ -583,6 +927,11 @@ int	zbx_shmem_create(zbx_shmem_info_t **info, zbx_uint64_t size, const char *des
 	size -= (char *)((*info)->buckets + ZBX_SHMEM_BUCKET_COUNT) - (char *)base;
 	base = (void *)((*info)->buckets + ZBX_SHMEM_BUCKET_COUNT);
 
+	(*info)->slab_classes = (zbx_shmem_slab_class_t *)ALIGN8(base);
+	mem_slab_clear(*info);
+	size -= (char *)((*info)->slab_classes + ZBX_SHMEM_SLAB_CLASS_COUNT) - (char *)base;
+	base = (void *)((*info)->slab_classes + ZBX_SHMEM_SLAB_CLASS_COUNT);
+
 	zbx_strlcpy((char *)base, descr, size);
 	(*info)->mem_descr = (char *)base;
 	size -= strlen(descr) + 1;
@@ -611,10 +960,10 @@ int	zbx_shmem_create(zbx_shmem_info_t **info, zbx_uint64_t size, const char *des
 	(*info)->used_size = 0;
 	(*info)->free_size = (*info)->total_size;
 
-	zabbix_log(LOG_LEVEL_DEBUG, "valid user addresses: [%p, %p] total size: " ZBX_FS_SIZE_T,
-			(void *)((char *)(*info)->lo_bound + SHMEM_SIZE_FIELD),
+	zabbix_log(LOG_LEVEL_DEBUG, "valid user addresses: [%p, %p] total size: " ZBX_FS_SIZE_T " page size: "
+			ZBX_FS_UI64, (void *)((char *)(*info)->lo_bound + SHMEM_SIZE_FIELD),
 			(void *)((char *)(*info)->hi_bound - SHMEM_SIZE_FIELD),
-			(zbx_fs_size_t)(*info)->total_size);
+			(zbx_fs_size_t)(*info)->total_size, (*info)->page_size);
 out:
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 
@@ -646,6 +995,8 @@ int	zbx_shmem_create_min(zbx_shmem_info_t **info, zbx_uint64_t size, const char
 	base = (void *)((zbx_shmem_info_t *)(base) + 1);
 	base = ALIGNPTR(base);
 	base = (void *)((void **)base + ZBX_SHMEM_BUCKET_COUNT);
+	base = ALIGN8(base);
+	base = (void *)((zbx_shmem_slab_class_t *)base + ZBX_SHMEM_SLAB_CLASS_COUNT);
 	base = (void *)((char *)base + strlen(descr) + 1);
 	base = (void *)((char *)base + strlen(param) + 1);
 	base = ALIGN8(base);
@@ -681,7 +1032,7 @@ void	*__zbx_shmem_malloc(const char *file, int line, zbx_shmem_info_t *info, con
 		exit(EXIT_FAILURE);
 	}
 
-	chunk = __mem_malloc(info, size);
+	chunk = mem_malloc(info, size);
 
 	if (NULL == chunk)
 	{
@@ -713,7 +1064,9 @@ void	*__zbx_shmem_realloc(const char *file, int line, zbx_shmem_info_t *info, vo
 	}
 
 	if (NULL == old)
-		chunk = __mem_malloc(info, size);
+		chunk = mem_malloc(info, size);
+	else if (SLAB_OBJECT(old))
+		chunk = mem_slab_realloc(info, old, size);
 	else
 		chunk = __mem_realloc(info, old, size);
 
@@ -743,7 +1096,10 @@ void	__zbx_shmem_free(const char *file, int line, zbx_shmem_info_t *info, void *
 		exit(EXIT_FAILURE);
 	}
 
-	__mem_free(info, ptr);
+	if (SLAB_OBJECT(ptr))
+		mem_slab_free(info, ptr);
+	else
+		__mem_free(info, ptr);
 }
 
 void	zbx_shmem_clear(zbx_shmem_info_t *info)
@@ -753,6 +1109,7 @@ void	zbx_shmem_clear(zbx_shmem_info_t *info)
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
 	memset(info->buckets, 0, ZBX_SHMEM_BUCKET_COUNT * ZBX_PTR_SIZE);
+	mem_slab_clear(info);
 	index = mem_bucket_by_size(info->total_size);
 	info->buckets[index] = info->lo_bound;
 	mem_set_chunk_size(info->buckets[index], info->total_size);
@@ -798,6 +1155,22 @@ void	zbx_shmem_get_stats(const zbx_shmem_info_t *info, zbx_shmem_stats_t *stats)
 	stats->used_chunks = stats->overhead / (2 * SHMEM_SIZE_FIELD) + 1 - stats->free_chunks;
 	stats->free_size = info->free_size;
 	stats->used_size = info->used_size;
+	stats->page_size = info->page_size;
+
+	stats->slab_free_size = 0;
+
+	for (i = 0; i < ZBX_SHMEM_SLAB_CLASS_COUNT; i++)
+	{
+		const zbx_shmem_slab_class_t	*slab_class = &info->slab_classes[i];
+		zbx_shmem_slab_stats_t		*slab_stats = &stats->slabs[i];
+
+		slab_stats->object_size = slab_object_sizes[i];
+		slab_stats->slabs_num = slab_class->slabs_num;
+		slab_stats->objects_used = slab_class->objects_used;
+		slab_stats->objects_free = slab_class->slabs_num * mem_slab_objects_num(i) - slab_class->objects_used;
+
+		stats->slab_free_size += slab_stats->objects_free * slab_stats->object_size;
+	}
 }
 
 void	zbx_shmem_dump_stats(int level, zbx_shmem_info_t *info)
@@ -818,6 +1191,7 @@ void	zbx_shmem_dump_stats(int level, zbx_shmem_info_t *info)
 			ZBX_SHMEM_MIN_BUCKET_SIZE + 8 * i, stats.chunks_num[i]);
 	}
 
+	zabbix_log(level, "memory page size: %10llu bytes", (unsigned long long)stats.page_size);
 	zabbix_log(level, "min chunk size: %10llu bytes", (unsigned long long)stats.min_chunk_size);
 	zabbix_log(level, "max chunk size: %10llu bytes", (unsigned long long)stats.max_chunk_size);
 
@@ -831,6 +1205,22 @@ void	zbx_shmem_dump_stats(int level, zbx_shmem_info_t *info)
 	zabbix_log(level, "of those, %10llu bytes are used by allocation overhead",
 			(unsigned long long)stats.overhead);
 
+	for (i = 0; i < ZBX_SHMEM_SLAB_CLASS_COUNT; i++)
+	{
+		const zbx_shmem_slab_stats_t	*slab_stats = &stats.slabs[i];
+
+		if (0 == slab_stats->slabs_num)
+			continue;
+
+		zabbix_log(level, "slabs of %3llu byte objects: %6u, objects used: %8u free: %8u (%.1f%% used)",
+				(unsigned long long)slab_stats->object_size, slab_stats->slabs_num,
+				slab_stats->objects_used, slab_stats->objects_free, 100.0 * slab_stats->objects_used /
+				(slab_stats->objects_used + slab_stats->objects_free));
+	}
+
+	zabbix_log(level, "of used memory, %10llu bytes are in free slab objects",
+			(unsigned long long)stats.slab_free_size);
+
 	zabbix_log(level, "================================");
 }
 
@@ -849,6 +1239,8 @@ size_t	zbx_shmem_required_size(int chunks_num, const char *descr, const char *pa
 	size += sizeof(zbx_shmem_info_t);
 	size += ZBX_PTR_SIZE - 1;			/* ensure we allocate enough to align bucket pointers */
 	size += ZBX_PTR_SIZE * ZBX_SHMEM_BUCKET_COUNT;
+	size += 7;					/* ensure we allocate enough to 8-align slab classes */
+	size += sizeof(zbx_shmem_slab_class_t) * ZBX_SHMEM_SLAB_CLASS_COUNT;
 	size += strlen(descr) + 1;
 	size += strlen(param) + 1;
 	size += (SHMEM_SIZE_FIELD - 1) + 8;		/* ensure we allocate enough to align the first chunk */
@@ -164,6 +164,8 @@ void	zbx_zabbix_stats_get(struct zbx_json *json, int config_startup_time)
 	zbx_json_addfloat(json, "pfree", *(double *)zbx_dc_config_get_stats(ZBX_CONFSTATS_BUFFER_PFREE));
 	zbx_json_adduint64(json, "used", *(zbx_uint64_t *)zbx_dc_config_get_stats(ZBX_CONFSTATS_BUFFER_USED));
 	zbx_json_addfloat(json, "pused", *(double *)zbx_dc_config_get_stats(ZBX_CONFSTATS_BUFFER_PUSED));
+	zbx_json_adduint64(json, "pagesize",
+			*(zbx_uint64_t *)zbx_dc_config_get_stats(ZBX_CONFSTATS_BUFFER_PAGESIZE));
 	zbx_json_close(json);
 
 	/* zabbix[version] */
@@ -191,6 +193,7 @@ void	zbx_zabbix_stats_get(struct zbx_json *json, int config_startup_time)
 	zbx_json_adduint64(json, "used", wcache_info.history_total - wcache_info.history_free);
 	zbx_json_addfloat(json, "pused", 100 * (double)(wcache_info.history_total - wcache_info.history_free) /
 			(double)wcache_info.history_total);
+	zbx_json_adduint64(json, "pagesize", wcache_info.history_page_size);
 	zbx_json_close(json);
 
 	zbx_json_addobject(json, "index");
@@ -200,6 +203,16 @@ void	zbx_zabbix_stats_get(struct zbx_json *json, int config_startup_time)
 	zbx_json_adduint64(json, "used", wcache_info.index_total - wcache_info.index_free);
 	zbx_json_addfloat(json, "pused", 100 * (double)(wcache_info.index_total - wcache_info.index_free) /
 			(double)wcache_info.index_total);
+	zbx_json_adduint64(json, "pagesize", wcache_info.index_page_size);
+	zbx_json_close(json);
+
+	zbx_json_addobject(json, "spill");
+	zbx_json_adduint64(json, "values", wcache_info.spill_values);
+	zbx_json_adduint64(json, "total", wcache_info.spill_total);
+	zbx_json_adduint64(json, "used", wcache_info.spill_used);
+	zbx_json_addfloat(json, "pused", 0 != wcache_info.spill_total ?
+			100 * (double)wcache_info.spill_used / (double)wcache_info.spill_total : 0);
+	zbx_json_adduint64(json, "lag", (zbx_uint64_t)wcache_info.spill_lag);
 	zbx_json_close(json);
 
 	if (0 != (get_program_type_cb() & ZBX_PROGRAM_TYPE_SERVER))
@@ -211,6 +224,7 @@ void	zbx_zabbix_stats_get(struct zbx_json *json, int config_startup_time)
 		zbx_json_adduint64(json, "used", wcache_info.trend_total - wcache_info.trend_free);
 		zbx_json_addfloat(json, "pused", 100 * (double)(wcache_info.trend_total - wcache_info.trend_free) /
 				(double)wcache_info.trend_total);
+		zbx_json_adduint64(json, "pagesize", wcache_info.trend_page_size);
 		zbx_json_close(json);
 	}
 
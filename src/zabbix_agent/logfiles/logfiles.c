@@ -1975,8 +1975,8 @@ static void	log_regexp_runtime_error(const char *key, const char *err_msg, zbx_u
  *                                                                            *
  ******************************************************************************/
 static int	zbx_read2(int fd, unsigned char flags, struct st_logfile *logfile, zbx_uint64_t *lastlogsize,
-		const int *mtime, int *big_rec, const char *encoding, zbx_vector_expression_t *regexps,
-		const char *pattern, const char *output_template, int *p_count, int *s_count,
+		const int *mtime, int *big_rec, const char *encoding, zbx_regexp_set_t *regexp_set,
+		const char *output_template, int *p_count, int *s_count,
 		zbx_process_value_func_t process_value, zbx_vector_addr_ptr_t *addrs, zbx_vector_ptr_t *agent2_result,
 		zbx_uint64_t itemid, const char *hostname, const char *key, zbx_uint64_t *lastlogsize_sent,
 		int *mtime_sent, const char *persistent_file_name, zbx_vector_pre_persistent_t *prep_vec,
@@ -2096,7 +2096,7 @@ static int	zbx_read2(int fd, unsigned char flags, struct st_logfile *logfile, zb
 					processed_size = (size_t)offset + (size_t)nbytes;
 					send_err = FAIL;
 
-					regexp_ret = zbx_regexp_sub_ex2(regexps, value, pattern, ZBX_CASE_SENSITIVE,
+					regexp_ret = zbx_regexp_set_sub(regexp_set, value,
 							(0 == is_count_item) ? output_template : NULL,
 							(0 == is_count_item) ? &item_value : NULL, err_msg);
 #if !defined(_WINDOWS) && !defined(__MINGW32__)
@@ -2234,7 +2234,7 @@ static int	zbx_read2(int fd, unsigned char flags, struct st_logfile *logfile, zb
 					processed_size = (size_t)offset + (size_t)(p_next - buf);
 					send_err = FAIL;
 
-					regexp_ret = zbx_regexp_sub_ex2(regexps, value, pattern, ZBX_CASE_SENSITIVE,
+					regexp_ret = zbx_regexp_set_sub(regexp_set, value,
 							(0 == is_count_item) ? output_template : NULL,
 							(0 == is_count_item) ? &item_value : NULL, err_msg);
 #if !defined(_WINDOWS) && !defined(__MINGW32__)
@@ -2382,8 +2382,7 @@ out:
  *                                 zbx_find_cr_lf_szbyte() for supported encodings.     *
  *                                 "" (empty string) means a single-byte character set  *
  *                                 (e.g. ASCII).                                        *
- *     regexps              - [IN] vector of regexps                                    *
- *     pattern              - [IN] pattern to match                                     *
+ *     regexp_set           - [IN] compiled pattern to match                            *
  *     output_template      - [IN] output formatting template                           *
  *     p_count              - [IN/OUT] limit of records to be processed                 *
  *     s_count              - [IN/OUT] limit of records to be sent to server            *
@@ -2419,9 +2418,9 @@ out:
  ****************************************************************************************/
 static int	process_log(unsigned char flags, struct st_logfile *logfile, zbx_uint64_t *lastlogsize, int *mtime,
 		zbx_uint64_t *lastlogsize_sent, int *mtime_sent, unsigned char *skip_old_data, int *big_rec,
-		const char *encoding, zbx_vector_expression_t *regexps, const char *pattern,
-		const char *output_template, int *p_count, int *s_count, zbx_process_value_func_t process_value,
-		zbx_vector_addr_ptr_t *addrs, zbx_vector_ptr_t *agent2_result, const char *hostname, const char *key,
+		const char *encoding, zbx_regexp_set_t *regexp_set, const char *output_template, int *p_count,
+		int *s_count, zbx_process_value_func_t process_value, zbx_vector_addr_ptr_t *addrs,
+		zbx_vector_ptr_t *agent2_result, const char *hostname, const char *key,
 		zbx_uint64_t *processed_bytes, zbx_uint64_t seek_offset, const char *persistent_file_name,
 		zbx_vector_pre_persistent_t *prep_vec, const zbx_config_tls_t *config_tls, int config_timeout,
 		const char *config_source_ip, zbx_uint64_t itemid, int config_buffer_send, int config_buffer_size,
@@ -2441,8 +2440,8 @@ static int	process_log(unsigned char flags, struct st_logfile *logfile, zbx_uint
 		*lastlogsize = seek_offset;
 		*skip_old_data = 0;
 
-		if (SUCCEED == (ret = zbx_read2(f, flags, logfile, lastlogsize, mtime, big_rec, encoding, regexps,
-				pattern, output_template, p_count, s_count, process_value, addrs, agent2_result,
+		if (SUCCEED == (ret = zbx_read2(f, flags, logfile, lastlogsize, mtime, big_rec, encoding, regexp_set,
+				output_template, p_count, s_count, process_value, addrs, agent2_result,
 				itemid, hostname, key, lastlogsize_sent, mtime_sent, persistent_file_name, prep_vec,
 				config_tls, config_timeout, config_source_ip, config_buffer_send, config_buffer_size,
 				err_msg)))
@@ -3245,8 +3244,7 @@ static int	update_new_list_from_old(zbx_log_rotation_options_t rotation_type, st
  *                                encodings.                                          *
  *                                "" (empty string) means a single-byte character set *
  *                                (e.g. ASCII).                                       *
- *     regexps              - [IN] array of regexps                                   *
- *     pattern              - [IN] pattern to match                                   *
+ *     regexp_set           - [IN] compiled pattern to match                          *
  *     output_template      - [IN] output formatting template                         *
  *     p_count              - [IN/OUT] limit of records to be processed               *
  *     s_count              - [IN/OUT] limit of records to be sent to server          *
@@ -3283,7 +3281,7 @@ static int	process_logrt(unsigned char flags, const char *filename, zbx_uint64_t
 		zbx_uint64_t *lastlogsize_sent, int *mtime_sent, unsigned char *skip_old_data, int *big_rec,
 		int *use_ino, char **err_msg, struct st_logfile **logfiles_old, int logfiles_num_old,
 		struct st_logfile **logfiles_new, int *logfiles_num_new, const char *encoding,
-		zbx_vector_expression_t *regexps, const char *pattern, const char *output_template, int *p_count,
+		zbx_regexp_set_t *regexp_set, const char *output_template, int *p_count,
 		int *s_count, zbx_process_value_func_t process_value, zbx_vector_addr_ptr_t *addrs,
 		zbx_vector_ptr_t *agent2_result, const char *hostname, const char *key, int *jumped, float max_delay,
 		double *start_time, zbx_uint64_t *processed_bytes, zbx_log_rotation_options_t rotation_type,
@@ -3492,7 +3490,7 @@ static int	process_logrt(unsigned char flags, const char *filename, zbx_uint64_t
 			if (0 != process_this_file)
 			{
 				ret = process_log(flags, logfiles + i, lastlogsize, mtime, lastlogsize_sent,
-						mtime_sent, skip_old_data, big_rec, encoding, regexps, pattern,
+						mtime_sent, skip_old_data, big_rec, encoding, regexp_set,
 						output_template, p_count, s_count, process_value, addrs, agent2_result,
 						hostname, key, &processed_bytes_tmp, seek_offset, persistent_file_name,
 						prep_vec, config_tls, config_timeout, config_source_ip, itemid,
@@ -3848,6 +3846,7 @@ int	process_log_check(zbx_vector_addr_ptr_t *addrs, zbx_vector_ptr_t *agent2_res
 	zbx_uint64_t			lastlogsize_orig;
 	float				max_delay;
 	struct st_logfile		*logfiles_new = NULL;
+	zbx_regexp_set_t		*regexp_set;
 
 	if (0 != (ZBX_METRIC_FLAG_LOG_COUNT & metric->flags))
 		is_count_item = 1;
@@ -4067,14 +4066,19 @@ int	process_log_check(zbx_vector_addr_ptr_t *addrs, zbx_vector_ptr_t *agent2_res
 		}
 	}
 #endif
+	/* compile the pattern once for all records read by this check */
+	regexp_set = zbx_regexp_set_create(regexps, regexp, ZBX_CASE_SENSITIVE);
+
 	ret = process_logrt(metric->flags, filename, &metric->lastlogsize, &metric->mtime, lastlogsize_sent, mtime_sent,
 			&metric->skip_old_data, &metric->big_rec, &metric->use_ino, error, &metric->logfiles,
-			metric->logfiles_num, &logfiles_new, &logfiles_num_new, encoding, regexps, regexp,
+			metric->logfiles_num, &logfiles_new, &logfiles_num_new, encoding, regexp_set,
 			output_template, &p_count, &s_count, process_value_cb, addrs, agent2_result, config_hostname,
 			metric->key, &jumped, max_delay, &metric->start_time, &metric->processed_bytes,
 			rotation_type, metric->persistent_file_name, prep_vec, config_tls, config_timeout,
 			config_source_ip, metric->itemid, config_buffer_send, config_buffer_size);
 
+	zbx_regexp_set_free(regexp_set);
+
 	if (0 == is_count_item && NULL != logfiles_new)
 	{
 		/* for log[] and logrt[] items - switch to the new log file list */
@@ -18,6 +18,7 @@
 #include "zbxdbhigh.h"
 #include "zbxcacheconfig.h"
 #include "zbxcachehistory.h"
+#include "zbxshmem.h"
 #include "zbxdbupgrade.h"
 #include "zbxlog.h"
 #include "zbxgetopt.h"
@@ -276,8 +277,14 @@ static int	config_vmware_timeout		= 10;
 static zbx_uint64_t	config_conf_cache_size		= 8 * ZBX_MEBIBYTE;
 static zbx_uint64_t	config_history_cache_size	= 16 * ZBX_MEBIBYTE;
 static zbx_uint64_t	config_history_index_cache_size	= 4 * ZBX_MEBIBYTE;
+static char		*config_history_cache_spill_dir	= NULL;
+static zbx_uint64_t	config_history_cache_spill_size	= 256 * ZBX_MEBIBYTE;
 static zbx_uint64_t	config_trends_cache_size	= 0;
 static zbx_uint64_t	config_vmware_cache_size	= 8 * ZBX_MEBIBYTE;
+static zbx_uint64_t	config_huge_page_size		= 0;
+static zbx_uint64_t	config_preprocessing_ring_size	= 0;
+static char		*config_preprocessing_capture_file	= NULL;
+static int		config_preprocessing_capture_sample	= 1;
 
 static int	config_unreachable_period		= 45;
 static int	config_unreachable_delay		= 15;
@@ -662,6 +669,20 @@ static void	zbx_validate_config(ZBX_TASK_EX *task)
 		err = 1;
 	}
 
+	if (0 != config_huge_page_size && 2 * ZBX_MEBIBYTE != config_huge_page_size &&
+			ZBX_GIBIBYTE != config_huge_page_size)
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "\"HugePageSize\" configuration parameter must be 0, 2M or 1G");
+		err = 1;
+	}
+
+	if (0 != config_preprocessing_ring_size && 64 * ZBX_KIBIBYTE > config_preprocessing_ring_size)
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "\"PreprocessingRingSize\" configuration parameter must be 0 or at least"
+				" 64K");
+		err = 1;
+	}
+
 	if (NULL != zbx_config_source_ip && SUCCEED != zbx_is_supported_ip(zbx_config_source_ip))
 	{
 		zabbix_log(LOG_LEVEL_CRIT, "invalid \"SourceIP\" configuration parameter: '%s'", zbx_config_source_ip);
@@ -898,6 +919,12 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 				ZBX_CONF_PARM_OPT,	128 * ZBX_KIBIBYTE,	__UINT64_C(2) * ZBX_GIBIBYTE},
 		{"HistoryIndexCacheSize",	&config_history_index_cache_size,	ZBX_CFG_TYPE_UINT64,
 				ZBX_CONF_PARM_OPT,	128 * ZBX_KIBIBYTE,	__UINT64_C(2) * ZBX_GIBIBYTE},
+		{"HistoryCacheSpillDir",	&config_history_cache_spill_dir,	ZBX_CFG_TYPE_STRING,
+				ZBX_CONF_PARM_OPT,	0,			0},
+		{"HistoryCacheSpillSize",	&config_history_cache_spill_size,	ZBX_CFG_TYPE_UINT64,
+				ZBX_CONF_PARM_OPT,	64 * ZBX_MEBIBYTE,	__UINT64_C(64) * ZBX_GIBIBYTE},
+		{"HugePageSize",		&config_huge_page_size,			ZBX_CFG_TYPE_UINT64,
+				ZBX_CONF_PARM_OPT,	0,			ZBX_GIBIBYTE},
 		{"HousekeepingFrequency",	&config_housekeeping_frequency,		ZBX_CFG_TYPE_INT,
 				ZBX_CONF_PARM_OPT,	0,			24},
 		{"ProxyLocalBuffer",		&config_proxy_local_buffer,		ZBX_CFG_TYPE_INT,
@@ -999,6 +1026,10 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 				ZBX_CONF_PARM_OPT,	0,			0},
 		{"LogSlowQueries",		&(zbx_db_config->log_slow_queries),	ZBX_CFG_TYPE_INT,
 				ZBX_CONF_PARM_OPT,	0,			3600000},
+		{"DBPipelining",		&(zbx_db_config->pipelining),		ZBX_CFG_TYPE_INT,
+				ZBX_CONF_PARM_OPT,	0,			1},
+		{"DBPreparedStatements",	&(zbx_db_config->prepared_statements),	ZBX_CFG_TYPE_INT,
+				ZBX_CONF_PARM_OPT,	0,			1},
 		{"LoadModulePath",		&config_load_module_path,		ZBX_CFG_TYPE_STRING,
 				ZBX_CONF_PARM_OPT,	0,			0},
 		{"LoadModule",			&config_load_module,			ZBX_CFG_TYPE_MULTISTRING,
@@ -1066,6 +1097,12 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 		{"StartPreprocessors",		&config_forks[ZBX_PROCESS_TYPE_PREPROCESSOR],
 											ZBX_CFG_TYPE_INT,
 				ZBX_CONF_PARM_OPT,	1,			1000},
+		{"PreprocessingRingSize",	&config_preprocessing_ring_size,	ZBX_CFG_TYPE_UINT64,
+				ZBX_CONF_PARM_OPT,	0,			ZBX_GIBIBYTE},
+		{"PreprocessingCaptureFile",	&config_preprocessing_capture_file,	ZBX_CFG_TYPE_STRING,
+				ZBX_CONF_PARM_OPT,	0,			0},
+		{"PreprocessingCaptureSample",	&config_preprocessing_capture_sample,	ZBX_CFG_TYPE_INT,
+				ZBX_CONF_PARM_OPT,	1,			1000000},
 		{"ListenBacklog",		&config_tcp_max_backlog_size,		ZBX_CFG_TYPE_INT,
 				ZBX_CONF_PARM_OPT,	0,			INT_MAX},
 		{"StartODBCPollers",		&config_forks[ZBX_PROCESS_TYPE_ODBCPOLLER],
@@ -1647,8 +1684,13 @@ int	MAIN_ZABBIX_ENTRY(int flags)
 
 	zbx_unblock_signals(&orig_mask);
 
+	zbx_shmem_set_huge_page_size(config_huge_page_size);
+	zbx_preprocessor_set_ring_size(config_preprocessing_ring_size);
+	zbx_preprocessor_set_capture(config_preprocessing_capture_file, config_preprocessing_capture_sample);
+
 	if (SUCCEED != zbx_init_database_cache(get_zbx_program_type, zbx_sync_proxy_history, config_history_cache_size,
-			config_history_index_cache_size, &config_trends_cache_size, &error))
+			config_history_index_cache_size, &config_trends_cache_size, config_history_cache_spill_dir,
+			config_history_cache_spill_size, &error))
 	{
 		zabbix_log(LOG_LEVEL_CRIT, "cannot initialize database cache: %s", error);
 		zbx_free(error);
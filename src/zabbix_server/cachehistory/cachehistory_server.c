@@ -1320,18 +1320,14 @@ void	zbx_sync_server_history(int *values_num, int *triggers_num, const zbx_event
 
 		*more = ZBX_SYNC_DONE;
 
-		zbx_dbcache_lock();
 		zbx_hc_pop_items(&history_items);		/* select and take items out of history cache */
-		zbx_dbcache_unlock();
 
 		if (0 != history_items.values_num)
 		{
 			if (0 == (history_num = zbx_dc_config_lock_triggers_by_history_items(&history_items,
 					&triggerids)))
 			{
-				zbx_dbcache_lock();
 				zbx_hc_push_items(&history_items);
-				zbx_dbcache_unlock();
 				zbx_vector_hc_item_ptr_clear(&history_items);
 			}
 		}
@@ -1392,7 +1388,7 @@ void	zbx_sync_server_history(int *values_num, int *triggers_num, const zbx_event
 					if (0 == trends_num)
 						break;
 
-					zbx_db_begin();
+					zbx_db_begin_pipeline();
 
 					DBmass_update_trends(trends, trends_num, &trends_diff);
 
@@ -1408,7 +1404,7 @@ void	zbx_sync_server_history(int *values_num, int *triggers_num, const zbx_event
 					if (0 == item_diff.values_num && 0 == inventory_values.values_num)
 						break;
 					zbx_prof_start("update items", ZBX_PROF_PROCESSING);
-					zbx_db_begin();
+					zbx_db_begin_pipeline();
 
 					zbx_db_mass_update_items(&item_diff, &inventory_values);
 
@@ -1467,7 +1463,7 @@ void	zbx_sync_server_history(int *values_num, int *triggers_num, const zbx_event
 					zbx_vector_escalation_new_ptr_t	escalations;
 
 					zbx_vector_escalation_new_ptr_create(&escalations);
-					zbx_db_begin();
+					zbx_db_begin_pipeline();
 
 					recalculate_triggers(history, history_num, &itemids, items, errcodes,
 							&trigger_timers, events_cbs->add_event_cb, &trigger_diff,
@@ -1532,9 +1528,7 @@ void	zbx_sync_server_history(int *values_num, int *triggers_num, const zbx_event
 
 		if (0 != history_num)
 		{
-			zbx_dbcache_lock();
 			zbx_hc_push_items(&history_items);	/* return items to history cache */
-			zbx_dbcache_set_history_num(zbx_dbcache_get_history_num() - history_num);
 
 			if (0 != zbx_hc_queue_get_size())
 			{
@@ -1547,8 +1541,6 @@ void	zbx_sync_server_history(int *values_num, int *triggers_num, const zbx_event
 					*more = ZBX_SYNC_MORE;
 			}
 
-			zbx_dbcache_unlock();
-
 			*values_num += history_num;
 		}
 
@@ -102,6 +102,15 @@ typedef struct
 }
 zbx_func_t;
 
+/* function ready for evaluation */
+typedef struct
+{
+	zbx_func_t			*func;
+	const zbx_history_sync_item_t	*item;
+	char				*params;
+}
+zbx_func_eval_t;
+
 typedef struct
 {
 	zbx_uint64_t	functionid;
@@ -235,9 +244,11 @@ static void	evaluate_item_functions(zbx_hashset_t *funcs, const zbx_vector_uint6
 		zbx_history_sync_item_t **items, int **items_err, int *items_num)
 {
 	char			*error = NULL;
-	int			i;
+	int			i, evals_num = 0;
 	zbx_func_t		*func;
+	zbx_func_eval_t		*evals;
 	zbx_vector_uint64_t	itemids;
+	zbx_vector_vc_request_t	requests;
 	zbx_hashset_iter_t	iter;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() funcs_num:%d", __func__, funcs->num_data);
@@ -265,13 +276,13 @@ static void	evaluate_item_functions(zbx_hashset_t *funcs, const zbx_vector_uint6
 				(size_t)itemids.values_num, ZBX_ITEM_GET_SYNC);
 	}
 
+	evals = (zbx_func_eval_t *)zbx_malloc(NULL, sizeof(zbx_func_eval_t) * (size_t)funcs->num_data);
+
 	zbx_hashset_iter_reset(funcs, &iter);
 	while (NULL != (func = (zbx_func_t *)zbx_hashset_iter_next(&iter)))
 	{
-		int				errcode, ret;
+		int				errcode;
 		const zbx_history_sync_item_t	*item;
-		char				*params;
-		zbx_dc_evaluate_item_t		evaluate_item;
 
 		/* avoid double copying from configuration cache if already retrieved when saving history */
 		if (FAIL != (i = zbx_vector_uint64_bsearch(history_itemids, func->itemid,
@@ -359,7 +370,45 @@ static void	evaluate_item_functions(zbx_hashset_t *funcs, const zbx_vector_uint6
 			continue;
 		}
 
-		params = zbx_dc_expand_user_macros_in_func_params(func->parameter, item->host.hostid);
+		evals[evals_num].func = func;
+		evals[evals_num].item = item;
+		evals[evals_num++].params = zbx_dc_expand_user_macros_in_func_params(func->parameter,
+				item->host.hostid);
+	}
+
+	/* read history of items missing from value cache in batches rather than one by one during evaluation */
+	zbx_vector_vc_request_create(&requests);
+	zbx_vector_vc_request_reserve(&requests, (size_t)evals_num);
+
+	for (i = 0; i < evals_num; i++)
+	{
+		zbx_vc_request_t	request;
+
+		func = evals[i].func;
+
+		if (ZBX_FUNCTION_TYPE_HISTORY != func->type || 0 == func->timespec.sec)
+			continue;
+
+		if (SUCCEED != zbx_evaluate_function_history_range(func->function, evals[i].params, &func->timespec,
+				&request.seconds, &request.count, &request.ts))
+		{
+			continue;
+		}
+
+		request.itemid = evals[i].item->itemid;
+		request.value_type = evals[i].item->value_type;
+		zbx_vector_vc_request_append(&requests, request);
+	}
+
+	zbx_vc_prefetch_values(&requests);
+	zbx_vector_vc_request_destroy(&requests);
+
+	for (i = 0; i < evals_num; i++)
+	{
+		const zbx_history_sync_item_t	*item = evals[i].item;
+		zbx_dc_evaluate_item_t		evaluate_item;
+
+		func = evals[i].func;
 
 		evaluate_item.itemid = item->itemid;
 		evaluate_item.value_type = item->value_type;
@@ -367,20 +416,21 @@ static void	evaluate_item_functions(zbx_hashset_t *funcs, const zbx_vector_uint6
 		evaluate_item.host = item->host.host;
 		evaluate_item.key_orig = item->key_orig;
 
-		ret = zbx_evaluate_function(&func->value, &evaluate_item, func->function, params, &func->timespec, &error);
-
-		if (SUCCEED != ret)
+		if (SUCCEED != zbx_evaluate_function(&func->value, &evaluate_item, func->function, evals[i].params,
+				&func->timespec, &error))
 		{
 			/* compose and store error message for future use */
 			zbx_variant_set_error(&func->value,
 					zbx_eval_format_function_error(func->function, item->host.host,
-							item->key_orig, params, error));
+							item->key_orig, evals[i].params, error));
 			zbx_free(error);
 		}
 
-		zbx_free(params);
+		zbx_free(evals[i].params);
 	}
 
+	zbx_free(evals);
+
 	zbx_vc_flush_stats();
 	zbx_vector_uint64_destroy(&itemids);
 
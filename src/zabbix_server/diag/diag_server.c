@@ -88,6 +88,7 @@ static void	diag_valuecache_add_items(struct zbx_json *json, const char *field,
 #define ZBX_DIAG_VALUECACHE_VALUES		0x00000002
 #define ZBX_DIAG_VALUECACHE_MODE		0x00000004
 #define ZBX_DIAG_VALUECACHE_MEMORY		0x00000008
+#define ZBX_DIAG_VALUECACHE_SNAPSHOT		0x00000010
 
 #define ZBX_DIAG_VALUECACHE_SIMPLE	(ZBX_DIAG_VALUECACHE_ITEMS | \
 					ZBX_DIAG_VALUECACHE_VALUES | \
@@ -112,11 +113,13 @@ static int	diag_add_valuecache_info(const struct zbx_json_parse *jp, struct zbx_
 	double				time1, time2, time_total = 0;
 	zbx_uint64_t			fields;
 	zbx_diag_map_t			field_map[] = {
-							{"", ZBX_DIAG_VALUECACHE_SIMPLE | ZBX_DIAG_VALUECACHE_MEMORY},
+							{"", ZBX_DIAG_VALUECACHE_SIMPLE | ZBX_DIAG_VALUECACHE_MEMORY |
+									ZBX_DIAG_VALUECACHE_SNAPSHOT},
 							{"items", ZBX_DIAG_VALUECACHE_ITEMS},
 							{"values", ZBX_DIAG_VALUECACHE_VALUES},
 							{"mode", ZBX_DIAG_VALUECACHE_MODE},
 							{"memory", ZBX_DIAG_VALUECACHE_MEMORY},
+							{"snapshot", ZBX_DIAG_VALUECACHE_SNAPSHOT},
 							{NULL, 0}
 						};
 
@@ -156,6 +159,24 @@ static int	diag_add_valuecache_info(const struct zbx_json_parse *jp, struct zbx_
 			zbx_diag_add_mem_stats(json, "memory", &mem);
 		}
 
+		if (0 != (fields & ZBX_DIAG_VALUECACHE_SNAPSHOT))
+		{
+			zbx_vc_snapshot_stats_t	stats;
+
+			time1 = zbx_time();
+			zbx_vc_get_snapshot_stats(&stats);
+			time2 = zbx_time();
+			time_total += time2 - time1;
+
+			zbx_json_addobject(json, "snapshot");
+			zbx_json_adduint64(json, "items", stats.items);
+			zbx_json_adduint64(json, "values", stats.values);
+			zbx_json_adduint64(json, "gap_values", stats.gap_values);
+			zbx_json_adduint64(json, "discarded", stats.discarded);
+			zbx_json_addfloat(json, "time", stats.time);
+			zbx_json_close(json);
+		}
+
 		if (0 != tops.values_num)
 		{
 			zbx_vector_vc_item_stats_ptr_t	items;
@@ -215,6 +236,7 @@ out:
 #undef ZBX_DIAG_VALUECACHE_VALUES
 #undef ZBX_DIAG_VALUECACHE_MODE
 #undef ZBX_DIAG_VALUECACHE_MEMORY
+#undef ZBX_DIAG_VALUECACHE_SNAPSHOT
 
 /******************************************************************************
  *                                                                            *
@@ -84,6 +84,9 @@ int	lld_item_prototype_compare_func(const void *d1, const void *d2)
  ******************************************************************************/
 static void	lld_condition_free(lld_condition_t *condition)
 {
+	if (NULL != condition->regexp_set)
+		zbx_regexp_set_free(condition->regexp_set);
+
 	zbx_regexp_clean_expressions(&condition->regexps);
 	zbx_vector_expression_destroy(&condition->regexps);
 
@@ -146,6 +149,7 @@ static int	lld_filter_condition_add(zbx_vector_lld_condition_ptr_t *conditions,
 	condition->macro = zbx_strdup(NULL, macro);
 	condition->regexp = zbx_strdup(NULL, regexp);
 	condition->op = (unsigned char)atoi(op);
+	condition->regexp_set = NULL;
 
 	zbx_vector_expression_create(&condition->regexps);
 
@@ -168,6 +172,8 @@ static int	lld_filter_condition_add(zbx_vector_lld_condition_ptr_t *conditions,
 				&condition->regexp, ZBX_MACRO_TYPE_LLD_FILTER, NULL, 0);
 	}
 
+	condition->regexp_set = zbx_regexp_set_create(&condition->regexps, condition->regexp, ZBX_CASE_SENSITIVE);
+
 	return SUCCEED;
 }
 
@@ -238,7 +244,7 @@ static int	filter_condition_match(const zbx_lld_entry_t *lld_obj, const lld_cond
 		}
 		else
 		{
-			switch (zbx_regexp_match_ex(&condition->regexps, value, condition->regexp, ZBX_CASE_SENSITIVE))
+			switch (zbx_regexp_set_match(condition->regexp_set, value))
 			{
 				case ZBX_REGEXP_MATCH:
 					*result = (ZBX_CONDITION_OPERATOR_REGEXP == condition->op ? 1 : 0);
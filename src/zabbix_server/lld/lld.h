@@ -58,6 +58,7 @@ typedef struct
 	char			*macro;
 	char			*regexp;
 	zbx_vector_expression_t	regexps;
+	zbx_regexp_set_t	*regexp_set;
 	unsigned char		op;
 }
 lld_condition_t;
@@ -88,8 +89,8 @@ zbx_id_name_pair_t;
 
 typedef struct
 {
-	char	*lld_macro;
-	char	*path;
+	char		*lld_macro;
+	zbx_jsonpath_t	path;	/* compiled once to be queried for every LLD row */
 }
 zbx_lld_macro_path_t;
 
@@ -97,10 +97,10 @@ static void	lld_entry_create(zbx_lld_entry_t *entry, const zbx_jsonobj_t *obj,
 	for (int i = 0; i < lld_macro_paths->values_num; i++)
 	{
 		zbx_lld_macro_t			lld_macro;
-		const zbx_lld_macro_path_t	*macro_path = lld_macro_paths->values[i];
+		zbx_lld_macro_path_t		*macro_path = lld_macro_paths->values[i];
 		char				*value = NULL;
 
-		if (SUCCEED != zbx_jsonobj_query(obj, macro_path->path, &value) || NULL == value)
+		if (SUCCEED != zbx_jsonobj_query_path(obj, &macro_path->path, &value) || NULL == value)
 			continue;
 
 		lld_macro.macro = zbx_strdup(NULL, macro_path->lld_macro);
@@ -75,11 +75,9 @@ int	zbx_lld_macro_paths_get(zbx_uint64_t lld_ruleid, zbx_vector_lld_macro_path_p
 			break;
 		}
 
-		zbx_jsonpath_clear(&path);
-
 		lld_macro_path = (zbx_lld_macro_path_t *)zbx_malloc(NULL, sizeof(zbx_lld_macro_path_t));
 		lld_macro_path->lld_macro = zbx_strdup(NULL, row[0]);
-		lld_macro_path->path = zbx_strdup(NULL, row[1]);
+		lld_macro_path->path = path;
 
 		zbx_vector_lld_macro_path_ptr_append(lld_macro_paths, lld_macro_path);
 	}
@@ -101,7 +99,7 @@ int	zbx_lld_macro_paths_get(zbx_uint64_t lld_ruleid, zbx_vector_lld_macro_path_p
  ******************************************************************************/
 void	zbx_lld_macro_path_free(zbx_lld_macro_path_t *lld_macro_path)
 {
-	zbx_free(lld_macro_path->path);
+	zbx_jsonpath_clear(&lld_macro_path->path);
 	zbx_free(lld_macro_path->lld_macro);
 	zbx_free(lld_macro_path);
 }
@@ -73,6 +73,7 @@
 #include "zbxconnector.h"
 #include "zbxcachevalue.h"
 #include "zbxcachehistory.h"
+#include "zbxshmem.h"
 #include "zbxhistory.h"
 #include "zbxvault.h"
 #include "zbxtrends.h"
@@ -98,6 +99,8 @@
 #include "zbxpoller.h"
 #include "zbxhttppoller.h"
 #include "zbx_ha_constants.h"
+#include "zbx_item_constants.h"
+#include "zbx_host_constants.h"
 #include "zbxescalations.h"
 #include "zbxbincommon.h"
 
@@ -321,10 +324,17 @@ static int	config_vmware_timeout		= 10;
 static zbx_uint64_t	config_conf_cache_size		= 32 * ZBX_MEBIBYTE;
 static zbx_uint64_t	config_history_cache_size	= 16 * ZBX_MEBIBYTE;
 static zbx_uint64_t	config_history_index_cache_size	= 4 * ZBX_MEBIBYTE;
+static char		*config_history_cache_spill_dir	= NULL;
+static zbx_uint64_t	config_history_cache_spill_size	= 256 * ZBX_MEBIBYTE;
 static zbx_uint64_t	config_trends_cache_size	= 4 * ZBX_MEBIBYTE;
 static zbx_uint64_t	config_trend_func_cache_size	= 4 * ZBX_MEBIBYTE;
 static zbx_uint64_t	config_value_cache_size		= 8 * ZBX_MEBIBYTE;
+static char		*config_value_cache_snapshot_file	= NULL;
 static zbx_uint64_t	config_vmware_cache_size	= 8 * ZBX_MEBIBYTE;
+static zbx_uint64_t	config_huge_page_size		= 0;
+static zbx_uint64_t	config_preprocessing_ring_size	= 0;
+static char		*config_preprocessing_capture_file	= NULL;
+static int		config_preprocessing_capture_sample	= 1;
 
 static int	config_unreachable_period		= 45;
 static int	config_unreachable_delay		= 15;
@@ -744,6 +754,20 @@ static void	zbx_validate_config(ZBX_TASK_EX *task)
 		err = 1;
 	}
 
+	if (0 != config_huge_page_size && 2 * ZBX_MEBIBYTE != config_huge_page_size &&
+			ZBX_GIBIBYTE != config_huge_page_size)
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "\"HugePageSize\" configuration parameter must be 0, 2M or 1G");
+		err = 1;
+	}
+
+	if (0 != config_preprocessing_ring_size && 64 * ZBX_KIBIBYTE > config_preprocessing_ring_size)
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "\"PreprocessingRingSize\" configuration parameter must be 0 or at least"
+				" 64K");
+		err = 1;
+	}
+
 	if (NULL != zbx_config_source_ip && SUCCEED != zbx_is_supported_ip(zbx_config_source_ip))
 	{
 		zabbix_log(LOG_LEVEL_CRIT, "invalid \"SourceIP\" configuration parameter: '%s'", zbx_config_source_ip);
@@ -917,12 +941,20 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 				ZBX_CONF_PARM_OPT,	128 * ZBX_KIBIBYTE,	__UINT64_C(2) * ZBX_GIBIBYTE},
 		{"HistoryIndexCacheSize",	&config_history_index_cache_size,	ZBX_CFG_TYPE_UINT64,
 				ZBX_CONF_PARM_OPT,	128 * ZBX_KIBIBYTE,	__UINT64_C(2) * ZBX_GIBIBYTE},
+		{"HistoryCacheSpillDir",	&config_history_cache_spill_dir,	ZBX_CFG_TYPE_STRING,
+				ZBX_CONF_PARM_OPT,	0,			0},
+		{"HistoryCacheSpillSize",	&config_history_cache_spill_size,	ZBX_CFG_TYPE_UINT64,
+				ZBX_CONF_PARM_OPT,	64 * ZBX_MEBIBYTE,	__UINT64_C(64) * ZBX_GIBIBYTE},
 		{"TrendCacheSize",		&config_trends_cache_size,		ZBX_CFG_TYPE_UINT64,
 				ZBX_CONF_PARM_OPT,	128 * ZBX_KIBIBYTE,	__UINT64_C(2) * ZBX_GIBIBYTE},
 		{"TrendFunctionCacheSize",	&config_trend_func_cache_size,		ZBX_CFG_TYPE_UINT64,
 				ZBX_CONF_PARM_OPT,	0,			__UINT64_C(2) * ZBX_GIBIBYTE},
 		{"ValueCacheSize",		&config_value_cache_size,		ZBX_CFG_TYPE_UINT64,
 				ZBX_CONF_PARM_OPT,	0,			__UINT64_C(64) * ZBX_GIBIBYTE},
+		{"ValueCacheSnapshotFile",	&config_value_cache_snapshot_file,	ZBX_CFG_TYPE_STRING,
+				ZBX_CONF_PARM_OPT,	0,			0},
+		{"HugePageSize",		&config_huge_page_size,			ZBX_CFG_TYPE_UINT64,
+				ZBX_CONF_PARM_OPT,	0,			ZBX_GIBIBYTE},
 		{"CacheUpdateFrequency",	&config_confsyncer_frequency,		ZBX_CFG_TYPE_INT,
 				ZBX_CONF_PARM_OPT,	1,			SEC_PER_HOUR},
 		{"HousekeepingFrequency",	&config_housekeeping_frequency,		ZBX_CFG_TYPE_INT,
@@ -1018,6 +1050,10 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 				ZBX_CONF_PARM_OPT,	0,			0},
 		{"LogSlowQueries",		&(zbx_db_config->log_slow_queries),	ZBX_CFG_TYPE_INT,
 				ZBX_CONF_PARM_OPT,	0,			3600000},
+		{"DBPipelining",		&(zbx_db_config->pipelining),		ZBX_CFG_TYPE_INT,
+				ZBX_CONF_PARM_OPT,	0,			1},
+		{"DBPreparedStatements",	&(zbx_db_config->prepared_statements),	ZBX_CFG_TYPE_INT,
+				ZBX_CONF_PARM_OPT,	0,			1},
 		{"StartProxyPollers",		&config_forks[ZBX_PROCESS_TYPE_PROXYPOLLER],
 											ZBX_CFG_TYPE_INT,
 				ZBX_CONF_PARM_OPT,	0,			250},
@@ -1077,6 +1113,12 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 		{"StartPreprocessors",		&config_forks[ZBX_PROCESS_TYPE_PREPROCESSOR],
 											ZBX_CFG_TYPE_INT,
 				ZBX_CONF_PARM_OPT,	1,			1000},
+		{"PreprocessingRingSize",	&config_preprocessing_ring_size,	ZBX_CFG_TYPE_UINT64,
+				ZBX_CONF_PARM_OPT,	0,			ZBX_GIBIBYTE},
+		{"PreprocessingCaptureFile",	&config_preprocessing_capture_file,	ZBX_CFG_TYPE_STRING,
+				ZBX_CONF_PARM_OPT,	0,			0},
+		{"PreprocessingCaptureSample",	&config_preprocessing_capture_sample,	ZBX_CFG_TYPE_INT,
+				ZBX_CONF_PARM_OPT,	1,			1000000},
 		{"HistoryStorageURL",		&config_history_storage_url,		ZBX_CFG_TYPE_STRING,
 				ZBX_CONF_PARM_OPT,	0,			0},
 		{"HistoryStorageTypes",		&config_history_storage_opts,		ZBX_CFG_TYPE_STRING_LIST,
@@ -1214,6 +1256,15 @@ static void	zbx_on_exit(int ret, void *on_exit_args)
 
 		zbx_free_configuration_cache();
 
+		if (NULL != config_value_cache_snapshot_file)
+		{
+			if (SUCCEED != zbx_vc_snapshot_save(config_value_cache_snapshot_file, &error))
+			{
+				zabbix_log(LOG_LEVEL_WARNING, "cannot save value cache snapshot: %s", error);
+				zbx_free(error);
+			}
+		}
+
 		/* free history value cache */
 		zbx_vc_destroy();
 
@@ -1518,6 +1569,32 @@ static void	zbx_db_save_server_status(void)
 	zbx_json_free(&json);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if value cache snapshot item matches current configuration *
+ *                                                                            *
+ * Return value: SUCCEED - the item is monitored and has the same value type  *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	server_vc_check_snapshot_item(zbx_uint64_t itemid, unsigned char value_type)
+{
+	zbx_history_sync_item_t	item;
+	int			errcode, ret = FAIL;
+
+	zbx_dc_config_history_sync_get_items_by_itemids(&item, &itemid, &errcode, 1, ZBX_ITEM_GET_SYNC);
+
+	if (SUCCEED == errcode && item.value_type == value_type && ITEM_STATUS_ACTIVE == item.status &&
+			HOST_STATUS_MONITORED == item.host.status)
+	{
+		ret = SUCCEED;
+	}
+
+	zbx_dc_config_clean_history_sync_items(&item, &errcode, 1);
+
+	return ret;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: initialize shared resources and start processes                   *
@@ -1617,8 +1694,13 @@ static int	server_startup(zbx_socket_t *listen_sock, int *ha_stat, int *ha_failo
 								.config_service_manager_sync_frequency =
 								config_service_manager_sync_frequency};
 
+	zbx_shmem_set_huge_page_size(config_huge_page_size);
+	zbx_preprocessor_set_ring_size(config_preprocessing_ring_size);
+	zbx_preprocessor_set_capture(config_preprocessing_capture_file, config_preprocessing_capture_sample);
+
 	if (SUCCEED != zbx_init_database_cache(get_zbx_program_type, zbx_sync_server_history, config_history_cache_size,
-			config_history_index_cache_size, &config_trends_cache_size, &error))
+			config_history_index_cache_size, &config_trends_cache_size, config_history_cache_spill_dir,
+			config_history_cache_spill_size, &error))
 	{
 		zabbix_log(LOG_LEVEL_CRIT, "cannot initialize database cache: %s", error);
 		zbx_free(error);
@@ -1767,6 +1849,13 @@ static int	server_startup(zbx_socket_t *listen_sock, int *ha_stat, int *ha_failo
 				/* update maintenance states */
 				zbx_dc_update_maintenances(MAINTENANCE_TIMER_PENDING);
 
+				if (NULL != config_value_cache_snapshot_file && SUCCEED != zbx_vc_snapshot_load(
+						config_value_cache_snapshot_file, server_vc_check_snapshot_item, &error))
+				{
+					zabbix_log(LOG_LEVEL_WARNING, "cannot load value cache snapshot: %s", error);
+					zbx_free(error);
+				}
+
 				zbx_db_close();
 				break;
 			case ZBX_PROCESS_TYPE_POLLER:
@@ -2284,7 +2373,8 @@ int	MAIN_ZABBIX_ENTRY(int flags)
 	}
 
 	if (SUCCEED != zbx_init_database_cache(get_zbx_program_type, zbx_sync_server_history, config_history_cache_size,
-			config_history_index_cache_size, &config_trends_cache_size, &error))
+			config_history_index_cache_size, &config_trends_cache_size, config_history_cache_spill_dir,
+			config_history_cache_spill_size, &error))
 	{
 		zabbix_log(LOG_LEVEL_CRIT, "cannot initialize database cache: %s", error);
 		zbx_free(error);
@@ -86,6 +86,9 @@ AC_DEFUN([CONF_TESTS],
 			tests/libs/zbxxml/Makefile
 			tests/libs/zbxodbc/Makefile
 			tests/libs/zbxip/Makefile
+			tests/libs/zbxipcservice/Makefile
+			tests/libs/zbxshmem/Makefile
+			tests/libs/zbxcachehistory/Makefile
 			tests/zabbix_server/Makefile
 			tests/zabbix_server/pinger/Makefile
 			tests/zabbix_server/service/Makefile
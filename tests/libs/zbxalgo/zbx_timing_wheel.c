@@ -0,0 +1,155 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxalgo.h"
+
+#define MOCK_NOT_SCHEDULED	-1
+
+static zbx_uint64_t	mock_random_next(zbx_uint64_t *seed)
+{
+	*seed = *seed * __UINT64_C(6364136223846793005) + __UINT64_C(1442695040888963407);
+
+	return *seed >> 33;
+}
+
+static int	mock_timing_wheel_compare(const void *d1, const void *d2)
+{
+	const zbx_timing_wheel_elem_t	*e1 = (const zbx_timing_wheel_elem_t *)d1;
+	const zbx_timing_wheel_elem_t	*e2 = (const zbx_timing_wheel_elem_t *)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(e1->time, e2->time);
+	ZBX_RETURN_IF_NOT_EQUAL(e1->key, e2->key);
+
+	return 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: finds the earliest element in reference array, elements with     *
+ *          the same time are ordered by key                                  *
+ *                                                                            *
+ ******************************************************************************/
+static int	mock_reference_min(const int *times, int times_num, zbx_uint64_t *key)
+{
+	int	min = -1;
+
+	for (int i = 0; i < times_num; i++)
+	{
+		if (MOCK_NOT_SCHEDULED == times[i])
+			continue;
+
+		if (-1 == min || times[i] < times[min])
+			min = i;
+	}
+
+	if (-1 == min)
+		return FAIL;
+
+	*key = (zbx_uint64_t)min;
+
+	return times[min];
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_timing_wheel_t	wheel;
+	zbx_timing_wheel_elem_t	elem, *min;
+	zbx_uint64_t		seed, key;
+	int			keys_num, ops_num, range, *times, now = 1700000000, elems_num = 0, time;
+
+	ZBX_UNUSED(state);
+
+	keys_num = (int)zbx_mock_get_parameter_uint64("in.keys");
+	range = (int)zbx_mock_get_parameter_uint64("in.range");
+	ops_num = (int)zbx_mock_get_parameter_uint64("in.operations");
+	seed = zbx_mock_get_parameter_uint64("in.seed");
+
+	times = (int *)zbx_malloc(NULL, sizeof(int) * (size_t)keys_num);
+
+	for (int i = 0; i < keys_num; i++)
+		times[i] = MOCK_NOT_SCHEDULED;
+
+	zbx_timing_wheel_create(&wheel, mock_timing_wheel_compare);
+
+	for (int i = 0; i < ops_num; i++)
+	{
+		elem.key = mock_random_next(&seed) % (zbx_uint64_t)keys_num;
+		elem.data = NULL;
+
+		/* schedule some elements before the current time */
+		elem.time = now + (int)(mock_random_next(&seed) % (zbx_uint64_t)range) - range / 10;
+
+		switch (mock_random_next(&seed) % 8)
+		{
+			case 0:
+			case 1:
+			case 2:
+				if (MOCK_NOT_SCHEDULED == times[elem.key])
+				{
+					zbx_timing_wheel_insert(&wheel, &elem);
+					elems_num++;
+				}
+				else
+					zbx_timing_wheel_update_direct(&wheel, &elem);
+
+				times[elem.key] = elem.time;
+				break;
+			case 3:
+				if (MOCK_NOT_SCHEDULED != times[elem.key])
+				{
+					zbx_timing_wheel_remove_direct(&wheel, elem.key);
+					times[elem.key] = MOCK_NOT_SCHEDULED;
+					elems_num--;
+				}
+				break;
+			default:
+				time = mock_reference_min(times, keys_num, &key);
+				zbx_mock_assert_int_eq("minimum time", time, zbx_timing_wheel_min_time(&wheel));
+
+				if (FAIL == time)
+				{
+					zbx_mock_assert_int_eq("empty wheel", SUCCEED, zbx_timing_wheel_empty(&wheel));
+					break;
+				}
+
+				min = zbx_timing_wheel_find_min(&wheel);
+				zbx_mock_assert_uint64_eq("minimum key", key, min->key);
+				zbx_mock_assert_int_eq("minimum element time", time, min->time);
+
+				if (time <= now)
+				{
+					zbx_timing_wheel_remove_min(&wheel);
+					times[key] = MOCK_NOT_SCHEDULED;
+					elems_num--;
+				}
+				else
+					now = time;
+				break;
+		}
+
+		zbx_mock_assert_int_eq("elements", elems_num, wheel.elems_num);
+	}
+
+	zbx_timing_wheel_clear(&wheel);
+	zbx_mock_assert_int_eq("cleared wheel", SUCCEED, zbx_timing_wheel_empty(&wheel));
+	zbx_mock_assert_int_eq("cleared wheel minimum time", FAIL, zbx_timing_wheel_min_time(&wheel));
+
+	zbx_timing_wheel_destroy(&wheel);
+	zbx_free(times);
+}
@@ -0,0 +1,239 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockutil.h"
+#include "zbxmockassert.h"
+
+#include "zbxmutexs.h"
+#include "zbxalgo.h"
+#include "../../../src/libs/zbxcachehistory/cachehistory_spill.h"
+
+#define SPILL_TEST_NAME	"hc_spill.journal"
+
+int	__real_open(const char *path, int oflag, ...);
+
+/* the journal is mapped from real file */
+static int	spill_test_open(const char *path, int oflag, int mode)
+{
+	return __real_open(path, oflag, mode);
+}
+
+typedef struct
+{
+	char			dir[32];
+
+	/* sizes of appended records, indexed by record sequence number */
+	zbx_vector_uint32_t	sizes;
+	int			read_num;
+}
+zbx_spill_test_t;
+
+static unsigned char	spill_test_byte(zbx_uint32_t seq, zbx_uint32_t i)
+{
+	return (unsigned char)(seq * 31 + i);
+}
+
+static void	spill_test_open_journal(zbx_spill_test_t *st, zbx_mock_handle_t hstep)
+{
+	char	*error = NULL;
+
+	if (SUCCEED != hc_spill_init(st->dir, SPILL_TEST_NAME, zbx_mock_get_object_member_uint64(hstep, "size"),
+			(zbx_uint32_t)zbx_mock_get_object_member_int(hstep, "format"), &error))
+	{
+		fail_msg("cannot open spill journal: %s", error);
+	}
+}
+
+static void	spill_test_append(zbx_spill_test_t *st, zbx_mock_handle_t hstep)
+{
+	int		i, records_num, expected_ret, ret;
+	zbx_uint32_t	size, j;
+	unsigned char	*data;
+
+	records_num = zbx_mock_get_object_member_int(hstep, "records");
+	size = (zbx_uint32_t)zbx_mock_get_object_member_int(hstep, "size");
+	expected_ret = zbx_mock_str_to_return_code(zbx_mock_get_object_member_string(hstep, "return"));
+
+	data = (unsigned char *)zbx_malloc(NULL, size);
+
+	for (i = 0; i < records_num; i++)
+	{
+		zbx_uint32_t	seq = (zbx_uint32_t)st->sizes.values_num;
+
+		memcpy(data, &seq, sizeof(seq));
+
+		for (j = sizeof(seq); j < size; j++)
+			data[j] = spill_test_byte(seq, j);
+
+		hc_spill_lock();
+		ret = hc_spill_append(data, size, 0);
+		hc_spill_unlock();
+
+		zbx_mock_assert_result_eq("hc_spill_append()", expected_ret, ret);
+
+		if (SUCCEED == ret)
+			zbx_vector_uint32_append(&st->sizes, size);
+	}
+
+	zbx_free(data);
+}
+
+static void	spill_test_check_record(zbx_spill_test_t *st, const void *data, zbx_uint32_t size)
+{
+	const unsigned char	*bytes = (const unsigned char *)data;
+	zbx_uint32_t		seq, j;
+
+	if (st->read_num >= st->sizes.values_num)
+		fail_msg("unexpected record %d in spill journal", st->read_num);
+
+	zbx_mock_assert_uint64_eq("record size", st->sizes.values[st->read_num], size);
+
+	memcpy(&seq, data, sizeof(seq));
+	zbx_mock_assert_int_eq("record sequence number", st->read_num, (int)seq);
+
+	for (j = sizeof(seq); j < size; j++)
+	{
+		if (spill_test_byte(seq, j) != bytes[j])
+			fail_msg("record %u contents differ at offset %u", seq, j);
+	}
+}
+
+static void	spill_test_read(zbx_spill_test_t *st, zbx_mock_handle_t hstep)
+{
+	int		i, records_num;
+	const void	*data, *data_peeked;
+	zbx_uint32_t	size, size_peeked;
+
+	records_num = zbx_mock_get_object_member_int(hstep, "records");
+
+	hc_spill_lock();
+
+	for (i = 0; i < records_num; i++)
+	{
+		zbx_mock_assert_result_eq("hc_spill_peek()", SUCCEED, hc_spill_peek(&data, &size));
+
+		/* peeking again must return the same record */
+		zbx_mock_assert_result_eq("hc_spill_peek()", SUCCEED, hc_spill_peek(&data_peeked, &size_peeked));
+		zbx_mock_assert_ptr_eq("peeked record", data, data_peeked);
+
+		spill_test_check_record(st, data, size);
+
+		hc_spill_pop();
+		st->read_num++;
+	}
+
+	hc_spill_unlock();
+}
+
+static void	spill_test_check(zbx_spill_test_t *st, zbx_mock_handle_t hstep)
+{
+	zbx_hc_spill_stats_t	stats;
+	zbx_mock_handle_t	hvalue;
+	const void		*data;
+	zbx_uint32_t		size;
+
+	hc_spill_get_stats(&stats);
+
+	zbx_mock_assert_uint64_eq("journal records", zbx_mock_get_object_member_uint64(hstep, "records"),
+			stats.records_num);
+	zbx_mock_assert_uint64_eq("hc_spill_get_records_num()", stats.records_num, hc_spill_get_records_num());
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hstep, "used", &hvalue))
+	{
+		zbx_mock_assert_uint64_eq("journal used size", zbx_mock_get_object_member_uint64(hstep, "used"),
+				stats.used);
+	}
+
+	if (0 == stats.records_num)
+	{
+		hc_spill_lock();
+		zbx_mock_assert_result_eq("hc_spill_peek()", FAIL, hc_spill_peek(&data, &size));
+		hc_spill_unlock();
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: closes and opens journal again, the records left in journal are   *
+ *          expected to be discarded if journal size or format changes        *
+ *                                                                            *
+ ******************************************************************************/
+static void	spill_test_reopen(zbx_spill_test_t *st, zbx_mock_handle_t hstep)
+{
+	hc_spill_destroy();
+	spill_test_open_journal(st, hstep);
+
+	if (0 == hc_spill_get_records_num())
+		st->read_num = st->sizes.values_num;
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_spill_test_t	st;
+	zbx_mock_handle_t	hsteps, hstep;
+	zbx_mock_error_t	err;
+	char			*error = NULL, path[MAX_STRING_LEN];
+
+	ZBX_UNUSED(state);
+
+	if (SUCCEED != zbx_locks_create(&error))
+		fail_msg("cannot create locks: %s", error);
+
+	zbx_strlcpy(st.dir, "/tmp/zbx_hc_spill_XXXXXX", sizeof(st.dir));
+
+	if (NULL == mkdtemp(st.dir))
+		fail_msg("cannot create journal directory: %s", zbx_strerror(errno));
+
+	zbx_set_open_mock_callback(spill_test_open);
+
+	zbx_vector_uint32_create(&st.sizes);
+	st.read_num = 0;
+
+	spill_test_open_journal(&st, zbx_mock_get_parameter_handle("in.journal"));
+
+	hsteps = zbx_mock_get_parameter_handle("in.steps");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = zbx_mock_vector_element(hsteps, &hstep)))
+	{
+		const char	*op;
+
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("cannot read step: %s", zbx_mock_error_string(err));
+
+		op = zbx_mock_get_object_member_string(hstep, "op");
+
+		if (0 == strcmp(op, "append"))
+			spill_test_append(&st, hstep);
+		else if (0 == strcmp(op, "read"))
+			spill_test_read(&st, hstep);
+		else if (0 == strcmp(op, "check"))
+			spill_test_check(&st, hstep);
+		else if (0 == strcmp(op, "reopen"))
+			spill_test_reopen(&st, hstep);
+		else
+			fail_msg("unknown step operation \"%s\"", op);
+	}
+
+	hc_spill_destroy();
+
+	zbx_set_open_mock_callback(NULL);
+
+	zbx_snprintf(path, sizeof(path), "%s/%s", st.dir, SPILL_TEST_NAME);
+	unlink(path);
+	rmdir(st.dir);
+
+	zbx_vector_uint32_destroy(&st.sizes);
+}
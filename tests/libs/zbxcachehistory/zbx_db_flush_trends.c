@@ -0,0 +1,180 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockutil.h"
+#include "zbxmockassert.h"
+
+#include "zbxcachehistory.h"
+#include "zbxalgo.h"
+
+static char		*flush_sql, itemid_str[MAX_ID_LEN + 1], *fetch_row[] = {itemid_str};
+static time_t		now;
+static ZBX_DC_TREND	*trends;
+static int		trends_num, fetch_num;
+
+time_t	__wrap_time(time_t *ptr);
+zbx_db_result_t	__wrap_zbx_db_select(const char *fmt, ...);
+zbx_db_row_t	__wrap_zbx_db_fetch(zbx_db_result_t result);
+void	__wrap_zbx_db_free_result(zbx_db_result_t result);
+int	__wrap_zbx_db_execute_overflowed_sql(char **sql, size_t *sql_alloc, size_t *sql_offset);
+int	__wrap_zbx_db_flush_overflowed_sql(char *sql, size_t sql_offset);
+
+time_t	__wrap_time(time_t *ptr)
+{
+	if (NULL != ptr)
+		*ptr = now;
+
+	return now;
+}
+
+/* trends of all items exist in database at the flushed hour, so all of them are merged */
+zbx_db_result_t	__wrap_zbx_db_select(const char *fmt, ...)
+{
+	ZBX_UNUSED(fmt);
+
+	fetch_num = 0;
+
+	return (zbx_db_result_t)&fetch_num;
+}
+
+zbx_db_row_t	__wrap_zbx_db_fetch(zbx_db_result_t result)
+{
+	ZBX_UNUSED(result);
+
+	if (fetch_num == trends_num)
+		return NULL;
+
+	zbx_snprintf(itemid_str, sizeof(itemid_str), ZBX_FS_UI64, trends[fetch_num++].itemid);
+
+	return fetch_row;
+}
+
+void	__wrap_zbx_db_free_result(zbx_db_result_t result)
+{
+	ZBX_UNUSED(result);
+}
+
+/* statements are accumulated and checked when flushed */
+int	__wrap_zbx_db_execute_overflowed_sql(char **sql, size_t *sql_alloc, size_t *sql_offset)
+{
+	ZBX_UNUSED(sql);
+	ZBX_UNUSED(sql_alloc);
+	ZBX_UNUSED(sql_offset);
+
+	return SUCCEED;
+}
+
+int	__wrap_zbx_db_flush_overflowed_sql(char *sql, size_t sql_offset)
+{
+	zbx_free(flush_sql);
+	flush_sql = zbx_malloc(NULL, sql_offset + 1);
+	memcpy(flush_sql, sql, sql_offset);
+	flush_sql[sql_offset] = '\0';
+
+	return SUCCEED;
+}
+
+static void	str_to_uint128(const char *str, zbx_uint128_t *value)
+{
+	value->hi = 0;
+	value->lo = 0;
+
+	for (; '\0' != *str; str++)
+	{
+		zbx_uint128_t	result;
+
+		if (0 == isdigit((unsigned char)*str))
+			fail_msg("invalid unsigned value \"%s\"", str);
+
+		zbx_umul64_64(&result, value->lo, 10);
+		result.hi += value->hi * 10;
+		zbx_uinc128_64(&result, (zbx_uint64_t)(*str - '0'));
+		*value = result;
+	}
+}
+
+static void	read_trend(zbx_mock_handle_t htrend, unsigned char value_type, int clock, ZBX_DC_TREND *trend)
+{
+	memset(trend, 0, sizeof(ZBX_DC_TREND));
+
+	trend->itemid = zbx_mock_get_object_member_uint64(htrend, "itemid");
+	trend->clock = clock;
+	trend->num = zbx_mock_get_object_member_int(htrend, "num");
+	trend->value_type = value_type;
+
+	if (ITEM_VALUE_TYPE_FLOAT == value_type)
+	{
+		trend->value_min.dbl = zbx_mock_get_object_member_float(htrend, "min");
+		trend->value_avg.dbl = zbx_mock_get_object_member_float(htrend, "avg");
+		trend->value_max.dbl = zbx_mock_get_object_member_float(htrend, "max");
+	}
+	else
+	{
+		trend->value_min.ui64 = zbx_mock_get_object_member_uint64(htrend, "min");
+		str_to_uint128(zbx_mock_get_object_member_string(htrend, "sum"), &trend->value_avg.ui64);
+		trend->value_max.ui64 = zbx_mock_get_object_member_uint64(htrend, "max");
+	}
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+#if defined(HAVE_POSTGRESQL) || defined(HAVE_MYSQL)
+	zbx_mock_handle_t	htrends, htrend;
+	int			clock;
+	unsigned char		value_type;
+	const char		*type;
+#	if defined(HAVE_POSTGRESQL)
+	const char		*sql_path = "out.postgresql";
+#	else
+	const char		*sql_path = "out.mysql";
+#	endif
+
+	ZBX_UNUSED(state);
+
+	clock = zbx_mock_get_parameter_int("in.clock");
+	now = clock + SEC_PER_MIN;
+
+	type = zbx_mock_get_parameter_string("in.value_type");
+
+	if (0 == strcmp(type, "float"))
+		value_type = ITEM_VALUE_TYPE_FLOAT;
+	else if (0 == strcmp(type, "uint"))
+		value_type = ITEM_VALUE_TYPE_UINT64;
+	else
+		fail_msg("unknown value type \"%s\"", type);
+
+	htrends = zbx_mock_get_parameter_handle("in.trends");
+
+	while (ZBX_MOCK_END_OF_VECTOR != zbx_mock_vector_element(htrends, &htrend))
+	{
+		trends = (ZBX_DC_TREND *)zbx_realloc(trends, sizeof(ZBX_DC_TREND) * (size_t)(trends_num + 1));
+		read_trend(htrend, value_type, clock, &trends[trends_num++]);
+	}
+
+	zbx_db_flush_trends(trends, &trends_num, NULL);
+
+	zbx_mock_assert_str_eq("upsert statement", zbx_mock_get_parameter_string(sql_path), flush_sql);
+
+	zbx_mock_assert_int_eq("trends left", 0, trends_num);
+
+	zbx_free(flush_sql);
+	zbx_free(trends);
+#else
+	ZBX_UNUSED(state);
+
+	skip();
+#endif
+}
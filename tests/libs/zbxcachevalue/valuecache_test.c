@@ -25,9 +25,10 @@ void	zbx_vc_set_mode(int mode)
 
 int	zbx_vc_get_cached_values(zbx_uint64_t itemid, unsigned char value_type, zbx_vector_history_record_t *values)
 {
-	zbx_vc_item_t	*item;
-	int		i;
-	zbx_vc_chunk_t	*chunk;
+	zbx_vc_item_t			*item;
+	int				i;
+	zbx_vc_chunk_t			*chunk;
+	const zbx_history_record_t	*slots;
 
 	if (NULL == (item = zbx_hashset_search(&vc_cache->items, &itemid)))
 		return FAIL;
@@ -37,8 +38,10 @@ int	zbx_vc_get_cached_values(zbx_uint64_t itemid, unsigned char value_type, zbx_
 
 	for (chunk = item->tail; NULL != chunk; chunk = chunk->next)
 	{
+		slots = vch_chunk_get_slots(chunk, &vc_unpack_buffer);
+
 		for (i = chunk->first_value; i <= chunk->last_value; i++)
-			vc_history_record_vector_append(values, value_type, &chunk->slots[i]);
+			vc_history_record_vector_append(values, value_type, &slots[i]);
 	}
 
 	return SUCCEED;
@@ -91,6 +94,44 @@ int	zbx_vc_get_item_state(zbx_uint64_t itemid, int *status, int *active_range, i
 	return ret;
 }
 
+int	zbx_vc_test_pack_values(zbx_uint64_t itemid, unsigned char value_type,
+		const zbx_vector_history_record_t *values, zbx_vector_history_record_t *packed_values,
+		zbx_vector_history_record_t *unpacked_values, int *packed)
+{
+	zbx_vc_item_t	*item, item_local = {.itemid = itemid, .value_type = value_type};
+	zbx_vc_chunk_t	*chunk;
+	int		ret = FAIL;
+
+	item = (zbx_vc_item_t *)zbx_hashset_insert(&vc_cache->items, &item_local, sizeof(item_local));
+
+	/* store all values in a single chunk */
+	if (FAIL == vch_item_add_chunk(item, values->values_num, NULL))
+		goto out;
+
+	item->tail->first_value = values->values_num;
+	item->tail->last_value = values->values_num - 1;
+
+	if (FAIL == vch_item_copy_values_at_tail(item, values->values, values->values_num))
+		goto out;
+
+	vch_item_pack_chunk(item, item->tail);
+	*packed = (0 != item->tail->packed_size);
+
+	if (SUCCEED != zbx_vc_get_cached_values(itemid, value_type, packed_values))
+		goto out;
+
+	chunk = item->tail;
+
+	if (0 != chunk->packed_size && NULL == vch_item_unpack_chunk(item, chunk))
+		goto out;
+
+	ret = zbx_vc_get_cached_values(itemid, value_type, unpacked_values);
+out:
+	vc_remove_item(item);
+
+	return ret;
+}
+
 int	zbx_vc_get_cache_state(int *mode, zbx_uint64_t *hits, zbx_uint64_t *misses)
 {
 	if (NULL == vc_cache)
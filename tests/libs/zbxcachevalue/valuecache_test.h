@@ -23,6 +23,9 @@ int	zbx_vc_precache_values(zbx_uint64_t itemid, int value_type, int seconds, int
 int	zbx_vc_get_item_state(zbx_uint64_t itemid, int *status, int *active_range, int *values_total,
 		int *db_cached_from);
 int	zbx_vc_get_cache_state(int *mode, zbx_uint64_t *hits, zbx_uint64_t *misses);
+int	zbx_vc_test_pack_values(zbx_uint64_t itemid, unsigned char value_type,
+		const zbx_vector_history_record_t *values, zbx_vector_history_record_t *packed_values,
+		zbx_vector_history_record_t *unpacked_values, int *packed);
 
 void	zbx_vcmock_set_mode(zbx_mock_handle_t hitem, const char *key);
 int	zbx_vcmock_str_to_cache_mode(const char *mode);
@@ -0,0 +1,175 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxnum.h"
+#include "zbxmutexs.h"
+#include "zbxcachevalue.h"
+#include "valuecache_test.h"
+#include "mocks/valuecache/valuecache_mock.h"
+
+static zbx_vc_aggregate_func_t	vcmock_str_to_aggregate_func(const char *str)
+{
+	if (0 == strcmp(str, "avg"))
+		return ZBX_VC_AGGREGATE_AVG;
+	if (0 == strcmp(str, "sum"))
+		return ZBX_VC_AGGREGATE_SUM;
+	if (0 == strcmp(str, "min"))
+		return ZBX_VC_AGGREGATE_MIN;
+	if (0 == strcmp(str, "max"))
+		return ZBX_VC_AGGREGATE_MAX;
+	if (0 == strcmp(str, "count"))
+		return ZBX_VC_AGGREGATE_COUNT;
+
+	fail_msg("Unknown aggregate function \"%s\"", str);
+
+	return ZBX_VC_AGGREGATE_COUNT;
+}
+
+static void	vcmock_check_aggregate(zbx_mock_handle_t hout, unsigned char value_type,
+		zbx_vc_aggregate_func_t func, int ret, const zbx_history_value_t *value, int values_num)
+{
+	int	expected_ret;
+
+	expected_ret = zbx_mock_str_to_return_code(zbx_mock_get_object_member_string(hout, "return"));
+	zbx_mock_assert_result_eq("zbx_vc_get_aggregate() return value", expected_ret, ret);
+
+	if (SUCCEED != ret)
+		return;
+
+	zbx_mock_assert_int_eq("values_num", zbx_mock_get_object_member_int(hout, "values_num"), values_num);
+
+	if (ZBX_VC_AGGREGATE_COUNT == func)
+		return;
+
+	if (ITEM_VALUE_TYPE_FLOAT == value_type || ZBX_VC_AGGREGATE_AVG == func)
+		zbx_mock_assert_double_eq("value", zbx_mock_get_object_member_float(hout, "value"), value->dbl);
+	else
+		zbx_mock_assert_uint64_eq("value", zbx_mock_get_object_member_uint64(hout, "value"), value->ui64);
+}
+
+static void	vcmock_check_steps(zbx_mock_handle_t hsteps, zbx_uint64_t itemid, unsigned char value_type,
+		zbx_vc_aggregate_func_t func, int seconds)
+{
+	zbx_mock_handle_t	hstep, hvalues;
+	zbx_mock_error_t	mock_err;
+	zbx_timespec_t		ts;
+	zbx_history_value_t	value;
+	int			err, values_num;
+
+	while (ZBX_MOCK_END_OF_VECTOR != (mock_err = (zbx_mock_vector_element(hsteps, &hstep))))
+	{
+		if (ZBX_MOCK_SUCCESS != mock_err)
+			fail_msg("Cannot read 'steps' element: %s", zbx_mock_error_string(mock_err));
+
+		zbx_vcmock_set_time(hstep, "time");
+
+		if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hstep, "values", &hvalues))
+		{
+			zbx_vector_dc_history_ptr_t	history;
+			int				ret_flush;
+
+			zbx_vector_dc_history_ptr_create(&history);
+			zbx_vcmock_get_dc_history(hvalues, &history);
+
+			err = zbx_vc_add_values(&history, &ret_flush, 0);
+			zbx_mock_assert_result_eq("zbx_vc_add_values() return value", SUCCEED, err);
+
+			zbx_vector_dc_history_ptr_clear_ext(&history, zbx_vcmock_free_dc_history);
+			zbx_vector_dc_history_ptr_destroy(&history);
+		}
+
+		zbx_strtime_to_timespec(zbx_mock_get_object_member_string(hstep, "end"), &ts);
+
+		err = zbx_vc_get_aggregate(itemid, value_type, func, seconds, &ts, &value, &values_num);
+		zbx_vc_flush_stats();
+		vcmock_check_aggregate(zbx_mock_get_object_member_handle(hstep, "out"), value_type, func, err, &value,
+				values_num);
+	}
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	int			err, seconds, count, values_num;
+	char			*error;
+	zbx_mock_handle_t	handle, hitem, hsteps;
+	zbx_mock_error_t	mock_err;
+	zbx_uint64_t		itemid;
+	unsigned char		value_type;
+	zbx_timespec_t		ts;
+	zbx_vc_aggregate_func_t	func;
+	zbx_history_value_t	value;
+
+	ZBX_UNUSED(state);
+
+	set_zbx_config_value_cache_size(ZBX_MEBIBYTE);
+
+	err = zbx_locks_create(&error);
+	zbx_mock_assert_result_eq("Lock initialization failed", SUCCEED, err);
+
+	err = zbx_vc_init(get_zbx_config_value_cache_size(), &error);
+	zbx_mock_assert_result_eq("Value cache initialization failed", SUCCEED, err);
+
+	zbx_vc_enable();
+
+	zbx_vcmock_ds_init();
+
+	/* precache values */
+	handle = zbx_mock_get_parameter_handle("in.precache");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (mock_err = (zbx_mock_vector_element(handle, &hitem))))
+	{
+		zbx_vcmock_set_time(hitem, "time");
+		zbx_vcmock_get_request_params(hitem, &itemid, &value_type, &seconds, &count, &ts);
+		zbx_vc_precache_values(itemid, value_type, seconds, count, &ts);
+	}
+
+	/* perform request */
+
+	handle = zbx_mock_get_parameter_handle("in.test");
+	zbx_vcmock_set_time(handle, "time");
+
+	if (FAIL == zbx_is_uint64(zbx_mock_get_object_member_string(handle, "itemid"), &itemid))
+		fail_msg("Invalid itemid value");
+
+	value_type = zbx_mock_str_to_value_type(zbx_mock_get_object_member_string(handle, "value type"));
+	func = vcmock_str_to_aggregate_func(zbx_mock_get_object_member_string(handle, "function"));
+	seconds = zbx_mock_get_object_member_int(handle, "seconds");
+	zbx_strtime_to_timespec(zbx_mock_get_object_member_string(handle, "end"), &ts);
+
+	/* the first request registers running aggregate period, which is calculated during statistics flush */
+	err = zbx_vc_get_aggregate(itemid, value_type, func, seconds, &ts, &value, &values_num);
+	zbx_mock_assert_result_eq("zbx_vc_get_aggregate() first call return value", FAIL, err);
+	zbx_vc_flush_stats();
+
+	err = zbx_vc_get_aggregate(itemid, value_type, func, seconds, &ts, &value, &values_num);
+	zbx_vc_flush_stats();
+	vcmock_check_aggregate(zbx_mock_get_parameter_handle("out"), value_type, func, err, &value, values_num);
+
+	/* add values and check the updated running aggregates */
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter("in.steps", &hsteps))
+		vcmock_check_steps(hsteps, itemid, value_type, func, seconds);
+
+	/* cleanup */
+
+	zbx_vcmock_ds_destroy();
+
+	zbx_vc_reset();
+	zbx_vc_destroy();
+}
@@ -0,0 +1,91 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxmutexs.h"
+#include "zbxcachevalue.h"
+#include "valuecache_test.h"
+#include "mocks/valuecache/valuecache_mock.h"
+
+static void	vcmock_check_log_values(const char *prefix, const zbx_vector_history_record_t *expected,
+		const zbx_vector_history_record_t *returned)
+{
+	int	i;
+
+	for (i = 0; i < expected->values_num; i++)
+	{
+		zbx_mock_assert_int_eq(prefix, expected->values[i].value.log->timestamp,
+				returned->values[i].value.log->timestamp);
+		zbx_mock_assert_int_eq(prefix, expected->values[i].value.log->severity,
+				returned->values[i].value.log->severity);
+	}
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	int				err, packed;
+	char				*error;
+	unsigned char			value_type;
+	zbx_vector_history_record_t	values, packed_values, unpacked_values;
+	zbx_mock_handle_t		handle;
+
+	ZBX_UNUSED(state);
+
+	set_zbx_config_value_cache_size(ZBX_MEBIBYTE);
+
+	err = zbx_locks_create(&error);
+	zbx_mock_assert_result_eq("Lock initialization failed", SUCCEED, err);
+
+	err = zbx_vc_init(get_zbx_config_value_cache_size(), &error);
+	zbx_mock_assert_result_eq("Value cache initialization failed", SUCCEED, err);
+
+	zbx_vc_enable();
+
+	zbx_vcmock_ds_init();
+
+	zbx_history_record_vector_create(&values);
+	zbx_history_record_vector_create(&packed_values);
+	zbx_history_record_vector_create(&unpacked_values);
+
+	handle = zbx_mock_get_parameter_handle("in");
+	value_type = zbx_mock_str_to_value_type(zbx_mock_get_object_member_string(handle, "value type"));
+	zbx_vcmock_read_values(zbx_mock_get_object_member_handle(handle, "values"), value_type, &values);
+
+	err = zbx_vc_test_pack_values(1, value_type, &values, &packed_values, &unpacked_values, &packed);
+	zbx_mock_assert_result_eq("zbx_vc_test_pack_values() return value", SUCCEED, err);
+
+	zbx_mock_assert_int_eq("packed", zbx_mock_get_parameter_int("out.packed"), packed);
+
+	zbx_vcmock_check_records("Packed chunk values", value_type, &values, &packed_values);
+	zbx_vcmock_check_records("Unpacked chunk values", value_type, &values, &unpacked_values);
+
+	if (ITEM_VALUE_TYPE_LOG == value_type)
+	{
+		vcmock_check_log_values("Packed chunk values", &values, &packed_values);
+		vcmock_check_log_values("Unpacked chunk values", &values, &unpacked_values);
+	}
+
+	zbx_history_record_vector_destroy(&unpacked_values, value_type);
+	zbx_history_record_vector_destroy(&packed_values, value_type);
+	zbx_history_record_vector_destroy(&values, value_type);
+
+	zbx_vcmock_ds_destroy();
+
+	zbx_vc_reset();
+	zbx_vc_destroy();
+}
@@ -0,0 +1,98 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxcommon.h"
+#include "zbxcachevalue.h"
+#include "valuecache_test.h"
+#include "mocks/valuecache/valuecache_mock.h"
+
+#include "zbx_vc_common.h"
+
+static zbx_mock_handle_t	meanwhile_handle;
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: caches item values while prefetch is reading them from history,  *
+ *          simulating another process requesting the same items             *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_test_precache_meanwhile(void)
+{
+	zbx_mock_handle_t	hitem;
+	zbx_uint64_t		itemid;
+	unsigned char		value_type;
+	int			seconds, count;
+	zbx_timespec_t		ts;
+
+	/* only the first batch read is affected */
+	zbx_vcmock_set_history_multi_cb(NULL);
+
+	while (ZBX_MOCK_END_OF_VECTOR != zbx_mock_vector_element(meanwhile_handle, &hitem))
+	{
+		zbx_vcmock_get_request_params(hitem, &itemid, &value_type, &seconds, &count, &ts);
+		zbx_vc_precache_values(itemid, value_type, seconds, count, &ts);
+	}
+}
+
+void	zbx_vc_test_prefetch_values_setup(zbx_mock_handle_t *handle, zbx_uint64_t *itemid,
+		unsigned char *value_type, zbx_timespec_t *ts, int *err, zbx_vector_history_record_t *expected,
+		zbx_vector_history_record_t *returned, int *seconds, int *count)
+{
+	zbx_vector_vc_request_t	requests;
+	zbx_mock_handle_t	hrequests, hrequest;
+	zbx_vc_request_t	request;
+
+	ZBX_UNUSED(err);
+	ZBX_UNUSED(expected);
+	ZBX_UNUSED(returned);
+
+	zbx_vector_vc_request_create(&requests);
+
+	*handle = zbx_mock_get_parameter_handle("in.test");
+	zbx_vcmock_set_time(*handle, "time");
+	zbx_vcmock_set_cache_size(*handle, "cache size");
+
+	hrequests = zbx_mock_get_object_member_handle(*handle, "requests");
+
+	while (ZBX_MOCK_END_OF_VECTOR != zbx_mock_vector_element(hrequests, &hrequest))
+	{
+		zbx_vcmock_get_request_params(hrequest, itemid, value_type, seconds, count, ts);
+
+		request.itemid = *itemid;
+		request.value_type = *value_type;
+		request.seconds = *seconds;
+		request.count = *count;
+		request.ts = *ts;
+		zbx_vector_vc_request_append(&requests, request);
+	}
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(*handle, "meanwhile", &meanwhile_handle))
+		zbx_vcmock_set_history_multi_cb(vc_test_precache_meanwhile);
+
+	zbx_vc_prefetch_values(&requests);
+	zbx_vc_flush_stats();
+
+	zbx_vcmock_set_history_multi_cb(NULL);
+	zbx_vector_vc_request_destroy(&requests);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_vc_common_test_func(state, NULL, NULL, zbx_vc_test_prefetch_values_setup, 0);
+}
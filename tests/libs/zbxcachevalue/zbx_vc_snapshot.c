@@ -0,0 +1,138 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxcommon.h"
+#include "zbxcachevalue.h"
+#include "valuecache_test.h"
+#include "mocks/valuecache/valuecache_mock.h"
+
+#include "zbx_vc_common.h"
+
+FILE	*__real_fopen(const char *path, const char *mode);
+
+/* snapshot is written and read from real file */
+static FILE	*vc_test_fopen(const char *path, const char *mode)
+{
+	return __real_fopen(path, mode);
+}
+
+static int	vc_test_check_item(zbx_uint64_t itemid, unsigned char value_type)
+{
+	ZBX_UNUSED(itemid);
+	ZBX_UNUSED(value_type);
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: corrupts snapshot file as described by test case                  *
+ *                                                                            *
+ * Comments: The patch writes 32-bit integer in native byte order at the      *
+ *           specified offset, the offsets in test cases follow the snapshot  *
+ *           header and item record layout on 64-bit platforms.               *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_test_corrupt_snapshot(zbx_mock_handle_t handle, const char *path)
+{
+	zbx_mock_handle_t	hpatch, htruncate;
+	const char		*data;
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(handle, "patch", &hpatch))
+	{
+		FILE	*file;
+		int	value;
+
+		value = atoi(zbx_mock_get_object_member_string(hpatch, "value"));
+
+		if (NULL == (file = fopen(path, "r+b")))
+			fail_msg("cannot open snapshot file \"%s\": %s", path, zbx_strerror(errno));
+
+		if (0 != fseek(file, atol(zbx_mock_get_object_member_string(hpatch, "offset")), SEEK_SET) ||
+				1 != fwrite(&value, sizeof(value), 1, file))
+		{
+			fail_msg("cannot patch snapshot file \"%s\"", path);
+		}
+
+		fclose(file);
+	}
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(handle, "truncate", &htruncate))
+	{
+		if (ZBX_MOCK_SUCCESS != zbx_mock_string(htruncate, &data))
+			fail_msg("invalid truncate parameter");
+
+		if (0 != truncate(path, atol(data)))
+			fail_msg("cannot truncate snapshot file \"%s\": %s", path, zbx_strerror(errno));
+	}
+}
+
+void	zbx_vc_test_snapshot_setup(zbx_mock_handle_t *handle, zbx_uint64_t *itemid, unsigned char *value_type,
+		zbx_timespec_t *ts, int *err, zbx_vector_history_record_t *expected,
+		zbx_vector_history_record_t *returned, int *seconds, int *count)
+{
+	char	path[] = "/tmp/zbx_vc_snapshot_XXXXXX", *error = NULL;
+	int	fd;
+
+	ZBX_UNUSED(itemid);
+	ZBX_UNUSED(value_type);
+	ZBX_UNUSED(ts);
+	ZBX_UNUSED(expected);
+	ZBX_UNUSED(returned);
+	ZBX_UNUSED(seconds);
+	ZBX_UNUSED(count);
+
+	*handle = zbx_mock_get_parameter_handle("in.test");
+	zbx_vcmock_set_time(*handle, "time");
+
+	zbx_set_fopen_mock_callback(vc_test_fopen);
+
+	if (-1 == (fd = mkstemp(path)))
+		fail_msg("cannot create snapshot file: %s", zbx_strerror(errno));
+
+	close(fd);
+
+	*err = zbx_vc_snapshot_save(path, &error);
+	zbx_mock_assert_result_eq("zbx_vc_snapshot_save()", SUCCEED, *err);
+
+	/* drop cached items so that only the items loaded from snapshot are checked */
+	zbx_vc_reset();
+
+	vc_test_corrupt_snapshot(*handle, path);
+
+	*err = zbx_vc_snapshot_load(path, vc_test_check_item, &error);
+	zbx_mock_assert_int_eq("zbx_vc_snapshot_load()",
+			zbx_mock_str_to_return_code(zbx_mock_get_parameter_string("out.return")), *err);
+
+	if (SUCCEED == *err)
+		zbx_mock_assert_ptr_eq("zbx_vc_snapshot_load() error", NULL, error);
+	else
+		zbx_mock_assert_ptr_ne("zbx_vc_snapshot_load() error", NULL, error);
+
+	/* the loaded snapshot file must be removed so a stale snapshot is not loaded again */
+	zbx_mock_assert_int_eq("snapshot file exists", -1, access(path, F_OK));
+
+	zbx_set_fopen_mock_callback(NULL);
+	zbx_free(error);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_vc_common_test_func(state, NULL, NULL, zbx_vc_test_snapshot_setup, 0);
+}
@@ -0,0 +1,87 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxdb.h"
+#include "../../../src/libs/zbxdb/dbconn.h"
+
+static unsigned char	str_to_bind_type(const char *str)
+{
+	if (0 == strcmp(str, "ZBX_TYPE_ID"))
+		return ZBX_TYPE_ID;
+
+	if (0 == strcmp(str, "ZBX_TYPE_INT"))
+		return ZBX_TYPE_INT;
+
+	if (0 == strcmp(str, "ZBX_TYPE_FLOAT"))
+		return ZBX_TYPE_FLOAT;
+
+	if (0 == strcmp(str, "ZBX_TYPE_CHAR"))
+		return ZBX_TYPE_CHAR;
+
+	fail_msg("unknown parameter type \"%s\"", str);
+
+	return ZBX_TYPE_CHAR;
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_mock_handle_t	hbinds, hbind;
+	zbx_mock_error_t	err;
+	zbx_db_bind_t		binds[16];
+	int			binds_num = 0;
+	char			*sql;
+
+	ZBX_UNUSED(state);
+
+	hbinds = zbx_mock_get_parameter_handle("in.binds");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = zbx_mock_vector_element(hbinds, &hbind)))
+	{
+		zbx_db_bind_t	*bind;
+
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("cannot read parameter #%d: %s", binds_num + 1, zbx_mock_error_string(err));
+
+		if ((int)ARRSIZE(binds) <= binds_num)
+			fail_msg("too many parameters");
+
+		bind = &binds[binds_num++];
+
+		switch (str_to_bind_type(zbx_mock_get_object_member_string(hbind, "type")))
+		{
+			case ZBX_TYPE_ID:
+				zbx_db_bind_uint64(bind, zbx_mock_get_object_member_uint64(hbind, "value"));
+				break;
+			case ZBX_TYPE_INT:
+				zbx_db_bind_int(bind, zbx_mock_get_object_member_int(hbind, "value"));
+				break;
+			case ZBX_TYPE_FLOAT:
+				bind->type = ZBX_TYPE_FLOAT;
+				bind->value.dbl = zbx_mock_get_object_member_float(hbind, "value");
+				break;
+			default:
+				zbx_db_bind_str(bind, zbx_mock_get_object_member_string(hbind, "value"));
+				break;
+		}
+	}
+
+	sql = dbconn_bind_sql(zbx_mock_get_parameter_string("in.sql"), binds, binds_num);
+	zbx_mock_assert_str_eq("statement text", zbx_mock_get_parameter_string("out.sql"), sql);
+	zbx_free(sql);
+}
@@ -0,0 +1,62 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxdb.h"
+#include "../../../src/libs/zbxdb/dbconn.h"
+
+void	zbx_mock_test_entry(void **state)
+{
+#if defined(ZBX_PG_PIPELINE)
+	zbx_mock_handle_t	hstatements, hstatement;
+	const char		*sql, *end, *expected;
+	char			*statement;
+	int			escape_backslash, num = 0;
+
+	ZBX_UNUSED(state);
+
+	sql = zbx_mock_get_parameter_string("in.sql");
+	escape_backslash = (ZBX_MOCK_SUCCESS == zbx_mock_parameter_exists("in.escape_backslash") ?
+			zbx_mock_get_parameter_int("in.escape_backslash") : 0);
+
+	hstatements = zbx_mock_get_parameter_handle("out.statements");
+
+	while (NULL != (end = dbconn_statement_next(&sql, escape_backslash)))
+	{
+		if (ZBX_MOCK_SUCCESS != zbx_mock_vector_element(hstatements, &hstatement) ||
+				ZBX_MOCK_SUCCESS != zbx_mock_string(hstatement, &expected))
+		{
+			fail_msg("unexpected statement #%d \"%s\"", num + 1, sql);
+		}
+
+		statement = zbx_dsprintf(NULL, "%.*s", (int)(end - sql), sql);
+		zbx_mock_assert_str_eq("statement", expected, statement);
+		zbx_free(statement);
+
+		sql = end;
+		num++;
+	}
+
+	if (ZBX_MOCK_END_OF_VECTOR != zbx_mock_vector_element(hstatements, &hstatement))
+		fail_msg("expected more than %d statements", num);
+#else
+	ZBX_UNUSED(state);
+
+	skip();
+#endif
+}
@@ -0,0 +1,214 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxdb.h"
+#include "zbxdbschema.h"
+#include "../../../src/libs/zbxdb/dbconn.h"
+
+#define TEST_TABLE_NAME	"test_copy"
+
+static char	*copy_sql, *copy_data, *execute_sql;
+static size_t	copy_data_alloc, copy_data_offset;
+static int	copy_num;
+
+int	__wrap_dbconn_copy(zbx_dbconn_t *db, const char *sql, const char *data, size_t size);
+int	__wrap_zbx_dbconn_execute(zbx_dbconn_t *db, const char *fmt, ...);
+
+int	__wrap_dbconn_copy(zbx_dbconn_t *db, const char *sql, const char *data, size_t size)
+{
+	ZBX_UNUSED(db);
+
+	copy_num++;
+
+	if (NULL != copy_sql && 0 != strcmp(copy_sql, sql))
+		fail_msg("COPY statement changed from \"%s\" to \"%s\"", copy_sql, sql);
+
+	zbx_free(copy_sql);
+	copy_sql = zbx_strdup(NULL, sql);
+
+	for (size_t i = 0; i < size; i++)
+		zbx_snprintf_alloc(&copy_data, &copy_data_alloc, &copy_data_offset, "%02x", (unsigned char)data[i]);
+
+	return ZBX_DB_OK;
+}
+
+int	__wrap_zbx_dbconn_execute(zbx_dbconn_t *db, const char *fmt, ...)
+{
+	va_list	args;
+
+	ZBX_UNUSED(db);
+
+	va_start(args, fmt);
+	zbx_free(execute_sql);
+	execute_sql = zbx_dvsprintf(NULL, fmt, args);
+	va_end(args);
+
+	return ZBX_DB_OK;
+}
+
+static unsigned char	str_to_field_type(const char *str)
+{
+	if (0 == strcmp(str, "ZBX_TYPE_ID"))
+		return ZBX_TYPE_ID;
+
+	if (0 == strcmp(str, "ZBX_TYPE_INT"))
+		return ZBX_TYPE_INT;
+
+	if (0 == strcmp(str, "ZBX_TYPE_UINT"))
+		return ZBX_TYPE_UINT;
+
+	if (0 == strcmp(str, "ZBX_TYPE_FLOAT"))
+		return ZBX_TYPE_FLOAT;
+
+	if (0 == strcmp(str, "ZBX_TYPE_CHAR"))
+		return ZBX_TYPE_CHAR;
+
+	if (0 == strcmp(str, "ZBX_TYPE_TEXT"))
+		return ZBX_TYPE_TEXT;
+
+	if (0 == strcmp(str, "ZBX_TYPE_BLOB"))
+		return ZBX_TYPE_BLOB;
+
+	fail_msg("unknown field type \"%s\"", str);
+
+	return ZBX_TYPE_CHAR;
+}
+
+static void	add_row(zbx_db_insert_t *db_insert, zbx_mock_handle_t hrow, const zbx_db_table_t *table)
+{
+	zbx_mock_handle_t	hvalue;
+	zbx_db_value_t		values[ZBX_MAX_FIELDS], *pvalues[ZBX_MAX_FIELDS];
+	const char		*str;
+	int			values_num = 0;
+
+	while (ZBX_MOCK_END_OF_VECTOR != zbx_mock_vector_element(hrow, &hvalue))
+	{
+		if (ZBX_MOCK_SUCCESS != zbx_mock_string(hvalue, &str))
+			fail_msg("invalid value of field #%d", values_num + 1);
+
+		switch (table->fields[values_num].type)
+		{
+			case ZBX_TYPE_ID:
+			case ZBX_TYPE_UINT:
+				if (SUCCEED != zbx_is_uint64(str, &values[values_num].ui64))
+					fail_msg("invalid unsigned value \"%s\"", str);
+				break;
+			case ZBX_TYPE_INT:
+				values[values_num].i32 = atoi(str);
+				break;
+			case ZBX_TYPE_FLOAT:
+				values[values_num].dbl = atof(str);
+				break;
+			default:
+				values[values_num].str = (char *)str;
+				break;
+		}
+
+		pvalues[values_num] = &values[values_num];
+		values_num++;
+	}
+
+	zbx_db_insert_add_values_dyn(db_insert, pvalues, values_num);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+#if defined(HAVE_POSTGRESQL)
+	zbx_mock_handle_t	hfields, hfield, hrows, hrow, hdata, hchunk;
+	zbx_db_table_t		table;
+	const zbx_db_field_t	*fields[ZBX_MAX_FIELDS];
+	zbx_db_insert_t		db_insert;
+	int			fields_num = 0;
+	char			*data = NULL;
+	size_t			data_alloc = 0, data_offset = 0;
+	const char		*chunk;
+
+	ZBX_UNUSED(state);
+
+	memset(&table, 0, sizeof(table));
+	table.table = TEST_TABLE_NAME;
+
+	hfields = zbx_mock_get_parameter_handle("in.fields");
+
+	while (ZBX_MOCK_END_OF_VECTOR != zbx_mock_vector_element(hfields, &hfield))
+	{
+		zbx_db_field_t	*field = &table.fields[fields_num];
+
+		field->name = zbx_mock_get_object_member_string(hfield, "name");
+		field->type = str_to_field_type(zbx_mock_get_object_member_string(hfield, "type"));
+
+		/* string lengths as defined in database schema, zero length blob is not limited */
+		if (ZBX_TYPE_CHAR == field->type)
+			field->length = 255;
+		else if (ZBX_TYPE_TEXT == field->type)
+			field->length = 65535;
+
+		fields[fields_num] = field;
+		fields_num++;
+	}
+
+	zbx_dbconn_prepare_insert_dyn(NULL, &db_insert, &table, fields, fields_num);
+
+	hrows = zbx_mock_get_parameter_handle("in.rows");
+
+	while (ZBX_MOCK_END_OF_VECTOR != zbx_mock_vector_element(hrows, &hrow))
+		add_row(&db_insert, hrow, &table);
+
+	zbx_mock_assert_result_eq("zbx_db_insert_execute() return value", SUCCEED, zbx_db_insert_execute(&db_insert));
+	zbx_db_insert_clean(&db_insert);
+
+	zbx_mock_assert_int_eq("COPY statements", zbx_mock_get_parameter_int("out.copies"), copy_num);
+
+	if (0 == copy_num)
+	{
+		zbx_mock_assert_str_eq("insert statement", zbx_mock_get_parameter_string("out.sql"), execute_sql);
+		zbx_free(execute_sql);
+
+		return;
+	}
+
+	zbx_mock_assert_str_eq("COPY statement", zbx_mock_get_parameter_string("out.sql"), copy_sql);
+
+	/* expected data is split into chunks with optional spaces to keep header, tuples and trailer readable */
+	hdata = zbx_mock_get_parameter_handle("out.data");
+
+	while (ZBX_MOCK_END_OF_VECTOR != zbx_mock_vector_element(hdata, &hchunk))
+	{
+		if (ZBX_MOCK_SUCCESS != zbx_mock_string(hchunk, &chunk))
+			fail_msg("invalid expected data chunk");
+
+		for (; '\0' != *chunk; chunk++)
+		{
+			if (' ' != *chunk)
+				zbx_chrcpy_alloc(&data, &data_alloc, &data_offset, *chunk);
+		}
+	}
+
+	zbx_mock_assert_str_eq("COPY data", data, copy_data);
+
+	zbx_free(data);
+	zbx_free(copy_data);
+	zbx_free(copy_sql);
+	zbx_free(execute_sql);
+#else
+	ZBX_UNUSED(state);
+
+	skip();
+#endif
+}
@@ -0,0 +1,51 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxexpression.h"
+
+void	zbx_mock_test_entry(void **state)
+{
+	int		expected_ret, returned_ret, seconds, count;
+	zbx_timespec_t	ts, ts_end, expected_end;
+
+	ZBX_UNUSED(state);
+
+	if (ZBX_MOCK_SUCCESS != zbx_strtime_to_timespec(zbx_mock_get_parameter_string("in.time"), &ts))
+		fail_msg("Invalid input time format");
+
+	returned_ret = zbx_evaluate_function_history_range(zbx_mock_get_parameter_string("in.function"),
+			zbx_mock_get_parameter_string("in.params"), &ts, &seconds, &count, &ts_end);
+
+	expected_ret = zbx_mock_str_to_return_code(zbx_mock_get_parameter_string("out.return"));
+	zbx_mock_assert_result_eq("return value", expected_ret, returned_ret);
+
+	if (SUCCEED == expected_ret)
+	{
+		zbx_mock_assert_int_eq("seconds", zbx_mock_get_parameter_int("out.seconds"), seconds);
+		zbx_mock_assert_int_eq("count", zbx_mock_get_parameter_int("out.count"), count);
+
+		if (ZBX_MOCK_SUCCESS != zbx_strtime_to_timespec(zbx_mock_get_parameter_string("out.end"),
+				&expected_end))
+		{
+			fail_msg("Invalid output end time format");
+		}
+
+		zbx_mock_assert_timespec_eq("end", &expected_end, &ts_end);
+	}
+}
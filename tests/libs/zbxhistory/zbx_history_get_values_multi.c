@@ -0,0 +1,177 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+#include "zbxmockdb.h"
+
+#include "zbxnum.h"
+#include "zbxalgo.h"
+#include "zbxhistory.h"
+#include "zbxdb.h"
+#include "zbxdbhigh.h"
+#include "zbxavailability.h"
+
+void	__wrap_zbx_sleep_loop(int sleeptime);
+zbx_uint64_t	__wrap_zbx_dc_get_nextid(const char *table_name, int num);
+int	__wrap_zbx_interface_availability_is_set(const zbx_interface_availability_t *ha);
+int	__wrap_zbx_add_event(unsigned char source, unsigned char object, zbx_uint64_t objectid,
+		const zbx_timespec_t *timespec, int value, const char *trigger_description,
+		const char *trigger_expression, const char *trigger_recovery_expression, unsigned char trigger_priority,
+		unsigned char trigger_type, const zbx_vector_ptr_t *trigger_tags,
+		unsigned char trigger_correlation_mode, const char *trigger_correlation_tag,
+		unsigned char trigger_value, const char *trigger_opdata, const char *error);
+int	__wrap_zbx_process_events(zbx_vector_ptr_t *trigger_diff, zbx_vector_uint64_t *triggerids_lock);
+void	__wrap_zbx_clean_events(void);
+void	__wrap_zbx_recalc_time_period(time_t *ts_from, int table_group);
+
+void	__wrap_zbx_sleep_loop(int sleeptime)
+{
+	ZBX_UNUSED(sleeptime);
+}
+
+zbx_uint64_t	__wrap_zbx_dc_get_nextid(const char *table_name, int num)
+{
+	ZBX_UNUSED(table_name);
+	ZBX_UNUSED(num);
+	return 0;
+}
+
+int	__wrap_zbx_interface_availability_is_set(const zbx_interface_availability_t *ha)
+{
+	ZBX_UNUSED(ha);
+	return SUCCEED;
+}
+
+int	__wrap_zbx_add_event(unsigned char source, unsigned char object, zbx_uint64_t objectid,
+		const zbx_timespec_t *timespec, int value, const char *trigger_description,
+		const char *trigger_expression, const char *trigger_recovery_expression, unsigned char trigger_priority,
+		unsigned char trigger_type, const zbx_vector_ptr_t *trigger_tags,
+		unsigned char trigger_correlation_mode, const char *trigger_correlation_tag,
+		unsigned char trigger_value, const char *trigger_opdata, const char *error)
+{
+	ZBX_UNUSED(source);
+	ZBX_UNUSED(object);
+	ZBX_UNUSED(objectid);
+	ZBX_UNUSED(timespec);
+	ZBX_UNUSED(value);
+	ZBX_UNUSED(trigger_description);
+	ZBX_UNUSED(trigger_expression);
+	ZBX_UNUSED(trigger_recovery_expression);
+	ZBX_UNUSED(trigger_priority);
+	ZBX_UNUSED(trigger_type);
+	ZBX_UNUSED(trigger_tags);
+	ZBX_UNUSED(trigger_correlation_mode);
+	ZBX_UNUSED(trigger_correlation_tag);
+	ZBX_UNUSED(trigger_value);
+	ZBX_UNUSED(trigger_opdata);
+	ZBX_UNUSED(error);
+	return SUCCEED;
+
+}
+
+int	__wrap_zbx_process_events(zbx_vector_ptr_t *trigger_diff, zbx_vector_uint64_t *triggerids_lock)
+{
+	ZBX_UNUSED(trigger_diff);
+	ZBX_UNUSED(triggerids_lock);
+	return SUCCEED;
+}
+
+void	__wrap_zbx_clean_events(void)
+{
+}
+
+void	__wrap_zbx_recalc_time_period(time_t *ts_from, int table_group)
+{
+	ZBX_UNUSED(ts_from);
+	ZBX_UNUSED(table_group);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Comments: The batch read of uint64 values is checked - the generated SQL   *
+ *           and the distribution of returned rows between items.             *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_mock_test_entry(void **state)
+{
+	char				*error = NULL;
+	int				err, i, itemids_num = 0;
+	zbx_uint64_t			itemids[16];
+	zbx_vector_history_record_t	values[16];
+	zbx_mock_handle_t		hitemids, hitemid, hitems, hitem, hvalues, hvalue;
+
+	ZBX_UNUSED(state);
+
+	zbx_mockdb_init();
+
+	err = zbx_history_init(NULL, NULL, 0, &error);
+	zbx_mock_assert_result_eq("zbx_history_init()", SUCCEED, err);
+
+	hitemids = zbx_mock_get_parameter_handle("in.itemids");
+
+	while (ZBX_MOCK_END_OF_VECTOR != zbx_mock_vector_element(hitemids, &hitemid))
+	{
+		if (ARRSIZE(itemids) == itemids_num)
+			fail_msg("too many items");
+
+		itemids[itemids_num] = zbx_mock_get_object_member_uint64(hitemid, "itemid");
+		zbx_history_record_vector_create(&values[itemids_num++]);
+	}
+
+	err = zbx_history_get_values_multi(itemids, itemids_num, ITEM_VALUE_TYPE_UINT64,
+			zbx_mock_get_parameter_int("in.start"), zbx_mock_get_parameter_int("in.count"),
+			zbx_mock_get_parameter_int("in.end"), values);
+	zbx_mock_assert_result_eq("zbx_history_get_values_multi()", SUCCEED, err);
+
+	zbx_mock_assert_str_eq("SQL", zbx_mock_get_parameter_string("out.sql"), zbx_mockdb_get_last_query());
+
+	hitems = zbx_mock_get_parameter_handle("out.items");
+
+	for (i = 0; i < itemids_num; i++)
+	{
+		int	values_num = 0;
+
+		if (ZBX_MOCK_SUCCESS != zbx_mock_vector_element(hitems, &hitem))
+			fail_msg("missing expected values of item " ZBX_FS_UI64, itemids[i]);
+
+		zbx_mock_assert_uint64_eq("itemid", zbx_mock_get_object_member_uint64(hitem, "itemid"), itemids[i]);
+
+		hvalues = zbx_mock_get_object_member_handle(hitem, "values");
+
+		while (ZBX_MOCK_END_OF_VECTOR != zbx_mock_vector_element(hvalues, &hvalue))
+		{
+			const zbx_history_record_t	*record;
+
+			if (values_num == values[i].values_num)
+				fail_msg("too few values returned for item " ZBX_FS_UI64, itemids[i]);
+
+			record = &values[i].values[values_num++];
+
+			zbx_mock_assert_int_eq("clock", zbx_mock_get_object_member_int(hvalue, "clock"),
+					record->timestamp.sec);
+			zbx_mock_assert_uint64_eq("value", zbx_mock_get_object_member_uint64(hvalue, "value"),
+					record->value.ui64);
+		}
+
+		zbx_mock_assert_int_eq("number of values", values_num, values[i].values_num);
+		zbx_history_record_vector_destroy(&values[i], ITEM_VALUE_TYPE_UINT64);
+	}
+
+	zbx_history_destroy();
+
+	zbx_mockdb_destroy();
+}
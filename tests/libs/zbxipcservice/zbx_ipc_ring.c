@@ -0,0 +1,273 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockutil.h"
+#include "zbxmockassert.h"
+
+#include "zbxipcservice.h"
+#include "zbxalgo.h"
+#include "../../../src/libs/zbxipcservice/ipcring.h"
+
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+/* the producer and consumer sides of the tested ring */
+typedef struct
+{
+	zbx_ipc_ring_t		*producer;
+	zbx_ipc_ring_t		*consumer;
+	zbx_ipc_socket_t	csocket;
+
+	/* sizes of written records, indexed by record sequence number */
+	zbx_vector_uint32_t	sizes;
+	zbx_uint32_t		read_num;
+
+	/* the child process reading records while producer waits for space */
+	pid_t			consumer_pid;
+	zbx_uint32_t		consumed_num;
+}
+zbx_ring_test_t;
+
+static unsigned char	ring_test_byte(zbx_uint32_t seq, zbx_uint32_t i)
+{
+	return (unsigned char)(seq * 31 + i);
+}
+
+static void	ring_test_write(zbx_ring_test_t *rt, zbx_mock_handle_t hstep)
+{
+	int		i, records_num;
+	zbx_uint32_t	size;
+
+	records_num = zbx_mock_get_object_member_int(hstep, "records");
+	size = (zbx_uint32_t)zbx_mock_get_object_member_int(hstep, "size");
+
+	for (i = 0; i < records_num; i++)
+	{
+		unsigned char	*data;
+		zbx_uint32_t	seq = (zbx_uint32_t)rt->sizes.values_num, j;
+
+		data = zbx_ipc_ring_reserve(rt->producer, size, &rt->csocket);
+		zbx_mock_assert_ptr_ne("reserved record", NULL, data);
+		zbx_mock_assert_int_eq("record alignment", 0, (int)((uintptr_t)data & 7));
+
+		memcpy(data, &seq, sizeof(seq));
+
+		for (j = sizeof(seq); j < size; j++)
+			data[j] = ring_test_byte(seq, j);
+
+		zbx_ipc_ring_commit(rt->producer, size);
+		zbx_vector_uint32_append(&rt->sizes, size);
+	}
+}
+
+static void	ring_test_read(zbx_ring_test_t *rt, zbx_mock_handle_t hstep)
+{
+	int			i, records_num;
+	zbx_uint32_t		size, seq, j;
+	const unsigned char	*data;
+
+	records_num = zbx_mock_get_object_member_int(hstep, "records");
+
+	for (i = 0; i < records_num; i++)
+	{
+		if (NULL == (data = zbx_ipc_ring_read(rt->consumer, &size)))
+			fail_msg("expected %d records while got %d", records_num, i);
+
+		memcpy(&seq, data, sizeof(seq));
+
+		/* records must be read in the order they were written */
+		zbx_mock_assert_uint64_eq("record sequence", rt->read_num, seq);
+		zbx_mock_assert_uint64_eq("record size", rt->sizes.values[seq], size);
+
+		for (j = sizeof(seq); j < size; j++)
+		{
+			if (ring_test_byte(seq, j) != data[j])
+				fail_msg("record %u data mismatch at offset %u", seq, j);
+		}
+
+		rt->read_num++;
+	}
+
+	zbx_mock_assert_ptr_eq("record after the last expected record", NULL,
+			zbx_ipc_ring_read(rt->consumer, &size));
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: reads records in a child process, releasing them as they are      *
+ *          read, so the producer can wait for ring space                     *
+ *                                                                            *
+ * Comments: The wait for ring space is observed through the shared ring      *
+ *           state only - test builds wrap read() and poll() functions.       *
+ *                                                                            *
+ ******************************************************************************/
+static void	ring_test_consume(zbx_ring_test_t *rt, zbx_mock_handle_t hstep)
+{
+	int	records_num;
+
+	records_num = zbx_mock_get_object_member_int(hstep, "records");
+
+	if (-1 == (rt->consumer_pid = fork()))
+		fail_msg("cannot fork consumer: %s", zbx_strerror(errno));
+
+	if (0 == rt->consumer_pid)
+	{
+		zbx_uint32_t		seq, size, j, read_num = rt->read_num;
+		const unsigned char	*data;
+
+		/* let the producer fill the ring and start waiting */
+		usleep(100000);
+
+		while (read_num < rt->read_num + (zbx_uint32_t)records_num)
+		{
+			ipc_ring_reset_doorbell(rt->consumer);
+
+			while (NULL != (data = zbx_ipc_ring_read(rt->consumer, &size)))
+			{
+				memcpy(&seq, data, sizeof(seq));
+
+				if (seq != read_num++)
+					_exit(EXIT_FAILURE);
+
+				for (j = sizeof(seq); j < size; j++)
+				{
+					if (ring_test_byte(seq, j) != data[j])
+						_exit(EXIT_FAILURE);
+				}
+			}
+
+			zbx_ipc_ring_release(rt->consumer);
+			usleep(1000);
+		}
+
+		_exit(EXIT_SUCCESS);
+	}
+
+	rt->consumed_num = (zbx_uint32_t)records_num;
+}
+
+static void	ring_test_wait(zbx_ring_test_t *rt)
+{
+	int	status;
+
+	if (-1 == waitpid(rt->consumer_pid, &status, 0))
+		fail_msg("cannot wait for consumer: %s", zbx_strerror(errno));
+
+	if (0 == WIFEXITED(status) || EXIT_SUCCESS != WEXITSTATUS(status))
+		fail_msg("consumer failed to read the records in order");
+
+	/* continue reading from the position the child consumer has released */
+	rt->consumer->offset = __atomic_load_n(&rt->consumer->header->head, __ATOMIC_SEQ_CST);
+	rt->consumer->limit = rt->consumer->offset;
+	rt->read_num += rt->consumed_num;
+	rt->consumer_pid = -1;
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_ring_test_t		rt;
+	zbx_mock_handle_t	hsteps, hstep;
+	char			*error = NULL;
+	int			sv[2], fds[ZBX_IPC_RING_FDS_NUM], i;
+	const char		*op;
+
+	ZBX_UNUSED(state);
+
+	memset(&rt, 0, sizeof(rt));
+	zbx_vector_uint32_create(&rt.sizes);
+
+	if (SUCCEED != zbx_ipc_ring_create(&rt.producer, (zbx_uint32_t)zbx_mock_get_parameter_int("in.size"),
+			&error))
+	{
+		fail_msg("cannot create ring: %s", error);
+	}
+
+	/* the consumer opens the ring with descriptors received from producer */
+	for (i = 0; i < ZBX_IPC_RING_FDS_NUM; i++)
+		fds[i] = dup(rt.producer->fds[i]);
+
+	if (SUCCEED != ipc_ring_open(&rt.consumer, fds, &error))
+		fail_msg("cannot open ring: %s", error);
+
+	if (0 != socketpair(AF_UNIX, SOCK_STREAM, 0, sv))
+		fail_msg("cannot create socket pair: %s", zbx_strerror(errno));
+
+	rt.csocket.fd = sv[0];
+	rt.consumer_pid = -1;
+
+	hsteps = zbx_mock_get_parameter_handle("in.steps");
+
+	while (ZBX_MOCK_END_OF_VECTOR != zbx_mock_vector_element(hsteps, &hstep))
+	{
+		op = zbx_mock_get_object_member_string(hstep, "op");
+
+		if (0 == strcmp(op, "write"))
+		{
+			ring_test_write(&rt, hstep);
+		}
+		else if (0 == strcmp(op, "notify"))
+		{
+			zbx_ipc_ring_notify(rt.producer);
+		}
+		else if (0 == strcmp(op, "doorbell"))
+		{
+			zbx_mock_assert_int_eq("doorbell state", zbx_mock_get_object_member_int(hstep, "value"),
+					__atomic_load_n(&rt.consumer->header->signaled, __ATOMIC_SEQ_CST));
+		}
+		else if (0 == strcmp(op, "reset"))
+		{
+			ipc_ring_reset_doorbell(rt.consumer);
+		}
+		else if (0 == strcmp(op, "read"))
+		{
+			ring_test_read(&rt, hstep);
+		}
+		else if (0 == strcmp(op, "release"))
+		{
+			zbx_ipc_ring_release(rt.consumer);
+		}
+		else if (0 == strcmp(op, "flush"))
+		{
+			zbx_mock_assert_result_eq("zbx_ipc_ring_flush() return value", SUCCEED,
+					zbx_ipc_ring_flush(rt.producer, &rt.csocket));
+		}
+		else if (0 == strcmp(op, "consume"))
+		{
+			ring_test_consume(&rt, hstep);
+		}
+		else if (0 == strcmp(op, "wait"))
+		{
+			ring_test_wait(&rt);
+		}
+		else if (0 == strcmp(op, "max record size"))
+		{
+			zbx_mock_assert_uint64_eq("zbx_ipc_ring_max_record_size() return value",
+					(zbx_uint64_t)zbx_mock_get_object_member_int(hstep, "value"),
+					zbx_ipc_ring_max_record_size(rt.producer));
+		}
+		else
+			fail_msg("unknown step operation \"%s\"", op);
+	}
+
+	zbx_mock_assert_uint64_eq("number of records read", rt.sizes.values_num, rt.read_num);
+
+	close(sv[1]);
+	close(sv[0]);
+
+	zbx_ipc_ring_free(rt.consumer);
+	zbx_ipc_ring_free(rt.producer);
+	zbx_vector_uint32_destroy(&rt.sizes);
+}
@@ -0,0 +1,191 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxjson.h"
+#include "zbxtime.h"
+
+/* benchmark of JSON parsing with payloads similar to the ones received by server: */
+/*   lld   - low level discovery rule value                                        */
+/*   http  - HTTP agent master item value with nested objects and escaped text     */
+/*   proxy - proxy history data                                                    */
+
+static void	bench_add_lld(struct zbx_json *j, int i)
+{
+	char	buf[MAX_STRING_LEN];
+
+	zbx_json_addobject(j, NULL);
+	zbx_snprintf(buf, sizeof(buf), "eth%d", i);
+	zbx_json_addstring(j, "{#IFNAME}", buf, ZBX_JSON_TYPE_STRING);
+	zbx_snprintf(buf, sizeof(buf), "uplink to core switch %d port %d", i % 48, i);
+	zbx_json_addstring(j, "{#IFALIAS}", buf, ZBX_JSON_TYPE_STRING);
+	zbx_json_addstring(j, "{#IFTYPE}", "6", ZBX_JSON_TYPE_STRING);
+	zbx_json_addstring(j, "{#IFDESCR}", "Intel Corporation Ethernet Controller X710 for 10GbE SFP+",
+			ZBX_JSON_TYPE_STRING);
+	zbx_json_close(j);
+}
+
+static void	bench_add_http(struct zbx_json *j, int i)
+{
+	char	buf[MAX_STRING_LEN];
+
+	zbx_json_addobject(j, NULL);
+	zbx_snprintf(buf, sizeof(buf), "node-%d", i);
+	zbx_json_addstring(j, "name", buf, ZBX_JSON_TYPE_STRING);
+	zbx_json_addstring(j, "status", 0 == i % 10 ? "yellow" : "green", ZBX_JSON_TYPE_STRING);
+	zbx_json_addobject(j, "stats");
+	zbx_json_adduint64(j, "cpu_percent", (zbx_uint64_t)(i % 100));
+	zbx_json_adduint64(j, "heap_used_in_bytes", (zbx_uint64_t)i * 1048576);
+	zbx_json_addfloat(j, "load_average", (double)(i % 400) / 100);
+	zbx_json_close(j);
+	zbx_json_addarray(j, "roles");
+	zbx_json_addstring(j, NULL, "data", ZBX_JSON_TYPE_STRING);
+	zbx_json_addstring(j, NULL, "ingest", ZBX_JSON_TYPE_STRING);
+	zbx_json_close(j);
+	zbx_snprintf(buf, sizeof(buf), "last \"gc\" run took %dms\n\tpath: C:\\data\\node-%d\n\tzone: \xc3\xa4",
+			i % 1000, i);
+	zbx_json_addstring(j, "message", buf, ZBX_JSON_TYPE_STRING);
+	zbx_json_close(j);
+}
+
+static void	bench_add_proxy(struct zbx_json *j, int i)
+{
+	char	buf[MAX_STRING_LEN];
+
+	zbx_json_addobject(j, NULL);
+	zbx_json_adduint64(j, "id", (zbx_uint64_t)i);
+	zbx_json_adduint64(j, "itemid", (zbx_uint64_t)(100000 + i % 5000));
+	zbx_json_adduint64(j, "clock", (zbx_uint64_t)(1700000000 + i / 100));
+	zbx_json_adduint64(j, "ns", (zbx_uint64_t)(i * 7919 % 1000000000));
+
+	if (0 == i % 4)
+	{
+		zbx_snprintf(buf, sizeof(buf), "2024-05-01 12:00:%02d host%d app[%d]: request %d processed", i % 60,
+				i % 17, i, i);
+	}
+	else
+		zbx_snprintf(buf, sizeof(buf), "%d.%d", i % 1000, i % 100);
+
+	zbx_json_addstring(j, "value", buf, ZBX_JSON_TYPE_STRING);
+	zbx_json_close(j);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	const char		*payload, *array, *key, *p;
+	int			i, iterations, elements = 0, count;
+	zbx_uint64_t		size;
+	struct zbx_json		j;
+	struct zbx_json_parse	jp, jp_array, jp_row;
+	zbx_jsonobj_t		obj;
+	const zbx_jsonobj_t	*value;
+	double			t_open = 0, t_next = 0, t_obj = 0, t, mb;
+	char			buf[MAX_STRING_LEN];
+	void			(*add_element)(struct zbx_json *j, int i);
+
+	ZBX_UNUSED(state);
+
+	payload = zbx_mock_get_parameter_string("in.payload");
+	size = zbx_mock_get_parameter_uint64("in.size");
+	iterations = (int)zbx_mock_get_parameter_uint64("in.iterations");
+
+	if (0 == strcmp(payload, "lld"))
+	{
+		array = "data";
+		key = "{#IFNAME}";
+		add_element = bench_add_lld;
+	}
+	else if (0 == strcmp(payload, "http"))
+	{
+		array = "nodes";
+		key = "name";
+		add_element = bench_add_http;
+	}
+	else if (0 == strcmp(payload, "proxy"))
+	{
+		array = ZBX_PROTO_TAG_HISTORY_DATA;
+		key = "itemid";
+		add_element = bench_add_proxy;
+	}
+	else
+		fail_msg("unknown payload type \"%s\"", payload);
+
+	zbx_json_init(&j, ZBX_JSON_STAT_BUF_LEN);
+
+	if (0 == strcmp(payload, "proxy"))
+	{
+		zbx_json_addstring(&j, ZBX_PROTO_TAG_REQUEST, ZBX_PROTO_VALUE_PROXY_DATA, ZBX_JSON_TYPE_STRING);
+		zbx_json_addstring(&j, ZBX_PROTO_TAG_HOST, "proxy", ZBX_JSON_TYPE_STRING);
+	}
+
+	zbx_json_addarray(&j, array);
+
+	while (j.buffer_size < size)
+		add_element(&j, elements++);
+
+	zbx_json_close(&j);
+	zbx_json_adduint64(&j, ZBX_PROTO_TAG_CLOCK, 1700000000);
+
+	for (i = 0; i < iterations; i++)
+	{
+		t = zbx_time();
+
+		if (SUCCEED != zbx_json_open(j.buffer, &jp))
+			fail_msg("cannot open generated JSON: %s", zbx_json_strerror());
+
+		t_open += zbx_time() - t;
+		t = zbx_time();
+
+		if (SUCCEED != zbx_json_brackets_by_name(&jp, array, &jp_array))
+			fail_msg("cannot find \"%s\" array: %s", array, zbx_json_strerror());
+
+		for (count = 0, p = NULL; NULL != (p = zbx_json_next(&jp_array, p)); count++)
+		{
+			if (SUCCEED != zbx_json_brackets_open(p, &jp_row) ||
+					SUCCEED != zbx_json_value_by_name(&jp_row, key, buf, sizeof(buf), NULL))
+			{
+				fail_msg("cannot parse element %d: %s", count, zbx_json_strerror());
+			}
+		}
+
+		t_next += zbx_time() - t;
+		zbx_mock_assert_int_eq("iterated elements", elements, count);
+
+		t = zbx_time();
+
+		if (SUCCEED != zbx_jsonobj_open(j.buffer, &obj))
+			fail_msg("cannot open generated JSON as object: %s", zbx_json_strerror());
+
+		t_obj += zbx_time() - t;
+
+		if (NULL == (value = zbx_jsonobj_get_value(&obj, array)) || ZBX_JSON_TYPE_ARRAY != value->type)
+			fail_msg("cannot find \"%s\" array in parsed object", array);
+
+		zbx_mock_assert_int_eq("parsed elements", elements, value->data.array.values_num);
+		zbx_jsonobj_clear(&obj);
+	}
+
+	mb = (double)j.buffer_size * iterations / ZBX_MEBIBYTE;
+
+	printf("%s: %d elements, " ZBX_FS_SIZE_T " bytes\n", payload, elements, (zbx_fs_size_t)j.buffer_size);
+	printf("\tzbx_json_open()    %8.1f MB/s\n", mb / t_open);
+	printf("\tzbx_json_next()    %8.1f MB/s\n", mb / t_next);
+	printf("\tzbx_jsonobj_open() %8.1f MB/s\n", mb / t_obj);
+
+	zbx_json_free(&j);
+}
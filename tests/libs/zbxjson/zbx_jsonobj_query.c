@@ -46,13 +46,17 @@ static void	check_indefinite_path_result(zbx_mock_handle_t handle, const char *r
 	zbx_mock_assert_json_eq("Indefinite query result", expected_output, returned_output);
 }
 
-static void	test_query(zbx_jsonobj_t *obj, const char *path, int expected_ret)
+static void	test_query(zbx_jsonobj_t *obj, const char *data, const char *path, int expected_ret)
 {
 	char			*output = NULL;
 	int			returned_ret;
 	zbx_mock_handle_t	handle;
 
-	returned_ret = zbx_jsonobj_query(obj, path, &output);
+	/* query either parsed object or text data */
+	if (NULL != obj)
+		returned_ret = zbx_jsonobj_query(obj, path, &output);
+	else
+		returned_ret = zbx_jsonpath_query_data(data, path, &output);
 
 	if (FAIL == returned_ret)
 		printf("\tzbx_jsonpath_query() failed with: %s\n", zbx_json_strerror());
@@ -100,10 +104,13 @@ void	zbx_mock_test_entry(void **state)
 	path = zbx_mock_get_parameter_string("in.path");
 	expected_ret = zbx_mock_str_to_return_code(zbx_mock_get_parameter_string("out.return"));
 
-	test_query(&obj, path, expected_ret);
+	test_query(&obj, NULL, path, expected_ret);
 
 	/* query second time to check index reuse */
-	test_query(&obj, path, expected_ret);
+	test_query(&obj, NULL, path, expected_ret);
+
+	/* query without parsing data into object */
+	test_query(NULL, data, path, expected_ret);
 
 	zbx_jsonobj_clear(&obj);
 }
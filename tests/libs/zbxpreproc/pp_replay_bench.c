@@ -0,0 +1,289 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxcommon.h"
+#include "zbxregexp.h"
+#include "zbxtime.h"
+#include "libs/zbxpreproc/pp_execute.h"
+#include "libs/zbxpreproc/pp_capture.h"
+
+/* Replays values captured by preprocessing manager (PreprocessingCaptureFile) through pp_execute() */
+/* on multiple threads. Values are partitioned between threads by itemid to keep the order of item */
+/* values and item history consistent. Only the item own steps are executed, dependent items are   */
+/* not replayed. User macros in step parameters are not expanded.                                  */
+
+#define BENCH_STEP_TYPES_MAX	(ZBX_PREPROC_SNMP_GET_VALUE + 1)
+#define BENCH_BUCKETS_NUM	64
+
+typedef struct
+{
+	zbx_uint64_t	count;
+	zbx_uint64_t	total_ns;
+	zbx_uint64_t	max_ns;
+	zbx_uint64_t	buckets[BENCH_BUCKETS_NUM];	/* number of steps taking [2^n, 2^(n+1)) nanoseconds */
+}
+zbx_bench_step_stats_t;
+
+typedef struct
+{
+	pthread_t				thread;
+	zbx_vector_pp_capture_value_ptr_t	values;
+	int					iterations;
+	int					span;
+	zbx_uint64_t				allocs;
+	zbx_uint64_t				errors;
+	zbx_bench_step_stats_t			steps[BENCH_STEP_TYPES_MAX];
+}
+zbx_bench_thread_t;
+
+static ZBX_THREAD_LOCAL zbx_uint64_t	allocs;
+
+void	*__real_malloc(size_t size);
+void	*__real_calloc(size_t nmemb, size_t size);
+void	*__real_realloc(void *ptr, size_t size);
+
+void	*__wrap_malloc(size_t size);
+void	*__wrap_calloc(size_t nmemb, size_t size);
+void	*__wrap_realloc(void *ptr, size_t size);
+
+void	*__wrap_malloc(size_t size)
+{
+	allocs++;
+	return __real_malloc(size);
+}
+
+void	*__wrap_calloc(size_t nmemb, size_t size)
+{
+	allocs++;
+	return __real_calloc(nmemb, size);
+}
+
+void	*__wrap_realloc(void *ptr, size_t size)
+{
+	allocs++;
+	return __real_realloc(ptr, size);
+}
+
+static const char	*bench_step_name(int type)
+{
+	static const char	*names[BENCH_STEP_TYPES_MAX] = {"none", "multiplier", "rtrim", "ltrim", "trim",
+			"regsub", "bool2dec", "oct2dec", "hex2dec", "delta value", "delta speed", "xpath", "jsonpath",
+			"validate range", "validate regex", "validate not regex", "error field json",
+			"error field xml", "error field regex", "throttle value", "throttle timed value", "script",
+			"prometheus pattern", "prometheus to json", "csv to json", "str replace",
+			"validate not supported", "xml to json", "snmp walk value", "snmp walk to json",
+			"snmp get value"};
+
+	return names[type];
+}
+
+static void	bench_step_stats_cb(const zbx_pp_step_t *step, zbx_uint64_t time_ns, void *data)
+{
+	zbx_bench_thread_t	*thread = (zbx_bench_thread_t *)data;
+	zbx_bench_step_stats_t	*stats;
+	int			bucket = 0;
+
+	if (0 > step->type || BENCH_STEP_TYPES_MAX <= step->type)
+		return;
+
+	stats = &thread->steps[step->type];
+	stats->count++;
+	stats->total_ns += time_ns;
+
+	if (stats->max_ns < time_ns)
+		stats->max_ns = time_ns;
+
+	while (1 < time_ns >> bucket && BENCH_BUCKETS_NUM - 1 > bucket)
+		bucket++;
+
+	stats->buckets[bucket]++;
+}
+
+static void	*bench_thread_entry(void *args)
+{
+	zbx_bench_thread_t	*thread = (zbx_bench_thread_t *)args;
+	zbx_pp_context_t	ctx;
+
+	zbx_init_regexp_env();
+
+	pp_context_init(&ctx);
+	ctx.step_stats_cb = bench_step_stats_cb;
+	ctx.step_stats_data = thread;
+
+	for (int i = 0; i < thread->iterations; i++)
+	{
+		for (int j = 0; j < thread->values.values_num; j++)
+		{
+			zbx_pp_capture_value_t	*value = thread->values.values[j];
+			zbx_variant_t		value_in, value_out;
+			zbx_timespec_t		ts = value->ts;
+			zbx_uint64_t		allocs_start;
+
+			/* keep timestamps increasing for delta and throttling steps */
+			ts.sec += i * thread->span;
+			zbx_variant_copy(&value_in, &value->value);
+
+			allocs_start = allocs;
+			pp_execute(&ctx, value->preproc, NULL, NULL, &value_in, ts, NULL, &value_out, NULL, NULL);
+			thread->allocs += allocs - allocs_start;
+
+			if (ZBX_VARIANT_ERR == value_out.type)
+				thread->errors++;
+
+			zbx_variant_clear(&value_out);
+			zbx_variant_clear(&value_in);
+		}
+	}
+
+	pp_context_destroy(&ctx);
+
+	return NULL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets upper bound of the histogram bucket containing percentile    *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_uint64_t	bench_percentile(const zbx_bench_step_stats_t *stats, int percentile)
+{
+	zbx_uint64_t	rank, count = 0;
+	int		i;
+
+	rank = (stats->count * (zbx_uint64_t)percentile + 99) / 100;
+
+	for (i = 0; i < BENCH_BUCKETS_NUM - 1; i++)
+	{
+		if (rank <= (count += stats->buckets[i]))
+			break;
+	}
+
+	return MIN(__UINT64_C(2) << i, stats->max_ns);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_vector_pp_capture_value_ptr_t	values;
+	zbx_bench_thread_t			*threads;
+	zbx_bench_step_stats_t			steps[BENCH_STEP_TYPES_MAX];
+	int					threads_num, iterations, span, err;
+	zbx_uint64_t				values_num, allocs_total = 0, errors = 0;
+	char					*error = NULL;
+	double					t;
+
+	ZBX_UNUSED(state);
+
+	zbx_vector_pp_capture_value_ptr_create(&values);
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter_exists("in.file"))
+	{
+		if (SUCCEED != pp_capture_load(zbx_mock_get_parameter_string("in.file"), &values, &error))
+			fail_msg("cannot load captured values: %s", error);
+	}
+	else
+	{
+		char	*data;
+
+		data = zbx_strdup(NULL, zbx_mock_get_parameter_string("in.capture"));
+
+		if (SUCCEED != pp_capture_parse(data, &values, &error))
+			fail_msg("cannot parse captured values: %s", error);
+
+		zbx_free(data);
+	}
+
+	if (0 == values.values_num)
+		fail_msg("no captured values found");
+
+	threads_num = (int)zbx_mock_get_parameter_uint64("in.threads");
+	iterations = (int)zbx_mock_get_parameter_uint64("in.iterations");
+
+	span = values.values[values.values_num - 1]->ts.sec - values.values[0]->ts.sec + 1;
+	threads = (zbx_bench_thread_t *)zbx_calloc(NULL, (size_t)threads_num, sizeof(zbx_bench_thread_t));
+
+	for (int i = 0; i < threads_num; i++)
+	{
+		zbx_vector_pp_capture_value_ptr_create(&threads[i].values);
+		threads[i].iterations = iterations;
+		threads[i].span = MAX(span, 1);
+	}
+
+	for (int i = 0; i < values.values_num; i++)
+	{
+		zbx_bench_thread_t	*thread = &threads[values.values[i]->itemid % (zbx_uint64_t)threads_num];
+
+		zbx_vector_pp_capture_value_ptr_append(&thread->values, values.values[i]);
+	}
+
+	t = zbx_time();
+
+	for (int i = 0; i < threads_num; i++)
+	{
+		if (0 != (err = pthread_create(&threads[i].thread, NULL, bench_thread_entry, &threads[i])))
+			fail_msg("cannot create thread: %s", zbx_strerror(err));
+	}
+
+	for (int i = 0; i < threads_num; i++)
+		pthread_join(threads[i].thread, NULL);
+
+	t = zbx_time() - t;
+
+	memset(steps, 0, sizeof(steps));
+
+	for (int i = 0; i < threads_num; i++)
+	{
+		allocs_total += threads[i].allocs;
+		errors += threads[i].errors;
+
+		for (int j = 0; j < BENCH_STEP_TYPES_MAX; j++)
+		{
+			steps[j].count += threads[i].steps[j].count;
+			steps[j].total_ns += threads[i].steps[j].total_ns;
+			steps[j].max_ns = MAX(steps[j].max_ns, threads[i].steps[j].max_ns);
+
+			for (int k = 0; k < BENCH_BUCKETS_NUM; k++)
+				steps[j].buckets[k] += threads[i].steps[j].buckets[k];
+		}
+
+		zbx_vector_pp_capture_value_ptr_destroy(&threads[i].values);
+	}
+
+	values_num = (zbx_uint64_t)values.values_num * (zbx_uint64_t)iterations;
+
+	printf("%d threads, " ZBX_FS_UI64 " values, " ZBX_FS_UI64 " errors\n", threads_num, values_num, errors);
+	printf("\t%-24s %10s %10s %10s %10s %10s\n", "step", "count", "mean ns", "p50 ns", "p99 ns", "max ns");
+
+	for (int i = 0; i < BENCH_STEP_TYPES_MAX; i++)
+	{
+		if (0 == steps[i].count)
+			continue;
+
+		printf("\t%-24s %10.0f %10.0f %10.0f %10.0f %10.0f\n", bench_step_name(i), (double)steps[i].count,
+				(double)steps[i].total_ns / (double)steps[i].count,
+				(double)bench_percentile(&steps[i], 50), (double)bench_percentile(&steps[i], 99),
+				(double)steps[i].max_ns);
+	}
+
+	printf("\tallocations per value %10.1f\n", (double)allocs_total / (double)values_num);
+	printf("\tvalues per second     %10.0f\n", (double)values_num / t);
+
+	zbx_free(threads);
+	zbx_vector_pp_capture_value_ptr_clear_ext(&values, pp_capture_value_free);
+	zbx_vector_pp_capture_value_ptr_destroy(&values);
+}
@@ -0,0 +1,340 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockutil.h"
+#include "zbxmockassert.h"
+
+#include "zbxpreproc.h"
+#include "zbxpreprocbase.h"
+#include "libs/zbxpreproc/pp_queue.h"
+#include "libs/zbxpreproc/pp_task.h"
+
+#include <sched.h>
+
+/* tasks are created without user macro cache, so the handle reference counting is skipped */
+zbx_dc_um_shared_handle_t	*__wrap_zbx_dc_um_shared_handle_copy(zbx_dc_um_shared_handle_t *handle);
+void	__wrap_zbx_dc_um_shared_handle_release(zbx_dc_um_shared_handle_t *handle);
+
+zbx_dc_um_shared_handle_t	*__wrap_zbx_dc_um_shared_handle_copy(zbx_dc_um_shared_handle_t *handle)
+{
+	return handle;
+}
+
+void	__wrap_zbx_dc_um_shared_handle_release(zbx_dc_um_shared_handle_t *handle)
+{
+	ZBX_UNUSED(handle);
+}
+
+typedef struct
+{
+	zbx_pp_queue_t	*queue;
+	int		worker_index;
+	int		stop;
+	zbx_uint64_t	queued_max;	/* the largest number of queued tasks seen after popping a task */
+}
+pp_test_worker_t;
+
+static zbx_pp_task_t	*pp_test_create_task(zbx_uint64_t itemid, const char *mode, zbx_pp_item_preproc_t *preproc,
+		zbx_pp_item_preproc_t *preproc_internal)
+{
+	zbx_timespec_t	ts = {0, 0};
+
+	if (0 == strcmp(mode, "sequential"))
+		return pp_task_value_seq_create(itemid, preproc, NULL, NULL, ts, NULL, NULL);
+
+	if (0 == strcmp(mode, "internal"))
+		return pp_task_value_create(itemid, preproc_internal, NULL, NULL, ts, NULL, NULL);
+
+	return pp_task_value_create(itemid, preproc, NULL, NULL, ts, NULL, NULL);
+}
+
+static void	pp_test_free_task(zbx_pp_queue_t *queue, zbx_pp_task_t *task)
+{
+	if (ZBX_PP_TASK_SEQUENCE == task->type)
+		pp_task_queue_remove_sequence(queue, task->itemid);
+
+	pp_task_free(task);
+}
+
+static const char	*pp_test_task_type_str(zbx_pp_task_type_t type)
+{
+	switch (type)
+	{
+		case ZBX_PP_TASK_VALUE:
+			return "value";
+		case ZBX_PP_TASK_VALUE_SEQ:
+			return "value sequential";
+		case ZBX_PP_TASK_SEQUENCE:
+			return "sequence";
+		default:
+			return "other";
+	}
+}
+
+static void	pp_test_push(zbx_pp_queue_t *queue, zbx_mock_handle_t hstep, zbx_pp_item_preproc_t *preproc,
+		zbx_pp_item_preproc_t *preproc_internal)
+{
+	const char	*mode = zbx_mock_get_object_member_string(hstep, "mode");
+	zbx_pp_task_t	*task;
+
+	task = pp_test_create_task(zbx_mock_get_object_member_uint64(hstep, "itemid"), mode, preproc,
+			preproc_internal);
+
+	if (0 == strcmp(mode, "immediate"))
+		pp_task_queue_push_immediate(queue, task);
+	else
+		pp_task_queue_push(queue, task);
+}
+
+static void	pp_test_pop(zbx_pp_queue_t *queue, zbx_mock_handle_t hstep, zbx_vector_ptr_t *processing)
+{
+	zbx_mock_handle_t	hitemid;
+	zbx_pp_task_t		*task;
+
+	task = pp_task_queue_pop_new(queue, zbx_mock_get_object_member_int(hstep, "worker"));
+
+	if (ZBX_MOCK_SUCCESS != zbx_mock_object_member(hstep, "itemid", &hitemid))
+	{
+		if (NULL != task)
+			fail_msg("expected no task while task of item " ZBX_FS_UI64 " was popped", task->itemid);
+
+		return;
+	}
+
+	if (NULL == task)
+		fail_msg("expected task of item " ZBX_FS_UI64 " while no task was popped",
+				zbx_mock_get_object_member_uint64(hstep, "itemid"));
+
+	zbx_mock_assert_uint64_eq("popped task itemid", zbx_mock_get_object_member_uint64(hstep, "itemid"),
+			task->itemid);
+	zbx_mock_assert_str_eq("popped task type", zbx_mock_get_object_member_string(hstep, "type"),
+			pp_test_task_type_str(task->type));
+
+	zbx_vector_ptr_append(processing, task);
+}
+
+static void	pp_test_finish(zbx_pp_queue_t *queue, zbx_mock_handle_t hstep, zbx_vector_ptr_t *processing)
+{
+	zbx_uint64_t	itemid = zbx_mock_get_object_member_uint64(hstep, "itemid");
+	int		i, ret;
+
+	for (i = 0; i < processing->values_num; i++)
+	{
+		if (itemid == ((zbx_pp_task_t *)processing->values[i])->itemid)
+			break;
+	}
+
+	if (i == processing->values_num)
+		fail_msg("task of item " ZBX_FS_UI64 " is not being processed", itemid);
+
+	ret = pp_task_queue_push_finished(queue, (zbx_pp_task_t *)processing->values[i]);
+	zbx_vector_ptr_remove(processing, i);
+
+	zbx_mock_assert_result_eq("push finished result",
+			zbx_mock_str_to_return_code(zbx_mock_get_object_member_string(hstep, "notify")), ret);
+}
+
+static void	pp_test_pop_finished(zbx_pp_queue_t *queue, zbx_mock_handle_t hstep)
+{
+	zbx_mock_handle_t	hitemids, hitemid;
+	zbx_pp_task_t		*task;
+	zbx_uint64_t		itemid;
+
+	hitemids = zbx_mock_get_object_member_handle(hstep, "itemids");
+
+	while (ZBX_MOCK_END_OF_VECTOR != zbx_mock_vector_element(hitemids, &hitemid))
+	{
+		if (ZBX_MOCK_SUCCESS != zbx_mock_uint64(hitemid, &itemid))
+			fail_msg("invalid finished task itemid");
+
+		if (NULL == (task = pp_task_queue_pop_finished(queue)))
+			fail_msg("expected finished task of item " ZBX_FS_UI64 " while there were none", itemid);
+
+		zbx_mock_assert_uint64_eq("finished task itemid", itemid, task->itemid);
+		pp_test_free_task(queue, task);
+	}
+
+	if (NULL != (task = pp_task_queue_pop_finished(queue)))
+		fail_msg("unexpected finished task of item " ZBX_FS_UI64, task->itemid);
+}
+
+static void	pp_test_check(zbx_pp_queue_t *queue, zbx_mock_handle_t hstep)
+{
+	zbx_uint64_t	pending_num, processing_num, finished_num;
+
+	pp_task_queue_get_stats(queue, &pending_num, &processing_num, &finished_num);
+
+	zbx_mock_assert_uint64_eq("pending tasks", zbx_mock_get_object_member_uint64(hstep, "pending"), pending_num);
+	zbx_mock_assert_uint64_eq("processing tasks", zbx_mock_get_object_member_uint64(hstep, "processing"),
+			processing_num);
+	zbx_mock_assert_uint64_eq("finished tasks", zbx_mock_get_object_member_uint64(hstep, "finished"),
+			finished_num);
+	zbx_mock_assert_uint64_eq("queued tasks", zbx_mock_get_object_member_uint64(hstep, "queued"),
+			queue->queued_num);
+}
+
+static void	*pp_test_worker_entry(void *arg)
+{
+	pp_test_worker_t	*worker = (pp_test_worker_t *)arg;
+	zbx_pp_task_t		*task;
+	zbx_uint64_t		queued_num;
+
+	while (0 == __atomic_load_n(&worker->stop, __ATOMIC_ACQUIRE))
+	{
+		if (NULL == (task = pp_task_queue_pop_new(worker->queue, worker->worker_index)))
+		{
+			sched_yield();
+			continue;
+		}
+
+		/* queued task counter wraps around if a task is popped before it is counted */
+		if (worker->queued_max < (queued_num = __atomic_load_n(&worker->queue->queued_num, __ATOMIC_RELAXED)))
+			worker->queued_max = queued_num;
+
+		(void)pp_task_queue_push_finished(worker->queue, task);
+	}
+
+	return NULL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: push tasks while worker threads pop them from their own queues    *
+ *          and steal from the queues that have no worker thread              *
+ *                                                                            *
+ ******************************************************************************/
+static void	pp_test_stress(zbx_pp_queue_t *queue, zbx_mock_handle_t hstep, zbx_pp_item_preproc_t *preproc,
+		zbx_pp_item_preproc_t *preproc_internal)
+{
+	int			threads_num = zbx_mock_get_object_member_int(hstep, "threads"),
+				tasks_num = zbx_mock_get_object_member_int(hstep, "tasks"), finished = 0, err;
+	pp_test_worker_t	*workers;
+	pthread_t		*threads;
+	unsigned char		*seen;
+	zbx_pp_task_t		*task;
+
+	workers = (pp_test_worker_t *)zbx_malloc(NULL, sizeof(pp_test_worker_t) * (size_t)threads_num);
+	threads = (pthread_t *)zbx_malloc(NULL, sizeof(pthread_t) * (size_t)threads_num);
+	seen = (unsigned char *)zbx_calloc(NULL, (size_t)tasks_num + 1, sizeof(unsigned char));
+
+	for (int i = 0; i < threads_num; i++)
+	{
+		workers[i].queue = queue;
+		workers[i].worker_index = i;
+		workers[i].stop = 0;
+		workers[i].queued_max = 0;
+
+		if (0 != (err = pthread_create(&threads[i], NULL, pp_test_worker_entry, &workers[i])))
+			fail_msg("cannot create worker thread: %s", zbx_strerror(err));
+	}
+
+	for (int i = 1; i <= tasks_num || finished < tasks_num;)
+	{
+		if (i <= tasks_num)
+		{
+			/* every third task is internal and goes to the immediate list of its worker queue */
+			pp_task_queue_push(queue, pp_test_create_task((zbx_uint64_t)i, 0 == i % 3 ? "internal" :
+					"normal", preproc, preproc_internal));
+			i++;
+		}
+		else
+			sched_yield();
+
+		while (NULL != (task = pp_task_queue_pop_finished(queue)))
+		{
+			if (0 != seen[task->itemid]++)
+				fail_msg("task of item " ZBX_FS_UI64 " was processed more than once", task->itemid);
+
+			finished++;
+			pp_test_free_task(queue, task);
+		}
+	}
+
+	for (int i = 0; i < threads_num; i++)
+	{
+		__atomic_store_n(&workers[i].stop, 1, __ATOMIC_RELEASE);
+		pthread_join(threads[i], NULL);
+
+		if ((zbx_uint64_t)tasks_num < workers[i].queued_max)
+		{
+			fail_msg("worker %d has seen " ZBX_FS_UI64 " queued tasks while only %d were pushed", i,
+					workers[i].queued_max, tasks_num);
+		}
+	}
+
+	for (int i = 1; i <= tasks_num; i++)
+	{
+		if (1 != seen[i])
+			fail_msg("task of item %d was not processed", i);
+	}
+
+	zbx_free(seen);
+	zbx_free(threads);
+	zbx_free(workers);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_pp_queue_t		queue;
+	zbx_pp_item_preproc_t	*preproc, *preproc_internal;
+	zbx_mock_handle_t	hsteps, hstep;
+	zbx_vector_ptr_t	processing;
+	char			*error = NULL;
+
+	ZBX_UNUSED(state);
+
+	memset(&queue, 0, sizeof(queue));
+
+	if (SUCCEED != pp_task_queue_init(&queue, zbx_mock_get_parameter_int("in.workers"), &error))
+		fail_msg("cannot initialize task queue: %s", error);
+
+	preproc = zbx_pp_item_preproc_create(1, ITEM_TYPE_ZABBIX, ITEM_VALUE_TYPE_UINT64, 0);
+	preproc_internal = zbx_pp_item_preproc_create(1, ITEM_TYPE_INTERNAL, ITEM_VALUE_TYPE_UINT64, 0);
+
+	zbx_vector_ptr_create(&processing);
+
+	hsteps = zbx_mock_get_parameter_handle("in.steps");
+
+	while (ZBX_MOCK_END_OF_VECTOR != zbx_mock_vector_element(hsteps, &hstep))
+	{
+		const char	*op = zbx_mock_get_object_member_string(hstep, "op");
+
+		if (0 == strcmp(op, "push"))
+			pp_test_push(&queue, hstep, preproc, preproc_internal);
+		else if (0 == strcmp(op, "pop"))
+			pp_test_pop(&queue, hstep, &processing);
+		else if (0 == strcmp(op, "finish"))
+			pp_test_finish(&queue, hstep, &processing);
+		else if (0 == strcmp(op, "finished"))
+			pp_test_pop_finished(&queue, hstep);
+		else if (0 == strcmp(op, "check"))
+			pp_test_check(&queue, hstep);
+		else if (0 == strcmp(op, "stress"))
+			pp_test_stress(&queue, hstep, preproc, preproc_internal);
+		else
+			fail_msg("unknown step operation: %s", op);
+	}
+
+	for (int i = 0; i < processing.values_num; i++)
+		pp_test_free_task(&queue, (zbx_pp_task_t *)processing.values[i]);
+
+	zbx_vector_ptr_destroy(&processing);
+
+	pp_task_queue_destroy(&queue);
+
+	zbx_pp_item_preproc_release(preproc_internal);
+	zbx_pp_item_preproc_release(preproc);
+}
@@ -0,0 +1,78 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockutil.h"
+#include "zbxmockassert.h"
+
+#include "zbxembed.h"
+#include "libs/zbxembed/embed.h"
+
+/******************************************************************************
+ *                                                                            *
+ * Comments: The executed scripts count their runs in a property of the      *
+ *           function object (arguments.callee), so the returned run number   *
+ *           shows whether the state of previous executions is visible to the *
+ *           next execution, while cached function count shows whether the    *
+ *           function loaded by previous execution was reused.                *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_es_t		es;
+	zbx_mock_handle_t	hsteps, hstep;
+	char			*error = NULL, *code, *result;
+	int			size;
+
+	ZBX_UNUSED(state);
+
+	zbx_es_init(&es);
+
+	if (SUCCEED != zbx_es_init_env(&es, NULL, &error))
+		fail_msg("cannot initialize scripting environment: %s", error);
+
+	hsteps = zbx_mock_get_parameter_handle("in.steps");
+
+	while (ZBX_MOCK_END_OF_VECTOR != zbx_mock_vector_element(hsteps, &hstep))
+	{
+		const char	*script = zbx_mock_get_object_member_string(hstep, "script");
+
+		code = NULL;
+		result = NULL;
+
+		if (SUCCEED != zbx_es_compile(&es, script, &code, &size, &error))
+			fail_msg("cannot compile script: %s", error);
+
+		if (SUCCEED != zbx_es_execute(&es, NULL, code, size, zbx_mock_get_object_member_string(hstep, "param"),
+				&result, &error))
+		{
+			fail_msg("cannot execute script: %s", error);
+		}
+
+		zbx_mock_assert_str_eq("script result", zbx_mock_get_object_member_string(hstep, "result"), result);
+		zbx_mock_assert_int_eq("cached scripts", zbx_mock_get_object_member_int(hstep, "scripts"),
+				es.env->scripts.num_data);
+		zbx_mock_assert_int_eq("cached functions", zbx_mock_get_object_member_int(hstep, "functions"),
+				es.env->functions.num_data);
+
+		zbx_free(result);
+		zbx_free(code);
+	}
+
+	if (SUCCEED != zbx_es_destroy_env(&es, &error))
+		fail_msg("cannot destroy scripting environment: %s", error);
+
+	zbx_es_destroy(&es);
+}
@@ -0,0 +1,73 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxregexp.h"
+#include "../../../src/libs/zbxregexp/regexp_ac.h"
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_mock_handle_t	hliterals, hliteral, hfound, hflag;
+	zbx_regexp_ac_t		ac;
+	zbx_vector_int32_t	ids;
+	unsigned char		*found;
+	int			i, expected;
+	char			buf[32];
+
+	ZBX_UNUSED(state);
+
+	zbx_vector_int32_create(&ids);
+	regexp_ac_init(&ac);
+
+	hliterals = zbx_mock_get_parameter_handle("in.literals");
+
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hliterals, &hliteral))
+	{
+		const char	*value = zbx_mock_get_object_member_string(hliteral, "value");
+
+		zbx_vector_int32_append(&ids, regexp_ac_add(&ac, value, strlen(value),
+				zbx_mock_get_object_member_int(hliteral, "case_sensitive")));
+	}
+
+	regexp_ac_compile(&ac);
+
+	found = (unsigned char *)zbx_calloc(NULL, (size_t)MAX(1, ac.literals_num), sizeof(unsigned char));
+	regexp_ac_scan(&ac, zbx_mock_get_parameter_string("in.text"), found);
+
+	zbx_mock_assert_int_eq("automaton use", zbx_mock_get_parameter_int("out.direct"), ac.direct);
+
+	hfound = zbx_mock_get_parameter_handle("out.found");
+
+	for (i = 0; ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hfound, &hflag); i++)
+	{
+		if (i == ids.values_num)
+			fail_msg("too many expected results");
+
+		if (ZBX_MOCK_SUCCESS != zbx_mock_int(hflag, &expected))
+			fail_msg("cannot read expected result");
+
+		zbx_snprintf(buf, sizeof(buf), "literal #%d", i + 1);
+		zbx_mock_assert_int_eq(buf, expected, found[ids.values[i]]);
+	}
+
+	zbx_mock_assert_int_eq("number of results", ids.values_num, i);
+
+	zbx_free(found);
+	regexp_ac_destroy(&ac);
+	zbx_vector_int32_destroy(&ids);
+}
@@ -0,0 +1,111 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxregexp.h"
+
+/* compiled regexps are compared by address, the references held by test keep the addresses unique */
+static zbx_regexp_t	*find_last_regexp(const zbx_vector_ptr_t *regexps, const zbx_vector_str_t *patterns,
+		const char *pattern)
+{
+	for (int i = patterns->values_num - 1; 0 <= i; i--)
+	{
+		if (0 == strcmp(patterns->values[i], pattern))
+			return (zbx_regexp_t *)regexps->values[i];
+	}
+
+	return NULL;
+}
+
+static void	fill_cache(int num, int *fill_index)
+{
+	for (int i = 0; i < num; i++)
+	{
+		char		pattern[32], *error = NULL;
+		zbx_regexp_t	*regexp;
+
+		zbx_snprintf(pattern, sizeof(pattern), "fill%d", (*fill_index)++);
+
+		if (SUCCEED != zbx_regexp_compile(pattern, &regexp, &error))
+			fail_msg("cannot compile pattern \"%s\": %s", pattern, error);
+
+		zbx_regexp_free(regexp);
+	}
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_mock_handle_t	hsteps, hstep, hfill;
+	zbx_vector_ptr_t	regexps;
+	zbx_vector_str_t	patterns;
+	const char		*value;
+	int			i, fill_index = 0;
+
+	ZBX_UNUSED(state);
+
+	zbx_vector_ptr_create(&regexps);
+	zbx_vector_str_create(&patterns);
+
+	/* start with empty cache of the calling thread */
+	zbx_regexp_cache_clear();
+
+	hsteps = zbx_mock_get_parameter_handle("in.steps");
+	value = zbx_mock_get_parameter_string("in.value");
+
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hsteps, &hstep))
+	{
+		const char	*pattern;
+		zbx_regexp_t	*regexp, *regexp_last;
+		char		*error = NULL;
+		int		cached;
+
+		/* fill the cache with unique patterns not referenced by test */
+		if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hstep, "fill", &hfill))
+		{
+			fill_cache(zbx_mock_get_object_member_int(hstep, "fill"), &fill_index);
+			continue;
+		}
+
+		pattern = zbx_mock_get_object_member_string(hstep, "pattern");
+		regexp_last = find_last_regexp(&regexps, &patterns, pattern);
+
+		if (SUCCEED != zbx_regexp_compile(pattern, &regexp, &error))
+			fail_msg("cannot compile pattern \"%s\": %s", pattern, error);
+
+		cached = (NULL != regexp_last && regexp_last == regexp ? SUCCEED : FAIL);
+
+		zbx_mock_assert_result_eq(pattern, zbx_mock_str_to_return_code(
+				zbx_mock_get_object_member_string(hstep, "cached")), cached);
+
+		zbx_vector_ptr_append(&regexps, regexp);
+		zbx_vector_str_append(&patterns, (char *)pattern);
+	}
+
+	/* regexps referenced by caller must survive cache cleanup */
+	zbx_regexp_cache_clear();
+
+	for (i = 0; i < regexps.values_num; i++)
+	{
+		zbx_mock_assert_int_eq("match result", 0,
+				zbx_regexp_match_precompiled(value, (zbx_regexp_t *)regexps.values[i]));
+		zbx_regexp_free((zbx_regexp_t *)regexps.values[i]);
+	}
+
+	zbx_vector_str_destroy(&patterns);
+	zbx_vector_ptr_destroy(&regexps);
+}
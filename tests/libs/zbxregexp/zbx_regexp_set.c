@@ -0,0 +1,90 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxregexp.h"
+
+/* the regexp set must return the same results as zbx_regexp_match_ex() and zbx_regexp_sub_ex2() */
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_mock_handle_t		hregexps, hregexp, hstrings, hstring;
+	zbx_vector_expression_t		regexps;
+	zbx_regexp_set_t		*set;
+	const char			*pattern, *output_template = NULL;
+	int				case_sensitive;
+
+	ZBX_UNUSED(state);
+
+	zbx_vector_expression_create(&regexps);
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter_exists("in.regexps"))
+	{
+		hregexps = zbx_mock_get_parameter_handle("in.regexps");
+
+		while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hregexps, &hregexp))
+		{
+			const char	*delimiter = zbx_mock_get_object_member_string(hregexp, "delimiter");
+
+			zbx_add_regexp_ex(&regexps, zbx_mock_get_object_member_string(hregexp, "name"),
+					zbx_mock_get_object_member_string(hregexp, "expression"),
+					zbx_mock_get_object_member_int(hregexp, "type"), *delimiter,
+					zbx_mock_get_object_member_int(hregexp, "case_sensitive"));
+		}
+	}
+
+	pattern = zbx_mock_get_parameter_string("in.pattern");
+	case_sensitive = zbx_mock_get_parameter_int("in.case_sensitive");
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter_exists("in.template"))
+		output_template = zbx_mock_get_parameter_string("in.template");
+
+	set = zbx_regexp_set_create(&regexps, pattern, case_sensitive);
+
+	hstrings = zbx_mock_get_parameter_handle("in.strings");
+
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hstrings, &hstring))
+	{
+		const char	*value = zbx_mock_get_object_member_string(hstring, "value");
+		int		expected = zbx_mock_get_object_member_int(hstring, "result"), ret;
+		char		*output = NULL, *output_set = NULL, *error = NULL, *error_set = NULL;
+
+		ret = zbx_regexp_match_ex(&regexps, value, pattern, case_sensitive);
+		zbx_mock_assert_int_eq(value, expected, ret);
+		zbx_mock_assert_int_eq(value, ret, zbx_regexp_set_match(set, value));
+
+		ret = zbx_regexp_sub_ex2(&regexps, value, pattern, case_sensitive, output_template, &output, &error);
+		zbx_mock_assert_int_eq(value, ret, zbx_regexp_set_sub(set, value, output_template, &output_set,
+				&error_set));
+
+		if (NULL != output || NULL != output_set)
+		{
+			zbx_mock_assert_ptr_ne(value, NULL, output_set);
+			zbx_mock_assert_ptr_ne(value, NULL, output);
+			zbx_mock_assert_str_eq(value, output, output_set);
+		}
+
+		zbx_free(output);
+		zbx_free(output_set);
+		zbx_free(error);
+		zbx_free(error_set);
+	}
+
+	zbx_regexp_set_free(set);
+	zbx_regexp_clean_expressions(&regexps);
+	zbx_vector_expression_destroy(&regexps);
+}
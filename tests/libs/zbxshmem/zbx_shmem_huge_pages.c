@@ -0,0 +1,144 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockutil.h"
+#include "zbxmockassert.h"
+
+#include "zbxshmem.h"
+#include "zbxalgo.h"
+#include "zbxstr.h"
+
+#include <sys/shm.h>
+
+#if defined(SHM_HUGETLB) && !defined(SHM_HUGE_SHIFT)
+#	define SHM_HUGE_SHIFT	26
+#endif
+
+/* segment sizes requested from shmget(), huge page requests are stored with the page size */
+static zbx_vector_uint64_pair_t	requests;
+static int			huge_pages_fail;
+static char			*warning_last;
+
+int	__real_shmget(key_t key, size_t size, int shmflg);
+int	__wrap_shmget(key_t key, size_t size, int shmflg);
+void	__real_zbx_mock_log_impl(int level, const char *fmt, va_list args);
+void	__wrap_zbx_mock_log_impl(int level, const char *fmt, va_list args);
+
+/* huge pages are emulated with normal pages, so the test does not depend on reserved huge pages */
+int	__wrap_shmget(key_t key, size_t size, int shmflg)
+{
+	zbx_uint64_pair_t	request = {size, 0};
+
+#if defined(SHM_HUGETLB)
+	if (0 != (shmflg & SHM_HUGETLB))
+	{
+		request.second = __UINT64_C(1) << (((unsigned int)shmflg >> SHM_HUGE_SHIFT) & 0x3f);
+		zbx_vector_uint64_pair_append(&requests, request);
+
+		if (0 != huge_pages_fail)
+		{
+			errno = ENOMEM;
+			return -1;
+		}
+
+		return __real_shmget(key, size, shmflg & 0777);
+	}
+#endif
+	zbx_vector_uint64_pair_append(&requests, request);
+
+	return __real_shmget(key, size, shmflg);
+}
+
+void	__wrap_zbx_mock_log_impl(int level, const char *fmt, va_list args)
+{
+	va_list	args_copy;
+
+	if (LOG_LEVEL_WARNING == level)
+	{
+		va_copy(args_copy, args);
+		zbx_free(warning_last);
+		warning_last = zbx_dvsprintf(NULL, fmt, args_copy);
+		va_end(args_copy);
+	}
+
+	__real_zbx_mock_log_impl(level, fmt, args);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+#if defined(SHM_HUGETLB)
+	zbx_shmem_info_t	*info = NULL;
+	zbx_mock_handle_t	hrequests, hrequest;
+	char			*error = NULL;
+	int			i = 0;
+	zbx_uint64_t		page_size;
+	const char		*warning;
+
+	ZBX_UNUSED(state);
+
+	zbx_vector_uint64_pair_create(&requests);
+
+	huge_pages_fail = (SUCCEED != zbx_mock_str_to_return_code(zbx_mock_get_parameter_string("in.huge_pages")));
+	zbx_shmem_set_huge_page_size(zbx_mock_get_parameter_uint64("in.huge_page_size"));
+
+	if (SUCCEED != zbx_shmem_create(&info, zbx_mock_get_parameter_uint64("in.size"), "test segment",
+			"TestSize", 0, &error))
+	{
+		fail_msg("cannot create shared memory: %s", error);
+	}
+
+	zbx_mock_assert_uint64_eq("segment size", zbx_mock_get_parameter_uint64("out.size"), info->orig_size);
+
+	if (0 == (page_size = zbx_mock_get_parameter_uint64("out.page_size")))
+		page_size = (zbx_uint64_t)sysconf(_SC_PAGESIZE);
+
+	zbx_mock_assert_uint64_eq("page size", page_size, info->page_size);
+
+	hrequests = zbx_mock_get_parameter_handle("out.requests");
+
+	while (ZBX_MOCK_END_OF_VECTOR != zbx_mock_vector_element(hrequests, &hrequest))
+	{
+		if (i >= requests.values_num)
+			fail_msg("expected more than %d shmget() calls", requests.values_num);
+
+		zbx_mock_assert_uint64_eq("requested size", zbx_mock_get_object_member_uint64(hrequest, "size"),
+				requests.values[i].first);
+		zbx_mock_assert_uint64_eq("requested huge page size",
+				zbx_mock_get_object_member_uint64(hrequest, "huge_page_size"), requests.values[i].second);
+		i++;
+	}
+
+	zbx_mock_assert_int_eq("shmget() calls", i, requests.values_num);
+
+	warning = zbx_mock_get_parameter_string("out.warning");
+
+	if ('\0' == *warning)
+	{
+		if (NULL != warning_last)
+			fail_msg("unexpected warning \"%s\"", warning_last);
+	}
+	else if (NULL == warning_last || NULL == strstr(warning_last, warning))
+		fail_msg("expected warning \"%s\", got \"%s\"", warning, ZBX_NULL2STR(warning_last));
+
+	zbx_shmem_destroy(info);
+	zbx_vector_uint64_pair_destroy(&requests);
+	zbx_free(warning_last);
+#else
+	ZBX_UNUSED(state);
+
+	skip();
+#endif
+}
@@ -0,0 +1,257 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockutil.h"
+#include "zbxmockassert.h"
+
+#include "zbxshmem.h"
+#include "zbxalgo.h"
+
+typedef struct
+{
+	zbx_shmem_info_t	*info;
+
+	/* allocated memory, freed elements are set to NULL */
+	zbx_vector_ptr_t	ptrs;
+
+	/* the last freed memory */
+	void			*freed;
+}
+zbx_slab_test_t;
+
+static int	slab_test_get_flag(zbx_mock_handle_t hstep, const char *name)
+{
+	zbx_mock_handle_t	hflag;
+	const char		*value;
+
+	if (ZBX_MOCK_SUCCESS != zbx_mock_object_member(hstep, name, &hflag))
+		return FAIL;
+
+	if (ZBX_MOCK_SUCCESS != zbx_mock_string(hflag, &value))
+		fail_msg("invalid step parameter \"%s\"", name);
+
+	return 0 == strcmp(value, "yes") ? SUCCEED : FAIL;
+}
+
+static void	slab_test_alloc(zbx_slab_test_t *st, zbx_mock_handle_t hstep)
+{
+	zbx_mock_handle_t	hcount;
+	size_t			size;
+	int			i, count = 1;
+
+	size = (size_t)zbx_mock_get_object_member_uint64(hstep, "size");
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hstep, "count", &hcount))
+		count = zbx_mock_get_object_member_int(hstep, "count");
+
+	for (i = 0; i < count; i++)
+	{
+		void	*ptr;
+
+		ptr = zbx_shmem_malloc(st->info, NULL, size);
+		zbx_mock_assert_ptr_ne("allocated memory", NULL, ptr);
+		zbx_mock_assert_int_eq("memory alignment", 0, (int)((uintptr_t)ptr & 7));
+
+		/* the whole requested size must be usable */
+		memset(ptr, 0xa5, size);
+
+		zbx_vector_ptr_append(&st->ptrs, ptr);
+	}
+
+	if (SUCCEED == slab_test_get_flag(hstep, "reuse"))
+		zbx_mock_assert_ptr_eq("reused memory", st->freed, st->ptrs.values[st->ptrs.values_num - 1]);
+}
+
+static void	slab_test_free(zbx_slab_test_t *st, zbx_mock_handle_t hstep)
+{
+	int	index;
+
+	index = zbx_mock_get_object_member_int(hstep, "index");
+
+	if (0 > index)
+		index += st->ptrs.values_num;
+
+	if (0 > index || index >= st->ptrs.values_num || NULL == st->ptrs.values[index])
+		fail_msg("invalid free index %d", index);
+
+	st->freed = st->ptrs.values[index];
+	zbx_shmem_free(st->info, st->ptrs.values[index]);
+}
+
+static void	slab_test_free_range(zbx_slab_test_t *st, zbx_mock_handle_t hstep)
+{
+	int	i, from, to;
+
+	from = zbx_mock_get_object_member_int(hstep, "from");
+	to = zbx_mock_get_object_member_int(hstep, "to");
+
+	for (i = from; i <= to; i++)
+	{
+		if (NULL != st->ptrs.values[i])
+			zbx_shmem_free(st->info, st->ptrs.values[i]);
+	}
+}
+
+static void	slab_test_realloc(zbx_slab_test_t *st, zbx_mock_handle_t hstep)
+{
+	int		index;
+	size_t		size;
+	void		*ptr, *old;
+	unsigned char	*data;
+
+	index = zbx_mock_get_object_member_int(hstep, "index");
+	size = (size_t)zbx_mock_get_object_member_uint64(hstep, "size");
+
+	old = st->ptrs.values[index];
+	ptr = zbx_shmem_realloc(st->info, old, size);
+	zbx_mock_assert_ptr_ne("reallocated memory", NULL, ptr);
+
+	if (SUCCEED == slab_test_get_flag(hstep, "moved"))
+		zbx_mock_assert_ptr_ne("reallocated memory", old, ptr);
+	else
+		zbx_mock_assert_ptr_eq("reallocated memory", old, ptr);
+
+	/* the contents must be preserved up to the smaller size, allocations are filled with 0xa5 */
+	data = (unsigned char *)ptr;
+	zbx_mock_assert_int_eq("reallocated memory contents", 0xa5, data[0]);
+
+	st->ptrs.values[index] = ptr;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: allocates memory from chunks leaving only the specified amount    *
+ *          of free memory                                                    *
+ *                                                                            *
+ ******************************************************************************/
+static void	slab_test_fill(zbx_slab_test_t *st, zbx_mock_handle_t hstep)
+{
+	zbx_shmem_stats_t	stats;
+	zbx_uint64_t		leave;
+	void			*ptr;
+
+	leave = zbx_mock_get_object_member_uint64(hstep, "leave");
+
+	zbx_shmem_get_stats(st->info, &stats);
+
+	if (stats.free_size <= leave + 16)
+		fail_msg("cannot leave " ZBX_FS_UI64 " bytes of free memory", leave);
+
+	/* the chunk takes two 8 byte size fields in addition to the allocated size */
+	ptr = zbx_shmem_malloc(st->info, NULL, (size_t)(stats.free_size - leave - 16));
+	zbx_mock_assert_ptr_ne("allocated memory", NULL, ptr);
+	zbx_vector_ptr_append(&st->ptrs, ptr);
+}
+
+static void	slab_test_check(zbx_slab_test_t *st, zbx_mock_handle_t hstep)
+{
+	zbx_shmem_stats_t		stats;
+	zbx_mock_handle_t		hclasses, hclass, hvalue;
+	zbx_mock_error_t		err;
+	const zbx_shmem_slab_stats_t	*slab;
+	int				i;
+
+	zbx_shmem_get_stats(st->info, &stats);
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hstep, "used chunks", &hvalue))
+	{
+		zbx_mock_assert_int_eq("used chunks", zbx_mock_get_object_member_int(hstep, "used chunks"),
+				(int)stats.used_chunks);
+	}
+
+	hclasses = zbx_mock_get_object_member_handle(hstep, "slabs");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = zbx_mock_vector_element(hclasses, &hclass)))
+	{
+		zbx_uint64_t	object_size;
+
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("cannot read slab class: %s", zbx_mock_error_string(err));
+
+		object_size = zbx_mock_get_object_member_uint64(hclass, "object size");
+
+		for (i = 0, slab = NULL; i < ZBX_SHMEM_SLAB_CLASS_COUNT; i++)
+		{
+			if (object_size == stats.slabs[i].object_size)
+				slab = &stats.slabs[i];
+		}
+
+		if (NULL == slab)
+			fail_msg("unknown slab object size " ZBX_FS_UI64, object_size);
+
+		zbx_mock_assert_int_eq("slabs", zbx_mock_get_object_member_int(hclass, "slabs"), (int)slab->slabs_num);
+		zbx_mock_assert_int_eq("used objects", zbx_mock_get_object_member_int(hclass, "used"),
+				(int)slab->objects_used);
+		zbx_mock_assert_int_eq("free objects", zbx_mock_get_object_member_int(hclass, "free"),
+				(int)slab->objects_free);
+	}
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_slab_test_t		st;
+	zbx_mock_handle_t	hsteps, hstep;
+	zbx_mock_error_t	err;
+	char			*error = NULL;
+	int			i;
+
+	ZBX_UNUSED(state);
+
+	if (SUCCEED != zbx_shmem_create(&st.info, zbx_mock_get_parameter_uint64("in.size"), "slab test",
+			"SlabTestSize", 1, &error))
+	{
+		fail_msg("cannot create shared memory: %s", error);
+	}
+
+	zbx_vector_ptr_create(&st.ptrs);
+	st.freed = NULL;
+
+	hsteps = zbx_mock_get_parameter_handle("in.steps");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = zbx_mock_vector_element(hsteps, &hstep)))
+	{
+		const char	*op;
+
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("cannot read step: %s", zbx_mock_error_string(err));
+
+		op = zbx_mock_get_object_member_string(hstep, "op");
+
+		if (0 == strcmp(op, "alloc"))
+			slab_test_alloc(&st, hstep);
+		else if (0 == strcmp(op, "free"))
+			slab_test_free(&st, hstep);
+		else if (0 == strcmp(op, "free range"))
+			slab_test_free_range(&st, hstep);
+		else if (0 == strcmp(op, "realloc"))
+			slab_test_realloc(&st, hstep);
+		else if (0 == strcmp(op, "fill"))
+			slab_test_fill(&st, hstep);
+		else if (0 == strcmp(op, "check"))
+			slab_test_check(&st, hstep);
+		else
+			fail_msg("unknown step operation \"%s\"", op);
+	}
+
+	for (i = 0; i < st.ptrs.values_num; i++)
+	{
+		if (NULL != st.ptrs.values[i])
+			zbx_shmem_free(st.info, st.ptrs.values[i]);
+	}
+
+	zbx_vector_ptr_destroy(&st.ptrs);
+	zbx_shmem_destroy(st.info);
+}
@@ -49,6 +49,8 @@ void	__wrap___zbx_shmem_free(const char *file, int line, zbx_shmem_info_t *info,
 void	__wrap_zbx_shmem_dump_stats(int level, zbx_shmem_info_t *info);
 int	__wrap_zbx_history_get_values(zbx_uint64_t itemid, int value_type, int start, int count, int end,
 		zbx_vector_history_record_t *values);
+int	__wrap_zbx_history_get_values_multi(const zbx_uint64_t *itemids, int itemids_num, int value_type, int start,
+		int count, int end, zbx_vector_history_record_t *values);
 int	__wrap_zbx_history_add_values(const zbx_vector_ptr_t *history);
 void	__wrap_zbx_history_sql_init(zbx_history_iface_t *hist, unsigned char value_type);
 int	__wrap_zbx_history_elastic_init(zbx_history_iface_t *hist, unsigned char value_type, int config_log_slow_queries, char **error);
@@ -482,6 +484,8 @@ zbx_shmem_info_t		*vc_meminfo = NULL;
 
 static size_t		vcmock_mem = ZBX_MEBIBYTE * 1024;
 
+static zbx_vcmock_history_cb_t	vcmock_history_multi_cb = NULL;
+
 int	__wrap_zbx_mutex_create(zbx_mutex_t *mutex, zbx_mutex_name_t name, char **error)
 {
 	vc_mutex = mutex;
@@ -615,6 +619,35 @@ int	__wrap_zbx_history_get_values(zbx_uint64_t itemid, int value_type, int start
 	return SUCCEED;
 }
 
+int	__wrap_zbx_history_get_values_multi(const zbx_uint64_t *itemids, int itemids_num, int value_type, int start,
+		int count, int end, zbx_vector_history_record_t *values)
+{
+	int	i, j;
+
+	if (NULL != vcmock_history_multi_cb)
+		vcmock_history_multi_cb();
+
+	for (i = 0; i < itemids_num; i++)
+	{
+		__wrap_zbx_history_get_values(itemids[i], value_type, start, 0, end, &values[i]);
+
+		if (0 == count || count >= values[i].values_num)
+			continue;
+
+		/* keep whole seconds of the last count values, like the SQL backend does */
+		for (j = count; j < values[i].values_num; j++)
+		{
+			if (values[i].values[j].timestamp.sec != values[i].values[count - 1].timestamp.sec)
+				break;
+		}
+
+		while (j < values[i].values_num)
+			zbx_history_record_clear(&values[i].values[--values[i].values_num], value_type);
+	}
+
+	return SUCCEED;
+}
+
 int	__wrap_zbx_history_add_values(const zbx_vector_ptr_t *history)
 {
 	int			i;
@@ -686,6 +719,18 @@ void	zbx_vcmock_set_available_mem(size_t size)
 	vcmock_mem = size;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: sets callback to be called before reading values of multiple      *
+ *          items, allowing to change cache contents between the prefetch     *
+ *          request collection and caching of the read values                 *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_vcmock_set_history_multi_cb(zbx_vcmock_history_cb_t cb)
+{
+	vcmock_history_multi_cb = cb;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose:  retrieves the memory available in the wrapped memory allocator   *
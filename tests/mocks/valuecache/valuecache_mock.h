@@ -42,6 +42,10 @@ void	zbx_vcmock_read_values(zbx_mock_handle_t hdata, unsigned char value_type, z
 void	zbx_vcmock_check_records(const char *prefix, unsigned char value_type,
 		const zbx_vector_history_record_t *expected_values, const zbx_vector_history_record_t *returned_values);
 
+typedef void	(*zbx_vcmock_history_cb_t)(void);
+
+void	zbx_vcmock_set_history_multi_cb(zbx_vcmock_history_cb_t cb);
+
 void	zbx_vcmock_set_available_mem(size_t size);
 size_t	zbx_vcmock_get_available_mem(void);
 
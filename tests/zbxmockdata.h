@@ -73,5 +73,6 @@ zbx_mock_error_t	zbx_timespec_to_strtime(const zbx_timespec_t *ts, char *buffer,
 
 /* miscelanious functions */
 void	zbx_set_fopen_mock_callback(FILE *(*fopen_callback)(const char *, const char *));
+void	zbx_set_open_mock_callback(int (*open_callback)(const char *, int, int));
 
 #endif	/* ZABBIX_MOCK_DATA_H */
@@ -23,12 +23,16 @@
 #define zbx_db_execute_multiple_query	__wrap_zbx_db_execute_multiple_query
 #define zbx_db_begin			__wrap_zbx_db_begin
 #define zbx_db_commit			__wrap_zbx_db_commit
+#define zbx_db_select_prepared		__wrap_zbx_db_select_prepared
 #include "zbxdb.h"
 #undef zbx_db_vselect
 #undef zbx_db_execute
 #undef zbx_db_execute_multiple_query
 #undef zbx_db_begin
 #undef zbx_db_commit
+#undef zbx_db_select_prepared
+
+#include "zbxdbschema.h"
 
 #define ZBX_MOCK_DB_RESULT_COLUMNS_MAX	128
 
@@ -42,6 +46,7 @@ zbx_mockdb_query_t;
 typedef struct
 {
 	zbx_hashset_t	queries;
+	char		*last_query;	/* the last selected query */
 }
 zbx_mockdb_t;
 
@@ -148,7 +153,8 @@ zbx_db_result_t	__wrap_zbx_db_vselect(const char *fmt, va_list args)
 	if (NULL == (query_local.data_source = generate_data_source(sql)))
 		fail_msg("Cannot generate data source string from SQL query: %s", sql);
 
-	zbx_free(sql);
+	zbx_free(mockdb.last_query);
+	mockdb.last_query = sql;
 
 	if (NULL == (query = zbx_hashset_search(&mockdb.queries, &query_local)))
 	{
@@ -193,6 +199,59 @@ zbx_db_result_t	__wrap_zbx_db_select_n(const char *query, int n)
 	return __wrap_zbx_db_select("%s limit %d", query, n);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: substitutes bound parameters into prepared statement and selects  *
+ *          the mocked data of resulting query                                *
+ *                                                                            *
+ ******************************************************************************/
+zbx_db_result_t	__wrap_zbx_db_select_prepared(const char *sql, const zbx_db_bind_t *binds, int binds_num)
+{
+	char		*query = NULL;
+	size_t		query_alloc = 0, query_offset = 0;
+	int		i = 0;
+	zbx_db_result_t	result;
+
+	for (; '\0' != *sql; sql++)
+	{
+		if ('?' != *sql)
+		{
+			zbx_chrcpy_alloc(&query, &query_alloc, &query_offset, *sql);
+			continue;
+		}
+
+		if (i == binds_num)
+			fail_msg("Not enough parameters bound to prepared statement");
+
+		switch (binds[i].type)
+		{
+			case ZBX_TYPE_ID:
+			case ZBX_TYPE_UINT:
+				zbx_snprintf_alloc(&query, &query_alloc, &query_offset, ZBX_FS_UI64, binds[i].value.ui64);
+				break;
+			case ZBX_TYPE_INT:
+				zbx_snprintf_alloc(&query, &query_alloc, &query_offset, "%d", binds[i].value.i32);
+				break;
+			case ZBX_TYPE_FLOAT:
+				zbx_snprintf_alloc(&query, &query_alloc, &query_offset, ZBX_FS_DBL64_SQL, binds[i].value.dbl);
+				break;
+			default:
+				zbx_snprintf_alloc(&query, &query_alloc, &query_offset, "'%s'", binds[i].value.str);
+				break;
+		}
+
+		i++;
+	}
+
+	if (i != binds_num)
+		fail_msg("Too many parameters bound to prepared statement");
+
+	result = __wrap_zbx_db_select("%s", query);
+	zbx_free(query);
+
+	return result;
+}
+
 zbx_db_row_t	zbx_db_fetch(zbx_db_result_t result)
 {
 	zbx_mock_error_t	error;
@@ -296,6 +355,12 @@ void	zbx_mockdb_init(void)
 void	zbx_mockdb_destroy(void)
 {
 	zbx_hashset_destroy(&mockdb.queries);
+	zbx_free(mockdb.last_query);
+}
+
+const char	*zbx_mockdb_get_last_query(void)
+{
+	return mockdb.last_query;
 }
 
 zbx_db_result_t	zbx_dbconn_vselect(zbx_dbconn_t *db, const char *fmt, va_list args)
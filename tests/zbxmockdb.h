@@ -18,5 +18,6 @@
 
 void	zbx_mockdb_init(void);
 void	zbx_mockdb_destroy(void);
+const char	*zbx_mockdb_get_last_query(void);
 
 #endif /* BUILD_TESTS_ZBXMOCKDB_H_ */
@@ -38,6 +38,7 @@ void	*mock_streams[ZBX_MOCK_MAX_FILES];
 static zbx_mock_handle_t	fragments;
 
 static FILE	*(*fopen_mock_callback)(const char *, const char *) = NULL;
+static int	(*open_mock_callback)(const char *, int, int) = NULL;
 
 struct zbx_mock_IO_FILE
 {
@@ -228,6 +229,18 @@ static int	next_fragment(void)
 
 int	__wrap_open(const char *path, int oflag, ...)
 {
+	/* in case a test needs a custom open mock, use callback instead */
+	if (NULL != open_mock_callback)
+	{
+		va_list	args;
+		int	fd;
+
+		va_start(args, oflag);
+		fd = (*open_mock_callback)(path, oflag, 0 != (oflag & O_CREAT) ? va_arg(args, int) : 0);
+		va_end(args);
+		return fd;
+	}
+
 	if (SUCCEED == is_profiler_path(path))
 	{
 		va_list	args;
@@ -386,3 +399,8 @@ void	zbx_set_fopen_mock_callback(FILE *(*fopen_callback)(const char *, const cha
 {
 	fopen_mock_callback = fopen_callback;
 }
+
+void	zbx_set_open_mock_callback(int (*open_callback)(const char *, int, int))
+{
+	open_mock_callback = open_callback;
+}